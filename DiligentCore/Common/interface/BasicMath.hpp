@@ -1533,6 +1533,49 @@ template <class T> struct Matrix4x4
         return inv;
     }
 
+    /// Inverts an affine transform (the last column is assumed to be [0, 0, 0, 1]).
+
+    /// Only the upper 3x3 block is inverted through its adjugate; the translation
+    /// of the inverse is -t * A^-1. This is considerably cheaper than the general
+    /// Inverse() that evaluates sixteen 3x3 determinants.
+    Matrix4x4 InverseAffine() const
+    {
+        // Cofactors of the upper 3x3 block, transposed
+        T inv11 = _22 * _33 - _23 * _32;
+        T inv12 = _13 * _32 - _12 * _33;
+        T inv13 = _12 * _23 - _13 * _22;
+        T inv21 = _23 * _31 - _21 * _33;
+        T inv22 = _11 * _33 - _13 * _31;
+        T inv23 = _13 * _21 - _11 * _23;
+        T inv31 = _21 * _32 - _22 * _31;
+        T inv32 = _12 * _31 - _11 * _32;
+        T inv33 = _11 * _22 - _12 * _21;
+
+        auto det    = _11 * inv11 + _12 * inv21 + _13 * inv31;
+        auto invDet = static_cast<T>(1) / det;
+
+        inv11 *= invDet;
+        inv12 *= invDet;
+        inv13 *= invDet;
+        inv21 *= invDet;
+        inv22 *= invDet;
+        inv23 *= invDet;
+        inv31 *= invDet;
+        inv32 *= invDet;
+        inv33 *= invDet;
+
+        return Matrix4x4 // clang-format off
+            {
+                inv11, inv12, inv13, 0,
+                inv21, inv22, inv23, 0,
+                inv31, inv32, inv33, 0,
+                -(_41 * inv11 + _42 * inv21 + _43 * inv31),
+                -(_41 * inv12 + _42 * inv22 + _43 * inv32),
+                -(_41 * inv13 + _42 * inv23 + _43 * inv33),
+                1 // clang-format on
+            };
+    }
+
     Matrix4x4 RemoveTranslation() const
     {
         return Matrix4x4 // clang-format off
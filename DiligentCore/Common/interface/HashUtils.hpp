@@ -61,6 +61,26 @@ std::size_t ComputeHash(const ArgsType&... Args)
     return Seed;
 }
 
+/// Computes the hash of a raw memory block, e.g. contents of a file.
+inline std::size_t ComputeHashRaw(const void* pData, size_t Size)
+{
+    std::size_t Seed = 0;
+
+    const auto* pBytes   = static_cast<const Uint8*>(pData);
+    const auto* pEnd     = pBytes + Size;
+    const auto  NumWords = Size / sizeof(std::size_t);
+    for (size_t i = 0; i < NumWords; ++i, pBytes += sizeof(std::size_t))
+    {
+        std::size_t Word;
+        memcpy(&Word, pBytes, sizeof(Word));
+        HashCombine(Seed, Word);
+    }
+    for (; pBytes < pEnd; ++pBytes)
+        HashCombine(Seed, *pBytes);
+
+    return Seed;
+}
+
 template <typename CharType>
 struct CStringHash
 {
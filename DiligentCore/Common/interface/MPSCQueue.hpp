@@ -0,0 +1,140 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include "../../Primitives/interface/BasicTypes.h"
+#include "../../Platforms/Basic/interface/DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+/// Lock-free unbounded queue with multiple producers and a single consumer.
+
+/// Any thread may push values, while only one thread at a time may pop them.
+/// The queue is a linked list of nodes (D. Vyukov's MPSC queue): a producer
+/// atomically exchanges the head pointer and then links the previous head to the new node,
+/// so pushing never blocks and never waits for other producers. A value that is being
+/// pushed becomes visible to the consumer once the producer has linked it; until then
+/// Pop() may report the queue as empty.
+template <typename T>
+class MPSCQueue
+{
+public:
+    MPSCQueue() :
+        m_Head{new Node},
+        m_pTail{m_Head.load(std::memory_order_relaxed)}
+    {
+    }
+
+    ~MPSCQueue()
+    {
+        auto* pNode = m_pTail;
+        while (pNode != nullptr)
+        {
+            auto* pNext = pNode->pNext.load(std::memory_order_relaxed);
+            delete pNode;
+            pNode = pNext;
+        }
+    }
+
+    // clang-format off
+    MPSCQueue           (const MPSCQueue&)  = delete;
+    MPSCQueue           (      MPSCQueue&&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&)  = delete;
+    MPSCQueue& operator=(      MPSCQueue&&) = delete;
+    // clang-format on
+
+    /// Adds the value to the queue. Can be called by any thread.
+    void Push(T Value)
+    {
+        auto* pNode = new Node{std::move(Value)};
+        m_Size.fetch_add(1, std::memory_order_relaxed);
+        // Serialization point for producers
+        auto* pPrev = m_Head.exchange(pNode, std::memory_order_acq_rel);
+        pPrev->pNext.store(pNode, std::memory_order_release);
+    }
+
+    /// Removes the oldest value from the queue. Must only be called by the consumer thread.
+
+    /// \return false if the queue is empty.
+    bool Pop(T& Value)
+    {
+        auto* pTail = m_pTail;
+        auto* pNext = pTail->pNext.load(std::memory_order_acquire);
+        if (pNext == nullptr)
+            return false;
+
+        // The next node becomes the new stub; its value is moved out
+        Value        = std::move(pNext->Value);
+        pNext->Value = T{};
+        m_pTail      = pNext;
+        delete pTail;
+        m_Size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Returns the approximate number of values in the queue.
+    Uint32 GetSize() const
+    {
+        return static_cast<Uint32>(m_Size.load(std::memory_order_relaxed));
+    }
+
+    /// Returns true if the consumer will not find any values in the queue.
+    /// Must only be called by the consumer thread.
+    bool IsEmpty() const
+    {
+        return m_pTail->pNext.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node
+    {
+        Node() = default;
+
+        explicit Node(T&& _Value) :
+            Value{std::move(_Value)}
+        {}
+
+        T                  Value{};
+        std::atomic<Node*> pNext{nullptr};
+    };
+
+    // Producers push to the head
+    std::atomic<Node*> m_Head;
+
+    // The consumer pops from the tail. The tail node is a stub whose value has been consumed.
+    Node* m_pTail;
+
+    std::atomic<Int32> m_Size{0};
+};
+
+} // namespace Diligent
@@ -0,0 +1,169 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+
+#include "../../Primitives/interface/BasicTypes.h"
+
+namespace Diligent
+{
+
+/// Simple pool of worker threads that execute tasks in FIFO order.
+class ThreadPool
+{
+public:
+    /// Creates the thread pool.
+
+    /// \param [in] NumThreads - Number of worker threads. If 0, the number of hardware
+    ///                          threads minus one is used, so that together with the
+    ///                          calling thread all cores are busy.
+    explicit ThreadPool(Uint32 NumThreads = 0)
+    {
+        if (NumThreads == 0)
+        {
+            auto NumCores = std::thread::hardware_concurrency();
+            NumThreads    = NumCores > 1 ? NumCores - 1 : 1;
+        }
+
+        m_Workers.reserve(NumThreads);
+        for (Uint32 i = 0; i < NumThreads; ++i)
+        {
+            m_Workers.emplace_back([this]() { WorkerThreadProc(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_QueueMtx};
+            m_Stop = true;
+        }
+        m_QueueCV.notify_all();
+        for (auto& Worker : m_Workers)
+            Worker.join();
+    }
+
+    // clang-format off
+    ThreadPool           (const ThreadPool&)  = delete;
+    ThreadPool           (      ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&)  = delete;
+    ThreadPool& operator=(      ThreadPool&&) = delete;
+    // clang-format on
+
+    /// Adds a task to the queue. The task will be executed by one of the worker threads.
+    void Enqueue(std::function<void()> Task)
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_QueueMtx};
+            m_Tasks.emplace_back(std::move(Task));
+        }
+        m_QueueCV.notify_one();
+    }
+
+    /// Splits the range [0, Count) into chunks of ChunkSize elements and calls Func(Begin, End)
+    /// for every chunk. The chunks are processed by the worker threads as well as by the calling
+    /// thread. The method returns when all chunks have been processed.
+    template <typename FuncType>
+    void ParallelFor(size_t Count, size_t ChunkSize, FuncType&& Func)
+    {
+        if (Count == 0)
+            return;
+
+        ChunkSize              = std::max(ChunkSize, size_t{1});
+        const size_t NumChunks = (Count + ChunkSize - 1) / ChunkSize;
+
+        std::atomic<size_t> NextChunk{0};
+
+        auto ProcessChunks = [&]() {
+            for (size_t Chunk = NextChunk.fetch_add(1); Chunk < NumChunks; Chunk = NextChunk.fetch_add(1))
+            {
+                const auto Begin = Chunk * ChunkSize;
+                Func(Begin, std::min(Begin + ChunkSize, Count));
+            }
+        };
+
+        // The calling thread takes one share of the work itself
+        const auto NumHelpers = static_cast<Uint32>(std::min(NumChunks - 1, m_Workers.size()));
+
+        std::mutex              DoneMtx;
+        std::condition_variable DoneCV;
+        Uint32                  NumPendingHelpers = NumHelpers;
+        for (Uint32 i = 0; i < NumHelpers; ++i)
+        {
+            Enqueue([&]() {
+                ProcessChunks();
+                // Notify while holding the mutex as the waiting thread may destroy
+                // the condition variable as soon as the counter reaches zero.
+                std::lock_guard<std::mutex> Lock{DoneMtx};
+                if (--NumPendingHelpers == 0)
+                    DoneCV.notify_one();
+            });
+        }
+
+        ProcessChunks();
+
+        std::unique_lock<std::mutex> Lock{DoneMtx};
+        DoneCV.wait(Lock, [&]() { return NumPendingHelpers == 0; });
+    }
+
+    Uint32 GetNumThreads() const { return static_cast<Uint32>(m_Workers.size()); }
+
+private:
+    void WorkerThreadProc()
+    {
+        for (;;)
+        {
+            std::function<void()> Task;
+            {
+                std::unique_lock<std::mutex> Lock{m_QueueMtx};
+                m_QueueCV.wait(Lock, [this]() { return m_Stop || !m_Tasks.empty(); });
+                if (m_Stop && m_Tasks.empty())
+                    return;
+                Task = std::move(m_Tasks.front());
+                m_Tasks.pop_front();
+            }
+            Task();
+        }
+    }
+
+    std::vector<std::thread>          m_Workers;
+    std::deque<std::function<void()>> m_Tasks;
+    std::mutex                        m_QueueMtx;
+    std::condition_variable           m_QueueCV;
+    bool                              m_Stop = false;
+};
+
+} // namespace Diligent
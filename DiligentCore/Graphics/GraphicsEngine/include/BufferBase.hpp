@@ -87,6 +87,12 @@ public:
         Uint64 DeviceQueuesMask = pDevice->GetCommandQueueMask();
         DEV_CHECK_ERR((this->m_Desc.CommandQueueMask & DeviceQueuesMask) != 0, "No bits in the command queue mask (0x", std::hex, this->m_Desc.CommandQueueMask, ") correspond to one of ", pDevice->GetCommandQueueCount(), " available device command queues");
         this->m_Desc.CommandQueueMask &= DeviceQueuesMask;
+
+        if ((this->m_Desc.MiscFlags & MISC_BUFFER_FLAG_PERSISTENT_MAPPING) != 0 && !pDevice->GetDeviceCaps().IsGLDevice())
+        {
+            // Only OpenGL backend creates persistently mapped storage
+            this->m_Desc.MiscFlags &= ~MISC_BUFFER_FLAG_PERSISTENT_MAPPING;
+        }
     }
 
     IMPLEMENT_QUERY_INTERFACE_IN_PLACE(IID_Buffer, TDeviceObjectBase)
@@ -1288,6 +1288,7 @@ inline void DeviceContextBase<BaseInterface, ImplementationTraits>::
     {
         DEV_CHECK_ERR(BuffDesc.Usage == USAGE_DYNAMIC || BuffDesc.Usage == USAGE_STAGING, "Only dynamic and staging buffers can be mapped with discard flag");
         DEV_CHECK_ERR(MapType == MAP_WRITE, "MAP_FLAG_DISCARD is only valid when mapping buffer for writing");
+        DEV_CHECK_ERR((BuffDesc.MiscFlags & MISC_BUFFER_FLAG_PERSISTENT_MAPPING) == 0, "Persistently mapped buffer '", BuffDesc.Name, "' can't be mapped with MAP_FLAG_DISCARD flag");
     }
 }
 
@@ -106,26 +106,31 @@ struct BufferDesc DILIGENT_DERIVE(DeviceObjectAttribs)
     /// Defines which command queues this buffer can be used with
     Uint64 CommandQueueMask         DEFAULT_INITIALIZER(1);
 
+    /// Miscellaneous flags, see Diligent::MISC_BUFFER_FLAGS for details.
+    MISC_BUFFER_FLAGS MiscFlags     DEFAULT_INITIALIZER(MISC_BUFFER_FLAG_NONE);
+
 #if DILIGENT_CPP_INTERFACE
     // We have to explicitly define constructors because otherwise the following initialization fails on Apple's clang:
     //      BufferDesc{1024, BIND_UNIFORM_BUFFER, USAGE_DEFAULT}
 
     BufferDesc()noexcept{}
 
-    BufferDesc(Uint32           _uiSizeInBytes, 
-               BIND_FLAGS       _BindFlags,
-               USAGE            _Usage             = BufferDesc{}.Usage,
-               CPU_ACCESS_FLAGS _CPUAccessFlags    = BufferDesc{}.CPUAccessFlags,
-               BUFFER_MODE      _Mode              = BufferDesc{}.Mode,
-               Uint32           _ElementByteStride = BufferDesc{}.ElementByteStride,
-               Uint64           _CommandQueueMask  = BufferDesc{}.CommandQueueMask) noexcept :
+    BufferDesc(Uint32            _uiSizeInBytes, 
+               BIND_FLAGS        _BindFlags,
+               USAGE             _Usage             = BufferDesc{}.Usage,
+               CPU_ACCESS_FLAGS  _CPUAccessFlags    = BufferDesc{}.CPUAccessFlags,
+               BUFFER_MODE       _Mode              = BufferDesc{}.Mode,
+               Uint32            _ElementByteStride = BufferDesc{}.ElementByteStride,
+               Uint64            _CommandQueueMask  = BufferDesc{}.CommandQueueMask,
+               MISC_BUFFER_FLAGS _MiscFlags         = BufferDesc{}.MiscFlags) noexcept :
         uiSizeInBytes       {_uiSizeInBytes    },
         BindFlags           {_BindFlags        },
         Usage               {_Usage            },
         CPUAccessFlags      {_CPUAccessFlags   },
         Mode                {_Mode             },
         ElementByteStride   {_ElementByteStride},
-        CommandQueueMask    {_CommandQueueMask }
+        CommandQueueMask    {_CommandQueueMask },
+        MiscFlags           {_MiscFlags        }
     {
     }
 
@@ -145,7 +150,8 @@ struct BufferDesc DILIGENT_DERIVE(DeviceObjectAttribs)
                CPUAccessFlags    == RHS.CPUAccessFlags    &&
                Mode              == RHS.Mode              &&
                ElementByteStride == RHS.ElementByteStride && 
-               CommandQueueMask  == RHS.CommandQueueMask;
+               CommandQueueMask  == RHS.CommandQueueMask  &&
+               MiscFlags         == RHS.MiscFlags;
     }
 #endif
 };
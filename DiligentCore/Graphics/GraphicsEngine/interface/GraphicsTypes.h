@@ -939,6 +939,28 @@ DILIGENT_TYPED_ENUM(MISC_TEXTURE_FLAGS, Uint8)
 };
 DEFINE_FLAG_ENUM_OPERATORS(MISC_TEXTURE_FLAGS)
 
+/// Miscellaneous buffer flags
+
+/// The enumeration is used by BufferDesc to describe misc buffer flags
+DILIGENT_TYPED_ENUM(MISC_BUFFER_FLAGS, Uint8)
+{
+    MISC_BUFFER_FLAG_NONE               = 0x00,
+
+    /// Keep the buffer storage mapped for the lifetime of the buffer.
+
+    /// Mapping the buffer for writing returns the same memory every time and does not
+    /// synchronize with the GPU, so the application must use fences to make sure that
+    /// the GPU has finished reading a region before overwriting it.
+    /// The buffer must be created with USAGE_DYNAMIC and CPU_ACCESS_WRITE, and can't be
+    /// mapped with MAP_FLAG_DISCARD.
+    ///
+    /// \note  The flag is only supported by OpenGL 4.4 or GL_ARB_buffer_storage, where the buffer
+    ///        is created with glBufferStorage and mapped with GL_MAP_PERSISTENT_BIT and GL_MAP_COHERENT_BIT.
+    ///        On other devices, the flag is removed from the buffer description when the buffer is created.
+    MISC_BUFFER_FLAG_PERSISTENT_MAPPING = 0x01
+};
+DEFINE_FLAG_ENUM_OPERATORS(MISC_BUFFER_FLAGS)
+
 /// Input primitive topology.
 
 /// This enumeration is used by GraphicsPipelineDesc structure to define input primitive topology.
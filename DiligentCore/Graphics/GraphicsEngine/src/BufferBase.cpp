@@ -110,6 +110,12 @@ void ValidateBufferDesc(const BufferDesc& Desc, const DeviceCaps& deviceCaps)
         default:
             UNEXPECTED("Unknown usage");
     }
+
+    if (Desc.MiscFlags & MISC_BUFFER_FLAG_PERSISTENT_MAPPING)
+    {
+        VERIFY_BUFFER(Desc.Usage == USAGE_DYNAMIC && Desc.CPUAccessFlags == CPU_ACCESS_WRITE,
+                      "persistently mapped buffers must be created with USAGE_DYNAMIC and CPU_ACCESS_WRITE.");
+    }
 }
 
 void ValidateBufferInitData(const BufferDesc& Desc, const BufferData* pBuffData)
@@ -96,6 +96,9 @@ private:
     GLObjectWrappers::GLBufferObj m_GlBuffer;
     const Uint32                  m_BindTarget;
     const GLenum                  m_GLUsageHint;
+
+    // CPU address of the storage of a buffer created with MISC_BUFFER_FLAG_PERSISTENT_MAPPING flag
+    void* m_pPersistentMappedData = nullptr;
 };
 
 } // namespace Diligent
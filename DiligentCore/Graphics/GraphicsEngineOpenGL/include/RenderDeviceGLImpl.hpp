@@ -149,6 +149,9 @@ public:
     size_t GetCommandQueueCount() const { return 1; }
     Uint64 GetCommandQueueMask() const { return Uint64{1}; }
 
+    /// Returns true if glBufferStorage is available, see MISC_BUFFER_FLAG_PERSISTENT_MAPPING.
+    bool IsBufferStorageSupported() const { return m_BufferStorageSupported; }
+
     void InitTexRegionRender();
 
 protected:
@@ -174,6 +177,8 @@ protected:
 
     std::unique_ptr<TexRegionRender> m_pTexRegionRender;
 
+    bool m_BufferStorageSupported = false;
+
 private:
     template <typename PSOCreateInfoType>
     void CreatePipelineState(const PSOCreateInfoType& PSOCreateInfo, IPipelineState** ppPipelineState, bool bIsDeviceInternal);
@@ -150,10 +150,36 @@ BufferGLImpl::BufferGLImpl(IReferenceCounters*        pRefCounters,
 
     // See also http://www.informit.com/articles/article.aspx?p=2033340&seqNum=2
 
-    // All buffer bind targets (GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER etc.) relate to the same
-    // kind of objects. As a result they are all equivalent from a transfer point of view.
-    glBufferData(m_BindTarget, DataSize, pData, m_GLUsageHint);
-    CHECK_GL_ERROR_AND_THROW("glBufferData() failed");
+    if (m_Desc.MiscFlags & MISC_BUFFER_FLAG_PERSISTENT_MAPPING)
+    {
+#if GL_ARB_buffer_storage
+        if (pDeviceGL->IsBufferStorageSupported())
+        {
+            // Immutable storage can be mapped while the GPU is using the buffer. Coherent mapping
+            // makes CPU writes visible to the GPU without explicit flushes.
+            constexpr GLbitfield StorageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | GL_DYNAMIC_STORAGE_BIT;
+            glBufferStorage(m_BindTarget, DataSize, nullptr, StorageFlags);
+            CHECK_GL_ERROR_AND_THROW("glBufferStorage() failed");
+
+            constexpr GLbitfield MapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            m_pPersistentMappedData       = glMapBufferRange(m_BindTarget, 0, DataSize, MapFlags);
+            CHECK_GL_ERROR_AND_THROW("glMapBufferRange() failed");
+        }
+        else
+#endif
+        {
+            LOG_WARNING_MESSAGE("Persistent mapping of buffer '", m_Desc.Name, "' is not supported by this device: glBufferStorage is not available");
+            m_Desc.MiscFlags &= ~MISC_BUFFER_FLAG_PERSISTENT_MAPPING;
+        }
+    }
+
+    if (m_pPersistentMappedData == nullptr)
+    {
+        // All buffer bind targets (GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER etc.) relate to the same
+        // kind of objects. As a result they are all equivalent from a transfer point of view.
+        glBufferData(m_BindTarget, DataSize, pData, m_GLUsageHint);
+        CHECK_GL_ERROR_AND_THROW("glBufferData() failed");
+    }
     GLState.BindBuffer(m_BindTarget, GLObjectWrappers::GLBufferObj::Null(), ResetVAO);
 }
 
@@ -208,6 +234,8 @@ BufferGLImpl::BufferGLImpl(IReferenceCounters*        pRefCounters,
     m_GLUsageHint {UsageToGLUsage(BuffDesc)}
 // clang-format on
 {
+    // The storage of an external buffer is not created by the engine
+    m_Desc.MiscFlags &= ~MISC_BUFFER_FLAG_PERSISTENT_MAPPING;
 }
 
 BufferGLImpl::~BufferGLImpl()
@@ -270,6 +298,16 @@ void BufferGLImpl::Map(GLContextState& CtxState, MAP_TYPE MapType, Uint32 MapFla
 
 void BufferGLImpl::MapRange(GLContextState& CtxState, MAP_TYPE MapType, Uint32 MapFlags, Uint32 Offset, Uint32 Length, PVoid& pMappedData)
 {
+    if (m_pPersistentMappedData != nullptr)
+    {
+        // The buffer is never unmapped, and the application synchronizes access to it with fences
+        VERIFY(MapType == MAP_WRITE, "Persistently mapped buffers can only be mapped for writing");
+        VERIFY((MapFlags & MAP_FLAG_DISCARD) == 0, "Persistently mapped buffers can't be mapped with MAP_FLAG_DISCARD flag");
+        VERIFY_EXPR(Offset + Length <= m_Desc.uiSizeInBytes);
+        pMappedData = reinterpret_cast<Uint8*>(m_pPersistentMappedData) + Offset;
+        return;
+    }
+
     BufferMemoryBarrier(
         GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT, // Access by the client to persistent mapped regions of buffer
                                              // objects will reflect data written by shaders prior to the barrier.
@@ -331,6 +369,9 @@ void BufferGLImpl::MapRange(GLContextState& CtxState, MAP_TYPE MapType, Uint32 M
 
 void BufferGLImpl::Unmap(GLContextState& CtxState)
 {
+    if (m_pPersistentMappedData != nullptr)
+        return;
+
     constexpr bool ResetVAO = true;
     CtxState.BindBuffer(m_BindTarget, m_GlBuffer, ResetVAO);
     auto Result = glUnmapBuffer(m_BindTarget);
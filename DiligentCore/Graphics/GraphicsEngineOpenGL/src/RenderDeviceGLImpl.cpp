@@ -387,6 +387,9 @@ RenderDeviceGLImpl::RenderDeviceGLImpl(IReferenceCounters*       pRefCounters,
         SamCaps.BorderSamplingModeSupported   = True;
         SamCaps.AnisotropicFilteringSupported = IsGL46OrAbove || CheckExtension("GL_ARB_texture_filter_anisotropic");
         SamCaps.LODBiasSupported              = True;
+
+        const bool IsGL44OrAbove = (MajorVersion >= 5) || (MajorVersion == 4 && MinorVersion >= 4);
+        m_BufferStorageSupported = IsGL44OrAbove || CheckExtension("GL_ARB_buffer_storage");
     }
     else
     {
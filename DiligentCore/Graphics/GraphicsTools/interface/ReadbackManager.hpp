@@ -0,0 +1,233 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "../../GraphicsEngine/interface/RenderDevice.h"
+#include "../../GraphicsEngine/interface/DeviceContext.h"
+#include "../../GraphicsEngine/interface/Query.h"
+#include "../../../Common/interface/RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+/// Reads data back from the GPU without stalling the pipeline.
+
+/// The manager copies buffer regions and texture subresources to pooled staging resources
+/// and tracks completion of all readbacks with one fence. Readbacks that are requested between two
+/// Update() calls share one fence value that is signaled by the next Update(). Once the GPU has reached
+/// the fence value, a later Update() maps the staging resource and invokes the callback or fulfills
+/// the future, typically two or three frames after the request.
+///
+/// All methods must be called by the render thread, and callbacks are invoked by Update()
+/// on the render thread. Futures may be waited on by any thread.
+/// Readbacks that are still pending when the manager is destroyed are abandoned:
+/// their callbacks are never called and their futures throw std::future_error.
+class ReadbackManager
+{
+public:
+    struct CreateInfo
+    {
+        /// The maximum number of idle staging buffers and textures that are kept for reuse.
+        Uint32 MaxPooledResources = 16;
+    };
+
+    /// Texture data returned by ReadTextureAsync(). Rows are tightly packed.
+    struct TextureData
+    {
+        Uint32             Width   = 0;
+        Uint32             Height  = 0;
+        Uint32             RowSize = 0;
+        TEXTURE_FORMAT     Format  = TEX_FORMAT_UNKNOWN;
+        std::vector<Uint8> Data;
+    };
+
+    using BufferCallback  = std::function<void(const void* pData, Uint32 Size)>;
+    using TextureCallback = std::function<void(const MappedTextureSubresource& MappedData, Uint32 Width, Uint32 Height)>;
+
+    ReadbackManager(IRenderDevice* pDevice, const CreateInfo& CI);
+
+    explicit ReadbackManager(IRenderDevice* pDevice) :
+        ReadbackManager{pDevice, CreateInfo{}}
+    {}
+
+    // clang-format off
+    ReadbackManager           (const ReadbackManager&)  = delete;
+    ReadbackManager           (      ReadbackManager&&) = delete;
+    ReadbackManager& operator=(const ReadbackManager&)  = delete;
+    ReadbackManager& operator=(      ReadbackManager&&) = delete;
+    // clang-format on
+
+    ~ReadbackManager();
+
+
+    /// Reads back the region of the buffer.
+
+    /// \param [in] pContext          - Device context to record the copy command.
+    /// \param [in] pBuffer           - Buffer to read.
+    /// \param [in] Offset            - Offset of the region, in bytes.
+    /// \param [in] Size              - Size of the region, in bytes.
+    /// \param [in] Callback          - Function that is called by Update() with the data.
+    /// \param [in] SrcTransitionMode - State transition mode of the source buffer.
+    void ReadBuffer(IDeviceContext*                pContext,
+                    IBuffer*                       pBuffer,
+                    Uint32                         Offset,
+                    Uint32                         Size,
+                    BufferCallback                 Callback,
+                    RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    /// Reads back the region of the buffer, see ReadBuffer().
+    std::future<std::vector<Uint8>> ReadBufferAsync(IDeviceContext*                pContext,
+                                                    IBuffer*                       pBuffer,
+                                                    Uint32                         Offset,
+                                                    Uint32                         Size,
+                                                    RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+
+    /// Reads back the region of the 2D texture subresource.
+
+    /// \param [in] pContext          - Device context to record the copy command.
+    /// \param [in] pTexture          - Texture to read. Compressed formats are not supported.
+    /// \param [in] MipLevel          - Mip level to read.
+    /// \param [in] ArraySlice        - Array slice to read.
+    /// \param [in] pRegion           - Region to read, or null to read the entire mip level.
+    /// \param [in] Callback          - Function that is called by Update() with the mapped data.
+    /// \param [in] SrcTransitionMode - State transition mode of the source texture.
+    void ReadTexture(IDeviceContext*                pContext,
+                     ITexture*                      pTexture,
+                     Uint32                         MipLevel,
+                     Uint32                         ArraySlice,
+                     const Box*                     pRegion,
+                     TextureCallback                Callback,
+                     RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    /// Reads back the region of the 2D texture subresource, see ReadTexture().
+    std::future<TextureData> ReadTextureAsync(IDeviceContext*                pContext,
+                                              ITexture*                      pTexture,
+                                              Uint32                         MipLevel,
+                                              Uint32                         ArraySlice,
+                                              const Box*                     pRegion,
+                                              RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+
+    /// Reads the query data once the GPU has completed the commands recorded so far.
+
+    /// \tparam QueryDataType - Query data structure that matches the query type, e.g. QueryDataOcclusion.
+    ///
+    /// \param [in] pQuery   - Query that has been ended.
+    /// \param [in] Callback - Function that is called by Update() with the query data.
+    template <typename QueryDataType>
+    void ReadQuery(IQuery* pQuery, std::function<void(const QueryDataType&)> Callback)
+    {
+        RefCntAutoPtr<IQuery> pQueryRef{pQuery};
+        EnqueueReadback(
+            [pQueryRef, Callback](IDeviceContext*) mutable //
+            {
+                QueryDataType Data;
+                if (!pQueryRef->GetData(&Data, sizeof(Data)))
+                    return false;
+                Callback(Data);
+                return true;
+            });
+    }
+
+    /// Reads the query data, see ReadQuery().
+    template <typename QueryDataType>
+    std::future<QueryDataType> ReadQueryAsync(IQuery* pQuery)
+    {
+        auto pPromise = std::make_shared<std::promise<QueryDataType>>();
+        auto Future   = pPromise->get_future();
+        ReadQuery<QueryDataType>(pQuery, [pPromise](const QueryDataType& Data) { pPromise->set_value(Data); });
+        return Future;
+    }
+
+    /// Reads the time between two timestamp queries, in seconds.
+
+    /// Unlike DurationQueryHelper, the manager does not keep a fixed ring of queries
+    /// and never polls queries before the GPU has reached them.
+    void ReadDuration(IQuery* pStartTimestamp, IQuery* pEndTimestamp, std::function<void(double Duration)> Callback);
+
+
+    /// Signals the fence for the readbacks requested since the last call and completes the readbacks
+    /// that the GPU has finished. Must be called once per frame.
+    void Update(IDeviceContext* pContext);
+
+    /// Waits until the GPU finishes all pending readbacks and completes them.
+    /// Queries that have been passed to ReadQuery() or ReadDuration() must have been ended.
+    void WaitForIdle(IDeviceContext* pContext);
+
+    size_t GetNumPendingReadbacks() const { return m_PendingReadbacks.size(); }
+
+private:
+    // Returns true when the readback has completed, and false if the data is not available yet.
+    using CompleteReadbackFunc = std::function<bool(IDeviceContext*)>;
+
+    void EnqueueReadback(CompleteReadbackFunc&& Complete);
+
+    RefCntAutoPtr<IBuffer>  AllocateStagingBuffer(Uint32 Size);
+    RefCntAutoPtr<ITexture> AllocateStagingTexture(Uint32 Width, Uint32 Height, TEXTURE_FORMAT Format);
+
+    void RecycleStagingBuffer(RefCntAutoPtr<IBuffer>&& pBuffer);
+    void RecycleStagingTexture(RefCntAutoPtr<ITexture>&& pTexture);
+
+    const CreateInfo m_CI;
+
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+    RefCntAutoPtr<IFence>        m_pFence;
+
+    struct PendingReadback
+    {
+        PendingReadback(Uint64 _FenceValue, CompleteReadbackFunc&& _Complete) :
+            // clang-format off
+            FenceValue{_FenceValue         },
+            Complete  {std::move(_Complete)}
+        // clang-format on
+        {
+        }
+
+        Uint64               FenceValue;
+        CompleteReadbackFunc Complete;
+    };
+    std::deque<PendingReadback> m_PendingReadbacks;
+
+    // Idle staging buffers, keyed by the power-of-two size
+    std::unordered_map<Uint32, std::vector<RefCntAutoPtr<IBuffer>>> m_AvailableBuffers;
+    std::vector<RefCntAutoPtr<ITexture>>                             m_AvailableTextures;
+    Uint32                                                           m_NumAvailableBuffers = 0;
+
+    Uint64 m_NextFenceValue      = 1;
+    bool   m_FenceSignalRequired = false;
+};
+
+} // namespace Diligent
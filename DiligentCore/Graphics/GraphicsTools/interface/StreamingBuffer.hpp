@@ -29,11 +29,13 @@
 
 #include <functional>
 #include <vector>
+#include <deque>
 #include <string>
 
 #include "../../GraphicsEngine/interface/RenderDevice.h"
 #include "../../GraphicsEngine/interface/DeviceContext.h"
 #include "../../GraphicsEngine/interface/Buffer.h"
+#include "../../GraphicsEngine/interface/Fence.h"
 #include "../../../Common/interface/RefCntAutoPtr.hpp"
 #include "MapHelper.hpp"
 
@@ -47,6 +49,17 @@ struct StreamingBufferCreateInfo
     std::function<void(IBuffer*)> OnBufferResizeCallback = nullptr;
     Uint32                        NumContexts            = 1;
     bool                          AllowPersistentMapping = false;
+
+    /// Keep the buffer mapped and use it as a ring, in which the space allocated during a frame
+    /// is only reused after the GPU has finished that frame, see StreamingBuffer::FinishFrame().
+
+    /// The ring requires a buffer that can stay mapped between frames without being renamed by the
+    /// driver: OpenGL 4.4 (see MISC_BUFFER_FLAG_PERSISTENT_MAPPING), or Vulkan with CPU-writable
+    /// unified memory. On other devices, the streaming buffer uses discard maps as usual.
+    /// Only a single immediate context is supported. When the ring is full, Map() waits for the oldest
+    /// frame with IDeviceContext::WaitForFence(), which flushes the context, so the pipeline state and
+    /// shader resources must be committed after the buffer is mapped.
+    bool UseFenceRing = false;
 };
 
 class StreamingBuffer
@@ -63,8 +76,20 @@ public:
     {
         VERIFY_EXPR(CI.pDevice != nullptr);
         VERIFY_EXPR(CI.BuffDesc.Usage == USAGE_DYNAMIC);
-        CI.pDevice->CreateBuffer(CI.BuffDesc, nullptr, &m_pBuffer);
+        VERIFY(!CI.UseFenceRing || CI.NumContexts == 1, "Fence ring only supports a single context");
+
+        const auto BuffDesc = CI.UseFenceRing ? GetFenceRingBufferDesc(CI.pDevice, CI.BuffDesc) : CI.BuffDesc;
+        CI.pDevice->CreateBuffer(BuffDesc, nullptr, &m_pBuffer);
         VERIFY_EXPR(m_pBuffer);
+
+        if (CI.UseFenceRing && IsPersistentlyMapped(m_pBuffer->GetDesc()))
+        {
+            FenceDesc Desc;
+            Desc.Name = "Streaming buffer fence";
+            CI.pDevice->CreateFence(Desc, &m_pFence);
+            VERIFY_EXPR(m_pFence);
+        }
+
         if (m_OnBufferResizeCallback)
             m_OnBufferResizeCallback(m_pBuffer);
     }
@@ -88,6 +113,12 @@ public:
     {
         VERIFY_EXPR(Size > 0);
 
+        if (m_pFence)
+        {
+            VERIFY(CtxNum == 0, "Fence ring only supports a single context");
+            return MapRing(pCtx, pDevice, Size);
+        }
+
         auto& MapInfo = m_MapInfo[CtxNum];
         // Check if there is enough space in the buffer
         if (MapInfo.m_CurrOffset + Size > m_BufferSize)
@@ -101,18 +132,7 @@ public:
                 while (m_BufferSize < Size)
                     m_BufferSize *= 2;
 
-                auto BuffDesc          = m_pBuffer->GetDesc();
-                BuffDesc.uiSizeInBytes = m_BufferSize;
-                // BuffDesc.Name becomes invalid after old buffer is released
-                std::string Name = BuffDesc.Name;
-                BuffDesc.Name    = Name.c_str();
-
-                m_pBuffer.Release();
-                pDevice->CreateBuffer(BuffDesc, nullptr, &m_pBuffer);
-                if (m_OnBufferResizeCallback)
-                    m_OnBufferResizeCallback(m_pBuffer);
-
-                LOG_INFO_MESSAGE("Extended streaming buffer '", BuffDesc.Name, "' to ", m_BufferSize, " bytes");
+                RecreateBuffer(pDevice);
             }
         }
 
@@ -148,16 +168,18 @@ public:
 
     void Unmap(size_t CtxNum = 0)
     {
-        if (!m_UsePersistentMap)
+        if (!m_UsePersistentMap && !m_pFence)
         {
             m_MapInfo[CtxNum].m_MappedData.Unmap();
         }
     }
 
+    // Unmaps the buffer. In fence ring mode, the allocated space is only reclaimed by FinishFrame().
     void Flush(size_t CtxNum = 0)
     {
         m_MapInfo[CtxNum].m_MappedData.Unmap();
-        m_MapInfo[CtxNum].m_CurrOffset = 0;
+        if (!m_pFence)
+            m_MapInfo[CtxNum].m_CurrOffset = 0;
     }
 
     void Reset()
@@ -166,6 +188,28 @@ public:
             Flush(ctx);
     }
 
+    /// Must be called by the immediate context at the end of every frame after the commands
+    /// that use the buffer. In fence ring mode, signals the fence that releases the space
+    /// allocated during the frame, and reclaims the space of the frames that the GPU has finished.
+    /// Otherwise, calls Reset().
+    void FinishFrame(IDeviceContext* pCtx)
+    {
+        if (!m_pFence)
+        {
+            Reset();
+            return;
+        }
+
+        if (m_CurrFrameSize != 0)
+        {
+            pCtx->SignalFence(m_pFence, m_NextFenceValue);
+            m_InFlightFrames.push_back({m_NextFenceValue, m_MapInfo[0].m_CurrOffset, m_CurrFrameSize});
+            ++m_NextFenceValue;
+            m_CurrFrameSize = 0;
+        }
+        ReleaseCompletedFrames();
+    }
+
     IBuffer* GetBuffer() const { return m_pBuffer.RawPtr<IBuffer>(); }
 
     void* GetMappedCPUAddress(size_t CtxNum = 0)
@@ -173,7 +217,150 @@ public:
         return m_MapInfo[CtxNum].m_MappedData;
     }
 
+    bool IsFenceRingUsed() const { return m_pFence != nullptr; }
+
 private:
+    static BufferDesc GetFenceRingBufferDesc(IRenderDevice* pDevice, BufferDesc Desc)
+    {
+        const auto& DevCaps = pDevice->GetDeviceCaps();
+        if (DevCaps.IsGLDevice())
+        {
+            Desc.MiscFlags |= MISC_BUFFER_FLAG_PERSISTENT_MAPPING;
+        }
+        else if (DevCaps.IsVulkanDevice() &&
+                 DevCaps.AdapterInfo.UnifiedMemory != 0 &&
+                 (DevCaps.AdapterInfo.UnifiedMemoryCPUAccess & CPU_ACCESS_WRITE) != 0)
+        {
+            // Unified buffers are backed by coherent host-visible memory that is never renamed
+            Desc.Usage = USAGE_UNIFIED;
+        }
+        return Desc;
+    }
+
+    static bool IsPersistentlyMapped(const BufferDesc& Desc)
+    {
+        return Desc.Usage == USAGE_UNIFIED || (Desc.MiscFlags & MISC_BUFFER_FLAG_PERSISTENT_MAPPING) != 0;
+    }
+
+    void RecreateBuffer(IRenderDevice* pDevice)
+    {
+        auto BuffDesc          = m_pBuffer->GetDesc();
+        BuffDesc.uiSizeInBytes = m_BufferSize;
+        // BuffDesc.Name becomes invalid after old buffer is released
+        std::string Name = BuffDesc.Name;
+        BuffDesc.Name    = Name.c_str();
+
+        m_pBuffer.Release();
+        pDevice->CreateBuffer(BuffDesc, nullptr, &m_pBuffer);
+        if (m_OnBufferResizeCallback)
+            m_OnBufferResizeCallback(m_pBuffer);
+
+        LOG_INFO_MESSAGE("Extended streaming buffer '", BuffDesc.Name, "' to ", m_BufferSize, " bytes");
+    }
+
+    Uint32 MapRing(IDeviceContext* pCtx, IRenderDevice* pDevice, Uint32 Size)
+    {
+        auto Offset = AllocateFromRing(Size);
+        while (Offset == InvalidOffset)
+        {
+            if (!m_InFlightFrames.empty())
+            {
+                // Wait until the GPU finishes the oldest frame
+                pCtx->WaitForFence(m_pFence, m_InFlightFrames.front().FenceValue, true);
+                ReleaseCompletedFrames();
+            }
+            else
+            {
+                // The current frame alone does not fit into the buffer. The commands that use the
+                // old buffer keep it alive until the GPU is done with them.
+                do
+                {
+                    m_BufferSize *= 2;
+                } while (m_BufferSize < Size);
+
+                m_MapInfo[0].m_MappedData.Unmap();
+                RecreateBuffer(pDevice);
+                VERIFY_EXPR(IsPersistentlyMapped(m_pBuffer->GetDesc()));
+
+                m_MapInfo[0].m_CurrOffset = 0;
+                m_RingTail                = 0;
+                m_RingUsedSize            = 0;
+                m_CurrFrameSize           = 0;
+            }
+            Offset = AllocateFromRing(Size);
+        }
+
+        auto& MappedData = m_MapInfo[0].m_MappedData;
+        if (MappedData == nullptr)
+        {
+            // The storage is never renamed, so the buffer is mapped once and stays mapped
+            MappedData.Map(pCtx, m_pBuffer, MAP_WRITE, MAP_FLAG_NO_OVERWRITE);
+            VERIFY_EXPR(MappedData);
+        }
+
+        return Offset;
+    }
+
+    Uint32 AllocateFromRing(Uint32 Size)
+    {
+        auto& Head = m_MapInfo[0].m_CurrOffset;
+        if (m_RingUsedSize == 0)
+        {
+            Head       = 0;
+            m_RingTail = 0;
+        }
+
+        if (m_RingUsedSize + Size > m_BufferSize)
+            return InvalidOffset;
+
+        auto Offset    = InvalidOffset;
+        auto AllocSize = Size;
+        if (Head >= m_RingTail)
+        {
+            // [Tail, Head) is in use
+            if (Head + Size <= m_BufferSize)
+            {
+                Offset = Head;
+            }
+            else if (Size <= m_RingTail)
+            {
+                // Skip the end of the buffer and wrap around
+                Offset = 0;
+                AllocSize += m_BufferSize - Head;
+            }
+        }
+        else
+        {
+            // [Head, Tail) is free
+            if (Head + Size <= m_RingTail)
+                Offset = Head;
+        }
+
+        if (Offset != InvalidOffset)
+        {
+            Head = Offset + Size;
+            m_RingUsedSize += AllocSize;
+            m_CurrFrameSize += AllocSize;
+        }
+
+        return Offset;
+    }
+
+    void ReleaseCompletedFrames()
+    {
+        const auto CompletedValue = m_pFence->GetCompletedValue();
+        while (!m_InFlightFrames.empty() && m_InFlightFrames.front().FenceValue <= CompletedValue)
+        {
+            const auto& Frame = m_InFlightFrames.front();
+            VERIFY_EXPR(m_RingUsedSize >= Frame.Size);
+            m_RingTail = Frame.End;
+            m_RingUsedSize -= Frame.Size;
+            m_InFlightFrames.pop_front();
+        }
+    }
+
+    static constexpr Uint32 InvalidOffset = ~Uint32{0};
+
     bool m_UsePersistentMap = false;
 
     Uint32 m_BufferSize = 0;
@@ -189,6 +376,24 @@ private:
     };
     // We need to keep track of mapped data for every context
     std::vector<MapInfo> m_MapInfo;
+
+    // Fence ring mode. The ring head is the current offset of the first context.
+    RefCntAutoPtr<IFence> m_pFence;
+
+    struct InFlightFrame
+    {
+        Uint64 FenceValue;
+        // Ring head at the end of the frame
+        Uint32 End;
+        // Space used by the frame, including the skipped end of the buffer
+        Uint32 Size;
+    };
+    std::deque<InFlightFrame> m_InFlightFrames;
+
+    Uint64 m_NextFenceValue = 1;
+    Uint32 m_RingTail       = 0;
+    Uint32 m_RingUsedSize   = 0;
+    Uint32 m_CurrFrameSize  = 0;
 };
 
 } // namespace Diligent
@@ -47,10 +47,12 @@ struct UploadBufferDesc
 
     bool operator == (const UploadBufferDesc &rhs) const
     {
-        return Width  == rhs.Width  && 
-                Height == rhs.Height &&
-                Depth  == rhs.Depth  &&
-                Format == rhs.Format;
+        return Width     == rhs.Width     &&
+               Height    == rhs.Height    &&
+               Depth     == rhs.Depth     &&
+               MipLevels == rhs.MipLevels &&
+               ArraySize == rhs.ArraySize &&
+               Format    == rhs.Format;
     }
 };
 // clang-format on
@@ -80,6 +82,10 @@ class ITextureUploader : public IObject
 {
 public:
     /// Executes pending render-thread operations
+
+    /// Copies that have been scheduled by worker threads since the last call are
+    /// recorded as one batch. On D3D12 and Vulkan, the destination textures are transitioned
+    /// with a single barrier call and the uploader signals its fence once per call.
     virtual void RenderThreadUpdate(IDeviceContext* pContext) = 0;
 
 
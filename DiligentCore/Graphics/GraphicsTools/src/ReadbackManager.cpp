@@ -0,0 +1,366 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+#include "ReadbackManager.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GraphicsAccessories.hpp"
+#include "Align.hpp"
+#include "PlatformMisc.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Staging buffers are pooled in power-of-two size buckets
+Uint32 GetStagingBufferSize(Uint32 Size)
+{
+    static constexpr Uint32 MinSize = 256;
+    Size                            = std::max(Size, MinSize);
+    return IsPowerOfTwo(Size) ? Size : Uint32{2} << PlatformMisc::GetMSB(Size);
+}
+
+} // namespace
+
+ReadbackManager::ReadbackManager(IRenderDevice* pDevice, const CreateInfo& CI) :
+    m_CI{CI},
+    m_pDevice{pDevice}
+{
+    FenceDesc fenceDesc;
+    fenceDesc.Name = "Readback manager fence";
+    m_pDevice->CreateFence(fenceDesc, &m_pFence);
+}
+
+ReadbackManager::~ReadbackManager()
+{
+    if (!m_PendingReadbacks.empty())
+    {
+        LOG_WARNING_MESSAGE("ReadbackManager::~ReadbackManager(): ", m_PendingReadbacks.size(),
+                            " pending readback(s) will never complete");
+    }
+}
+
+void ReadbackManager::EnqueueReadback(CompleteReadbackFunc&& Complete)
+{
+    // All readbacks until the next Update() share the same fence value
+    m_FenceSignalRequired = true;
+    m_PendingReadbacks.emplace_back(m_NextFenceValue, std::move(Complete));
+}
+
+RefCntAutoPtr<IBuffer> ReadbackManager::AllocateStagingBuffer(Uint32 Size)
+{
+    const auto StagingSize = GetStagingBufferSize(Size);
+
+    RefCntAutoPtr<IBuffer> pBuffer;
+
+    auto it = m_AvailableBuffers.find(StagingSize);
+    if (it != m_AvailableBuffers.end() && !it->second.empty())
+    {
+        pBuffer = std::move(it->second.back());
+        it->second.pop_back();
+        --m_NumAvailableBuffers;
+    }
+    else
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name           = "Staging buffer for readback";
+        BuffDesc.uiSizeInBytes  = StagingSize;
+        BuffDesc.Usage          = USAGE_STAGING;
+        BuffDesc.CPUAccessFlags = CPU_ACCESS_READ;
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &pBuffer);
+    }
+
+    return pBuffer;
+}
+
+RefCntAutoPtr<ITexture> ReadbackManager::AllocateStagingTexture(Uint32 Width, Uint32 Height, TEXTURE_FORMAT Format)
+{
+    for (auto it = m_AvailableTextures.begin(); it != m_AvailableTextures.end(); ++it)
+    {
+        const auto& TexDesc = (*it)->GetDesc();
+        if (TexDesc.Width == Width && TexDesc.Height == Height && TexDesc.Format == Format)
+        {
+            RefCntAutoPtr<ITexture> pTexture = std::move(*it);
+            m_AvailableTextures.erase(it);
+            return pTexture;
+        }
+    }
+
+    TextureDesc TexDesc;
+    TexDesc.Name           = "Staging texture for readback";
+    TexDesc.Type           = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width          = Width;
+    TexDesc.Height         = Height;
+    TexDesc.Format         = Format;
+    TexDesc.Usage          = USAGE_STAGING;
+    TexDesc.CPUAccessFlags = CPU_ACCESS_READ;
+
+    RefCntAutoPtr<ITexture> pTexture;
+    m_pDevice->CreateTexture(TexDesc, nullptr, &pTexture);
+    return pTexture;
+}
+
+void ReadbackManager::RecycleStagingBuffer(RefCntAutoPtr<IBuffer>&& pBuffer)
+{
+    if (m_NumAvailableBuffers >= m_CI.MaxPooledResources)
+        return;
+
+    m_AvailableBuffers[pBuffer->GetDesc().uiSizeInBytes].emplace_back(std::move(pBuffer));
+    ++m_NumAvailableBuffers;
+}
+
+void ReadbackManager::RecycleStagingTexture(RefCntAutoPtr<ITexture>&& pTexture)
+{
+    // Keep the most recently used textures
+    if (m_CI.MaxPooledResources == 0)
+        return;
+    if (m_AvailableTextures.size() >= m_CI.MaxPooledResources)
+        m_AvailableTextures.erase(m_AvailableTextures.begin());
+
+    m_AvailableTextures.emplace_back(std::move(pTexture));
+}
+
+void ReadbackManager::ReadBuffer(IDeviceContext*                pContext,
+                                 IBuffer*                       pBuffer,
+                                 Uint32                         Offset,
+                                 Uint32                         Size,
+                                 BufferCallback                 Callback,
+                                 RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode)
+{
+    DEV_CHECK_ERR(pBuffer != nullptr, "Buffer must not be null");
+    DEV_CHECK_ERR(Size > 0, "Readback size must not be zero");
+    DEV_CHECK_ERR(Offset + Size <= pBuffer->GetDesc().uiSizeInBytes, "Readback region [", Offset, ", ", Offset + Size,
+                  ") is out of the buffer bounds (", pBuffer->GetDesc().uiSizeInBytes, ")");
+
+    auto pStagingBuffer = AllocateStagingBuffer(Size);
+    if (!pStagingBuffer)
+    {
+        LOG_ERROR_MESSAGE("Failed to create staging buffer for readback");
+        return;
+    }
+
+    pContext->CopyBuffer(pBuffer, Offset, SrcTransitionMode, pStagingBuffer, 0, Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    EnqueueReadback(
+        [this, pStagingBuffer, Size, Callback](IDeviceContext* pCtx) mutable //
+        {
+            PVoid pData = nullptr;
+            pCtx->MapBuffer(pStagingBuffer, MAP_READ, MAP_FLAG_DO_NOT_WAIT, pData);
+            if (pData == nullptr)
+                return false;
+
+            Callback(pData, Size);
+            pCtx->UnmapBuffer(pStagingBuffer, MAP_READ);
+            RecycleStagingBuffer(std::move(pStagingBuffer));
+            return true;
+        });
+}
+
+std::future<std::vector<Uint8>> ReadbackManager::ReadBufferAsync(IDeviceContext*                pContext,
+                                                                 IBuffer*                       pBuffer,
+                                                                 Uint32                         Offset,
+                                                                 Uint32                         Size,
+                                                                 RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode)
+{
+    // std::function requires copyable callables
+    auto pPromise = std::make_shared<std::promise<std::vector<Uint8>>>();
+    auto Future   = pPromise->get_future();
+    ReadBuffer(
+        pContext, pBuffer, Offset, Size,
+        [pPromise](const void* pData, Uint32 DataSize) //
+        {
+            const auto* pBytes = static_cast<const Uint8*>(pData);
+            pPromise->set_value(std::vector<Uint8>{pBytes, pBytes + DataSize});
+        },
+        SrcTransitionMode);
+    return Future;
+}
+
+void ReadbackManager::ReadTexture(IDeviceContext*                pContext,
+                                  ITexture*                      pTexture,
+                                  Uint32                         MipLevel,
+                                  Uint32                         ArraySlice,
+                                  const Box*                     pRegion,
+                                  TextureCallback                Callback,
+                                  RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode)
+{
+    DEV_CHECK_ERR(pTexture != nullptr, "Texture must not be null");
+
+    const auto& TexDesc = pTexture->GetDesc();
+    DEV_CHECK_ERR(TexDesc.Type == RESOURCE_DIM_TEX_2D || TexDesc.Type == RESOURCE_DIM_TEX_2D_ARRAY,
+                  "Only 2D textures and 2D texture arrays can be read back");
+    DEV_CHECK_ERR(GetTextureFormatAttribs(TexDesc.Format).ComponentType != COMPONENT_TYPE_COMPRESSED,
+                  "Compressed textures can't be read back");
+    DEV_CHECK_ERR(MipLevel < TexDesc.MipLevels, "Mip level ", MipLevel, " is out of range");
+    DEV_CHECK_ERR(ArraySlice < TexDesc.ArraySize, "Array slice ", ArraySlice, " is out of range");
+
+    const auto MipProps = GetMipLevelProperties(TexDesc, MipLevel);
+    const Box  SrcBox   = pRegion != nullptr ? *pRegion : Box{0, MipProps.LogicalWidth, 0, MipProps.LogicalHeight};
+    DEV_CHECK_ERR(SrcBox.MaxX > SrcBox.MinX && SrcBox.MaxY > SrcBox.MinY, "Readback region must not be empty");
+    DEV_CHECK_ERR(SrcBox.MaxX <= MipProps.LogicalWidth && SrcBox.MaxY <= MipProps.LogicalHeight,
+                  "Readback region is out of the bounds of mip level ", MipLevel);
+
+    const Uint32 Width  = SrcBox.MaxX - SrcBox.MinX;
+    const Uint32 Height = SrcBox.MaxY - SrcBox.MinY;
+
+    auto pStagingTexture = AllocateStagingTexture(Width, Height, TexDesc.Format);
+    if (!pStagingTexture)
+    {
+        LOG_ERROR_MESSAGE("Failed to create staging texture for readback");
+        return;
+    }
+
+    CopyTextureAttribs CopyAttribs{pTexture, SrcTransitionMode, pStagingTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+    CopyAttribs.SrcMipLevel = MipLevel;
+    CopyAttribs.SrcSlice    = ArraySlice;
+    CopyAttribs.pSrcBox     = &SrcBox;
+    pContext->CopyTexture(CopyAttribs);
+
+    EnqueueReadback(
+        [this, pStagingTexture, Width, Height, Callback](IDeviceContext* pCtx) mutable //
+        {
+            MappedTextureSubresource MappedData;
+            pCtx->MapTextureSubresource(pStagingTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+            if (MappedData.pData == nullptr)
+                return false;
+
+            Callback(MappedData, Width, Height);
+            pCtx->UnmapTextureSubresource(pStagingTexture, 0, 0);
+            RecycleStagingTexture(std::move(pStagingTexture));
+            return true;
+        });
+}
+
+std::future<ReadbackManager::TextureData> ReadbackManager::ReadTextureAsync(IDeviceContext*                pContext,
+                                                                            ITexture*                      pTexture,
+                                                                            Uint32                         MipLevel,
+                                                                            Uint32                         ArraySlice,
+                                                                            const Box*                     pRegion,
+                                                                            RESOURCE_STATE_TRANSITION_MODE SrcTransitionMode)
+{
+    const auto& FmtAttribs = GetTextureFormatAttribs(pTexture->GetDesc().Format);
+    const auto  TexelSize  = Uint32{FmtAttribs.ComponentSize} * Uint32{FmtAttribs.NumComponents};
+    const auto  Format     = pTexture->GetDesc().Format;
+
+    auto pPromise = std::make_shared<std::promise<TextureData>>();
+    auto Future   = pPromise->get_future();
+    ReadTexture(
+        pContext, pTexture, MipLevel, ArraySlice, pRegion,
+        [pPromise, TexelSize, Format](const MappedTextureSubresource& MappedData, Uint32 Width, Uint32 Height) //
+        {
+            TextureData Data;
+            Data.Width   = Width;
+            Data.Height  = Height;
+            Data.RowSize = Width * TexelSize;
+            Data.Format  = Format;
+            Data.Data.resize(size_t{Data.RowSize} * Height);
+            for (Uint32 Row = 0; Row < Height; ++Row)
+            {
+                memcpy(&Data.Data[size_t{Row} * Data.RowSize],
+                       static_cast<const Uint8*>(MappedData.pData) + size_t{Row} * MappedData.Stride,
+                       Data.RowSize);
+            }
+            pPromise->set_value(std::move(Data));
+        },
+        SrcTransitionMode);
+    return Future;
+}
+
+void ReadbackManager::ReadDuration(IQuery* pStartTimestamp, IQuery* pEndTimestamp, std::function<void(double Duration)> Callback)
+{
+    RefCntAutoPtr<IQuery> pStart{pStartTimestamp};
+    RefCntAutoPtr<IQuery> pEnd{pEndTimestamp};
+    EnqueueReadback(
+        [pStart, pEnd, Callback](IDeviceContext*) mutable //
+        {
+            // Do not invalidate the start query until the end timestamp is also available
+            QueryDataTimestamp StartData;
+            if (!pStart->GetData(&StartData, sizeof(StartData), false))
+                return false;
+
+            QueryDataTimestamp EndData;
+            if (!pEnd->GetData(&EndData, sizeof(EndData)))
+                return false;
+            pStart->Invalidate();
+
+            Callback(static_cast<double>(EndData.Counter) / static_cast<double>(EndData.Frequency) -
+                     static_cast<double>(StartData.Counter) / static_cast<double>(StartData.Frequency));
+            return true;
+        });
+}
+
+void ReadbackManager::Update(IDeviceContext* pContext)
+{
+    if (m_FenceSignalRequired)
+    {
+        pContext->SignalFence(m_pFence, m_NextFenceValue++);
+        m_FenceSignalRequired = false;
+    }
+
+    if (m_PendingReadbacks.empty())
+        return;
+
+    const auto CompletedFenceValue = m_pFence->GetCompletedValue();
+
+    // Callbacks may request new readbacks, so process a separate queue
+    std::deque<PendingReadback> Readbacks;
+    Readbacks.swap(m_PendingReadbacks);
+
+    // Readbacks whose data is not available yet are retried by the next Update()
+    auto DstIt = Readbacks.begin();
+    for (auto SrcIt = Readbacks.begin(); SrcIt != Readbacks.end(); ++SrcIt)
+    {
+        if (SrcIt->FenceValue <= CompletedFenceValue && SrcIt->Complete(pContext))
+            continue;
+
+        if (DstIt != SrcIt)
+            *DstIt = std::move(*SrcIt);
+        ++DstIt;
+    }
+    Readbacks.erase(DstIt, Readbacks.end());
+
+    for (auto& Readback : m_PendingReadbacks)
+        Readbacks.emplace_back(std::move(Readback));
+    m_PendingReadbacks.swap(Readbacks);
+}
+
+void ReadbackManager::WaitForIdle(IDeviceContext* pContext)
+{
+    const auto LastFenceValue = m_FenceSignalRequired ? m_NextFenceValue : m_NextFenceValue - 1;
+    Update(pContext);
+    pContext->WaitForFence(m_pFence, LastFenceValue, true);
+    // Query data or staging maps may still not be available right after the fence
+    while (!m_PendingReadbacks.empty())
+        Update(pContext);
+}
+
+} // namespace Diligent
@@ -27,11 +27,16 @@
 
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <deque>
 #include <vector>
+#include <algorithm>
 
 #include "TextureUploaderD3D12_Vk.hpp"
 #include "ThreadSignal.hpp"
+#include "MPSCQueue.hpp"
+#include "Align.hpp"
+#include "PlatformMisc.hpp"
 #include "GraphicsAccessories.hpp"
 
 namespace Diligent
@@ -45,9 +50,11 @@ class UploadTexture : public UploadBufferBase
 public:
     UploadTexture(IReferenceCounters*     pRefCounters,
                   const UploadBufferDesc& Desc,
+                  const UploadBufferDesc& StagingDesc,
                   ITexture*               pStagingTexture) :
         // clang-format off
         UploadBufferBase {pRefCounters, Desc},
+        m_StagingDesc    {StagingDesc},
         m_pStagingTexture{pStagingTexture}
     // clang-format on
     {
@@ -95,6 +102,18 @@ public:
         SetMappedData(Mip, Slice, MappedData);
     }
 
+    void MapAll(IDeviceContext* pDeviceContext)
+    {
+        for (Uint32 Slice = 0; Slice < m_Desc.ArraySize; ++Slice)
+        {
+            for (Uint32 Mip = 0; Mip < m_Desc.MipLevels; ++Mip)
+            {
+                Map(pDeviceContext, Mip, Slice);
+            }
+        }
+        SignalMapped();
+    }
+
     void Reset()
     {
         m_CopyScheduledSignal.Reset();
@@ -103,6 +122,15 @@ public:
         UploadBufferBase::Reset();
     }
 
+    // Staging textures are shared by all sizes that round up to the same power of two,
+    // so a recycled texture takes the size of the new request.
+    void SetDesc(const UploadBufferDesc& Desc)
+    {
+        VERIFY_EXPR(Desc.MipLevels == m_Desc.MipLevels && Desc.ArraySize == m_Desc.ArraySize);
+        VERIFY_EXPR(Desc.Width <= m_StagingDesc.Width && Desc.Height <= m_StagingDesc.Height);
+        m_Desc = Desc;
+    }
+
     virtual void WaitForCopyScheduled() override final
     {
         m_CopyScheduledSignal.Wait();
@@ -110,6 +138,8 @@ public:
 
     ITexture* GetStagingTexture() { return m_pStagingTexture; }
 
+    const UploadBufferDesc& GetStagingDesc() const { return m_StagingDesc; }
+
     bool DbgIsCopyScheduled() const
     {
         return m_CopyScheduledSignal.IsTriggered();
@@ -130,10 +160,32 @@ private:
     ThreadingTools::Signal m_CopyScheduledSignal;
     ThreadingTools::Signal m_TextureMappedSignal;
 
+    const UploadBufferDesc  m_StagingDesc;
     RefCntAutoPtr<ITexture> m_pStagingTexture;
     Uint64                  m_CopyScheduledFenceValue = 0;
 };
 
+Uint32 RoundUpToPowerOfTwo(Uint32 Val)
+{
+    return IsPowerOfTwo(Val) ? Val : Uint32{2} << PlatformMisc::GetMSB(Val);
+}
+
+// Returns the description of the staging texture that is used for the upload buffer.
+// Staging textures are pooled in power-of-two size buckets, so that uploads of many
+// slightly different sizes share the same textures.
+UploadBufferDesc GetStagingTextureDesc(const UploadBufferDesc& Desc)
+{
+    UploadBufferDesc StagingDesc = Desc;
+    // Copy regions of compressed textures must be aligned to the block size, which
+    // the smallest mip levels of the requested size may not be.
+    if (GetTextureFormatAttribs(Desc.Format).ComponentType != COMPONENT_TYPE_COMPRESSED)
+    {
+        StagingDesc.Width  = RoundUpToPowerOfTwo(Desc.Width);
+        StagingDesc.Height = RoundUpToPowerOfTwo(Desc.Height);
+    }
+    return StagingDesc;
+}
+
 } // namespace
 
 
@@ -145,13 +197,14 @@ struct TextureUploaderD3D12_Vk::InternalData
         {
             Copy,
             Map
-        } operation;
+        } operation = Map;
         RefCntAutoPtr<UploadTexture> pUploadTexture;
         RefCntAutoPtr<ITexture>      pDstTexture;
         Uint32                       DstSlice = 0;
         Uint32                       DstMip   = 0;
 
         // clang-format off
+        PendingBufferOperation() = default;
         PendingBufferOperation(Operation op, UploadTexture* pUploadTex) :
             operation     {op        },
             pUploadTexture{pUploadTex}
@@ -175,71 +228,112 @@ struct TextureUploaderD3D12_Vk::InternalData
 
     ~InternalData()
     {
-        for (auto it : m_UploadTexturesCache)
+        std::unordered_map<UploadBufferDesc, Uint32> NumTextures;
+        for (auto& it : m_UploadTexturePool)
         {
-            if (it.second.size())
+            for (auto& pUploadTex : it.second)
             {
-                const auto& desc    = it.first;
-                auto&       FmtInfo = GetTextureFormatAttribs(desc.Format);
-                LOG_INFO_MESSAGE("TextureUploaderD3D12_Vk: releasing ", it.second.size(), ' ',
-                                 desc.Width, 'x', desc.Height, 'x', desc.Depth, ' ', FmtInfo.Name,
-                                 " upload buffer(s)", (it.second.size() == 1 ? "" : "s"));
+                // Pooled textures stay mapped between uploads and there is no context to unmap them here.
+                // D3D12 resources and Vulkan host-visible memory may be released while mapped.
+                pUploadTex->UploadBufferBase::Reset();
             }
+            NumTextures[it.first] += static_cast<Uint32>(it.second.size());
+        }
+        for (auto& pUploadTex : m_RecycledTextures)
+            ++NumTextures[pUploadTex->GetStagingDesc()];
+
+        for (const auto& it : NumTextures)
+        {
+            const auto& desc    = it.first;
+            auto&       FmtInfo = GetTextureFormatAttribs(desc.Format);
+            LOG_INFO_MESSAGE("TextureUploaderD3D12_Vk: releasing ", it.second, ' ',
+                             desc.Width, 'x', desc.Height, 'x', desc.Depth, ' ', FmtInfo.Name,
+                             " upload buffer", (it.second == 1 ? "" : "s"));
         }
     }
 
-    std::vector<PendingBufferOperation>& SwapMapQueues()
+    // Moves the operations that have been enqueued so far to the in-work list.
+    // Only the render thread dequeues operations.
+    std::vector<PendingBufferOperation>& DequeueOperations()
     {
-        std::lock_guard<std::mutex> QueueLock(m_PendingOperationsMtx);
-        m_PendingOperations.swap(m_InWorkOperations);
+        // Operations enqueued while the queue is drained are executed in the next update
+        auto NumOperations = m_PendingOperations.GetSize();
+        m_InWorkOperations.reserve(NumOperations);
+        PendingBufferOperation Operation;
+        while (NumOperations-- > 0 && m_PendingOperations.Pop(Operation))
+            m_InWorkOperations.emplace_back(std::move(Operation));
         return m_InWorkOperations;
     }
 
     void EnqueCopy(UploadTexture* pUploadBuffer, ITexture* pDstTex, Uint32 dstSlice, Uint32 dstMip)
     {
-        std::lock_guard<std::mutex> QueueLock(m_PendingOperationsMtx);
-        m_PendingOperations.emplace_back(PendingBufferOperation::Operation::Copy, pUploadBuffer, pDstTex, dstSlice, dstMip);
+        m_PendingOperations.Push(PendingBufferOperation{PendingBufferOperation::Operation::Copy, pUploadBuffer, pDstTex, dstSlice, dstMip});
     }
 
     void EnqueMap(UploadTexture* pUploadBuffer)
     {
-        std::lock_guard<std::mutex> QueueLock(m_PendingOperationsMtx);
-        m_PendingOperations.emplace_back(PendingBufferOperation::Operation::Map, pUploadBuffer);
+        m_PendingOperations.Push(PendingBufferOperation{PendingBufferOperation::Operation::Map, pUploadBuffer});
+    }
+
+    // Returns the fence value that will be signaled after the copies recorded so far.
+    // Fences can't be accessed from multiple threads simultaneously even when protected
+    // by mutex, so this and the following methods must only be called by the render thread.
+    Uint64 GetCopyFenceValue()
+    {
+        m_FenceSignalRequired = true;
+        return m_NextFenceValue;
     }
 
-    Uint64 SignalFence(IDeviceContext* pContext)
+    // Signals the fence once for all copies recorded since the last call.
+    void SignalFence(IDeviceContext* pContext)
     {
-        // Fences can't be accessed from multiple threads simultaneously even
-        // when protected by mutex
-        auto FenceValue = m_NextFenceValue++;
-        pContext->SignalFence(m_pFence, FenceValue);
-        return FenceValue;
+        if (m_FenceSignalRequired)
+        {
+            pContext->SignalFence(m_pFence, m_NextFenceValue++);
+            m_FenceSignalRequired = false;
+        }
     }
 
     void UpdatedCompletedFenceValue()
     {
-        // Fences can't be accessed from multiple threads simultaneously even
-        // when protected by mutex
         m_CompletedFenceValue = m_pFence->GetCompletedValue();
     }
 
-    RefCntAutoPtr<UploadTexture> FindCachedUploadTexture(const UploadBufferDesc& Desc)
+    // Maps the recycled textures whose copies have completed and makes them available
+    // for new uploads, so that worker threads don't have to wait for the render thread.
+    void RefillPool(IDeviceContext* pContext)
+    {
+        std::lock_guard<std::mutex> PoolLock{m_UploadTexturePoolMtx};
+
+        auto ReadyEnd = std::stable_partition(m_RecycledTextures.begin(), m_RecycledTextures.end(),
+                                              [this](const RefCntAutoPtr<UploadTexture>& pUploadTex) //
+                                              {
+                                                  return pUploadTex->GetCopyScheduledFenceValue() <= m_CompletedFenceValue;
+                                              });
+        for (auto it = m_RecycledTextures.begin(); it != ReadyEnd; ++it)
+        {
+            auto& pUploadTex = *it;
+            pUploadTex->Reset();
+            pUploadTex->MapAll(pContext);
+            m_UploadTexturePool[pUploadTex->GetStagingDesc()].emplace_back(std::move(pUploadTex));
+        }
+        m_RecycledTextures.erase(m_RecycledTextures.begin(), ReadyEnd);
+    }
+
+    // Returns a mapped texture from the pool
+    RefCntAutoPtr<UploadTexture> FindPooledUploadTexture(const UploadBufferDesc& StagingDesc)
     {
         RefCntAutoPtr<UploadTexture> pUploadTexture;
-        std::lock_guard<std::mutex>  CacheLock(m_UploadTexturesCacheMtx);
-        auto                         DequeIt = m_UploadTexturesCache.find(Desc);
-        if (DequeIt != m_UploadTexturesCache.end())
+        std::lock_guard<std::mutex>  PoolLock{m_UploadTexturePoolMtx};
+
+        auto DequeIt = m_UploadTexturePool.find(StagingDesc);
+        if (DequeIt != m_UploadTexturePool.end())
         {
             auto& Deque = DequeIt->second;
             if (!Deque.empty())
             {
-                auto& FrontBuff = Deque.front();
-                if (FrontBuff->GetCopyScheduledFenceValue() <= m_CompletedFenceValue)
-                {
-                    pUploadTexture = std::move(FrontBuff);
-                    Deque.pop_front();
-                    pUploadTexture->Reset();
-                }
+                pUploadTexture = std::move(Deque.front());
+                Deque.pop_front();
             }
         }
 
@@ -248,30 +342,35 @@ struct TextureUploaderD3D12_Vk::InternalData
 
     void RecycleUploadTexture(UploadTexture* pUploadTexture)
     {
-        std::lock_guard<std::mutex> CacheLock(m_UploadTexturesCacheMtx);
-        auto&                       Deque = m_UploadTexturesCache[pUploadTexture->GetDesc()];
-        Deque.emplace_back(pUploadTexture);
+        std::lock_guard<std::mutex> PoolLock{m_UploadTexturePoolMtx};
+        m_RecycledTextures.emplace_back(pUploadTexture);
     }
 
-    Uint32 GetNumPendingOperations()
+    Uint32 GetNumPendingOperations() const
     {
-        std::lock_guard<std::mutex> QueueLock(m_PendingOperationsMtx);
-        return static_cast<Uint32>(m_PendingOperations.size());
+        return m_PendingOperations.GetSize();
     }
 
-    void Execute(IDeviceContext* pContext, PendingBufferOperation& OperationInfo);
+    void ExecuteCopies(IDeviceContext* pContext, PendingBufferOperation* pOperations, size_t NumOperations);
 
 private:
-    std::mutex                          m_PendingOperationsMtx;
-    std::vector<PendingBufferOperation> m_PendingOperations;
+    MPSCQueue<PendingBufferOperation>   m_PendingOperations;
     std::vector<PendingBufferOperation> m_InWorkOperations;
 
-    std::mutex                                                                     m_UploadTexturesCacheMtx;
-    std::unordered_map<UploadBufferDesc, std::deque<RefCntAutoPtr<UploadTexture>>> m_UploadTexturesCache;
+    // Destination textures of the current copy batch and the barriers that transition them
+    std::unordered_set<ITexture*>    m_BatchDstTextures;
+    std::vector<StateTransitionDesc> m_BatchBarriers;
+
+    std::mutex m_UploadTexturePoolMtx;
+    // Mapped textures that are ready to be used, keyed by the staging texture description
+    std::unordered_map<UploadBufferDesc, std::deque<RefCntAutoPtr<UploadTexture>>> m_UploadTexturePool;
+    // Textures that may still be used by the GPU
+    std::vector<RefCntAutoPtr<UploadTexture>> m_RecycledTextures;
 
     RefCntAutoPtr<IFence> m_pFence;
     Uint64                m_NextFenceValue      = 1;
     Uint64                m_CompletedFenceValue = 0;
+    bool                  m_FenceSignalRequired = false;
 };
 
 TextureUploaderD3D12_Vk::TextureUploaderD3D12_Vk(IReferenceCounters* pRefCounters, IRenderDevice* pDevice, const TextureUploaderDesc Desc) :
@@ -294,84 +393,100 @@ TextureUploaderD3D12_Vk::~TextureUploaderD3D12_Vk()
 
 void TextureUploaderD3D12_Vk::RenderThreadUpdate(IDeviceContext* pContext)
 {
-    auto& InWorkOperations = m_pInternalData->SwapMapQueues();
+    using PendingBufferOperation = InternalData::PendingBufferOperation;
+
+    auto& InWorkOperations = m_pInternalData->DequeueOperations();
     if (!InWorkOperations.empty())
     {
-        Uint32 NumCopyOperations = 0;
-        for (auto& OperationInfo : InWorkOperations)
-        {
-            m_pInternalData->Execute(pContext, OperationInfo);
-            if (OperationInfo.operation == InternalData::PendingBufferOperation::Copy)
-                ++NumCopyOperations;
-        }
-
+        // Copies go after all maps so that they can be recorded as one batch.
+        // The relative order of the copies is preserved.
+        auto CopiesBegin = std::stable_partition(InWorkOperations.begin(), InWorkOperations.end(),
+                                                 [](const PendingBufferOperation& OperationInfo) //
+                                                 {
+                                                     return OperationInfo.operation == PendingBufferOperation::Map;
+                                                 });
+        for (auto it = InWorkOperations.begin(); it != CopiesBegin; ++it)
+            it->pUploadTexture->MapAll(pContext);
+
+        const auto NumCopyOperations = static_cast<size_t>(InWorkOperations.end() - CopiesBegin);
         if (NumCopyOperations > 0)
         {
-            // The buffer may be recycled immediately after the copy scheduled is signaled,
-            // so we must signal the fence first.
-            auto SignaledFenceValue = m_pInternalData->SignalFence(pContext);
+            m_pInternalData->ExecuteCopies(pContext, &*CopiesBegin, NumCopyOperations);
 
-            for (auto& OperationInfo : InWorkOperations)
-            {
-                if (OperationInfo.operation == InternalData::PendingBufferOperation::Copy)
-                    OperationInfo.pUploadTexture->SignalCopyScheduled(SignaledFenceValue);
-            }
+            // The buffers are only reused after the fence value is completed,
+            // see InternalData::RefillPool().
+            const auto FenceValue = m_pInternalData->GetCopyFenceValue();
+            for (auto it = CopiesBegin; it != InWorkOperations.end(); ++it)
+                it->pUploadTexture->SignalCopyScheduled(FenceValue);
         }
 
         InWorkOperations.clear();
     }
 
+    // Signal the fence once for all copies of this update and the copies
+    // that have been scheduled by the render thread since the last update.
+    m_pInternalData->SignalFence(pContext);
     // This must be called by the same thread that signals the fence
     m_pInternalData->UpdatedCompletedFenceValue();
+    m_pInternalData->RefillPool(pContext);
 }
 
 
-void TextureUploaderD3D12_Vk::InternalData::Execute(IDeviceContext*         pContext,
-                                                    PendingBufferOperation& OperationInfo)
+void TextureUploaderD3D12_Vk::InternalData::ExecuteCopies(IDeviceContext*         pContext,
+                                                          PendingBufferOperation* pOperations,
+                                                          size_t                  NumOperations)
 {
-    auto&       pUploadTex     = OperationInfo.pUploadTexture;
-    const auto& StagingTexDesc = pUploadTex->GetDesc();
+    // Transition all destination textures with a single barrier batch rather than
+    // one barrier per copy. Textures with untracked state are transitioned by the user.
+    for (size_t i = 0; i < NumOperations; ++i)
+    {
+        auto* pDstTexture = pOperations[i].pDstTexture.RawPtr();
+
+        const auto State = pDstTexture->GetState();
+        if (State != RESOURCE_STATE_UNKNOWN && State != RESOURCE_STATE_COPY_DEST && m_BatchDstTextures.insert(pDstTexture).second)
+            m_BatchBarriers.emplace_back(pDstTexture, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_COPY_DEST, true);
+    }
+    if (!m_BatchBarriers.empty())
+        pContext->TransitionResourceStates(static_cast<Uint32>(m_BatchBarriers.size()), m_BatchBarriers.data());
+    m_BatchBarriers.clear();
+    m_BatchDstTextures.clear();
 
-    switch (OperationInfo.operation)
+    for (size_t i = 0; i < NumOperations; ++i)
     {
-        case InternalData::PendingBufferOperation::Map:
-        {
-            for (Uint32 Slice = 0; Slice < StagingTexDesc.ArraySize; ++Slice)
-            {
-                for (Uint32 Mip = 0; Mip < StagingTexDesc.MipLevels; ++Mip)
-                {
-                    pUploadTex->Map(pContext, Mip, Slice);
-                }
-            }
-            pUploadTex->SignalMapped();
-        }
-        break;
+        auto& OperationInfo = pOperations[i];
+        VERIFY_EXPR(OperationInfo.operation == PendingBufferOperation::Copy);
+
+        auto*       pUploadTex  = OperationInfo.pUploadTexture.RawPtr();
+        const auto& Desc        = pUploadTex->GetDesc();
+        const auto& StagingDesc = pUploadTex->GetStagingDesc();
+        VERIFY(pUploadTex->DbgIsMapped(), "Upload texture must be copied only after it has been mapped");
 
-        case InternalData::PendingBufferOperation::Copy:
+        for (Uint32 Slice = 0; Slice < Desc.ArraySize; ++Slice)
         {
-            VERIFY(pUploadTex->DbgIsMapped(), "Upload texture must be copied only after it has been mapped");
-            for (Uint32 Slice = 0; Slice < StagingTexDesc.ArraySize; ++Slice)
+            for (Uint32 Mip = 0; Mip < Desc.MipLevels; ++Mip)
             {
-                for (Uint32 Mip = 0; Mip < StagingTexDesc.MipLevels; ++Mip)
-                {
-                    pUploadTex->Unmap(pContext, Mip, Slice);
-
-                    CopyTextureAttribs CopyInfo //
-                        {
-                            pUploadTex->GetStagingTexture(),
-                            RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
-                            OperationInfo.pDstTexture,
-                            RESOURCE_STATE_TRANSITION_MODE_TRANSITION //
-                        };
-                    CopyInfo.SrcMipLevel = Mip;
-                    CopyInfo.SrcSlice    = Slice;
-                    CopyInfo.DstMipLevel = OperationInfo.DstMip + Mip;
-                    CopyInfo.DstSlice    = OperationInfo.DstSlice + Slice;
-                    pContext->CopyTexture(CopyInfo);
-                }
+                pUploadTex->Unmap(pContext, Mip, Slice);
+
+                CopyTextureAttribs CopyInfo //
+                    {
+                        pUploadTex->GetStagingTexture(),
+                        RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                        OperationInfo.pDstTexture,
+                        RESOURCE_STATE_TRANSITION_MODE_TRANSITION //
+                    };
+                CopyInfo.SrcMipLevel = Mip;
+                CopyInfo.SrcSlice    = Slice;
+                CopyInfo.DstMipLevel = OperationInfo.DstMip + Mip;
+                CopyInfo.DstSlice    = OperationInfo.DstSlice + Slice;
+
+                // The staging texture may be larger than the requested size
+                Box SrcBox{0, std::max(Desc.Width >> Mip, 1u), 0, std::max(Desc.Height >> Mip, 1u)};
+                if (Desc.Width != StagingDesc.Width || Desc.Height != StagingDesc.Height)
+                    CopyInfo.pSrcBox = &SrcBox;
+
+                pContext->CopyTexture(CopyInfo);
             }
         }
-        break;
     }
 }
 
@@ -379,43 +494,49 @@ void TextureUploaderD3D12_Vk::AllocateUploadBuffer(IDeviceContext*         pCont
                                                    const UploadBufferDesc& Desc,
                                                    IUploadBuffer**         ppBuffer)
 {
-    RefCntAutoPtr<UploadTexture> pUploadTexture = m_pInternalData->FindCachedUploadTexture(Desc);
+    const auto StagingDesc = GetStagingTextureDesc(Desc);
 
-    // No available buffer found in the cache
-    if (!pUploadTexture)
+    // Pooled textures are already mapped by the render thread
+    RefCntAutoPtr<UploadTexture> pUploadTexture = m_pInternalData->FindPooledUploadTexture(StagingDesc);
+    if (pUploadTexture)
     {
+        pUploadTexture->SetDesc(Desc);
+    }
+    else
+    {
+        // No available buffer found in the pool
         TextureDesc StagingTexDesc;
-        StagingTexDesc.Type           = Desc.ArraySize == 1 ? RESOURCE_DIM_TEX_2D : RESOURCE_DIM_TEX_2D_ARRAY;
-        StagingTexDesc.Width          = Desc.Width;
-        StagingTexDesc.Height         = Desc.Height;
-        StagingTexDesc.Format         = Desc.Format;
-        StagingTexDesc.MipLevels      = Desc.MipLevels;
-        StagingTexDesc.ArraySize      = Desc.ArraySize;
+        StagingTexDesc.Type           = StagingDesc.ArraySize == 1 ? RESOURCE_DIM_TEX_2D : RESOURCE_DIM_TEX_2D_ARRAY;
+        StagingTexDesc.Width          = StagingDesc.Width;
+        StagingTexDesc.Height         = StagingDesc.Height;
+        StagingTexDesc.Format         = StagingDesc.Format;
+        StagingTexDesc.MipLevels      = StagingDesc.MipLevels;
+        StagingTexDesc.ArraySize      = StagingDesc.ArraySize;
         StagingTexDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
         StagingTexDesc.Usage          = USAGE_STAGING;
 
         RefCntAutoPtr<ITexture> pStagingTexture;
         m_pDevice->CreateTexture(StagingTexDesc, nullptr, &pStagingTexture);
 
-        LOG_INFO_MESSAGE("Created ", Desc.Width, "x", Desc.Height, 'x', Desc.Depth, ' ', Desc.MipLevels, "-mip ",
-                         Desc.ArraySize, "-slice ",
-                         GetTextureFormatAttribs(Desc.Format).Name, " staging texture");
+        LOG_INFO_MESSAGE("Created ", StagingDesc.Width, "x", StagingDesc.Height, 'x', StagingDesc.Depth, ' ', StagingDesc.MipLevels, "-mip ",
+                         StagingDesc.ArraySize, "-slice ",
+                         GetTextureFormatAttribs(StagingDesc.Format).Name, " staging texture");
 
-        pUploadTexture = MakeNewRCObj<UploadTexture>()(Desc, pStagingTexture);
-    }
+        pUploadTexture = MakeNewRCObj<UploadTexture>()(Desc, StagingDesc, pStagingTexture);
 
-    if (pContext != nullptr)
-    {
-        // Render thread
-        InternalData::PendingBufferOperation MapOp{InternalData::PendingBufferOperation::Operation::Map, pUploadTexture};
-        m_pInternalData->Execute(pContext, MapOp);
-    }
-    else
-    {
-        // Worker thread
-        m_pInternalData->EnqueMap(pUploadTexture);
-        pUploadTexture->WaitForMap();
+        if (pContext != nullptr)
+        {
+            // Render thread
+            pUploadTexture->MapAll(pContext);
+        }
+        else
+        {
+            // Worker thread
+            m_pInternalData->EnqueMap(pUploadTexture);
+            pUploadTexture->WaitForMap();
+        }
     }
+
     *ppBuffer = pUploadTexture.Detach();
 }
 
@@ -437,14 +558,11 @@ void TextureUploaderD3D12_Vk::ScheduleGPUCopy(IDeviceContext* pContext,
                 ArraySlice,
                 MipLevel //
             };
-        m_pInternalData->Execute(pContext, CopyOp);
+        m_pInternalData->ExecuteCopies(pContext, &CopyOp, 1);
 
-        // The buffer may be recycled immediately after the copy scheduled is signaled,
-        // so we must signal the fence first.
-        auto SignaledFenceValue = m_pInternalData->SignalFence(pContext);
-        pUploadTexture->SignalCopyScheduled(SignaledFenceValue);
-        // This must be called by the same thread that signals the fence
-        m_pInternalData->UpdatedCompletedFenceValue();
+        // The fence is signaled by the next RenderThreadUpdate() together with other copies.
+        // The buffer is not reused until then.
+        pUploadTexture->SignalCopyScheduled(m_pInternalData->GetCopyFenceValue());
     }
     else
     {
@@ -464,7 +582,7 @@ void TextureUploaderD3D12_Vk::RecycleBuffer(IUploadBuffer* pUploadBuffer)
 TextureUploaderStats TextureUploaderD3D12_Vk::GetStats()
 {
     TextureUploaderStats Stats;
-    Stats.NumPendingOperations = static_cast<Uint32>(m_pInternalData->GetNumPendingOperations());
+    Stats.NumPendingOperations = m_pInternalData->GetNumPendingOperations();
     return Stats;
 }
 
@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <cstdio>
 #include <CoreFoundation/CoreFoundation.h>
 
@@ -119,14 +120,22 @@ bool AppleFileSystem::FileExists(const Diligent::Char* strFilePath)
 
 bool AppleFileSystem::PathExists(const Diligent::Char* strPath)
 {
-    UNSUPPORTED("Not implemented");
-    return false;
+    struct stat Info;
+    return stat(strPath, &Info) == 0;
 }
 
 bool AppleFileSystem::CreateDirectory(const Diligent::Char* strPath)
 {
-    UNSUPPORTED("Not implemented");
-    return false;
+    // Create all intermediate directories
+    Diligent::String Path{strPath};
+    for (size_t Pos = Path.find('/', 1); Pos != Diligent::String::npos; Pos = Path.find('/', Pos + 1))
+    {
+        Path[Pos] = '\0';
+        if (!PathExists(Path.c_str()) && mkdir(Path.c_str(), 0755) != 0)
+            return false;
+        Path[Pos] = '/';
+    }
+    return PathExists(Path.c_str()) || mkdir(Path.c_str(), 0755) == 0;
 }
 
 void AppleFileSystem::ClearDirectory(const Diligent::Char* strPath)
@@ -0,0 +1,127 @@
+/*     Copyright 2015-2018 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT OF ANY PROPRIETARY RIGHTS.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../../../Primitives/interface/DataBlob.h"
+#include "../../../Common/interface/ObjectBase.hpp"
+#include "../../../Common/interface/RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+/// Data blob that maps a file into memory instead of reading it.
+
+/// The pages are mapped copy-on-write, so the blob may be modified without affecting the file.
+/// The contents are only read from the disk when they are accessed, which avoids reading large
+/// files into a transient buffer, e.g. when pre-compressed textures are uploaded directly from the file.
+///
+/// \note  The file must not be truncated while it is mapped.
+class LinuxMappedFileBlob final : public ObjectBase<IDataBlob>
+{
+public:
+    using TBase = ObjectBase<IDataBlob>;
+
+    /// Maps the file into memory.
+
+    /// \param [in]  strFilePath - Path to the file.
+    /// \param [out] ppBlob      - Address of the memory location where the pointer to the blob
+    ///                            will be written. Null is written if the file can't be mapped.
+    static void Create(const Char* strFilePath, IDataBlob** ppBlob)
+    {
+        VERIFY_EXPR(ppBlob != nullptr && *ppBlob == nullptr);
+
+        int fd = open(strFilePath, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        struct stat Info;
+        if (fstat(fd, &Info) != 0 || !S_ISREG(Info.st_mode) || Info.st_size <= 0)
+        {
+            // Empty files can't be mapped
+            close(fd);
+            return;
+        }
+
+        const auto Size  = static_cast<size_t>(Info.st_size);
+        auto*      pData = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        // The mapping keeps a reference to the file
+        close(fd);
+        if (pData == MAP_FAILED)
+            return;
+
+        // Texture files are typically read once from start to end
+        madvise(pData, Size, MADV_SEQUENTIAL);
+
+        RefCntAutoPtr<LinuxMappedFileBlob> pBlob{MakeNewRCObj<LinuxMappedFileBlob>()(pData, Size)};
+        *ppBlob = pBlob.Detach();
+    }
+
+    LinuxMappedFileBlob(IReferenceCounters* pRefCounters, void* pData, size_t Size) :
+        TBase{pRefCounters},
+        m_pData{pData},
+        m_Size{Size}
+    {}
+
+    ~LinuxMappedFileBlob()
+    {
+        munmap(m_pData, m_Size);
+    }
+
+    IMPLEMENT_QUERY_INTERFACE_IN_PLACE(IID_DataBlob, TBase)
+
+    /// The size of the mapping can't be changed
+    virtual void DILIGENT_CALL_TYPE Resize(size_t NewSize) override
+    {
+        UNSUPPORTED("Mapped file blob can't be resized");
+    }
+
+    /// Returns the size of the file
+    virtual size_t DILIGENT_CALL_TYPE GetSize() const override
+    {
+        return m_Size;
+    }
+
+    /// Returns the pointer to the mapped file contents
+    virtual void* DILIGENT_CALL_TYPE GetDataPtr() override
+    {
+        return m_pData;
+    }
+
+    /// Returns const pointer to the mapped file contents
+    virtual const void* DILIGENT_CALL_TYPE GetConstDataPtr() const override
+    {
+        return m_pData;
+    }
+
+private:
+    void* const  m_pData;
+    const size_t m_Size;
+};
+
+} // namespace Diligent
@@ -0,0 +1,211 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include <array>
+
+#include "ReadbackManager.hpp"
+#include "TestingEnvironment.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+using namespace Diligent::Testing;
+
+namespace
+{
+
+TEST(ReadbackManagerTest, ReadBuffer)
+{
+    auto* pEnv     = TestingEnvironment::GetInstance();
+    auto* pDevice  = pEnv->GetDevice();
+    auto* pContext = pEnv->GetDeviceContext();
+
+    TestingEnvironment::ScopedReset EnvironmentAutoReset;
+
+    std::array<Uint32, 64> RefData;
+    for (Uint32 i = 0; i < RefData.size(); ++i)
+        RefData[i] = i * 3 + 1;
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name          = "Readback test buffer";
+    BuffDesc.Usage         = USAGE_DEFAULT;
+    BuffDesc.uiSizeInBytes = sizeof(RefData);
+    BuffDesc.BindFlags     = BIND_UNIFORM_BUFFER;
+
+    BufferData InitData{RefData.data(), sizeof(RefData)};
+
+    RefCntAutoPtr<IBuffer> pBuffer;
+    pDevice->CreateBuffer(BuffDesc, &InitData, &pBuffer);
+    ASSERT_NE(pBuffer, nullptr);
+
+    ReadbackManager Readback{pDevice};
+
+    bool CallbackCalled = false;
+    Readback.ReadBuffer(pContext, pBuffer, 16 * sizeof(Uint32), 8 * sizeof(Uint32),
+                        [&](const void* pData, Uint32 Size) //
+                        {
+                            CallbackCalled = true;
+                            ASSERT_EQ(Size, 8 * sizeof(Uint32));
+                            const auto* pValues = static_cast<const Uint32*>(pData);
+                            for (Uint32 i = 0; i < 8; ++i)
+                                EXPECT_EQ(pValues[i], RefData[16 + i]);
+                        });
+
+    auto Future = Readback.ReadBufferAsync(pContext, pBuffer, 0, sizeof(RefData));
+    EXPECT_EQ(Readback.GetNumPendingReadbacks(), size_t{2});
+
+    // The data is not available until the GPU reaches the fence
+    Readback.Update(pContext);
+    EXPECT_FALSE(CallbackCalled);
+
+    Readback.WaitForIdle(pContext);
+    EXPECT_TRUE(CallbackCalled);
+    EXPECT_EQ(Readback.GetNumPendingReadbacks(), size_t{0});
+
+    ASSERT_EQ(Future.wait_for(std::chrono::seconds{0}), std::future_status::ready);
+    auto Data = Future.get();
+    ASSERT_EQ(Data.size(), sizeof(RefData));
+    EXPECT_EQ(memcmp(Data.data(), RefData.data(), sizeof(RefData)), 0);
+}
+
+TEST(ReadbackManagerTest, ReadTexture)
+{
+    auto* pEnv     = TestingEnvironment::GetInstance();
+    auto* pDevice  = pEnv->GetDevice();
+    auto* pContext = pEnv->GetDeviceContext();
+
+    TestingEnvironment::ScopedReset EnvironmentAutoReset;
+
+    static constexpr Uint32 TexSize = 8;
+
+    std::array<Uint32, TexSize * TexSize> RefData;
+    for (Uint32 i = 0; i < RefData.size(); ++i)
+        RefData[i] = 0xFF000000u | (i * 0x010203u);
+
+    TextureDesc TexDesc;
+    TexDesc.Name      = "Readback test texture";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = TexSize;
+    TexDesc.Height    = TexSize;
+    TexDesc.Format    = TEX_FORMAT_RGBA8_UNORM;
+    TexDesc.Usage     = USAGE_DEFAULT;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+    TextureSubResData SubresData{RefData.data(), TexSize * sizeof(Uint32)};
+    TextureData       InitData{&SubresData, 1};
+
+    RefCntAutoPtr<ITexture> pTexture;
+    pDevice->CreateTexture(TexDesc, &InitData, &pTexture);
+    ASSERT_NE(pTexture, nullptr);
+
+    ReadbackManager Readback{pDevice};
+
+    const Box Region{2, 6, 1, 4};
+    auto      Future = Readback.ReadTextureAsync(pContext, pTexture, 0, 0, &Region);
+    Readback.WaitForIdle(pContext);
+
+    ASSERT_EQ(Future.wait_for(std::chrono::seconds{0}), std::future_status::ready);
+    auto Data = Future.get();
+    ASSERT_EQ(Data.Width, Uint32{4});
+    ASSERT_EQ(Data.Height, Uint32{3});
+    ASSERT_EQ(Data.RowSize, Uint32{4 * sizeof(Uint32)});
+    for (Uint32 y = 0; y < Data.Height; ++y)
+    {
+        for (Uint32 x = 0; x < Data.Width; ++x)
+        {
+            Uint32 Texel;
+            memcpy(&Texel, &Data.Data[y * Data.RowSize + x * sizeof(Uint32)], sizeof(Texel));
+            EXPECT_EQ(Texel, RefData[(Region.MinY + y) * TexSize + Region.MinX + x]) << "x: " << x << " y: " << y;
+        }
+    }
+
+    // The staging texture of the same size is reused
+    bool CallbackCalled = false;
+    Readback.ReadTexture(pContext, pTexture, 0, 0, &Region,
+                         [&](const MappedTextureSubresource& MappedData, Uint32 Width, Uint32 Height) //
+                         {
+                             CallbackCalled = true;
+                             EXPECT_EQ(Width, Uint32{4});
+                             EXPECT_EQ(Height, Uint32{3});
+                             EXPECT_NE(MappedData.pData, nullptr);
+                         });
+    Readback.WaitForIdle(pContext);
+    EXPECT_TRUE(CallbackCalled);
+}
+
+TEST(ReadbackManagerTest, ReadQuery)
+{
+    auto* pEnv    = TestingEnvironment::GetInstance();
+    auto* pDevice = pEnv->GetDevice();
+
+    const auto& deviceCaps = pDevice->GetDeviceCaps();
+    if (!deviceCaps.Features.TimestampQueries)
+    {
+        GTEST_SKIP() << "Timestamp queries are not supported by this device";
+    }
+
+    auto* pContext = pEnv->GetDeviceContext();
+
+    TestingEnvironment::ScopedReset EnvironmentAutoReset;
+
+    QueryDesc queryDesc;
+    queryDesc.Name = "Readback timestamp query";
+    queryDesc.Type = QUERY_TYPE_TIMESTAMP;
+
+    RefCntAutoPtr<IQuery> pQueryStart;
+    pDevice->CreateQuery(queryDesc, &pQueryStart);
+    ASSERT_NE(pQueryStart, nullptr);
+
+    RefCntAutoPtr<IQuery> pQueryEnd;
+    pDevice->CreateQuery(queryDesc, &pQueryEnd);
+    ASSERT_NE(pQueryEnd, nullptr);
+
+    ReadbackManager Readback{pDevice};
+
+    pContext->EndQuery(pQueryStart);
+    pContext->EndQuery(pQueryEnd);
+
+    bool   DurationRead = false;
+    double Duration     = -1;
+    Readback.ReadDuration(pQueryStart, pQueryEnd,
+                          [&](double _Duration) //
+                          {
+                              DurationRead = true;
+                              Duration     = _Duration;
+                          });
+    Readback.WaitForIdle(pContext);
+    EXPECT_TRUE(DurationRead);
+    EXPECT_GE(Duration, 0.0);
+
+    pContext->EndQuery(pQueryEnd);
+    auto Future = Readback.ReadQueryAsync<QueryDataTimestamp>(pQueryEnd);
+    Readback.WaitForIdle(pContext);
+    ASSERT_EQ(Future.wait_for(std::chrono::seconds{0}), std::future_status::ready);
+    EXPECT_EQ(Future.get().Type, QUERY_TYPE_TIMESTAMP);
+}
+
+} // namespace
@@ -99,4 +99,86 @@ TEST(StreamingBufferTest, MapUnamp)
     StreamBuff.Reset();
 }
 
+TEST(StreamingBufferTest, FenceRing)
+{
+    auto* pEnv     = TestingEnvironment::GetInstance();
+    auto* pDevice  = pEnv->GetDevice();
+    auto* pContext = pEnv->GetDeviceContext();
+
+    StreamingBufferCreateInfo CI;
+    CI.pDevice      = pDevice;
+    CI.UseFenceRing = true;
+
+    CI.BuffDesc.Name           = "Test streaming ring buffer";
+    CI.BuffDesc.BindFlags      = BIND_VERTEX_BUFFER;
+    CI.BuffDesc.Usage          = USAGE_DYNAMIC;
+    CI.BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    CI.BuffDesc.uiSizeInBytes  = 1024;
+
+    StreamingBuffer StreamBuff{CI};
+    ASSERT_TRUE(StreamBuff.GetBuffer() != nullptr);
+    if (!StreamBuff.IsFenceRingUsed())
+    {
+        GTEST_SKIP() << "Persistent mapping is not supported by this device";
+    }
+
+    {
+        auto Offset = StreamBuff.Map(pContext, pDevice, 256);
+        EXPECT_EQ(Offset, Uint32{0});
+        StreamBuff.Unmap();
+        // The buffer stays mapped
+        EXPECT_NE(StreamBuff.GetMappedCPUAddress(), nullptr);
+    }
+
+    {
+        static constexpr Uint32 DataSize       = 512;
+        static constexpr Uint8  Data[DataSize] = {};
+
+        auto Offset = StreamBuff.Update(pContext, pDevice, Data, DataSize);
+        EXPECT_EQ(Offset, Uint32{256});
+    }
+
+    // The GPU may finish the frame at any time after FinishFrame(). The fence is signaled
+    // before the frame's fence, so the frame is still in flight while it is not completed.
+    RefCntAutoPtr<IFence> pFence;
+    {
+        FenceDesc Desc;
+        Desc.Name = "Streaming buffer test fence";
+        pDevice->CreateFence(Desc, &pFence);
+        ASSERT_TRUE(pFence != nullptr);
+    }
+    pContext->SignalFence(pFence, 1);
+    StreamBuff.FinishFrame(pContext);
+
+    bool PrevFrameReleased = false;
+    {
+        // The space [0, 768) of the previous frame is not reused until the GPU has finished it,
+        // in which case the ring is empty and starts over
+        auto Offset = StreamBuff.Map(pContext, pDevice, 256);
+        PrevFrameReleased = Offset == 0;
+        EXPECT_TRUE(PrevFrameReleased || Offset == 768);
+        EXPECT_TRUE(!PrevFrameReleased || pFence->GetCompletedValue() >= 1);
+        StreamBuff.Unmap();
+    }
+
+    {
+        // Waits for the previous frame and wraps around unless it has been released
+        auto Offset = StreamBuff.Map(pContext, pDevice, 512);
+        EXPECT_EQ(Offset, PrevFrameReleased ? Uint32{256} : Uint32{0});
+        StreamBuff.Unmap();
+    }
+
+    StreamBuff.FinishFrame(pContext);
+
+    {
+        auto Offset = StreamBuff.Map(pContext, pDevice, 2048);
+        EXPECT_EQ(Offset, Uint32{0});
+        EXPECT_EQ(StreamBuff.GetBuffer()->GetDesc().uiSizeInBytes, Uint32{2048});
+        StreamBuff.Unmap();
+    }
+
+    StreamBuff.FinishFrame(pContext);
+    StreamBuff.Reset();
+}
+
 } // namespace
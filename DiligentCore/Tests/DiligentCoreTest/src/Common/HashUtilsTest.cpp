@@ -26,6 +26,7 @@
  */
 
 #include <unordered_map>
+#include <vector>
 
 #include "HashUtils.hpp"
 
@@ -116,4 +117,25 @@ TEST(Common_HashUtils, HashMapStringKey)
     }
 }
 
+TEST(Common_HashUtils, ComputeHashRaw)
+{
+    // Odd size to test the tail that is not a multiple of the word size
+    std::vector<Uint8> Data(1027);
+    for (size_t i = 0; i < Data.size(); ++i)
+        Data[i] = static_cast<Uint8>(i * 7 + 3);
+
+    const auto Hash = ComputeHashRaw(Data.data(), Data.size());
+    EXPECT_EQ(Hash, ComputeHashRaw(Data.data(), Data.size()));
+    EXPECT_NE(Hash, ComputeHashRaw(Data.data(), Data.size() - 1));
+
+    for (size_t i : {size_t{0}, size_t{500}, Data.size() - 1})
+    {
+        auto ModifiedData = Data;
+        ModifiedData[i] ^= 1;
+        EXPECT_NE(Hash, ComputeHashRaw(ModifiedData.data(), ModifiedData.size())) << "Byte " << i;
+    }
+
+    EXPECT_EQ(ComputeHashRaw(nullptr, 0), size_t{0});
+}
+
 } // namespace
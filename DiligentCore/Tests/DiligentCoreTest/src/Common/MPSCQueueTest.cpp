@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "MPSCQueue.hpp"
+
+#include <vector>
+#include <thread>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+TEST(Common_MPSCQueue, PushPop)
+{
+    MPSCQueue<int> Queue;
+
+    int Value = -1;
+    EXPECT_TRUE(Queue.IsEmpty());
+    EXPECT_FALSE(Queue.Pop(Value));
+
+    for (int i = 0; i < 10; ++i)
+        Queue.Push(i);
+    EXPECT_EQ(Queue.GetSize(), 10u);
+    EXPECT_FALSE(Queue.IsEmpty());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        ASSERT_TRUE(Queue.Pop(Value));
+        EXPECT_EQ(Value, i);
+    }
+    EXPECT_FALSE(Queue.Pop(Value));
+    EXPECT_EQ(Queue.GetSize(), 0u);
+}
+
+TEST(Common_MPSCQueue, MoveOnlyValues)
+{
+    MPSCQueue<std::unique_ptr<int>> Queue;
+    Queue.Push(std::unique_ptr<int>{new int{7}});
+
+    std::unique_ptr<int> pValue;
+    ASSERT_TRUE(Queue.Pop(pValue));
+    ASSERT_TRUE(pValue);
+    EXPECT_EQ(*pValue, 7);
+
+    // Values that are left in the queue are released by the destructor
+    Queue.Push(std::unique_ptr<int>{new int{8}});
+}
+
+TEST(Common_MPSCQueue, MultipleProducers)
+{
+    static constexpr int NumProducers = 4;
+    static constexpr int NumValues    = 10000;
+
+    MPSCQueue<int> Queue;
+
+    std::vector<std::thread> Producers;
+    for (int p = 0; p < NumProducers; ++p)
+    {
+        Producers.emplace_back([&Queue, p]() {
+            for (int i = 0; i < NumValues; ++i)
+                Queue.Push(p * NumValues + i);
+        });
+    }
+
+    // Values of every producer must arrive in the order they were pushed
+    std::vector<int> NextValue(NumProducers, 0);
+
+    int NumPopped = 0;
+    while (NumPopped < NumProducers * NumValues)
+    {
+        int Value = 0;
+        if (!Queue.Pop(Value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const auto Producer = Value / NumValues;
+        ASSERT_LT(Producer, NumProducers);
+        EXPECT_EQ(Value % NumValues, NextValue[Producer]);
+        NextValue[Producer] = Value % NumValues + 1;
+        ++NumPopped;
+    }
+
+    for (auto& Producer : Producers)
+        Producer.join();
+
+    int Value = 0;
+    EXPECT_FALSE(Queue.Pop(Value));
+    EXPECT_EQ(Queue.GetSize(), 0u);
+}
+
+} // namespace
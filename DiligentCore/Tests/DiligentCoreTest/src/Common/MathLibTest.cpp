@@ -915,6 +915,32 @@ TEST(Common_BasicMath, MatrixInverse)
         }
     }
 
+    {
+        auto m = float4x4::Scale(2.f, 0.5f, 3.f) *
+            Quaternion::RotationFromAxisAngle(float3{1, 2, 3}, 0.75f).ToMatrix() *
+            float4x4::Translation(10.f, -4.f, 7.f);
+
+        auto inv = m.InverseAffine();
+        auto ref = m.Inverse();
+        for (int j = 0; j < 4; ++j)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                EXPECT_NEAR(inv[i][j], ref[i][j], 1e-5f);
+            }
+        }
+
+        auto identity = m * inv;
+        for (int j = 0; j < 4; ++j)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                float val = i == j ? 1.f : 0.f;
+                EXPECT_NEAR(identity[i][j], val, 1e-5f);
+            }
+        }
+    }
+
     // Determinant
     {
         // clang-format off
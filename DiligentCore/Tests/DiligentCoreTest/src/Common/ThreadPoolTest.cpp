@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "ThreadPool.hpp"
+
+#include <vector>
+#include <atomic>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+TEST(Common_ThreadPool, Enqueue)
+{
+    std::atomic<int> Counter{0};
+    {
+        ThreadPool Pool{4};
+        EXPECT_EQ(Pool.GetNumThreads(), 4u);
+        for (int i = 0; i < 1000; ++i)
+            Pool.Enqueue([&Counter]() { ++Counter; });
+        // Destructor completes all pending tasks
+    }
+    EXPECT_EQ(Counter, 1000);
+}
+
+TEST(Common_ThreadPool, ParallelFor)
+{
+    ThreadPool Pool;
+
+    for (size_t Count : {size_t{0}, size_t{1}, size_t{7}, size_t{64}, size_t{1000}})
+    {
+        for (size_t ChunkSize : {size_t{0}, size_t{1}, size_t{3}, size_t{16}, size_t{2048}})
+        {
+            std::vector<int> Visited(Count);
+            Pool.ParallelFor(Count, ChunkSize, [&Visited](size_t Begin, size_t End) {
+                for (size_t i = Begin; i < End; ++i)
+                    ++Visited[i];
+            });
+            for (size_t i = 0; i < Count; ++i)
+                EXPECT_EQ(Visited[i], 1) << "Count: " << Count << ", chunk size: " << ChunkSize << ", item: " << i;
+        }
+    }
+}
+
+} // namespace
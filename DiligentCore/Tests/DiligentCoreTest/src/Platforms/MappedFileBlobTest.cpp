@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "PlatformDefinitions.h"
+
+#if PLATFORM_LINUX
+
+#    include <cstdio>
+#    include <vector>
+
+#    include "LinuxMappedFileBlob.hpp"
+
+#    include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+TEST(Platforms_LinuxMappedFileBlob, MapFile)
+{
+    const char* FilePath = "MappedFileBlobTest.bin";
+
+    std::vector<Uint8> RefData(100000);
+    for (size_t i = 0; i < RefData.size(); ++i)
+        RefData[i] = static_cast<Uint8>(i * 7 + 3);
+
+    {
+        FILE* pFile = fopen(FilePath, "wb");
+        ASSERT_NE(pFile, nullptr);
+        EXPECT_EQ(fwrite(RefData.data(), 1, RefData.size(), pFile), RefData.size());
+        fclose(pFile);
+    }
+
+    {
+        RefCntAutoPtr<IDataBlob> pBlob;
+        LinuxMappedFileBlob::Create(FilePath, &pBlob);
+        ASSERT_NE(pBlob, nullptr);
+        ASSERT_EQ(pBlob->GetSize(), RefData.size());
+        EXPECT_EQ(memcmp(pBlob->GetConstDataPtr(), RefData.data(), RefData.size()), 0);
+
+        // The mapping is copy-on-write and must not modify the file
+        auto* pData = static_cast<Uint8*>(pBlob->GetDataPtr());
+        pData[0]    = ~RefData[0];
+    }
+
+    {
+        RefCntAutoPtr<IDataBlob> pBlob;
+        LinuxMappedFileBlob::Create(FilePath, &pBlob);
+        ASSERT_NE(pBlob, nullptr);
+        EXPECT_EQ(static_cast<const Uint8*>(pBlob->GetConstDataPtr())[0], RefData[0]);
+    }
+
+    remove(FilePath);
+}
+
+TEST(Platforms_LinuxMappedFileBlob, MissingOrEmptyFile)
+{
+    {
+        RefCntAutoPtr<IDataBlob> pBlob;
+        LinuxMappedFileBlob::Create("MappedFileBlobTest_NonExistent.bin", &pBlob);
+        EXPECT_EQ(pBlob, nullptr);
+    }
+
+    const char* FilePath = "MappedFileBlobTest_Empty.bin";
+    {
+        FILE* pFile = fopen(FilePath, "wb");
+        ASSERT_NE(pFile, nullptr);
+        fclose(pFile);
+    }
+
+    {
+        RefCntAutoPtr<IDataBlob> pBlob;
+        LinuxMappedFileBlob::Create(FilePath, &pBlob);
+        EXPECT_EQ(pBlob, nullptr);
+    }
+
+    remove(FilePath);
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/Texture.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/TextureView.h"
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+#include "../../../DiligentCore/Common/interface/BasicMath.hpp"
+
+namespace Diligent
+{
+
+/// Hierarchical depth (Hi-Z) pyramid for occlusion culling.
+
+/// Every mip level of the pyramid keeps the maximum (farthest) depth of the 2x2 texels of the
+/// previous level, so that an object whose nearest depth is greater than the pyramid depth
+/// over the object's screen rectangle is guaranteed to be hidden. The pyramid is built from the
+/// depth of the frame that has just been rendered and is used to cull objects in the next frame.
+class HiZPyramid
+{
+public:
+    /// Initializes the pyramid.
+
+    /// \param [in] pDevice - Render device. The device must support compute shaders.
+    explicit HiZPyramid(IRenderDevice* pDevice);
+
+    // clang-format off
+    HiZPyramid           (const HiZPyramid&)  = delete;
+    HiZPyramid           (      HiZPyramid&&) = delete;
+    HiZPyramid& operator=(const HiZPyramid&)  = delete;
+    HiZPyramid& operator=(      HiZPyramid&&) = delete;
+    // clang-format on
+
+    /// Builds the pyramid.
+
+    /// \param [in] pCtx      - Device context.
+    /// \param [in] pDepthSRV - Shader resource view of a single-channel texture that contains normalized
+    ///                         device z of the frame, e.g. a depth buffer or an R32_FLOAT render target.
+    ///                         Larger values must be farther from the camera.
+    /// \param [in] ViewProj  - View-projection matrix the depth was rendered with.
+    ///
+    /// \note This method must be called outside of a render pass. The depth texture is transitioned
+    ///       to RESOURCE_STATE_SHADER_RESOURCE state.
+    void Build(IDeviceContext* pCtx, ITextureView* pDepthSRV, const float4x4& ViewProj);
+
+    /// Marks the pyramid as not usable for culling, e.g. after a camera cut, until it is rebuilt.
+    void Invalidate() { m_IsValid = false; }
+
+    /// Returns true if the pyramid has been built and has not been invalidated since.
+    bool IsValid() const { return m_IsValid; }
+
+    // clang-format off
+    ITextureView*   GetSRV()          const { return m_pHiZSRV.RawPtr<ITextureView>(); }
+    const float4x4& GetViewProj()     const { return m_ViewProj; }
+    Uint32          GetDepthWidth()   const { return m_DepthWidth; }
+    Uint32          GetDepthHeight()  const { return m_DepthHeight; }
+    Uint32          GetNumMipLevels() const { return static_cast<Uint32>(m_MipUAVs.size()); }
+    // clang-format on
+
+    /// Number of threads in each dimension of a pyramid build thread group.
+    static constexpr Uint32 ThreadGroupSize = 8;
+
+private:
+    void CreatePyramid(Uint32 DepthWidth, Uint32 DepthHeight);
+
+    RefCntAutoPtr<IRenderDevice>  m_pDevice;
+    RefCntAutoPtr<IPipelineState> m_pBuildPSO;
+    RefCntAutoPtr<IBuffer>        m_pBuildAttribsCB;
+
+    RefCntAutoPtr<ITexture>                            m_pHiZ;
+    RefCntAutoPtr<ITextureView>                        m_pHiZSRV;
+    std::vector<RefCntAutoPtr<ITextureView>>           m_MipUAVs;
+    std::vector<RefCntAutoPtr<IShaderResourceBinding>> m_MipSRBs;
+
+    float4x4 m_ViewProj;
+    Uint32   m_DepthWidth  = 0;
+    Uint32   m_DepthHeight = 0;
+    bool     m_IsValid     = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,203 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+
+#include "HiZPyramid.hpp"
+#include "../../../Utilities/include/DiligentFXShaderSourceStreamFactory.hpp"
+#include "GraphicsUtilities.h"
+#include "GraphicsAccessories.hpp"
+#include "ShaderMacroHelper.hpp"
+#include "MapHelper.hpp"
+
+namespace Diligent
+{
+
+HiZPyramid::HiZPyramid(IRenderDevice* pDevice) :
+    m_pDevice{pDevice}
+{
+    CreateUniformBuffer(pDevice, sizeof(uint4), "Hi-Z build attribs CB", &m_pBuildAttribsCB);
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.UseCombinedTextureSamplers = true;
+    ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("HIZ_THREAD_GROUP_SIZE", ThreadGroupSize);
+    ShaderCI.Macros = Macros;
+
+    RefCntAutoPtr<IShader> pCS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Build Hi-Z pyramid CS";
+        ShaderCI.FilePath        = "BuildHiZPyramid.csh";
+        pDevice->CreateShader(ShaderCI, &pCS);
+    }
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name         = "Build Hi-Z pyramid PSO";
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_COMPUTE, "cbHiZBuildAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    PSOCreateInfo.pCS = pCS;
+    pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pBuildPSO);
+    if (!m_pBuildPSO)
+        LOG_ERROR_AND_THROW("Failed to create Hi-Z pyramid build PSO");
+
+    m_pBuildPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbHiZBuildAttribs")->Set(m_pBuildAttribsCB);
+}
+
+void HiZPyramid::CreatePyramid(Uint32 DepthWidth, Uint32 DepthHeight)
+{
+    m_pHiZ.Release();
+    m_pHiZSRV.Release();
+    m_MipUAVs.clear();
+    m_MipSRBs.clear();
+
+    m_DepthWidth  = DepthWidth;
+    m_DepthHeight = DepthHeight;
+
+    // The first level is half the size of the depth buffer
+    TextureDesc TexDesc;
+    TexDesc.Name      = "Hi-Z pyramid";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = std::max(DepthWidth / 2, 1u);
+    TexDesc.Height    = std::max(DepthHeight / 2, 1u);
+    TexDesc.MipLevels = ComputeMipLevelsCount(TexDesc.Width, TexDesc.Height);
+    TexDesc.Format    = TEX_FORMAT_R32_FLOAT;
+    TexDesc.Usage     = USAGE_DEFAULT;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    m_pDevice->CreateTexture(TexDesc, nullptr, &m_pHiZ);
+    if (!m_pHiZ)
+    {
+        LOG_ERROR_MESSAGE("Failed to create Hi-Z pyramid texture");
+        return;
+    }
+    m_pHiZSRV = m_pHiZ->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+
+    m_MipUAVs.resize(TexDesc.MipLevels);
+    m_MipSRBs.resize(TexDesc.MipLevels);
+    RefCntAutoPtr<ITextureView> pPrevMipSRV;
+    for (Uint32 mip = 0; mip < TexDesc.MipLevels; ++mip)
+    {
+        TextureViewDesc ViewDesc;
+        ViewDesc.TextureDim      = RESOURCE_DIM_TEX_2D;
+        ViewDesc.MostDetailedMip = mip;
+        ViewDesc.NumMipLevels    = 1;
+
+        ViewDesc.ViewType    = TEXTURE_VIEW_UNORDERED_ACCESS;
+        ViewDesc.AccessFlags = UAV_ACCESS_FLAG_WRITE;
+        m_pHiZ->CreateView(ViewDesc, &m_MipUAVs[mip]);
+
+        m_pBuildPSO->CreateShaderResourceBinding(&m_MipSRBs[mip], true);
+        m_MipSRBs[mip]->GetVariableByName(SHADER_TYPE_COMPUTE, "g_DstHiZ")->Set(m_MipUAVs[mip]);
+        // The source of the first level is the depth buffer that is set by Build()
+        if (mip > 0)
+            m_MipSRBs[mip]->GetVariableByName(SHADER_TYPE_COMPUTE, "g_SrcDepth")->Set(pPrevMipSRV);
+
+        ViewDesc.ViewType    = TEXTURE_VIEW_SHADER_RESOURCE;
+        ViewDesc.AccessFlags = UAV_ACCESS_UNSPECIFIED;
+        pPrevMipSRV.Release();
+        m_pHiZ->CreateView(ViewDesc, &pPrevMipSRV);
+    }
+}
+
+void HiZPyramid::Build(IDeviceContext* pCtx, ITextureView* pDepthSRV, const float4x4& ViewProj)
+{
+    auto* pDepth = pDepthSRV->GetTexture();
+
+    const auto& DepthDesc = pDepth->GetDesc();
+    if (!m_pHiZ || DepthDesc.Width != m_DepthWidth || DepthDesc.Height != m_DepthHeight)
+    {
+        CreatePyramid(DepthDesc.Width, DepthDesc.Height);
+        if (!m_pHiZ)
+        {
+            m_IsValid = false;
+            return;
+        }
+    }
+
+    m_MipSRBs[0]->GetVariableByName(SHADER_TYPE_COMPUTE, "g_SrcDepth")->Set(pDepthSRV);
+
+    // clang-format off
+    StateTransitionDesc Barriers[] =
+    {
+        {pDepth, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,  true},
+        {m_pHiZ, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, true}
+    };
+    // clang-format on
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+    pCtx->SetPipelineState(m_pBuildPSO);
+
+    Uint32 SrcWidth  = DepthDesc.Width;
+    Uint32 SrcHeight = DepthDesc.Height;
+    for (Uint32 mip = 0; mip < m_MipSRBs.size(); ++mip)
+    {
+        const auto& MipProps = GetMipLevelProperties(m_pHiZ->GetDesc(), mip);
+        {
+            MapHelper<uint4> BuildAttribs(pCtx, m_pBuildAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+            *BuildAttribs = uint4{SrcWidth, SrcHeight, MipProps.LogicalWidth, MipProps.LogicalHeight};
+        }
+
+        // Source and destination levels are in different states, so the pyramid texture
+        // is transitioned manually one level at a time
+        pCtx->CommitShaderResources(m_MipSRBs[mip], RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+        DispatchComputeAttribs DispatchAttribs{(MipProps.LogicalWidth + ThreadGroupSize - 1) / ThreadGroupSize,
+                                               (MipProps.LogicalHeight + ThreadGroupSize - 1) / ThreadGroupSize,
+                                               1};
+        pCtx->DispatchCompute(DispatchAttribs);
+
+        StateTransitionDesc MipBarrier{m_pHiZ, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE, mip, 1};
+        pCtx->TransitionResourceStates(1, &MipBarrier);
+
+        SrcWidth  = MipProps.LogicalWidth;
+        SrcHeight = MipProps.LogicalHeight;
+    }
+    // All levels are now in shader resource state
+    m_pHiZ->SetState(RESOURCE_STATE_SHADER_RESOURCE);
+
+    m_ViewProj = ViewProj;
+    m_IsValid  = true;
+}
+
+} // namespace Diligent
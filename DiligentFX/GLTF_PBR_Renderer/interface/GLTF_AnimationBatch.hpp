@@ -0,0 +1,146 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+#include "../../../DiligentCore/Common/interface/ThreadPool.hpp"
+#include "../../../DiligentTools/AssetLoader/interface/GLTFLoader.hpp"
+
+namespace Diligent
+{
+
+/// Evaluates animations of many GLTF model instances in parallel and writes
+/// their joint palettes into a single structured buffer.
+
+/// An application adds every animated instance with AddInstance() each frame and
+/// then calls Execute() once. Animation sampling, hierarchy update and joint palette
+/// computation run on a pool of worker threads, and every job copies its palettes
+/// straight into the mapped buffer. The buffer is then bound to the GLTF_PBR_Renderer
+/// (see GLTF_PBR_Renderer::CreateInfo::UseJointsBuffer), and the instance's first joint
+/// is passed to the renderer in GLTF_PBR_Renderer::RenderInfo::FirstJoint.
+///
+/// Within an instance, palettes of skinned meshes are stored consecutively
+/// in the order of GLTF::Model::LinearNodes.
+class GLTF_AnimationBatch
+{
+public:
+    /// Animation batch create info
+    struct CreateInfo
+    {
+        /// Maximum total number of joints of all instances in one frame.
+        Uint32 MaxJointCount = 16384;
+
+        /// Number of worker threads. If 0, the number of hardware threads minus one is used.
+        Uint32 NumWorkerThreads = 0;
+
+        /// Number of instances processed by a single job.
+        Uint32 InstancesPerJob = 8;
+    };
+
+    /// Invalid joint offset returned by GetFirstJoint() for instances that are not in the buffer.
+    static constexpr Uint32 InvalidJoint = ~0u;
+
+    GLTF_AnimationBatch(IRenderDevice* pDevice, const CreateInfo& CI);
+
+    // clang-format off
+    GLTF_AnimationBatch           (const GLTF_AnimationBatch&)  = delete;
+    GLTF_AnimationBatch           (      GLTF_AnimationBatch&&) = delete;
+    GLTF_AnimationBatch& operator=(const GLTF_AnimationBatch&)  = delete;
+    GLTF_AnimationBatch& operator=(      GLTF_AnimationBatch&&) = delete;
+    // clang-format on
+
+    /// Adds an instance to be animated by the next call to Execute().
+
+    /// \param [in] Instance       - Model instance. The instance must stay alive until
+    ///                              the frame is rendered.
+    /// \param [in] AnimationIndex - Index of the animation to sample.
+    /// \param [in] Time           - Animation time.
+    ///
+    /// \note  An instance is only added once per frame; subsequent calls for the same instance are ignored.
+    void AddInstance(GLTF::ModelInstance& Instance, Uint32 AnimationIndex, float Time);
+
+    /// Adds an instance whose current pose is written to the joints buffer by the next call
+    /// to Execute() without sampling an animation, e.g. a paused instance or an instance in the rest pose.
+
+    /// Every skinned instance that is rendered with the joints buffer must be added every frame,
+    /// otherwise it is not in the buffer and is rendered in the bind pose.
+    void AddInstance(GLTF::ModelInstance& Instance);
+
+    /// Updates all instances added since the last call and fills the joints buffer.
+    void Execute(IDeviceContext* pCtx);
+
+    /// Returns the index of the first joint of the given instance in the joints buffer,
+    /// or InvalidJoint if the instance was not processed by the last call to Execute().
+    Uint32 GetFirstJoint(const GLTF::ModelInstance& Instance) const
+    {
+        auto it = m_FirstJoints.find(&Instance);
+        return it != m_FirstJoints.end() ? it->second : InvalidJoint;
+    }
+
+    /// Returns the number of joints written by the last call to Execute().
+    Uint32 GetJointCount() const { return m_JointCount; }
+
+    /// Returns the shader resource view of the joints buffer (StructuredBuffer<float4x4>).
+    IBufferView* GetJointsBufferSRV() { return m_pJointsBufferSRV; }
+
+    /// Returns the total number of joints in the palettes of all skinned meshes of the model.
+    static Uint32 GetModelJointCount(const GLTF::Model& GLTFModel);
+
+private:
+    struct InstanceInfo
+    {
+        GLTF::ModelInstance* pInstance      = nullptr;
+        Uint32               AnimationIndex = 0;
+        float                Time           = 0;
+        bool                 Animate        = false;
+        Uint32               FirstJoint     = InvalidJoint;
+    };
+
+    const CreateInfo m_Settings;
+
+    ThreadPool m_ThreadPool;
+
+    std::vector<InstanceInfo>                              m_Instances;
+    std::unordered_set<const GLTF::ModelInstance*>         m_AddedInstances;
+    std::unordered_map<const GLTF::ModelInstance*, Uint32> m_FirstJoints;
+
+    Uint32 m_JointCount = 0;
+
+    RefCntAutoPtr<IBuffer>     m_pJointsBuffer;
+    RefCntAutoPtr<IBufferView> m_pJointsBufferSRV;
+};
+
+} // namespace Diligent
@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+#include "../../../DiligentTools/AssetLoader/interface/GLTFLoader.hpp"
+#include "GLTF_AnimationBatch.hpp"
+
+namespace Diligent
+{
+
+/// Skins GLTF model instances in a compute pre-pass.
+
+/// Every animated instance is skinned once per frame into its own copy of the model's
+/// first vertex buffer (see GLTF::Model::VertexAttribs0). The copy is then passed to
+/// GLTF_PBR_Renderer in RenderInfo::pSkinnedVertexBuffer, so that all passes and
+/// primitives that draw the instance reuse the skinned positions and normals, and
+/// joint matrices are no longer needed by the vertex shader.
+///
+/// Joint matrices are read from the joints buffer of GLTF_AnimationBatch.
+class GLTF_ComputeSkinning
+{
+public:
+    /// Per-instance skinning resources
+    struct SkinnedVertices
+    {
+        /// Vertex buffer with skinned VertexAttribs0 data.
+        RefCntAutoPtr<IBuffer> pVertexBuffer;
+
+        /// Shader resource binding that references the model's and the instance's vertex buffers.
+        RefCntAutoPtr<IShaderResourceBinding> pSRB;
+    };
+
+    /// Initializes the pass.
+
+    /// \param [in] pDevice          - Render device.
+    /// \param [in] pJointsBufferSRV - Joints buffer view, see GLTF_AnimationBatch::GetJointsBufferSRV().
+    GLTF_ComputeSkinning(IRenderDevice* pDevice, IBufferView* pJointsBufferSRV);
+
+    // clang-format off
+    GLTF_ComputeSkinning           (const GLTF_ComputeSkinning&)  = delete;
+    GLTF_ComputeSkinning           (      GLTF_ComputeSkinning&&) = delete;
+    GLTF_ComputeSkinning& operator=(const GLTF_ComputeSkinning&)  = delete;
+    GLTF_ComputeSkinning& operator=(      GLTF_ComputeSkinning&&) = delete;
+    // clang-format on
+
+    /// Creates skinning resources for an instance of the given model.
+    /// The vertex buffer is initialized with the rest pose vertices of the model.
+    SkinnedVertices CreateSkinnedVertices(IDeviceContext* pCtx, const GLTF::Model& GLTFModel);
+
+    /// Adds an instance to be skinned by the next call to Execute().
+
+    /// \param [in] Instance - Model instance. The instance must also be added to the
+    ///                        animation batch that is passed to Execute().
+    /// \param [in] Vertices - Skinning resources created for the instance's model.
+    void AddInstance(const GLTF::ModelInstance& Instance, SkinnedVertices& Vertices);
+
+    /// Skins all instances added since the last call.
+
+    /// \note This method must be called after Batch.Execute() and outside of a render pass.
+    ///       When it returns, all skinned vertex buffers are in RESOURCE_STATE_VERTEX_BUFFER state.
+    void Execute(IDeviceContext* pCtx, const GLTF_AnimationBatch& Batch);
+
+    /// Number of threads in a skinning thread group.
+    static constexpr Uint32 ThreadGroupSize = 64;
+
+private:
+    struct InstanceInfo
+    {
+        const GLTF::ModelInstance* pInstance = nullptr;
+        SkinnedVertices*           pVertices = nullptr;
+    };
+
+    RefCntAutoPtr<IRenderDevice>  m_pDevice;
+    RefCntAutoPtr<IPipelineState> m_pSkinningPSO;
+    RefCntAutoPtr<IBuffer>        m_pSkinningAttribsCB;
+
+    std::vector<InstanceInfo>        m_Instances;
+    std::vector<StateTransitionDesc> m_Barriers;
+};
+
+} // namespace Diligent
@@ -29,11 +29,14 @@
 
 #include <unordered_map>
 #include <functional>
+#include <array>
+#include <string>
 
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
 #include "../../../DiligentCore/Common/interface/HashUtils.hpp"
 #include "../../../DiligentTools/AssetLoader/interface/GLTFLoader.hpp"
+#include "GLTF_StaticScene.hpp"
 
 namespace Diligent
 {
@@ -44,6 +47,12 @@ namespace Diligent
 class GLTF_PBR_Renderer
 {
 public:
+    /// Maximum number of joints in a skin that the shaders support.
+    static constexpr Uint32 MaxNumJoints = 128;
+
+    /// Invalid joint index.
+    static constexpr Uint32 InvalidJoint = ~0u;
+
     /// Renderer create info
     struct CreateInfo
     {
@@ -58,6 +67,21 @@ public:
         ///         render callback function.
         TEXTURE_FORMAT DSVFmt = TEX_FORMAT_UNKNOWN;
 
+        /// Shadow map format. If not TEX_FORMAT_UNKNOWN, the renderer creates depth-only
+        /// pipeline states that render to a shadow map outside of the render pass
+        /// (see RenderDepth).
+        TEXTURE_FORMAT ShadowMapFmt = TEX_FORMAT_UNKNOWN;
+
+        /// Whether the directional light is shadowed by the cascaded shadow map set by SetShadowMap().
+        /// Cascade attributes are read from LightAttribs::ShadowAttribs (see ShadowMapManager).
+
+        /// \note  Shadows are filtered with PCF, so the shadow map must be a depth texture array.
+        bool UseShadows = false;
+
+        /// PCF kernel size (2, 3, 5 or 7) used when UseShadows is true. It must match
+        /// ShadowMapAttribs::iFixedFilterSize that defines the margins of the cascades.
+        int ShadowFilterSize = 3;
+
         /// Indicates if front face is CCW.
         bool FrontCCW = false;
 
@@ -74,6 +98,31 @@ public:
         /// Whether to use emissive texture.
         bool UseEmissive = true;
 
+        /// Directory where the precomputed BRDF look-up table and IBL cube maps are cached
+        /// between runs (see PrecomputeCubemaps). If null, the textures are computed every time.
+
+        /// \note   Cached textures are loaded by all backends, but only D3D11, D3D12 and Vulkan
+        ///         backends can read the textures back from the GPU and write them to the cache.
+        const char* IBLCacheDirectory = nullptr;
+
+        /// Whether to read joint matrices from a structured buffer set by SetJointsBuffer()
+        /// instead of copying them into the transforms constant buffer for every draw call.
+        /// Skinned instances are then rendered with RenderInfo::FirstJoint.
+        bool UseJointsBuffer = false;
+
+        /// Whether to render models in bindless mode. In this mode, all textures of a model are placed
+        /// into one texture array, and materials are read by index from a structured buffer, so that
+        /// the whole model is rendered with a single SRB created by InitializeResourceBindings().
+
+        /// \note  Bindless mode requires DeviceFeatures::BindlessResources. If the feature is not
+        ///        enabled, the renderer uses one SRB per material. Textures in bindless mode always
+        ///        use ColorMapImmutableSampler.
+        bool UseBindlessMaterials = false;
+
+        /// Size of the texture array in bindless mode. Textures that do not fit into
+        /// the array are replaced with default textures.
+        Uint32 MaxBindlessTextures = 256;
+
         /// When set to true, pipeline state will be compiled with immutable samplers.
         /// When set to false, samplers from the texture views will be used.
         bool UseImmutableSamplers = true;
@@ -108,6 +157,23 @@ public:
         /// Model transform matrix
         float4x4 ModelTransform = float4x4::Identity();
 
+        /// Index of the first joint of the instance in the joints buffer (see CreateInfo::UseJointsBuffer).
+        /// If the value is InvalidJoint, skinning is disabled.
+        Uint32 FirstJoint = InvalidJoint;
+
+        /// Optional vertex buffer with pre-skinned vertices (see GLTF_ComputeSkinning)
+        /// that replaces the model's first vertex buffer. When the buffer is set,
+        /// the vertex shader does not perform skinning.
+        IBuffer* pSkinnedVertexBuffer = nullptr;
+
+        /// View-projection matrix used to select levels of detail of the primitives (see GLTF::Primitive::LODs)
+        /// and to sort alpha-blended primitives back to front.
+        float4x4 ViewProj = float4x4::Identity();
+
+        /// Maximum simplification error of the selected level of detail, projected to the screen,
+        /// as a fraction of the viewport height. If the value is 0, full detail is always rendered.
+        float MaxLODScreenError = 0;
+
         /// Alpha mode flags
         enum ALPHA_MODE_FLAGS : Uint32
         {
@@ -180,6 +246,10 @@ public:
         /// GLTF node shader transforms
         GLTFNodeShaderTransforms ShaderTransforms;
 
+        /// GLTF joint matrices, only valid when ShaderTransforms.JointCount is not zero
+        /// and the renderer does not use the joints buffer
+        GLTFJointMatrices JointMatrices;
+
         /// GLTF material shader information
         GLTFMaterialShaderInfo MaterialShaderInfo;
 
@@ -216,18 +286,159 @@ public:
                 std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback = nullptr,
                 size_t                                         SRBTypeId          = 0);
 
-    /// Initializes resource bindings for a given GLTF model
+    /// Renders the given instance of a GLTF model using the instance's pose.
+
+    /// \param [in] pCtx               - Device context to record rendering commands to.
+    /// \param [in] Instance           - GLTF model instance to render.
+    /// \param [in] RenderParams       - Render parameters.
+    /// \param [in] RenderNodeCallback - Optional render call back function that should be called
+    ///                                  for every GLTF node instead of rendering it.
+    /// \param [in] SRBTypeId          - Optional application-defined SRB type that was given to
+    ///                                  CreateMaterialSRB.
+    void Render(IDeviceContext*                                pCtx,
+                const GLTF::ModelInstance&                     Instance,
+                const RenderInfo&                              RenderParams,
+                std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback = nullptr,
+                size_t                                         SRBTypeId          = 0);
+
+    /// Renders opaque and alpha-masked primitives of the given GLTF model to the depth buffer only.
+
+    /// \param [in] pCtx         - Device context to record rendering commands to.
+    /// \param [in] GLTFModel    - GLTF model to render.
+    /// \param [in] RenderParams - Render parameters. RenderParams.ViewProj is the view-projection
+    ///                            matrix of the pass.
+    /// \param [in] IsShadowPass - If false, the model is rendered within the first subpass of the
+    ///                            renderer's render pass, e.g. as a depth pre-pass before Render().
+    ///                            If true, the model is rendered to a shadow map of CreateInfo::ShadowMapFmt
+    ///                            format bound outside of the render pass.
+
+    /// \note  Alpha-masked primitives are only rendered if resource bindings with the default
+    ///        SRB type have been initialized for their materials.
+    void RenderDepth(IDeviceContext*   pCtx,
+                     GLTF::Model&      GLTFModel,
+                     const RenderInfo& RenderParams,
+                     bool              IsShadowPass = false);
+
+    /// Renders the given instance of a GLTF model to the depth buffer only using the instance's pose.
+
+    /// \param [in] pCtx         - Device context to record rendering commands to.
+    /// \param [in] Instance     - GLTF model instance to render.
+    /// \param [in] RenderParams - Render parameters.
+    /// \param [in] IsShadowPass - Whether the instance is rendered to a shadow map (see the overload above).
+    void RenderDepth(IDeviceContext*            pCtx,
+                     const GLTF::ModelInstance& Instance,
+                     const RenderInfo&          RenderParams,
+                     bool                       IsShadowPass = false);
+
+    /// Renders the instances of the static scene that passed the last culling pass.
+
+    /// \param [in] pCtx         - Device context to record rendering commands to.
+    /// \param [in] Scene        - Static scene, see GLTF_StaticScene. The scene must be culled by
+    ///                            GLTF_StaticScene::Cull() before the render pass begins.
+    /// \param [in] RenderParams - Render parameters. Only the shader parameters, e.g. DebugView and
+    ///                            tone mapping attributes, are used. Instance transforms are
+    ///                            taken from the scene.
+    ///
+    /// \note  The scene is rendered with one indirect draw call per batch. Resource bindings
+    ///        must be initialized by InitializeResourceBindings().
+    void RenderStaticScene(IDeviceContext*         pCtx,
+                           const GLTF_StaticScene& Scene,
+                           const RenderInfo&       RenderParams);
+
+    /// Renders opaque instances of the static scene that passed the last culling pass to the depth buffer only.
+
+    /// \param [in] pCtx         - Device context to record rendering commands to.
+    /// \param [in] Scene        - Static scene, see GLTF_StaticScene. The scene must be culled by
+    ///                            GLTF_StaticScene::Cull() before the render pass begins.
+    /// \param [in] RenderParams   - Render parameters. RenderParams.ViewProj is the view-projection
+    ///                              matrix of the pass.
+    /// \param [in] IsOccluderPass - Whether the depth is rendered outside of the render pass to a
+    ///                              depth buffer of DSVFmt format bound by the application, e.g. to
+    ///                              build the Hi-Z pyramid for GLTF_StaticScene::CullOccluded().
+    ///
+    /// \note  Unless IsOccluderPass is true, the scene is rendered within the first subpass of the
+    ///        renderer's render pass, e.g. as a depth pre-pass before RenderStaticScene().
+    ///        Alpha-masked and blended instances are skipped and only write depth in the color pass.
+    void RenderStaticSceneDepth(IDeviceContext*         pCtx,
+                                const GLTF_StaticScene& Scene,
+                                const RenderInfo&       RenderParams,
+                                bool                    IsOccluderPass = false);
+
+    /// Computes the size of the bounding box diagonal projected to the screen, as a fraction of the viewport height.
+
+    /// \param [in] BB            - Bounding box.
+    /// \param [in] WorldViewProj - Matrix that transforms the box to clip space.
+    /// \return                     Projected size, or +inf if the box intersects the near plane.
+    static float GetScreenSize(const BoundBox& BB, const float4x4& WorldViewProj);
+
+    /// Selects the least detailed level of the primitive whose simplification error does not exceed MaxError.
+
+    /// \param [in] Primitive - GLTF primitive.
+    /// \param [in] MaxError  - Maximum error, in mesh space units.
+    /// \return                 Level index, where 0 is the full-detail primitive and
+    ///                          i > 0 refers to Primitive.LODs[i - 1].
+    static Uint32 SelectLOD(const GLTF::Primitive& Primitive, float MaxError);
+
+    /// Initializes resource bindings for a given GLTF model.
+
+    /// \note  In bindless mode (see CreateInfo::UseBindlessMaterials), all materials of the model
+    ///        share one SRB. Otherwise, materials that use the same textures, e.g. textures packed
+    ///        into the same atlases (see GLTF::Model::CreateInfo::TextureAtlas), share one SRB, and
+    ///        their attributes are written to a dynamic buffer when the material changes.
     void InitializeResourceBindings(GLTF::Model&               GLTFModel,
                                     IBuffer*                   pCameraAttribs,
                                     IBuffer*                   pLightAttribs);
 
-    /// Releases resource bindings for a given GLTF model and SRB type
+    /// Initializes resource bindings for a static scene.
+
+    /// \note  The scene must be built (see GLTF_StaticScene::Build()). Static scenes always use
+    ///        one SRB per material, also when CreateInfo::UseBindlessMaterials is true.
+    void InitializeResourceBindings(const GLTF_StaticScene& Scene,
+                                    IBuffer*                pCameraAttribs,
+                                    IBuffer*                pLightAttribs);
+
+    /// Releases resource bindings for a given static scene.
+    void ReleaseResourceBindings(const GLTF_StaticScene& Scene);
+
+    /// Releases resource bindings for a given GLTF model and SRB type.
+
+    /// \note The renderer caches sorted draw lists of the models it renders. The cache is reset
+    ///       when resource bindings are created or released, so bindings of a model must be
+    ///       released before the model is destroyed.
     void ReleaseResourceBindings(GLTF::Model& GLTFModel, size_t SRBTypeId = 0);
 
+    /// Sets the structured buffer with joint matrices used when CreateInfo::UseJointsBuffer is true.
+
+    /// \note The buffer must be set before any shader resource bindings are created.
+    void SetJointsBuffer(IBufferView* pJointsBufferSRV);
+
+    /// Sets the shadow map used when CreateInfo::UseShadows is true.
+
+    /// \note The shadow map must be set before any shader resource bindings are created.
+    void SetShadowMap(ITextureView* pShadowMapSRV);
+
     /// Precompute cubemaps used by IBL.
+
+    /// \param [in] pDevice           - Render device.
+    /// \param [in] pCtx              - Device context.
+    /// \param [in] pEnvironmentMap   - Environment map to precompute the cubemaps from.
+    /// \param [in] EnvMapContentHash - Hash of the environment map contents, e.g. of its source file
+    ///                                 (see ComputeHashRaw). If the hash is not zero and CreateInfo::IBLCacheDirectory
+    ///                                 is set, the cubemaps are loaded from the cache when they have been
+    ///                                 computed for the same environment map before.
     void PrecomputeCubemaps(IRenderDevice*  pDevice,
                             IDeviceContext* pCtx,
-                            ITextureView*   pEnvironmentMap);
+                            ITextureView*   pEnvironmentMap,
+                            size_t          EnvMapContentHash = 0);
+
+    /// Sets the IBL cubemaps precomputed by another renderer, e.g. to share them between
+    /// renderers that use the same environment map instead of precomputing them again.
+
+    /// \param [in] pIrradianceCubeSRV    - Irradiance cubemap, see GetIrradianceCubeSRV().
+    /// \param [in] pPrefilteredEnvMapSRV - Prefiltered environment map, see GetPrefilteredEnvMapSRV().
+    ///
+    /// \note The cubemaps must be set before any shader resource bindings are created.
+    void SetIBLCubemaps(ITextureView* pIrradianceCubeSRV, ITextureView* pPrefilteredEnvMapSRV);
 
     // clang-format off
     ITextureView* GetIrradianceCubeSRV()    { return m_pIrradianceCubeSRV; }
@@ -273,12 +484,104 @@ private:
 
     void CreatePSO(IRenderDevice* pDevice);
 
-    void RenderGLTFNode(IDeviceContext*                                pCtx,
-                        const GLTF::Node*                              node,
-                        GLTF::Material::ALPHA_MODE                     AlphaMode,
+    void SetCommonSRBResources(IShaderResourceBinding* pSRB,
+                               IBuffer*                pCameraAttribs,
+                               IBuffer*                pLightAttribs);
+
+    RefCntAutoPtr<IBuffer> InitMaterialSRB(IShaderResourceBinding* pSRB,
+                                           const GLTF::Material&   Material,
+                                           IBuffer*                pCameraAttribs,
+                                           IBuffer*                pLightAttribs,
+                                           IBuffer*                pSharedMaterialCB = nullptr);
+
+    RefCntAutoPtr<IBuffer> CreateMaterialCB(const GLTF::Material& Material);
+
+    void CreateDepthSRBs(const GLTF::Material& Material,
+                         IBuffer*              pMaterialCB);
+
+    void InitializeBindlessResourceBindings(GLTF::Model& GLTFModel,
+                                            IBuffer*     pCameraAttribs,
+                                            IBuffer*     pLightAttribs);
+
+    void CreateDepthPSOs(IRenderDevice*                  pDevice,
+                         GraphicsPipelineStateCreateInfo PSOCreateInfo);
+
+    void CreateStaticScenePSOs(IRenderDevice* pDevice);
+
+    void TransitionPendingMaterialBuffers(IDeviceContext* pCtx);
+
+    void UpdateShaderParameters(IDeviceContext* pCtx, const RenderInfo& RenderParams);
+
+    const Uint32* PrepareModelDraw(IDeviceContext*            pCtx,
+                                   const GLTF::Model&         GLTFModel,
+                                   const GLTF::ModelInstance* pInstance,
+                                   const RenderInfo&          RenderParams,
+                                   bool                       BindBuffers);
+
+    void RenderModelDepth(IDeviceContext*            pCtx,
+                          const GLTF::Model&         GLTFModel,
+                          const GLTF::ModelInstance* pInstance,
+                          const RenderInfo&          RenderParams,
+                          bool                       IsShadowPass);
+
+    void RenderModel(IDeviceContext*                                pCtx,
+                     const GLTF::Model&                             GLTFModel,
+                     const GLTF::ModelInstance*                     pInstance,
+                     const RenderInfo&                              RenderParams,
+                     std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
+                     size_t                                         SRBTypeId);
+
+    /// Single primitive draw of a flattened model.
+    struct DrawItem
+    {
+        const GLTF::Node*       pNode      = nullptr;
+        const GLTF::Primitive*  pPrimitive = nullptr;
+        IPipelineState*         pPSO       = nullptr;
+        IShaderResourceBinding* pSRB       = nullptr;
+
+        /// SRB of the depth-only passes
+        IShaderResourceBinding* pDepthSRB = nullptr;
+
+        /// Index of the material in the bindless materials buffer, or -1
+        Int32 MaterialIndex = -1;
+
+        /// Attributes of the material that shares the SRB with other materials, or null
+        const GLTFMaterialShaderInfo* pSharedMaterialInfo = nullptr;
+
+        /// View-space depth used to sort alpha-blended draws
+        float Depth = 0;
+    };
+
+    /// Draws of a model sorted by alpha mode, PSO, SRB, material and mesh.
+    struct DrawList
+    {
+        std::vector<DrawItem> Items;
+
+        /// Items of alpha mode i are in the range [AlphaModeOffsets[i], AlphaModeOffsets[i + 1]).
+        std::array<size_t, GLTF::Material::ALPHAMODE_BLEND + 2> AlphaModeOffsets = {};
+    };
+
+    /// State set by the previous draw of the current RenderModel() call.
+    struct DrawState
+    {
+        IPipelineState*         pPSO  = nullptr;
+        IShaderResourceBinding* pSRB  = nullptr;
+        const GLTF::Node*       pNode = nullptr;
+
+        Int32 MaterialIndex = -1;
+
+        const GLTFMaterialShaderInfo* pSharedMaterialInfo = nullptr;
+    };
+
+    const DrawList& GetDrawList(const GLTF::Model& GLTFModel, size_t SRBTypeId);
+
+    void RenderDrawItem(IDeviceContext*                                pCtx,
+                        const DrawItem&                                Item,
+                        const GLTF::ModelInstance*                     pInstance,
+                        const Uint32*                                  pFirstJoints,
                         const float4x4&                                ModelTransform,
                         std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
-                        size_t                                         SRBTypeId);
+                        DrawState&                                     State);
 
     struct PSOKey
     {
@@ -313,13 +616,45 @@ private:
         return Idx < m_PSOCache.size() ? m_PSOCache[Idx].RawPtr() : nullptr;
     }
 
+    static size_t GetDepthPSOIdx(bool IsShadowPass, GLTF::Material::ALPHA_MODE AlphaMode, bool DoubleSided)
+    {
+        return (IsShadowPass ? 4 : 0) + (AlphaMode == GLTF::Material::ALPHAMODE_MASK ? 2 : 0) + (DoubleSided ? 1 : 0);
+    }
+
     const CreateInfo m_Settings;
 
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+
+    const std::string m_IBLCacheDirectory;
+
+    // Whether bindless mode was requested and is supported by the device
+    const bool m_UseBindlessMaterials;
+
     static constexpr Uint32     BRDF_LUT_Dim = 512;
     RefCntAutoPtr<ITextureView> m_pBRDF_LUT_SRV;
 
+    // Shadow map set by SetShadowMap(). It is kept to initialize the static scene PSOs.
+    RefCntAutoPtr<ITextureView> m_pShadowMapSRV;
+
     std::vector<RefCntAutoPtr<IPipelineState>> m_PSOCache;
 
+    // Depth-only PSOs indexed by GetDepthPSOIdx()
+    std::array<RefCntAutoPtr<IPipelineState>, 8> m_DepthPSOs;
+    // Opaque depth-only PSOs have no mutable resources and share a single SRB
+    RefCntAutoPtr<IShaderResourceBinding> m_pDepthSRB;
+    // SRBs of the alpha-masked depth-only PSOs, one per material
+    std::unordered_map<const GLTF::Material*, RefCntAutoPtr<IShaderResourceBinding>> m_DepthSRBCache;
+
+    // Single- and double-sided PSOs of the static scenes, created by the first
+    // InitializeResourceBindings() call for a static scene
+    std::array<RefCntAutoPtr<IPipelineState>, 2> m_StaticScenePSOs;
+    // SRBs of the static scenes, indexed by batch
+    std::unordered_map<const GLTF_StaticScene*, std::vector<RefCntAutoPtr<IShaderResourceBinding>>> m_StaticSceneSRBs;
+    // Single- and double-sided depth-only PSOs of the static scenes, for the render pass and for
+    // the occluder pass, and their SRBs, one per scene
+    std::array<RefCntAutoPtr<IPipelineState>, 4>                                         m_StaticSceneDepthPSOs;
+    std::unordered_map<const GLTF_StaticScene*, RefCntAutoPtr<IShaderResourceBinding>> m_StaticSceneDepthSRBs;
+
     RefCntAutoPtr<ITextureView> m_pWhiteTexSRV;
     RefCntAutoPtr<ITextureView> m_pBlackTexSRV;
     RefCntAutoPtr<ITextureView> m_pDefaultNormalMapSRV;
@@ -353,6 +688,44 @@ private:
     };
     std::unordered_map<SRBCacheKey, RefCntAutoPtr<IShaderResourceBinding>, SRBCacheKey::Hasher> m_SRBCache;
 
+    // Attributes of the materials whose default SRB is shared with other materials. The attributes
+    // are written to m_SharedMaterialAttribsCB when the material changes.
+    std::unordered_map<const GLTF::Material*, GLTFMaterialShaderInfo> m_SharedSRBMaterials;
+
+    struct DrawListKey
+    {
+        const GLTF::Model* pModel    = nullptr;
+        size_t             SRBTypeId = 0;
+
+        DrawListKey(const GLTF::Model* _pModel,
+                    size_t             _SRBTypeId) :
+            pModel{_pModel},
+            SRBTypeId{_SRBTypeId}
+        {}
+
+        bool operator==(const DrawListKey& Key) const
+        {
+            return pModel == Key.pModel && SRBTypeId == Key.SRBTypeId;
+        }
+
+        struct Hasher
+        {
+            size_t operator()(const DrawListKey& Key) const
+            {
+                return ComputeHash(Key.pModel, Key.SRBTypeId);
+            }
+        };
+    };
+    // Draw lists only depend on the model structure and its SRBs, so they are built once and
+    // invalidated when resource bindings change.
+    std::unordered_map<DrawListKey, DrawList, DrawListKey::Hasher> m_DrawListCache;
+
+    // Material buffers created since the last RenderModel() call that need a state transition
+    std::vector<std::pair<RefCntAutoPtr<IBuffer>, RESOURCE_STATE>> m_PendingMaterialBuffers;
+
+    std::vector<DrawItem> m_BlendItems;
+    std::vector<float>    m_NodeLODErrors;
+
     static constexpr TEXTURE_FORMAT IrradianceCubeFmt    = TEX_FORMAT_RGBA32_FLOAT;
     static constexpr TEXTURE_FORMAT PrefilteredEnvMapFmt = TEX_FORMAT_RGBA16_FLOAT;
     static constexpr Uint32         IrradianceCubeDim    = 64;
@@ -366,10 +739,15 @@ private:
     RefCntAutoPtr<IShaderResourceBinding> m_pPrefilterEnvMapSRB;
 
     RenderInfo                 m_RenderParams;
+    std::vector<Uint32>        m_FirstJoints;
     RefCntAutoPtr<IRenderPass> m_pRenderPass;
 
     RefCntAutoPtr<IBuffer> m_TransformsCB;
+    RefCntAutoPtr<IBuffer> m_JointMatricesCB;
     RefCntAutoPtr<IBuffer> m_GLTFAttribsCB;
+    RefCntAutoPtr<IBuffer> m_DepthPassAttribsCB;
+    RefCntAutoPtr<IBuffer> m_BindlessDrawAttribsCB;
+    RefCntAutoPtr<IBuffer> m_SharedMaterialAttribsCB;
     RefCntAutoPtr<IBuffer> m_PrecomputeEnvMapAttribsCB;
 };
 
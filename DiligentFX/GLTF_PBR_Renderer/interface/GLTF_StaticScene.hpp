@@ -0,0 +1,228 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+#include "../../../DiligentTools/AssetLoader/interface/GLTFLoader.hpp"
+
+namespace Diligent
+{
+
+class HiZPyramid;
+
+/// Static GLTF geometry that is culled and rendered by the GPU.
+
+/// Vertices and indices of all models in the scene are packed into shared buffers, and
+/// transforms and world-space bounding boxes of all primitive instances are kept in a GPU buffer.
+/// Every frame, Cull() tests the instances against the view frustum in a compute pass that
+/// writes indirect draw arguments and the indices of the visible instances. When a Hi-Z pyramid
+/// of the previous frame is given, the instances are also tested for occlusion. The previous frame
+/// may hide objects that are visible in this one, so the application then renders the depth of the
+/// instances that passed the test, builds a new pyramid from it and calls CullOccluded(), which
+/// tests the occluded instances again and adds the visible ones to the draw arguments.
+/// GLTF_PBR_Renderer::RenderStaticScene() then issues one indirect draw per batch, where a batch
+/// contains all instances of one primitive, so that the CPU cost of rendering the scene
+/// does not depend on the number of instances.
+///
+/// Models are rendered in their current pose at the time Build() is called. Skinning, levels
+/// of detail and alpha-blended materials are not supported.
+class GLTF_StaticScene
+{
+public:
+    /// Draw batch: all instances of one primitive of a model
+    struct Batch
+    {
+        /// Material of the primitive
+        const GLTF::Material* pMaterial = nullptr;
+
+        /// Location of the primitive in the packed index buffer
+        Uint32 IndexCount = 0;
+        Uint32 FirstIndex = 0;
+
+        /// Offset of the model's vertices in the packed vertex buffer
+        Uint32 BaseVertex = 0;
+
+        /// Range of the batch in the visible instances buffer
+        Uint32 FirstInstance = 0;
+        Uint32 NumInstances  = 0;
+    };
+
+    /// Culling statistics
+    struct Statistics
+    {
+        /// Total number of instances in the scene
+        Uint32 NumInstances = 0;
+
+        /// Number of instances outside of the view frustum
+        Uint32 NumFrustumCulled = 0;
+
+        /// Number of instances in the view frustum hidden by both Hi-Z tests
+        Uint32 NumOcclusionCulled = 0;
+    };
+
+    /// Initializes the scene.
+
+    /// \param [in] pDevice - Render device. The device must support compute shaders.
+    explicit GLTF_StaticScene(IRenderDevice* pDevice);
+
+    // clang-format off
+    GLTF_StaticScene           (const GLTF_StaticScene&)  = delete;
+    GLTF_StaticScene           (      GLTF_StaticScene&&) = delete;
+    GLTF_StaticScene& operator=(const GLTF_StaticScene&)  = delete;
+    GLTF_StaticScene& operator=(      GLTF_StaticScene&&) = delete;
+    // clang-format on
+
+    /// Adds an instance of the model to the scene.
+
+    /// \param [in] GLTFModel - GLTF model. The model must stay alive as long as the scene.
+    /// \param [in] Transform - Model transform matrix.
+    ///
+    /// \note Instances can only be added before the scene is built.
+    void AddInstance(const GLTF::Model& GLTFModel, const float4x4& Transform);
+
+    /// Packs the geometry of all added models and creates GPU buffers.
+
+    /// \note This method must be called outside of a render pass.
+    void Build(IDeviceContext* pCtx);
+
+    /// Culls the instances and writes indirect draw arguments.
+
+    /// \param [in] pCtx     - Device context.
+    /// \param [in] ViewProj - View-projection matrix of the camera.
+    /// \param [in] pHiZ     - Optional Hi-Z pyramid of the previous frame. If the pyramid is null
+    ///                        or is not valid, only frustum culling is performed. Otherwise,
+    ///                        CullOccluded() must be called before the scene is rendered.
+    ///
+    /// \note This method must be called outside of a render pass. When it returns, the draw arguments
+    ///       buffer is in RESOURCE_STATE_INDIRECT_ARGUMENT state, and the visible instances buffer
+    ///       is in RESOURCE_STATE_VERTEX_BUFFER state.
+    void Cull(IDeviceContext* pCtx, const float4x4& ViewProj, const HiZPyramid* pHiZ = nullptr);
+
+    /// Tests the instances culled by the Hi-Z test of the last Cull() call again and adds the visible
+    /// ones to the draw arguments.
+
+    /// \param [in] pCtx - Device context.
+    /// \param [in] HiZ  - Hi-Z pyramid built from the depth of the instances that passed the last
+    ///                    Cull() call, rendered with its view-projection matrix, e.g. by
+    ///                    GLTF_PBR_Renderer::RenderStaticSceneDepth().
+    ///
+    /// \note This method must be called outside of a render pass. It does nothing if the last
+    ///       Cull() call did not perform occlusion culling.
+    void CullOccluded(IDeviceContext* pCtx, const HiZPyramid& HiZ);
+
+    /// Returns the statistics of the most recent culling pass whose results have been read back
+    /// from the GPU. The statistics are typically a few frames old.
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+    bool IsBuilt() const { return m_IsBuilt; }
+
+    // clang-format off
+    const std::vector<Batch>& GetBatches()           const { return m_Batches; }
+    Uint32                    GetNumInstances()      const { return m_NumInstances; }
+
+    IBuffer*     GetVertexBuffer()           const { return m_pVertexBuffer.RawPtr<IBuffer>(); }
+    IBuffer*     GetIndexBuffer()            const { return m_pIndexBuffer.RawPtr<IBuffer>(); }
+    IBuffer*     GetDrawArgsBuffer()         const { return m_pDrawArgsBuffer.RawPtr<IBuffer>(); }
+    IBuffer*     GetVisibleInstancesBuffer() const { return m_pVisibleInstancesBuffer.RawPtr<IBuffer>(); }
+    IBufferView* GetInstancesBufferSRV()     const { return m_pInstancesBufferSRV.RawPtr<IBufferView>(); }
+    // clang-format on
+
+    /// Size of the indirect draw arguments of one batch in the draw arguments buffer:
+    /// IndexCount, InstanceCount, FirstIndex, BaseVertex, FirstInstance.
+    static constexpr Uint32 DrawArgsStride = 5 * sizeof(Uint32);
+
+    /// Number of threads in a culling thread group.
+    static constexpr Uint32 ThreadGroupSize = 64;
+
+private:
+    RefCntAutoPtr<IPipelineState> CreateCullingPSO(bool OcclusionCulling, bool OcclusionRetest);
+
+    RefCntAutoPtr<IShaderResourceBinding> CreateCullingSRB(IPipelineState* pPSO);
+
+    void ReadBackStatistics(IDeviceContext* pCtx);
+
+    struct InstanceInfo
+    {
+        const GLTF::Model* pModel = nullptr;
+        float4x4           Transform;
+    };
+
+    RefCntAutoPtr<IRenderDevice>          m_pDevice;
+    RefCntAutoPtr<IPipelineState>         m_pCullingPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pCullingSRB;
+    RefCntAutoPtr<IBuffer>                m_pCullingAttribsCB;
+
+    // Frustum and occlusion culling pipeline and the pipeline that tests the occluded instances
+    // again, created when a Hi-Z pyramid is used for the first time
+    RefCntAutoPtr<IPipelineState>         m_pOcclusionCullingPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pOcclusionCullingSRB;
+    RefCntAutoPtr<IPipelineState>         m_pOcclusionRetestPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pOcclusionRetestSRB;
+
+    // Flags of the instances culled by the Hi-Z test of the last Cull() call
+    RefCntAutoPtr<IBuffer>     m_pOccludedInstancesBuffer;
+    RefCntAutoPtr<IBufferView> m_pOccludedInstancesUAV;
+    bool                       m_HasOccludedInstances = false;
+    float4x4                   m_CullingViewProj;
+
+    RefCntAutoPtr<IBuffer>     m_pVertexBuffer;
+    RefCntAutoPtr<IBuffer>     m_pIndexBuffer;
+    RefCntAutoPtr<IBuffer>     m_pDrawArgsBuffer;
+    RefCntAutoPtr<IBuffer>     m_pVisibleInstancesBuffer;
+    RefCntAutoPtr<IBufferView> m_pInstancesBufferSRV;
+    RefCntAutoPtr<IBufferView> m_pDrawArgsUAV;
+    RefCntAutoPtr<IBufferView> m_pVisibleInstancesUAV;
+
+    // Culling statistics are copied to the staging buffer that keeps the statistics of the
+    // last StatisticsHistorySize frames, and are read back once the fence is signaled.
+    static constexpr Uint32 StatisticsHistorySize = 4;
+    // Frustum culled, occluded in the first pass, visible in the second pass
+    static constexpr Uint32 NumStatistics = 3;
+
+    RefCntAutoPtr<IBuffer>     m_pCullingStatsBuffer;
+    RefCntAutoPtr<IBufferView> m_pCullingStatsUAV;
+    RefCntAutoPtr<IBuffer>     m_pCullingStatsStaging;
+    RefCntAutoPtr<IFence>      m_pCullingStatsAvailable;
+    Uint64                     m_FrameId = 1; // Fence value 0 means no frame has completed
+    Statistics                 m_Stats;
+
+    std::vector<InstanceInfo> m_Instances;
+    std::vector<Batch>        m_Batches;
+    Uint32                    m_NumInstances = 0;
+    bool                      m_IsBuilt      = false;
+
+    // Draw arguments with zero instance counts that reset the buffer before culling
+    std::vector<Uint32> m_ResetDrawArgs;
+};
+
+} // namespace Diligent
@@ -0,0 +1,152 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <cstring>
+#include <algorithm>
+
+#include "GLTF_AnimationBatch.hpp"
+#include "GraphicsAccessories.hpp"
+#include "MapHelper.hpp"
+
+namespace Diligent
+{
+
+GLTF_AnimationBatch::GLTF_AnimationBatch(IRenderDevice* pDevice, const CreateInfo& CI) :
+    m_Settings{CI},
+    m_ThreadPool{CI.NumWorkerThreads}
+{
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "GLTF joints buffer";
+    BuffDesc.uiSizeInBytes     = sizeof(float4x4) * std::max(CI.MaxJointCount, 1u);
+    BuffDesc.Usage             = USAGE_DYNAMIC;
+    BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+    BuffDesc.CPUAccessFlags    = CPU_ACCESS_WRITE;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(float4x4);
+    pDevice->CreateBuffer(BuffDesc, nullptr, &m_pJointsBuffer);
+    if (!m_pJointsBuffer)
+        LOG_ERROR_AND_THROW("Failed to create GLTF joints buffer");
+
+    m_pJointsBufferSRV = m_pJointsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+}
+
+Uint32 GLTF_AnimationBatch::GetModelJointCount(const GLTF::Model& GLTFModel)
+{
+    Uint32 JointCount = 0;
+    for (const auto* node : GLTFModel.LinearNodes)
+    {
+        if (node->_Mesh && node->_Skin != nullptr)
+            JointCount += static_cast<Uint32>(node->_Skin->Joints.size());
+    }
+    return JointCount;
+}
+
+void GLTF_AnimationBatch::AddInstance(GLTF::ModelInstance& Instance, Uint32 AnimationIndex, float Time)
+{
+    // Jobs update instances in parallel, so an instance must only be added once
+    if (!m_AddedInstances.insert(&Instance).second)
+        return;
+
+    InstanceInfo Info;
+    Info.pInstance      = &Instance;
+    Info.AnimationIndex = AnimationIndex;
+    Info.Time           = Time;
+    Info.Animate        = true;
+    m_Instances.emplace_back(Info);
+}
+
+void GLTF_AnimationBatch::AddInstance(GLTF::ModelInstance& Instance)
+{
+    if (!m_AddedInstances.insert(&Instance).second)
+        return;
+
+    InstanceInfo Info;
+    Info.pInstance = &Instance;
+    m_Instances.emplace_back(Info);
+}
+
+void GLTF_AnimationBatch::Execute(IDeviceContext* pCtx)
+{
+    m_FirstJoints.clear();
+    m_JointCount = 0;
+
+    // Assign ranges in the joints buffer to all instances
+    for (auto& Info : m_Instances)
+    {
+        const auto InstJointCount = GetModelJointCount(Info.pInstance->GLTFModel);
+        if (m_JointCount + InstJointCount > m_Settings.MaxJointCount)
+        {
+            LOG_WARNING_MESSAGE_ONCE("The total number of joints exceeds the size of the joints buffer (", m_Settings.MaxJointCount,
+                                     "). Some instances will not be animated. Increase CreateInfo::MaxJointCount.");
+            continue;
+        }
+        Info.FirstJoint = m_JointCount;
+        m_JointCount += InstJointCount;
+        m_FirstJoints.emplace(Info.pInstance, Info.FirstJoint);
+    }
+
+    // Instances without joints and instances that do not fit into the buffer are still animated
+    MapHelper<float4x4> Joints;
+    if (m_JointCount != 0)
+        Joints.Map(pCtx, m_pJointsBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+    float4x4* pJoints = Joints;
+
+    auto UpdateInstances = [&](size_t Begin, size_t End) {
+        for (size_t i = Begin; i < End; ++i)
+        {
+            const auto& Info = m_Instances[i];
+
+            // Instances never share data, so they can be safely updated in parallel
+            auto& Instance = *Info.pInstance;
+            if (Info.Animate)
+                Instance.UpdateAnimation(Info.AnimationIndex, Info.Time);
+
+            if (pJoints == nullptr || Info.FirstJoint == InvalidJoint)
+                continue;
+
+            auto* pDst = pJoints + Info.FirstJoint;
+            for (const auto* node : Instance.GLTFModel.LinearNodes)
+            {
+                if (!node->_Mesh || node->_Skin == nullptr)
+                    continue;
+
+                const auto& JointMatrices = Instance.GetMeshTransforms(*node).jointMatrices;
+                const auto  JointCount    = node->_Skin->Joints.size();
+                VERIFY_EXPR(JointMatrices.size() == JointCount);
+                memcpy(pDst, JointMatrices.data(), sizeof(float4x4) * std::min(JointMatrices.size(), JointCount));
+                pDst += JointCount;
+            }
+        }
+    };
+    m_ThreadPool.ParallelFor(m_Instances.size(), m_Settings.InstancesPerJob, UpdateInstances);
+
+    m_Instances.clear();
+    m_AddedInstances.clear();
+}
+
+} // namespace Diligent
@@ -0,0 +1,224 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+
+#include "GLTF_ComputeSkinning.hpp"
+#include "../../../Utilities/include/DiligentFXShaderSourceStreamFactory.hpp"
+#include "ShaderMacroHelper.hpp"
+#include "GraphicsUtilities.h"
+#include "MapHelper.hpp"
+
+namespace Diligent
+{
+
+#include "Shaders/GLTF_PBR/public/GLTF_PBR_Structures.fxh"
+
+GLTF_ComputeSkinning::GLTF_ComputeSkinning(IRenderDevice* pDevice, IBufferView* pJointsBufferSRV) :
+    m_pDevice{pDevice}
+{
+    CreateUniformBuffer(pDevice, sizeof(GLTFSkinningAttribs), "GLTF skinning attribs CB", &m_pSkinningAttribsCB);
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.UseCombinedTextureSamplers = true;
+    ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("SKINNING_THREAD_GROUP_SIZE", ThreadGroupSize);
+    ShaderCI.Macros = Macros;
+
+    RefCntAutoPtr<IShader> pCS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "GLTF skinning CS";
+        ShaderCI.FilePath        = "SkinGLTF.csh";
+        pDevice->CreateShader(ShaderCI, &pCS);
+    }
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name         = "GLTF skinning PSO";
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_COMPUTE, "cbSkinningAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_COMPUTE, "g_JointMatrices",   SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    PSOCreateInfo.pCS = pCS;
+    pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pSkinningPSO);
+    if (!m_pSkinningPSO)
+        LOG_ERROR_AND_THROW("Failed to create GLTF skinning PSO");
+
+    m_pSkinningPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbSkinningAttribs")->Set(m_pSkinningAttribsCB);
+    m_pSkinningPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "g_JointMatrices")->Set(pJointsBufferSRV);
+}
+
+GLTF_ComputeSkinning::SkinnedVertices GLTF_ComputeSkinning::CreateSkinnedVertices(IDeviceContext* pCtx, const GLTF::Model& GLTFModel)
+{
+    // The model is shared between instances and is never modified
+    auto* pSrcVB0 = GLTFModel.pVertexBuffer[0].RawPtr<IBuffer>();
+    auto* pSrcVB1 = GLTFModel.pVertexBuffer[1].RawPtr<IBuffer>();
+    VERIFY_EXPR(pSrcVB0 != nullptr && pSrcVB1 != nullptr);
+
+    SkinnedVertices Vertices;
+
+    BufferDesc VBDesc;
+    VBDesc.Name              = "GLTF skinned vertex attribs 0 buffer";
+    VBDesc.uiSizeInBytes     = pSrcVB0->GetDesc().uiSizeInBytes;
+    VBDesc.BindFlags         = BIND_VERTEX_BUFFER | BIND_UNORDERED_ACCESS;
+    VBDesc.Usage             = USAGE_DEFAULT;
+    VBDesc.Mode              = BUFFER_MODE_FORMATTED;
+    VBDesc.ElementByteStride = sizeof(float);
+    m_pDevice->CreateBuffer(VBDesc, nullptr, &Vertices.pVertexBuffer);
+    if (!Vertices.pVertexBuffer)
+        LOG_ERROR_AND_THROW("Failed to create GLTF skinned vertex buffer");
+
+    // Vertices of meshes that are not skinned as well as texture coordinates are never overwritten
+    pCtx->CopyBuffer(pSrcVB0, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                     Vertices.pVertexBuffer, 0, VBDesc.uiSizeInBytes, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    BufferViewDesc ViewDesc;
+    ViewDesc.ViewType             = BUFFER_VIEW_SHADER_RESOURCE;
+    ViewDesc.Format.ValueType     = VT_FLOAT32;
+    ViewDesc.Format.NumComponents = 1;
+
+    RefCntAutoPtr<IBufferView> pVB0SRV;
+    pSrcVB0->CreateView(ViewDesc, &pVB0SRV);
+
+    ViewDesc.Format.NumComponents = 4;
+    RefCntAutoPtr<IBufferView> pVB1SRV;
+    pSrcVB1->CreateView(ViewDesc, &pVB1SRV);
+
+    ViewDesc.ViewType             = BUFFER_VIEW_UNORDERED_ACCESS;
+    ViewDesc.Format.NumComponents = 1;
+    RefCntAutoPtr<IBufferView> pSkinnedVB0UAV;
+    Vertices.pVertexBuffer->CreateView(ViewDesc, &pSkinnedVB0UAV);
+
+    m_pSkinningPSO->CreateShaderResourceBinding(&Vertices.pSRB, true);
+    Vertices.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_VertexAttribs0")->Set(pVB0SRV);
+    Vertices.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_VertexAttribs1")->Set(pVB1SRV);
+    Vertices.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_SkinnedVertexAttribs0")->Set(pSkinnedVB0UAV);
+
+    // Source buffers are read by the skinning shader and by the renderer in the same frame
+    // clang-format off
+    StateTransitionDesc Barriers[] =
+    {
+        {pSrcVB0,                RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER | RESOURCE_STATE_SHADER_RESOURCE, true},
+        {pSrcVB1,                RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER | RESOURCE_STATE_SHADER_RESOURCE, true},
+        {Vertices.pVertexBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, true}
+    };
+    // clang-format on
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+    return Vertices;
+}
+
+void GLTF_ComputeSkinning::AddInstance(const GLTF::ModelInstance& Instance, SkinnedVertices& Vertices)
+{
+    InstanceInfo Info;
+    Info.pInstance = &Instance;
+    Info.pVertices = &Vertices;
+    m_Instances.emplace_back(Info);
+}
+
+void GLTF_ComputeSkinning::Execute(IDeviceContext* pCtx, const GLTF_AnimationBatch& Batch)
+{
+    m_Barriers.clear();
+    for (const auto& Info : m_Instances)
+    {
+        if (Batch.GetFirstJoint(*Info.pInstance) != GLTF_AnimationBatch::InvalidJoint)
+            m_Barriers.emplace_back(Info.pVertices->pVertexBuffer, RESOURCE_STATE_VERTEX_BUFFER, RESOURCE_STATE_UNORDERED_ACCESS, true);
+    }
+    if (m_Barriers.empty())
+    {
+        m_Instances.clear();
+        return;
+    }
+    pCtx->TransitionResourceStates(static_cast<Uint32>(m_Barriers.size()), m_Barriers.data());
+
+    pCtx->SetPipelineState(m_pSkinningPSO);
+    for (const auto& Info : m_Instances)
+    {
+        auto FirstJoint = Batch.GetFirstJoint(*Info.pInstance);
+        if (FirstJoint == GLTF_AnimationBatch::InvalidJoint)
+            continue;
+
+        pCtx->CommitShaderResources(Info.pVertices->pSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+        // Joint palettes are laid out in the same order by GLTF_AnimationBatch
+        for (const auto* node : Info.pInstance->GLTFModel.LinearNodes)
+        {
+            if (!node->_Mesh || node->_Skin == nullptr)
+                continue;
+
+            Uint32 FirstVertex = ~0u;
+            Uint32 EndVertex   = 0;
+            for (const auto& primitive : node->_Mesh->Primitives)
+            {
+                FirstVertex = std::min(FirstVertex, primitive->FirstVertex);
+                EndVertex   = std::max(EndVertex, primitive->FirstVertex + primitive->VertexCount);
+            }
+
+            if (FirstVertex < EndVertex)
+            {
+                {
+                    MapHelper<GLTFSkinningAttribs> Attribs(pCtx, m_pSkinningAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+                    Attribs->FirstVertex = FirstVertex;
+                    Attribs->NumVertices = EndVertex - FirstVertex;
+                    Attribs->FirstJoint  = FirstJoint;
+                }
+
+                DispatchComputeAttribs DispatchAttribs((EndVertex - FirstVertex + ThreadGroupSize - 1) / ThreadGroupSize, 1, 1);
+                pCtx->DispatchCompute(DispatchAttribs);
+            }
+
+            FirstJoint += static_cast<Uint32>(node->_Skin->Joints.size());
+        }
+    }
+
+    for (auto& Barrier : m_Barriers)
+    {
+        Barrier.OldState = RESOURCE_STATE_UNORDERED_ACCESS;
+        Barrier.NewState = RESOURCE_STATE_VERTEX_BUFFER;
+    }
+    pCtx->TransitionResourceStates(static_cast<Uint32>(m_Barriers.size()), m_Barriers.data());
+
+    m_Instances.clear();
+}
+
+} // namespace Diligent
@@ -27,6 +27,8 @@
 
 #include <cstring>
 #include <array>
+#include <algorithm>
+#include <sstream>
 
 #include "GLTF_PBR_Renderer.hpp"
 #include "../../../Utilities/include/DiligentFXShaderSourceStreamFactory.hpp"
@@ -37,19 +39,210 @@
 #include "GraphicsUtilities.h"
 #include "MapHelper.hpp"
 #include "GraphicsAccessories.hpp"
+#include "TextureUtilities.h"
+#include "FileSystem.hpp"
 
 namespace Diligent
 {
 
 const SamplerDesc GLTF_PBR_Renderer::CreateInfo::DefaultSampler = Sam_LinearWrap;
 
+namespace
+{
+
+// Sample counts used to precompute IBL textures. They are part of the IBL cache key.
+constexpr Uint32 IrradianceNumPhiSamples   = 64;
+constexpr Uint32 IrradianceNumThetaSamples = 32;
+constexpr Uint32 PrefilterEnvMapNumSamples = 256;
+
+// Must be incremented whenever the precomputation shaders change
+constexpr Uint32 IBLCacheVersion = 1;
+
+std::string GetIBLCacheFilePath(const std::string& CacheDir, const char* Name, size_t Key)
+{
+    std::stringstream ss;
+    ss << CacheDir << FileSystem::GetSlashSymbol() << Name << '_' << std::hex << Key << ".dds";
+    return ss.str();
+}
+
+// Loads a texture from the IBL cache and copies it into the destination texture
+bool LoadCachedIBLTexture(IRenderDevice* pDevice, IDeviceContext* pCtx, const std::string& FilePath, ITexture* pDstTex)
+{
+    if (!FileSystem::FileExists(FilePath.c_str()))
+        return false;
+
+    RefCntAutoPtr<ITexture> pCachedTex;
+    try
+    {
+        CreateTextureFromFile(FilePath.c_str(), TextureLoadInfo{"Cached IBL texture"}, pDevice, &pCachedTex);
+    }
+    catch (...)
+    {
+    }
+    if (!pCachedTex)
+    {
+        LOG_WARNING_MESSAGE("Failed to load cached IBL texture '", FilePath, "'");
+        return false;
+    }
+
+    const auto& SrcDesc = pCachedTex->GetDesc();
+    const auto& DstDesc = pDstTex->GetDesc();
+    if (SrcDesc.Width != DstDesc.Width || SrcDesc.Height != DstDesc.Height || SrcDesc.ArraySize != DstDesc.ArraySize ||
+        SrcDesc.MipLevels != DstDesc.MipLevels || SrcDesc.Format != DstDesc.Format)
+    {
+        LOG_WARNING_MESSAGE("Cached IBL texture '", FilePath, "' does not match the description of texture '", DstDesc.Name, "'");
+        return false;
+    }
+
+    for (Uint32 slice = 0; slice < DstDesc.ArraySize; ++slice)
+    {
+        for (Uint32 mip = 0; mip < DstDesc.MipLevels; ++mip)
+        {
+            CopyTextureAttribs CopyAttribs{pCachedTex, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pDstTex, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            CopyAttribs.SrcMipLevel = mip;
+            CopyAttribs.SrcSlice    = slice;
+            CopyAttribs.DstMipLevel = mip;
+            CopyAttribs.DstSlice    = slice;
+            pCtx->CopyTexture(CopyAttribs);
+        }
+    }
+
+    return true;
+}
+
+// Reads the texture back from the GPU and writes it to the IBL cache
+void SaveIBLTextureToCache(IRenderDevice* pDevice, IDeviceContext* pCtx, ITexture* pSrcTex, const std::string& CacheDir, const std::string& FilePath)
+{
+    if (pDevice->GetDeviceCaps().IsGLDevice())
+    {
+        LOG_WARNING_MESSAGE_ONCE("Reading textures back is not supported in OpenGL backend, so IBL textures will not be cached");
+        return;
+    }
+
+    if (!FileSystem::PathExists(CacheDir.c_str()) && !FileSystem::CreateDirectory(CacheDir.c_str()))
+    {
+        LOG_WARNING_MESSAGE("Failed to create IBL cache directory '", CacheDir, "'");
+        return;
+    }
+
+    const auto& SrcDesc = pSrcTex->GetDesc();
+
+    // Staging textures can't be cube maps in D3D11
+    auto StagingDesc           = SrcDesc;
+    StagingDesc.Name           = "IBL cache staging texture";
+    StagingDesc.Type           = RESOURCE_DIM_TEX_2D_ARRAY;
+    StagingDesc.Usage          = USAGE_STAGING;
+    StagingDesc.BindFlags      = BIND_NONE;
+    StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+
+    RefCntAutoPtr<ITexture> pStagingTex;
+    pDevice->CreateTexture(StagingDesc, nullptr, &pStagingTex);
+    if (!pStagingTex)
+        return;
+
+    for (Uint32 slice = 0; slice < SrcDesc.ArraySize; ++slice)
+    {
+        for (Uint32 mip = 0; mip < SrcDesc.MipLevels; ++mip)
+        {
+            CopyTextureAttribs CopyAttribs{pSrcTex, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pStagingTex, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            CopyAttribs.SrcMipLevel = mip;
+            CopyAttribs.SrcSlice    = slice;
+            CopyAttribs.DstMipLevel = mip;
+            CopyAttribs.DstSlice    = slice;
+            pCtx->CopyTexture(CopyAttribs);
+        }
+    }
+    pCtx->WaitForIdle();
+
+    std::vector<TextureSubResData> SubResources;
+    SubResources.reserve(SrcDesc.ArraySize * SrcDesc.MipLevels);
+    for (Uint32 slice = 0; slice < SrcDesc.ArraySize; ++slice)
+    {
+        for (Uint32 mip = 0; mip < SrcDesc.MipLevels; ++mip)
+        {
+            MappedTextureSubresource MappedData;
+            pCtx->MapTextureSubresource(pStagingTex, mip, slice, MAP_READ, MAP_FLAG_NONE, nullptr, MappedData);
+            SubResources.emplace_back(MappedData.pData, MappedData.Stride, MappedData.DepthStride);
+        }
+    }
+
+    TextureData TexData{SubResources.data(), static_cast<Uint32>(SubResources.size())};
+    if (!SaveTextureAsDDS(FilePath.c_str(), SrcDesc, TexData))
+        LOG_WARNING_MESSAGE("Failed to write IBL texture to the cache file '", FilePath, "'");
+
+    for (Uint32 slice = 0; slice < SrcDesc.ArraySize; ++slice)
+    {
+        for (Uint32 mip = 0; mip < SrcDesc.MipLevels; ++mip)
+            pCtx->UnmapTextureSubresource(pStagingTex, mip, slice);
+    }
+}
+
+// Macros of the pipelines that use the GLTF PBR pixel shader
+void AddMaterialShaderMacros(ShaderMacroHelper& Macros, const GLTF_PBR_Renderer::CreateInfo& Settings)
+{
+    Macros.AddShaderMacro("MAX_NUM_JOINTS", GLTF_PBR_Renderer::MaxNumJoints);
+    Macros.AddShaderMacro("ALLOW_DEBUG_VIEW", Settings.AllowDebugView);
+    Macros.AddShaderMacro("TONE_MAPPING_MODE", "TONE_MAPPING_MODE_UNCHARTED2");
+    Macros.AddShaderMacro("GLTF_PBR_USE_IBL", Settings.UseIBL);
+    Macros.AddShaderMacro("GLTF_PBR_USE_AO", Settings.UseAO);
+    Macros.AddShaderMacro("GLTF_PBR_USE_EMISSIVE", Settings.UseEmissive);
+    Macros.AddShaderMacro("GLTF_PBR_USE_SHADOWS", Settings.UseShadows);
+    if (Settings.UseShadows)
+        Macros.AddShaderMacro("SHADOW_FILTER_SIZE", Settings.ShadowFilterSize);
+}
+
+// The shadow map is shared by all materials and is bound as a static variable
+void AddShadowMapResources(std::vector<ShaderResourceVariableDesc>& Vars,
+                           std::vector<ImmutableSamplerDesc>&       ImtblSamplers,
+                           const GLTF_PBR_Renderer::CreateInfo&     Settings)
+{
+    if (!Settings.UseShadows)
+        return;
+
+    Vars.emplace_back(SHADER_TYPE_PIXEL, "g_tex2DShadowMap", SHADER_RESOURCE_VARIABLE_TYPE_STATIC);
+    ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_tex2DShadowMap", Sam_ComparsionLinearClamp);
+}
+
+// Immutable samplers of the material textures when every material has its own SRB
+void AddMaterialTextureSamplers(std::vector<ImmutableSamplerDesc>& ImtblSamplers, const GLTF_PBR_Renderer::CreateInfo& Settings)
+{
+    // clang-format off
+    if (Settings.UseImmutableSamplers)
+    {
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_ColorMap",              Settings.ColorMapImmutableSampler);
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_PhysicalDescriptorMap", Settings.PhysDescMapImmutableSampler);
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_NormalMap",             Settings.NormalMapImmutableSampler);
+    }
+    // clang-format on
+
+    if (Settings.UseAO)
+    {
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_AOMap", Settings.AOMapImmutableSampler);
+    }
+
+    if (Settings.UseEmissive)
+    {
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_EmissiveMap", Settings.EmissiveMapImmutableSampler);
+    }
+}
+
+} // namespace
+
 GLTF_PBR_Renderer::GLTF_PBR_Renderer(IRenderDevice*    pDevice,
                                      IDeviceContext*   pCtx,
                                      const CreateInfo&           CI,
                                      RefCntAutoPtr<IRenderPass>& pRenderPass) :
     m_Settings{CI},
+    m_pDevice{pDevice},
+    m_IBLCacheDirectory{CI.IBLCacheDirectory != nullptr ? CI.IBLCacheDirectory : ""},
+    m_UseBindlessMaterials{CI.UseBindlessMaterials && pDevice->GetDeviceCaps().Features.BindlessResources},
     m_pRenderPass{pRenderPass}
 {
+    if (CI.UseBindlessMaterials && !m_UseBindlessMaterials)
+        LOG_WARNING_MESSAGE("Bindless resources are not supported by the device. GLTF materials will be rendered with one SRB per material.");
+    // Default textures take the first three elements of the bindless texture array
+    VERIFY(!m_UseBindlessMaterials || CI.MaxBindlessTextures >= 3, "Bindless texture array must have at least 3 elements");
+
     if (m_Settings.UseIBL)
     {
         PrecomputeBRDF(pDevice, pCtx);
@@ -129,17 +322,40 @@ GLTF_PBR_Renderer::GLTF_PBR_Renderer(IRenderDevice*    pDevice,
     if (CI.RTVFmt != TEX_FORMAT_UNKNOWN || CI.DSVFmt != TEX_FORMAT_UNKNOWN)
     {
         CreateUniformBuffer(pDevice, sizeof(GLTFNodeShaderTransforms), "GLTF node transforms CB", &m_TransformsCB);
-        CreateUniformBuffer(pDevice, sizeof(GLTFMaterialShaderInfo) + sizeof(GLTFRendererShaderParameters), "GLTF attribs CB", &m_GLTFAttribsCB);
+        CreateUniformBuffer(pDevice, sizeof(GLTFRendererShaderParameters), "GLTF attribs CB", &m_GLTFAttribsCB);
+        CreateUniformBuffer(pDevice, sizeof(float4x4), "GLTF depth pass attribs CB", &m_DepthPassAttribsCB);
 
         // clang-format off
         StateTransitionDesc Barriers[] = 
         {
-            {m_TransformsCB,  RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true},
-            {m_GLTFAttribsCB, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true}
+            {m_TransformsCB,       RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true},
+            {m_GLTFAttribsCB,      RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true},
+            {m_DepthPassAttribsCB, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true}
         };
         // clang-format on
         pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
 
+        if (!CI.UseJointsBuffer)
+        {
+            // Joint matrices are only uploaded per draw when the joints buffer is not used
+            CreateUniformBuffer(pDevice, sizeof(GLTFJointMatrices), "GLTF joint matrices CB", &m_JointMatricesCB);
+            StateTransitionDesc Barrier{m_JointMatricesCB, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true};
+            pCtx->TransitionResourceStates(1, &Barrier);
+        }
+
+        if (m_UseBindlessMaterials)
+        {
+            CreateUniformBuffer(pDevice, sizeof(GLTFBindlessDrawAttribs), "GLTF bindless draw attribs CB", &m_BindlessDrawAttribsCB);
+            StateTransitionDesc Barrier{m_BindlessDrawAttribsCB, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true};
+            pCtx->TransitionResourceStates(1, &Barrier);
+        }
+        else
+        {
+            CreateUniformBuffer(pDevice, sizeof(GLTFMaterialShaderInfo), "GLTF shared material attribs CB", &m_SharedMaterialAttribsCB);
+            StateTransitionDesc Barrier{m_SharedMaterialAttribsCB, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true};
+            pCtx->TransitionResourceStates(1, &Barrier);
+        }
+
         CreatePSO(pDevice);
     }
 }
@@ -160,6 +376,24 @@ void GLTF_PBR_Renderer::PrecomputeBRDF(IRenderDevice*  pDevice,
     pDevice->CreateTexture(TexDesc, nullptr, &pBRDF_LUT);
     m_pBRDF_LUT_SRV = pBRDF_LUT->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
 
+    // clang-format off
+    StateTransitionDesc Barriers[] =
+    {
+        {pBRDF_LUT, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true}
+    };
+    // clang-format on
+
+    std::string CacheFilePath;
+    if (!m_IBLCacheDirectory.empty())
+    {
+        CacheFilePath = GetIBLCacheFilePath(m_IBLCacheDirectory, "GLTF_BRDF_LUT", ComputeHash(IBLCacheVersion, TexDesc.Width, TexDesc.Format));
+        if (LoadCachedIBLTexture(pDevice, pCtx, CacheFilePath, pBRDF_LUT))
+        {
+            pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+            return;
+        }
+    }
+
     RefCntAutoPtr<IPipelineState> PrecomputeBRDF_PSO;
     {
         GraphicsPipelineStateCreateInfo PSOCreateInfo;
@@ -213,12 +447,9 @@ void GLTF_PBR_Renderer::PrecomputeBRDF(IRenderDevice*  pDevice,
     DrawAttribs attrs(4, DRAW_FLAG_VERIFY_ALL);
     pCtx->Draw(attrs);
 
-    // clang-format off
-    StateTransitionDesc Barriers[] =
-    {
-        {pBRDF_LUT, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true}
-    };
-    // clang-format on
+    if (!CacheFilePath.empty())
+        SaveIBLTextureToCache(pDevice, pCtx, pBRDF_LUT, m_IBLCacheDirectory, CacheFilePath);
+
     pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
 }
 
@@ -241,6 +472,8 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
     GraphicsPipeline.RasterizerDesc.CullMode              = CULL_MODE_BACK;
     GraphicsPipeline.RasterizerDesc.FrontCounterClockwise = m_Settings.FrontCCW;
     GraphicsPipeline.DepthStencilDesc.DepthEnable         = True;
+    // Depth pre-pass writes exactly the same depth values (see RenderDepth)
+    GraphicsPipeline.DepthStencilDesc.DepthFunc           = COMPARISON_FUNC_LESS_EQUAL;
 
     ShaderCreateInfo ShaderCI;
     ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
@@ -248,12 +481,11 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
     ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
 
     ShaderMacroHelper Macros;
-    Macros.AddShaderMacro("MAX_NUM_JOINTS", Uint32{GLTF::Mesh::TransformData::MaxNumJoints});
-    Macros.AddShaderMacro("ALLOW_DEBUG_VIEW", m_Settings.AllowDebugView);
-    Macros.AddShaderMacro("TONE_MAPPING_MODE", "TONE_MAPPING_MODE_UNCHARTED2");
-    Macros.AddShaderMacro("GLTF_PBR_USE_IBL", m_Settings.UseIBL);
-    Macros.AddShaderMacro("GLTF_PBR_USE_AO", m_Settings.UseAO);
-    Macros.AddShaderMacro("GLTF_PBR_USE_EMISSIVE", m_Settings.UseEmissive);
+    AddMaterialShaderMacros(Macros, m_Settings);
+    Macros.AddShaderMacro("GLTF_PBR_USE_JOINTS_BUFFER", m_Settings.UseJointsBuffer);
+    Macros.AddShaderMacro("GLTF_PBR_BINDLESS", m_UseBindlessMaterials);
+    if (m_UseBindlessMaterials)
+        Macros.AddShaderMacro("GLTF_PBR_MAX_BINDLESS_TEXTURES", m_Settings.MaxBindlessTextures);
     ShaderCI.Macros = Macros;
     RefCntAutoPtr<IShader> pVS;
     {
@@ -298,23 +530,24 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
     // clang-format on
 
     std::vector<ImmutableSamplerDesc> ImtblSamplers;
-    // clang-format off
-    if (m_Settings.UseImmutableSamplers)
+    if (m_UseBindlessMaterials)
     {
-        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_ColorMap",              m_Settings.ColorMapImmutableSampler);
-        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_PhysicalDescriptorMap", m_Settings.PhysDescMapImmutableSampler);
-        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_NormalMap",             m_Settings.NormalMapImmutableSampler);
+        // All textures in the array share one sampler
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_Textures", m_Settings.ColorMapImmutableSampler);
+        Vars.emplace_back(SHADER_TYPE_PIXEL, "cbBindlessDrawAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC);
     }
-    // clang-format on
-
-    if (m_Settings.UseAO)
+    else
     {
-        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_AOMap", m_Settings.AOMapImmutableSampler);
+        AddMaterialTextureSamplers(ImtblSamplers, m_Settings);
     }
 
-    if (m_Settings.UseEmissive)
+    if (m_Settings.UseJointsBuffer)
+    {
+        Vars.emplace_back(SHADER_TYPE_VERTEX, "g_JointMatrices", SHADER_RESOURCE_VARIABLE_TYPE_STATIC);
+    }
+    else
     {
-        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_EmissiveMap", m_Settings.EmissiveMapImmutableSampler);
+        Vars.emplace_back(SHADER_TYPE_VERTEX, "cbJointMatrices", SHADER_RESOURCE_VARIABLE_TYPE_STATIC);
     }
 
     if (m_Settings.UseIBL)
@@ -328,6 +561,8 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
         // clang-format on
     }
 
+    AddShadowMapResources(Vars, ImtblSamplers, m_Settings);
+
     PSODesc.ResourceLayout.NumVariables         = static_cast<Uint32>(Vars.size());
     PSODesc.ResourceLayout.Variables            = Vars.data();
     PSODesc.ResourceLayout.NumImmutableSamplers = static_cast<Uint32>(ImtblSamplers.size());
@@ -352,6 +587,8 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
         AddPSO(Key, std::move(pDobleSidedOpaquePSO));
     }
 
+    CreateDepthPSOs(pDevice, PSOCreateInfo);
+
     PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = CULL_MODE_BACK;
 
     auto& RT0          = PSOCreateInfo.GraphicsPipeline.BlendDesc.RenderTargets[0];
@@ -389,105 +626,662 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
         PSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "cbTransforms")->Set(m_TransformsCB);
         PSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbGLTFAttribs")->Set(m_GLTFAttribsCB);
         // clang-format on
+        if (!m_Settings.UseJointsBuffer)
+        {
+            PSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "cbJointMatrices")->Set(m_JointMatricesCB);
+        }
+        if (m_UseBindlessMaterials)
+        {
+            PSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbBindlessDrawAttribs")->Set(m_BindlessDrawAttribsCB);
+        }
     }
 }
 
-IShaderResourceBinding* GLTF_PBR_Renderer::CreateMaterialSRB(GLTF::Material& Material,
-                                                             IBuffer*        pCameraAttribs,
-                                                             IBuffer*        pLightAttribs,
-                                                             IPipelineState* pPSO,
-                                                             size_t          TypeId)
+void GLTF_PBR_Renderer::CreateStaticScenePSOs(IRenderDevice* pDevice)
 {
-    if (pPSO == nullptr)
-        pPSO = GetPSO(PSOKey{});
+    GraphicsPipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&              PSODesc          = PSOCreateInfo.PSODesc;
+    GraphicsPipelineDesc&           GraphicsPipeline = PSOCreateInfo.GraphicsPipeline;
 
-    RefCntAutoPtr<IShaderResourceBinding> pSRB;
-    pPSO->CreateShaderResourceBinding(&pSRB, true);
+    PSODesc.Name         = "Render GLTF static scene PSO";
+    PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
 
-    if (auto* pCameraAttribsVSVar = pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "cbCameraAttribs"))
-        pCameraAttribsVSVar->Set(pCameraAttribs);
+    GraphicsPipeline.pRenderPass  = m_pRenderPass;
+    GraphicsPipeline.SubpassIndex = 0;
 
-    if (pCameraAttribs != nullptr)
+    GraphicsPipeline.NumRenderTargets                     = 0;
+    GraphicsPipeline.RTVFormats[0]                        = m_Settings.RTVFmt;
+    GraphicsPipeline.DSVFormat                            = m_Settings.DSVFmt;
+    GraphicsPipeline.PrimitiveTopology                    = PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    GraphicsPipeline.RasterizerDesc.CullMode              = CULL_MODE_BACK;
+    GraphicsPipeline.RasterizerDesc.FrontCounterClockwise = m_Settings.FrontCCW;
+    GraphicsPipeline.DepthStencilDesc.DepthEnable         = True;
+    GraphicsPipeline.DepthStencilDesc.DepthFunc           = COMPARISON_FUNC_LESS_EQUAL;
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.UseCombinedTextureSamplers = true;
+    ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
+
+    // Batches of a static scene may belong to different models, so static scenes
+    // always use per-material SRBs rather than bindless materials.
+    ShaderMacroHelper Macros;
+    AddMaterialShaderMacros(Macros, m_Settings);
+    Macros.AddShaderMacro("GLTF_PBR_BINDLESS", false);
+    ShaderCI.Macros = Macros;
+    RefCntAutoPtr<IShader> pVS;
     {
-        if (auto* pCameraAttribsPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbCameraAttribs"))
-            pCameraAttribsPSVar->Set(pCameraAttribs);
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "GLTF static scene VS";
+        ShaderCI.FilePath        = "RenderGLTF_Instanced.vsh";
+        pDevice->CreateShader(ShaderCI, &pVS);
     }
 
-    if (pLightAttribs != nullptr)
+    RefCntAutoPtr<IShader> pPS;
     {
-        if (auto* pLightAttribsPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbLightAttribs"))
-            pLightAttribsPSVar->Set(pLightAttribs);
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "GLTF static scene PS";
+        ShaderCI.FilePath        = "RenderGLTF_PBR.psh";
+        pDevice->CreateShader(ShaderCI, &pPS);
     }
 
+    // clang-format off
+    LayoutElement Inputs[] =
+    {
+        {0, 0, 3, VT_FLOAT32},   //float3 Pos        : ATTRIB0;
+        {1, 0, 3, VT_FLOAT32},   //float3 Normal     : ATTRIB1;
+        {2, 0, 2, VT_FLOAT32},   //float2 UV0        : ATTRIB2;
+        {3, 0, 2, VT_FLOAT32},   //float2 UV1        : ATTRIB3;
+        // Index of the instance written by the culling shader
+        {4, 1, 1, VT_UINT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE} //uint InstanceId : ATTRIB4;
+    };
+    // clang-format on
+    GraphicsPipeline.InputLayout.LayoutElements = Inputs;
+    GraphicsPipeline.InputLayout.NumElements    = _countof(Inputs);
+
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    // clang-format off
+    std::vector<ShaderResourceVariableDesc> Vars = 
+    {
+        {SHADER_TYPE_PIXEL, "cbGLTFAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+
+    std::vector<ImmutableSamplerDesc> ImtblSamplers;
+    AddMaterialTextureSamplers(ImtblSamplers, m_Settings);
+
     if (m_Settings.UseIBL)
     {
-        if (auto* pIrradianceMapPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_IrradianceMap"))
-            pIrradianceMapPSVar->Set(m_pIrradianceCubeSRV);
+        Vars.emplace_back(SHADER_TYPE_PIXEL, "g_BRDF_LUT", SHADER_RESOURCE_VARIABLE_TYPE_STATIC);
 
-        if (auto* pPrefilteredEnvMap = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_PrefilteredEnvMap"))
-            pPrefilteredEnvMap->Set(m_pPrefilteredEnvMapSRV);
+        // clang-format off
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_BRDF_LUT",          Sam_LinearClamp);
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_IrradianceMap",     Sam_LinearClamp);
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_PrefilteredEnvMap", Sam_LinearClamp);
+        // clang-format on
     }
 
-    auto SetTexture = [&](ITexture* pTexture, ITextureView* pDefaultTexSRV, const char* VarName) //
-    {
-        ITextureView* pTexSRV = pTexture != nullptr ? pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE) : pDefaultTexSRV;
-        if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, VarName))
-            pVar->Set(pTexSRV);
-    };
+    AddShadowMapResources(Vars, ImtblSamplers, m_Settings);
 
-    ITexture* pBaseColorTex = nullptr;
-    ITexture* pPhysDescTex  = nullptr;
-    if (Material.workflow == GLTF::Material::PbrWorkflow::MetallicRoughness)
+    PSODesc.ResourceLayout.NumVariables         = static_cast<Uint32>(Vars.size());
+    PSODesc.ResourceLayout.Variables            = Vars.data();
+    PSODesc.ResourceLayout.NumImmutableSamplers = static_cast<Uint32>(ImtblSamplers.size());
+    PSODesc.ResourceLayout.ImmutableSamplers    = !ImtblSamplers.empty() ? ImtblSamplers.data() : nullptr;
+
+    PSOCreateInfo.pVS = pVS;
+    PSOCreateInfo.pPS = pPS;
+
+    for (bool DoubleSided : {false, true})
     {
-        pBaseColorTex = Material.pBaseColorTexture;
-        pPhysDescTex  = Material.pMetallicRoughnessTexture;
+        GraphicsPipeline.RasterizerDesc.CullMode = DoubleSided ? CULL_MODE_NONE : CULL_MODE_BACK;
+
+        auto& pPSO = m_StaticScenePSOs[DoubleSided ? 1 : 0];
+        pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
+        if (!pPSO)
+            LOG_ERROR_AND_THROW("Failed to create GLTF static scene PSO");
+
+        if (m_Settings.UseIBL)
+        {
+            pPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_BRDF_LUT")->Set(m_pBRDF_LUT_SRV);
+        }
+        pPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbGLTFAttribs")->Set(m_GLTFAttribsCB);
+        if (m_Settings.UseShadows && m_pShadowMapSRV)
+        {
+            pPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_tex2DShadowMap")->Set(m_pShadowMapSRV);
+        }
     }
-    else if (Material.workflow == GLTF::Material::PbrWorkflow::SpecularGlossiness)
+
+    if (m_Settings.DSVFmt == TEX_FORMAT_UNKNOWN)
+        return;
+
+    // Depth-only pipelines use the same vertex layout and are rendered within the same subpass
     {
-        pBaseColorTex = Material.extension.pDiffuseTexture;
-        pPhysDescTex  = Material.extension.pSpecularGlossinessTexture;
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "GLTF static scene depth VS";
+        ShaderCI.FilePath        = "RenderGLTF_InstancedDepth.vsh";
+        pVS.Release();
+        pDevice->CreateShader(ShaderCI, &pVS);
     }
 
+    PSODesc.Name = "GLTF static scene depth PSO";
+
     // clang-format off
-    SetTexture(pBaseColorTex,           m_pWhiteTexSRV,         "g_ColorMap");
-    SetTexture(pPhysDescTex ,           m_pWhiteTexSRV,         "g_PhysicalDescriptorMap");
-    SetTexture(Material.pNormalTexture, m_pDefaultNormalMapSRV, "g_NormalMap");
-    // clang-format on
-    if (m_Settings.UseAO)
+    ShaderResourceVariableDesc DepthVars[] = 
     {
-        SetTexture(Material.pOcclusionTexture, m_pWhiteTexSRV, "g_AOMap");
-    }
-    if (m_Settings.UseEmissive)
+        {SHADER_TYPE_VERTEX, "cbDepthPassAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.NumVariables         = _countof(DepthVars);
+    PSODesc.ResourceLayout.Variables            = DepthVars;
+    PSODesc.ResourceLayout.NumImmutableSamplers = 0;
+    PSODesc.ResourceLayout.ImmutableSamplers    = nullptr;
+
+    PSOCreateInfo.pVS = pVS;
+    PSOCreateInfo.pPS = nullptr;
+
+    for (bool IsOccluderPass : {false, true})
     {
-        SetTexture(Material.pEmissiveTexture, m_pBlackTexSRV, "g_EmissiveMap");
-    }
+        if (IsOccluderPass)
+        {
+            PSODesc.Name = "GLTF static scene occluder depth PSO";
+
+            // Occluder depth is rendered outside of the render pass
+            GraphicsPipeline.pRenderPass      = nullptr;
+            GraphicsPipeline.SubpassIndex     = 0;
+            GraphicsPipeline.NumRenderTargets = 0;
+            GraphicsPipeline.RTVFormats[0]    = TEX_FORMAT_UNKNOWN;
+            GraphicsPipeline.DSVFormat        = m_Settings.DSVFmt;
+        }
 
+        for (bool DoubleSided : {false, true})
+        {
+            GraphicsPipeline.RasterizerDesc.CullMode = DoubleSided ? CULL_MODE_NONE : CULL_MODE_BACK;
 
-    SRBCacheKey SRBKey{&Material, TypeId};
+            auto& pPSO = m_StaticSceneDepthPSOs[(IsOccluderPass ? 2 : 0) + (DoubleSided ? 1 : 0)];
+            pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
+            if (!pPSO)
+                LOG_ERROR_AND_THROW("Failed to create ", PSODesc.Name);
 
-    auto it = m_SRBCache.find(SRBKey);
-    if (it != m_SRBCache.end())
-    {
-        it->second = std::move(pSRB);
-        return it->second;
-    }
-    else
-    {
-        auto new_it = m_SRBCache.emplace(SRBKey, std::move(pSRB));
-        VERIFY_EXPR(new_it.second);
-        return new_it.first->second;
+            pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "cbDepthPassAttribs")->Set(m_DepthPassAttribsCB);
+        }
     }
 }
 
-void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
-                                           IDeviceContext* pCtx,
-                                           ITextureView*   pEnvironmentMap)
+void GLTF_PBR_Renderer::CreateDepthPSOs(IRenderDevice*                  pDevice,
+                                        GraphicsPipelineStateCreateInfo PSOCreateInfo)
 {
-    if (!m_Settings.UseIBL)
-    {
-        LOG_WARNING_MESSAGE("IBL is disabled, so precomputing cube maps will have no effect");
-        return;
-    }
+    PipelineStateDesc&    PSODesc          = PSOCreateInfo.PSODesc;
+    GraphicsPipelineDesc& GraphicsPipeline = PSOCreateInfo.GraphicsPipeline;
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.UseCombinedTextureSamplers = true;
+    ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("MAX_NUM_JOINTS", MaxNumJoints);
+    Macros.AddShaderMacro("GLTF_PBR_USE_JOINTS_BUFFER", m_Settings.UseJointsBuffer);
+    ShaderCI.Macros = Macros;
+    RefCntAutoPtr<IShader> pVS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "GLTF depth VS";
+        ShaderCI.FilePath        = "RenderGLTF_Depth.vsh";
+        pDevice->CreateShader(ShaderCI, &pVS);
+    }
+
+    // Pixel shader is only used by alpha-masked materials
+    RefCntAutoPtr<IShader> pAlphaMaskPS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "GLTF alpha mask depth PS";
+        ShaderCI.FilePath        = "RenderGLTF_Depth.psh";
+        pDevice->CreateShader(ShaderCI, &pAlphaMaskPS);
+    }
+
+    // Vertex layout is the same as in the color pass, so the model's vertex buffers are used as is
+
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    // clang-format off
+    std::vector<ShaderResourceVariableDesc> Vars = 
+    {
+        {SHADER_TYPE_VERTEX, "cbTransforms",       SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_VERTEX, "cbDepthPassAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+    if (m_Settings.UseJointsBuffer)
+    {
+        Vars.emplace_back(SHADER_TYPE_VERTEX, "g_JointMatrices", SHADER_RESOURCE_VARIABLE_TYPE_STATIC);
+    }
+    else
+    {
+        Vars.emplace_back(SHADER_TYPE_VERTEX, "cbJointMatrices", SHADER_RESOURCE_VARIABLE_TYPE_STATIC);
+    }
+
+    std::vector<ImmutableSamplerDesc> ImtblSamplers;
+    if (m_Settings.UseImmutableSamplers)
+    {
+        ImtblSamplers.emplace_back(SHADER_TYPE_PIXEL, "g_ColorMap", m_Settings.ColorMapImmutableSampler);
+    }
+
+    PSODesc.ResourceLayout.NumVariables         = static_cast<Uint32>(Vars.size());
+    PSODesc.ResourceLayout.Variables            = Vars.data();
+    PSODesc.ResourceLayout.NumImmutableSamplers = static_cast<Uint32>(ImtblSamplers.size());
+    PSODesc.ResourceLayout.ImmutableSamplers    = !ImtblSamplers.empty() ? ImtblSamplers.data() : nullptr;
+
+    PSOCreateInfo.pVS = pVS;
+
+    for (bool IsShadowPass : {false, true})
+    {
+        if (IsShadowPass)
+        {
+            if (m_Settings.ShadowMapFmt == TEX_FORMAT_UNKNOWN)
+                break;
+
+            PSODesc.Name = "GLTF shadow PSO";
+
+            // Shadow maps are rendered outside of the render pass
+            GraphicsPipeline.pRenderPass      = nullptr;
+            GraphicsPipeline.SubpassIndex     = 0;
+            GraphicsPipeline.NumRenderTargets = 0;
+            GraphicsPipeline.RTVFormats[0]    = TEX_FORMAT_UNKNOWN;
+            GraphicsPipeline.DSVFormat        = m_Settings.ShadowMapFmt;
+
+            GraphicsPipeline.DepthStencilDesc.DepthFunc = COMPARISON_FUNC_LESS;
+            if (pDevice->GetDeviceCaps().Features.DepthClamp)
+            {
+                // Disable depth clipping to render shadow casters that are closer than
+                // the near clipping plane of the light.
+                GraphicsPipeline.RasterizerDesc.DepthClipEnable = False;
+            }
+        }
+        else
+        {
+            PSODesc.Name = "GLTF depth pre-pass PSO";
+        }
+
+        for (auto AlphaMode : {GLTF::Material::ALPHAMODE_OPAQUE, GLTF::Material::ALPHAMODE_MASK})
+        {
+            PSOCreateInfo.pPS = AlphaMode == GLTF::Material::ALPHAMODE_MASK ? pAlphaMaskPS.RawPtr() : nullptr;
+            for (bool DoubleSided : {false, true})
+            {
+                GraphicsPipeline.RasterizerDesc.CullMode = DoubleSided ? CULL_MODE_NONE : CULL_MODE_BACK;
+
+                RefCntAutoPtr<IPipelineState> pPSO;
+                pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pPSO);
+                // clang-format off
+                pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "cbTransforms")->Set(m_TransformsCB);
+                pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "cbDepthPassAttribs")->Set(m_DepthPassAttribsCB);
+                // clang-format on
+                if (!m_Settings.UseJointsBuffer)
+                {
+                    pPSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "cbJointMatrices")->Set(m_JointMatricesCB);
+                }
+                m_DepthPSOs[GetDepthPSOIdx(IsShadowPass, AlphaMode, DoubleSided)] = std::move(pPSO);
+            }
+        }
+    }
+}
+
+void GLTF_PBR_Renderer::SetJointsBuffer(IBufferView* pJointsBufferSRV)
+{
+    if (!m_Settings.UseJointsBuffer)
+    {
+        LOG_ERROR_MESSAGE("The renderer was not created with UseJointsBuffer flag");
+        return;
+    }
+
+    for (auto& PSO : m_PSOCache)
+    {
+        PSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "g_JointMatrices")->Set(pJointsBufferSRV);
+    }
+    for (auto& PSO : m_DepthPSOs)
+    {
+        if (PSO)
+            PSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "g_JointMatrices")->Set(pJointsBufferSRV);
+    }
+}
+
+void GLTF_PBR_Renderer::SetShadowMap(ITextureView* pShadowMapSRV)
+{
+    if (!m_Settings.UseShadows)
+    {
+        LOG_ERROR_MESSAGE("The renderer was not created with UseShadows flag");
+        return;
+    }
+
+    m_pShadowMapSRV = pShadowMapSRV;
+    for (auto& PSO : m_PSOCache)
+    {
+        PSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_tex2DShadowMap")->Set(pShadowMapSRV);
+    }
+    for (auto& PSO : m_StaticScenePSOs)
+    {
+        if (PSO)
+            PSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_tex2DShadowMap")->Set(pShadowMapSRV);
+    }
+}
+
+void GLTF_PBR_Renderer::SetIBLCubemaps(ITextureView* pIrradianceCubeSRV, ITextureView* pPrefilteredEnvMapSRV)
+{
+    if (!m_Settings.UseIBL)
+    {
+        LOG_ERROR_MESSAGE("The renderer was not created with UseIBL flag");
+        return;
+    }
+    VERIFY(pIrradianceCubeSRV != nullptr && pPrefilteredEnvMapSRV != nullptr, "IBL cubemaps must not be null");
+
+    m_pIrradianceCubeSRV    = pIrradianceCubeSRV;
+    m_pPrefilteredEnvMapSRV = pPrefilteredEnvMapSRV;
+}
+
+namespace
+{
+
+GLTFMaterialShaderInfo GetMaterialShaderInfo(const GLTF::Material& material)
+{
+    GLTFMaterialShaderInfo MaterialInfo{};
+
+    MaterialInfo.EmissiveFactor = material.EmissiveFactor;
+
+    auto GetUVSelector = [](const ITexture* pTexture, Uint8 TexCoordSet) {
+        return pTexture != nullptr ? static_cast<float>(TexCoordSet) : -1;
+    };
+
+    MaterialInfo.BaseColorTextureUVSelector = GetUVSelector(material.pBaseColorTexture, material.TexCoordSets.BaseColor);
+    MaterialInfo.NormalTextureUVSelector    = GetUVSelector(material.pNormalTexture, material.TexCoordSets.Normal);
+    MaterialInfo.OcclusionTextureUVSelector = GetUVSelector(material.pOcclusionTexture, material.TexCoordSets.Occlusion);
+    MaterialInfo.EmissiveTextureUVSelector  = GetUVSelector(material.pEmissiveTexture, material.TexCoordSets.Emissive);
+    MaterialInfo.UseAlphaMask               = material.AlphaMode == GLTF::Material::ALPHAMODE_MASK ? 1 : 0;
+    MaterialInfo.AlphaMaskCutoff            = material.AlphaCutoff;
+
+    MaterialInfo.BaseColorUVScaleBias          = material.UVScaleBias.BaseColor;
+    MaterialInfo.PhysicalDescriptorUVScaleBias = material.UVScaleBias.MetallicRoughness;
+    MaterialInfo.NormalUVScaleBias             = material.UVScaleBias.Normal;
+    MaterialInfo.OcclusionUVScaleBias          = material.UVScaleBias.Occlusion;
+    MaterialInfo.EmissiveUVScaleBias           = material.UVScaleBias.Emissive;
+
+    // Two-component normal maps (e.g. BC5-compressed) store X and Y only
+    if (material.pNormalTexture != nullptr)
+        MaterialInfo.NormalMapXY = GetTextureFormatAttribs(material.pNormalTexture->GetDesc().Format).NumComponents == 2 ? 1 : 0;
+
+    // TODO: glTF specs states that metallic roughness should be preferred, even if specular glosiness is present
+    if (material.workflow == GLTF::Material::PbrWorkflow::MetallicRoughness)
+    {
+        // Metallic roughness workflow
+        MaterialInfo.Workflow                            = PBR_WORKFLOW_METALLIC_ROUGHNESS;
+        MaterialInfo.BaseColorFactor                     = material.BaseColorFactor;
+        MaterialInfo.MetallicFactor                      = material.MetallicFactor;
+        MaterialInfo.RoughnessFactor                     = material.RoughnessFactor;
+        MaterialInfo.PhysicalDescriptorTextureUVSelector = GetUVSelector(material.pMetallicRoughnessTexture, material.TexCoordSets.MetallicRoughness);
+        MaterialInfo.BaseColorTextureUVSelector          = GetUVSelector(material.pBaseColorTexture, material.TexCoordSets.BaseColor);
+    }
+    else if (material.workflow == GLTF::Material::PbrWorkflow::SpecularGlossiness)
+    {
+        // Specular glossiness workflow
+        MaterialInfo.Workflow                            = PBR_WORKFLOW_SPECULAR_GLOSINESS;
+        MaterialInfo.PhysicalDescriptorTextureUVSelector = GetUVSelector(material.extension.pSpecularGlossinessTexture, material.TexCoordSets.SpecularGlossiness);
+        MaterialInfo.BaseColorTextureUVSelector          = GetUVSelector(material.extension.pDiffuseTexture, material.TexCoordSets.BaseColor);
+        MaterialInfo.BaseColorFactor                     = material.extension.DiffuseFactor;
+        MaterialInfo.SpecularFactor                      = float4(material.extension.SpecularFactor, 1.0f);
+        MaterialInfo.PhysicalDescriptorUVScaleBias       = material.UVScaleBias.SpecularGlossiness;
+        MaterialInfo.BaseColorUVScaleBias                = material.UVScaleBias.Diffuse;
+    }
+
+    return MaterialInfo;
+}
+
+// Returns base color and physical descriptor textures of the material's workflow
+std::pair<ITexture*, ITexture*> GetMaterialTextures(const GLTF::Material& Material)
+{
+    if (Material.workflow == GLTF::Material::PbrWorkflow::MetallicRoughness)
+        return {Material.pBaseColorTexture.RawPtr<ITexture>(), Material.pMetallicRoughnessTexture.RawPtr<ITexture>()};
+    else if (Material.workflow == GLTF::Material::PbrWorkflow::SpecularGlossiness)
+        return {Material.extension.pDiffuseTexture.RawPtr<ITexture>(), Material.extension.pSpecularGlossinessTexture.RawPtr<ITexture>()};
+    else
+        return {nullptr, nullptr};
+}
+
+// Texture views that the material binds to the SRB, see GLTF_PBR_Renderer::InitMaterialSRB()
+struct MaterialTextureSet
+{
+    std::array<const ITextureView*, 5> Views = {};
+
+    bool operator==(const MaterialTextureSet& Set) const
+    {
+        return Views == Set.Views;
+    }
+
+    struct Hasher
+    {
+        size_t operator()(const MaterialTextureSet& Set) const
+        {
+            return ComputeHash(Set.Views[0], Set.Views[1], Set.Views[2], Set.Views[3], Set.Views[4]);
+        }
+    };
+};
+
+const GLTF::Mesh::TransformData& GetMeshTransforms(const GLTF::Node* node, const GLTF::ModelInstance* pInstance)
+{
+    return pInstance != nullptr ? pInstance->GetMeshTransforms(*node) : node->_Mesh->Transforms;
+}
+
+} // namespace
+
+void GLTF_PBR_Renderer::SetCommonSRBResources(IShaderResourceBinding* pSRB,
+                                              IBuffer*                pCameraAttribs,
+                                              IBuffer*                pLightAttribs)
+{
+    if (auto* pCameraAttribsVSVar = pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "cbCameraAttribs"))
+        pCameraAttribsVSVar->Set(pCameraAttribs);
+
+    if (pCameraAttribs != nullptr)
+    {
+        if (auto* pCameraAttribsPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbCameraAttribs"))
+            pCameraAttribsPSVar->Set(pCameraAttribs);
+    }
+
+    if (pLightAttribs != nullptr)
+    {
+        if (auto* pLightAttribsPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbLightAttribs"))
+            pLightAttribsPSVar->Set(pLightAttribs);
+    }
+
+    if (m_Settings.UseIBL)
+    {
+        if (auto* pIrradianceMapPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_IrradianceMap"))
+            pIrradianceMapPSVar->Set(m_pIrradianceCubeSRV);
+
+        if (auto* pPrefilteredEnvMap = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_PrefilteredEnvMap"))
+            pPrefilteredEnvMap->Set(m_pPrefilteredEnvMapSRV);
+    }
+}
+
+RefCntAutoPtr<IBuffer> GLTF_PBR_Renderer::CreateMaterialCB(const GLTF::Material& Material)
+{
+    // Material parameters never change, so they are uploaded once into an immutable buffer
+    const auto MaterialInfo = GetMaterialShaderInfo(Material);
+
+    BufferDesc CBDesc;
+    CBDesc.Name          = "GLTF material attribs CB";
+    CBDesc.uiSizeInBytes = sizeof(MaterialInfo);
+    CBDesc.Usage         = USAGE_IMMUTABLE;
+    CBDesc.BindFlags     = BIND_UNIFORM_BUFFER;
+
+    BufferData             InitData{&MaterialInfo, sizeof(MaterialInfo)};
+    RefCntAutoPtr<IBuffer> pMaterialCB;
+    m_pDevice->CreateBuffer(CBDesc, &InitData, &pMaterialCB);
+
+    // No device context is available here, so the buffer is transitioned by the next RenderModel() call
+    m_PendingMaterialBuffers.emplace_back(pMaterialCB, RESOURCE_STATE_CONSTANT_BUFFER);
+
+    return pMaterialCB;
+}
+
+void GLTF_PBR_Renderer::CreateDepthSRBs(const GLTF::Material& Material,
+                                        IBuffer*              pMaterialCB)
+{
+    if (!m_DepthPSOs[0])
+        return;
+
+    if (!m_pDepthSRB)
+        m_DepthPSOs[0]->CreateShaderResourceBinding(&m_pDepthSRB, true);
+
+    if (Material.AlphaMode == GLTF::Material::ALPHAMODE_MASK)
+    {
+        // SRB is compatible with all alpha-masked depth PSOs
+        auto* pMaskPSO = m_DepthPSOs[GetDepthPSOIdx(false, GLTF::Material::ALPHAMODE_MASK, false)].RawPtr();
+
+        RefCntAutoPtr<IShaderResourceBinding> pDepthSRB;
+        pMaskPSO->CreateShaderResourceBinding(&pDepthSRB, true);
+        pDepthSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbMaterialAttribs")->Set(pMaterialCB);
+        ITexture*     pBaseColorTex = GetMaterialTextures(Material).first;
+        ITextureView* pColorMapSRV  = pBaseColorTex != nullptr ? pBaseColorTex->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE) : m_pWhiteTexSRV.RawPtr();
+        pDepthSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ColorMap")->Set(pColorMapSRV);
+        m_DepthSRBCache[&Material] = std::move(pDepthSRB);
+    }
+}
+
+IShaderResourceBinding* GLTF_PBR_Renderer::CreateMaterialSRB(GLTF::Material& Material,
+                                                             IBuffer*        pCameraAttribs,
+                                                             IBuffer*        pLightAttribs,
+                                                             IPipelineState* pPSO,
+                                                             size_t          TypeId)
+{
+    if (pPSO == nullptr)
+        pPSO = GetPSO(PSOKey{});
+
+    RefCntAutoPtr<IShaderResourceBinding> pSRB;
+    pPSO->CreateShaderResourceBinding(&pSRB, true);
+
+    auto pMaterialCB = InitMaterialSRB(pSRB, Material, pCameraAttribs, pLightAttribs);
+
+    // Depth-only passes use the bindings of the default SRB type
+    if (TypeId == 0)
+    {
+        if (!pMaterialCB && Material.AlphaMode == GLTF::Material::ALPHAMODE_MASK)
+            pMaterialCB = CreateMaterialCB(Material);
+        CreateDepthSRBs(Material, pMaterialCB);
+    }
+
+    // Draw lists reference SRBs
+    m_DrawListCache.clear();
+
+    // The material no longer shares the SRB
+    if (TypeId == 0)
+        m_SharedSRBMaterials.erase(&Material);
+
+    SRBCacheKey SRBKey{&Material, TypeId};
+
+    auto it = m_SRBCache.find(SRBKey);
+    if (it != m_SRBCache.end())
+    {
+        it->second = std::move(pSRB);
+        return it->second;
+    }
+    else
+    {
+        auto new_it = m_SRBCache.emplace(SRBKey, std::move(pSRB));
+        VERIFY_EXPR(new_it.second);
+        return new_it.first->second;
+    }
+}
+
+RefCntAutoPtr<IBuffer> GLTF_PBR_Renderer::InitMaterialSRB(IShaderResourceBinding* pSRB,
+                                                          const GLTF::Material&   Material,
+                                                          IBuffer*                pCameraAttribs,
+                                                          IBuffer*                pLightAttribs,
+                                                          IBuffer*                pSharedMaterialCB)
+{
+    SetCommonSRBResources(pSRB, pCameraAttribs, pLightAttribs);
+
+    auto SetTexture = [&](ITexture* pTexture, ITextureView* pDefaultTexSRV, const char* VarName) //
+    {
+        ITextureView* pTexSRV = pTexture != nullptr ? pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE) : pDefaultTexSRV;
+        if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, VarName))
+            pVar->Set(pTexSRV);
+    };
+
+    const auto MaterialTextures = GetMaterialTextures(Material);
+
+    // clang-format off
+    SetTexture(MaterialTextures.first,                     m_pWhiteTexSRV,         "g_ColorMap");
+    SetTexture(MaterialTextures.second,                    m_pWhiteTexSRV,         "g_PhysicalDescriptorMap");
+    SetTexture(Material.pNormalTexture.RawPtr<ITexture>(), m_pDefaultNormalMapSRV, "g_NormalMap");
+    // clang-format on
+    if (m_Settings.UseAO)
+    {
+        SetTexture(Material.pOcclusionTexture.RawPtr<ITexture>(), m_pWhiteTexSRV, "g_AOMap");
+    }
+    if (m_Settings.UseEmissive)
+    {
+        SetTexture(Material.pEmissiveTexture.RawPtr<ITexture>(), m_pBlackTexSRV, "g_EmissiveMap");
+    }
+
+    RefCntAutoPtr<IBuffer> pMaterialCB;
+    if (auto* pMaterialAttribsVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbMaterialAttribs"))
+    {
+        if (pSharedMaterialCB != nullptr)
+        {
+            pMaterialAttribsVar->Set(pSharedMaterialCB);
+        }
+        else
+        {
+            pMaterialCB = CreateMaterialCB(Material);
+            pMaterialAttribsVar->Set(pMaterialCB);
+        }
+    }
+
+    return pMaterialCB;
+}
+
+void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
+                                           IDeviceContext* pCtx,
+                                           ITextureView*   pEnvironmentMap,
+                                           size_t          EnvMapContentHash)
+{
+    if (!m_Settings.UseIBL)
+    {
+        LOG_WARNING_MESSAGE("IBL is disabled, so precomputing cube maps will have no effect");
+        return;
+    }
+
+    auto* pIrradianceCube    = m_pIrradianceCubeSRV->GetTexture();
+    auto* pPrefilteredEnvMap = m_pPrefilteredEnvMapSRV->GetTexture();
+
+    // clang-format off
+    StateTransitionDesc Barriers[] = 
+    {
+        {pPrefilteredEnvMap, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
+        {pIrradianceCube,    RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true}
+    };
+    // clang-format on
+
+    std::string IrradianceCubeCachePath;
+    std::string PrefilteredEnvMapCachePath;
+    if (!m_IBLCacheDirectory.empty() && EnvMapContentHash != 0)
+    {
+        const auto& IrradianceDesc  = pIrradianceCube->GetDesc();
+        const auto& PrefilteredDesc = pPrefilteredEnvMap->GetDesc();
+
+        const auto CacheKey = ComputeHash(IBLCacheVersion, EnvMapContentHash,
+                                          IrradianceDesc.Width, IrradianceDesc.Format, IrradianceNumPhiSamples, IrradianceNumThetaSamples,
+                                          PrefilteredDesc.Width, PrefilteredDesc.Format, PrefilterEnvMapNumSamples);
+
+        IrradianceCubeCachePath    = GetIBLCacheFilePath(m_IBLCacheDirectory, "GLTF_IrradianceCube", CacheKey);
+        PrefilteredEnvMapCachePath = GetIBLCacheFilePath(m_IBLCacheDirectory, "GLTF_PrefilteredEnvMap", CacheKey);
+        if (LoadCachedIBLTexture(pDevice, pCtx, IrradianceCubeCachePath, pIrradianceCube) &&
+            LoadCachedIBLTexture(pDevice, pCtx, PrefilteredEnvMapCachePath, pPrefilteredEnvMap))
+        {
+            pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+            return;
+        }
+    }
 
     struct PrecomputeEnvMapAttribs
     {
@@ -512,8 +1306,8 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
         ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
 
         ShaderMacroHelper Macros;
-        Macros.AddShaderMacro("NUM_PHI_SAMPLES", 64);
-        Macros.AddShaderMacro("NUM_THETA_SAMPLES", 32);
+        Macros.AddShaderMacro("NUM_PHI_SAMPLES", static_cast<int>(IrradianceNumPhiSamples));
+        Macros.AddShaderMacro("NUM_THETA_SAMPLES", static_cast<int>(IrradianceNumThetaSamples));
         ShaderCI.Macros = Macros;
         RefCntAutoPtr<IShader> pVS;
         {
@@ -661,7 +1455,6 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
     pCtx->SetPipelineState(m_pPrecomputeIrradianceCubePSO);
     m_pPrecomputeIrradianceCubeSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_EnvironmentMap")->Set(pEnvironmentMap);
     pCtx->CommitShaderResources(m_pPrecomputeIrradianceCubeSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-    auto*       pIrradianceCube    = m_pIrradianceCubeSRV->GetTexture();
     const auto& IrradianceCubeDesc = pIrradianceCube->GetDesc();
     for (Uint32 mip = 0; mip < IrradianceCubeDesc.MipLevels; ++mip)
     {
@@ -688,7 +1481,6 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
     pCtx->SetPipelineState(m_pPrefilterEnvMapPSO);
     m_pPrefilterEnvMapSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_EnvironmentMap")->Set(pEnvironmentMap);
     pCtx->CommitShaderResources(m_pPrefilterEnvMapSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-    auto*       pPrefilteredEnvMap    = m_pPrefilteredEnvMapSRV->GetTexture();
     const auto& PrefilteredEnvMapDesc = pPrefilteredEnvMap->GetDesc();
     for (Uint32 mip = 0; mip < PrefilteredEnvMapDesc.MipLevels; ++mip)
     {
@@ -709,7 +1501,7 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
                 Attribs->Rotation   = Matrices[face];
                 Attribs->Roughness  = static_cast<float>(mip) / static_cast<float>(PrefilteredEnvMapDesc.MipLevels);
                 Attribs->EnvMapDim  = static_cast<float>(PrefilteredEnvMapDesc.Width);
-                Attribs->NumSamples = 256;
+                Attribs->NumSamples = PrefilterEnvMapNumSamples;
             }
 
             DrawAttribs drawAttrs(4, DRAW_FLAG_VERIFY_ALL);
@@ -717,13 +1509,12 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
         }
     }
 
-    // clang-format off
-    StateTransitionDesc Barriers[] = 
+    if (!IrradianceCubeCachePath.empty())
     {
-        {m_pPrefilteredEnvMapSRV->GetTexture(), RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
-        {m_pIrradianceCubeSRV->GetTexture(),    RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true}
-    };
-    // clang-format on
+        SaveIBLTextureToCache(pDevice, pCtx, pIrradianceCube, m_IBLCacheDirectory, IrradianceCubeCachePath);
+        SaveIBLTextureToCache(pDevice, pCtx, pPrefilteredEnvMap, m_IBLCacheDirectory, PrefilteredEnvMapCachePath);
+    }
+
     pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
 }
 
@@ -732,192 +1523,505 @@ void GLTF_PBR_Renderer::InitializeResourceBindings(GLTF::Model& GLTFModel,
                                                    IBuffer*     pCameraAttribs,
                                                    IBuffer*     pLightAttribs)
 {
+    if (m_UseBindlessMaterials)
+    {
+        InitializeBindlessResourceBindings(GLTFModel, pCameraAttribs, pLightAttribs);
+        return;
+    }
+
+    auto GetTextureSet = [this](const GLTF::Material& Mat) //
+    {
+        auto GetView = [](ITexture* pTexture, ITextureView* pDefaultTexSRV) -> const ITextureView* {
+            return pTexture != nullptr ? pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE) : pDefaultTexSRV;
+        };
+
+        const auto MaterialTextures = GetMaterialTextures(Mat);
+
+        MaterialTextureSet Set;
+        Set.Views[0] = GetView(MaterialTextures.first, m_pWhiteTexSRV);
+        Set.Views[1] = GetView(MaterialTextures.second, m_pWhiteTexSRV);
+        Set.Views[2] = GetView(Mat.pNormalTexture.RawPtr<ITexture>(), m_pDefaultNormalMapSRV);
+        if (m_Settings.UseAO)
+            Set.Views[3] = GetView(Mat.pOcclusionTexture.RawPtr<ITexture>(), m_pWhiteTexSRV);
+        if (m_Settings.UseEmissive)
+            Set.Views[4] = GetView(Mat.pEmissiveTexture.RawPtr<ITexture>(), m_pBlackTexSRV);
+        return Set;
+    };
+
+    // Materials that bind the same textures, e.g. textures packed into the same atlases, only differ
+    // in their attributes, so they share one SRB and consecutive draws don't commit resources again.
+    std::unordered_map<MaterialTextureSet, std::vector<GLTF::Material*>, MaterialTextureSet::Hasher> TextureSetMaterials;
+    for (auto& mat : GLTFModel.Materials)
+    {
+        TextureSetMaterials[GetTextureSet(mat)].push_back(&mat);
+    }
+
     for (auto& mat : GLTFModel.Materials)
     {
-        CreateMaterialSRB(mat, pCameraAttribs, pLightAttribs);
+        const auto& SetMaterials = TextureSetMaterials[GetTextureSet(mat)];
+        if (SetMaterials.size() == 1 || !m_SharedMaterialAttribsCB)
+        {
+            CreateMaterialSRB(mat, pCameraAttribs, pLightAttribs);
+            continue;
+        }
+
+        // The shared SRB is created for the first material of the set
+        if (SetMaterials[0] != &mat)
+            continue;
+
+        RefCntAutoPtr<IShaderResourceBinding> pSRB;
+        GetPSO(PSOKey{})->CreateShaderResourceBinding(&pSRB, true);
+        InitMaterialSRB(pSRB, mat, pCameraAttribs, pLightAttribs, m_SharedMaterialAttribsCB);
+
+        for (auto* pMat : SetMaterials)
+        {
+            // Depth-only passes of alpha-masked materials use per-material bindings
+            CreateDepthSRBs(*pMat, pMat->AlphaMode == GLTF::Material::ALPHAMODE_MASK ? CreateMaterialCB(*pMat) : RefCntAutoPtr<IBuffer>{});
+
+            m_SharedSRBMaterials[pMat]       = GetMaterialShaderInfo(*pMat);
+            m_SRBCache[SRBCacheKey{pMat, 0}] = pSRB;
+        }
+    }
+
+    // Draw lists reference SRBs
+    m_DrawListCache.clear();
+}
+
+void GLTF_PBR_Renderer::InitializeBindlessResourceBindings(GLTF::Model& GLTFModel,
+                                                           IBuffer*     pCameraAttribs,
+                                                           IBuffer*     pLightAttribs)
+{
+    RefCntAutoPtr<IShaderResourceBinding> pSRB;
+    GetPSO(PSOKey{})->CreateShaderResourceBinding(&pSRB, true);
+
+    SetCommonSRBResources(pSRB, pCameraAttribs, pLightAttribs);
+
+    // Default textures are always at the beginning of the array
+    constexpr int WhiteTexIdx         = 0;
+    constexpr int BlackTexIdx         = 1;
+    constexpr int DefaultNormalMapIdx = 2;
+
+    std::vector<IDeviceObject*> TexSRVs = {m_pWhiteTexSRV.RawPtr(), m_pBlackTexSRV.RawPtr(), m_pDefaultNormalMapSRV.RawPtr()};
+    TexSRVs.reserve(m_Settings.MaxBindlessTextures);
+    std::unordered_map<const ITexture*, int> TexIndices;
+
+    auto AddTexture = [&](ITexture* pTexture, int DefaultIdx) //
+    {
+        if (pTexture == nullptr)
+            return DefaultIdx;
+
+        auto it = TexIndices.find(pTexture);
+        if (it != TexIndices.end())
+            return it->second;
+
+        if (TexSRVs.size() >= m_Settings.MaxBindlessTextures)
+        {
+            LOG_WARNING_MESSAGE_ONCE("The number of textures in the GLTF model exceeds the size of the bindless texture array (",
+                                     m_Settings.MaxBindlessTextures, "). Some materials will use default textures.");
+            return DefaultIdx;
+        }
+
+        const auto Idx = static_cast<int>(TexSRVs.size());
+        TexSRVs.push_back(pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+        TexIndices.emplace(pTexture, Idx);
+        return Idx;
+    };
+
+    // Material index is the index in GLTFModel.Materials
+    std::vector<GLTFBindlessMaterialInfo> Materials(GLTFModel.Materials.size());
+    for (size_t i = 0; i < GLTFModel.Materials.size(); ++i)
+    {
+        const auto& Mat  = GLTFModel.Materials[i];
+        auto&       Info = Materials[i];
+
+        const auto MaterialTextures = GetMaterialTextures(Mat);
+
+        Info.Material                          = GetMaterialShaderInfo(Mat);
+        Info.TextureIndices                    = {};
+        Info.TextureIndices.BaseColor          = AddTexture(MaterialTextures.first, WhiteTexIdx);
+        Info.TextureIndices.PhysicalDescriptor = AddTexture(MaterialTextures.second, WhiteTexIdx);
+        Info.TextureIndices.Normal             = AddTexture(Mat.pNormalTexture.RawPtr<ITexture>(), DefaultNormalMapIdx);
+        Info.TextureIndices.Occlusion          = m_Settings.UseAO ? AddTexture(Mat.pOcclusionTexture.RawPtr<ITexture>(), WhiteTexIdx) : WhiteTexIdx;
+        Info.TextureIndices.Emissive           = m_Settings.UseEmissive ? AddTexture(Mat.pEmissiveTexture.RawPtr<ITexture>(), BlackTexIdx) : BlackTexIdx;
     }
+
+    // All elements of the array must be initialized
+    TexSRVs.resize(m_Settings.MaxBindlessTextures, m_pWhiteTexSRV.RawPtr());
+    pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Textures")->SetArray(TexSRVs.data(), 0, static_cast<Uint32>(TexSRVs.size()));
+
+    if (!Materials.empty())
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "GLTF bindless materials buffer";
+        BuffDesc.uiSizeInBytes     = static_cast<Uint32>(sizeof(GLTFBindlessMaterialInfo) * Materials.size());
+        BuffDesc.Usage             = USAGE_IMMUTABLE;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(GLTFBindlessMaterialInfo);
+
+        BufferData             InitData{Materials.data(), BuffDesc.uiSizeInBytes};
+        RefCntAutoPtr<IBuffer> pMaterialsBuffer;
+        m_pDevice->CreateBuffer(BuffDesc, &InitData, &pMaterialsBuffer);
+        pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Materials")->Set(pMaterialsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+
+        m_PendingMaterialBuffers.emplace_back(std::move(pMaterialsBuffer), RESOURCE_STATE_SHADER_RESOURCE);
+    }
+
+    for (auto& Mat : GLTFModel.Materials)
+    {
+        // Depth-only passes of alpha-masked materials still use per-material bindings
+        CreateDepthSRBs(Mat, Mat.AlphaMode == GLTF::Material::ALPHAMODE_MASK ? CreateMaterialCB(Mat) : RefCntAutoPtr<IBuffer>{});
+
+        // All materials share the same SRB, so the model is rendered without switching SRBs
+        m_SRBCache[SRBCacheKey{&Mat, 0}] = pSRB;
+    }
+
+    // Draw lists reference SRBs
+    m_DrawListCache.clear();
 }
 
 void GLTF_PBR_Renderer::ReleaseResourceBindings(GLTF::Model& GLTFModel, size_t SRBTypeId)
 {
+    m_DrawListCache.clear();
     for (auto& mat : GLTFModel.Materials)
     {
         m_SRBCache.erase(SRBCacheKey{&mat, SRBTypeId});
+        if (SRBTypeId == 0)
+        {
+            m_DepthSRBCache.erase(&mat);
+            m_SharedSRBMaterials.erase(&mat);
+        }
     }
 }
 
-
-void GLTF_PBR_Renderer::RenderGLTFNode(IDeviceContext*                                pCtx,
-                                       const GLTF::Node*                              node,
-                                       GLTF::Material::ALPHA_MODE                     AlphaMode,
-                                       const float4x4&                                ModelTransform,
-                                       std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
-                                       size_t                                         SRBTypeId)
+void GLTF_PBR_Renderer::InitializeResourceBindings(const GLTF_StaticScene& Scene,
+                                                   IBuffer*                pCameraAttribs,
+                                                   IBuffer*                pLightAttribs)
 {
-    if (node->_Mesh)
+    if (m_PSOCache.empty())
     {
-        // Render mesh primitives
-        for (const auto& primitive : node->_Mesh->Primitives)
+        LOG_ERROR_MESSAGE("Static scenes can't be rendered as the renderer has no render target or depth format");
+        return;
+    }
+
+    // Pipelines of the static scenes are only compiled by the applications that use them
+    if (!m_StaticScenePSOs[0])
+        CreateStaticScenePSOs(m_pDevice);
+
+    // SRBs of all batches that use the same material are the same
+    std::unordered_map<const GLTF::Material*, IShaderResourceBinding*> MaterialSRBs;
+
+    auto& SRBs = m_StaticSceneSRBs[&Scene];
+    SRBs.clear();
+    SRBs.reserve(Scene.GetBatches().size());
+    for (const auto& batch : Scene.GetBatches())
+    {
+        auto it = MaterialSRBs.find(batch.pMaterial);
+        if (it == MaterialSRBs.end())
         {
-            if (primitive->material.AlphaMode != AlphaMode)
-                continue;
+            // SRB is compatible with both single- and double-sided pipelines
+            RefCntAutoPtr<IShaderResourceBinding> pSRB;
+            m_StaticScenePSOs[0]->CreateShaderResourceBinding(&pSRB, true);
+            InitMaterialSRB(pSRB, *batch.pMaterial, pCameraAttribs, pLightAttribs);
+            pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_Instances")->Set(Scene.GetInstancesBufferSRV());
+            it = MaterialSRBs.emplace(batch.pMaterial, pSRB).first;
+            SRBs.emplace_back(std::move(pSRB));
+        }
+        else
+        {
+            SRBs.emplace_back(it->second);
+        }
+    }
 
-            GLTFNodeRenderInfo NodeRI;
+    if (m_StaticSceneDepthPSOs[0])
+    {
+        // Opaque depth-only draws only read the instances, so all batches share one SRB
+        auto& pDepthSRB = m_StaticSceneDepthSRBs[&Scene];
+        pDepthSRB.Release();
+        m_StaticSceneDepthPSOs[0]->CreateShaderResourceBinding(&pDepthSRB, true);
+        pDepthSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_Instances")->Set(Scene.GetInstancesBufferSRV());
+    }
+}
 
-            IShaderResourceBinding* pSRB = nullptr;
+void GLTF_PBR_Renderer::ReleaseResourceBindings(const GLTF_StaticScene& Scene)
+{
+    m_StaticSceneSRBs.erase(&Scene);
+    m_StaticSceneDepthSRBs.erase(&Scene);
+}
+
+const GLTF_PBR_Renderer::DrawList& GLTF_PBR_Renderer::GetDrawList(const GLTF::Model& GLTFModel, size_t SRBTypeId)
+{
+    const DrawListKey Key{&GLTFModel, SRBTypeId};
+
+    auto it = m_DrawListCache.find(Key);
+    if (it != m_DrawListCache.end())
+        return it->second;
 
+    DrawList List;
+    for (const auto* node : GLTFModel.LinearNodes)
+    {
+        if (!node->_Mesh)
+            continue;
+
+        for (const auto& primitive : node->_Mesh->Primitives)
+        {
             const auto& material = primitive->material;
-            if (RenderNodeCallback == nullptr)
-            {
-                auto* pPSO = GetPSO(PSOKey{AlphaMode, material.DoubleSided});
-                VERIFY_EXPR(pPSO != nullptr);
-                pCtx->SetPipelineState(pPSO);
 
-                pSRB = GetMaterialSRB(&material, SRBTypeId);
-                if (pSRB == nullptr)
-                {
-                    LOG_ERROR_MESSAGE("Unable to find SRB for GLTF material. Please call GLTF_PBR_Renderer::InitializeResourceBindings()");
-                    continue;
-                }
-                pCtx->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            DrawItem Item;
+            Item.pNode      = node;
+            Item.pPrimitive = primitive.get();
+            // There are no PSOs when the application renders the model with a custom callback
+            Item.pPSO = !m_PSOCache.empty() ? GetPSO(PSOKey{material.AlphaMode, material.DoubleSided}) : nullptr;
+            Item.pSRB = GetMaterialSRB(&material, SRBTypeId);
+            if (m_UseBindlessMaterials && SRBTypeId == 0)
+                Item.MaterialIndex = static_cast<Int32>(&material - GLTFModel.Materials.data());
+            if (SRBTypeId == 0)
+            {
+                auto shared_it           = m_SharedSRBMaterials.find(&material);
+                Item.pSharedMaterialInfo = shared_it != m_SharedSRBMaterials.end() ? &shared_it->second : nullptr;
+            }
+            if (material.AlphaMode == GLTF::Material::ALPHAMODE_MASK)
+            {
+                auto depth_srb_it = m_DepthSRBCache.find(&material);
+                Item.pDepthSRB    = depth_srb_it != m_DepthSRBCache.end() ? depth_srb_it->second.RawPtr() : nullptr;
             }
             else
             {
-                NodeRI.pMaterial = &material;
+                Item.pDepthSRB = m_pDepthSRB;
             }
+            List.Items.push_back(Item);
+        }
+    }
 
-            {
-                GLTFNodeShaderTransforms* pTransforms = nullptr;
-                if (RenderNodeCallback == nullptr)
-                {
-                    pCtx->MapBuffer(m_TransformsCB, MAP_WRITE, MAP_FLAG_DISCARD, reinterpret_cast<PVoid&>(pTransforms));
-                }
-                else
-                {
-                    pTransforms = &NodeRI.ShaderTransforms;
-                }
+    // Group the draws by alpha mode, then by PSO, SRB, material and mesh, so that consecutive
+    // draws share as much state as possible.
+    std::stable_sort(List.Items.begin(), List.Items.end(), [](const DrawItem& Item0, const DrawItem& Item1) {
+        const auto AlphaMode0 = Item0.pPrimitive->material.AlphaMode;
+        const auto AlphaMode1 = Item1.pPrimitive->material.AlphaMode;
+        if (AlphaMode0 != AlphaMode1)
+            return AlphaMode0 < AlphaMode1;
+        if (Item0.pPSO != Item1.pPSO)
+            return std::less<const IPipelineState*>{}(Item0.pPSO, Item1.pPSO);
+        if (Item0.pSRB != Item1.pSRB)
+            return std::less<const IShaderResourceBinding*>{}(Item0.pSRB, Item1.pSRB);
+        if (&Item0.pPrimitive->material != &Item1.pPrimitive->material)
+            return std::less<const GLTF::Material*>{}(&Item0.pPrimitive->material, &Item1.pPrimitive->material);
+        return Item0.pNode->LinearIndex < Item1.pNode->LinearIndex;
+    });
+
+    for (int AlphaMode = 0; AlphaMode <= GLTF::Material::ALPHAMODE_BLEND + 1; ++AlphaMode)
+    {
+        const auto ModeStart = std::find_if(List.Items.begin(), List.Items.end(), [AlphaMode](const DrawItem& Item) {
+            return Item.pPrimitive->material.AlphaMode >= AlphaMode;
+        });
+        List.AlphaModeOffsets[AlphaMode] = static_cast<size_t>(ModeStart - List.Items.begin());
+    }
 
-                pTransforms->NodeMatrix = node->_Mesh->Transforms.matrix * ModelTransform;
-                pTransforms->JointCount = node->_Mesh->Transforms.jointcount;
-                if (node->_Mesh->Transforms.jointcount != 0)
-                {
-                    static_assert(sizeof(pTransforms->JointMatrix) == sizeof(node->_Mesh->Transforms.jointMatrix), "Incosistent sizes");
-                    memcpy(pTransforms->JointMatrix, node->_Mesh->Transforms.jointMatrix, sizeof(node->_Mesh->Transforms.jointMatrix));
-                }
+    return m_DrawListCache.emplace(Key, std::move(List)).first->second;
+}
 
-                if (RenderNodeCallback == nullptr)
-                {
-                    pCtx->UnmapBuffer(m_TransformsCB, MAP_WRITE);
-                }
-            }
+void GLTF_PBR_Renderer::RenderDrawItem(IDeviceContext*                                pCtx,
+                                       const DrawItem&                                Item,
+                                       const GLTF::ModelInstance*                     pInstance,
+                                       const Uint32*                                  pFirstJoints,
+                                       const float4x4&                                ModelTransform,
+                                       std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
+                                       DrawState&                                     State)
+{
+    const auto* node      = Item.pNode;
+    const auto& primitive = *Item.pPrimitive;
+    const auto& material  = primitive.material;
 
-            {
-                GLTFMaterialShaderInfo* pMaterialInfo = nullptr;
-                if (RenderNodeCallback == nullptr)
-                {
-                    struct GLTFAttribs
-                    {
-                        GLTFRendererShaderParameters RenderParameters;
-                        GLTFMaterialShaderInfo       MaterialInfo;
-                    };
-                    GLTFAttribs* pGLTFAttribs = nullptr;
-                    pCtx->MapBuffer(m_GLTFAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD, reinterpret_cast<PVoid&>(pGLTFAttribs));
-                    pMaterialInfo = &pGLTFAttribs->MaterialInfo;
-
-                    auto& RenderParams = pGLTFAttribs->RenderParameters;
-
-                    RenderParams.DebugViewType            = static_cast<int>(m_RenderParams.DebugView);
-                    RenderParams.OcclusionStrength        = m_RenderParams.OcclusionStrength;
-                    RenderParams.EmissionScale            = m_RenderParams.EmissionScale;
-                    RenderParams.AverageLogLum            = m_RenderParams.AverageLogLum;
-                    RenderParams.MiddleGray               = m_RenderParams.MiddleGray;
-                    RenderParams.WhitePoint               = m_RenderParams.WhitePoint;
-                    RenderParams.IBLScale                 = m_RenderParams.IBLScale;
-                    RenderParams.PrefilteredCubeMipLevels = m_Settings.UseIBL ? static_cast<float>(m_pPrefilteredEnvMapSRV->GetTexture()->GetDesc().MipLevels) : 0.f;
-                }
-                else
-                {
-                    pMaterialInfo = &NodeRI.MaterialShaderInfo;
-                }
+    const auto MaxLODError = m_NodeLODErrors.empty() ? 0.f : m_NodeLODErrors[node->LinearIndex];
+    const auto LODIdx      = MaxLODError > 0 ? SelectLOD(primitive, MaxLODError) : 0;
+    const auto FirstIndex  = LODIdx > 0 ? primitive.LODs[LODIdx - 1].FirstIndex : primitive.FirstIndex;
+    const auto IndexCount  = LODIdx > 0 ? primitive.LODs[LODIdx - 1].IndexCount : primitive.IndexCount;
 
-                pMaterialInfo->EmissiveFactor = material.EmissiveFactor;
+    GLTFNodeRenderInfo NodeRI;
+    if (RenderNodeCallback == nullptr)
+    {
+        if (Item.pSRB == nullptr)
+        {
+            LOG_ERROR_MESSAGE("Unable to find SRB for GLTF material. Please call GLTF_PBR_Renderer::InitializeResourceBindings()");
+            return;
+        }
 
-                auto GetUVSelector = [](const ITexture* pTexture, Uint8 TexCoordSet) {
-                    return pTexture != nullptr ? static_cast<float>(TexCoordSet) : -1;
-                };
+        if (State.pPSO != Item.pPSO)
+        {
+            VERIFY_EXPR(Item.pPSO != nullptr);
+            pCtx->SetPipelineState(Item.pPSO);
+            State.pPSO = Item.pPSO;
+            // Resources must be committed again after the pipeline has changed
+            State.pSRB = nullptr;
+        }
 
-                pMaterialInfo->BaseColorTextureUVSelector = GetUVSelector(material.pBaseColorTexture, material.TexCoordSets.BaseColor);
-                pMaterialInfo->NormalTextureUVSelector    = GetUVSelector(material.pNormalTexture, material.TexCoordSets.Normal);
-                pMaterialInfo->OcclusionTextureUVSelector = GetUVSelector(material.pOcclusionTexture, material.TexCoordSets.Occlusion);
-                pMaterialInfo->EmissiveTextureUVSelector  = GetUVSelector(material.pEmissiveTexture, material.TexCoordSets.Emissive);
-                pMaterialInfo->UseAlphaMask               = material.AlphaMode == GLTF::Material::ALPHAMODE_MASK ? 1 : 0;
-                pMaterialInfo->AlphaMaskCutoff            = material.AlphaCutoff;
+        if (State.pSRB != Item.pSRB)
+        {
+            pCtx->CommitShaderResources(Item.pSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            State.pSRB = Item.pSRB;
+        }
 
-                // TODO: glTF specs states that metallic roughness should be preferred, even if specular glosiness is present
-                if (material.workflow == GLTF::Material::PbrWorkflow::MetallicRoughness)
-                {
-                    // Metallic roughness workflow
-                    pMaterialInfo->Workflow                            = PBR_WORKFLOW_METALLIC_ROUGHNESS;
-                    pMaterialInfo->BaseColorFactor                     = material.BaseColorFactor;
-                    pMaterialInfo->MetallicFactor                      = material.MetallicFactor;
-                    pMaterialInfo->RoughnessFactor                     = material.RoughnessFactor;
-                    pMaterialInfo->PhysicalDescriptorTextureUVSelector = GetUVSelector(material.pMetallicRoughnessTexture, material.TexCoordSets.MetallicRoughness);
-                    pMaterialInfo->BaseColorTextureUVSelector          = GetUVSelector(material.pBaseColorTexture, material.TexCoordSets.BaseColor);
-                }
-                else if (material.workflow == GLTF::Material::PbrWorkflow::SpecularGlossiness)
-                {
-                    // Specular glossiness workflow
-                    pMaterialInfo->Workflow                            = PBR_WORKFLOW_SPECULAR_GLOSINESS;
-                    pMaterialInfo->PhysicalDescriptorTextureUVSelector = GetUVSelector(material.extension.pSpecularGlossinessTexture, material.TexCoordSets.SpecularGlossiness);
-                    pMaterialInfo->BaseColorTextureUVSelector          = GetUVSelector(material.extension.pDiffuseTexture, material.TexCoordSets.BaseColor);
-                    pMaterialInfo->BaseColorFactor                     = material.extension.DiffuseFactor;
-                    pMaterialInfo->SpecularFactor                      = float4(material.extension.SpecularFactor, 1.0f);
-                }
+        // In bindless mode, only the material index changes between materials
+        if (Item.MaterialIndex >= 0 && State.MaterialIndex != Item.MaterialIndex)
+        {
+            MapHelper<GLTFBindlessDrawAttribs> DrawAttribs{pCtx, m_BindlessDrawAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+            DrawAttribs->MaterialIndex = Item.MaterialIndex;
+            State.MaterialIndex        = Item.MaterialIndex;
+        }
 
-                if (RenderNodeCallback == nullptr)
-                {
-                    pCtx->UnmapBuffer(m_GLTFAttribsCB, MAP_WRITE);
-                }
-            }
+        // Materials that share the SRB only differ in their attributes
+        if (Item.pSharedMaterialInfo != nullptr && State.pSharedMaterialInfo != Item.pSharedMaterialInfo)
+        {
+            MapHelper<GLTFMaterialShaderInfo> MaterialInfo{pCtx, m_SharedMaterialAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+            *MaterialInfo             = *Item.pSharedMaterialInfo;
+            State.pSharedMaterialInfo = Item.pSharedMaterialInfo;
+        }
+    }
+    else
+    {
+        NodeRI.pMaterial = &material;
+    }
+
+    // Consecutive draws of the same mesh reuse the uploaded transforms
+    if (RenderNodeCallback != nullptr || State.pNode != node)
+    {
+        const auto& Transforms = GetMeshTransforms(node, pInstance);
+
+        GLTFNodeShaderTransforms* pTransforms = nullptr;
+        if (RenderNodeCallback == nullptr)
+        {
+            pCtx->MapBuffer(m_TransformsCB, MAP_WRITE, MAP_FLAG_DISCARD, reinterpret_cast<PVoid&>(pTransforms));
+        }
+        else
+        {
+            pTransforms = &NodeRI.ShaderTransforms;
+        }
+
+        pTransforms->NodeMatrix = Transforms.matrix * ModelTransform;
 
-            if (primitive->hasIndices)
+        if (m_RenderParams.pSkinnedVertexBuffer != nullptr)
+        {
+            // Vertices have already been skinned by the compute pre-pass
+            pTransforms->JointCount = 0;
+            pTransforms->FirstJoint = 0;
+        }
+        else if (m_Settings.UseJointsBuffer)
+        {
+            // Joint matrices have already been written to the joints buffer
+            const auto FirstJoint   = pFirstJoints != nullptr ? pFirstJoints[node->LinearIndex] : InvalidJoint;
+            pTransforms->JointCount = FirstJoint != InvalidJoint ? static_cast<int>(Transforms.jointMatrices.size()) : 0;
+            pTransforms->FirstJoint = FirstJoint != InvalidJoint ? static_cast<int>(FirstJoint) : 0;
+        }
+        else
+        {
+            auto JointCount = static_cast<Uint32>(Transforms.jointMatrices.size());
+            if (JointCount > MaxNumJoints)
             {
+                LOG_WARNING_MESSAGE_ONCE("The number of joints in the mesh (", JointCount, ") exceeds the maximum supported number (", MaxNumJoints, ")");
+                JointCount = MaxNumJoints;
+            }
+            pTransforms->JointCount = static_cast<int>(JointCount);
+            pTransforms->FirstJoint = 0;
+            if (JointCount != 0)
+            {
+                // The joint palette is only uploaded for skinned meshes and only the joints
+                // the skin actually has are copied
+                GLTFJointMatrices* pJoints = nullptr;
                 if (RenderNodeCallback == nullptr)
                 {
-                    DrawIndexedAttribs drawAttrs(primitive->IndexCount, VT_UINT32, DRAW_FLAG_VERIFY_ALL);
-                    drawAttrs.FirstIndexLocation = primitive->FirstIndex;
-                    pCtx->DrawIndexed(drawAttrs);
+                    pCtx->MapBuffer(m_JointMatricesCB, MAP_WRITE, MAP_FLAG_DISCARD, reinterpret_cast<PVoid&>(pJoints));
                 }
                 else
                 {
-                    NodeRI.IndexType  = VT_UINT32;
-                    NodeRI.IndexCount = primitive->IndexCount;
-                    NodeRI.FirstIndex = primitive->FirstIndex;
-                    RenderNodeCallback(NodeRI);
+                    pJoints = &NodeRI.JointMatrices;
                 }
-            }
-            else
-            {
+
+                memcpy(pJoints->JointMatrix, Transforms.jointMatrices.data(), sizeof(float4x4) * JointCount);
+
                 if (RenderNodeCallback == nullptr)
                 {
-                    DrawAttribs drawAttrs(primitive->VertexCount, DRAW_FLAG_VERIFY_ALL);
-                    pCtx->Draw(drawAttrs);
-                }
-                else
-                {
-                    NodeRI.IndexType   = VT_UNDEFINED;
-                    NodeRI.VertexCount = primitive->VertexCount;
-                    NodeRI.FirstIndex  = 0;
-                    RenderNodeCallback(NodeRI);
+                    pCtx->UnmapBuffer(m_JointMatricesCB, MAP_WRITE);
                 }
             }
         }
+
+        if (RenderNodeCallback == nullptr)
+        {
+            pCtx->UnmapBuffer(m_TransformsCB, MAP_WRITE);
+        }
+
+        State.pNode = node;
+    }
+
+    if (RenderNodeCallback != nullptr)
+    {
+        NodeRI.MaterialShaderInfo = GetMaterialShaderInfo(material);
+    }
+
+    if (primitive.hasIndices)
+    {
+        if (RenderNodeCallback == nullptr)
+        {
+            DrawIndexedAttribs drawAttrs(IndexCount, VT_UINT32, DRAW_FLAG_VERIFY_ALL);
+            drawAttrs.FirstIndexLocation = FirstIndex;
+            pCtx->DrawIndexed(drawAttrs);
+        }
+        else
+        {
+            NodeRI.IndexType  = VT_UINT32;
+            NodeRI.IndexCount = IndexCount;
+            NodeRI.FirstIndex = FirstIndex;
+            RenderNodeCallback(NodeRI);
+        }
     }
+    else
+    {
+        if (RenderNodeCallback == nullptr)
+        {
+            DrawAttribs drawAttrs(primitive.VertexCount, DRAW_FLAG_VERIFY_ALL);
+            drawAttrs.StartVertexLocation = primitive.FirstVertex;
+            pCtx->Draw(drawAttrs);
+        }
+        else
+        {
+            NodeRI.IndexType   = VT_UNDEFINED;
+            NodeRI.VertexCount = primitive.VertexCount;
+            NodeRI.FirstIndex  = 0;
+            RenderNodeCallback(NodeRI);
+        }
+    }
+}
 
-    for (const auto& child : node->Children)
+float GLTF_PBR_Renderer::GetScreenSize(const BoundBox& BB, const float4x4& WorldViewProj)
+{
+    float2 MinPos{+FLT_MAX, +FLT_MAX};
+    float2 MaxPos{-FLT_MAX, -FLT_MAX};
+    for (Uint32 Corner = 0; Corner < 8; ++Corner)
     {
-        RenderGLTFNode(pCtx, child.get(), AlphaMode, ModelTransform, RenderNodeCallback, SRBTypeId);
+        const float3 Pos{
+            (Corner & 0x01) ? BB.Max.x : BB.Min.x,
+            (Corner & 0x02) ? BB.Max.y : BB.Min.y,
+            (Corner & 0x04) ? BB.Max.z : BB.Min.z //
+        };
+        const auto ClipPos = float4{Pos, 1} * WorldViewProj;
+        if (ClipPos.w <= 0)
+            return FLT_MAX;
+
+        const float2 NDCPos{ClipPos.x / ClipPos.w, ClipPos.y / ClipPos.w};
+        MinPos = std::min(MinPos, NDCPos);
+        MaxPos = std::max(MaxPos, NDCPos);
     }
+    // NDC range is [-1, 1]
+    return length(MaxPos - MinPos) * 0.5f;
+}
+
+Uint32 GLTF_PBR_Renderer::SelectLOD(const GLTF::Primitive& Primitive, float MaxError)
+{
+    // Levels are ordered by increasing error
+    Uint32 LODIdx = 0;
+    while (LODIdx < Primitive.LODs.size() && Primitive.LODs[LODIdx].Error <= MaxError)
+        ++LODIdx;
+    return LODIdx;
 }
 
 void GLTF_PBR_Renderer::Render(IDeviceContext*                                pCtx,
@@ -925,52 +2029,334 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*                                pC
                                const RenderInfo&                              RenderParams,
                                std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
                                size_t                                         SRBTypeId)
+{
+    RenderModel(pCtx, GLTFModel, nullptr, RenderParams, RenderNodeCallback, SRBTypeId);
+}
+
+void GLTF_PBR_Renderer::Render(IDeviceContext*                                pCtx,
+                               const GLTF::ModelInstance&                     Instance,
+                               const RenderInfo&                              RenderParams,
+                               std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
+                               size_t                                         SRBTypeId)
+{
+    RenderModel(pCtx, Instance.GLTFModel, &Instance, RenderParams, RenderNodeCallback, SRBTypeId);
+}
+
+void GLTF_PBR_Renderer::RenderDepth(IDeviceContext*   pCtx,
+                                    GLTF::Model&      GLTFModel,
+                                    const RenderInfo& RenderParams,
+                                    bool              IsShadowPass)
+{
+    RenderModelDepth(pCtx, GLTFModel, nullptr, RenderParams, IsShadowPass);
+}
+
+void GLTF_PBR_Renderer::RenderDepth(IDeviceContext*            pCtx,
+                                    const GLTF::ModelInstance& Instance,
+                                    const RenderInfo&          RenderParams,
+                                    bool                       IsShadowPass)
+{
+    RenderModelDepth(pCtx, Instance.GLTFModel, &Instance, RenderParams, IsShadowPass);
+}
+
+void GLTF_PBR_Renderer::TransitionPendingMaterialBuffers(IDeviceContext* pCtx)
+{
+    if (m_PendingMaterialBuffers.empty())
+        return;
+
+    std::vector<StateTransitionDesc> Barriers;
+    Barriers.reserve(m_PendingMaterialBuffers.size());
+    for (auto& Buffer : m_PendingMaterialBuffers)
+        Barriers.emplace_back(Buffer.first, RESOURCE_STATE_UNKNOWN, Buffer.second, true);
+    pCtx->TransitionResourceStates(static_cast<Uint32>(Barriers.size()), Barriers.data());
+    m_PendingMaterialBuffers.clear();
+}
+
+void GLTF_PBR_Renderer::UpdateShaderParameters(IDeviceContext* pCtx, const RenderInfo& RenderParams)
+{
+    MapHelper<GLTFRendererShaderParameters> ShaderParams{pCtx, m_GLTFAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+
+    ShaderParams->DebugViewType            = static_cast<int>(RenderParams.DebugView);
+    ShaderParams->OcclusionStrength        = RenderParams.OcclusionStrength;
+    ShaderParams->EmissionScale            = RenderParams.EmissionScale;
+    ShaderParams->AverageLogLum            = RenderParams.AverageLogLum;
+    ShaderParams->MiddleGray               = RenderParams.MiddleGray;
+    ShaderParams->WhitePoint               = RenderParams.WhitePoint;
+    ShaderParams->IBLScale                 = RenderParams.IBLScale;
+    ShaderParams->PrefilteredCubeMipLevels = m_Settings.UseIBL ? static_cast<float>(m_pPrefilteredEnvMapSRV->GetTexture()->GetDesc().MipLevels) : 0.f;
+}
+
+const Uint32* GLTF_PBR_Renderer::PrepareModelDraw(IDeviceContext*            pCtx,
+                                                  const GLTF::Model&         GLTFModel,
+                                                  const GLTF::ModelInstance* pInstance,
+                                                  const RenderInfo&          RenderParams,
+                                                  bool                       BindBuffers)
 {
     m_RenderParams = RenderParams;
 
-    if (RenderNodeCallback == nullptr)
+    if (BindBuffers)
     {
-        IBuffer* pVBs[]                  = {GLTFModel.pVertexBuffer[0], GLTFModel.pVertexBuffer[1]};
+        // The model is shared between instances and is never modified by the renderer
+        IBuffer* pVB0                    = RenderParams.pSkinnedVertexBuffer != nullptr ? RenderParams.pSkinnedVertexBuffer : GLTFModel.pVertexBuffer[0].RawPtr<IBuffer>();
+        IBuffer* pVBs[]                  = {pVB0, GLTFModel.pVertexBuffer[1].RawPtr<IBuffer>()};
         Uint32   Offsets[_countof(pVBs)] = {};
         pCtx->SetVertexBuffers(0, _countof(pVBs), pVBs, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
         if (GLTFModel.pIndexBuffer)
         {
-            pCtx->SetIndexBuffer(GLTFModel.pIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            pCtx->SetIndexBuffer(GLTFModel.pIndexBuffer.RawPtr<IBuffer>(), 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
         }
+
+        TransitionPendingMaterialBuffers(pCtx);
     }
     else
     {
         // An application should bind index buffers and PSOs
     }
 
+    // Offsets of the skinned meshes' palettes in the joints buffer, indexed by Node::LinearIndex
+    const Uint32* pFirstJoints = nullptr;
+    if (m_Settings.UseJointsBuffer && pInstance != nullptr && RenderParams.FirstJoint != InvalidJoint)
+    {
+        m_FirstJoints.resize(GLTFModel.LinearNodes.size());
+        auto FirstJoint = RenderParams.FirstJoint;
+        for (const auto* node : GLTFModel.LinearNodes)
+        {
+            if (node->_Mesh && node->_Skin != nullptr)
+            {
+                m_FirstJoints[node->LinearIndex] = FirstJoint;
+                FirstJoint += static_cast<Uint32>(node->_Skin->Joints.size());
+            }
+            else
+            {
+                m_FirstJoints[node->LinearIndex] = InvalidJoint;
+            }
+        }
+        pFirstJoints = m_FirstJoints.data();
+    }
 
-    // Opaque primitives first
-    if (RenderParams.AlphaModes & RenderInfo::ALPHA_MODE_FLAG_OPAQUE)
+    // Maximum LOD errors of the mesh nodes. They depend on the current transforms, so they are
+    // computed every frame, once per node rather than once per primitive.
+    m_NodeLODErrors.clear();
+    if (RenderParams.MaxLODScreenError > 0)
     {
-        for (const auto& node : GLTFModel.Nodes)
+        m_NodeLODErrors.resize(GLTFModel.LinearNodes.size());
+        for (const auto* node : GLTFModel.LinearNodes)
         {
-            RenderGLTFNode(pCtx, node.get(), GLTF::Material::ALPHAMODE_OPAQUE, RenderParams.ModelTransform, RenderNodeCallback, SRBTypeId);
+            if (!node->_Mesh || !node->_Mesh->IsValidBB)
+                continue;
+
+            // Maximum simplification error in mesh space that projects to less than the allowed screen error
+            const auto& BB         = node->_Mesh->BB;
+            const auto  ScreenSize = GetScreenSize(BB, GetMeshTransforms(node, pInstance).matrix * RenderParams.ModelTransform * RenderParams.ViewProj);
+            if (ScreenSize > 0 && ScreenSize < FLT_MAX)
+                m_NodeLODErrors[node->LinearIndex] = RenderParams.MaxLODScreenError * length(BB.Max - BB.Min) / ScreenSize;
         }
     }
 
+    return pFirstJoints;
+}
 
-    // Alpha masked primitives
-    if (RenderParams.AlphaModes & RenderInfo::ALPHA_MODE_FLAG_MASK)
+void GLTF_PBR_Renderer::RenderModelDepth(IDeviceContext*            pCtx,
+                                         const GLTF::Model&         GLTFModel,
+                                         const GLTF::ModelInstance* pInstance,
+                                         const RenderInfo&          RenderParams,
+                                         bool                       IsShadowPass)
+{
+    if (!m_DepthPSOs[GetDepthPSOIdx(IsShadowPass, GLTF::Material::ALPHAMODE_OPAQUE, false)])
     {
-        for (const auto& node : GLTFModel.Nodes)
+        if (IsShadowPass)
+            LOG_ERROR_MESSAGE("Shadow pipeline states have not been created. Please set GLTF_PBR_Renderer::CreateInfo::ShadowMapFmt");
+        else
+            LOG_ERROR_MESSAGE("Depth pipeline states have not been created as the renderer has no render target or depth format");
+        return;
+    }
+
+    const auto* pFirstJoints = PrepareModelDraw(pCtx, GLTFModel, pInstance, RenderParams, true);
+
+    {
+        MapHelper<float4x4> DepthViewProj{pCtx, m_DepthPassAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+        *DepthViewProj = RenderParams.ViewProj.Transpose();
+    }
+
+    // Depth SRBs do not depend on the SRB type, and the draw list of the default type is
+    // the one that is most likely cached already.
+    const auto& List = GetDrawList(GLTFModel, 0);
+
+    DrawState State;
+    for (auto AlphaMode : {GLTF::Material::ALPHAMODE_OPAQUE, GLTF::Material::ALPHAMODE_MASK})
+    {
+        if ((RenderParams.AlphaModes & (1u << AlphaMode)) == 0)
+            continue;
+
+        for (auto i = List.AlphaModeOffsets[AlphaMode]; i < List.AlphaModeOffsets[AlphaMode + 1]; ++i)
         {
-            RenderGLTFNode(pCtx, node.get(), GLTF::Material::ALPHAMODE_MASK, RenderParams.ModelTransform, RenderNodeCallback, SRBTypeId);
+            auto DepthItem = List.Items[i];
+            DepthItem.pPSO = m_DepthPSOs[GetDepthPSOIdx(IsShadowPass, AlphaMode, DepthItem.pPrimitive->material.DoubleSided)];
+            DepthItem.pSRB = DepthItem.pDepthSRB;
+            // Depth PSOs do not use bindless materials or shared material attributes
+            DepthItem.MaterialIndex       = -1;
+            DepthItem.pSharedMaterialInfo = nullptr;
+            RenderDrawItem(pCtx, DepthItem, pInstance, pFirstJoints, RenderParams.ModelTransform, nullptr, State);
         }
     }
+}
+
+void GLTF_PBR_Renderer::RenderStaticScene(IDeviceContext*         pCtx,
+                                          const GLTF_StaticScene& Scene,
+                                          const RenderInfo&       RenderParams)
+{
+    auto srbs_it = m_StaticSceneSRBs.find(&Scene);
+    if (srbs_it == m_StaticSceneSRBs.end())
+    {
+        LOG_ERROR_MESSAGE("Resource bindings of the static scene have not been initialized. Please call GLTF_PBR_Renderer::InitializeResourceBindings()");
+        return;
+    }
+
+    const auto& Batches = Scene.GetBatches();
+    const auto& SRBs    = srbs_it->second;
+    if (Batches.empty())
+        return;
+    if (SRBs.size() != Batches.size())
+    {
+        LOG_ERROR_MESSAGE("Resource bindings of the static scene were initialized before the scene was built");
+        return;
+    }
+
+    TransitionPendingMaterialBuffers(pCtx);
+    UpdateShaderParameters(pCtx, RenderParams);
 
+    IBuffer* pVBs[]                  = {Scene.GetVertexBuffer(), Scene.GetVisibleInstancesBuffer()};
+    Uint32   Offsets[_countof(pVBs)] = {};
+    pCtx->SetVertexBuffers(0, _countof(pVBs), pVBs, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+    pCtx->SetIndexBuffer(Scene.GetIndexBuffer(), 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
 
-    // Transparent primitives
-    // TODO: Correct depth sorting
+    // Batches are sorted by pipeline and material. The number of draw calls only depends
+    // on the number of batches, while the instance counts are written by GLTF_StaticScene::Cull().
+    IPipelineState*         pCurrPSO = nullptr;
+    IShaderResourceBinding* pCurrSRB = nullptr;
+    for (size_t b = 0; b < Batches.size(); ++b)
+    {
+        auto* pPSO = m_StaticScenePSOs[Batches[b].pMaterial->DoubleSided ? 1 : 0].RawPtr();
+        if (pPSO != pCurrPSO)
+        {
+            pCtx->SetPipelineState(pPSO);
+            pCurrPSO = pPSO;
+            pCurrSRB = nullptr;
+        }
+
+        auto* pSRB = SRBs[b].RawPtr<IShaderResourceBinding>();
+        if (pSRB != pCurrSRB)
+        {
+            pCurrSRB = pSRB;
+            pCtx->CommitShaderResources(pCurrSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+        }
+
+        DrawIndexedIndirectAttribs DrawAttribs{VT_UINT32, DRAW_FLAG_VERIFY_ALL, RESOURCE_STATE_TRANSITION_MODE_VERIFY};
+        DrawAttribs.IndirectDrawArgsOffset = static_cast<Uint32>(b) * GLTF_StaticScene::DrawArgsStride;
+        pCtx->DrawIndexedIndirect(DrawAttribs, Scene.GetDrawArgsBuffer());
+    }
+}
+
+void GLTF_PBR_Renderer::RenderStaticSceneDepth(IDeviceContext*         pCtx,
+                                               const GLTF_StaticScene& Scene,
+                                               const RenderInfo&       RenderParams,
+                                               bool                    IsOccluderPass)
+{
+    auto srb_it = m_StaticSceneDepthSRBs.find(&Scene);
+    if (srb_it == m_StaticSceneDepthSRBs.end())
+    {
+        LOG_ERROR_MESSAGE("Depth resource bindings of the static scene have not been initialized. Please call GLTF_PBR_Renderer::InitializeResourceBindings()");
+        return;
+    }
+
+    const auto& Batches = Scene.GetBatches();
+    if (Batches.empty())
+        return;
+
+    {
+        MapHelper<float4x4> DepthViewProj{pCtx, m_DepthPassAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+        *DepthViewProj = RenderParams.ViewProj.Transpose();
+    }
+
+    IBuffer* pVBs[]                  = {Scene.GetVertexBuffer(), Scene.GetVisibleInstancesBuffer()};
+    Uint32   Offsets[_countof(pVBs)] = {};
+    pCtx->SetVertexBuffers(0, _countof(pVBs), pVBs, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+    pCtx->SetIndexBuffer(Scene.GetIndexBuffer(), 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+    IPipelineState* pCurrPSO = nullptr;
+    for (size_t b = 0; b < Batches.size(); ++b)
+    {
+        const auto& Material = *Batches[b].pMaterial;
+        if (Material.AlphaMode != GLTF::Material::ALPHAMODE_OPAQUE)
+            continue;
+
+        auto* pPSO = m_StaticSceneDepthPSOs[(IsOccluderPass ? 2 : 0) + (Material.DoubleSided ? 1 : 0)].RawPtr();
+        if (pPSO != pCurrPSO)
+        {
+            // The SRB is compatible with all pipelines, but must be committed again when the pipeline changes
+            pCtx->SetPipelineState(pPSO);
+            pCtx->CommitShaderResources(srb_it->second, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            pCurrPSO = pPSO;
+        }
+
+        DrawIndexedIndirectAttribs DrawAttribs{VT_UINT32, DRAW_FLAG_VERIFY_ALL, RESOURCE_STATE_TRANSITION_MODE_VERIFY};
+        DrawAttribs.IndirectDrawArgsOffset = static_cast<Uint32>(b) * GLTF_StaticScene::DrawArgsStride;
+        pCtx->DrawIndexedIndirect(DrawAttribs, Scene.GetDrawArgsBuffer());
+    }
+}
+
+void GLTF_PBR_Renderer::RenderModel(IDeviceContext*                                pCtx,
+                                    const GLTF::Model&                             GLTFModel,
+                                    const GLTF::ModelInstance*                     pInstance,
+                                    const RenderInfo&                              RenderParams,
+                                    std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
+                                    size_t                                         SRBTypeId)
+{
+    const auto* pFirstJoints = PrepareModelDraw(pCtx, GLTFModel, pInstance, RenderParams, RenderNodeCallback == nullptr);
+
+    if (RenderNodeCallback == nullptr)
+    {
+        // Render parameters are the same for all draws
+        UpdateShaderParameters(pCtx, RenderParams);
+    }
+
+    const auto& List = GetDrawList(GLTFModel, SRBTypeId);
+
+    // The state may have been changed by the application since the previous call
+    DrawState State;
+
+    // Opaque primitives first, then alpha masked primitives
+    for (auto AlphaMode : {GLTF::Material::ALPHAMODE_OPAQUE, GLTF::Material::ALPHAMODE_MASK})
+    {
+        if ((RenderParams.AlphaModes & (1u << AlphaMode)) == 0)
+            continue;
+
+        for (auto i = List.AlphaModeOffsets[AlphaMode]; i < List.AlphaModeOffsets[AlphaMode + 1]; ++i)
+        {
+            RenderDrawItem(pCtx, List.Items[i], pInstance, pFirstJoints, RenderParams.ModelTransform, RenderNodeCallback, State);
+        }
+    }
+
+    // Transparent primitives are sorted back to front
     if (RenderParams.AlphaModes & RenderInfo::ALPHA_MODE_FLAG_BLEND)
     {
-        for (const auto& node : GLTFModel.Nodes)
+        m_BlendItems.assign(List.Items.begin() + List.AlphaModeOffsets[GLTF::Material::ALPHAMODE_BLEND],
+                            List.Items.begin() + List.AlphaModeOffsets[GLTF::Material::ALPHAMODE_BLEND + 1]);
+        for (auto& Item : m_BlendItems)
+        {
+            const auto& BB     = Item.pPrimitive->IsValidBB ? Item.pPrimitive->BB : Item.pNode->_Mesh->BB;
+            const auto  Center = (BB.Min + BB.Max) * 0.5f;
+            const auto  Pos    = float4{Center, 1} * GetMeshTransforms(Item.pNode, pInstance).matrix * RenderParams.ModelTransform * RenderParams.ViewProj;
+            // Clip-space z is an affine function of the view-space depth for both perspective and
+            // orthographic projections, while w is constant for the latter
+            Item.Depth = Pos.z;
+        }
+        std::stable_sort(m_BlendItems.begin(), m_BlendItems.end(), [](const DrawItem& Item0, const DrawItem& Item1) {
+            return Item0.Depth > Item1.Depth;
+        });
+
+        for (const auto& Item : m_BlendItems)
         {
-            RenderGLTFNode(pCtx, node.get(), GLTF::Material::ALPHAMODE_BLEND, RenderParams.ModelTransform, RenderNodeCallback, SRBTypeId);
+            RenderDrawItem(pCtx, Item, pInstance, pFirstJoints, RenderParams.ModelTransform, RenderNodeCallback, State);
         }
     }
 }
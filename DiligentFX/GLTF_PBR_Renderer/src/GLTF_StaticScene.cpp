@@ -0,0 +1,627 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+#include <unordered_map>
+#include <cfloat>
+
+#include "GLTF_StaticScene.hpp"
+#include "../../Components/interface/HiZPyramid.hpp"
+#include "../../../Utilities/include/DiligentFXShaderSourceStreamFactory.hpp"
+#include "ShaderMacroHelper.hpp"
+#include "GraphicsUtilities.h"
+#include "MapHelper.hpp"
+#include "AdvancedMath.hpp"
+
+namespace Diligent
+{
+
+#include "Shaders/GLTF_PBR/public/GLTF_PBR_Structures.fxh"
+
+GLTF_StaticScene::GLTF_StaticScene(IRenderDevice* pDevice) :
+    m_pDevice{pDevice}
+{
+    CreateUniformBuffer(pDevice, sizeof(GLTFStaticCullingAttribs), "GLTF static scene culling attribs CB", &m_pCullingAttribsCB);
+
+    m_pCullingPSO = CreateCullingPSO(false, false);
+}
+
+RefCntAutoPtr<IPipelineState> GLTF_StaticScene::CreateCullingPSO(bool OcclusionCulling, bool OcclusionRetest)
+{
+    VERIFY(OcclusionCulling || !OcclusionRetest, "Occlusion retest requires occlusion culling");
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.UseCombinedTextureSamplers = true;
+    ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("CULLING_THREAD_GROUP_SIZE", ThreadGroupSize);
+    Macros.AddShaderMacro("HIZ_OCCLUSION_CULLING", OcclusionCulling);
+    Macros.AddShaderMacro("HIZ_OCCLUSION_RETEST", OcclusionRetest);
+    ShaderCI.Macros = Macros;
+
+    RefCntAutoPtr<IShader> pCS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = OcclusionRetest ? "GLTF instance occlusion retest CS" : (OcclusionCulling ? "GLTF instance occlusion culling CS" : "GLTF instance culling CS");
+        ShaderCI.FilePath        = "CullGLTFInstances.csh";
+        m_pDevice->CreateShader(ShaderCI, &pCS);
+    }
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name         = OcclusionRetest ? "GLTF instance occlusion retest PSO" : (OcclusionCulling ? "GLTF instance occlusion culling PSO" : "GLTF instance culling PSO");
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_COMPUTE, "cbCullingAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    PSOCreateInfo.pCS = pCS;
+    RefCntAutoPtr<IPipelineState> pPSO;
+    m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+    if (!pPSO)
+        LOG_ERROR_AND_THROW("Failed to create ", PSODesc.Name);
+
+    pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbCullingAttribs")->Set(m_pCullingAttribsCB);
+    return pPSO;
+}
+
+RefCntAutoPtr<IShaderResourceBinding> GLTF_StaticScene::CreateCullingSRB(IPipelineState* pPSO)
+{
+    RefCntAutoPtr<IShaderResourceBinding> pSRB;
+    pPSO->CreateShaderResourceBinding(&pSRB, true);
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Instances")->Set(m_pInstancesBufferSRV);
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_DrawArgs")->Set(m_pDrawArgsUAV);
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_VisibleInstances")->Set(m_pVisibleInstancesUAV);
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_CullingStats")->Set(m_pCullingStatsUAV);
+    if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OccludedInstances"))
+        pVar->Set(m_pOccludedInstancesUAV);
+    return pSRB;
+}
+
+void GLTF_StaticScene::AddInstance(const GLTF::Model& GLTFModel, const float4x4& Transform)
+{
+    if (m_IsBuilt)
+    {
+        LOG_ERROR_MESSAGE("Instances can't be added to a static scene that has already been built");
+        return;
+    }
+
+    InstanceInfo Info;
+    Info.pModel    = &GLTFModel;
+    Info.Transform = Transform;
+    m_Instances.emplace_back(Info);
+}
+
+void GLTF_StaticScene::Build(IDeviceContext* pCtx)
+{
+    if (m_IsBuilt)
+    {
+        LOG_ERROR_MESSAGE("The static scene has already been built");
+        return;
+    }
+    m_IsBuilt = true;
+
+    // Geometry of every model is packed once, no matter how many instances the model has
+    struct ModelGeometry
+    {
+        Uint32 BaseVertex = 0;
+        Uint32 FirstIndex = 0;
+    };
+    std::unordered_map<const GLTF::Model*, ModelGeometry> Geometry;
+    std::vector<const GLTF::Model*>                       Models;
+
+    Uint32 NumVertices = 0;
+    Uint32 NumIndices  = 0;
+    for (const auto& Inst : m_Instances)
+    {
+        const auto* pModel = Inst.pModel;
+        if (Geometry.find(pModel) != Geometry.end())
+            continue;
+
+        ModelGeometry ModelGeom;
+        if (pModel->pVertexBuffer[0] && pModel->pIndexBuffer)
+        {
+            ModelGeom.BaseVertex = NumVertices;
+            ModelGeom.FirstIndex = NumIndices;
+            NumVertices += pModel->pVertexBuffer[0]->GetDesc().uiSizeInBytes / sizeof(GLTF::Model::VertexAttribs0);
+            NumIndices += pModel->pIndexBuffer->GetDesc().uiSizeInBytes / sizeof(Uint32);
+            Models.push_back(pModel);
+        }
+        else
+        {
+            LOG_WARNING_MESSAGE("GLTF model without indexed geometry can't be rendered as part of a static scene");
+        }
+        Geometry.emplace(pModel, ModelGeom);
+    }
+
+    // Every indexed opaque or alpha-masked primitive of every mesh node is a batch
+    struct BatchSource
+    {
+        const GLTF::Model*     pModel     = nullptr;
+        const GLTF::Node*      pNode      = nullptr;
+        const GLTF::Primitive* pPrimitive = nullptr;
+    };
+    std::vector<BatchSource> Sources;
+    for (const auto* pModel : Models)
+    {
+        for (const auto* node : pModel->LinearNodes)
+        {
+            if (!node->_Mesh)
+                continue;
+
+            for (const auto& primitive : node->_Mesh->Primitives)
+            {
+                if (!primitive->hasIndices || primitive->IndexCount == 0)
+                    continue;
+
+                if (primitive->material.AlphaMode == GLTF::Material::ALPHAMODE_BLEND)
+                {
+                    LOG_WARNING_MESSAGE_ONCE("Alpha-blended primitives are not rendered as part of a static scene");
+                    continue;
+                }
+
+                BatchSource Src;
+                Src.pModel     = pModel;
+                Src.pNode      = node;
+                Src.pPrimitive = primitive.get();
+                Sources.push_back(Src);
+            }
+        }
+    }
+
+    // Batches with the same pipeline state and material are drawn one after another
+    std::stable_sort(Sources.begin(), Sources.end(), [](const BatchSource& Src0, const BatchSource& Src1) {
+        const auto& Mat0 = Src0.pPrimitive->material;
+        const auto& Mat1 = Src1.pPrimitive->material;
+        if (Mat0.DoubleSided != Mat1.DoubleSided)
+            return !Mat0.DoubleSided;
+        return std::less<const GLTF::Material*>{}(&Mat0, &Mat1);
+    });
+
+    std::unordered_map<const GLTF::Model*, std::vector<Uint32>> ModelBatches;
+    m_Batches.resize(Sources.size());
+    for (Uint32 b = 0; b < static_cast<Uint32>(Sources.size()); ++b)
+    {
+        const auto& Src       = Sources[b];
+        const auto& ModelGeom = Geometry[Src.pModel];
+
+        auto& batch      = m_Batches[b];
+        batch.pMaterial  = &Src.pPrimitive->material;
+        batch.IndexCount = Src.pPrimitive->IndexCount;
+        batch.FirstIndex = ModelGeom.FirstIndex + Src.pPrimitive->FirstIndex;
+        batch.BaseVertex = ModelGeom.BaseVertex;
+        ModelBatches[Src.pModel].push_back(b);
+    }
+
+    for (const auto& Inst : m_Instances)
+    {
+        auto it = ModelBatches.find(Inst.pModel);
+        if (it == ModelBatches.end())
+            continue;
+        for (auto b : it->second)
+            ++m_Batches[b].NumInstances;
+    }
+
+    m_NumInstances = 0;
+    for (auto& batch : m_Batches)
+    {
+        batch.FirstInstance = m_NumInstances;
+        m_NumInstances += batch.NumInstances;
+    }
+
+    if (m_NumInstances == 0)
+    {
+        LOG_WARNING_MESSAGE("Static scene has no primitives to render");
+        m_Batches.clear();
+        return;
+    }
+
+    std::vector<GLTFStaticInstanceAttribs> Instances;
+    Instances.reserve(m_NumInstances);
+    for (const auto& Inst : m_Instances)
+    {
+        auto it = ModelBatches.find(Inst.pModel);
+        if (it == ModelBatches.end())
+            continue;
+
+        for (auto b : it->second)
+        {
+            const auto& Src  = Sources[b];
+            const auto& Mesh = *Src.pNode->_Mesh;
+
+            GLTFStaticInstanceAttribs Attribs{};
+            Attribs.Transform          = Mesh.Transforms.matrix * Inst.Transform;
+            Attribs.BatchIndex         = b;
+            Attribs.BatchFirstInstance = m_Batches[b].FirstInstance;
+            if (Src.pPrimitive->IsValidBB || Mesh.IsValidBB)
+            {
+                const auto& BB      = Src.pPrimitive->IsValidBB ? Src.pPrimitive->BB : Mesh.BB;
+                const auto  WorldBB = BB.Transform(Attribs.Transform);
+                Attribs.BBMin       = float4{WorldBB.Min, 0};
+                Attribs.BBMax       = float4{WorldBB.Max, 0};
+            }
+            else
+            {
+                // The instance is never culled
+                Attribs.BBMin = float4{-FLT_MAX, -FLT_MAX, -FLT_MAX, 0};
+                Attribs.BBMax = float4{+FLT_MAX, +FLT_MAX, +FLT_MAX, 0};
+            }
+            Instances.push_back(Attribs);
+        }
+    }
+    // Instances of one batch are culled by consecutive threads
+    std::stable_sort(Instances.begin(), Instances.end(), [](const GLTFStaticInstanceAttribs& Inst0, const GLTFStaticInstanceAttribs& Inst1) {
+        return Inst0.BatchIndex < Inst1.BatchIndex;
+    });
+
+    {
+        BufferDesc VBDesc;
+        VBDesc.Name          = "GLTF static scene vertex buffer";
+        VBDesc.uiSizeInBytes = NumVertices * static_cast<Uint32>(sizeof(GLTF::Model::VertexAttribs0));
+        VBDesc.BindFlags     = BIND_VERTEX_BUFFER;
+        VBDesc.Usage         = USAGE_DEFAULT;
+        m_pDevice->CreateBuffer(VBDesc, nullptr, &m_pVertexBuffer);
+
+        BufferDesc IBDesc;
+        IBDesc.Name          = "GLTF static scene index buffer";
+        IBDesc.uiSizeInBytes = NumIndices * static_cast<Uint32>(sizeof(Uint32));
+        IBDesc.BindFlags     = BIND_INDEX_BUFFER;
+        IBDesc.Usage         = USAGE_DEFAULT;
+        m_pDevice->CreateBuffer(IBDesc, nullptr, &m_pIndexBuffer);
+
+        if (!m_pVertexBuffer || !m_pIndexBuffer)
+            LOG_ERROR_AND_THROW("Failed to create GLTF static scene geometry buffers");
+
+        // Indices are relative to the model's vertices, and the batches provide the base vertex
+        for (const auto* pModel : Models)
+        {
+            const auto& ModelGeom = Geometry[pModel];
+
+            auto* pSrcVB = pModel->pVertexBuffer[0].RawPtr<IBuffer>();
+            pCtx->CopyBuffer(pSrcVB, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                             m_pVertexBuffer, ModelGeom.BaseVertex * static_cast<Uint32>(sizeof(GLTF::Model::VertexAttribs0)),
+                             pSrcVB->GetDesc().uiSizeInBytes, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+            auto* pSrcIB = pModel->pIndexBuffer.RawPtr<IBuffer>();
+            pCtx->CopyBuffer(pSrcIB, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                             m_pIndexBuffer, ModelGeom.FirstIndex * static_cast<Uint32>(sizeof(Uint32)),
+                             pSrcIB->GetDesc().uiSizeInBytes, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
+    }
+
+    RefCntAutoPtr<IBuffer> pInstancesBuffer;
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "GLTF static scene instances buffer";
+        BuffDesc.uiSizeInBytes     = static_cast<Uint32>(sizeof(GLTFStaticInstanceAttribs) * Instances.size());
+        BuffDesc.Usage             = USAGE_IMMUTABLE;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(GLTFStaticInstanceAttribs);
+
+        BufferData InitData{Instances.data(), BuffDesc.uiSizeInBytes};
+        m_pDevice->CreateBuffer(BuffDesc, &InitData, &pInstancesBuffer);
+        if (!pInstancesBuffer)
+            LOG_ERROR_AND_THROW("Failed to create GLTF static scene instances buffer");
+        m_pInstancesBufferSRV = pInstancesBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    }
+
+    m_ResetDrawArgs.resize(m_Batches.size() * DrawArgsStride / sizeof(Uint32));
+    for (size_t b = 0; b < m_Batches.size(); ++b)
+    {
+        const auto& batch = m_Batches[b];
+        auto*       Args  = &m_ResetDrawArgs[b * DrawArgsStride / sizeof(Uint32)];
+
+        Args[0] = batch.IndexCount;
+        Args[1] = 0; // Instance count is incremented by the culling shader
+        Args[2] = batch.FirstIndex;
+        Args[3] = batch.BaseVertex;
+        Args[4] = batch.FirstInstance;
+    }
+
+    BufferViewDesc UAVDesc;
+    UAVDesc.ViewType             = BUFFER_VIEW_UNORDERED_ACCESS;
+    UAVDesc.Format.ValueType     = VT_UINT32;
+    UAVDesc.Format.NumComponents = 1;
+
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "GLTF static scene draw args buffer";
+        BuffDesc.uiSizeInBytes     = static_cast<Uint32>(m_ResetDrawArgs.size() * sizeof(Uint32));
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_INDIRECT_DRAW_ARGS | BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_FORMATTED;
+        BuffDesc.ElementByteStride = sizeof(Uint32);
+
+        BufferData InitData{m_ResetDrawArgs.data(), BuffDesc.uiSizeInBytes};
+        m_pDevice->CreateBuffer(BuffDesc, &InitData, &m_pDrawArgsBuffer);
+        if (!m_pDrawArgsBuffer)
+            LOG_ERROR_AND_THROW("Failed to create GLTF static scene draw args buffer");
+        m_pDrawArgsBuffer->CreateView(UAVDesc, &m_pDrawArgsUAV);
+    }
+
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "GLTF static scene visible instances buffer";
+        BuffDesc.uiSizeInBytes     = m_NumInstances * static_cast<Uint32>(sizeof(Uint32));
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_VERTEX_BUFFER | BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_FORMATTED;
+        BuffDesc.ElementByteStride = sizeof(Uint32);
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pVisibleInstancesBuffer);
+        if (!m_pVisibleInstancesBuffer)
+            LOG_ERROR_AND_THROW("Failed to create GLTF static scene visible instances buffer");
+        m_pVisibleInstancesBuffer->CreateView(UAVDesc, &m_pVisibleInstancesUAV);
+    }
+
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "GLTF static scene occluded instances buffer";
+        BuffDesc.uiSizeInBytes     = m_NumInstances * static_cast<Uint32>(sizeof(Uint32));
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_FORMATTED;
+        BuffDesc.ElementByteStride = sizeof(Uint32);
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pOccludedInstancesBuffer);
+        if (!m_pOccludedInstancesBuffer)
+            LOG_ERROR_AND_THROW("Failed to create GLTF static scene occluded instances buffer");
+        m_pOccludedInstancesBuffer->CreateView(UAVDesc, &m_pOccludedInstancesUAV);
+    }
+
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "GLTF static scene culling stats buffer";
+        BuffDesc.uiSizeInBytes     = NumStatistics * sizeof(Uint32);
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_FORMATTED;
+        BuffDesc.ElementByteStride = sizeof(Uint32);
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pCullingStatsBuffer);
+        if (!m_pCullingStatsBuffer)
+            LOG_ERROR_AND_THROW("Failed to create GLTF static scene culling stats buffer");
+        m_pCullingStatsBuffer->CreateView(UAVDesc, &m_pCullingStatsUAV);
+
+        BuffDesc.Name              = "GLTF static scene culling stats staging buffer";
+        BuffDesc.uiSizeInBytes     = NumStatistics * sizeof(Uint32) * StatisticsHistorySize;
+        BuffDesc.Usage             = USAGE_STAGING;
+        BuffDesc.BindFlags         = BIND_NONE;
+        BuffDesc.Mode              = BUFFER_MODE_UNDEFINED;
+        BuffDesc.ElementByteStride = 0;
+        BuffDesc.CPUAccessFlags    = CPU_ACCESS_READ;
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pCullingStatsStaging);
+        if (!m_pCullingStatsStaging)
+            LOG_ERROR_AND_THROW("Failed to create GLTF static scene culling stats staging buffer");
+
+        FenceDesc FDesc;
+        FDesc.Name = "GLTF static scene culling stats available";
+        m_pDevice->CreateFence(FDesc, &m_pCullingStatsAvailable);
+    }
+    m_Stats.NumInstances = m_NumInstances;
+
+    m_pCullingSRB = CreateCullingSRB(m_pCullingPSO);
+
+    // clang-format off
+    StateTransitionDesc Barriers[] =
+    {
+        {m_pVertexBuffer,            RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER,     true},
+        {m_pIndexBuffer,             RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_INDEX_BUFFER,      true},
+        {pInstancesBuffer,           RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,   true},
+        {m_pDrawArgsBuffer,          RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_INDIRECT_ARGUMENT, true},
+        {m_pVisibleInstancesBuffer,  RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER,     true},
+        {m_pCullingStatsBuffer,      RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_COPY_SOURCE,       true},
+        {m_pOccludedInstancesBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS,  true}
+    };
+    // clang-format on
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+}
+
+void GLTF_StaticScene::Cull(IDeviceContext* pCtx, const float4x4& ViewProj, const HiZPyramid* pHiZ)
+{
+    if (!m_IsBuilt)
+    {
+        LOG_ERROR_MESSAGE("The static scene has not been built. Please call GLTF_StaticScene::Build()");
+        return;
+    }
+    if (m_NumInstances == 0)
+        return;
+
+    // Only the instance counts need to be reset, so the CPU cost depends on the number of batches
+    pCtx->UpdateBuffer(m_pDrawArgsBuffer, 0, static_cast<Uint32>(m_ResetDrawArgs.size() * sizeof(Uint32)), m_ResetDrawArgs.data(),
+                       RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    const Uint32 ZeroStats[NumStatistics] = {};
+    pCtx->UpdateBuffer(m_pCullingStatsBuffer, 0, sizeof(ZeroStats), ZeroStats, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    const bool UseHiZ = pHiZ != nullptr && pHiZ->IsValid();
+    if (UseHiZ && !m_pOcclusionCullingPSO)
+    {
+        m_pOcclusionCullingPSO = CreateCullingPSO(true, false);
+        m_pOcclusionCullingSRB = CreateCullingSRB(m_pOcclusionCullingPSO);
+        m_pOcclusionRetestPSO  = CreateCullingPSO(true, true);
+        m_pOcclusionRetestSRB  = CreateCullingSRB(m_pOcclusionRetestPSO);
+    }
+
+    {
+        ViewFrustum Frustum;
+        ExtractViewFrustumPlanesFromMatrix(ViewProj, Frustum, m_pDevice->GetDeviceCaps().IsGLDevice());
+
+        MapHelper<GLTFStaticCullingAttribs> Attribs(pCtx, m_pCullingAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+        for (Uint32 i = 0; i < ViewFrustum::NUM_PLANES; ++i)
+            Attribs->FrustumPlanes[i] = Frustum.GetPlane(static_cast<ViewFrustum::PLANE_IDX>(i));
+        Attribs->NumInstances = m_NumInstances;
+        if (UseHiZ)
+        {
+            Attribs->PrevViewProj = pHiZ->GetViewProj();
+            Attribs->HiZDepthSize = float4{
+                static_cast<float>(pHiZ->GetDepthWidth()),
+                static_cast<float>(pHiZ->GetDepthHeight()),
+                1.f / static_cast<float>(pHiZ->GetDepthWidth()),
+                1.f / static_cast<float>(pHiZ->GetDepthHeight()) //
+            };
+            Attribs->HiZMipLevels = pHiZ->GetNumMipLevels();
+        }
+    }
+
+    // clang-format off
+    StateTransitionDesc Barriers[] =
+    {
+        {m_pDrawArgsBuffer,         RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, true},
+        {m_pVisibleInstancesBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, true},
+        {m_pCullingStatsBuffer,     RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, true}
+    };
+    // clang-format on
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+    if (UseHiZ)
+    {
+        // The pyramid is bound every frame as the application may rebuild it, e.g. after a resize
+        m_pOcclusionCullingSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_HiZ")->Set(pHiZ->GetSRV());
+
+        pCtx->SetPipelineState(m_pOcclusionCullingPSO);
+        pCtx->CommitShaderResources(m_pOcclusionCullingSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+    }
+    else
+    {
+        pCtx->SetPipelineState(m_pCullingPSO);
+        pCtx->CommitShaderResources(m_pCullingSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+    }
+
+    DispatchComputeAttribs DispatchAttribs((m_NumInstances + ThreadGroupSize - 1) / ThreadGroupSize, 1, 1);
+    pCtx->DispatchCompute(DispatchAttribs);
+
+    Barriers[0].OldState = RESOURCE_STATE_UNORDERED_ACCESS;
+    Barriers[0].NewState = RESOURCE_STATE_INDIRECT_ARGUMENT;
+    Barriers[1].OldState = RESOURCE_STATE_UNORDERED_ACCESS;
+    Barriers[1].NewState = RESOURCE_STATE_VERTEX_BUFFER;
+    Barriers[2].OldState = RESOURCE_STATE_UNORDERED_ACCESS;
+    Barriers[2].NewState = RESOURCE_STATE_COPY_SOURCE;
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+    // With occlusion culling, the statistics are read back after the second pass
+    m_HasOccludedInstances = UseHiZ;
+    m_CullingViewProj      = ViewProj;
+    if (!m_HasOccludedInstances)
+        ReadBackStatistics(pCtx);
+}
+
+void GLTF_StaticScene::CullOccluded(IDeviceContext* pCtx, const HiZPyramid& HiZ)
+{
+    if (!m_HasOccludedInstances)
+        return;
+    m_HasOccludedInstances = false;
+
+    if (HiZ.IsValid())
+    {
+        {
+            ViewFrustum Frustum;
+            ExtractViewFrustumPlanesFromMatrix(m_CullingViewProj, Frustum, m_pDevice->GetDeviceCaps().IsGLDevice());
+
+            MapHelper<GLTFStaticCullingAttribs> Attribs(pCtx, m_pCullingAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+            for (Uint32 i = 0; i < ViewFrustum::NUM_PLANES; ++i)
+                Attribs->FrustumPlanes[i] = Frustum.GetPlane(static_cast<ViewFrustum::PLANE_IDX>(i));
+            Attribs->NumInstances = m_NumInstances;
+            Attribs->PrevViewProj = HiZ.GetViewProj();
+            Attribs->HiZDepthSize = float4{
+                static_cast<float>(HiZ.GetDepthWidth()),
+                static_cast<float>(HiZ.GetDepthHeight()),
+                1.f / static_cast<float>(HiZ.GetDepthWidth()),
+                1.f / static_cast<float>(HiZ.GetDepthHeight()) //
+            };
+            Attribs->HiZMipLevels = HiZ.GetNumMipLevels();
+        }
+
+        // clang-format off
+        StateTransitionDesc Barriers[] =
+        {
+            {m_pDrawArgsBuffer,         RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, true},
+            {m_pVisibleInstancesBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, true},
+            {m_pCullingStatsBuffer,     RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, true}
+        };
+        // clang-format on
+        pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+        m_pOcclusionRetestSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_HiZ")->Set(HiZ.GetSRV());
+        pCtx->SetPipelineState(m_pOcclusionRetestPSO);
+        pCtx->CommitShaderResources(m_pOcclusionRetestSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+        DispatchComputeAttribs DispatchAttribs((m_NumInstances + ThreadGroupSize - 1) / ThreadGroupSize, 1, 1);
+        pCtx->DispatchCompute(DispatchAttribs);
+
+        Barriers[0].OldState = RESOURCE_STATE_UNORDERED_ACCESS;
+        Barriers[0].NewState = RESOURCE_STATE_INDIRECT_ARGUMENT;
+        Barriers[1].OldState = RESOURCE_STATE_UNORDERED_ACCESS;
+        Barriers[1].NewState = RESOURCE_STATE_VERTEX_BUFFER;
+        Barriers[2].OldState = RESOURCE_STATE_UNORDERED_ACCESS;
+        Barriers[2].NewState = RESOURCE_STATE_COPY_SOURCE;
+        pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+    }
+    else
+    {
+        LOG_ERROR_MESSAGE("The Hi-Z pyramid is not valid. Instances culled by the first occlusion culling pass will not be rendered");
+    }
+
+    ReadBackStatistics(pCtx);
+}
+
+void GLTF_StaticScene::ReadBackStatistics(IDeviceContext* pCtx)
+{
+    constexpr Uint32 StatsSize = NumStatistics * sizeof(Uint32);
+
+    pCtx->CopyBuffer(m_pCullingStatsBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY,
+                     m_pCullingStatsStaging, static_cast<Uint32>(m_FrameId % StatisticsHistorySize) * StatsSize, StatsSize,
+                     RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pCtx->SignalFence(m_pCullingStatsAvailable, m_FrameId);
+
+    // Read the statistics of the most recent frame that has completed on the GPU, unless
+    // its slot in the staging buffer has already been reused
+    const auto CompletedFrameId = m_pCullingStatsAvailable->GetCompletedValue();
+    if (CompletedFrameId > 0 && m_FrameId - CompletedFrameId < StatisticsHistorySize)
+    {
+        MapHelper<Uint32> StagingData(pCtx, m_pCullingStatsStaging, MAP_READ, MAP_FLAG_DO_NOT_WAIT);
+        if (StagingData)
+        {
+            const auto* pStats         = &StagingData[static_cast<size_t>(CompletedFrameId % StatisticsHistorySize) * NumStatistics];
+            m_Stats.NumFrustumCulled   = pStats[0];
+            m_Stats.NumOcclusionCulled = pStats[1] - pStats[2];
+        }
+    }
+
+    ++m_FrameId;
+}
+
+} // namespace Diligent
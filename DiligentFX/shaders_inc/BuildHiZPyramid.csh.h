@@ -0,0 +1,46 @@
+"#ifndef HIZ_THREAD_GROUP_SIZE\n"
+"#   define HIZ_THREAD_GROUP_SIZE 8\n"
+"#endif\n"
+"\n"
+"cbuffer cbHiZBuildAttribs\n"
+"{\n"
+"    // xy - size of the source level, zw - size of the destination level\n"
+"    uint4 g_SrcDstSize;\n"
+"}\n"
+"\n"
+"// Depth buffer for the first level, previous level of the pyramid otherwise\n"
+"Texture2D<float> g_SrcDepth;\n"
+"\n"
+"RWTexture2D<float /*format = r32f*/> g_DstHiZ;\n"
+"\n"
+"// Every level is half the size of the previous one, rounded down. Destination texel (x, y)\n"
+"// keeps the maximum (farthest) depth of source texels [2x, 2x + 1] by [2y, 2y + 1].\n"
+"// When the source size is odd, the last destination texel also covers the last source texel,\n"
+"// so the texel that covers source texel s is min(s / 2, DstSize - 1).\n"
+"[numthreads(HIZ_THREAD_GROUP_SIZE, HIZ_THREAD_GROUP_SIZE, 1)]\n"
+"void main(uint3 DTid : SV_DispatchThreadID)\n"
+"{\n"
+"    uint2 SrcSize = g_SrcDstSize.xy;\n"
+"    uint2 DstSize = g_SrcDstSize.zw;\n"
+"    if (DTid.x >= DstSize.x || DTid.y >= DstSize.y)\n"
+"        return;\n"
+"\n"
+"    uint2 SrcFirst = DTid.xy * 2u;\n"
+"    uint2 SrcLast  = SrcFirst + uint2(1u, 1u);\n"
+"    if (DTid.x == DstSize.x - 1u)\n"
+"        SrcLast.x = SrcSize.x - 1u;\n"
+"    if (DTid.y == DstSize.y - 1u)\n"
+"        SrcLast.y = SrcSize.y - 1u;\n"
+"    SrcLast = min(SrcLast, SrcSize - uint2(1u, 1u));\n"
+"\n"
+"    float Depth = 0.0;\n"
+"    for (uint y = SrcFirst.y; y <= SrcLast.y; ++y)\n"
+"    {\n"
+"        for (uint x = SrcFirst.x; x <= SrcLast.x; ++x)\n"
+"        {\n"
+"            Depth = max(Depth, g_SrcDepth.Load(int3(int(x), int(y), 0)));\n"
+"        }\n"
+"    }\n"
+"\n"
+"    g_DstHiZ[DTid.xy] = Depth;\n"
+"}\n"
@@ -0,0 +1,170 @@
+"#include \"GLTF_PBR_Structures.fxh\"\n"
+"\n"
+"#ifndef CULLING_THREAD_GROUP_SIZE\n"
+"#   define CULLING_THREAD_GROUP_SIZE 64\n"
+"#endif\n"
+"\n"
+"#ifndef HIZ_OCCLUSION_CULLING\n"
+"#   define HIZ_OCCLUSION_CULLING 0\n"
+"#endif\n"
+"\n"
+"// Second pass of the occlusion culling, see GLTF_StaticScene::CullOccluded()\n"
+"#ifndef HIZ_OCCLUSION_RETEST\n"
+"#   define HIZ_OCCLUSION_RETEST 0\n"
+"#endif\n"
+"\n"
+"// Number of uints in the indirect draw arguments of one batch:\n"
+"// IndexCount, InstanceCount, FirstIndex, BaseVertex, FirstInstance\n"
+"#define DRAW_ARGS_STRIDE 5u\n"
+"\n"
+"cbuffer cbCullingAttribs\n"
+"{\n"
+"    GLTFStaticCullingAttribs g_CullingAttribs;\n"
+"}\n"
+"\n"
+"StructuredBuffer<GLTFStaticInstanceAttribs> g_Instances;\n"
+"\n"
+"RWBuffer<uint /*format = r32ui*/> g_DrawArgs;\n"
+"RWBuffer<uint /*format = r32ui*/> g_VisibleInstances;\n"
+"\n"
+"// [0] - number of instances culled by the frustum, [1] - number of instances culled by the Hi-Z test\n"
+"// of the first pass, [2] - number of these instances found visible by the second pass\n"
+"RWBuffer<uint /*format = r32ui*/> g_CullingStats;\n"
+"\n"
+"#if HIZ_OCCLUSION_CULLING\n"
+"// Max-depth pyramid: of the previous frame in the first pass, of the instances found visible\n"
+"// by the first pass in the second one. Depth buffer pixel p is covered by\n"
+"// texel min(p / 2^(m+1), MipSize - 1) of mip level m (see BuildHiZPyramid.csh).\n"
+"Texture2D<float> g_HiZ;\n"
+"\n"
+"// 1 for the instances culled by the Hi-Z test of the first pass, 0 for all others\n"
+"RWBuffer<uint /*format = r32ui*/> g_OccludedInstances;\n"
+"#endif\n"
+"\n"
+"bool IsBoxInsideFrustum(float3 BBMin, float3 BBMax)\n"
+"{\n"
+"    for (int i = 0; i < 6; ++i)\n"
+"    {\n"
+"        float4 Plane = g_CullingAttribs.FrustumPlanes[i];\n"
+"        // The corner of the box that is farthest along the plane normal\n"
+"        float3 MaxPoint = float3(Plane.x > 0.0 ? BBMax.x : BBMin.x,\n"
+"                                 Plane.y > 0.0 ? BBMax.y : BBMin.y,\n"
+"                                 Plane.z > 0.0 ? BBMax.z : BBMin.z);\n"
+"        if (dot(MaxPoint, Plane.xyz) + Plane.w < 0.0)\n"
+"            return false;\n"
+"    }\n"
+"    return true;\n"
+"}\n"
+"\n"
+"#if HIZ_OCCLUSION_CULLING\n"
+"// Tests the box against the Hi-Z pyramid. The box is reprojected with the view-projection\n"
+"// matrix the pyramid was built with. Parts of the box that the pyramid has no depth for,\n"
+"// i.e. that were outside of the viewport or behind the camera, are treated as visible.\n"
+"bool IsBoxOccluded(float3 BBMin, float3 BBMax)\n"
+"{\n"
+"    // Screen rectangle of the box in UV space\n"
+"    float2 RectMin  = float2(1.0, 1.0);\n"
+"    float2 RectMax  = float2(0.0, 0.0);\n"
+"    float  MinDepth = 1.0;\n"
+"    for (uint i = 0u; i < 8u; ++i)\n"
+"    {\n"
+"        float3 Corner = float3((i & 1u) != 0u ? BBMax.x : BBMin.x,\n"
+"                               (i & 2u) != 0u ? BBMax.y : BBMin.y,\n"
+"                               (i & 4u) != 0u ? BBMax.z : BBMin.z);\n"
+"        float4 PosPS  = mul(g_CullingAttribs.PrevViewProj, float4(Corner, 1.0));\n"
+"        if (PosPS.w <= 0.0)\n"
+"            return false;\n"
+"\n"
+"        float3 PosNDC = PosPS.xyz / PosPS.w;\n"
+"        if (abs(PosNDC.x) > 1.0 || abs(PosNDC.y) > 1.0)\n"
+"            return false;\n"
+"\n"
+"        // UV y axis may be flipped relative to NDC y axis\n"
+"        float2 UV = NormalizedDeviceXYToTexUV(PosNDC.xy);\n"
+"        RectMin   = min(RectMin, UV);\n"
+"        RectMax   = max(RectMax, UV);\n"
+"        MinDepth  = min(MinDepth, PosNDC.z);\n"
+"    }\n"
+"\n"
+"    // Expand the rectangle by one pixel to account for rasterization rules\n"
+"    float2 DepthSize = g_CullingAttribs.HiZDepthSize.xy;\n"
+"    float2 PixMin    = clamp(RectMin * DepthSize - float2(1.0, 1.0), float2(0.0, 0.0), DepthSize - float2(1.0, 1.0));\n"
+"    float2 PixMax    = clamp(RectMax * DepthSize + float2(1.0, 1.0), float2(0.0, 0.0), DepthSize - float2(1.0, 1.0));\n"
+"\n"
+"    // Select the mip level where the rectangle is not larger than one texel, so that\n"
+"    // it overlaps at most 2x2 texels\n"
+"    float  RectSize  = max(max(PixMax.x - PixMin.x, PixMax.y - PixMin.y), 1.0);\n"
+"    uint   Mip       = uint(max(ceil(log2(RectSize)) - 1.0, 0.0));\n"
+"    Mip              = min(Mip, g_CullingAttribs.HiZMipLevels - 1u);\n"
+"    float  TexelSize = exp2(float(Mip + 1u));\n"
+"\n"
+"    int2 Texel0 = int2(floor(PixMin / TexelSize));\n"
+"    int2 Texel1 = int2(floor(PixMax / TexelSize));\n"
+"    if (Texel1.x - Texel0.x > 1 || Texel1.y - Texel0.y > 1)\n"
+"    {\n"
+"        // The rectangle is larger than the coarsest level of the pyramid\n"
+"        return false;\n"
+"    }\n"
+"\n"
+"    // The last texel of every level also covers the remainder of odd-sized levels\n"
+"    uint MipWidth, MipHeight, NumMips;\n"
+"    g_HiZ.GetDimensions(Mip, MipWidth, MipHeight, NumMips);\n"
+"    int2 MaxTexel = int2(int(MipWidth), int(MipHeight)) - int2(1, 1);\n"
+"    Texel0 = min(Texel0, MaxTexel);\n"
+"    Texel1 = min(Texel1, MaxTexel);\n"
+"\n"
+"    float MaxDepth = max(max(g_HiZ.Load(int3(Texel0.x, Texel0.y, int(Mip))),\n"
+"                             g_HiZ.Load(int3(Texel1.x, Texel0.y, int(Mip)))),\n"
+"                         max(g_HiZ.Load(int3(Texel0.x, Texel1.y, int(Mip))),\n"
+"                             g_HiZ.Load(int3(Texel1.x, Texel1.y, int(Mip)))));\n"
+"\n"
+"    return MinDepth > MaxDepth;\n"
+"}\n"
+"#endif\n"
+"\n"
+"[numthreads(CULLING_THREAD_GROUP_SIZE, 1, 1)]\n"
+"void main(uint3 DTid : SV_DispatchThreadID)\n"
+"{\n"
+"    uint InstanceId = DTid.x;\n"
+"    if (InstanceId >= g_CullingAttribs.NumInstances)\n"
+"        return;\n"
+"\n"
+"    GLTFStaticInstanceAttribs Instance = g_Instances[InstanceId];\n"
+"\n"
+"#if HIZ_OCCLUSION_RETEST\n"
+"    // The pyramid of the previous frame may hide objects that are visible in this frame.\n"
+"    // Instances it has culled are tested again against the pyramid built from the depth of\n"
+"    // the instances found visible by the first pass, and are appended to the draw arguments.\n"
+"    if (g_OccludedInstances[InstanceId] == 0u)\n"
+"        return;\n"
+"\n"
+"    if (IsBoxOccluded(Instance.BBMin.xyz, Instance.BBMax.xyz))\n"
+"        return;\n"
+"\n"
+"    InterlockedAdd(g_CullingStats[2], 1u);\n"
+"#else\n"
+"    if (!IsBoxInsideFrustum(Instance.BBMin.xyz, Instance.BBMax.xyz))\n"
+"    {\n"
+"#   if HIZ_OCCLUSION_CULLING\n"
+"        g_OccludedInstances[InstanceId] = 0u;\n"
+"#   endif\n"
+"        InterlockedAdd(g_CullingStats[0], 1u);\n"
+"        return;\n"
+"    }\n"
+"\n"
+"#   if HIZ_OCCLUSION_CULLING\n"
+"    bool IsOccluded = IsBoxOccluded(Instance.BBMin.xyz, Instance.BBMax.xyz);\n"
+"    g_OccludedInstances[InstanceId] = IsOccluded ? 1u : 0u;\n"
+"    if (IsOccluded)\n"
+"    {\n"
+"        InterlockedAdd(g_CullingStats[1], 1u);\n"
+"        return;\n"
+"    }\n"
+"#   endif\n"
+"#endif\n"
+"\n"
+"    // Instance counts are reset by GLTF_StaticScene::Cull() before the first pass\n"
+"    uint Slot;\n"
+"    InterlockedAdd(g_DrawArgs[Instance.BatchIndex * DRAW_ARGS_STRIDE + 1u], 1u, Slot);\n"
+"    g_VisibleInstances[Instance.BatchFirstInstance + Slot] = InstanceId;\n"
+"}\n"
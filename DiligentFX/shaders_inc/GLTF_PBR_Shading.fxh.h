@@ -65,6 +65,21 @@
 "}\n"
 "\n"
 "\n"
+"// Samples a material texture that may be packed into an atlas (see GLTFMaterialShaderInfo).\n"
+"// The texture is repeated within its region, and the gradients of the original coordinates\n"
+"// are used, so that the mip level does not jump where the coordinates wrap around.\n"
+"float4 GLTF_PBR_SampleTexture(in Texture2D    Tex,\n"
+"                              in SamplerState Tex_sampler,\n"
+"                              in float2       UV,\n"
+"                              in float4       UVScaleBias)\n"
+"{\n"
+"    // Textures that are not packed keep the address mode of their sampler\n"
+"    float2 RegionUV = (UVScaleBias.x < 1.0 || UVScaleBias.y < 1.0) ? frac(UV) : UV;\n"
+"    return Tex.SampleGrad(Tex_sampler, RegionUV * UVScaleBias.xy + UVScaleBias.zw,\n"
+"                          ddx(UV) * UVScaleBias.xy, ddy(UV) * UVScaleBias.xy);\n"
+"}\n"
+"\n"
+"\n"
 "float3 GLTF_PBR_ApplyDirectionalLight(float3 lightDir, float3 lightColor, SurfaceReflectanceInfo srfInfo, float3 normal, float3 view)\n"
 "{\n"
 "    float3 pointToLight = -lightDir;\n"
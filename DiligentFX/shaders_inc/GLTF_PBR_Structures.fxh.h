@@ -22,10 +22,9 @@
 "struct GLTFNodeShaderTransforms\n"
 "{\n"
 "	float4x4 NodeMatrix;\n"
-"	float4x4 JointMatrix[MAX_NUM_JOINTS];\n"
 "\n"
 "	int      JointCount;\n"
-"    float    Dummy0;\n"
+"    int      FirstJoint;\n"
 "    float    Dummy1;\n"
 "    float    Dummy2;\n"
 "};\n"
@@ -33,6 +32,26 @@
 "	CHECK_STRUCT_ALIGNMENT(GLTFNodeShaderTransforms);\n"
 "#endif\n"
 "\n"
+"// Joint matrices of the skin, only used when the joints buffer is not available\n"
+"struct GLTFJointMatrices\n"
+"{\n"
+"	float4x4 JointMatrix[MAX_NUM_JOINTS];\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFJointMatrices);\n"
+"#endif\n"
+"\n"
+"struct GLTFSkinningAttribs\n"
+"{\n"
+"    uint FirstVertex;\n"
+"    uint NumVertices;\n"
+"    uint FirstJoint;\n"
+"    uint Padding0;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFSkinningAttribs);\n"
+"#endif\n"
+"\n"
 "\n"
 "struct GLTFRendererShaderParameters\n"
 "{\n"
@@ -56,6 +75,14 @@
 "	float4  EmissiveFactor;\n"
 "	float4  SpecularFactor;\n"
 "\n"
+"    // Scale (xy) and bias (zw) of the texture coordinates of the textures packed into an atlas.\n"
+"    // Textures that are not packed use (1, 1, 0, 0).\n"
+"    float4  BaseColorUVScaleBias;\n"
+"    float4  PhysicalDescriptorUVScaleBias;\n"
+"    float4  NormalUVScaleBias;\n"
+"    float4  OcclusionUVScaleBias;\n"
+"    float4  EmissiveUVScaleBias;\n"
+"\n"
 "	int     Workflow;\n"
 "	float   BaseColorTextureUVSelector;\n"
 "	float   PhysicalDescriptorTextureUVSelector;\n"
@@ -68,11 +95,89 @@
 "\n"
 "	int     UseAlphaMask;	\n"
 "	float   AlphaMaskCutoff;\n"
-"    float   Dummy0;\n"
+"    // Normal map stores X and Y only (e.g. BC5), Z is reconstructed\n"
+"    int     NormalMapXY;\n"
 "    float   Dummy1;\n"
 "};\n"
 "#ifdef CHECK_STRUCT_ALIGNMENT\n"
 "	CHECK_STRUCT_ALIGNMENT(GLTFMaterialShaderInfo);\n"
 "#endif\n"
 "\n"
+"// Indices of the material textures in the bindless texture array\n"
+"struct GLTFMaterialTextureIndices\n"
+"{\n"
+"    int BaseColor;\n"
+"    int PhysicalDescriptor;\n"
+"    int Normal;\n"
+"    int Occlusion;\n"
+"\n"
+"    int Emissive;\n"
+"    int Dummy0;\n"
+"    int Dummy1;\n"
+"    int Dummy2;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFMaterialTextureIndices);\n"
+"#endif\n"
+"\n"
+"struct GLTFBindlessMaterialInfo\n"
+"{\n"
+"    GLTFMaterialShaderInfo     Material;\n"
+"    GLTFMaterialTextureIndices TextureIndices;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFBindlessMaterialInfo);\n"
+"#endif\n"
+"\n"
+"struct GLTFBindlessDrawAttribs\n"
+"{\n"
+"    int MaterialIndex;\n"
+"    int Dummy0;\n"
+"    int Dummy1;\n"
+"    int Dummy2;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFBindlessDrawAttribs);\n"
+"#endif\n"
+"\n"
+"// Instance of a static scene primitive (see GLTF_StaticScene)\n"
+"struct GLTFStaticInstanceAttribs\n"
+"{\n"
+"    float4x4 Transform;\n"
+"\n"
+"    // World-space bounding box of the instance\n"
+"    float4   BBMin;\n"
+"    float4   BBMax;\n"
+"\n"
+"    // Index of the batch whose indirect draw arguments the instance is counted in\n"
+"    uint     BatchIndex;\n"
+"    // First element of the batch\'s range in the visible instances buffer\n"
+"    uint     BatchFirstInstance;\n"
+"    uint     Padding0;\n"
+"    uint     Padding1;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFStaticInstanceAttribs);\n"
+"#endif\n"
+"\n"
+"struct GLTFStaticCullingAttribs\n"
+"{\n"
+"    // Frustum planes in world space: a point P is inside the plane if dot(Plane.xyz, P) + Plane.w >= 0\n"
+"    float4 FrustumPlanes[6];\n"
+"\n"
+"    // View-projection matrix of the frame the Hi-Z pyramid was built from.\n"
+"    // The matrix is not transposed and is used as mul(PrevViewProj, Pos).\n"
+"    float4x4 PrevViewProj;\n"
+"    // Size of the depth buffer the Hi-Z pyramid was built from: (width, height, 1/width, 1/height)\n"
+"    float4   HiZDepthSize;\n"
+"\n"
+"    uint   NumInstances;\n"
+"    uint   HiZMipLevels;\n"
+"    uint   Padding0;\n"
+"    uint   Padding1;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFStaticCullingAttribs);\n"
+"#endif\n"
+"\n"
 "#endif // _GLTF_PBR_STRUCTURES_FXH_\n"
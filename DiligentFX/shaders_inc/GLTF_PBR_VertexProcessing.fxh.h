@@ -22,20 +22,26 @@
 "    return adjugate / det;\n"
 "}\n"
 "\n"
+"float3 GLTF_TransformPosition(in float3   Pos,\n"
+"                              in float4x4 Transform)\n"
+"{\n"
+"	float4 locPos = mul(Transform, float4(Pos, 1.0));\n"
+"	return locPos.xyz / locPos.w;\n"
+"}\n"
+"\n"
 "GLTF_TransformedVertex GLTF_TransformVertex(in float3    Pos,\n"
 "                                            in float3    Normal,\n"
 "                                            in float4x4  Transform)\n"
 "{\n"
 "    GLTF_TransformedVertex TransformedVert;\n"
 "    \n"
-"	float4 locPos = mul(Transform, float4(Pos, 1.0));\n"
 "    float3x3 NormalTransform = float3x3(Transform[0].xyz, Transform[1].xyz, Transform[2].xyz);\n"
 "    NormalTransform = InverseTranspose3x3(NormalTransform);\n"
 "    Normal = mul(NormalTransform, Normal);\n"
 "    float NormalLen = length(Normal);\n"
 "    TransformedVert.Normal = Normal / max(NormalLen, 1e-5);\n"
 "\n"
-"	TransformedVert.WorldPos = locPos.xyz / locPos.w;\n"
+"	TransformedVert.WorldPos = GLTF_TransformPosition(Pos, Transform);\n"
 "\n"
 "    return TransformedVert;\n"
 "}\n"
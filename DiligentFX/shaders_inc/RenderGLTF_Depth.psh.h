@@ -0,0 +1,24 @@
+"#include \"GLTF_PBR_Shading.fxh\"\n"
+"\n"
+"// Pixel shader of the depth-only passes for alpha-masked materials.\n"
+"// Opaque materials are rendered without a pixel shader.\n"
+"\n"
+"cbuffer cbMaterialAttribs\n"
+"{\n"
+"    GLTFMaterialShaderInfo g_MaterialInfo;\n"
+"}\n"
+"\n"
+"Texture2D    g_ColorMap;\n"
+"SamplerState g_ColorMap_sampler;\n"
+"\n"
+"void main(in float4 ClipPos : SV_Position,\n"
+"          in float2 UV0     : UV0,\n"
+"          in float2 UV1     : UV1)\n"
+"{\n"
+"    float Alpha = GLTF_PBR_SampleTexture(g_ColorMap, g_ColorMap_sampler, lerp(UV0, UV1, g_MaterialInfo.BaseColorTextureUVSelector), g_MaterialInfo.BaseColorUVScaleBias).a;\n"
+"    Alpha *= g_MaterialInfo.BaseColorFactor.a;\n"
+"    if (Alpha < g_MaterialInfo.AlphaMaskCutoff)\n"
+"    {\n"
+"        discard;\n"
+"    }\n"
+"}\n"
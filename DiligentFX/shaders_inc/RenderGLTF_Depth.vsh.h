@@ -0,0 +1,60 @@
+"#include \"GLTF_PBR_VertexProcessing.fxh\"\n"
+"\n"
+"// Vertex shader of the depth-only passes. It reads the same vertex buffers as RenderGLTF_PBR.vsh,\n"
+"// but skips normal transformation.\n"
+"\n"
+"struct GLTF_VS_Input\n"
+"{\n"
+"    float3 Pos     : ATTRIB0;\n"
+"    float2 UV0     : ATTRIB2;\n"
+"    float2 UV1     : ATTRIB3;\n"
+"    float4 Joint0  : ATTRIB4;\n"
+"    float4 Weight0 : ATTRIB5;\n"
+"};\n"
+"\n"
+"cbuffer cbDepthPassAttribs\n"
+"{\n"
+"    float4x4 g_DepthViewProj;\n"
+"}\n"
+"\n"
+"cbuffer cbTransforms\n"
+"{\n"
+"    GLTFNodeShaderTransforms g_Transforms;\n"
+"}\n"
+"\n"
+"#if GLTF_PBR_USE_JOINTS_BUFFER\n"
+"    StructuredBuffer<float4x4> g_JointMatrices;\n"
+"#   define GLTF_JOINT_MATRIX(Idx) g_JointMatrices[g_Transforms.FirstJoint + int(Idx)]\n"
+"#else\n"
+"    cbuffer cbJointMatrices\n"
+"    {\n"
+"        GLTFJointMatrices g_Joints;\n"
+"    }\n"
+"#   define GLTF_JOINT_MATRIX(Idx) g_Joints.JointMatrix[int(Idx)]\n"
+"#endif\n"
+"\n"
+"void main(in  GLTF_VS_Input  VSIn,\n"
+"          out float4 ClipPos  : SV_Position,\n"
+"          out float2 UV0      : UV0,\n"
+"          out float2 UV1      : UV1) \n"
+"{\n"
+"    // The position must be computed exactly as in RenderGLTF_PBR.vsh, so that\n"
+"    // the depth written by the pre-pass matches the depth of the color pass.\n"
+"    float4x4 Transform = g_Transforms.NodeMatrix;\n"
+"    if (g_Transforms.JointCount > 0)\n"
+"    {\n"
+"        // Mesh is skinned\n"
+"        float4x4 SkinMat = \n"
+"            VSIn.Weight0.x * GLTF_JOINT_MATRIX(VSIn.Joint0.x) +\n"
+"            VSIn.Weight0.y * GLTF_JOINT_MATRIX(VSIn.Joint0.y) +\n"
+"            VSIn.Weight0.z * GLTF_JOINT_MATRIX(VSIn.Joint0.z) +\n"
+"            VSIn.Weight0.w * GLTF_JOINT_MATRIX(VSIn.Joint0.w);\n"
+"        Transform = mul(Transform, SkinMat);\n"
+"    }\n"
+"\n"
+"    float3 WorldPos = GLTF_TransformPosition(VSIn.Pos, Transform);\n"
+"\n"
+"    ClipPos = mul(float4(WorldPos, 1.0), g_DepthViewProj);\n"
+"    UV0     = VSIn.UV0;\n"
+"    UV1     = VSIn.UV1;\n"
+"}\n"
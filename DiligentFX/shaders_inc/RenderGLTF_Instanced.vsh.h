@@ -0,0 +1,40 @@
+"#include \"BasicStructures.fxh\"\n"
+"#include \"GLTF_PBR_VertexProcessing.fxh\"\n"
+"\n"
+"// Vertex shader of the static scene (see GLTF_StaticScene). Every instance reads its transform\n"
+"// from the instances buffer by the index that the culling shader has written to the visible\n"
+"// instances buffer, which is bound as a per-instance vertex buffer.\n"
+"\n"
+"struct GLTF_VS_Input\n"
+"{\n"
+"    float3 Pos        : ATTRIB0;\n"
+"    float3 Normal     : ATTRIB1;\n"
+"    float2 UV0        : ATTRIB2;\n"
+"    float2 UV1        : ATTRIB3;\n"
+"    uint   InstanceId : ATTRIB4;\n"
+"};\n"
+"\n"
+"cbuffer cbCameraAttribs\n"
+"{\n"
+"    CameraAttribs g_CameraAttribs;\n"
+"}\n"
+"\n"
+"StructuredBuffer<GLTFStaticInstanceAttribs> g_Instances;\n"
+"\n"
+"void main(in  GLTF_VS_Input  VSIn,\n"
+"          out float4 ClipPos  : SV_Position,\n"
+"          out float3 WorldPos : WORLD_POS,\n"
+"          out float3 Normal   : NORMAL,\n"
+"          out float2 UV0      : UV0,\n"
+"          out float2 UV1      : UV1) \n"
+"{\n"
+"    float4x4 Transform = g_Instances[VSIn.InstanceId].Transform;\n"
+"\n"
+"    GLTF_TransformedVertex TransformedVert = GLTF_TransformVertex(VSIn.Pos, VSIn.Normal, Transform);\n"
+"\n"
+"    ClipPos  = mul(float4(TransformedVert.WorldPos, 1.0), g_CameraAttribs.mViewProj);\n"
+"    WorldPos = TransformedVert.WorldPos;\n"
+"    Normal   = TransformedVert.Normal;\n"
+"    UV0      = VSIn.UV0;\n"
+"    UV1      = VSIn.UV1;\n"
+"}\n"
@@ -0,0 +1,29 @@
+"#include \"GLTF_PBR_VertexProcessing.fxh\"\n"
+"\n"
+"// Vertex shader of the depth pre-pass of the static scene (see GLTF_StaticScene). It reads the\n"
+"// same buffers as RenderGLTF_Instanced.vsh, but only transforms the position.\n"
+"\n"
+"struct GLTF_VS_Input\n"
+"{\n"
+"    float3 Pos        : ATTRIB0;\n"
+"    uint   InstanceId : ATTRIB4;\n"
+"};\n"
+"\n"
+"cbuffer cbDepthPassAttribs\n"
+"{\n"
+"    float4x4 g_DepthViewProj;\n"
+"}\n"
+"\n"
+"StructuredBuffer<GLTFStaticInstanceAttribs> g_Instances;\n"
+"\n"
+"void main(in  GLTF_VS_Input  VSIn,\n"
+"          out float4 ClipPos : SV_Position) \n"
+"{\n"
+"    // The position must be computed exactly as in RenderGLTF_Instanced.vsh, so that\n"
+"    // the depth written by the pre-pass matches the depth of the color pass.\n"
+"    float4x4 Transform = g_Instances[VSIn.InstanceId].Transform;\n"
+"\n"
+"    float3 WorldPos = GLTF_TransformPosition(VSIn.Pos, Transform);\n"
+"\n"
+"    ClipPos = mul(float4(WorldPos, 1.0), g_DepthViewProj);\n"
+"}\n"
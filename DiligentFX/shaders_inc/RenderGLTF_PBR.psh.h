@@ -10,6 +10,18 @@
 "#   define ALLOW_DEBUG_VIEW 0\n"
 "#endif\n"
 "\n"
+"#ifndef GLTF_PBR_BINDLESS\n"
+"#   define GLTF_PBR_BINDLESS 0\n"
+"#endif\n"
+"\n"
+"#ifndef GLTF_PBR_USE_SHADOWS\n"
+"#   define GLTF_PBR_USE_SHADOWS 0\n"
+"#endif\n"
+"\n"
+"#if GLTF_PBR_USE_SHADOWS\n"
+"#   include \"Shadows.fxh\"\n"
+"#endif\n"
+"\n"
 "cbuffer cbCameraAttribs\n"
 "{\n"
 "    CameraAttribs g_CameraAttribs;\n"
@@ -23,9 +35,25 @@
 "cbuffer cbGLTFAttribs\n"
 "{\n"
 "    GLTFRendererShaderParameters g_RenderParameters;\n"
-"    GLTFMaterialShaderInfo       g_MaterialInfo;\n"
 "}\n"
 "\n"
+"#if GLTF_PBR_BINDLESS\n"
+"// All materials of the model are in one buffer, and all textures are in one array\n"
+"cbuffer cbBindlessDrawAttribs\n"
+"{\n"
+"    GLTFBindlessDrawAttribs g_DrawAttribs;\n"
+"}\n"
+"\n"
+"StructuredBuffer<GLTFBindlessMaterialInfo> g_Materials;\n"
+"#   define g_MaterialInfo     g_Materials[g_DrawAttribs.MaterialIndex].Material\n"
+"#   define g_MaterialTextures g_Materials[g_DrawAttribs.MaterialIndex].TextureIndices\n"
+"#else\n"
+"cbuffer cbMaterialAttribs\n"
+"{\n"
+"    GLTFMaterialShaderInfo g_MaterialInfo;\n"
+"}\n"
+"#endif\n"
+"\n"
 "#if GLTF_PBR_USE_IBL\n"
 "TextureCube  g_IrradianceMap;\n"
 "SamplerState g_IrradianceMap_sampler;\n"
@@ -37,6 +65,10 @@
 "SamplerState  g_BRDF_LUT_sampler;\n"
 "#endif\n"
 "\n"
+"#if GLTF_PBR_BINDLESS\n"
+"Texture2D    g_Textures[GLTF_PBR_MAX_BINDLESS_TEXTURES];\n"
+"SamplerState g_Textures_sampler;\n"
+"#else\n"
 "Texture2D    g_ColorMap;\n"
 "SamplerState g_ColorMap_sampler;\n"
 "\n"
@@ -55,6 +87,12 @@
 "Texture2D    g_EmissiveMap;\n"
 "SamplerState g_EmissiveMap_sampler;\n"
 "#endif\n"
+"#endif\n"
+"\n"
+"#if GLTF_PBR_USE_SHADOWS\n"
+"Texture2DArray<float>  g_tex2DShadowMap;\n"
+"SamplerComparisonState g_tex2DShadowMap_sampler;\n"
+"#endif\n"
 "\n"
 "\n"
 "void main(in  float4 ClipPos     : SV_Position,\n"
@@ -68,7 +106,11 @@
 "{\n"
 "    DepthZ = DepthToNormalizedDeviceZ(ClipPos.z);\n"
 "\n"
-"    float4 BaseColor = g_ColorMap.Sample(g_ColorMap_sampler, lerp(UV0, UV1, g_MaterialInfo.BaseColorTextureUVSelector));\n"
+"#if GLTF_PBR_BINDLESS\n"
+"    float4 BaseColor = GLTF_PBR_SampleTexture(g_Textures[g_MaterialTextures.BaseColor], g_Textures_sampler, lerp(UV0, UV1, g_MaterialInfo.BaseColorTextureUVSelector), g_MaterialInfo.BaseColorUVScaleBias);\n"
+"#else\n"
+"    float4 BaseColor = GLTF_PBR_SampleTexture(g_ColorMap, g_ColorMap_sampler, lerp(UV0, UV1, g_MaterialInfo.BaseColorTextureUVSelector), g_MaterialInfo.BaseColorUVScaleBias);\n"
+"#endif\n"
 "    BaseColor = SRGBtoLINEAR(BaseColor) * g_MaterialInfo.BaseColorFactor;\n"
 "    //BaseColor *= getVertexColor();\n"
 "\n"
@@ -80,24 +122,51 @@
 "    float2 dNormalMapUV_dx = ddx(NormalMapUV);\n"
 "    float2 dNormalMapUV_dy = ddy(NormalMapUV);\n"
 "\n"
+"#if GLTF_PBR_USE_SHADOWS\n"
+"    // Light view space is an affine transform of the world space, so the gradients are transformed the same way\n"
+"    float3 PosInLightViewSpace     = mul(float4(WorldPos, 1.0), g_LightAttribs.ShadowAttribs.mWorldToLightView).xyz;\n"
+"    float3 dPosInLightViewSpace_dx = mul(float4(dWorldPos_dx, 0.0), g_LightAttribs.ShadowAttribs.mWorldToLightView).xyz;\n"
+"    float3 dPosInLightViewSpace_dy = mul(float4(dWorldPos_dy, 0.0), g_LightAttribs.ShadowAttribs.mWorldToLightView).xyz;\n"
+"#endif\n"
+"\n"
 "    if (g_MaterialInfo.UseAlphaMask != 0 && BaseColor.a < g_MaterialInfo.AlphaMaskCutoff)\n"
 "    {\n"
 "        discard;\n"
 "    }\n"
 "\n"
-"    float3 TSNormal = g_NormalMap.Sample(g_NormalMap_sampler, NormalMapUV).rgb * float3(2.0, 2.0, 2.0) - float3(1.0, 1.0, 1.0);\n"
+"#if GLTF_PBR_BINDLESS\n"
+"    float3 TSNormal = GLTF_PBR_SampleTexture(g_Textures[g_MaterialTextures.Normal], g_Textures_sampler, NormalMapUV, g_MaterialInfo.NormalUVScaleBias).rgb * float3(2.0, 2.0, 2.0) - float3(1.0, 1.0, 1.0);\n"
+"#else\n"
+"    float3 TSNormal = GLTF_PBR_SampleTexture(g_NormalMap, g_NormalMap_sampler, NormalMapUV, g_MaterialInfo.NormalUVScaleBias).rgb * float3(2.0, 2.0, 2.0) - float3(1.0, 1.0, 1.0);\n"
+"#endif\n"
+"    if (g_MaterialInfo.NormalMapXY != 0)\n"
+"    {\n"
+"        TSNormal.z = sqrt(saturate(1.0 - dot(TSNormal.xy, TSNormal.xy)));\n"
+"    }\n"
 "\n"
 "    float Occlusion = 1.0;\n"
 "#if GLTF_PBR_USE_AO\n"
-"    Occlusion = g_AOMap.Sample(g_AOMap_sampler, lerp(UV0, UV1, g_MaterialInfo.OcclusionTextureUVSelector)).r;\n"
+"#   if GLTF_PBR_BINDLESS\n"
+"    Occlusion = GLTF_PBR_SampleTexture(g_Textures[g_MaterialTextures.Occlusion], g_Textures_sampler, lerp(UV0, UV1, g_MaterialInfo.OcclusionTextureUVSelector), g_MaterialInfo.OcclusionUVScaleBias).r;\n"
+"#   else\n"
+"    Occlusion = GLTF_PBR_SampleTexture(g_AOMap, g_AOMap_sampler, lerp(UV0, UV1, g_MaterialInfo.OcclusionTextureUVSelector), g_MaterialInfo.OcclusionUVScaleBias).r;\n"
+"#   endif\n"
 "#endif\n"
 "\n"
 "    float3 Emissive = float3(0.0, 0.0, 0.0);\n"
 "#if GLTF_PBR_USE_EMISSIVE\n"
-"    Emissive = g_EmissiveMap.Sample(g_EmissiveMap_sampler, lerp(UV0, UV1, g_MaterialInfo.EmissiveTextureUVSelector)).rgb;\n"
+"#   if GLTF_PBR_BINDLESS\n"
+"    Emissive = GLTF_PBR_SampleTexture(g_Textures[g_MaterialTextures.Emissive], g_Textures_sampler, lerp(UV0, UV1, g_MaterialInfo.EmissiveTextureUVSelector), g_MaterialInfo.EmissiveUVScaleBias).rgb;\n"
+"#   else\n"
+"    Emissive = GLTF_PBR_SampleTexture(g_EmissiveMap, g_EmissiveMap_sampler, lerp(UV0, UV1, g_MaterialInfo.EmissiveTextureUVSelector), g_MaterialInfo.EmissiveUVScaleBias).rgb;\n"
+"#   endif\n"
 "#endif\n"
 "\n"
-"    float4 PhysicalDesc = g_PhysicalDescriptorMap.Sample(g_PhysicalDescriptorMap_sampler, lerp(UV0, UV1, g_MaterialInfo.PhysicalDescriptorTextureUVSelector));\n"
+"#if GLTF_PBR_BINDLESS\n"
+"    float4 PhysicalDesc = GLTF_PBR_SampleTexture(g_Textures[g_MaterialTextures.PhysicalDescriptor], g_Textures_sampler, lerp(UV0, UV1, g_MaterialInfo.PhysicalDescriptorTextureUVSelector), g_MaterialInfo.PhysicalDescriptorUVScaleBias);\n"
+"#else\n"
+"    float4 PhysicalDesc = GLTF_PBR_SampleTexture(g_PhysicalDescriptorMap, g_PhysicalDescriptorMap_sampler, lerp(UV0, UV1, g_MaterialInfo.PhysicalDescriptorTextureUVSelector), g_MaterialInfo.PhysicalDescriptorUVScaleBias);\n"
+"#endif\n"
 "    \n"
 "    float metallic;\n"
 "    if (g_MaterialInfo.Workflow == PBR_WORKFLOW_SPECULAR_GLOSINESS)\n"
@@ -118,8 +187,18 @@
 "                                                    Normal, TSNormal, g_MaterialInfo.NormalTextureUVSelector >= 0.0, IsFrontFace);\n"
 "    float3 view = normalize(g_CameraAttribs.f4Position.xyz - WorldPos.xyz); // Direction from surface point to camera\n"
 "\n"
+"    float3 LightIntensity = g_LightAttribs.f4Intensity.rgb;\n"
+"#if GLTF_PBR_USE_SHADOWS\n"
+"    {\n"
+"        float CameraViewSpaceZ = mul(float4(WorldPos, 1.0), g_CameraAttribs.mView).z;\n"
+"        FilteredShadow Shadow  = FilterShadowMap(g_LightAttribs.ShadowAttribs, g_tex2DShadowMap, g_tex2DShadowMap_sampler,\n"
+"                                                 PosInLightViewSpace, dPosInLightViewSpace_dx, dPosInLightViewSpace_dy, CameraViewSpaceZ);\n"
+"        LightIntensity *= Shadow.fLightAmount;\n"
+"    }\n"
+"#endif\n"
+"\n"
 "    float3 color = float3(0.0, 0.0, 0.0);\n"
-"    color += GLTF_PBR_ApplyDirectionalLight(g_LightAttribs.f4Direction.xyz, g_LightAttribs.f4Intensity.rgb, SrfInfo, perturbedNormal, view);\n"
+"    color += GLTF_PBR_ApplyDirectionalLight(g_LightAttribs.f4Direction.xyz, LightIntensity, SrfInfo, perturbedNormal, view);\n"
 "    \n"
 "//#ifdef USE_PUNCTUAL\n"
 "//    for (int i = 0; i < LIGHT_COUNT; ++i)\n"
@@ -20,6 +20,17 @@
 "{\n"
 "    GLTFNodeShaderTransforms g_Transforms;\n"
 "}\n"
+"\n"
+"#if GLTF_PBR_USE_JOINTS_BUFFER\n"
+"    StructuredBuffer<float4x4> g_JointMatrices;\n"
+"#   define GLTF_JOINT_MATRIX(Idx) g_JointMatrices[g_Transforms.FirstJoint + int(Idx)]\n"
+"#else\n"
+"    cbuffer cbJointMatrices\n"
+"    {\n"
+"        GLTFJointMatrices g_Joints;\n"
+"    }\n"
+"#   define GLTF_JOINT_MATRIX(Idx) g_Joints.JointMatrix[int(Idx)]\n"
+"#endif\n"
 "    \n"
 "void main(in  GLTF_VS_Input  VSIn,\n"
 "          out float4 ClipPos  : SV_Position,\n"
@@ -36,10 +47,10 @@
 "    {\n"
 "        // Mesh is skinned\n"
 "        float4x4 SkinMat = \n"
-"            VSIn.Weight0.x * g_Transforms.JointMatrix[int(VSIn.Joint0.x)] +\n"
-"            VSIn.Weight0.y * g_Transforms.JointMatrix[int(VSIn.Joint0.y)] +\n"
-"            VSIn.Weight0.z * g_Transforms.JointMatrix[int(VSIn.Joint0.z)] +\n"
-"            VSIn.Weight0.w * g_Transforms.JointMatrix[int(VSIn.Joint0.w)];\n"
+"            VSIn.Weight0.x * GLTF_JOINT_MATRIX(VSIn.Joint0.x) +\n"
+"            VSIn.Weight0.y * GLTF_JOINT_MATRIX(VSIn.Joint0.y) +\n"
+"            VSIn.Weight0.z * GLTF_JOINT_MATRIX(VSIn.Joint0.z) +\n"
+"            VSIn.Weight0.w * GLTF_JOINT_MATRIX(VSIn.Joint0.w);\n"
 "        Transform = mul(Transform, SkinMat);\n"
 "    }\n"
 "\n"
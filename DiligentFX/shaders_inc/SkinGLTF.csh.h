@@ -0,0 +1,61 @@
+"#include \"GLTF_PBR_Structures.fxh\"\n"
+"#include \"GLTF_PBR_VertexProcessing.fxh\"\n"
+"\n"
+"#ifndef SKINNING_THREAD_GROUP_SIZE\n"
+"#   define SKINNING_THREAD_GROUP_SIZE 64\n"
+"#endif\n"
+"\n"
+"// Number of floats in GLTF::Model::VertexAttribs0: float3 Pos, float3 Normal, float2 UV0, float2 UV1\n"
+"#define VERTEX_ATTRIBS0_STRIDE 10u\n"
+"\n"
+"cbuffer cbSkinningAttribs\n"
+"{\n"
+"    GLTFSkinningAttribs g_SkinningAttribs;\n"
+"}\n"
+"\n"
+"Buffer<float>              g_VertexAttribs0;\n"
+"Buffer<float4>             g_VertexAttribs1;\n"
+"StructuredBuffer<float4x4> g_JointMatrices;\n"
+"\n"
+"RWBuffer<float /*format = r32f*/> g_SkinnedVertexAttribs0;\n"
+"\n"
+"float3 LoadFloat3(uint Offset)\n"
+"{\n"
+"    return float3(g_VertexAttribs0.Load(int(Offset)),\n"
+"                  g_VertexAttribs0.Load(int(Offset + 1u)),\n"
+"                  g_VertexAttribs0.Load(int(Offset + 2u)));\n"
+"}\n"
+"\n"
+"void StoreFloat3(uint Offset, float3 Value)\n"
+"{\n"
+"    g_SkinnedVertexAttribs0[Offset]      = Value.x;\n"
+"    g_SkinnedVertexAttribs0[Offset + 1u] = Value.y;\n"
+"    g_SkinnedVertexAttribs0[Offset + 2u] = Value.z;\n"
+"}\n"
+"\n"
+"[numthreads(SKINNING_THREAD_GROUP_SIZE, 1, 1)]\n"
+"void main(uint3 DTid : SV_DispatchThreadID)\n"
+"{\n"
+"    if (DTid.x >= g_SkinningAttribs.NumVertices)\n"
+"        return;\n"
+"\n"
+"    uint Vertex = g_SkinningAttribs.FirstVertex + DTid.x;\n"
+"\n"
+"    float4 Joint0  = g_VertexAttribs1.Load(int(Vertex * 2u));\n"
+"    float4 Weight0 = g_VertexAttribs1.Load(int(Vertex * 2u + 1u));\n"
+"\n"
+"    uint FirstJoint = g_SkinningAttribs.FirstJoint;\n"
+"    float4x4 SkinMat = \n"
+"        Weight0.x * g_JointMatrices[FirstJoint + uint(Joint0.x)] +\n"
+"        Weight0.y * g_JointMatrices[FirstJoint + uint(Joint0.y)] +\n"
+"        Weight0.z * g_JointMatrices[FirstJoint + uint(Joint0.z)] +\n"
+"        Weight0.w * g_JointMatrices[FirstJoint + uint(Joint0.w)];\n"
+"\n"
+"    uint Offset = Vertex * VERTEX_ATTRIBS0_STRIDE;\n"
+"\n"
+"    // Only positions and normals are skinned. Texture coordinates in the\n"
+"    // destination buffer are never overwritten.\n"
+"    GLTF_TransformedVertex SkinnedVert = GLTF_TransformVertex(LoadFloat3(Offset), LoadFloat3(Offset + 3u), SkinMat);\n"
+"    StoreFloat3(Offset,      SkinnedVert.WorldPos);\n"
+"    StoreFloat3(Offset + 3u, SkinnedVert.Normal);\n"
+"}\n"
@@ -30,6 +30,10 @@ static const ShaderIncInfo g_Shaders[] =
         "Shadows.fxh",
         #include "Shadows.fxh.h"
     },
+    {
+        "BuildHiZPyramid.csh",
+        #include "BuildHiZPyramid.csh.h"
+    },
     {
         "ComputeIrradianceMap.psh",
         #include "ComputeIrradianceMap.psh.h"
@@ -58,6 +62,30 @@ static const ShaderIncInfo g_Shaders[] =
         "RenderGLTF_PBR.vsh",
         #include "RenderGLTF_PBR.vsh.h"
     },
+    {
+        "RenderGLTF_Depth.psh",
+        #include "RenderGLTF_Depth.psh.h"
+    },
+    {
+        "RenderGLTF_Depth.vsh",
+        #include "RenderGLTF_Depth.vsh.h"
+    },
+    {
+        "RenderGLTF_Instanced.vsh",
+        #include "RenderGLTF_Instanced.vsh.h"
+    },
+    {
+        "RenderGLTF_InstancedDepth.vsh",
+        #include "RenderGLTF_InstancedDepth.vsh.h"
+    },
+    {
+        "CullGLTFInstances.csh",
+        #include "CullGLTFInstances.csh.h"
+    },
+    {
+        "SkinGLTF.csh",
+        #include "SkinGLTF.csh.h"
+    },
     {
         "GLTF_PBR_Shading.fxh",
         #include "GLTF_PBR_Shading.fxh.h"
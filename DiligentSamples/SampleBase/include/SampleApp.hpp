@@ -39,6 +39,7 @@
 #include "SwapChain.h"
 #include "SampleBase.hpp"
 #include "ScreenCapture.hpp"
+#include "ScreenCaptureWriter.hpp"
 #include "Image.h"
 
 namespace Diligent
@@ -99,6 +100,8 @@ protected:
     void CompareGoldenImage(const std::string& FileName, ScreenCapture::CaptureInfo& Capture);
     void SaveScreenCapture(const std::string& FileName, ScreenCapture::CaptureInfo& Capture);
 
+    ScreenCaptureWriter::FrameFormat GetScreenCaptureFormat() const;
+
     RENDER_DEVICE_TYPE                         m_DeviceType = RENDER_DEVICE_TYPE_UNDEFINED;
     RefCntAutoPtr<IEngineFactory>              m_pEngineFactory;
     RefCntAutoPtr<IRenderDevice>               m_pDevice;
@@ -138,18 +141,29 @@ protected:
         double            LastCaptureTime = -1e+10;
         Uint32            FramesToCapture = 0;
         Uint32            CurrentFrame    = 0;
-        IMAGE_FILE_FORMAT FileFormat      = IMAGE_FILE_FORMAT_PNG;
+        CaptureFileFormat FileFormat      = CaptureFileFormat::Png;
         int               JpegQuality     = 95;
         bool              KeepAlpha       = false;
 
+        // Capture writer thread count and the maximum number of frames in flight
+        Uint32 NumThreads       = 0;
+        Uint32 MaxPendingFrames = 8;
+
+        // Frames that were captured later than requested because the writer was full
+        Uint32 NumDelayedFrames = 0;
+
     } m_ScreenCaptureInfo;
-    std::unique_ptr<ScreenCapture> m_pScreenCapture;
+    std::unique_ptr<ScreenCapture>       m_pScreenCapture;
+    std::unique_ptr<ScreenCaptureWriter> m_pScreenCaptureWriter;
 
     std::unique_ptr<ImGuiImplDiligent> m_pImGui;
 
     GoldenImageMode m_GoldenImgMode           = GoldenImageMode::None;
     int             m_GoldenImgPixelTolerance = 0;
     int             m_ExitCode                = 0;
+
+    // If not empty, diff images of failed golden image comparisons are saved to this directory
+    std::string m_GoldenImgDiffDirectory;
 };
 
 } // namespace Diligent
@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+
+#include "ScreenCapture.hpp"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// File format of the screen captures written by ScreenCaptureWriter
+enum class CaptureFileFormat
+{
+    Png,
+    Jpeg,
+
+    /// Tightly packed RGB8 (or RGBA8 if alpha is kept) pixels without a header. Raw frames are
+    /// meant to be encoded offline, e.g.:
+    ///     cat frame*.raw | ffmpeg -f rawvideo -pixel_format rgb24 -video_size 1280x1024 -i - out.mp4
+    Raw,
+
+    /// Raw pixels compressed with deflate in gzip format
+    RawGzip
+};
+
+/// Writes screen captures to files on a pool of worker threads.
+
+/// The render thread maps the staging texture of a completed capture and hands it over to a
+/// worker that converts the pixels, encodes them and writes the file. The texture stays mapped
+/// until the worker is done, after which Update() unmaps it and returns it to the screen capture.
+/// The number of frames in flight is limited by CreateInfo::MaxPendingFrames.
+///
+/// All methods except the constructor must be called by the render thread.
+class ScreenCaptureWriter
+{
+public:
+    struct FrameFormat
+    {
+        CaptureFileFormat FileFormat  = CaptureFileFormat::Png;
+        int               JpegQuality = 95;
+        bool              KeepAlpha   = false;
+
+        /// Deflate compression level (1-9) of CaptureFileFormat::RawGzip
+        int CompressionLevel = 1;
+    };
+
+    struct CreateInfo
+    {
+        FrameFormat Format;
+
+        /// Number of worker threads. If 0, the number of hardware threads minus one is used.
+        Uint32 NumThreads = 0;
+
+        /// Maximum number of frames that are being written at the same time.
+        Uint32 MaxPendingFrames = 8;
+    };
+
+    /// \param [in] Capture - Screen capture that produces the frames. The staging textures
+    ///                       of the written frames are recycled to this object.
+    /// \param [in] CI      - Writer create info.
+    ScreenCaptureWriter(ScreenCapture& Capture, const CreateInfo& CI);
+
+    /// The writer must be flushed before it is destroyed.
+    ~ScreenCaptureWriter();
+
+    // clang-format off
+    ScreenCaptureWriter           (const ScreenCaptureWriter&)  = delete;
+    ScreenCaptureWriter           (      ScreenCaptureWriter&&) = delete;
+    ScreenCaptureWriter& operator=(const ScreenCaptureWriter&)  = delete;
+    ScreenCaptureWriter& operator=(      ScreenCaptureWriter&&) = delete;
+    // clang-format on
+
+    /// Maps the staging texture of the capture and starts writing it to the file.
+    /// The writer must not be full, see IsFull().
+    void Write(IDeviceContext* pContext, ScreenCapture::CaptureInfo&& Capture, std::string FileName);
+
+    /// Unmaps the staging textures of the frames that have been written and recycles them.
+    void Update(IDeviceContext* pContext);
+
+    /// Waits until all frames are written and recycles their staging textures.
+    void Flush(IDeviceContext* pContext);
+
+    bool IsFull() const
+    {
+        return m_Frames.size() >= m_CI.MaxPendingFrames;
+    }
+
+    size_t GetNumPendingFrames() const
+    {
+        return m_Frames.size();
+    }
+
+    /// Returns the error code of the last failed write (-5 if the file could not be written,
+    /// -6 if it could not be created), or 0 if all frames have been written successfully.
+    int GetErrorCode() const
+    {
+        return m_ErrorCode.load();
+    }
+
+    /// Converts, encodes and writes the mapped texture data to the file.
+
+    /// \param [in] FileName - File name.
+    /// \param [in] TexDesc  - Description of the captured texture.
+    /// \param [in] TexData  - Mapped data of the most detailed mip level.
+    /// \param [in] Format   - Frame format.
+    ///
+    /// \return 0 on success, or the error code, see GetErrorCode().
+    static int WriteToFile(const std::string&              FileName,
+                           const TextureDesc&              TexDesc,
+                           const MappedTextureSubresource& TexData,
+                           const FrameFormat&              Format);
+
+    /// Returns the file extension of the format, including the dot.
+    static const char* GetFileExtension(CaptureFileFormat FileFormat);
+
+private:
+    struct PendingFrame;
+
+    const CreateInfo m_CI;
+
+    ScreenCapture& m_Capture;
+
+    // Frames that are being written, accessed by the render thread only
+    std::deque<std::unique_ptr<PendingFrame>> m_Frames;
+
+    std::mutex              m_WrittenFramesMtx;
+    std::condition_variable m_FrameWrittenCV;
+
+    std::atomic<int> m_ErrorCode{0};
+
+    bool m_RawFormatReported = false;
+
+    std::unique_ptr<ThreadPool> m_pWorkers;
+};
+
+} // namespace Diligent
@@ -36,7 +36,7 @@
 #include "StringTools.hpp"
 #include "MapHelper.hpp"
 #include "Image.h"
-#include "FileWrapper.hpp"
+#include "ImageComparator.hpp"
 
 #if D3D11_SUPPORTED
 #    include "EngineFactoryD3D11.h"
@@ -76,6 +76,17 @@ SampleApp::~SampleApp()
     m_pImGui.reset();
     m_TheSample.reset();
 
+    if (m_pScreenCaptureWriter)
+    {
+        m_pScreenCaptureWriter->Flush(m_pImmediateContext);
+        m_pScreenCaptureWriter.reset();
+    }
+    if (m_ScreenCaptureInfo.NumDelayedFrames > 0)
+    {
+        LOG_WARNING_MESSAGE(m_ScreenCaptureInfo.NumDelayedFrames, " screen capture(s) were delayed because the capture writer could not keep up. "
+                                                                  "Consider increasing the number of capture threads or using the raw capture format.");
+    }
+
     if (m_pImmediateContext)
         m_pImmediateContext->Flush();
     m_pDeferredContexts.clear();
@@ -403,9 +414,25 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
         {
             // Capture only one frame
             m_ScreenCaptureInfo.FramesToCapture = 1;
+
+            if (m_ScreenCaptureInfo.FileFormat != CaptureFileFormat::Png && m_ScreenCaptureInfo.FileFormat != CaptureFileFormat::Jpeg)
+            {
+                LOG_WARNING_MESSAGE("Golden images can only be stored in png or jpeg format. Using png.");
+                m_ScreenCaptureInfo.FileFormat = CaptureFileFormat::Png;
+            }
         }
 
         m_pScreenCapture.reset(new ScreenCapture(m_pDevice));
+
+        if (m_GoldenImgMode == GoldenImageMode::None)
+        {
+            // Frames are written by worker threads to not stall the render loop
+            ScreenCaptureWriter::CreateInfo WriterCI;
+            WriterCI.Format           = GetScreenCaptureFormat();
+            WriterCI.NumThreads       = m_ScreenCaptureInfo.NumThreads;
+            WriterCI.MaxPendingFrames = std::max(m_ScreenCaptureInfo.MaxPendingFrames, 1u);
+            m_pScreenCaptureWriter.reset(new ScreenCaptureWriter{*m_pScreenCapture, WriterCI});
+        }
     }
 }
 
@@ -661,15 +688,23 @@ void SampleApp::ProcessCommandLine(const char* CmdLine)
         {
             if (StrCmpNoCase(Arg.c_str(), "jpeg", Arg.length()) == 0 || StrCmpNoCase(Arg.c_str(), "jpg", Arg.length()) == 0)
             {
-                m_ScreenCaptureInfo.FileFormat = IMAGE_FILE_FORMAT_JPEG;
+                m_ScreenCaptureInfo.FileFormat = CaptureFileFormat::Jpeg;
             }
             else if (StrCmpNoCase(Arg.c_str(), "png", Arg.length()) == 0)
             {
-                m_ScreenCaptureInfo.FileFormat = IMAGE_FILE_FORMAT_PNG;
+                m_ScreenCaptureInfo.FileFormat = CaptureFileFormat::Png;
+            }
+            else if (StrCmpNoCase(Arg.c_str(), "raw", Arg.length()) == 0)
+            {
+                m_ScreenCaptureInfo.FileFormat = CaptureFileFormat::Raw;
+            }
+            else if (StrCmpNoCase(Arg.c_str(), "raw_gz", Arg.length()) == 0)
+            {
+                m_ScreenCaptureInfo.FileFormat = CaptureFileFormat::RawGzip;
             }
             else
             {
-                LOG_ERROR_MESSAGE("Unknown capture format. The following are allowed values: 'jpeg', 'jpg', 'png'");
+                LOG_ERROR_MESSAGE("Unknown capture format. The following are allowed values: 'jpeg', 'jpg', 'png', 'raw', 'raw_gz'");
             }
         }
         else if (!(Arg = GetArgument(pos, "capture_quality")).empty())
@@ -680,6 +715,14 @@ void SampleApp::ProcessCommandLine(const char* CmdLine)
         {
             m_ScreenCaptureInfo.KeepAlpha = (StrCmpNoCase(Arg.c_str(), "true", Arg.length()) == 0) || Arg == "1";
         }
+        else if (!(Arg = GetArgument(pos, "capture_threads")).empty())
+        {
+            m_ScreenCaptureInfo.NumThreads = atoi(Arg.c_str());
+        }
+        else if (!(Arg = GetArgument(pos, "capture_max_pending")).empty())
+        {
+            m_ScreenCaptureInfo.MaxPendingFrames = atoi(Arg.c_str());
+        }
         else if (!(Arg = GetArgument(pos, "width")).empty())
         {
             m_InitialWindowWidth = atoi(Arg.c_str());
@@ -740,6 +783,10 @@ void SampleApp::ProcessCommandLine(const char* CmdLine)
         {
             m_GoldenImgPixelTolerance = atoi(Arg.c_str());
         }
+        else if (!(Arg = GetArgument(pos, "golden_image_diff_path")).empty())
+        {
+            m_GoldenImgDiffDirectory = std::move(Arg);
+        }
         else if (!(Arg = GetArgument(pos, "vsync")).empty())
         {
             m_bVSync = (StrCmpNoCase(Arg.c_str(), "true", Arg.length()) == 0) || (StrCmpNoCase(Arg.c_str(), "on", Arg.length()) == 0) || Arg == "1";
@@ -845,6 +892,33 @@ void SampleApp::Render()
     }
 }
 
+static void SaveRGBImage(const std::string& FileName, Uint32 Width, Uint32 Height, const Uint8* pPixels)
+{
+    TextureDesc Desc;
+    Desc.Width  = Width;
+    Desc.Height = Height;
+    Desc.Format = TEX_FORMAT_RGBA8_UNORM;
+
+    // Image::Encode expects four-component pixels
+    std::vector<Uint8> RGBAPixels(size_t{Width} * size_t{Height} * 4);
+    for (size_t i = 0; i < size_t{Width} * size_t{Height}; ++i)
+    {
+        RGBAPixels[i * 4 + 0] = pPixels[i * 3 + 0];
+        RGBAPixels[i * 4 + 1] = pPixels[i * 3 + 1];
+        RGBAPixels[i * 4 + 2] = pPixels[i * 3 + 2];
+        RGBAPixels[i * 4 + 3] = 255;
+    }
+
+    MappedTextureSubresource Data;
+    Data.pData  = RGBAPixels.data();
+    Data.Stride = Width * 4;
+
+    ScreenCaptureWriter::FrameFormat Format;
+    Format.FileFormat = CaptureFileFormat::Png;
+    if (ScreenCaptureWriter::WriteToFile(FileName, Desc, Data, Format) != 0)
+        LOG_ERROR_MESSAGE("Failed to save golden image diff '", FileName, "'");
+}
+
 void SampleApp::CompareGoldenImage(const std::string& FileName, ScreenCapture::CaptureInfo& Capture)
 {
     RefCntAutoPtr<Image> pGoldenImg;
@@ -871,27 +945,66 @@ void SampleApp::CompareGoldenImage(const std::string& FileName, ScreenCapture::C
         return;
     }
 
+    if (GoldenImgDesc.NumComponents < 3)
+    {
+        LOG_ERROR_MESSAGE("Golden image must have at least three components");
+        m_ExitCode = -2;
+        return;
+    }
+
+    // Convert the capture to the layout of the golden image so that the comparison can use the fast path
+    const bool GoldenImgHasAlpha = GoldenImgDesc.NumComponents == 4;
+
     MappedTextureSubresource TexData;
     m_pImmediateContext->MapTextureSubresource(Capture.pTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, TexData);
     auto CapturedPixels = Image::ConvertImageData(TexDesc.Width, TexDesc.Height,
                                                   reinterpret_cast<const Uint8*>(TexData.pData), TexData.Stride,
-                                                  TexDesc.Format, TEX_FORMAT_RGBA8_UNORM, false /*Keep alpha*/);
+                                                  TexDesc.Format, TEX_FORMAT_RGBA8_UNORM, GoldenImgHasAlpha);
     m_pImmediateContext->UnmapTextureSubresource(Capture.pTexture, 0, 0);
 
-    auto* pGoldenImgPixels = reinterpret_cast<const Uint8*>(pGoldenImg->GetData()->GetDataPtr());
+    const Uint32 NumComponents = GoldenImgHasAlpha ? 4 : 3;
+
+    ImageCompareInfo CompareInfo;
+    CompareInfo.Width                 = TexDesc.Width;
+    CompareInfo.Height                = TexDesc.Height;
+    CompareInfo.NumComponents         = NumComponents;
+    CompareInfo.NumComparedComponents = 3;
+    CompareInfo.pImage                = CapturedPixels.data();
+    CompareInfo.Stride                = TexDesc.Width * NumComponents;
+    CompareInfo.pReference            = pGoldenImg->GetData()->GetConstDataPtr();
+    CompareInfo.ReferenceStride       = GoldenImgDesc.RowStride;
+    CompareInfo.Tolerance             = static_cast<Uint32>(std::max(m_GoldenImgPixelTolerance, 0));
+    CompareInfo.CreateDiffImage       = !m_GoldenImgDiffDirectory.empty();
+
+    ImageComparison Result;
+    CompareImages(CompareInfo, Result);
+
+    // The exit code is the number of different pixels
+    m_ExitCode = static_cast<int>(Result.NumDiffPixels);
+    if (Result.NumDiffPixels == 0)
+        return;
+
+    LOG_ERROR_MESSAGE("Golden image comparison failed: ", Result.NumDiffPixels, " pixels in ", Result.NumDiffTiles, " of ",
+                      Result.NumTilesX * Result.NumTilesY, " tiles differ. Max error: ", Result.MaxError, ", PSNR: ", Result.PSNR, " dB");
 
-    m_ExitCode = 0;
-    for (Uint32 row = 0; row < TexDesc.Height; ++row)
+    if (!m_GoldenImgDiffDirectory.empty())
     {
-        for (Uint32 col = 0; col < TexDesc.Width; ++col)
-        {
-            const auto* SrcPixel = &CapturedPixels[(col + row * TexDesc.Width) * 3];
-            const auto* DstPixel = pGoldenImgPixels + row * GoldenImgDesc.RowStride + col * GoldenImgDesc.NumComponents;
-            if (std::abs(int{SrcPixel[0]} - int{DstPixel[0]}) > m_GoldenImgPixelTolerance ||
-                std::abs(int{SrcPixel[1]} - int{DstPixel[1]}) > m_GoldenImgPixelTolerance ||
-                std::abs(int{SrcPixel[2]} - int{DstPixel[2]}) > m_GoldenImgPixelTolerance)
-                ++m_ExitCode;
-        }
+        auto BaseName = FileName;
+        // Strip the directory and the extension of the golden image
+        const auto SeparatorPos = BaseName.find_last_of("/\\");
+        if (SeparatorPos != std::string::npos)
+            BaseName.erase(0, SeparatorPos + 1);
+        const auto DotPos = BaseName.rfind('.');
+        if (DotPos != std::string::npos)
+            BaseName.erase(DotPos);
+
+        auto DiffFileBase = m_GoldenImgDiffDirectory;
+        if (DiffFileBase.back() != '/')
+            DiffFileBase.push_back('/');
+        DiffFileBase += BaseName;
+
+        SaveRGBImage(DiffFileBase + "_diff.png", TexDesc.Width, TexDesc.Height, Result.DiffImage.data());
+        SaveRGBImage(DiffFileBase + "_heatmap.png", TexDesc.Width, TexDesc.Height, Result.CreateTileHeatmap().data());
     }
 }
 
@@ -899,38 +1012,21 @@ void SampleApp::SaveScreenCapture(const std::string& FileName, ScreenCapture::Ca
 {
     MappedTextureSubresource TexData;
     m_pImmediateContext->MapTextureSubresource(Capture.pTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, TexData);
-    const auto& TexDesc = Capture.pTexture->GetDesc();
-
-    Image::EncodeInfo Info;
-    Info.Width       = TexDesc.Width;
-    Info.Height      = TexDesc.Height;
-    Info.TexFormat   = TexDesc.Format;
-    Info.KeepAlpha   = m_ScreenCaptureInfo.KeepAlpha;
-    Info.pData       = TexData.pData;
-    Info.Stride      = TexData.Stride;
-    Info.FileFormat  = m_ScreenCaptureInfo.FileFormat;
-    Info.JpegQuality = m_ScreenCaptureInfo.JpegQuality;
-
-    RefCntAutoPtr<IDataBlob> pEncodedImage;
-    Image::Encode(Info, &pEncodedImage);
+
+    auto ErrorCode = ScreenCaptureWriter::WriteToFile(FileName, Capture.pTexture->GetDesc(), TexData, GetScreenCaptureFormat());
+    if (ErrorCode != 0)
+        m_ExitCode = ErrorCode;
+
     m_pImmediateContext->UnmapTextureSubresource(Capture.pTexture, 0, 0);
+}
 
-    FileWrapper pFile(FileName.c_str(), EFileAccessMode::Overwrite);
-    if (pFile)
-    {
-        auto res = pFile->Write(pEncodedImage->GetDataPtr(), pEncodedImage->GetSize());
-        if (!res)
-        {
-            LOG_ERROR_MESSAGE("Failed to write screen capture file '", FileName, "'.");
-            m_ExitCode = -5;
-        }
-        pFile.Close();
-    }
-    else
-    {
-        LOG_ERROR_MESSAGE("Failed to create screen capture file '", FileName, "'. Verify that the directory exists and the app has sufficient rights to write to this directory.");
-        m_ExitCode = -6;
-    }
+ScreenCaptureWriter::FrameFormat SampleApp::GetScreenCaptureFormat() const
+{
+    ScreenCaptureWriter::FrameFormat Format;
+    Format.FileFormat  = m_ScreenCaptureInfo.FileFormat;
+    Format.JpegQuality = m_ScreenCaptureInfo.JpegQuality;
+    Format.KeepAlpha   = m_ScreenCaptureInfo.KeepAlpha;
+    return Format;
 }
 
 void SampleApp::Present()
@@ -940,7 +1036,18 @@ void SampleApp::Present()
 
     if (m_pScreenCapture && m_ScreenCaptureInfo.FramesToCapture > 0)
     {
-        if (m_CurrentTime - m_ScreenCaptureInfo.LastCaptureTime >= 1.0 / m_ScreenCaptureInfo.CaptureFPS)
+        bool CaptureFrame = m_CurrentTime - m_ScreenCaptureInfo.LastCaptureTime >= 1.0 / m_ScreenCaptureInfo.CaptureFPS;
+
+        // Completed captures wait for the writer in the staging textures. If the writer can't keep up,
+        // the capture is delayed rather than stalling the render loop or piling up staging textures.
+        if (CaptureFrame && m_pScreenCaptureWriter && m_pScreenCaptureWriter->IsFull() &&
+            m_pScreenCapture->GetNumPendingCaptures() >= m_ScreenCaptureInfo.MaxPendingFrames)
+        {
+            ++m_ScreenCaptureInfo.NumDelayedFrames;
+            CaptureFrame = false;
+        }
+
+        if (CaptureFrame)
         {
             m_pImmediateContext->SetRenderTargets(0, nullptr, nullptr, RESOURCE_STATE_TRANSITION_MODE_NONE);
             m_pScreenCapture->Capture(m_pSwapChain, m_pImmediateContext, m_ScreenCaptureInfo.CurrentFrame);
@@ -968,8 +1075,19 @@ void SampleApp::Present()
 
     if (m_pScreenCapture)
     {
-        while (auto Capture = m_pScreenCapture->GetCapture())
+        if (m_pScreenCaptureWriter)
         {
+            m_pScreenCaptureWriter->Update(m_pImmediateContext);
+            if (auto ErrorCode = m_pScreenCaptureWriter->GetErrorCode())
+                m_ExitCode = ErrorCode;
+        }
+
+        while (!(m_pScreenCaptureWriter && m_pScreenCaptureWriter->IsFull()))
+        {
+            auto Capture = m_pScreenCapture->GetCapture();
+            if (!Capture)
+                break;
+
             std::string FileName;
             {
                 std::stringstream FileNameSS;
@@ -984,10 +1102,16 @@ void SampleApp::Present()
                 {
                     FileNameSS << std::setw(3) << std::setfill('0') << Capture.Id;
                 }
-                FileNameSS << (m_ScreenCaptureInfo.FileFormat == IMAGE_FILE_FORMAT_JPEG ? ".jpg" : ".png");
+                FileNameSS << ScreenCaptureWriter::GetFileExtension(m_ScreenCaptureInfo.FileFormat);
                 FileName = FileNameSS.str();
             }
 
+            if (m_pScreenCaptureWriter)
+            {
+                m_pScreenCaptureWriter->Write(m_pImmediateContext, std::move(Capture), std::move(FileName));
+                continue;
+            }
+
             if (m_GoldenImgMode == GoldenImageMode::Compare || m_GoldenImgMode == GoldenImageMode::CompareUpdate)
             {
                 CompareGoldenImage(FileName, Capture);
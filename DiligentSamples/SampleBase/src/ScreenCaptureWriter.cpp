@@ -0,0 +1,246 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+
+#include "ScreenCaptureWriter.hpp"
+#include "ThreadPool.hpp"
+#include "Image.h"
+#include "FileWrapper.hpp"
+#include "Errors.hpp"
+#include "DebugUtilities.hpp"
+
+#include "zlib.h"
+
+namespace Diligent
+{
+
+struct ScreenCaptureWriter::PendingFrame
+{
+    ScreenCapture::CaptureInfo Capture;
+    std::string                FileName;
+    MappedTextureSubresource   TexData;
+
+    // Protected by m_WrittenFramesMtx
+    bool IsWritten = false;
+};
+
+ScreenCaptureWriter::ScreenCaptureWriter(ScreenCapture& Capture, const CreateInfo& CI) :
+    m_CI{CI},
+    m_Capture{Capture},
+    m_pWorkers{new ThreadPool{CI.NumThreads}}
+{
+    VERIFY(m_CI.MaxPendingFrames > 0, "The maximum number of pending frames must not be zero");
+}
+
+ScreenCaptureWriter::~ScreenCaptureWriter()
+{
+    VERIFY(m_Frames.empty(), "The writer must be flushed before it is destroyed as the staging textures are still mapped");
+    m_pWorkers.reset();
+}
+
+void ScreenCaptureWriter::Write(IDeviceContext* pContext, ScreenCapture::CaptureInfo&& Capture, std::string FileName)
+{
+    VERIFY(!IsFull(), "The writer is full");
+
+    std::unique_ptr<PendingFrame> pFrame{new PendingFrame};
+    pFrame->Capture  = std::move(Capture);
+    pFrame->FileName = std::move(FileName);
+
+    // The device context is not thread-safe, so the texture is mapped by the render thread.
+    // The capture is complete, so the map does not stall.
+    auto* pTexture = pFrame->Capture.pTexture.RawPtr();
+    pContext->MapTextureSubresource(pTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, pFrame->TexData);
+    if (pFrame->TexData.pData == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Failed to map the staging texture of screen capture '", pFrame->FileName, "'.");
+        m_ErrorCode.store(-5);
+        m_Capture.RecycleStagingTexture(std::move(pFrame->Capture.pTexture));
+        return;
+    }
+
+    const auto& TexDesc = pTexture->GetDesc();
+    if (!m_RawFormatReported && (m_CI.Format.FileFormat == CaptureFileFormat::Raw || m_CI.Format.FileFormat == CaptureFileFormat::RawGzip))
+    {
+        LOG_INFO_MESSAGE("Raw screen captures are ", TexDesc.Width, "x", TexDesc.Height, ' ', (m_CI.Format.KeepAlpha ? "rgba" : "rgb24"), " frames");
+        m_RawFormatReported = true;
+    }
+
+    auto* pRawFrame = pFrame.get();
+    m_Frames.emplace_back(std::move(pFrame));
+
+    m_pWorkers->Enqueue(
+        [this, pRawFrame]() //
+        {
+            auto ErrorCode = WriteToFile(pRawFrame->FileName, pRawFrame->Capture.pTexture->GetDesc(), pRawFrame->TexData, m_CI.Format);
+            if (ErrorCode != 0)
+                m_ErrorCode.store(ErrorCode);
+
+            {
+                std::lock_guard<std::mutex> Lock{m_WrittenFramesMtx};
+                pRawFrame->IsWritten = true;
+            }
+            m_FrameWrittenCV.notify_all();
+        });
+}
+
+void ScreenCaptureWriter::Update(IDeviceContext* pContext)
+{
+    std::lock_guard<std::mutex> Lock{m_WrittenFramesMtx};
+    for (auto it = m_Frames.begin(); it != m_Frames.end();)
+    {
+        auto& Frame = **it;
+        if (Frame.IsWritten)
+        {
+            pContext->UnmapTextureSubresource(Frame.Capture.pTexture, 0, 0);
+            m_Capture.RecycleStagingTexture(std::move(Frame.Capture.pTexture));
+            it = m_Frames.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void ScreenCaptureWriter::Flush(IDeviceContext* pContext)
+{
+    {
+        std::unique_lock<std::mutex> Lock{m_WrittenFramesMtx};
+        for (const auto& pFrame : m_Frames)
+        {
+            m_FrameWrittenCV.wait(Lock, [&pFrame]() { return pFrame->IsWritten; });
+        }
+    }
+    Update(pContext);
+}
+
+static bool CompressGzip(const std::vector<Uint8>& Data, int Level, std::vector<Uint8>& CompressedData)
+{
+    z_stream Stream = {};
+    // 16 added to the window bits selects the gzip wrapper
+    if (deflateInit2(&Stream, Level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    CompressedData.resize(deflateBound(&Stream, static_cast<uLong>(Data.size())));
+
+    Stream.next_in   = const_cast<Bytef*>(Data.data());
+    Stream.avail_in  = static_cast<uInt>(Data.size());
+    Stream.next_out  = CompressedData.data();
+    Stream.avail_out = static_cast<uInt>(CompressedData.size());
+
+    auto Res = deflate(&Stream, Z_FINISH);
+    CompressedData.resize(Stream.total_out);
+    deflateEnd(&Stream);
+
+    return Res == Z_STREAM_END;
+}
+
+int ScreenCaptureWriter::WriteToFile(const std::string&              FileName,
+                                     const TextureDesc&              TexDesc,
+                                     const MappedTextureSubresource& TexData,
+                                     const FrameFormat&              Format)
+{
+    RefCntAutoPtr<IDataBlob> pEncodedImage;
+    std::vector<Uint8>       RawData;
+    std::vector<Uint8>       CompressedData;
+
+    const void* pFileData    = nullptr;
+    size_t      FileDataSize = 0;
+    if (Format.FileFormat == CaptureFileFormat::Png || Format.FileFormat == CaptureFileFormat::Jpeg)
+    {
+        Image::EncodeInfo Info;
+        Info.Width       = TexDesc.Width;
+        Info.Height      = TexDesc.Height;
+        Info.TexFormat   = TexDesc.Format;
+        Info.KeepAlpha   = Format.KeepAlpha;
+        Info.pData       = TexData.pData;
+        Info.Stride      = TexData.Stride;
+        Info.FileFormat  = Format.FileFormat == CaptureFileFormat::Jpeg ? IMAGE_FILE_FORMAT_JPEG : IMAGE_FILE_FORMAT_PNG;
+        Info.JpegQuality = Format.JpegQuality;
+        Image::Encode(Info, &pEncodedImage);
+
+        pFileData    = pEncodedImage->GetConstDataPtr();
+        FileDataSize = pEncodedImage->GetSize();
+    }
+    else
+    {
+        RawData = Image::ConvertImageData(TexDesc.Width, TexDesc.Height, static_cast<const Uint8*>(TexData.pData), TexData.Stride,
+                                          TexDesc.Format, TEX_FORMAT_RGBA8_UNORM, Format.KeepAlpha);
+        if (Format.FileFormat == CaptureFileFormat::RawGzip)
+        {
+            if (!CompressGzip(RawData, Format.CompressionLevel, CompressedData))
+            {
+                LOG_ERROR_MESSAGE("Failed to compress screen capture '", FileName, "'.");
+                return -5;
+            }
+            pFileData    = CompressedData.data();
+            FileDataSize = CompressedData.size();
+        }
+        else
+        {
+            pFileData    = RawData.data();
+            FileDataSize = RawData.size();
+        }
+    }
+
+    FileWrapper pFile(FileName.c_str(), EFileAccessMode::Overwrite);
+    if (!pFile)
+    {
+        LOG_ERROR_MESSAGE("Failed to create screen capture file '", FileName, "'. Verify that the directory exists and the app has sufficient rights to write to this directory.");
+        return -6;
+    }
+
+    auto res = pFile->Write(pFileData, FileDataSize);
+    pFile.Close();
+    if (!res)
+    {
+        LOG_ERROR_MESSAGE("Failed to write screen capture file '", FileName, "'.");
+        return -5;
+    }
+
+    return 0;
+}
+
+const char* ScreenCaptureWriter::GetFileExtension(CaptureFileFormat FileFormat)
+{
+    switch (FileFormat)
+    {
+        // clang-format off
+        case CaptureFileFormat::Png:     return ".png";
+        case CaptureFileFormat::Jpeg:    return ".jpg";
+        case CaptureFileFormat::Raw:     return ".raw";
+        case CaptureFileFormat::RawGzip: return ".raw.gz";
+        // clang-format on
+        default:
+            UNEXPECTED("Unexpected capture file format");
+            return "";
+    }
+}
+
+} // namespace Diligent
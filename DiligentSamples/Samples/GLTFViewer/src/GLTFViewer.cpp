@@ -80,6 +80,7 @@ void GLTFViewer::LoadModel(const char* Path)
 {
     if (m_Model)
     {
+        m_ModelInstance.reset();
         m_GLTFRenderer->ReleaseResourceBindings(*m_Model);
         m_PlayAnimation  = false;
         m_AnimationIndex = 0;
@@ -87,6 +88,7 @@ void GLTFViewer::LoadModel(const char* Path)
     }
 
     m_Model.reset(new GLTF::Model(m_pDevice, m_pImmediateContext, Path));
+    m_ModelInstance.reset(new GLTF::ModelInstance(*m_Model));
     m_GLTFRenderer->InitializeResourceBindings(*m_Model, m_CameraAttribsCB, m_LightAttribsCB);
 
     // Center and scale model
@@ -491,7 +493,7 @@ void GLTFViewer::Render()
         lightAttribs->f4Intensity = m_LightColor * m_LightIntensity;
     }
 
-    m_GLTFRenderer->Render(m_pImmediateContext, *m_Model, m_RenderParams);
+    m_GLTFRenderer->Render(m_pImmediateContext, *m_ModelInstance, m_RenderParams);
 
     if (m_BoundBoxMode != BoundBoxMode::None)
     {
@@ -583,7 +585,7 @@ void GLTFViewer::Update(double CurrTime, double ElapsedTime)
         float& AnimationTimer = m_AnimationTimers[m_AnimationIndex];
         AnimationTimer += static_cast<float>(ElapsedTime);
         AnimationTimer = std::fmod(AnimationTimer, m_Model->Animations[m_AnimationIndex].End);
-        m_Model->UpdateAnimation(m_AnimationIndex, AnimationTimer);
+        m_ModelInstance->UpdateAnimation(m_AnimationIndex, AnimationTimer);
     }
 }
 
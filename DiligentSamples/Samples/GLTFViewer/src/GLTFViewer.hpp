@@ -94,6 +94,7 @@ private:
 
     std::unique_ptr<GLTF_PBR_Renderer>    m_GLTFRenderer;
     std::unique_ptr<GLTF::Model>          m_Model;
+    std::unique_ptr<GLTF::ModelInstance>  m_ModelInstance;
     RefCntAutoPtr<IBuffer>                m_CameraAttribsCB;
     RefCntAutoPtr<IBuffer>                m_LightAttribsCB;
     RefCntAutoPtr<IPipelineState>         m_EnvMapPSO;
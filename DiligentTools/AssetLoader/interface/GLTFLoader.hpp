@@ -30,7 +30,9 @@
 #include <vector>
 #include <memory>
 #include <cfloat>
+#include <limits>
 #include <unordered_map>
+#include <string>
 
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
@@ -48,9 +50,13 @@ class Model;
 namespace Diligent
 {
 
+class ImageDecodeQueue;
+
 namespace GLTF
 {
 
+class TextureStreamer;
+
 struct Material
 {
     Material() noexcept {}
@@ -103,6 +109,21 @@ struct Material
         SpecularGlossiness
     };
     PbrWorkflow workflow = PbrWorkflow::MetallicRoughness;
+
+    /// Scale (xy) and bias (zw) that transform texture coordinates to the region of the texture
+    /// in its atlas, see Model::CreateInfo::TextureAtlas. Textures that are not packed into an
+    /// atlas use (1, 1, 0, 0).
+    struct TextureUVScaleBiases
+    {
+        float4 BaseColor          = float4(1.0f, 1.0f, 0.0f, 0.0f);
+        float4 MetallicRoughness  = float4(1.0f, 1.0f, 0.0f, 0.0f);
+        float4 SpecularGlossiness = float4(1.0f, 1.0f, 0.0f, 0.0f);
+        float4 Diffuse            = float4(1.0f, 1.0f, 0.0f, 0.0f);
+        float4 Normal             = float4(1.0f, 1.0f, 0.0f, 0.0f);
+        float4 Occlusion          = float4(1.0f, 1.0f, 0.0f, 0.0f);
+        float4 Emissive           = float4(1.0f, 1.0f, 0.0f, 0.0f);
+    };
+    TextureUVScaleBiases UVScaleBias;
 };
 
 
@@ -110,6 +131,7 @@ struct Primitive
 {
     Uint32    FirstIndex  = 0;
     Uint32    IndexCount  = 0;
+    Uint32    FirstVertex = 0;
     Uint32    VertexCount = 0;
     Material& material;
     bool      hasIndices;
@@ -117,12 +139,28 @@ struct Primitive
     BoundBox BB;
     bool     IsValidBB = false;
 
+    /// Simplified level of detail of the primitive.
+    struct LOD
+    {
+        Uint32 FirstIndex = 0;
+        Uint32 IndexCount = 0;
+
+        /// Maximum deviation of the simplified surface from the full-detail one, in mesh space units.
+        float Error = 0;
+    };
+
+    /// Simplified levels of detail ordered from the most to the least detailed. All levels
+    /// reference the vertices of the primitive. The full-detail level is not included.
+    std::vector<LOD> LODs;
+
     Primitive(Uint32    _FirstIndex,
               Uint32    _IndexCount,
+              Uint32    _FirstVertex,
               Uint32    _VertexCount,
               Material& _material) :
         FirstIndex{_FirstIndex},
         IndexCount{_IndexCount},
+        FirstVertex{_FirstVertex},
         VertexCount{_VertexCount},
         material{_material},
         hasIndices{_IndexCount > 0}
@@ -149,13 +187,14 @@ struct Mesh
 
     struct TransformData
     {
-        static constexpr Uint32 MaxNumJoints = 128u;
-
         float4x4 matrix;
-        float4x4 jointMatrix[MaxNumJoints] = {};
-        int      jointcount                = 0;
+
+        /// Joint palette of a skinned mesh, one matrix per skin joint.
+        /// Empty for meshes that are not skinned.
+        std::vector<float4x4> jointMatrices;
     };
 
+    /// Rest-pose transforms, see ModelInstance for animated transforms.
     TransformData Transforms;
 
     Mesh(IRenderDevice* pDevice, const float4x4& matrix);
@@ -179,6 +218,9 @@ struct Node
     Node*       Parent = nullptr;
     Uint32      Index;
 
+    /// Index of the node in Model::LinearNodes.
+    Uint32 LinearIndex = 0;
+
     std::vector<std::unique_ptr<Node>> Children;
 
     float4x4              Matrix;
@@ -192,11 +234,19 @@ struct Node
     BoundBox              AABB;
     bool                  IsValidBVH = false;
 
+    /// Rest-pose node-to-model transform, see UpdateNodeTransforms().
+    float4x4 GlobalMatrix;
+
     float4x4 LocalMatrix() const;
-    float4x4 GetMatrix() const;
-    void     Update();
 };
 
+/// Computes the rest-pose global matrix of every node in a single top-down pass and
+/// updates rest-pose mesh transforms and joint matrices of skinned meshes.
+
+/// \param [in] LinearNodes - Nodes in parent-first order (see Model::LinearNodes).
+///                           Every global matrix is computed exactly once.
+void UpdateNodeTransforms(const std::vector<Node*>& LinearNodes);
+
 
 struct AnimationChannel
 {
@@ -252,6 +302,9 @@ struct Model
         float4 weight0;
     };
 
+    /// Vertex buffers with VertexAttribs0 and VertexAttribs1 data.
+    /// Besides vertex input, the buffers can be accessed in shaders through
+    /// formatted views (float for buffer 0 and float4 for buffer 1).
     RefCntAutoPtr<IBuffer> pVertexBuffer[2];
     RefCntAutoPtr<IBuffer> pIndexBuffer;
     Uint32                 IndexCount = 0;
@@ -261,12 +314,23 @@ struct Model
     float4x4 AABBTransform;
 
     std::vector<std::unique_ptr<Node>> Nodes;
-    std::vector<Node*>                 LinearNodes;
+
+    /// All nodes of the hierarchy, parents are always stored before their children.
+    std::vector<Node*> LinearNodes;
 
     std::vector<std::unique_ptr<Skin>> Skins;
 
     std::vector<RefCntAutoPtr<ITexture>> Textures;
     std::vector<RefCntAutoPtr<ISampler>> TextureSamplers;
+
+    /// Scale (xy) and bias (zw) of the texture coordinates of every texture in Textures,
+    /// see Material::UVScaleBias. Textures packed into one atlas reference the same ITexture.
+    std::vector<float4> TextureUVScaleBias;
+
+    /// Incremented every time the texture streamer replaces textures of the model.
+    /// Resource bindings that reference the old textures must then be re-created.
+    Uint32 TexturesVersion = 0;
+
     std::vector<Material>                Materials;
     std::vector<Animation>               Animations;
     std::vector<std::string>             Extensions;
@@ -279,35 +343,175 @@ struct Model
 
     using TextureCacheType = std::unordered_map<std::string, RefCntWeakPtr<ITexture>>;
 
+    /// Import-time optimizations applied to indexed triangle list primitives.
+    /// All optimizations are disabled by default, so that the model is loaded exactly as it is stored in the file.
+    struct MeshOptimizationSettings
+    {
+        /// Merge vertices that are identical in all attributes.
+        bool WeldVertices = false;
+
+        /// Reorder triangles to improve the post-transform vertex cache hit rate.
+        bool OptimizeVertexCache = false;
+
+        /// Reorder triangle clusters to reduce overdraw.
+        /// The clusters are produced by the vertex cache optimization, which is enabled by this flag as well.
+        bool OptimizeOverdraw = false;
+
+        /// Reorder vertices in the order of their first use by the index buffer.
+        bool OptimizeVertexFetch = false;
+
+        /// The number of simplified levels of detail to generate for every primitive (see Primitive::LODs).
+        Uint32 NumLODs = 0;
+
+        /// The ratio between the triangle counts of two consecutive levels of detail.
+        float LODReductionFactor = 0.5f;
+
+        /// Maximum simplification error, relative to the primitive extent. Generation stops
+        /// at the first level that cannot be simplified further within this error.
+        float LODMaxError = 0.05f;
+    };
+
+    /// Import-time block compression of the textures decoded from images.
+    struct TextureCompressionSettings
+    {
+        /// Compress color textures to BC1 (opaque) or BC3, normal maps to BC5 and occlusion maps to BC4.
+        /// Mip levels are computed and compressed on the CPU. Images whose width or height is not
+        /// a multiple of 4 are not compressed.
+        bool Enabled = false;
+
+        /// Compress color textures to BC7 instead of BC1/BC3.
+        bool HighQuality = false;
+
+        /// Directory where compressed textures are written as DDS files. When the directory contains
+        /// the compressed version of a texture, the DDS file is loaded instead of compressing the image.
+        /// The files are keyed by the contents of the source image, the compression mode of the texture
+        /// and the alpha cutoff of its material. An empty string disables the cache.
+        std::string CacheDir;
+    };
+
+    /// Import-time packing of small textures into texture atlases.
+    struct TextureAtlasSettings
+    {
+        /// Pack textures decoded from images that are not larger than MaxTextureSize into RGBA8 atlases.
+        /// Only textures with repeating samplers are packed, and textures that use different samplers are
+        /// packed into different atlases. Packed textures are neither compressed nor streamed.
+        ///
+        /// Materials store the transforms of the texture coordinates in Material::UVScaleBias.
+        /// Materials whose textures are packed into the same atlases have identical texture bindings
+        /// and share a single SRB in GLTF_PBR_Renderer.
+        bool Enabled = false;
+
+        /// Maximum width and height of the textures that are packed.
+        Uint32 MaxTextureSize = 256;
+
+        /// Width and maximum height of an atlas.
+        Uint32 AtlasSize = 2048;
+
+        /// Border around every texture that contains the texels of its opposite edges, in texels.
+        /// Must be a power of two. Atlases have log2(Padding) + 1 mip levels, so that the texels of
+        /// neighboring textures are never filtered together.
+        ///
+        /// \warning The mip chain of the atlases is truncated: with the default padding, it ends at 1/8 of
+        ///          the original resolution, so packed textures alias when they are minified further,
+        ///          e.g. on distant objects. Larger padding gives more mip levels at the cost of atlas space.
+        Uint32 Padding = 8;
+    };
+
+    /// Optimized geometry of a single primitive. Indices are relative to the first vertex of the primitive.
+    struct OptimizedPrimitiveData
+    {
+        std::vector<VertexAttribs0> Vertices0;
+        std::vector<VertexAttribs1> Vertices1;
+        std::vector<Uint32>         Indices;
+
+        struct LODData
+        {
+            std::vector<Uint32> Indices;
+            float               Error = 0;
+        };
+        std::vector<LODData> LODs;
+    };
+
+    /// Cache of optimized primitives that allows skipping the optimization when the same
+    /// model is loaded again. Keys are built from the file name, mesh and primitive indices
+    /// and the optimization settings. Like the texture cache, the cache holds weak references:
+    /// the data is kept alive by the models that use it and is released together with the last one.
+    using MeshCacheType = std::unordered_map<std::string, std::weak_ptr<const OptimizedPrimitiveData>>;
+
+    struct CreateInfo
+    {
+        std::string FileName;
+
+        TextureCacheType* pTextureCache = nullptr;
+
+        MeshCacheType* pMeshCache = nullptr;
+
+        MeshOptimizationSettings MeshOptimization;
+
+        /// Optional texture streamer. If provided, textures decoded from images are streamed
+        /// by the streamer and are not added to the texture cache. The streamer must outlive the model.
+        TextureStreamer* pTextureStreamer = nullptr;
+
+        /// Block compression of the textures. Compressed textures are not streamed.
+        TextureCompressionSettings TextureCompression;
+
+        /// Packing of small textures into atlases.
+        TextureAtlasSettings TextureAtlas;
+
+        /// Optional queue that decodes the images while the file is parsed. The queue may be
+        /// shared by several models. If null, the model creates a temporary queue.
+        ImageDecodeQueue* pImageDecodeQueue = nullptr;
+
+        CreateInfo() noexcept {}
+
+        explicit CreateInfo(const std::string& _FileName,
+                            TextureCacheType*  _pTextureCache = nullptr) :
+            FileName{_FileName},
+            pTextureCache{_pTextureCache}
+        {}
+    };
+
+    Model(IRenderDevice*    pDevice,
+          IDeviceContext*   pContext,
+          const CreateInfo& CI);
+
     Model(IRenderDevice*     pDevice,
           IDeviceContext*    pContext,
           const std::string& filename,
           TextureCacheType*  pTextureCache = nullptr);
 
-    void UpdateAnimation(Uint32 index, float time);
+    ~Model();
 
 private:
-    void LoadFromFile(IRenderDevice*     pDevice,
-                      IDeviceContext*    pContext,
-                      const std::string& filename,
-                      TextureCacheType*  pTextureCache);
+    void LoadFromFile(IRenderDevice*    pDevice,
+                      IDeviceContext*   pContext,
+                      const CreateInfo& CI);
 
     void LoadNode(IRenderDevice*               pDevice,
                   Node*                        parent,
                   const tinygltf::Node&        gltf_node,
                   uint32_t                     nodeIndex,
                   const tinygltf::Model&       gltf_model,
+                  const CreateInfo&            CI,
                   std::vector<uint32_t>&       indexBuffer,
                   std::vector<VertexAttribs0>& vertexData0,
                   std::vector<VertexAttribs1>& vertexData1);
 
     void LoadSkins(const tinygltf::Model& gltf_model);
 
-    void LoadTextures(IRenderDevice*         pDevice,
-                      IDeviceContext*        pCtx,
-                      const tinygltf::Model& gltf_model,
-                      const std::string&     BaseDir,
-                      TextureCacheType*      pTextureCache);
+    void LoadTextures(IRenderDevice*                               pDevice,
+                      IDeviceContext*                              pCtx,
+                      const tinygltf::Model&                       gltf_model,
+                      const std::string&                           BaseDir,
+                      TextureCacheType*                            pTextureCache,
+                      const TextureCompressionSettings&            Compression,
+                      const TextureAtlasSettings&                  Atlas,
+                      const std::vector<size_t>&                   CompressedImageHashes,
+                      const std::vector<RefCntAutoPtr<IDataBlob>>& EncodedImages);
+
+    std::vector<RefCntAutoPtr<ITexture>> LoadTextureAtlases(IRenderDevice*              pDevice,
+                                                            const tinygltf::Model&      gltf_model,
+                                                            const TextureAtlasSettings& Atlas);
 
     void  LoadTextureSamplers(IRenderDevice* pDevice, const tinygltf::Model& gltf_model);
     void  LoadMaterials(const tinygltf::Model& gltf_model);
@@ -316,6 +520,56 @@ private:
     void  GetSceneDimensions();
     Node* FindNode(Node* parent, Uint32 index);
     Node* NodeFromIndex(uint32_t index);
+
+    TextureStreamer* pTextureStreamer = nullptr;
+
+    // Optimized primitives referenced by the mesh cache
+    std::vector<std::shared_ptr<const OptimizedPrimitiveData>> CachedPrimitives;
+};
+
+
+/// Animation state of a single instance of a GLTF model.
+
+/// The instance never modifies the model it references, so any number of instances
+/// may play different animations while sharing vertex and index buffers, textures
+/// and materials of one model. Joint palettes are sized to the joint count of each skin.
+struct ModelInstance
+{
+    struct NodePose
+    {
+        float3     Translation;
+        float3     Scale = float3(1.0f, 1.0f, 1.0f);
+        Quaternion Rotation;
+    };
+
+    /// The model must outlive the instance.
+    explicit ModelInstance(const Model& _GLTFModel);
+
+    /// Resets all nodes to the rest pose of the model.
+    void ResetPose();
+
+    /// Samples the animation at the given time and updates all transforms.
+    void UpdateAnimation(Uint32 index, float time);
+
+    /// Recomputes global matrices, mesh transforms and joint palettes from NodePoses.
+    void UpdateTransforms();
+
+    const Mesh::TransformData& GetMeshTransforms(const Node& node) const
+    {
+        return MeshTransforms[node.LinearIndex];
+    }
+
+    const Model& GLTFModel;
+
+    /// Local node transforms, indexed by Node::LinearIndex.
+    std::vector<NodePose> NodePoses;
+
+    /// Node-to-model transforms, indexed by Node::LinearIndex.
+    std::vector<float4x4> GlobalMatrices;
+
+    /// Mesh transforms and joint palettes, indexed by Node::LinearIndex.
+    /// Entries of nodes that have no mesh are not used.
+    std::vector<Mesh::TransformData> MeshTransforms;
 };
 
 } // namespace GLTF
@@ -0,0 +1,229 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
+#include "../../../DiligentCore/Graphics/GraphicsTools/interface/TextureUploader.hpp"
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+namespace GLTF
+{
+
+struct Model;
+struct Material;
+
+/// Streams mip levels of GLTF textures in and out of video memory.
+
+/// Textures of the models that are loaded with the streamer (see Model::CreateInfo::pTextureStreamer)
+/// are created with the coarse mip levels only. Every frame, the application requests the resolution
+/// that the materials need on screen, and the streamer re-derives the missing mip levels from the source
+/// image and uploads them in the background through the texture uploader. Mip levels are not kept in
+/// system memory once they are resident. When the resident mip levels exceed the memory budget,
+/// the streamer drops the levels that have not been needed for the longest time.
+///
+/// A texture can't change its size, so the streamer replaces it with a new texture that has
+/// a different number of levels and increments Model::TexturesVersion of the model that owns it.
+/// Resource bindings of the model must then be re-created.
+///
+/// \note  DDS and KTX textures are loaded as usual and are not streamed.
+class TextureStreamer
+{
+public:
+    struct CreateInfo
+    {
+        /// Maximum size of the resident mip levels of all streamed textures and of the source
+        /// data kept in system memory, in bytes.
+        Uint64 MemoryBudget = Uint64{256} << 20;
+
+        /// Mip levels that are not larger than this size are always resident.
+        Uint32 MinResidentSize = 64;
+
+        /// The number of frames a mip level stays requested after the last request.
+        /// Prevents streaming the same levels in and out when the camera moves back and forth.
+        Uint32 RequestLifetime = 60;
+
+        /// Bias added to the mip level computed from the screen size. Negative values
+        /// request more detail, e.g. for textures that are tiled across the surface.
+        float MipBias = 0;
+
+        /// Maximum number of textures that are streamed in at the same time.
+        Uint32 MaxPendingUploads = 4;
+    };
+
+    struct Statistics
+    {
+        Uint32 NumTextures       = 0;
+        Uint32 NumPendingUploads = 0;
+
+        /// Size of the resident mip levels of all textures, in bytes.
+        Uint64 ResidentMemory = 0;
+
+        /// Size of the source data of all textures kept in system memory, in bytes.
+        Uint64 SourceMemory = 0;
+
+        /// Size of all textures at full resolution, in bytes.
+        Uint64 FullResolutionMemory = 0;
+
+        /// The total number of stream-in and eviction operations.
+        Uint32 NumStreamedIn = 0;
+        Uint32 NumEvicted    = 0;
+    };
+
+    /// \param [in] pDevice   - Render device.
+    /// \param [in] pContext  - Immediate device context. The context is used to complete
+    ///                         pending uploads when the streamer is destroyed.
+    /// \param [in] CI        - Streamer create info.
+    TextureStreamer(IRenderDevice*    pDevice,
+                    IDeviceContext*   pContext,
+                    const CreateInfo& CI);
+
+    ~TextureStreamer();
+
+    // clang-format off
+    TextureStreamer           (const TextureStreamer&)  = delete;
+    TextureStreamer           (      TextureStreamer&&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&)  = delete;
+    TextureStreamer& operator=(      TextureStreamer&&) = delete;
+    // clang-format on
+
+    /// Re-derives tightly packed RGBA8 data of the most detailed mip level, e.g. by decoding
+    /// the source image. Called by the upload thread. Returns false if the data can't be loaded.
+    using SourceLoaderType = std::function<bool(std::vector<Uint8>& RGBA)>;
+
+    /// Creates a streamed texture from RGBA8 data. Called by the model loader.
+
+    /// \param [in] GLTFModel    - Model that owns the texture.
+    /// \param [in] TextureIndex - Index of the texture in Model::Textures.
+    /// \param [in] Width        - Texture width.
+    /// \param [in] Height       - Texture height.
+    /// \param [in] pRGBAData    - Tightly packed RGBA8 data of the most detailed mip level.
+    /// \param [in] pSampler     - Sampler to set in the default shader resource views.
+    /// \param [in] LoadSource   - Function that re-derives pRGBAData when the detailed levels are
+    ///                            streamed in. If null, the streamer keeps a copy of pRGBAData.
+    /// \param [in] SourceSize   - Size of the system memory kept alive by LoadSource, e.g. of the
+    ///                            encoded image, in bytes.
+    ///
+    /// \return The texture with the coarse mip levels. The texture must be transitioned
+    ///         to the shader resource state before it is used.
+    ///
+    /// \note  The source data is counted against the memory budget.
+    RefCntAutoPtr<ITexture> CreateTexture(Model&           GLTFModel,
+                                          Uint32           TextureIndex,
+                                          Uint32           Width,
+                                          Uint32           Height,
+                                          const void*      pRGBAData,
+                                          ISampler*        pSampler,
+                                          SourceLoaderType LoadSource = nullptr,
+                                          size_t           SourceSize = 0);
+
+    /// Stops streaming textures of the model. Called by the model destructor.
+    void ReleaseModel(const Model& GLTFModel);
+
+    /// Requests the resolution of the material's textures for the current frame.
+
+    /// \param [in] Mat        - Material of a model loaded with the streamer.
+    /// \param [in] ScreenSize - Size of the surface on screen, in pixels. The texture is
+    ///                          assumed to cover the surface once.
+    void RequestMaterial(const Material& Mat, float ScreenSize);
+
+    /// Requests the resolution of all materials of the model, see RequestMaterial().
+    void RequestModel(const Model& GLTFModel, float ScreenSize);
+
+    /// Completes finished uploads, evicts mip levels to stay within the budget and starts
+    /// new uploads. Must be called once per frame by the render thread outside of a render pass.
+    void Update(IDeviceContext* pContext);
+
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+    /// Returns the most detailed mip level that is needed to draw a Width x Height texture
+    /// over ScreenSize pixels.
+    static Uint32 ComputeRequiredMip(Uint32 Width, Uint32 Height, float ScreenSize, float MipBias);
+
+    /// Returns the size of the RGBA8 mip levels [FirstMip, MipLevels) of a Width x Height texture, in bytes.
+    static Uint64 GetMipChainSize(Uint32 Width, Uint32 Height, Uint32 FirstMip, Uint32 MipLevels);
+
+private:
+    struct TextureSource;
+    struct UploadJob;
+    struct StreamedTexture;
+
+    RefCntAutoPtr<ITexture> CreateResidentTexture(const StreamedTexture& Tex, Uint32 FirstMip, const TextureData* pInitData);
+
+    void ReplaceTexture(StreamedTexture& Tex, ITexture* pNewTexture, Uint32 NewResidentMip);
+    void UpdateRequestedMip(StreamedTexture& Tex);
+    void CompleteUploads(IDeviceContext* pContext);
+    bool Evict(IDeviceContext* pContext, Uint64 RequiredMemory, const StreamedTexture* pExclude);
+    void StartUploads(IDeviceContext* pContext);
+    void UploadMipLevels(UploadJob& Upload);
+
+    Uint64 GetResidentSize(const StreamedTexture& Tex, Uint32 ResidentMip) const;
+
+    // Resident and source memory of all textures
+    Uint64 GetUsedMemory() const { return m_ResidentMemory + m_SourceMemory; }
+
+    const CreateInfo m_CI;
+
+    RefCntAutoPtr<IRenderDevice>    m_pDevice;
+    RefCntAutoPtr<IDeviceContext>   m_pContext;
+    RefCntAutoPtr<ITextureUploader> m_pUploader;
+
+    std::vector<std::unique_ptr<StreamedTexture>> m_Textures;
+
+    // Current textures of the streamed textures
+    std::unordered_map<const ITexture*, StreamedTexture*> m_TextureLookup;
+
+    Uint64 m_FrameIndex     = 0;
+    Uint64 m_ResidentMemory = 0;
+    Uint64 m_SourceMemory   = 0;
+    // Memory of the textures that are being streamed in
+    Uint64 m_ReservedMemory = 0;
+
+    Statistics m_Stats;
+
+    std::atomic<Uint32> m_NumActiveUploads{0};
+    std::atomic<bool>   m_Abort{false};
+
+    // Uploads block until the render thread executes them, so they run on a separate worker
+    std::unique_ptr<ThreadPool> m_pUploadThread;
+};
+
+} // namespace GLTF
+
+} // namespace Diligent
@@ -0,0 +1,143 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+
+namespace Diligent
+{
+
+/// Vertex attribute stream used by GenerateVertexRemap().
+struct MeshOptimizerStream
+{
+    /// Pointer to the first vertex.
+    const void* pData = nullptr;
+
+    /// Size of the vertex data that identifies the vertex, in bytes.
+    size_t Size = 0;
+
+    /// Distance between two consecutive vertices, in bytes.
+    size_t Stride = 0;
+};
+
+/// Builds a table that maps every vertex to its index in a welded vertex buffer.
+
+/// Vertices that are bitwise identical in all streams are mapped to the same index.
+/// New indices are assigned in the order in which vertices are referenced by the index buffer.
+/// Vertices that are not referenced by any index are mapped to ~0u.
+///
+/// \param [out] pRemap      - Remap table of VertexCount elements.
+/// \param [in]  pIndices    - Triangle list index buffer.
+/// \param [in]  IndexCount  - Number of indices.
+/// \param [in]  VertexCount - Number of vertices in every stream.
+/// \param [in]  pStreams    - Vertex attribute streams.
+/// \param [in]  NumStreams  - Number of vertex attribute streams.
+/// \return                    The number of unique vertices.
+Uint32 GenerateVertexRemap(Uint32*                    pRemap,
+                           const Uint32*              pIndices,
+                           size_t                     IndexCount,
+                           size_t                     VertexCount,
+                           const MeshOptimizerStream* pStreams,
+                           size_t                     NumStreams);
+
+/// Applies the remap table to the index buffer. pDst may be equal to pIndices.
+void RemapIndexBuffer(Uint32* pDst, const Uint32* pIndices, size_t IndexCount, const Uint32* pRemap);
+
+/// Applies the remap table to the vertex buffer. pDst must not overlap with pVertices.
+void RemapVertexBuffer(void* pDst, const void* pVertices, size_t VertexCount, size_t VertexStride, const Uint32* pRemap);
+
+/// Reorders triangles to improve the post-transform vertex cache hit rate.
+
+/// The method implements the linear-speed vertex cache optimization algorithm by Tom Forsyth.
+/// pDst must not overlap with pIndices.
+void OptimizeVertexCache(Uint32* pDst, const Uint32* pIndices, size_t IndexCount, size_t VertexCount);
+
+/// Reorders clusters of triangles to reduce overdraw while preserving vertex cache efficiency.
+
+/// The index buffer is expected to be optimized for the vertex cache. The buffer is split into
+/// clusters at the triangles that miss the cache for all three vertices, and clusters that face
+/// away from the mesh center are moved to the front, so that they occlude the rest of the mesh.
+/// pDst must not overlap with pIndices.
+///
+/// \param [out] pDst           - Destination index buffer.
+/// \param [in]  pIndices       - Index buffer optimized for the vertex cache.
+/// \param [in]  IndexCount     - Number of indices.
+/// \param [in]  pPositions     - Pointer to the position (three floats) of the first vertex.
+/// \param [in]  VertexCount    - Number of vertices.
+/// \param [in]  PositionStride - Distance between two consecutive positions, in bytes.
+void OptimizeOverdraw(Uint32*       pDst,
+                      const Uint32* pIndices,
+                      size_t        IndexCount,
+                      const float*  pPositions,
+                      size_t        VertexCount,
+                      size_t        PositionStride);
+
+/// Builds a remap table that orders vertices in the order of their first use by the index buffer,
+/// which improves the locality of vertex fetches. Unreferenced vertices are mapped to ~0u.
+
+/// \return The number of referenced vertices.
+Uint32 OptimizeVertexFetchRemap(Uint32* pRemap, const Uint32* pIndices, size_t IndexCount, size_t VertexCount);
+
+/// Reduces the number of triangles of the mesh by collapsing edges in the order of increasing
+/// quadric error. The vertex buffer is not modified, so the result can share it with the source mesh.
+
+/// Vertices on mesh borders and on attribute seams (vertices that share the position with other
+/// vertices) are never moved, so that the simplified mesh has no cracks. Collapses that flip
+/// triangles are rejected.
+///
+/// \param [out] pDst             - Destination index buffer of IndexCount elements.
+///                                 pDst must not overlap with pIndices.
+/// \param [in]  pIndices         - Triangle list index buffer.
+/// \param [in]  IndexCount       - Number of indices.
+/// \param [in]  pPositions       - Pointer to the position (three floats) of the first vertex.
+/// \param [in]  VertexCount      - Number of vertices.
+/// \param [in]  PositionStride   - Distance between two consecutive positions, in bytes.
+/// \param [in]  TargetIndexCount - Desired number of indices.
+/// \param [in]  TargetError      - Maximum allowed error, relative to the mesh extent.
+/// \param [out] pResultError     - Optional pointer to the error of the simplified mesh,
+///                                 relative to the mesh extent.
+/// \return                         The number of indices in the simplified mesh. The value may be
+///                                 greater than TargetIndexCount if the error limit has been reached.
+size_t SimplifyMesh(Uint32*       pDst,
+                    const Uint32* pIndices,
+                    size_t        IndexCount,
+                    const float*  pPositions,
+                    size_t        VertexCount,
+                    size_t        PositionStride,
+                    size_t        TargetIndexCount,
+                    float         TargetError,
+                    float*        pResultError = nullptr);
+
+/// Computes the average cache miss ratio (the number of transformed vertices per triangle)
+/// of the index buffer for a FIFO post-transform vertex cache of the given size.
+float ComputeACMR(const Uint32* pIndices, size_t IndexCount, size_t VertexCount, Uint32 CacheSize);
+
+} // namespace Diligent
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+#include "../../../DiligentCore/Common/interface/BasicMath.hpp"
+
+namespace Diligent
+{
+
+/// Region of a texture in a texture atlas.
+struct TextureAtlasRegion
+{
+    /// Position of the texture in the atlas, not including the padding.
+    Uint32 X = 0;
+    Uint32 Y = 0;
+
+    /// Size of the texture.
+    Uint32 Width  = 0;
+    Uint32 Height = 0;
+
+    /// Whether the texture fits into the atlas.
+    bool IsPacked = false;
+};
+
+/// Packs textures into an atlas.
+
+/// The textures are sorted by height and placed left to right in rows (shelves). Every texture
+/// is surrounded by Padding texels, and the padded rectangles are aligned by Alignment texels.
+/// If the alignment is 2^N, box-filtered mip levels 0..N of the atlas don't mix the texels of
+/// different rectangles.
+///
+/// \param [in]     AtlasWidth  - Atlas width.
+/// \param [in]     AtlasHeight - Maximum atlas height.
+/// \param [in]     Padding     - Border around every texture, in texels.
+/// \param [in]     Alignment   - Alignment of the padded rectangles. Must be a power of two.
+/// \param [in,out] pRegions    - Regions of the textures. Width and Height must be set by the caller,
+///                               X, Y and IsPacked are set by the function.
+/// \param [in]     NumRegions  - Number of regions.
+/// \return                       Size of the used part of the atlas, aligned by Alignment.
+uint2 PackTextureAtlas(Uint32              AtlasWidth,
+                       Uint32              AtlasHeight,
+                       Uint32              Padding,
+                       Uint32              Alignment,
+                       TextureAtlasRegion* pRegions,
+                       size_t              NumRegions);
+
+/// Copies an RGBA8 texture to its region in the atlas.
+
+/// The padding is filled with the texels that wrap around the opposite edges of the texture,
+/// so that the texture can be repeated within its region (see GetTextureAtlasUVScaleBias())
+/// without filtering the texels of the neighboring regions.
+void CopyToTextureAtlas(const TextureAtlasRegion& Region,
+                        Uint32                    Padding,
+                        const Uint8*              pSrcData,
+                        Uint32                    SrcStride,
+                        Uint8*                    pAtlasData,
+                        Uint32                    AtlasStride);
+
+/// Returns the scale (xy) and bias (zw) that transform texture coordinates in [0, 1]
+/// to the region of the texture in the atlas: AtlasUV = frac(UV) * Scale + Bias.
+float4 GetTextureAtlasUVScaleBias(const TextureAtlasRegion& Region,
+                                  Uint32                    AtlasWidth,
+                                  Uint32                    AtlasHeight);
+
+} // namespace Diligent
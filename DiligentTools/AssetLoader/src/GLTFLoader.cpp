@@ -28,16 +28,28 @@
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
 
 #include "GLTFLoader.hpp"
 #include "MapHelper.hpp"
 #include "CommonlyUsedStates.h"
 #include "DataBlobImpl.hpp"
+#include "ProxyDataBlob.hpp"
+#include "ImageDecodeQueue.hpp"
 #include "Image.h"
 #include "FileSystem.hpp"
 #include "FileWrapper.hpp"
 #include "GraphicsAccessories.hpp"
 #include "TextureLoader.h"
+#include "TextureUtilities.h"
+#include "HashUtils.hpp"
+#include "MeshOptimizer.hpp"
+#include "GLTFTextureStreamer.hpp"
+#include "TextureAtlasPacker.hpp"
+#include "PlatformMisc.hpp"
 
 #define TINYGLTF_IMPLEMENTATION
 #define TINYGLTF_NO_STB_IMAGE
@@ -52,11 +64,11 @@ namespace Diligent
 namespace GLTF
 {
 
-RefCntAutoPtr<ITexture> TextureFromGLTFImage(IRenderDevice*         pDevice,
-                                             IDeviceContext*        pCtx,
-                                             const tinygltf::Image& gltfimage,
-                                             ISampler*              pSampler,
-                                             float                  AlphaCutoff)
+// Returns RGBA8 data of the image. RGB images are expanded to RGBA in RGBA, and if AlphaCutoff is
+// not zero, alpha channel is remapped in RGBA to improve mip maps of alpha-cut textures.
+const Uint8* GetGLTFImageRGBAData(const tinygltf::Image& gltfimage,
+                                  float                  AlphaCutoff,
+                                  std::vector<Uint8>&    RGBA)
 {
     if (gltfimage.image.empty())
     {
@@ -67,8 +79,6 @@ RefCntAutoPtr<ITexture> TextureFromGLTFImage(IRenderDevice*         pDevice,
         LOG_ERROR_AND_THROW("Failed to create texture for image ", gltfimage.uri, ": invalid parameters.");
     }
 
-    std::vector<Uint8> RGBA;
-
     const Uint8* pTextureData = nullptr;
     if (gltfimage.component == 3)
     {
@@ -130,6 +140,19 @@ RefCntAutoPtr<ITexture> TextureFromGLTFImage(IRenderDevice*         pDevice,
         UNEXPECTED("Unexpected number of color components in gltf image: ", gltfimage.component);
     }
 
+    return pTextureData;
+}
+
+RefCntAutoPtr<ITexture> TextureFromGLTFImage(IRenderDevice*         pDevice,
+                                             IDeviceContext*        pCtx,
+                                             const tinygltf::Image& gltfimage,
+                                             ISampler*              pSampler,
+                                             float                  AlphaCutoff)
+{
+    std::vector<Uint8> RGBA;
+
+    const auto* pTextureData = GetGLTFImageRGBAData(gltfimage, AlphaCutoff, RGBA);
+
     TextureDesc TexDesc;
     TexDesc.Name      = "GLTF Texture";
     TexDesc.Type      = RESOURCE_DIM_TEX_2D;
@@ -153,6 +176,107 @@ RefCntAutoPtr<ITexture> TextureFromGLTFImage(IRenderDevice*         pDevice,
     return pTexture;
 }
 
+// Returns the path of the compressed texture in the cache directory. The file name is the hash
+// of the encoded image, the compression settings, the compression mode and the alpha cutoff.
+std::string GetCompressedImageCachePath(const Model::TextureCompressionSettings& Compression,
+                                        size_t                                   ImageHash,
+                                        TEXTURE_LOAD_COMPRESS_MODE               CompressMode,
+                                        float                                    AlphaCutoff)
+{
+    auto Hash = ImageHash;
+    HashCombine(Hash, Compression.HighQuality, static_cast<int>(CompressMode), AlphaCutoff);
+
+    std::stringstream ss;
+    ss << Compression.CacheDir;
+    if (!Compression.CacheDir.empty() && Compression.CacheDir.back() != '/' && Compression.CacheDir.back() != '\\')
+        ss << '/';
+    ss << std::hex << std::setw(sizeof(Hash) * 2) << std::setfill('0') << Hash << ".dds";
+    return ss.str();
+}
+
+// Computes all mip levels of the image on the CPU, compresses them and writes the texture to
+// CacheFile, unless it is empty. Returns null if the image can't be compressed.
+RefCntAutoPtr<ITexture> CompressedTextureFromGLTFImage(IRenderDevice*             pDevice,
+                                                       const tinygltf::Image&     gltfimage,
+                                                       ISampler*                  pSampler,
+                                                       float                      AlphaCutoff,
+                                                       TEXTURE_LOAD_COMPRESS_MODE CompressMode,
+                                                       const std::string&         CacheFile)
+{
+    if ((gltfimage.width % 4) != 0 || (gltfimage.height % 4) != 0)
+    {
+        LOG_WARNING_MESSAGE("Image ", gltfimage.uri, " is not compressed: its dimensions (", gltfimage.width, "x", gltfimage.height, ") are not multiples of 4");
+        return {};
+    }
+
+    std::vector<Uint8> RGBA;
+
+    const auto* pRGBAData = GetGLTFImageRGBAData(gltfimage, AlphaCutoff, RGBA);
+
+    TextureDesc TexDesc;
+    TexDesc.Name      = "GLTF Texture";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Usage     = USAGE_IMMUTABLE;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+    TexDesc.Width     = gltfimage.width;
+    TexDesc.Height    = gltfimage.height;
+    TexDesc.MipLevels = ComputeMipLevelsCount(TexDesc.Width, TexDesc.Height);
+
+    bool HasAlpha = false;
+    if (CompressMode == TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR)
+    {
+        const size_t NumTexels = size_t{TexDesc.Width} * size_t{TexDesc.Height};
+        for (size_t i = 0; i < NumTexels && !HasAlpha; ++i)
+            HasAlpha = pRGBAData[i * 4 + 3] != 255;
+    }
+    // Color textures are sampled as UNORM and converted to linear space in the shader
+    TexDesc.Format = GetCompressedTextureFormat(CompressMode, HasAlpha, false);
+
+    const auto BlockSize = Uint32{GetTextureFormatAttribs(TexDesc.Format).ComponentSize};
+
+    std::vector<std::vector<Uint8>> Mips(TexDesc.MipLevels);
+    std::vector<std::vector<Uint8>> CompressedMips(TexDesc.MipLevels);
+    std::vector<TextureSubResData>  SubResources(TexDesc.MipLevels);
+    for (Uint32 m = 0; m < TexDesc.MipLevels; ++m)
+    {
+        const auto MipWidth  = std::max(TexDesc.Width >> m, 1u);
+        const auto MipHeight = std::max(TexDesc.Height >> m, 1u);
+
+        const Uint8* pMipData = pRGBAData;
+        if (m > 0)
+        {
+            const auto* pFineMipData = m > 1 ? Mips[m - 1].data() : pRGBAData;
+            Mips[m].resize(size_t{MipWidth} * size_t{MipHeight} * 4);
+            ComputeMipLevel(std::max(TexDesc.Width >> (m - 1), 1u), std::max(TexDesc.Height >> (m - 1), 1u), TEX_FORMAT_RGBA8_UNORM,
+                            pFineMipData, std::max(TexDesc.Width >> (m - 1), 1u) * 4,
+                            Mips[m].data(), MipWidth * 4);
+            pMipData = Mips[m].data();
+        }
+
+        const auto BlockStride = (MipWidth + 3) / 4 * BlockSize;
+        CompressedMips[m].resize(size_t{BlockStride} * size_t{(MipHeight + 3) / 4});
+        CompressMipLevel(MipWidth, MipHeight, TEX_FORMAT_RGBA8_UNORM, pMipData, MipWidth * 4,
+                         TexDesc.Format, CompressedMips[m].data(), BlockStride);
+
+        SubResources[m] = TextureSubResData{CompressedMips[m].data(), BlockStride};
+    }
+
+    TextureData TexData{SubResources.data(), TexDesc.MipLevels};
+
+    RefCntAutoPtr<ITexture> pTexture;
+    pDevice->CreateTexture(TexDesc, &TexData, &pTexture);
+    if (!pTexture)
+        return {};
+    pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)->SetSampler(pSampler);
+
+    if (!CacheFile.empty() && !SaveTextureAsDDS(CacheFile.c_str(), TexDesc, TexData))
+    {
+        LOG_WARNING_MESSAGE("Failed to write compressed image ", gltfimage.uri, " to ", CacheFile);
+    }
+
+    return pTexture;
+}
+
 
 
 Mesh::Mesh(IRenderDevice* pDevice, const float4x4& matrix)
@@ -171,58 +295,248 @@ void Mesh::SetBoundingBox(const float3& min, const float3& max)
 
 
 
-float4x4 Node::LocalMatrix() const
+namespace
 {
-    return Matrix * float4x4::Scale(Scale) * Rotation.ToMatrix() * float4x4::Translation(Translation);
-}
 
-float4x4 Node::GetMatrix() const
+float4x4 ComposeLocalMatrix(const float4x4&   Matrix,
+                            const float3&     Translation,
+                            const Quaternion& Rotation,
+                            const float3&     Scale)
 {
-    auto mat = LocalMatrix();
-
-    for (auto* p = Parent; p != nullptr; p = p->Parent)
+    // Compose Scale * Rotation * Translation directly instead of multiplying three 4x4 matrices
+    auto SRT = Rotation.ToMatrix();
+    for (int r = 0; r < 3; ++r)
     {
-        mat = mat * p->LocalMatrix();
+        SRT[r][0] *= Scale[r];
+        SRT[r][1] *= Scale[r];
+        SRT[r][2] *= Scale[r];
     }
-    return mat;
+    SRT[3][0] = Translation.x;
+    SRT[3][1] = Translation.y;
+    SRT[3][2] = Translation.z;
+    return Matrix * SRT;
 }
 
-void Node::Update()
+// Computes global matrices of all nodes in a single top-down pass, then mesh transforms
+// and joint palettes. Accessors map a node to its local matrix, its global matrix and its
+// mesh transforms, which allows the same code to update the rest pose stored in the model
+// as well as the pose of a model instance.
+template <typename LocalMatrixAccessor, typename GlobalMatrixAccessor, typename MeshTransformsAccessor>
+void ComputeNodeTransforms(const std::vector<Node*>& LinearNodes,
+                           LocalMatrixAccessor       LocalMatrix,
+                           GlobalMatrixAccessor      GlobalMatrix,
+                           MeshTransformsAccessor    MeshTransforms)
 {
-    if (_Mesh)
+    // Parents are always processed before their children, so the parent's
+    // global matrix is up to date by the time it is needed.
+    for (auto* node : LinearNodes)
+    {
+        GlobalMatrix(*node) = node->Parent != nullptr ?
+            LocalMatrix(*node) * GlobalMatrix(*node->Parent) :
+            LocalMatrix(*node);
+    }
+
+    // Joints may appear anywhere in the hierarchy, so skinning requires a separate pass
+    for (auto* node : LinearNodes)
     {
-        _Mesh->Transforms.matrix = GetMatrix();
-        if (_Skin != nullptr)
+        if (!node->_Mesh)
+            continue;
+
+        const auto& NodeGlobalMatrix = GlobalMatrix(*node);
+
+        auto& Transforms  = MeshTransforms(*node);
+        Transforms.matrix = NodeGlobalMatrix;
+        if (node->_Skin != nullptr)
         {
             // Update join matrices
-            auto   InverseTransform = _Mesh->Transforms.matrix.Inverse(); // TODO: do not use inverse tranform here
-            size_t numJoints        = std::min((uint32_t)_Skin->Joints.size(), Uint32{Mesh::TransformData::MaxNumJoints});
-            for (size_t i = 0; i < numJoints; i++)
+            const auto& Skin             = *node->_Skin;
+            const auto  InverseTransform = NodeGlobalMatrix.InverseAffine();
+            Transforms.jointMatrices.resize(Skin.Joints.size());
+            for (size_t i = 0; i < Skin.Joints.size(); ++i)
             {
-                auto* JointNode = _Skin->Joints[i];
-                auto  JointMat  = _Skin->InverseBindMatrices[i] * JointNode->GetMatrix() * InverseTransform;
-
-                _Mesh->Transforms.jointMatrix[i] = JointMat;
+                const auto& JointMatrix = GlobalMatrix(*Skin.Joints[i]);
+                // Inverse bind matrices are optional and default to identity
+                Transforms.jointMatrices[i] = i < Skin.InverseBindMatrices.size() ?
+                    Skin.InverseBindMatrices[i] * JointMatrix * InverseTransform :
+                    JointMatrix * InverseTransform;
             }
-            _Mesh->Transforms.jointcount = static_cast<int>(numJoints);
         }
     }
+}
+
+} // namespace
+
+float4x4 Node::LocalMatrix() const
+{
+    return ComposeLocalMatrix(Matrix, Translation, Rotation, Scale);
+}
+
+
+void UpdateNodeTransforms(const std::vector<Node*>& LinearNodes)
+{
+    ComputeNodeTransforms(
+        LinearNodes,
+        [](const Node& node) { return node.LocalMatrix(); },
+        [](Node& node) -> float4x4& { return node.GlobalMatrix; },
+        [](const Node& node) -> Mesh::TransformData& { return node._Mesh->Transforms; });
+}
+
+
+
+
+namespace
+{
 
-    for (auto& child : Children)
+std::string GetMeshCacheKey(const std::string& FileName, int MeshIndex, size_t PrimitiveIndex, const Model::MeshOptimizationSettings& Settings)
+{
+    std::stringstream ss;
+    ss << FileName << ':' << MeshIndex << ':' << PrimitiveIndex << ':'
+       << (Settings.WeldVertices ? 'w' : '-')
+       << (Settings.OptimizeVertexCache ? 'c' : '-')
+       << (Settings.OptimizeOverdraw ? 'o' : '-')
+       << (Settings.OptimizeVertexFetch ? 'f' : '-');
+    if (Settings.NumLODs > 0)
+        ss << ':' << Settings.NumLODs << ':' << Settings.LODReductionFactor << ':' << Settings.LODMaxError;
+    return ss.str();
+}
+
+// Optimizes indexed triangle list geometry of a single primitive in place.
+// Indices in Data are relative to the first vertex of the primitive.
+void OptimizePrimitive(Model::OptimizedPrimitiveData& Data, const Model::MeshOptimizationSettings& Settings)
+{
+    auto&        Indices     = Data.Indices;
+    const size_t IndexCount  = Indices.size();
+    size_t       VertexCount = Data.Vertices0.size();
+    VERIFY_EXPR(Data.Vertices1.size() == VertexCount);
+
+    // Overdraw optimization reorders the clusters produced by the vertex cache optimization
+    const bool OptimizeCache = Settings.OptimizeVertexCache || Settings.OptimizeOverdraw;
+
+    std::vector<Uint32> Remap(VertexCount);
+    auto                ApplyRemap = [&](Uint32 NewVertexCount) {
+        RemapIndexBuffer(Indices.data(), Indices.data(), IndexCount, Remap.data());
+
+        std::vector<Model::VertexAttribs0> Vertices0(NewVertexCount);
+        std::vector<Model::VertexAttribs1> Vertices1(NewVertexCount);
+        RemapVertexBuffer(Vertices0.data(), Data.Vertices0.data(), VertexCount, sizeof(Vertices0[0]), Remap.data());
+        RemapVertexBuffer(Vertices1.data(), Data.Vertices1.data(), VertexCount, sizeof(Vertices1[0]), Remap.data());
+        Data.Vertices0.swap(Vertices0);
+        Data.Vertices1.swap(Vertices1);
+        VertexCount = NewVertexCount;
+    };
+
+    if (Settings.WeldVertices)
     {
-        child->Update();
+        const MeshOptimizerStream Streams[] =
+            {
+                {Data.Vertices0.data(), sizeof(Model::VertexAttribs0), sizeof(Model::VertexAttribs0)},
+                {Data.Vertices1.data(), sizeof(Model::VertexAttribs1), sizeof(Model::VertexAttribs1)} //
+            };
+        const auto NumUniqueVertices = GenerateVertexRemap(Remap.data(), Indices.data(), IndexCount, VertexCount, Streams, _countof(Streams));
+        ApplyRemap(NumUniqueVertices);
+    }
+
+    if (OptimizeCache)
+    {
+        std::vector<Uint32> OptimizedIndices(IndexCount);
+        OptimizeVertexCache(OptimizedIndices.data(), Indices.data(), IndexCount, VertexCount);
+        if (Settings.OptimizeOverdraw)
+        {
+            OptimizeOverdraw(Indices.data(), OptimizedIndices.data(), IndexCount, &Data.Vertices0[0].pos.x, VertexCount, sizeof(Model::VertexAttribs0));
+        }
+        else
+        {
+            Indices.swap(OptimizedIndices);
+        }
     }
-}
 
+    if (Settings.OptimizeVertexFetch)
+    {
+        const auto NumUsedVertices = OptimizeVertexFetchRemap(Remap.data(), Indices.data(), IndexCount, VertexCount);
+        ApplyRemap(NumUsedVertices);
+    }
+
+    if (Settings.NumLODs > 0 && IndexCount > 0)
+    {
+        float3 MinPos{+FLT_MAX, +FLT_MAX, +FLT_MAX};
+        float3 MaxPos{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        for (auto Idx : Indices)
+        {
+            MinPos = std::min(MinPos, Data.Vertices0[Idx].pos);
+            MaxPos = std::max(MaxPos, Data.Vertices0[Idx].pos);
+        }
+        const auto  Extent    = MaxPos - MinPos;
+        const float MeshScale = std::max(std::max(Extent.x, Extent.y), Extent.z);
+
+        // Every level is simplified from the previous one, so errors accumulate
+        // and the levels are guaranteed to have decreasing triangle counts.
+        // LODs are never reallocated, so that pSrcIndices stays valid.
+        Data.LODs.reserve(Settings.NumLODs);
+        const std::vector<Uint32>* pSrcIndices = &Indices;
+
+        float               SrcError = 0;
+        std::vector<Uint32> LODIndices;
+        for (Uint32 Level = 0; Level < Settings.NumLODs; ++Level)
+        {
+            const auto SrcIndexCount    = pSrcIndices->size();
+            const auto TargetIndexCount = static_cast<size_t>(static_cast<float>(SrcIndexCount / 3) * Settings.LODReductionFactor) * 3;
+
+            LODIndices.resize(SrcIndexCount);
+            float      LODError      = 0;
+            const auto LODIndexCount = SimplifyMesh(LODIndices.data(), pSrcIndices->data(), SrcIndexCount, &Data.Vertices0[0].pos.x, VertexCount,
+                                                    sizeof(Model::VertexAttribs0), TargetIndexCount, Settings.LODMaxError - SrcError, &LODError);
+            // Stop if the level does not remove a meaningful number of triangles
+            if (LODIndexCount == 0 || LODIndexCount > SrcIndexCount * 9 / 10)
+                break;
+
+            SrcError += LODError;
+
+            Data.LODs.emplace_back();
+            auto& LOD = Data.LODs.back();
+            LOD.Error = SrcError * MeshScale;
+            LOD.Indices.resize(LODIndexCount);
+            if (OptimizeCache)
+                OptimizeVertexCache(LOD.Indices.data(), LODIndices.data(), LODIndexCount, VertexCount);
+            else
+                LOD.Indices.assign(LODIndices.begin(), LODIndices.begin() + LODIndexCount);
 
+            pSrcIndices = &LOD.Indices;
+        }
+    }
+}
 
+} // namespace
+
+Model::Model(IRenderDevice*    pDevice,
+             IDeviceContext*   pContext,
+             const CreateInfo& CI) :
+    pTextureStreamer{CI.pTextureStreamer}
+{
+    try
+    {
+        LoadFromFile(pDevice, pContext, CI);
+    }
+    catch (...)
+    {
+        // The destructor is not called, but the streamer may already reference the model
+        if (pTextureStreamer != nullptr)
+            pTextureStreamer->ReleaseModel(*this);
+        throw;
+    }
+}
 
 Model::Model(IRenderDevice*     pDevice,
              IDeviceContext*    pContext,
              const std::string& filename,
-             TextureCacheType*  pTextureCache)
+             TextureCacheType*  pTextureCache) :
+    Model{pDevice, pContext, CreateInfo{filename, pTextureCache}}
+{
+}
+
+Model::~Model()
 {
-    LoadFromFile(pDevice, pContext, filename, pTextureCache);
+    if (pTextureStreamer != nullptr)
+        pTextureStreamer->ReleaseModel(*this);
 }
 
 void Model::LoadNode(IRenderDevice*               pDevice,
@@ -230,6 +544,7 @@ void Model::LoadNode(IRenderDevice*               pDevice,
                      const tinygltf::Node&        gltf_node,
                      uint32_t                     nodeIndex,
                      const tinygltf::Model&       gltf_model,
+                     const CreateInfo&            CI,
                      std::vector<uint32_t>&       indexBuffer,
                      std::vector<VertexAttribs0>& vertexData0,
                      std::vector<VertexAttribs1>& vertexData1)
@@ -264,12 +579,16 @@ void Model::LoadNode(IRenderDevice*               pDevice,
         NewNode->Matrix = float4x4::MakeMatrix(gltf_node.matrix.data());
     }
 
+    // Register the node before its children to keep LinearNodes in parent-first order
+    NewNode->LinearIndex = static_cast<Uint32>(LinearNodes.size());
+    LinearNodes.push_back(NewNode.get());
+
     // Node with children
     if (gltf_node.children.size() > 0)
     {
         for (size_t i = 0; i < gltf_node.children.size(); i++)
         {
-            LoadNode(pDevice, NewNode.get(), gltf_model.nodes[gltf_node.children[i]], gltf_node.children[i], gltf_model, indexBuffer, vertexData0, vertexData1);
+            LoadNode(pDevice, NewNode.get(), gltf_model.nodes[gltf_node.children[i]], gltf_node.children[i], gltf_model, CI, indexBuffer, vertexData0, vertexData1);
         }
     }
 
@@ -288,6 +607,8 @@ void Model::LoadNode(IRenderDevice*               pDevice,
 
             uint32_t indexCount  = 0;
             uint32_t vertexCount = 0;
+
+            std::vector<Primitive::LOD> LODs;
             float3   PosMin;
             float3   PosMax;
             bool     hasSkin    = false;
@@ -483,18 +804,87 @@ void Model::LoadNode(IRenderDevice*               pDevice,
                         std::cerr << "Index component type " << accessor.componentType << " not supported!" << std::endl;
                         return;
                 }
+
+                const auto& OptSettings = CI.MeshOptimization;
+                const bool  IsTriList   = primitive.mode == TINYGLTF_MODE_TRIANGLES || primitive.mode < 0;
+                if (IsTriList && (OptSettings.WeldVertices || OptSettings.OptimizeVertexCache || OptSettings.OptimizeOverdraw || OptSettings.OptimizeVertexFetch || OptSettings.NumLODs > 0))
+                {
+                    std::shared_ptr<const OptimizedPrimitiveData> pOptimizedData;
+
+                    std::string CacheKey;
+                    if (CI.pMeshCache != nullptr)
+                    {
+                        CacheKey = GetMeshCacheKey(CI.FileName, gltf_node.mesh, j, OptSettings);
+                        auto it  = CI.pMeshCache->find(CacheKey);
+                        if (it != CI.pMeshCache->end())
+                        {
+                            pOptimizedData = it->second.lock();
+                            if (!pOptimizedData)
+                            {
+                                // All models that used the data have been destroyed
+                                CI.pMeshCache->erase(it);
+                            }
+                        }
+                    }
+
+                    if (!pOptimizedData)
+                    {
+                        std::shared_ptr<OptimizedPrimitiveData> pNewData{new OptimizedPrimitiveData};
+                        pNewData->Vertices0.assign(vertexData0.begin() + vertexStart, vertexData0.end());
+                        pNewData->Vertices1.assign(vertexData1.begin() + vertexStart, vertexData1.end());
+                        pNewData->Indices.reserve(indexCount);
+                        for (auto it = indexBuffer.begin() + indexStart; it != indexBuffer.end(); ++it)
+                            pNewData->Indices.push_back(*it - vertexStart);
+
+                        OptimizePrimitive(*pNewData, OptSettings);
+
+                        pOptimizedData = pNewData;
+                        if (CI.pMeshCache != nullptr)
+                            CI.pMeshCache->emplace(CacheKey, pOptimizedData);
+                    }
+
+                    if (CI.pMeshCache != nullptr)
+                    {
+                        // The cache only holds weak references, keep the data alive while the model exists
+                        CachedPrimitives.emplace_back(pOptimizedData);
+                    }
+
+                    VERIFY_EXPR(pOptimizedData->Indices.size() == indexCount);
+                    vertexCount = static_cast<uint32_t>(pOptimizedData->Vertices0.size());
+
+                    vertexData0.resize(vertexStart);
+                    vertexData0.insert(vertexData0.end(), pOptimizedData->Vertices0.begin(), pOptimizedData->Vertices0.end());
+                    vertexData1.resize(vertexStart);
+                    vertexData1.insert(vertexData1.end(), pOptimizedData->Vertices1.begin(), pOptimizedData->Vertices1.end());
+                    for (size_t i = 0; i < indexCount; ++i)
+                        indexBuffer[indexStart + i] = pOptimizedData->Indices[i] + vertexStart;
+
+                    // Simplified levels share the vertices and follow the full-detail indices
+                    for (const auto& LODData : pOptimizedData->LODs)
+                    {
+                        Primitive::LOD LOD;
+                        LOD.FirstIndex = static_cast<Uint32>(indexBuffer.size());
+                        LOD.IndexCount = static_cast<Uint32>(LODData.Indices.size());
+                        LOD.Error      = LODData.Error;
+                        for (auto Idx : LODData.Indices)
+                            indexBuffer.push_back(Idx + vertexStart);
+                        LODs.push_back(LOD);
+                    }
+                }
             }
             std::unique_ptr<Primitive> newPrimitive(
                 new Primitive //
                 {
                     indexStart,
                     indexCount,
+                    vertexStart,
                     vertexCount,
                     primitive.material > -1 ? Materials[primitive.material] : Materials.back() //
                 }                                                                              //
             );
 
             newPrimitive->SetBoundingBox(PosMin, PosMax);
+            newPrimitive->LODs = std::move(LODs);
             NewMesh->Primitives.push_back(std::move(newPrimitive));
         }
 
@@ -513,7 +903,6 @@ void Model::LoadNode(IRenderDevice*               pDevice,
         NewNode->_Mesh = std::move(NewMesh);
     }
 
-    LinearNodes.push_back(NewNode.get());
     if (parent)
     {
         parent->Children.push_back(std::move(NewNode));
@@ -637,17 +1026,229 @@ static float GetTextureAlphaCutoffValue(const tinygltf::Model& gltf_model, int T
     return std::max(AlphaCutoff, 0.f);
 }
 
-void Model::LoadTextures(IRenderDevice*         pDevice,
-                         IDeviceContext*        pCtx,
-                         const tinygltf::Model& gltf_model,
-                         const std::string&     BaseDir,
-                         TextureCacheType*      pTextureCache)
+// Normal maps are compressed to BC5 and occlusion maps to BC4 unless the texture is also
+// used for other purposes, e.g. as an occlusion-roughness-metallic map.
+static TEXTURE_LOAD_COMPRESS_MODE GetTextureCompressMode(const tinygltf::Model& gltf_model, int TextureIndex, bool HighQuality)
 {
+    bool UsedAsNormal    = false;
+    bool UsedAsOcclusion = false;
+    bool UsedAsColor     = false;
+
+    const auto CheckParameters = [&](const tinygltf::ParameterMap& Params) {
+        for (const auto& it : Params)
+        {
+            if (it.second.TextureIndex() != TextureIndex)
+                continue;
+
+            if (it.first == "normalTexture")
+                UsedAsNormal = true;
+            else if (it.first == "occlusionTexture")
+                UsedAsOcclusion = true;
+            else
+                UsedAsColor = true;
+        }
+    };
+
+    for (const auto& gltf_mat : gltf_model.materials)
+    {
+        CheckParameters(gltf_mat.values);
+        CheckParameters(gltf_mat.additionalValues);
+    }
+
+    if (UsedAsNormal && !UsedAsOcclusion && !UsedAsColor)
+        return TEXTURE_LOAD_COMPRESS_MODE_BC_NORMAL;
+    else if (UsedAsOcclusion && !UsedAsNormal && !UsedAsColor)
+        return TEXTURE_LOAD_COMPRESS_MODE_BC_SINGLE_CHANNEL;
+    else
+        return HighQuality ? TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR_HQ : TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR;
+}
+
+std::vector<RefCntAutoPtr<ITexture>> Model::LoadTextureAtlases(IRenderDevice*              pDevice,
+                                                               const tinygltf::Model&      gltf_model,
+                                                               const TextureAtlasSettings& Atlas)
+{
+    std::vector<RefCntAutoPtr<ITexture>> AtlasTextures(gltf_model.textures.size());
+
+    VERIFY(Atlas.Padding != 0 && (Atlas.Padding & (Atlas.Padding - 1)) == 0, "Atlas padding (", Atlas.Padding, ") must be a power of two");
+    if (Atlas.MaxTextureSize + Atlas.Padding * 2 > Atlas.AtlasSize)
+    {
+        LOG_WARNING_MESSAGE("Textures are not packed into atlases: padded textures of the maximum size (", Atlas.MaxTextureSize,
+                            ") don't fit into the atlas (", Atlas.AtlasSize, ")");
+        return AtlasTextures;
+    }
+
+    // Textures that use the same sampler are packed into the same atlases. Textures with no sampler
+    // use the default one.
+    std::unordered_map<int, std::vector<int>> SamplerTextures;
+    for (int i = 0; i < static_cast<int>(gltf_model.textures.size()); ++i)
+    {
+        const auto& gltf_tex   = gltf_model.textures[i];
+        const auto& gltf_image = gltf_model.images[gltf_tex.source];
+
+        // Textures found in the texture cache are not decoded
+        if (gltf_image.image.empty() || gltf_image.width <= 0 || gltf_image.height <= 0 || gltf_image.bits != 8 ||
+            (gltf_image.component != 3 && gltf_image.component != 4))
+            continue;
+
+        if (static_cast<Uint32>(gltf_image.width) > Atlas.MaxTextureSize || static_cast<Uint32>(gltf_image.height) > Atlas.MaxTextureSize)
+            continue;
+
+        // The shader repeats the textures within their regions, which only matches the wrap address mode
+        constexpr int GLTFRepeat = 10497;
+        if (gltf_tex.sampler != -1)
+        {
+            const auto& gltf_sampler = gltf_model.samplers[gltf_tex.sampler];
+            if (gltf_sampler.wrapS != GLTFRepeat || gltf_sampler.wrapT != GLTFRepeat)
+                continue;
+        }
+
+        SamplerTextures[gltf_tex.sampler].push_back(i);
+    }
+
+    // Box-filtered mip levels don't mix the texels of the regions aligned by the padding,
+    // and the coarsest level still has a border of one texel
+    const auto AtlasMipLevels = 1 + PlatformMisc::GetMSB(Atlas.Padding);
+
+    for (auto& sampler_it : SamplerTextures)
+    {
+        auto& TexIndices = sampler_it.second;
+        while (TexIndices.size() > 1)
+        {
+            std::vector<TextureAtlasRegion> Regions(TexIndices.size());
+            for (size_t i = 0; i < TexIndices.size(); ++i)
+            {
+                const auto& gltf_image = gltf_model.images[gltf_model.textures[TexIndices[i]].source];
+                Regions[i].Width       = static_cast<Uint32>(gltf_image.width);
+                Regions[i].Height      = static_cast<Uint32>(gltf_image.height);
+            }
+
+            const auto AtlasSize = PackTextureAtlas(Atlas.AtlasSize, Atlas.AtlasSize, Atlas.Padding, Atlas.Padding, Regions.data(), Regions.size());
+
+            const auto NumPacked = std::count_if(Regions.begin(), Regions.end(), [](const TextureAtlasRegion& Region) { return Region.IsPacked; });
+            // A single texture is loaded as usual
+            if (NumPacked < 2)
+                break;
+
+            TextureDesc TexDesc;
+            TexDesc.Name      = "GLTF texture atlas";
+            TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+            TexDesc.Usage     = USAGE_IMMUTABLE;
+            TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+            TexDesc.Width     = AtlasSize.x;
+            TexDesc.Height    = AtlasSize.y;
+            TexDesc.Format    = TEX_FORMAT_RGBA8_UNORM;
+            TexDesc.MipLevels = std::min(AtlasMipLevels, ComputeMipLevelsCount(TexDesc.Width, TexDesc.Height));
+
+            std::vector<std::vector<Uint8>> Mips(TexDesc.MipLevels);
+            Mips[0].resize(size_t{TexDesc.Width} * size_t{TexDesc.Height} * 4);
+
+            std::vector<int> RemainingTextures;
+            for (size_t i = 0; i < TexIndices.size(); ++i)
+            {
+                const auto  TexIdx = TexIndices[i];
+                const auto& Region = Regions[i];
+                if (!Region.IsPacked)
+                {
+                    RemainingTextures.push_back(TexIdx);
+                    continue;
+                }
+
+                const auto& gltf_image  = gltf_model.images[gltf_model.textures[TexIdx].source];
+                const auto  AlphaCutoff = GetTextureAlphaCutoffValue(gltf_model, TexIdx);
+
+                std::vector<Uint8> RGBA;
+
+                const auto* pRGBAData = GetGLTFImageRGBAData(gltf_image, AlphaCutoff, RGBA);
+                CopyToTextureAtlas(Region, Atlas.Padding, pRGBAData, Region.Width * 4, Mips[0].data(), TexDesc.Width * 4);
+
+                TextureUVScaleBias[TexIdx] = GetTextureAtlasUVScaleBias(Region, TexDesc.Width, TexDesc.Height);
+            }
+
+            std::vector<TextureSubResData> SubResources(TexDesc.MipLevels);
+            SubResources[0] = TextureSubResData{Mips[0].data(), TexDesc.Width * 4};
+            for (Uint32 m = 1; m < TexDesc.MipLevels; ++m)
+            {
+                const auto FineWidth  = std::max(TexDesc.Width >> (m - 1), 1u);
+                const auto FineHeight = std::max(TexDesc.Height >> (m - 1), 1u);
+                const auto MipWidth   = std::max(TexDesc.Width >> m, 1u);
+                const auto MipHeight  = std::max(TexDesc.Height >> m, 1u);
+                Mips[m].resize(size_t{MipWidth} * size_t{MipHeight} * 4);
+                ComputeMipLevel(FineWidth, FineHeight, TEX_FORMAT_RGBA8_UNORM, Mips[m - 1].data(), FineWidth * 4, Mips[m].data(), MipWidth * 4);
+                SubResources[m] = TextureSubResData{Mips[m].data(), MipWidth * 4};
+            }
+
+            TextureData TexData{SubResources.data(), TexDesc.MipLevels};
+
+            RefCntAutoPtr<ITexture> pAtlas;
+            pDevice->CreateTexture(TexDesc, &TexData, &pAtlas);
+            if (!pAtlas)
+            {
+                LOG_ERROR_MESSAGE("Failed to create texture atlas. The textures will be loaded individually.");
+                for (size_t i = 0; i < TexIndices.size(); ++i)
+                {
+                    if (Regions[i].IsPacked)
+                        TextureUVScaleBias[TexIndices[i]] = float4{1, 1, 0, 0};
+                }
+                break;
+            }
+
+            RefCntAutoPtr<ISampler> pSampler;
+            if (sampler_it.first == -1)
+                pDevice->CreateSampler(Sam_LinearWrap, &pSampler);
+            else
+                pSampler = TextureSamplers[sampler_it.first];
+            pAtlas->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)->SetSampler(pSampler);
+
+            for (size_t i = 0; i < TexIndices.size(); ++i)
+            {
+                if (Regions[i].IsPacked)
+                    AtlasTextures[TexIndices[i]] = pAtlas;
+            }
+
+            // Textures that don't fit are packed into the next atlas
+            TexIndices.swap(RemainingTextures);
+        }
+    }
+
+    return AtlasTextures;
+}
+
+namespace Callbacks
+{
+bool DecodeGLTFImage(IDataBlob* pEncodedData, tinygltf::Image& gltf_image);
+} // namespace Callbacks
+
+void Model::LoadTextures(IRenderDevice*                               pDevice,
+                         IDeviceContext*                              pCtx,
+                         const tinygltf::Model&                       gltf_model,
+                         const std::string&                           BaseDir,
+                         TextureCacheType*                            pTextureCache,
+                         const TextureCompressionSettings&            Compression,
+                         const TextureAtlasSettings&                  Atlas,
+                         const std::vector<size_t>&                   CompressedImageHashes,
+                         const std::vector<RefCntAutoPtr<IDataBlob>>& EncodedImages)
+{
+    TextureUVScaleBias.assign(gltf_model.textures.size(), float4{1, 1, 0, 0});
+
+    std::vector<RefCntAutoPtr<ITexture>> AtlasTextures;
+    if (Atlas.Enabled)
+        AtlasTextures = LoadTextureAtlases(pDevice, gltf_model, Atlas);
+
     std::vector<ITexture*> NewTextures;
     for (const tinygltf::Texture& gltf_tex : gltf_model.textures)
     {
         const tinygltf::Image& gltf_image = gltf_model.images[gltf_tex.source];
 
+        // Packed textures are model-specific and are not added to the texture cache
+        if (!AtlasTextures.empty() && AtlasTextures[Textures.size()])
+        {
+            auto& pAtlas = AtlasTextures[Textures.size()];
+            if (std::find(NewTextures.begin(), NewTextures.end(), pAtlas.RawPtr()) == NewTextures.end())
+                NewTextures.emplace_back(pAtlas);
+            Textures.push_back(pAtlas);
+            continue;
+        }
+
         RefCntAutoPtr<ITexture> pTexture;
         if (pTextureCache != nullptr)
         {
@@ -689,16 +1290,81 @@ void Model::LoadTextures(IRenderDevice*         pDevice,
             // Check if the texture is used in an alpha-cut material
             float AlphaCutoff = GetTextureAlphaCutoffValue(gltf_model, static_cast<int>(Textures.size()));
 
+            bool IsStreamed = false;
             if (gltf_image.width > 0 && gltf_image.height > 0)
             {
-                pTexture = TextureFromGLTFImage(pDevice, pCtx, gltf_image, pSampler, AlphaCutoff);
-                pCtx->GenerateMips(pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+                if (Compression.Enabled)
+                {
+                    const auto CompressMode = GetTextureCompressMode(gltf_model, static_cast<int>(Textures.size()), Compression.HighQuality);
+
+                    // The block format depends on the role of the texture, and the texels on the alpha cutoff
+                    // of its material, so the same image may be cached in several versions
+                    std::string CacheFile;
+                    const auto  ImageIndex = static_cast<size_t>(gltf_tex.source);
+                    if (ImageIndex < CompressedImageHashes.size() && CompressedImageHashes[ImageIndex] != 0)
+                    {
+                        CacheFile = GetCompressedImageCachePath(Compression, CompressedImageHashes[ImageIndex], CompressMode, AlphaCutoff);
+                        if (FileSystem::FileExists(CacheFile.c_str()))
+                        {
+                            TextureLoadInfo LoadInfo;
+                            LoadInfo.Name = "GLTF Texture";
+                            CreateTextureFromFile(CacheFile.c_str(), LoadInfo, pDevice, &pTexture);
+                            if (pTexture)
+                                pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)->SetSampler(pSampler);
+                        }
+                    }
+
+                    if (!pTexture)
+                        pTexture = CompressedTextureFromGLTFImage(pDevice, gltf_image, pSampler, AlphaCutoff, CompressMode, CacheFile);
+                }
+
+                if (!pTexture && pTextureStreamer != nullptr)
+                {
+                    // The streamer creates the texture with the coarse levels only. When the detailed levels are
+                    // needed, it decodes the encoded image again rather than keeping the decoded data in memory.
+                    std::vector<Uint8> RGBA;
+
+                    const auto* pRGBAData = GetGLTFImageRGBAData(gltf_image, AlphaCutoff, RGBA);
+
+                    TextureStreamer::SourceLoaderType LoadSource;
+                    size_t                            SourceSize = 0;
+
+                    const auto ImageIndex = static_cast<size_t>(gltf_tex.source);
+                    if (ImageIndex < EncodedImages.size() && EncodedImages[ImageIndex])
+                    {
+                        RefCntAutoPtr<IDataBlob> pEncodedData = EncodedImages[ImageIndex];
+
+                        SourceSize = pEncodedData->GetSize();
+                        LoadSource = [pEncodedData, AlphaCutoff](std::vector<Uint8>& SrcRGBA) mutable //
+                        {
+                            tinygltf::Image DecodedImage;
+                            if (!Callbacks::DecodeGLTFImage(pEncodedData, DecodedImage))
+                                return false;
+
+                            std::vector<Uint8> ExpandedRGBA;
+                            if (GetGLTFImageRGBAData(DecodedImage, AlphaCutoff, ExpandedRGBA) == DecodedImage.image.data())
+                                SrcRGBA = std::move(DecodedImage.image);
+                            else
+                                SrcRGBA = std::move(ExpandedRGBA);
+                            return true;
+                        };
+                    }
+
+                    pTexture   = pTextureStreamer->CreateTexture(*this, static_cast<Uint32>(Textures.size()),
+                                                               static_cast<Uint32>(gltf_image.width), static_cast<Uint32>(gltf_image.height),
+                                                               pRGBAData, pSampler, std::move(LoadSource), SourceSize);
+                    IsStreamed = true;
+                }
+                else if (!pTexture)
+                {
+                    pTexture = TextureFromGLTFImage(pDevice, pCtx, gltf_image, pSampler, AlphaCutoff);
+                    pCtx->GenerateMips(pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+                }
             }
             else if (gltf_image.pixel_type == IMAGE_FILE_FORMAT_DDS || gltf_image.pixel_type == IMAGE_FILE_FORMAT_KTX)
             {
-                // Create the texture from raw bits
-                RefCntAutoPtr<DataBlobImpl> pRawData(MakeNewRCObj<DataBlobImpl>()(gltf_image.image.size()));
-                memcpy(pRawData->GetDataPtr(), gltf_image.image.data(), gltf_image.image.size());
+                // Create the texture from raw bits. The subresources reference the image data directly.
+                RefCntAutoPtr<ProxyDataBlob> pRawData(MakeNewRCObj<ProxyDataBlob>()(gltf_image.image.data(), gltf_image.image.size()));
                 switch (gltf_image.pixel_type)
                 {
                     case IMAGE_FILE_FORMAT_DDS:
@@ -712,12 +1378,17 @@ void Model::LoadTextures(IRenderDevice*         pDevice,
                     default:
                         UNEXPECTED("Unknown raw image format");
                 }
+
+                // Compressed images loaded from the cache must use the sampler of the texture as well
+                if (pTexture)
+                    pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)->SetSampler(pSampler);
             }
 
             VERIFY_EXPR(pTexture);
             NewTextures.emplace_back(pTexture);
 
-            if (pTextureCache != nullptr)
+            // Streamed textures are replaced in this model only and can't be shared
+            if (pTextureCache != nullptr && !IsStreamed)
             {
                 pTextureCache->emplace(BaseDir + gltf_image.uri, pTexture);
             }
@@ -818,6 +1489,7 @@ void Model::LoadMaterials(const tinygltf::Model& gltf_model)
             {
                 Mat.pBaseColorTexture      = Textures[base_color_tex_it->second.TextureIndex()];
                 Mat.TexCoordSets.BaseColor = static_cast<Uint8>(base_color_tex_it->second.TextureTexCoord());
+                Mat.UVScaleBias.BaseColor  = TextureUVScaleBias[base_color_tex_it->second.TextureIndex()];
             }
         }
 
@@ -827,6 +1499,7 @@ void Model::LoadMaterials(const tinygltf::Model& gltf_model)
             {
                 Mat.pMetallicRoughnessTexture      = Textures[metal_rough_tex_it->second.TextureIndex()];
                 Mat.TexCoordSets.MetallicRoughness = static_cast<Uint8>(metal_rough_tex_it->second.TextureTexCoord());
+                Mat.UVScaleBias.MetallicRoughness  = TextureUVScaleBias[metal_rough_tex_it->second.TextureIndex()];
             }
         }
 
@@ -860,6 +1533,7 @@ void Model::LoadMaterials(const tinygltf::Model& gltf_model)
             {
                 Mat.pNormalTexture      = Textures[normal_tex_it->second.TextureIndex()];
                 Mat.TexCoordSets.Normal = static_cast<Uint8>(normal_tex_it->second.TextureTexCoord());
+                Mat.UVScaleBias.Normal  = TextureUVScaleBias[normal_tex_it->second.TextureIndex()];
             }
         }
 
@@ -869,6 +1543,7 @@ void Model::LoadMaterials(const tinygltf::Model& gltf_model)
             {
                 Mat.pEmissiveTexture      = Textures[emssive_tex_it->second.TextureIndex()];
                 Mat.TexCoordSets.Emissive = static_cast<Uint8>(emssive_tex_it->second.TextureTexCoord());
+                Mat.UVScaleBias.Emissive  = TextureUVScaleBias[emssive_tex_it->second.TextureIndex()];
             }
         }
 
@@ -878,6 +1553,7 @@ void Model::LoadMaterials(const tinygltf::Model& gltf_model)
             {
                 Mat.pOcclusionTexture      = Textures[occlusion_tex_it->second.TextureIndex()];
                 Mat.TexCoordSets.Occlusion = static_cast<Uint8>(occlusion_tex_it->second.TextureTexCoord());
+                Mat.UVScaleBias.Occlusion  = TextureUVScaleBias[occlusion_tex_it->second.TextureIndex()];
             }
         }
 
@@ -933,6 +1609,7 @@ void Model::LoadMaterials(const tinygltf::Model& gltf_model)
                 {
                     auto index                               = ext_it->second.Get("specularGlossinessTexture").Get("index");
                     Mat.extension.pSpecularGlossinessTexture = Textures[index.Get<int>()];
+                    Mat.UVScaleBias.SpecularGlossiness       = TextureUVScaleBias[index.Get<int>()];
                     auto texCoordSet                         = ext_it->second.Get("specularGlossinessTexture").Get("texCoord");
                     Mat.TexCoordSets.SpecularGlossiness      = static_cast<Uint8>(texCoordSet.Get<int>());
                     Mat.workflow                             = Material::PbrWorkflow::SpecularGlossiness;
@@ -942,6 +1619,7 @@ void Model::LoadMaterials(const tinygltf::Model& gltf_model)
                 {
                     auto index                    = ext_it->second.Get("diffuseTexture").Get("index");
                     Mat.extension.pDiffuseTexture = Textures[index.Get<int>()];
+                    Mat.UVScaleBias.Diffuse       = TextureUVScaleBias[index.Get<int>()];
                 }
 
                 if (ext_it->second.Has("diffuseFactor"))
@@ -1119,11 +1797,137 @@ namespace
 
 struct ImageLoaderData
 {
-    Model::TextureCacheType*              pTextureCache;
-    std::vector<RefCntAutoPtr<ITexture>>* pTextureHold;
+    Model::TextureCacheType*              pTextureCache = nullptr;
+    std::vector<RefCntAutoPtr<ITexture>>* pTextureHold  = nullptr;
     std::string                           BaseDir;
+
+    const Model::TextureCompressionSettings* pCompression = nullptr;
+
+    // Hashes of the encoded images that are compressed to the cache directory, indexed by the image index.
+    // Zero for images that are not cached.
+    std::vector<size_t> CompressedImageHashes;
+
+    // Encoded images that the texture streamer decodes again when it streams in the detailed
+    // mip levels, indexed by the image index. Only kept if KeepEncodedImages is true.
+    bool                                  KeepEncodedImages = false;
+    std::vector<RefCntAutoPtr<IDataBlob>> EncodedImages;
+
+    // Queue that decodes the images while the file is parsed
+    ImageDecodeQueue*                 pDecodeQueue = nullptr;
+    std::unique_ptr<ImageDecodeQueue> pOwnDecodeQueue;
+
+    struct PendingImage
+    {
+        int    ImageIndex;
+        Uint32 JobId;
+        int    ReqWidth;
+        int    ReqHeight;
+    };
+    std::vector<PendingImage> PendingImages;
 };
 
+// Initializes the GLTF image with the decoded image
+bool InitGLTFImage(tinygltf::Image& gltf_image,
+                   const int        gltf_image_idx,
+                   Image*           pImage,
+                   int              req_width,
+                   int              req_height,
+                   std::string*     error)
+{
+    const auto& ImgDesc = pImage->GetDesc();
+
+    if (req_width > 0)
+    {
+        if (static_cast<Uint32>(req_width) != ImgDesc.Width)
+        {
+            if (error != nullptr)
+            {
+                (*error) += FormatString("Image width mismatch for image[",
+                                         gltf_image_idx, "] name = '", gltf_image.name,
+                                         "': requested width: ",
+                                         req_width, ", actual width: ",
+                                         ImgDesc.Width);
+            }
+            return false;
+        }
+    }
+
+    if (req_height > 0)
+    {
+        if (static_cast<Uint32>(req_height) != ImgDesc.Height)
+        {
+            if (error != nullptr)
+            {
+                (*error) += FormatString("Image height mismatch for image[",
+                                         gltf_image_idx, "] name = '", gltf_image.name,
+                                         "': requested height: ",
+                                         req_height, ", actual height: ",
+                                         ImgDesc.Height);
+            }
+            return false;
+        }
+    }
+
+    gltf_image.width      = ImgDesc.Width;
+    gltf_image.height     = ImgDesc.Height;
+    gltf_image.component  = 4;
+    gltf_image.bits       = GetValueSize(ImgDesc.ComponentType) * 8;
+    gltf_image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+    auto DstRowSize       = gltf_image.width * gltf_image.component * (gltf_image.bits / 8);
+    gltf_image.image.resize(static_cast<size_t>(gltf_image.height * DstRowSize));
+    auto*        pPixelsBlob = pImage->GetData();
+    const Uint8* pSrcPixels  = reinterpret_cast<const Uint8*>(pPixelsBlob->GetDataPtr());
+    if (ImgDesc.NumComponents == 3)
+    {
+        for (Uint32 row = 0; row < ImgDesc.Height; ++row)
+        {
+            for (Uint32 col = 0; col < ImgDesc.Width; ++col)
+            {
+                Uint8*       DstPixel = gltf_image.image.data() + DstRowSize * row + col * gltf_image.component;
+                const Uint8* SrcPixel = pSrcPixels + ImgDesc.RowStride * row + col * ImgDesc.NumComponents;
+
+                DstPixel[0] = SrcPixel[0];
+                DstPixel[1] = SrcPixel[1];
+                DstPixel[2] = SrcPixel[2];
+                DstPixel[3] = 255;
+            }
+        }
+    }
+    else if (ImgDesc.NumComponents == 1 || ImgDesc.NumComponents == 2)
+    {
+        // Grayscale image with optional alpha
+        for (Uint32 row = 0; row < ImgDesc.Height; ++row)
+        {
+            for (Uint32 col = 0; col < ImgDesc.Width; ++col)
+            {
+                Uint8*       DstPixel = gltf_image.image.data() + DstRowSize * row + col * gltf_image.component;
+                const Uint8* SrcPixel = pSrcPixels + ImgDesc.RowStride * row + col * ImgDesc.NumComponents;
+
+                DstPixel[0] = SrcPixel[0];
+                DstPixel[1] = SrcPixel[0];
+                DstPixel[2] = SrcPixel[0];
+                DstPixel[3] = ImgDesc.NumComponents == 2 ? SrcPixel[1] : 255;
+            }
+        }
+    }
+    else if (ImgDesc.NumComponents == 4)
+    {
+        for (Uint32 row = 0; row < ImgDesc.Height; ++row)
+        {
+            memcpy(gltf_image.image.data() + DstRowSize * row, pSrcPixels + ImgDesc.RowStride * row, DstRowSize);
+        }
+    }
+    else
+    {
+        if (error != nullptr)
+        {
+            *error += FormatString("Unexpected number of image comonents (", ImgDesc.NumComponents, ")");
+        }
+        return false;
+    }
+
+    return true;
+}
 
 bool LoadImageData(tinygltf::Image*     gltf_image,
                    const int            gltf_image_idx,
@@ -1178,7 +1982,19 @@ bool LoadImageData(tinygltf::Image*     gltf_image,
         return false;
     }
 
-    if (LoadInfo.Format == IMAGE_FILE_FORMAT_DDS || LoadInfo.Format == IMAGE_FILE_FORMAT_KTX)
+    const bool IsRawImage = LoadInfo.Format == IMAGE_FILE_FORMAT_DDS || LoadInfo.Format == IMAGE_FILE_FORMAT_KTX;
+    if (!IsRawImage && pLoaderData != nullptr && pLoaderData->pCompression != nullptr &&
+        pLoaderData->pCompression->Enabled && !pLoaderData->pCompression->CacheDir.empty())
+    {
+        // The textures that use the image are not known until the file is parsed, so LoadTextures()
+        // looks up the compressed textures in the cache or compresses the image and writes them there
+        auto& CompressedImageHashes = pLoaderData->CompressedImageHashes;
+        if (static_cast<size_t>(gltf_image_idx) >= CompressedImageHashes.size())
+            CompressedImageHashes.resize(gltf_image_idx + 1);
+        CompressedImageHashes[gltf_image_idx] = std::max(ComputeHashRaw(image_data, static_cast<size_t>(size)), size_t{1});
+    }
+
+    if (IsRawImage)
     {
         // Store binary data directly
         gltf_image->image.resize(size);
@@ -1190,87 +2006,41 @@ bool LoadImageData(tinygltf::Image*     gltf_image,
     {
         RefCntAutoPtr<DataBlobImpl> pImageData(MakeNewRCObj<DataBlobImpl>()(size));
         memcpy(pImageData->GetDataPtr(), image_data, size);
-        RefCntAutoPtr<Image> pImage;
-        Image::CreateFromDataBlob(pImageData, LoadInfo, &pImage);
-        if (!pImage)
-        {
-            if (error != nullptr)
-            {
-                *error += FormatString("Failed to load image[", gltf_image_idx, "] name = '", gltf_image->name, "'");
-            }
-            return false;
-        }
-        const auto& ImgDesc = pImage->GetDesc();
 
-        if (req_width > 0)
+        if (pLoaderData != nullptr && pLoaderData->KeepEncodedImages)
         {
-            if (static_cast<Uint32>(req_width) != ImgDesc.Width)
-            {
-                if (error != nullptr)
-                {
-                    (*error) += FormatString("Image width mismatch for image[",
-                                             gltf_image_idx, "] name = '", gltf_image->name,
-                                             "': requested width: ",
-                                             req_width, ", actual width: ",
-                                             ImgDesc.Width);
-                }
-                return false;
-            }
+            auto& EncodedImages = pLoaderData->EncodedImages;
+            if (static_cast<size_t>(gltf_image_idx) >= EncodedImages.size())
+                EncodedImages.resize(gltf_image_idx + 1);
+            EncodedImages[gltf_image_idx] = pImageData;
         }
 
-        if (req_height > 0)
+        if (pLoaderData != nullptr)
         {
-            if (static_cast<Uint32>(req_height) != ImgDesc.Height)
+            // Decode the image in the background. Model::LoadFromFile() waits for the image
+            // after the file is parsed and initializes it with InitGLTFImage().
+            if (pLoaderData->pDecodeQueue == nullptr)
             {
-                if (error != nullptr)
-                {
-                    (*error) += FormatString("Image height mismatch for image[",
-                                             gltf_image_idx, "] name = '", gltf_image->name,
-                                             "': requested height: ",
-                                             req_height, ", actual height: ",
-                                             ImgDesc.Height);
-                }
-                return false;
+                pLoaderData->pOwnDecodeQueue.reset(new ImageDecodeQueue);
+                pLoaderData->pDecodeQueue = pLoaderData->pOwnDecodeQueue.get();
             }
+            auto JobId = pLoaderData->pDecodeQueue->Enqueue(pImageData, LoadInfo);
+            pLoaderData->PendingImages.push_back({gltf_image_idx, JobId, req_width, req_height});
+            return true;
         }
 
-        gltf_image->width      = ImgDesc.Width;
-        gltf_image->height     = ImgDesc.Height;
-        gltf_image->component  = 4;
-        gltf_image->bits       = GetValueSize(ImgDesc.ComponentType) * 8;
-        gltf_image->pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
-        auto DstRowSize        = gltf_image->width * gltf_image->component * (gltf_image->bits / 8);
-        gltf_image->image.resize(static_cast<size_t>(gltf_image->height * DstRowSize));
-        auto*        pPixelsBlob = pImage->GetData();
-        const Uint8* pSrcPixels  = reinterpret_cast<const Uint8*>(pPixelsBlob->GetDataPtr());
-        if (ImgDesc.NumComponents == 3)
-        {
-            for (Uint32 row = 0; row < ImgDesc.Height; ++row)
-            {
-                for (Uint32 col = 0; col < ImgDesc.Width; ++col)
-                {
-                    Uint8*       DstPixel = gltf_image->image.data() + DstRowSize * row + col * gltf_image->component;
-                    const Uint8* SrcPixel = pSrcPixels + ImgDesc.RowStride * row + col * ImgDesc.NumComponents;
-
-                    DstPixel[0] = SrcPixel[0];
-                    DstPixel[1] = SrcPixel[1];
-                    DstPixel[2] = SrcPixel[2];
-                    DstPixel[3] = 1;
-                }
-            }
-        }
-        else if (gltf_image->component == 4)
+        RefCntAutoPtr<Image> pImage;
+        Image::CreateFromDataBlob(pImageData, LoadInfo, &pImage);
+        if (!pImage)
         {
-            for (Uint32 row = 0; row < ImgDesc.Height; ++row)
+            if (error != nullptr)
             {
-                memcpy(gltf_image->image.data() + DstRowSize * row, pSrcPixels + ImgDesc.RowStride * row, DstRowSize);
+                *error += FormatString("Failed to load image[", gltf_image_idx, "] name = '", gltf_image->name, "'");
             }
-        }
-        else
-        {
-            *error += FormatString("Unexpected number of image comonents (", ImgDesc.NumComponents, ")");
             return false;
         }
+
+        return InitGLTFImage(*gltf_image, gltf_image_idx, pImage, req_width, req_height, error);
     }
 
     return true;
@@ -1314,28 +2084,57 @@ bool ReadWholeFile(std::vector<unsigned char>* out,
 
 } // namespace
 
+// Decodes the image that was kept by LoadImageData() and initializes the GLTF image with it
+bool DecodeGLTFImage(IDataBlob* pEncodedData, tinygltf::Image& gltf_image)
+{
+    ImageLoadInfo LoadInfo;
+    LoadInfo.Format = Image::GetFileFormat(static_cast<const Uint8*>(pEncodedData->GetConstDataPtr()), pEncodedData->GetSize());
+
+    RefCntAutoPtr<Image> pImage;
+    Image::CreateFromDataBlob(pEncodedData, LoadInfo, &pImage);
+    if (!pImage)
+        return false;
+
+    return InitGLTFImage(gltf_image, 0, pImage, 0, 0, nullptr);
+}
+
 } // namespace Callbacks
 
-void Model::LoadFromFile(IRenderDevice*     pDevice,
-                         IDeviceContext*    pContext,
-                         const std::string& filename,
-                         TextureCacheType*  pTextureCache)
+void Model::LoadFromFile(IRenderDevice*    pDevice,
+                         IDeviceContext*   pContext,
+                         const CreateInfo& CI)
 {
+    const auto& filename      = CI.FileName;
+    auto* const pTextureCache = CI.pTextureCache;
+
     tinygltf::Model    gltf_model;
     tinygltf::TinyGLTF gltf_context;
 
     std::vector<RefCntAutoPtr<ITexture>> TextureHold;
 
-    Callbacks::ImageLoaderData LoaderData //
-        {
-            pTextureCache,
-            &TextureHold //
-        };
+    Callbacks::ImageLoaderData LoaderData;
+    LoaderData.pTextureCache = pTextureCache;
+    LoaderData.pTextureHold  = &TextureHold;
+
+    LoaderData.KeepEncodedImages = CI.pTextureStreamer != nullptr;
 
     if (filename.find_last_of("/\\") != std::string::npos)
         LoaderData.BaseDir = filename.substr(0, filename.find_last_of("/\\"));
     LoaderData.BaseDir += '/';
 
+    if (CI.TextureCompression.Enabled)
+    {
+        LoaderData.pCompression = &CI.TextureCompression;
+
+        const auto& CacheDir = CI.TextureCompression.CacheDir;
+        if (!CacheDir.empty() && !FileSystem::PathExists(CacheDir.c_str()) && !FileSystem::CreateDirectory(CacheDir.c_str()))
+        {
+            LOG_WARNING_MESSAGE("Failed to create compressed texture cache directory ", CacheDir);
+        }
+    }
+
+    LoaderData.pDecodeQueue = CI.pImageDecodeQueue;
+
     gltf_context.SetImageLoader(Callbacks::LoadImageData, &LoaderData);
     tinygltf::FsCallbacks fsCallbacks = {};
     fsCallbacks.ExpandFilePath        = tinygltf::ExpandFilePath;
@@ -1360,6 +2159,26 @@ void Model::LoadFromFile(IRenderDevice*     pDevice,
         fileLoaded = gltf_context.LoadBinaryFromFile(&gltf_model, &error, &warning, filename.c_str());
     else
         fileLoaded = gltf_context.LoadASCIIFromFile(&gltf_model, &error, &warning, filename.c_str());
+
+    // Wait for the images even if the file failed to load, so that no jobs are left in a shared queue
+    for (const auto& Pending : LoaderData.PendingImages)
+    {
+        auto pImage = LoaderData.pDecodeQueue->WaitForImage(Pending.JobId);
+        if (!fileLoaded)
+            continue;
+
+        auto& gltf_image = gltf_model.images[Pending.ImageIndex];
+        if (!pImage)
+        {
+            error += FormatString("Failed to load image[", Pending.ImageIndex, "] name = '", gltf_image.name, "'");
+            fileLoaded = false;
+        }
+        else if (!Callbacks::InitGLTFImage(gltf_image, Pending.ImageIndex, pImage, Pending.ReqWidth, Pending.ReqHeight, &error))
+        {
+            fileLoaded = false;
+        }
+    }
+
     if (!fileLoaded)
     {
         LOG_ERROR_AND_THROW("Failed to load gltf file ", filename, ": ", error);
@@ -1374,7 +2193,8 @@ void Model::LoadFromFile(IRenderDevice*     pDevice,
     std::vector<VertexAttribs1> VertexData1;
 
     LoadTextureSamplers(pDevice, gltf_model);
-    LoadTextures(pDevice, pContext, gltf_model, LoaderData.BaseDir, pTextureCache);
+    LoadTextures(pDevice, pContext, gltf_model, LoaderData.BaseDir, pTextureCache, CI.TextureCompression, CI.TextureAtlas,
+                 LoaderData.CompressedImageHashes, LoaderData.EncodedImages);
     LoadMaterials(gltf_model);
 
     // TODO: scene handling with no default scene
@@ -1382,7 +2202,7 @@ void Model::LoadFromFile(IRenderDevice*     pDevice,
     for (size_t i = 0; i < scene.nodes.size(); i++)
     {
         const tinygltf::Node node = gltf_model.nodes[scene.nodes[i]];
-        LoadNode(pDevice, nullptr, node, scene.nodes[i], gltf_model, IndexBuffer, VertexData0, VertexData1);
+        LoadNode(pDevice, nullptr, node, scene.nodes[i], gltf_model, CI, IndexBuffer, VertexData0, VertexData1);
     }
 
     if (gltf_model.animations.size() > 0)
@@ -1391,31 +2211,30 @@ void Model::LoadFromFile(IRenderDevice*     pDevice,
     }
     LoadSkins(gltf_model);
 
+    // Assign skins
     for (auto* node : LinearNodes)
     {
-        // Assign skins
         if (node->SkinIndex >= 0)
         {
             node->_Skin = Skins[node->SkinIndex].get();
         }
-
-        // Initial pose
-        if (node->_Mesh)
-        {
-            node->Update();
-        }
     }
 
+    // Initial pose
+    UpdateNodeTransforms(LinearNodes);
+
 
     Extensions = gltf_model.extensionsUsed;
 
     {
         VERIFY_EXPR(!VertexData0.empty());
         BufferDesc VBDesc;
-        VBDesc.Name          = "GLTF vertex attribs 0 buffer";
-        VBDesc.uiSizeInBytes = static_cast<Uint32>(VertexData0.size() * sizeof(VertexData0[0]));
-        VBDesc.BindFlags     = BIND_VERTEX_BUFFER;
-        VBDesc.Usage         = USAGE_IMMUTABLE;
+        VBDesc.Name              = "GLTF vertex attribs 0 buffer";
+        VBDesc.uiSizeInBytes     = static_cast<Uint32>(VertexData0.size() * sizeof(VertexData0[0]));
+        VBDesc.BindFlags         = BIND_VERTEX_BUFFER | BIND_SHADER_RESOURCE;
+        VBDesc.Usage             = USAGE_IMMUTABLE;
+        VBDesc.Mode              = BUFFER_MODE_FORMATTED;
+        VBDesc.ElementByteStride = sizeof(float);
 
         BufferData BuffData(VertexData0.data(), VBDesc.uiSizeInBytes);
         pDevice->CreateBuffer(VBDesc, &BuffData, &pVertexBuffer[0]);
@@ -1424,10 +2243,12 @@ void Model::LoadFromFile(IRenderDevice*     pDevice,
     {
         VERIFY_EXPR(!VertexData1.empty());
         BufferDesc VBDesc;
-        VBDesc.Name          = "GLTF vertex attribs 1 buffer";
-        VBDesc.uiSizeInBytes = static_cast<Uint32>(VertexData1.size() * sizeof(VertexData1[0]));
-        VBDesc.BindFlags     = BIND_VERTEX_BUFFER;
-        VBDesc.Usage         = USAGE_IMMUTABLE;
+        VBDesc.Name              = "GLTF vertex attribs 1 buffer";
+        VBDesc.uiSizeInBytes     = static_cast<Uint32>(VertexData1.size() * sizeof(VertexData1[0]));
+        VBDesc.BindFlags         = BIND_VERTEX_BUFFER | BIND_SHADER_RESOURCE;
+        VBDesc.Usage             = USAGE_IMMUTABLE;
+        VBDesc.Mode              = BUFFER_MODE_FORMATTED;
+        VBDesc.ElementByteStride = sizeof(float4);
 
         BufferData BuffData(VertexData1.data(), VBDesc.uiSizeInBytes);
         pDevice->CreateBuffer(VBDesc, &BuffData, &pVertexBuffer[1]);
@@ -1457,7 +2278,7 @@ void Model::CalculateBoundingBox(Node* node, const Node* parent)
     {
         if (node->_Mesh->IsValidBB)
         {
-            node->AABB = node->_Mesh->BB.Transform(node->GetMatrix());
+            node->AABB = node->_Mesh->BB.Transform(node->GlobalMatrix);
             if (node->Children.empty())
             {
                 node->BVH.Min    = node->AABB.Min;
@@ -1503,19 +2324,89 @@ void Model::GetSceneDimensions()
     AABBTransform[3][2] = dimensions.min[2];
 }
 
-void Model::UpdateAnimation(Uint32 index, float time)
+Node* Model::FindNode(Node* parent, Uint32 index)
+{
+    Node* nodeFound = nullptr;
+    if (parent->Index == index)
+    {
+        return parent;
+    }
+    for (auto& child : parent->Children)
+    {
+        nodeFound = FindNode(child.get(), index);
+        if (nodeFound)
+        {
+            break;
+        }
+    }
+    return nodeFound;
+}
+
+
+Node* Model::NodeFromIndex(uint32_t index)
+{
+    Node* nodeFound = nullptr;
+    for (auto& node : Nodes)
+    {
+        nodeFound = FindNode(node.get(), index);
+        if (nodeFound)
+        {
+            break;
+        }
+    }
+    return nodeFound;
+}
+
+
+ModelInstance::ModelInstance(const Model& _GLTFModel) :
+    GLTFModel{_GLTFModel},
+    NodePoses(_GLTFModel.LinearNodes.size()),
+    GlobalMatrices(_GLTFModel.LinearNodes.size()),
+    MeshTransforms(_GLTFModel.LinearNodes.size())
 {
-    if (index > static_cast<Uint32>(Animations.size()) - 1)
+    ResetPose();
+}
+
+void ModelInstance::ResetPose()
+{
+    for (const auto* node : GLTFModel.LinearNodes)
+    {
+        auto& Pose       = NodePoses[node->LinearIndex];
+        Pose.Translation = node->Translation;
+        Pose.Scale       = node->Scale;
+        Pose.Rotation    = node->Rotation;
+
+        GlobalMatrices[node->LinearIndex] = node->GlobalMatrix;
+        if (node->_Mesh)
+            MeshTransforms[node->LinearIndex] = node->_Mesh->Transforms;
+    }
+}
+
+void ModelInstance::UpdateTransforms()
+{
+    ComputeNodeTransforms(
+        GLTFModel.LinearNodes,
+        [this](const Node& node) {
+            const auto& Pose = NodePoses[node.LinearIndex];
+            return ComposeLocalMatrix(node.Matrix, Pose.Translation, Pose.Rotation, Pose.Scale);
+        },
+        [this](const Node& node) -> float4x4& { return GlobalMatrices[node.LinearIndex]; },
+        [this](const Node& node) -> Mesh::TransformData& { return MeshTransforms[node.LinearIndex]; });
+}
+
+void ModelInstance::UpdateAnimation(Uint32 index, float time)
+{
+    if (index >= static_cast<Uint32>(GLTFModel.Animations.size()))
     {
         LOG_WARNING_MESSAGE("No animation with index ", index);
         return;
     }
-    Animation& animation = Animations[index];
+    const Animation& animation = GLTFModel.Animations[index];
 
     bool updated = false;
-    for (auto& channel : animation.Channels)
+    for (const auto& channel : animation.Channels)
     {
-        AnimationSampler& sampler = animation.Samplers[channel.SamplerIndex];
+        const AnimationSampler& sampler = animation.Samplers[channel.SamplerIndex];
         if (sampler.Inputs.size() > sampler.OutputsVec4.size())
         {
             continue;
@@ -1528,19 +2419,20 @@ void Model::UpdateAnimation(Uint32 index, float time)
                 float u = std::max(0.0f, time - sampler.Inputs[i]) / (sampler.Inputs[i + 1] - sampler.Inputs[i]);
                 if (u <= 1.0f)
                 {
+                    auto& Pose = NodePoses[channel.node->LinearIndex];
                     switch (channel.PathType)
                     {
                         case AnimationChannel::PATH_TYPE::TRANSLATION:
                         {
-                            float4 trans              = lerp(sampler.OutputsVec4[i], sampler.OutputsVec4[i + 1], u);
-                            channel.node->Translation = float3(trans);
+                            float4 trans     = lerp(sampler.OutputsVec4[i], sampler.OutputsVec4[i + 1], u);
+                            Pose.Translation = float3(trans);
                             break;
                         }
 
                         case AnimationChannel::PATH_TYPE::SCALE:
                         {
-                            float4 scale        = lerp(sampler.OutputsVec4[i], sampler.OutputsVec4[i + 1], u);
-                            channel.node->Scale = float3(scale);
+                            float4 scale = lerp(sampler.OutputsVec4[i], sampler.OutputsVec4[i + 1], u);
+                            Pose.Scale   = float3(scale);
                             break;
                         }
 
@@ -1558,7 +2450,7 @@ void Model::UpdateAnimation(Uint32 index, float time)
                             q2.q.z = sampler.OutputsVec4[i + 1].z;
                             q2.q.w = sampler.OutputsVec4[i + 1].w;
 
-                            channel.node->Rotation = normalize(slerp(q1, q2, u));
+                            Pose.Rotation = normalize(slerp(q1, q2, u));
                             break;
                         }
                     }
@@ -1570,48 +2462,10 @@ void Model::UpdateAnimation(Uint32 index, float time)
 
     if (updated)
     {
-        for (auto& node : Nodes)
-        {
-            node->Update();
-        }
+        UpdateTransforms();
     }
 }
 
-
-Node* Model::FindNode(Node* parent, Uint32 index)
-{
-    Node* nodeFound = nullptr;
-    if (parent->Index == index)
-    {
-        return parent;
-    }
-    for (auto& child : parent->Children)
-    {
-        nodeFound = FindNode(child.get(), index);
-        if (nodeFound)
-        {
-            break;
-        }
-    }
-    return nodeFound;
-}
-
-
-Node* Model::NodeFromIndex(uint32_t index)
-{
-    Node* nodeFound = nullptr;
-    for (auto& node : Nodes)
-    {
-        nodeFound = FindNode(node.get(), index);
-        if (nodeFound)
-        {
-            break;
-        }
-    }
-    return nodeFound;
-}
-
-
 } // namespace GLTF
 
 } // namespace Diligent
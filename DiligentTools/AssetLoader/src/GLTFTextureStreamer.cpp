@@ -0,0 +1,649 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "GLTFTextureStreamer.hpp"
+#include "GLTFLoader.hpp"
+#include "TextureLoader.h"
+#include "ThreadPool.hpp"
+#include "GraphicsAccessories.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace GLTF
+{
+
+namespace
+{
+
+// GLTF images are expanded to RGBA8 by the loader
+constexpr TEXTURE_FORMAT StreamedTextureFormat = TEX_FORMAT_RGBA8_UNORM;
+constexpr Uint32         TexelSize             = 4;
+
+Uint32 GetMipDimension(Uint32 Dim, Uint32 Mip)
+{
+    return std::max(Dim >> Mip, 1u);
+}
+
+// Computes the mip levels of the Width x Height RGBA8 image down to LastMip and passes the levels
+// [FirstMip, LastMip) to the handler. Only two levels are kept in memory at a time.
+template <typename HandlerType>
+void ComputeMipLevels(Uint32 Width, Uint32 Height, const Uint8* pRGBAData, Uint32 FirstMip, Uint32 LastMip, HandlerType&& Handler)
+{
+    std::vector<Uint8> FineLevel;
+    std::vector<Uint8> Level;
+    for (Uint32 Mip = 0; Mip < LastMip; ++Mip)
+    {
+        const auto MipWidth  = GetMipDimension(Width, Mip);
+        const auto MipHeight = GetMipDimension(Height, Mip);
+        if (Mip == 0)
+        {
+            // The next level is computed directly from the source data
+            if (FirstMip > 0)
+                continue;
+            Level.assign(pRGBAData, pRGBAData + size_t{MipWidth} * size_t{MipHeight} * TexelSize);
+        }
+        else
+        {
+            const auto  FineWidth  = GetMipDimension(Width, Mip - 1);
+            const auto  FineHeight = GetMipDimension(Height, Mip - 1);
+            const auto* pFineData  = Mip == 1 ? pRGBAData : FineLevel.data();
+
+            Level.resize(size_t{MipWidth} * size_t{MipHeight} * TexelSize);
+            ComputeMipLevel(FineWidth, FineHeight, StreamedTextureFormat,
+                            pFineData, FineWidth * TexelSize,
+                            Level.data(), MipWidth * TexelSize);
+        }
+
+        if (Mip >= FirstMip)
+        {
+            // The handler may take the level, so it is copied to compute the next one
+            if (Mip + 1 < LastMip)
+                FineLevel = Level;
+            Handler(Mip, Level);
+        }
+        else
+        {
+            FineLevel.swap(Level);
+        }
+    }
+}
+
+} // namespace
+
+struct TextureStreamer::TextureSource
+{
+    // Function that re-derives the most detailed level, or its copy if there is no such function
+    SourceLoaderType   LoadSource;
+    std::vector<Uint8> RGBA;
+
+    // System memory kept by the source
+    Uint64 Size = 0;
+};
+
+struct TextureStreamer::UploadJob
+{
+    std::shared_ptr<const TextureSource> pSource;
+
+    RefCntAutoPtr<ITexture> pNewTexture;
+
+    Uint32 Width  = 0;
+    Uint32 Height = 0;
+
+    // Mip levels [FirstMip, LastMip) are uploaded to the levels [0, LastMip - FirstMip) of the new texture
+    Uint32 FirstMip = 0;
+    Uint32 LastMip  = 0;
+
+    // Memory reserved for the new texture until it replaces the old one
+    Uint64 ReservedMemory = 0;
+
+    std::atomic<bool> Completed{false};
+};
+
+struct TextureStreamer::StreamedTexture
+{
+    Model* pModel       = nullptr;
+    Uint32 TextureIndex = 0;
+
+    Uint32 Width     = 0;
+    Uint32 Height    = 0;
+    Uint32 MipLevels = 0;
+
+    // The coarsest mip level that is always resident
+    Uint32 TailMip = 0;
+
+    std::shared_ptr<const TextureSource> pSource;
+
+    RefCntAutoPtr<ITexture> pTexture;
+    RefCntAutoPtr<ISampler> pSampler;
+
+    // The most detailed mip level of the current texture
+    Uint32 ResidentMip = 0;
+
+    // The most detailed mip level requested in the current frame
+    Uint32 FrameRequestedMip = 0;
+    Uint64 LastRequestFrame  = ~Uint64{0};
+
+    // The mip level the texture should have and the frame when it was last requested
+    Uint32 RequestedMip      = 0;
+    Uint64 RequestedMipFrame = 0;
+
+    std::shared_ptr<UploadJob> pUpload;
+};
+
+TextureStreamer::TextureStreamer(IRenderDevice*    pDevice,
+                                 IDeviceContext*   pContext,
+                                 const CreateInfo& CI) :
+    // clang-format off
+    m_CI           {CI},
+    m_pDevice      {pDevice},
+    m_pContext     {pContext},
+    m_pUploadThread{new ThreadPool{1}}
+// clang-format on
+{
+    CreateTextureUploader(pDevice, TextureUploaderDesc{}, &m_pUploader);
+    if (!m_pUploader)
+        LOG_ERROR_AND_THROW("Failed to create texture uploader");
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    m_Abort.store(true);
+
+    // Uploads that have already started wait for the render thread
+    while (m_NumActiveUploads.load() != 0)
+    {
+        m_pUploader->RenderThreadUpdate(m_pContext);
+        std::this_thread::yield();
+    }
+    m_pUploadThread.reset();
+}
+
+Uint32 TextureStreamer::ComputeRequiredMip(Uint32 Width, Uint32 Height, float ScreenSize, float MipBias)
+{
+    const auto MipLevels = ComputeMipLevelsCount(Width, Height);
+    if (ScreenSize <= 0)
+        return MipLevels - 1;
+
+    // At least one texel per pixel
+    const auto MaxDim = static_cast<float>(std::max(Width, Height));
+    const auto Mip    = std::floor(std::log2(MaxDim / ScreenSize) + MipBias);
+    return static_cast<Uint32>(std::min(std::max(Mip, 0.f), static_cast<float>(MipLevels - 1)));
+}
+
+Uint64 TextureStreamer::GetMipChainSize(Uint32 Width, Uint32 Height, Uint32 FirstMip, Uint32 MipLevels)
+{
+    Uint64 Size = 0;
+    for (Uint32 Mip = FirstMip; Mip < MipLevels; ++Mip)
+        Size += Uint64{GetMipDimension(Width, Mip)} * Uint64{GetMipDimension(Height, Mip)} * TexelSize;
+    return Size;
+}
+
+Uint64 TextureStreamer::GetResidentSize(const StreamedTexture& Tex, Uint32 ResidentMip) const
+{
+    return GetMipChainSize(Tex.Width, Tex.Height, ResidentMip, Tex.MipLevels);
+}
+
+RefCntAutoPtr<ITexture> TextureStreamer::CreateResidentTexture(const StreamedTexture& Tex, Uint32 FirstMip, const TextureData* pInitData)
+{
+    TextureDesc TexDesc;
+    TexDesc.Name      = "GLTF streamed texture";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Usage     = USAGE_DEFAULT;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+    TexDesc.Width     = GetMipDimension(Tex.Width, FirstMip);
+    TexDesc.Height    = GetMipDimension(Tex.Height, FirstMip);
+    TexDesc.Format    = StreamedTextureFormat;
+    TexDesc.MipLevels = Tex.MipLevels - FirstMip;
+
+    RefCntAutoPtr<ITexture> pTexture;
+    m_pDevice->CreateTexture(TexDesc, pInitData, &pTexture);
+    if (!pTexture)
+    {
+        LOG_ERROR_MESSAGE("Failed to create ", TexDesc.Width, "x", TexDesc.Height, " streamed texture");
+        return {};
+    }
+    pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)->SetSampler(Tex.pSampler.RawPtr<ISampler>());
+    return pTexture;
+}
+
+RefCntAutoPtr<ITexture> TextureStreamer::CreateTexture(Model&           GLTFModel,
+                                                       Uint32           TextureIndex,
+                                                       Uint32           Width,
+                                                       Uint32           Height,
+                                                       const void*      pRGBAData,
+                                                       ISampler*        pSampler,
+                                                       SourceLoaderType LoadSource,
+                                                       size_t           SourceSize)
+{
+    VERIFY_EXPR(Width > 0 && Height > 0 && pRGBAData != nullptr);
+
+    std::unique_ptr<StreamedTexture> pTex{new StreamedTexture};
+
+    auto& Tex        = *pTex;
+    Tex.pModel       = &GLTFModel;
+    Tex.TextureIndex = TextureIndex;
+    Tex.Width        = Width;
+    Tex.Height       = Height;
+    Tex.MipLevels    = ComputeMipLevelsCount(Width, Height);
+    Tex.pSampler     = pSampler;
+    while (Tex.TailMip + 1 < Tex.MipLevels && std::max(GetMipDimension(Width, Tex.TailMip), GetMipDimension(Height, Tex.TailMip)) > m_CI.MinResidentSize)
+        ++Tex.TailMip;
+
+    // Only the source of the most detailed level is kept in system memory. The other levels are
+    // computed when they are uploaded.
+    std::shared_ptr<TextureSource> pSource{new TextureSource};
+    if (LoadSource)
+    {
+        pSource->LoadSource = std::move(LoadSource);
+        pSource->Size       = SourceSize;
+    }
+    else
+    {
+        const auto* pSrc = static_cast<const Uint8*>(pRGBAData);
+        pSource->RGBA.assign(pSrc, pSrc + size_t{Width} * size_t{Height} * TexelSize);
+        pSource->Size = pSource->RGBA.size();
+    }
+    Tex.pSource = pSource;
+
+    std::vector<std::vector<Uint8>> TailLevels(Tex.MipLevels - Tex.TailMip);
+    std::vector<TextureSubResData>  SubResources(Tex.MipLevels - Tex.TailMip);
+    ComputeMipLevels(Width, Height, static_cast<const Uint8*>(pRGBAData), Tex.TailMip, Tex.MipLevels,
+                     [&](Uint32 Mip, std::vector<Uint8>& Level) //
+                     {
+                         TailLevels[Mip - Tex.TailMip].swap(Level);
+                         SubResources[Mip - Tex.TailMip] = TextureSubResData{TailLevels[Mip - Tex.TailMip].data(), GetMipDimension(Width, Mip) * TexelSize};
+                     });
+
+    TextureData InitData{SubResources.data(), static_cast<Uint32>(SubResources.size())};
+    Tex.pTexture = CreateResidentTexture(Tex, Tex.TailMip, &InitData);
+    if (!Tex.pTexture)
+        return {};
+
+    Tex.ResidentMip       = Tex.TailMip;
+    Tex.FrameRequestedMip = Tex.TailMip;
+    Tex.RequestedMip      = Tex.TailMip;
+    Tex.RequestedMipFrame = m_FrameIndex;
+
+    m_ResidentMemory += GetResidentSize(Tex, Tex.ResidentMip);
+    m_SourceMemory += pSource->Size;
+    m_Stats.FullResolutionMemory += GetResidentSize(Tex, 0);
+
+    m_TextureLookup.emplace(Tex.pTexture.RawPtr(), &Tex);
+    m_Textures.emplace_back(std::move(pTex));
+
+    return Tex.pTexture;
+}
+
+void TextureStreamer::ReleaseModel(const Model& GLTFModel)
+{
+    auto it = std::remove_if(m_Textures.begin(), m_Textures.end(),
+                             [&](const std::unique_ptr<StreamedTexture>& pTex) //
+                             {
+                                 if (pTex->pModel != &GLTFModel)
+                                     return false;
+
+                                 // A pending upload completes on the worker thread and its texture is released
+                                 if (pTex->pUpload)
+                                     m_ReservedMemory -= pTex->pUpload->ReservedMemory;
+                                 m_ResidentMemory -= GetResidentSize(*pTex, pTex->ResidentMip);
+                                 m_SourceMemory -= pTex->pSource->Size;
+                                 m_Stats.FullResolutionMemory -= GetResidentSize(*pTex, 0);
+                                 m_TextureLookup.erase(pTex->pTexture.RawPtr());
+                                 return true;
+                             });
+    m_Textures.erase(it, m_Textures.end());
+}
+
+void TextureStreamer::RequestMaterial(const Material& Mat, float ScreenSize)
+{
+    const ITexture* Textures[] = {
+        Mat.pBaseColorTexture.RawPtr(),
+        Mat.pMetallicRoughnessTexture.RawPtr(),
+        Mat.pNormalTexture.RawPtr(),
+        Mat.pOcclusionTexture.RawPtr(),
+        Mat.pEmissiveTexture.RawPtr(),
+        Mat.extension.pSpecularGlossinessTexture.RawPtr(),
+        Mat.extension.pDiffuseTexture.RawPtr() //
+    };
+    for (const auto* pTexture : Textures)
+    {
+        if (pTexture == nullptr)
+            continue;
+
+        auto it = m_TextureLookup.find(pTexture);
+        if (it == m_TextureLookup.end())
+            continue; // The texture is not streamed
+
+        auto&      Tex = *it->second;
+        const auto Mip = std::min(ComputeRequiredMip(Tex.Width, Tex.Height, ScreenSize, m_CI.MipBias), Tex.TailMip);
+
+        Tex.FrameRequestedMip = std::min(Tex.FrameRequestedMip, Mip);
+        Tex.LastRequestFrame  = m_FrameIndex;
+    }
+}
+
+void TextureStreamer::RequestModel(const Model& GLTFModel, float ScreenSize)
+{
+    for (const auto& Mat : GLTFModel.Materials)
+        RequestMaterial(Mat, ScreenSize);
+}
+
+void TextureStreamer::ReplaceTexture(StreamedTexture& Tex, ITexture* pNewTexture, Uint32 NewResidentMip)
+{
+    const auto* pOldTexture = Tex.pTexture.RawPtr();
+
+    m_ResidentMemory -= GetResidentSize(Tex, Tex.ResidentMip);
+    m_ResidentMemory += GetResidentSize(Tex, NewResidentMip);
+    m_TextureLookup.erase(pOldTexture);
+
+    auto& GLTFModel = *Tex.pModel;
+    VERIFY_EXPR(GLTFModel.Textures[Tex.TextureIndex].RawPtr() == pOldTexture);
+    GLTFModel.Textures[Tex.TextureIndex] = pNewTexture;
+    for (auto& Mat : GLTFModel.Materials)
+    {
+        RefCntAutoPtr<ITexture>* Textures[] = {
+            std::addressof(Mat.pBaseColorTexture),
+            std::addressof(Mat.pMetallicRoughnessTexture),
+            std::addressof(Mat.pNormalTexture),
+            std::addressof(Mat.pOcclusionTexture),
+            std::addressof(Mat.pEmissiveTexture),
+            std::addressof(Mat.extension.pSpecularGlossinessTexture),
+            std::addressof(Mat.extension.pDiffuseTexture) //
+        };
+        for (auto* pTexture : Textures)
+        {
+            if (pTexture->RawPtr() == pOldTexture)
+                *pTexture = pNewTexture;
+        }
+    }
+    ++GLTFModel.TexturesVersion;
+
+    Tex.pTexture    = pNewTexture;
+    Tex.ResidentMip = NewResidentMip;
+    m_TextureLookup.emplace(pNewTexture, &Tex);
+}
+
+void TextureStreamer::UpdateRequestedMip(StreamedTexture& Tex)
+{
+    if (Tex.LastRequestFrame == m_FrameIndex)
+    {
+        // More detail is requested immediately, while less detail is only requested when
+        // the more detailed level has not been needed for RequestLifetime frames
+        if (Tex.FrameRequestedMip <= Tex.RequestedMip || m_FrameIndex - Tex.RequestedMipFrame > m_CI.RequestLifetime)
+        {
+            Tex.RequestedMip      = Tex.FrameRequestedMip;
+            Tex.RequestedMipFrame = m_FrameIndex;
+        }
+    }
+    else if (m_FrameIndex - Tex.RequestedMipFrame > m_CI.RequestLifetime)
+    {
+        Tex.RequestedMip = Tex.TailMip;
+    }
+
+    Tex.FrameRequestedMip = Tex.TailMip;
+}
+
+void TextureStreamer::CompleteUploads(IDeviceContext* pContext)
+{
+    for (auto& pTex : m_Textures)
+    {
+        if (!pTex->pUpload || !pTex->pUpload->Completed.load())
+            continue;
+
+        // The uploader has recorded the copies to the new texture
+        auto pUpload = std::move(pTex->pUpload);
+        m_ReservedMemory -= pUpload->ReservedMemory;
+
+        StateTransitionDesc Barrier{pUpload->pNewTexture, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true};
+        pContext->TransitionResourceStates(1, &Barrier);
+
+        ReplaceTexture(*pTex, pUpload->pNewTexture, pUpload->FirstMip);
+        ++m_Stats.NumStreamedIn;
+    }
+}
+
+bool TextureStreamer::Evict(IDeviceContext* pContext, Uint64 RequiredMemory, const StreamedTexture* pExclude)
+{
+    // Only the levels that are no longer requested are evicted
+    std::vector<StreamedTexture*> Candidates;
+    for (auto& pTex : m_Textures)
+    {
+        if (pTex.get() != pExclude && !pTex->pUpload && pTex->ResidentMip < pTex->RequestedMip)
+            Candidates.push_back(pTex.get());
+    }
+
+    // Least recently requested textures are evicted first
+    std::sort(Candidates.begin(), Candidates.end(),
+              [](const StreamedTexture* pTex0, const StreamedTexture* pTex1) //
+              {
+                  return pTex0->RequestedMipFrame < pTex1->RequestedMipFrame;
+              });
+
+    for (auto* pTex : Candidates)
+    {
+        if (GetUsedMemory() + RequiredMemory <= m_CI.MemoryBudget)
+            break;
+
+        const auto NewResidentMip = pTex->RequestedMip;
+
+        auto pNewTexture = CreateResidentTexture(*pTex, NewResidentMip, nullptr);
+        if (!pNewTexture)
+            continue;
+
+        for (Uint32 Mip = NewResidentMip; Mip < pTex->MipLevels; ++Mip)
+        {
+            CopyTextureAttribs CopyAttribs{pTex->pTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                           pNewTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            CopyAttribs.SrcMipLevel = Mip - pTex->ResidentMip;
+            CopyAttribs.DstMipLevel = Mip - NewResidentMip;
+            pContext->CopyTexture(CopyAttribs);
+        }
+
+        // The old texture is still bound until the model's bindings are re-created
+        StateTransitionDesc Barriers[] = {
+            {pTex->pTexture, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
+            {pNewTexture, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true} //
+        };
+        pContext->TransitionResourceStates(_countof(Barriers), Barriers);
+
+        ReplaceTexture(*pTex, pNewTexture, NewResidentMip);
+        ++m_Stats.NumEvicted;
+    }
+
+    return GetUsedMemory() + RequiredMemory <= m_CI.MemoryBudget;
+}
+
+void TextureStreamer::StartUploads(IDeviceContext* pContext)
+{
+    std::vector<StreamedTexture*> Candidates;
+    for (auto& pTex : m_Textures)
+    {
+        if (!pTex->pUpload && pTex->ResidentMip > pTex->RequestedMip)
+            Candidates.push_back(pTex.get());
+    }
+
+    // Textures that miss the most detail are streamed first
+    std::sort(Candidates.begin(), Candidates.end(),
+              [](const StreamedTexture* pTex0, const StreamedTexture* pTex1) //
+              {
+                  return pTex0->ResidentMip - pTex0->RequestedMip > pTex1->ResidentMip - pTex1->RequestedMip;
+              });
+
+    for (auto* pTex : Candidates)
+    {
+        if (m_NumActiveUploads.load() >= m_CI.MaxPendingUploads)
+            break;
+
+        // Stream in as many levels as fit into the budget
+        auto   NewResidentMip = pTex->RequestedMip;
+        Uint64 RequiredMemory = 0;
+        for (; NewResidentMip < pTex->ResidentMip; ++NewResidentMip)
+        {
+            RequiredMemory = GetResidentSize(*pTex, NewResidentMip) - GetResidentSize(*pTex, pTex->ResidentMip);
+            if (GetUsedMemory() + m_ReservedMemory + RequiredMemory <= m_CI.MemoryBudget)
+                break;
+            if (Evict(pContext, m_ReservedMemory + RequiredMemory, pTex))
+                break;
+        }
+        if (NewResidentMip == pTex->ResidentMip)
+            continue;
+
+        auto pNewTexture = CreateResidentTexture(*pTex, NewResidentMip, nullptr);
+        if (!pNewTexture)
+            continue;
+
+        // Resident levels are copied right away, the missing ones are uploaded by the worker
+        for (Uint32 Mip = pTex->ResidentMip; Mip < pTex->MipLevels; ++Mip)
+        {
+            CopyTextureAttribs CopyAttribs{pTex->pTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                           pNewTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            CopyAttribs.SrcMipLevel = Mip - pTex->ResidentMip;
+            CopyAttribs.DstMipLevel = Mip - NewResidentMip;
+            pContext->CopyTexture(CopyAttribs);
+        }
+        StateTransitionDesc Barrier{pTex->pTexture, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true};
+        pContext->TransitionResourceStates(1, &Barrier);
+
+        std::shared_ptr<UploadJob> pUpload{new UploadJob};
+        pUpload->pSource        = pTex->pSource;
+        pUpload->pNewTexture    = pNewTexture;
+        pUpload->Width          = pTex->Width;
+        pUpload->Height         = pTex->Height;
+        pUpload->FirstMip       = NewResidentMip;
+        pUpload->LastMip        = pTex->ResidentMip;
+        pUpload->ReservedMemory = RequiredMemory;
+
+        pTex->pUpload = pUpload;
+        m_ReservedMemory += RequiredMemory;
+
+        m_NumActiveUploads.fetch_add(1);
+        m_pUploadThread->Enqueue(
+            [this, pUpload]() //
+            {
+                if (!m_Abort.load())
+                    UploadMipLevels(*pUpload);
+                pUpload->Completed.store(true);
+                m_NumActiveUploads.fetch_sub(1);
+            });
+    }
+}
+
+void TextureStreamer::UploadMipLevels(UploadJob& Upload)
+{
+    // The levels are derived before the upload buffer is allocated, so that the buffer is not
+    // held while the source image is decoded
+    std::vector<Uint8> LoadedRGBA;
+
+    const auto* pRGBAData = Upload.pSource->RGBA.data();
+    if (Upload.pSource->LoadSource)
+    {
+        if (!Upload.pSource->LoadSource(LoadedRGBA) || LoadedRGBA.size() != size_t{Upload.Width} * size_t{Upload.Height} * TexelSize)
+        {
+            LOG_ERROR_MESSAGE("Failed to load the source of a ", Upload.Width, "x", Upload.Height, " streamed texture");
+            return;
+        }
+        pRGBAData = LoadedRGBA.data();
+    }
+
+    std::vector<std::vector<Uint8>> Levels(Upload.LastMip - Upload.FirstMip);
+    ComputeMipLevels(Upload.Width, Upload.Height, pRGBAData, Upload.FirstMip, Upload.LastMip,
+                     [&](Uint32 Mip, std::vector<Uint8>& Level) //
+                     {
+                         Levels[Mip - Upload.FirstMip].swap(Level);
+                     });
+    LoadedRGBA.clear();
+    LoadedRGBA.shrink_to_fit();
+
+    UploadBufferDesc BuffDesc;
+    BuffDesc.Width     = GetMipDimension(Upload.Width, Upload.FirstMip);
+    BuffDesc.Height    = GetMipDimension(Upload.Height, Upload.FirstMip);
+    BuffDesc.MipLevels = Upload.LastMip - Upload.FirstMip;
+    BuffDesc.Format    = StreamedTextureFormat;
+
+    // Blocks until the render thread maps the buffer
+    RefCntAutoPtr<IUploadBuffer> pUploadBuffer;
+    m_pUploader->AllocateUploadBuffer(nullptr, BuffDesc, &pUploadBuffer);
+    if (!pUploadBuffer)
+    {
+        LOG_ERROR_MESSAGE("Failed to allocate upload buffer for streamed texture");
+        return;
+    }
+
+    for (Uint32 Mip = 0; Mip < BuffDesc.MipLevels; ++Mip)
+    {
+        const auto& Level      = Levels[Mip];
+        const auto  RowSize    = GetMipDimension(BuffDesc.Width, Mip) * TexelSize;
+        const auto  NumRows    = GetMipDimension(BuffDesc.Height, Mip);
+        const auto  MappedData = pUploadBuffer->GetMappedData(Mip, 0);
+        for (Uint32 Row = 0; Row < NumRows; ++Row)
+        {
+            memcpy(static_cast<Uint8*>(MappedData.pData) + size_t{Row} * MappedData.Stride,
+                   Level.data() + size_t{Row} * RowSize,
+                   RowSize);
+        }
+    }
+
+    m_pUploader->ScheduleGPUCopy(nullptr, Upload.pNewTexture, 0, 0, pUploadBuffer);
+    pUploadBuffer->WaitForCopyScheduled();
+    m_pUploader->RecycleBuffer(pUploadBuffer);
+}
+
+void TextureStreamer::Update(IDeviceContext* pContext)
+{
+    // Executes the maps and copies requested by the worker
+    m_pUploader->RenderThreadUpdate(pContext);
+
+    CompleteUploads(pContext);
+
+    for (auto& pTex : m_Textures)
+        UpdateRequestedMip(*pTex);
+
+    // The budget may have been exceeded by the textures of newly loaded models
+    if (GetUsedMemory() + m_ReservedMemory > m_CI.MemoryBudget)
+        Evict(pContext, m_ReservedMemory, nullptr);
+
+    StartUploads(pContext);
+
+    m_Stats.NumTextures       = static_cast<Uint32>(m_Textures.size());
+    m_Stats.NumPendingUploads = m_NumActiveUploads.load();
+    m_Stats.ResidentMemory    = m_ResidentMemory;
+    m_Stats.SourceMemory      = m_SourceMemory;
+
+    ++m_FrameIndex;
+}
+
+} // namespace GLTF
+
+} // namespace Diligent
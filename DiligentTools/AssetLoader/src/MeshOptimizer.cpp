@@ -0,0 +1,713 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#include <unordered_map>
+
+#include "MeshOptimizer.hpp"
+#include "BasicMath.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr Uint32 InvalidIndex = ~0u;
+
+size_t HashVertex(const MeshOptimizerStream* pStreams, size_t NumStreams, size_t Vertex)
+{
+    // FNV-1a
+    size_t Hash = 2166136261u;
+    for (size_t s = 0; s < NumStreams; ++s)
+    {
+        const auto* pBytes = static_cast<const Uint8*>(pStreams[s].pData) + Vertex * pStreams[s].Stride;
+        for (size_t b = 0; b < pStreams[s].Size; ++b)
+        {
+            Hash ^= pBytes[b];
+            Hash *= 16777619u;
+        }
+    }
+    return Hash;
+}
+
+bool VerticesEqual(const MeshOptimizerStream* pStreams, size_t NumStreams, size_t Vertex0, size_t Vertex1)
+{
+    for (size_t s = 0; s < NumStreams; ++s)
+    {
+        const auto* pData = static_cast<const Uint8*>(pStreams[s].pData);
+        if (memcmp(pData + Vertex0 * pStreams[s].Stride, pData + Vertex1 * pStreams[s].Stride, pStreams[s].Size) != 0)
+            return false;
+    }
+    return true;
+}
+
+// Vertex scoring parameters from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+constexpr Uint32 ForsythCacheSize     = 32;
+constexpr float  CacheDecayPower      = 1.5f;
+constexpr float  LastTriScore         = 0.75f;
+constexpr float  ValenceBoostScale    = 2.0f;
+constexpr float  ValenceBoostPower    = 0.5f;
+constexpr Uint32 MaxValenceScoreCount = 32;
+
+float ComputeVertexScore(Int32 CachePosition, Uint32 NumActiveTris)
+{
+    if (NumActiveTris == 0)
+    {
+        // No triangles need this vertex
+        return -1.f;
+    }
+
+    float Score = 0;
+    if (CachePosition >= 0)
+    {
+        if (CachePosition < 3)
+        {
+            // The vertex was used in the last triangle. Its score is fixed to discourage
+            // using the same triangle edges over and over again.
+            Score = LastTriScore;
+        }
+        else
+        {
+            VERIFY_EXPR(CachePosition < static_cast<Int32>(ForsythCacheSize));
+            const float Scaler = 1.f / static_cast<float>(ForsythCacheSize - 3);
+            Score              = std::pow(1.f - static_cast<float>(CachePosition - 3) * Scaler, CacheDecayPower);
+        }
+    }
+
+    // Bonus for vertices with few remaining triangles so that lone triangles get
+    // processed instead of being left behind
+    Score += ValenceBoostScale * std::pow(static_cast<float>(NumActiveTris), -ValenceBoostPower);
+    return Score;
+}
+
+// Symmetric 4x4 matrix of the squared distance to a set of planes, see
+// "Surface Simplification Using Quadric Error Metrics" by M. Garland and P. Heckbert
+struct Quadric
+{
+    float a2 = 0, ab = 0, ac = 0, ad = 0;
+    float b2 = 0, bc = 0, bd = 0;
+    float c2 = 0, cd = 0;
+    float d2 = 0;
+
+    // Total weight of the planes
+    float w = 0;
+
+    Quadric() noexcept {}
+
+    Quadric(const float3& N, float d, float Weight) :
+        // clang-format off
+        a2{N.x * N.x * Weight}, ab{N.x * N.y * Weight}, ac{N.x * N.z * Weight}, ad{N.x * d * Weight},
+                                b2{N.y * N.y * Weight}, bc{N.y * N.z * Weight}, bd{N.y * d * Weight},
+                                                        c2{N.z * N.z * Weight}, cd{N.z * d * Weight},
+                                                                                d2{d * d * Weight},
+        w{Weight}
+    // clang-format on
+    {}
+
+    Quadric& operator+=(const Quadric& Q)
+    {
+        a2 += Q.a2, ab += Q.ab, ac += Q.ac, ad += Q.ad;
+        b2 += Q.b2, bc += Q.bc, bd += Q.bd;
+        c2 += Q.c2, cd += Q.cd;
+        d2 += Q.d2;
+        w += Q.w;
+        return *this;
+    }
+
+    // Returns the weighted mean squared distance from the point to the planes
+    float Evaluate(const float3& P) const
+    {
+        const float rx = a2 * P.x + ab * P.y + ac * P.z + ad;
+        const float ry = ab * P.x + b2 * P.y + bc * P.z + bd;
+        const float rz = ac * P.x + bc * P.y + c2 * P.z + cd;
+        const float E  = rx * P.x + ry * P.y + rz * P.z + ad * P.x + bd * P.y + cd * P.z + d2;
+        return w > 0 ? std::abs(E) / w : 0;
+    }
+};
+
+} // namespace
+
+Uint32 GenerateVertexRemap(Uint32*                    pRemap,
+                           const Uint32*              pIndices,
+                           size_t                     IndexCount,
+                           size_t                     VertexCount,
+                           const MeshOptimizerStream* pStreams,
+                           size_t                     NumStreams)
+{
+    std::fill(pRemap, pRemap + VertexCount, InvalidIndex);
+
+    // Open-addressing hash table of the first occurrence of every unique vertex
+    size_t TableSize = 1;
+    while (TableSize < VertexCount * 2)
+        TableSize *= 2;
+    std::vector<Uint32> Table(TableSize, InvalidIndex);
+
+    Uint32 NumUniqueVertices = 0;
+    for (size_t i = 0; i < IndexCount; ++i)
+    {
+        const auto Vertex = pIndices[i];
+        VERIFY_EXPR(Vertex < VertexCount);
+        if (pRemap[Vertex] != InvalidIndex)
+            continue;
+
+        auto Bucket = HashVertex(pStreams, NumStreams, Vertex) & (TableSize - 1);
+        while (Table[Bucket] != InvalidIndex && !VerticesEqual(pStreams, NumStreams, Table[Bucket], Vertex))
+            Bucket = (Bucket + 1) & (TableSize - 1);
+
+        if (Table[Bucket] == InvalidIndex)
+        {
+            Table[Bucket]  = Vertex;
+            pRemap[Vertex] = NumUniqueVertices++;
+        }
+        else
+        {
+            pRemap[Vertex] = pRemap[Table[Bucket]];
+        }
+    }
+
+    return NumUniqueVertices;
+}
+
+void RemapIndexBuffer(Uint32* pDst, const Uint32* pIndices, size_t IndexCount, const Uint32* pRemap)
+{
+    for (size_t i = 0; i < IndexCount; ++i)
+    {
+        VERIFY_EXPR(pRemap[pIndices[i]] != InvalidIndex);
+        pDst[i] = pRemap[pIndices[i]];
+    }
+}
+
+void RemapVertexBuffer(void* pDst, const void* pVertices, size_t VertexCount, size_t VertexStride, const Uint32* pRemap)
+{
+    auto*       pDstBytes = static_cast<Uint8*>(pDst);
+    const auto* pSrcBytes = static_cast<const Uint8*>(pVertices);
+    for (size_t v = 0; v < VertexCount; ++v)
+    {
+        if (pRemap[v] != InvalidIndex)
+            memcpy(pDstBytes + pRemap[v] * VertexStride, pSrcBytes + v * VertexStride, VertexStride);
+    }
+}
+
+void OptimizeVertexCache(Uint32* pDst, const Uint32* pIndices, size_t IndexCount, size_t VertexCount)
+{
+    VERIFY(IndexCount % 3 == 0, "Index count must be a multiple of 3");
+    const size_t NumTris = IndexCount / 3;
+    if (NumTris == 0)
+        return;
+
+    // Vertex-triangle adjacency
+    std::vector<Uint32> NumActiveTris(VertexCount);
+    for (size_t i = 0; i < IndexCount; ++i)
+        ++NumActiveTris[pIndices[i]];
+
+    std::vector<Uint32> AdjacencyOffsets(VertexCount + 1);
+    for (size_t v = 0; v < VertexCount; ++v)
+        AdjacencyOffsets[v + 1] = AdjacencyOffsets[v] + NumActiveTris[v];
+
+    std::vector<Uint32> AdjacentTris(IndexCount);
+    {
+        std::vector<Uint32> Fill(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < IndexCount; ++i)
+            AdjacentTris[Fill[pIndices[i]]++] = static_cast<Uint32>(i / 3);
+    }
+
+    // Precomputed scores for vertices outside of the cache
+    float ValenceScores[MaxValenceScoreCount];
+    for (Uint32 i = 0; i < MaxValenceScoreCount; ++i)
+        ValenceScores[i] = ComputeVertexScore(-1, i);
+    auto GetVertexScore = [&](Int32 CachePosition, Uint32 Valence) {
+        return CachePosition < 0 && Valence < MaxValenceScoreCount ? ValenceScores[Valence] : ComputeVertexScore(CachePosition, Valence);
+    };
+
+    std::vector<Int32> CachePositions(VertexCount, -1);
+    std::vector<float> VertexScores(VertexCount);
+    for (size_t v = 0; v < VertexCount; ++v)
+        VertexScores[v] = GetVertexScore(-1, NumActiveTris[v]);
+
+    std::vector<float> TriScores(NumTris);
+    std::vector<bool>  TriEmitted(NumTris);
+    for (size_t t = 0; t < NumTris; ++t)
+        TriScores[t] = VertexScores[pIndices[t * 3 + 0]] + VertexScores[pIndices[t * 3 + 1]] + VertexScores[pIndices[t * 3 + 2]];
+
+    Uint32 BestTri = 0;
+    for (Uint32 t = 1; t < NumTris; ++t)
+    {
+        if (TriScores[t] > TriScores[BestTri])
+            BestTri = t;
+    }
+
+    Uint32 Cache[ForsythCacheSize + 3];
+    Uint32 NewCache[ForsythCacheSize + 3];
+    Uint32 CacheSize = 0;
+
+    size_t NextUnemittedTri = 0;
+    for (size_t EmittedTris = 0; EmittedTris < NumTris; ++EmittedTris)
+    {
+        if (BestTri == InvalidIndex)
+        {
+            // Dead end: none of the cached vertices has triangles left. Continue with
+            // the next triangle in the input order.
+            while (TriEmitted[NextUnemittedTri])
+                ++NextUnemittedTri;
+            BestTri = static_cast<Uint32>(NextUnemittedTri);
+        }
+
+        const Uint32* Tri = pIndices + BestTri * 3;
+        pDst[EmittedTris * 3 + 0] = Tri[0];
+        pDst[EmittedTris * 3 + 1] = Tri[1];
+        pDst[EmittedTris * 3 + 2] = Tri[2];
+        TriEmitted[BestTri]       = true;
+
+        // Remove the triangle from the adjacency lists of its vertices
+        for (int i = 0; i < 3; ++i)
+        {
+            const auto v      = Tri[i];
+            auto*      pBegin = &AdjacentTris[AdjacencyOffsets[v]];
+            auto*      pEnd   = pBegin + NumActiveTris[v];
+            auto*      pTri   = std::find(pBegin, pEnd, BestTri);
+            VERIFY_EXPR(pTri != pEnd);
+            std::swap(*pTri, *(pEnd - 1));
+            --NumActiveTris[v];
+        }
+
+        // Move the triangle's vertices to the front of the LRU cache
+        Uint32 NewCacheSize = 0;
+        for (int i = 0; i < 3; ++i)
+            NewCache[NewCacheSize++] = Tri[i];
+        for (Uint32 i = 0; i < CacheSize; ++i)
+        {
+            const auto v = Cache[i];
+            if (v != Tri[0] && v != Tri[1] && v != Tri[2])
+                NewCache[NewCacheSize++] = v;
+        }
+
+        // Update scores of all vertices that were or are in the cache
+        BestTri            = InvalidIndex;
+        float BestTriScore = -1.f;
+        for (Uint32 i = 0; i < NewCacheSize; ++i)
+        {
+            const auto v          = NewCache[i];
+            CachePositions[v]     = i < ForsythCacheSize ? static_cast<Int32>(i) : -1;
+            const float NewScore  = GetVertexScore(CachePositions[v], NumActiveTris[v]);
+            const float ScoreDiff = NewScore - VertexScores[v];
+            VertexScores[v]       = NewScore;
+
+            for (Uint32 a = 0; a < NumActiveTris[v]; ++a)
+            {
+                const auto t = AdjacentTris[AdjacencyOffsets[v] + a];
+                TriScores[t] += ScoreDiff;
+                if (TriScores[t] > BestTriScore)
+                {
+                    BestTriScore = TriScores[t];
+                    BestTri      = t;
+                }
+            }
+        }
+
+        CacheSize = std::min(NewCacheSize, ForsythCacheSize);
+        std::copy(NewCache, NewCache + CacheSize, Cache);
+    }
+}
+
+void OptimizeOverdraw(Uint32*       pDst,
+                      const Uint32* pIndices,
+                      size_t        IndexCount,
+                      const float*  pPositions,
+                      size_t        VertexCount,
+                      size_t        PositionStride)
+{
+    VERIFY(IndexCount % 3 == 0, "Index count must be a multiple of 3");
+    const size_t NumTris = IndexCount / 3;
+    if (NumTris == 0)
+        return;
+
+    auto GetPosition = [&](Uint32 v) {
+        const auto* p = reinterpret_cast<const float*>(reinterpret_cast<const Uint8*>(pPositions) + v * PositionStride);
+        return float3{p[0], p[1], p[2]};
+    };
+
+    // Split the index buffer into clusters at hard cache boundaries
+    constexpr Uint32    FIFOSize = 16;
+    std::vector<Uint32> CacheTimestamps(VertexCount, 0);
+    std::vector<Uint32> ClusterStarts;
+    Uint32              Timestamp = FIFOSize + 1;
+    for (size_t t = 0; t < NumTris; ++t)
+    {
+        Uint32 NumMisses = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            const auto v = pIndices[t * 3 + i];
+            if (Timestamp - CacheTimestamps[v] > FIFOSize)
+            {
+                CacheTimestamps[v] = Timestamp++;
+                ++NumMisses;
+            }
+        }
+        if (t == 0 || NumMisses == 3)
+            ClusterStarts.push_back(static_cast<Uint32>(t));
+    }
+
+    float3 MeshCenter;
+    for (size_t i = 0; i < IndexCount; ++i)
+        MeshCenter += GetPosition(pIndices[i]);
+    MeshCenter /= static_cast<float>(IndexCount);
+
+    // Clusters whose area-weighted normal points away from the mesh center are likely
+    // to be visible and occlude other parts of the mesh, so they should be drawn first.
+    struct ClusterInfo
+    {
+        Uint32 FirstTri;
+        Uint32 NumTris;
+        float  SortKey;
+    };
+    std::vector<ClusterInfo> Clusters(ClusterStarts.size());
+    for (size_t c = 0; c < ClusterStarts.size(); ++c)
+    {
+        auto& Cluster    = Clusters[c];
+        Cluster.FirstTri = ClusterStarts[c];
+        Cluster.NumTris  = static_cast<Uint32>((c + 1 < ClusterStarts.size() ? ClusterStarts[c + 1] : NumTris) - Cluster.FirstTri);
+
+        float3 Centroid;
+        float3 Normal;
+        float  Area = 0;
+        for (Uint32 t = Cluster.FirstTri; t < Cluster.FirstTri + Cluster.NumTris; ++t)
+        {
+            const auto P0 = GetPosition(pIndices[t * 3 + 0]);
+            const auto P1 = GetPosition(pIndices[t * 3 + 1]);
+            const auto P2 = GetPosition(pIndices[t * 3 + 2]);
+
+            const auto  N       = cross(P1 - P0, P2 - P0);
+            const float TriArea = length(N);
+            Centroid += (P0 + P1 + P2) * (TriArea / 3.f);
+            Normal += N;
+            Area += TriArea;
+        }
+        Centroid        = Area > 0 ? Centroid / Area : MeshCenter;
+        const float Len = length(Normal);
+        Cluster.SortKey = Len > 0 ? dot(Centroid - MeshCenter, Normal / Len) : 0;
+    }
+
+    std::stable_sort(Clusters.begin(), Clusters.end(), [](const ClusterInfo& C0, const ClusterInfo& C1) {
+        return C0.SortKey > C1.SortKey;
+    });
+
+    size_t Offset = 0;
+    for (const auto& Cluster : Clusters)
+    {
+        memcpy(pDst + Offset, pIndices + Cluster.FirstTri * 3, sizeof(Uint32) * Cluster.NumTris * 3);
+        Offset += Cluster.NumTris * 3;
+    }
+    VERIFY_EXPR(Offset == IndexCount);
+}
+
+Uint32 OptimizeVertexFetchRemap(Uint32* pRemap, const Uint32* pIndices, size_t IndexCount, size_t VertexCount)
+{
+    std::fill(pRemap, pRemap + VertexCount, InvalidIndex);
+
+    Uint32 NextVertex = 0;
+    for (size_t i = 0; i < IndexCount; ++i)
+    {
+        const auto v = pIndices[i];
+        VERIFY_EXPR(v < VertexCount);
+        if (pRemap[v] == InvalidIndex)
+            pRemap[v] = NextVertex++;
+    }
+    return NextVertex;
+}
+
+size_t SimplifyMesh(Uint32*       pDst,
+                    const Uint32* pIndices,
+                    size_t        IndexCount,
+                    const float*  pPositions,
+                    size_t        VertexCount,
+                    size_t        PositionStride,
+                    size_t        TargetIndexCount,
+                    float         TargetError,
+                    float*        pResultError)
+{
+    VERIFY(IndexCount % 3 == 0, "Index count must be a multiple of 3");
+    VERIFY(pDst != pIndices, "In-place simplification is not supported");
+
+    memcpy(pDst, pIndices, IndexCount * sizeof(Uint32));
+    if (pResultError != nullptr)
+        *pResultError = 0;
+    if (IndexCount <= TargetIndexCount)
+        return IndexCount;
+
+    // Normalize positions so that errors are relative to the mesh extent
+    std::vector<float3> Positions(VertexCount);
+    float3              MinPos{+FLT_MAX, +FLT_MAX, +FLT_MAX};
+    float3              MaxPos{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (size_t i = 0; i < IndexCount; ++i)
+    {
+        const auto* p = reinterpret_cast<const float*>(reinterpret_cast<const Uint8*>(pPositions) + pIndices[i] * PositionStride);
+
+        Positions[pIndices[i]] = float3{p[0], p[1], p[2]};
+        MinPos                 = std::min(MinPos, Positions[pIndices[i]]);
+        MaxPos                 = std::max(MaxPos, Positions[pIndices[i]]);
+    }
+    const auto  Extent = MaxPos - MinPos;
+    const float Scale  = std::max(std::max(Extent.x, Extent.y), Extent.z);
+    if (Scale <= 0)
+        return IndexCount;
+    for (auto& Pos : Positions)
+        Pos = (Pos - MinPos) / Scale;
+
+    // Vertices that share the position with other vertices lie on attribute seams
+    std::vector<Uint32> PositionIds(VertexCount);
+    {
+        const MeshOptimizerStream PosStream{Positions.data(), sizeof(float3), sizeof(float3)};
+        GenerateVertexRemap(PositionIds.data(), pIndices, IndexCount, VertexCount, &PosStream, 1);
+    }
+
+    std::vector<bool> IsLocked(VertexCount);
+    {
+        std::vector<Uint32> PositionRefs(VertexCount, InvalidIndex);
+        for (size_t v = 0; v < VertexCount; ++v)
+        {
+            const auto PosId = PositionIds[v];
+            if (PosId == InvalidIndex)
+                continue;
+            if (PositionRefs[PosId] == InvalidIndex)
+                PositionRefs[PosId] = static_cast<Uint32>(v);
+            else
+                IsLocked[v] = IsLocked[PositionRefs[PosId]] = true;
+        }
+
+        // Border edges have no opposite half-edge. Non-manifold edges are treated as borders too.
+        std::unordered_map<Uint64, Uint32> HalfEdges;
+        auto                               GetEdgeKey = [&](Uint32 v0, Uint32 v1) {
+            return (Uint64{PositionIds[v0]} << 32u) | Uint64{PositionIds[v1]};
+        };
+        for (size_t i = 0; i < IndexCount; i += 3)
+        {
+            for (int e = 0; e < 3; ++e)
+                ++HalfEdges[GetEdgeKey(pIndices[i + e], pIndices[i + (e + 1) % 3])];
+        }
+        for (size_t i = 0; i < IndexCount; i += 3)
+        {
+            for (int e = 0; e < 3; ++e)
+            {
+                const auto v0       = pIndices[i + e];
+                const auto v1       = pIndices[i + (e + 1) % 3];
+                const auto NumEdges = HalfEdges[GetEdgeKey(v0, v1)];
+                const auto it       = HalfEdges.find(GetEdgeKey(v1, v0));
+                if (NumEdges != 1 || it == HalfEdges.end() || it->second != 1)
+                    IsLocked[v0] = IsLocked[v1] = true;
+            }
+        }
+    }
+
+    auto GetTriangleNormal = [&](Uint32 v0, Uint32 v1, Uint32 v2) {
+        return cross(Positions[v1] - Positions[v0], Positions[v2] - Positions[v0]);
+    };
+
+    std::vector<Quadric> Quadrics(VertexCount);
+    for (size_t i = 0; i < IndexCount; i += 3)
+    {
+        const auto  N    = GetTriangleNormal(pIndices[i], pIndices[i + 1], pIndices[i + 2]);
+        const float Area = length(N);
+        if (Area == 0)
+            continue;
+
+        const auto    UnitN = N / Area;
+        const Quadric Q{UnitN, -dot(UnitN, Positions[pIndices[i]]), Area};
+        for (int v = 0; v < 3; ++v)
+            Quadrics[pIndices[i + v]] += Q;
+    }
+
+    const float MaxCost        = TargetError * TargetError;
+    float       MaxAppliedCost = 0;
+
+    struct Collapse
+    {
+        Uint32 Src;
+        Uint32 Dst;
+        float  Cost;
+    };
+    std::vector<Collapse> Collapses;
+    std::vector<Uint32>   AdjacencyOffsets(VertexCount + 1);
+    std::vector<Uint32>   AdjacentTris;
+    std::vector<Uint32>   Remap(VertexCount);
+    std::vector<bool>     IsTouched(VertexCount);
+    while (IndexCount > TargetIndexCount)
+    {
+        // Vertex-triangle adjacency of the current mesh
+        std::fill(AdjacencyOffsets.begin(), AdjacencyOffsets.end(), 0);
+        for (size_t i = 0; i < IndexCount; ++i)
+            ++AdjacencyOffsets[pDst[i] + 1];
+        for (size_t v = 0; v < VertexCount; ++v)
+            AdjacencyOffsets[v + 1] += AdjacencyOffsets[v];
+        AdjacentTris.resize(IndexCount);
+        {
+            std::vector<Uint32> Fill(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < IndexCount; ++i)
+                AdjacentTris[Fill[pDst[i]]++] = static_cast<Uint32>(i / 3);
+        }
+
+        // The cheapest collapse of every movable vertex
+        Collapses.clear();
+        {
+            std::vector<Uint32> BestCollapse(VertexCount, InvalidIndex);
+            for (size_t i = 0; i < IndexCount; ++i)
+            {
+                const auto Src = pDst[i];
+                if (IsLocked[Src])
+                    continue;
+                for (int n = 1; n < 3; ++n)
+                {
+                    const auto Dst = pDst[i - i % 3 + (i % 3 + n) % 3];
+
+                    auto Q = Quadrics[Src];
+                    Q += Quadrics[Dst];
+                    const float Cost = Q.Evaluate(Positions[Dst]);
+                    if (BestCollapse[Src] == InvalidIndex)
+                    {
+                        BestCollapse[Src] = static_cast<Uint32>(Collapses.size());
+                        Collapses.push_back({Src, Dst, Cost});
+                    }
+                    else if (Cost < Collapses[BestCollapse[Src]].Cost)
+                    {
+                        Collapses[BestCollapse[Src]] = {Src, Dst, Cost};
+                    }
+                }
+            }
+        }
+        std::sort(Collapses.begin(), Collapses.end(), [](const Collapse& C0, const Collapse& C1) {
+            return C0.Cost < C1.Cost;
+        });
+
+        for (size_t v = 0; v < VertexCount; ++v)
+            Remap[v] = static_cast<Uint32>(v);
+        std::fill(IsTouched.begin(), IsTouched.end(), false);
+
+        const size_t TrisToRemove = (IndexCount - TargetIndexCount) / 3;
+        size_t       RemovedTris  = 0;
+        size_t       NumCollapses = 0;
+        for (const auto& C : Collapses)
+        {
+            if (C.Cost > MaxCost || RemovedTris >= TrisToRemove)
+                break;
+            if (IsTouched[C.Src] || IsTouched[C.Dst])
+                continue;
+
+            // Reject the collapse if any of the remaining triangles flips
+            const auto* pAdjTris     = &AdjacentTris[AdjacencyOffsets[C.Src]];
+            const auto  NumAdjTris   = AdjacencyOffsets[C.Src + 1] - AdjacencyOffsets[C.Src];
+            size_t      NumCollapsed = 0;
+            bool        IsValid      = true;
+            for (Uint32 t = 0; t < NumAdjTris && IsValid; ++t)
+            {
+                const auto* Tri = pDst + pAdjTris[t] * 3;
+                if (Tri[0] == C.Dst || Tri[1] == C.Dst || Tri[2] == C.Dst)
+                {
+                    ++NumCollapsed;
+                    continue;
+                }
+
+                Uint32 NewTri[] = {Tri[0], Tri[1], Tri[2]};
+                for (auto& v : NewTri)
+                {
+                    if (v == C.Src)
+                        v = C.Dst;
+                }
+                const auto N0 = GetTriangleNormal(Tri[0], Tri[1], Tri[2]);
+                const auto N1 = GetTriangleNormal(NewTri[0], NewTri[1], NewTri[2]);
+                IsValid       = dot(N0, N1) > 0;
+            }
+            if (!IsValid)
+                continue;
+
+            Remap[C.Src] = C.Dst;
+            Quadrics[C.Dst] += Quadrics[C.Src];
+            MaxAppliedCost = std::max(MaxAppliedCost, C.Cost);
+            RemovedTris += NumCollapsed;
+            ++NumCollapses;
+
+            // Adjacency of the vertices around the collapsed one is now stale
+            for (Uint32 t = 0; t < NumAdjTris; ++t)
+            {
+                for (int v = 0; v < 3; ++v)
+                    IsTouched[pDst[pAdjTris[t] * 3 + v]] = true;
+            }
+        }
+
+        if (NumCollapses == 0)
+            break;
+
+        // Apply collapses and remove degenerate triangles
+        size_t NewIndexCount = 0;
+        for (size_t i = 0; i < IndexCount; i += 3)
+        {
+            const auto v0 = Remap[pDst[i + 0]];
+            const auto v1 = Remap[pDst[i + 1]];
+            const auto v2 = Remap[pDst[i + 2]];
+            if (v0 != v1 && v1 != v2 && v2 != v0)
+            {
+                pDst[NewIndexCount++] = v0;
+                pDst[NewIndexCount++] = v1;
+                pDst[NewIndexCount++] = v2;
+            }
+        }
+        IndexCount = NewIndexCount;
+    }
+
+    if (pResultError != nullptr)
+        *pResultError = std::sqrt(MaxAppliedCost);
+
+    return IndexCount;
+}
+
+float ComputeACMR(const Uint32* pIndices, size_t IndexCount, size_t VertexCount, Uint32 CacheSize)
+{
+    const size_t NumTris = IndexCount / 3;
+    if (NumTris == 0)
+        return 0;
+
+    std::vector<Uint32> CacheTimestamps(VertexCount, 0);
+    Uint32              Timestamp = CacheSize + 1;
+    size_t              NumMisses = 0;
+    for (size_t i = 0; i < IndexCount; ++i)
+    {
+        const auto v = pIndices[i];
+        if (Timestamp - CacheTimestamps[v] > CacheSize)
+        {
+            CacheTimestamps[v] = Timestamp++;
+            ++NumMisses;
+        }
+    }
+    return static_cast<float>(NumMisses) / static_cast<float>(NumTris);
+}
+
+} // namespace Diligent
@@ -0,0 +1,162 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+
+#include "TextureAtlasPacker.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+Uint32 AlignUp(Uint32 Value, Uint32 Alignment)
+{
+    return (Value + Alignment - 1) & ~(Alignment - 1);
+}
+
+} // namespace
+
+uint2 PackTextureAtlas(Uint32              AtlasWidth,
+                       Uint32              AtlasHeight,
+                       Uint32              Padding,
+                       Uint32              Alignment,
+                       TextureAtlasRegion* pRegions,
+                       size_t              NumRegions)
+{
+    VERIFY(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment (", Alignment, ") must be a power of two");
+
+    // Taller textures are placed first, so that the rows are filled with textures of similar height
+    std::vector<size_t> Order(NumRegions);
+    std::iota(Order.begin(), Order.end(), size_t{0});
+    std::stable_sort(Order.begin(), Order.end(), [pRegions](size_t i0, size_t i1) {
+        if (pRegions[i0].Height != pRegions[i1].Height)
+            return pRegions[i0].Height > pRegions[i1].Height;
+        return pRegions[i0].Width > pRegions[i1].Width;
+    });
+
+    struct Shelf
+    {
+        Uint32 Y;
+        Uint32 Height;
+        Uint32 UsedWidth;
+    };
+    std::vector<Shelf> Shelves;
+
+    uint2 UsedSize{0, 0};
+    for (auto i : Order)
+    {
+        auto& Region = pRegions[i];
+
+        Region.IsPacked = false;
+        if (Region.Width == 0 || Region.Height == 0)
+            continue;
+
+        const auto CellWidth  = AlignUp(Region.Width + Padding * 2, Alignment);
+        const auto CellHeight = AlignUp(Region.Height + Padding * 2, Alignment);
+        if (CellWidth > AtlasWidth)
+            continue;
+
+        // The first row that has enough space
+        auto shelf_it = std::find_if(Shelves.begin(), Shelves.end(), [&](const Shelf& shelf) {
+            return shelf.Height >= CellHeight && shelf.UsedWidth + CellWidth <= AtlasWidth;
+        });
+        if (shelf_it == Shelves.end())
+        {
+            const auto ShelfY = Shelves.empty() ? 0 : Shelves.back().Y + Shelves.back().Height;
+            if (ShelfY + CellHeight > AtlasHeight)
+                continue;
+
+            Shelves.push_back({ShelfY, CellHeight, 0});
+            shelf_it = Shelves.end() - 1;
+        }
+
+        Region.X        = shelf_it->UsedWidth + Padding;
+        Region.Y        = shelf_it->Y + Padding;
+        Region.IsPacked = true;
+        shelf_it->UsedWidth += CellWidth;
+
+        UsedSize.x = std::max(UsedSize.x, shelf_it->UsedWidth);
+        UsedSize.y = std::max(UsedSize.y, shelf_it->Y + shelf_it->Height);
+    }
+
+    return UsedSize;
+}
+
+void CopyToTextureAtlas(const TextureAtlasRegion& Region,
+                        Uint32                    Padding,
+                        const Uint8*              pSrcData,
+                        Uint32                    SrcStride,
+                        Uint8*                    pAtlasData,
+                        Uint32                    AtlasStride)
+{
+    VERIFY_EXPR(Region.IsPacked && Region.X >= Padding && Region.Y >= Padding);
+
+    const auto PaddedWidth  = Region.Width + Padding * 2;
+    const auto PaddedHeight = Region.Height + Padding * 2;
+
+    // Source column of every column of the padded region
+    std::vector<Uint32> SrcColumns(PaddedWidth);
+    for (Uint32 x = 0; x < PaddedWidth; ++x)
+        SrcColumns[x] = (x + Region.Width - Padding % Region.Width) % Region.Width;
+
+    for (Uint32 y = 0; y < PaddedHeight; ++y)
+    {
+        const auto  SrcRow  = (y + Region.Height - Padding % Region.Height) % Region.Height;
+        const auto* pSrcRow = pSrcData + size_t{SrcRow} * SrcStride;
+        auto*       pDstRow = pAtlasData + size_t{Region.Y - Padding + y} * AtlasStride + size_t{Region.X - Padding} * 4;
+
+        // The interior of the row is copied at once
+        memcpy(pDstRow + size_t{Padding} * 4, pSrcRow, size_t{Region.Width} * 4);
+        for (Uint32 x = 0; x < Padding; ++x)
+        {
+            memcpy(pDstRow + size_t{x} * 4, pSrcRow + size_t{SrcColumns[x]} * 4, 4);
+            const auto RightX = Padding + Region.Width + x;
+            memcpy(pDstRow + size_t{RightX} * 4, pSrcRow + size_t{SrcColumns[RightX]} * 4, 4);
+        }
+    }
+}
+
+float4 GetTextureAtlasUVScaleBias(const TextureAtlasRegion& Region,
+                                  Uint32                    AtlasWidth,
+                                  Uint32                    AtlasHeight)
+{
+    return float4{
+        static_cast<float>(Region.Width) / static_cast<float>(AtlasWidth),
+        static_cast<float>(Region.Height) / static_cast<float>(AtlasHeight),
+        static_cast<float>(Region.X) / static_cast<float>(AtlasWidth),
+        static_cast<float>(Region.Y) / static_cast<float>(AtlasHeight) //
+    };
+}
+
+} // namespace Diligent
@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "../include/DDSLoader.h"
+#include "../include/dxgiformat.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <cstring>
+
+#include "DataBlobImpl.hpp"
+#include "MemoryFileStream.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+Uint32 ReadUint32(const Uint8* pData, size_t Offset)
+{
+    Uint32 Val;
+    memcpy(&Val, pData + Offset, sizeof(Val));
+    return Val;
+}
+
+TEST(Tools_TextureLoader, SaveDDSCubemap)
+{
+    constexpr Uint32 Dim       = 4;
+    constexpr Uint32 MipLevels = 3;
+    constexpr Uint32 TexelSize = 8; // RGBA16F
+    constexpr Uint32 Padding   = 12;
+
+    TextureDesc TexDesc;
+    TexDesc.Type      = RESOURCE_DIM_TEX_CUBE;
+    TexDesc.Width     = Dim;
+    TexDesc.Height    = Dim;
+    TexDesc.ArraySize = 6;
+    TexDesc.MipLevels = MipLevels;
+    TexDesc.Format    = TEX_FORMAT_RGBA16_FLOAT;
+
+    // Rows of every subresource are padded to test that the writer packs them tightly
+    std::vector<std::vector<Uint8>> SubresData;
+    std::vector<TextureSubResData>  SubResources;
+    std::vector<Uint8>              RefPayload;
+    for (Uint32 Face = 0; Face < 6; ++Face)
+    {
+        for (Uint32 Mip = 0; Mip < MipLevels; ++Mip)
+        {
+            const Uint32 MipDim   = Dim >> Mip;
+            const Uint32 RowBytes = MipDim * TexelSize;
+            const Uint32 Stride   = RowBytes + Padding;
+
+            std::vector<Uint8> Data(Stride * MipDim, 0xCD);
+            for (Uint32 Row = 0; Row < MipDim; ++Row)
+            {
+                for (Uint32 b = 0; b < RowBytes; ++b)
+                {
+                    auto Val                = static_cast<Uint8>(Face * 37 + Mip * 11 + Row * 5 + b);
+                    Data[Row * Stride + b] = Val;
+                    RefPayload.push_back(Val);
+                }
+            }
+            SubResources.emplace_back(Data.data(), Stride);
+            SubresData.emplace_back(std::move(Data));
+        }
+    }
+
+    TextureData TexData{SubResources.data(), static_cast<Uint32>(SubResources.size())};
+
+    RefCntAutoPtr<IDataBlob>        pDDSData{MakeNewRCObj<DataBlobImpl>()(0)};
+    RefCntAutoPtr<MemoryFileStream> pStream{MakeNewRCObj<MemoryFileStream>()(pDDSData)};
+    ASSERT_TRUE(SaveDDSTextureToStream(pStream, TexDesc, TexData));
+
+    // Magic + DDS_HEADER + DDS_HEADER_DXT10
+    constexpr size_t HeaderSize = 4 + 124 + 20;
+    ASSERT_EQ(pDDSData->GetSize(), HeaderSize + RefPayload.size());
+
+    const auto* pBytes = reinterpret_cast<const Uint8*>(pDDSData->GetDataPtr());
+    EXPECT_EQ(ReadUint32(pBytes, 0), 0x20534444u); // "DDS "
+    EXPECT_EQ(ReadUint32(pBytes, 4), 124u);        // header size
+    EXPECT_EQ(ReadUint32(pBytes, 12), Dim);        // height
+    EXPECT_EQ(ReadUint32(pBytes, 16), Dim);        // width
+    EXPECT_EQ(ReadUint32(pBytes, 28), MipLevels);  // mip count
+
+    EXPECT_EQ(ReadUint32(pBytes, 128), static_cast<Uint32>(DXGI_FORMAT_R16G16B16A16_FLOAT));
+    EXPECT_EQ(ReadUint32(pBytes, 132), 3u); // D3D11_RESOURCE_DIMENSION_TEXTURE2D
+    EXPECT_EQ(ReadUint32(pBytes, 136), 4u); // D3D11_RESOURCE_MISC_TEXTURECUBE
+    EXPECT_EQ(ReadUint32(pBytes, 140), 1u); // one cube
+
+    EXPECT_EQ(memcmp(pBytes + HeaderSize, RefPayload.data(), RefPayload.size()), 0);
+}
+
+TEST(Tools_TextureLoader, SaveDDSInvalidSubresources)
+{
+    TextureDesc TexDesc;
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = 4;
+    TexDesc.Height    = 4;
+    TexDesc.MipLevels = 3;
+    TexDesc.Format    = TEX_FORMAT_RG16_FLOAT;
+
+    std::vector<Uint8> Data(4 * 4 * 4);
+    TextureSubResData  SubRes{Data.data(), 4 * 4};
+    TextureData        TexData{&SubRes, 1};
+
+    RefCntAutoPtr<IDataBlob>        pDDSData{MakeNewRCObj<DataBlobImpl>()(0)};
+    RefCntAutoPtr<MemoryFileStream> pStream{MakeNewRCObj<MemoryFileStream>()(pDDSData)};
+    EXPECT_FALSE(SaveDDSTextureToStream(pStream, TexDesc, TexData));
+}
+
+} // namespace
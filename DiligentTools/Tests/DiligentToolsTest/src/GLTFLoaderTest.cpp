@@ -0,0 +1,212 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "GLTFLoader.hpp"
+#include "Timer.hpp"
+#include "DebugUtilities.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Synthetic skinned rig that matches the topology of CesiumMan:
+// a mesh node with a 19-joint skeleton that is up to 9 levels deep.
+class SkinnedRig
+{
+public:
+    SkinnedRig()
+    {
+        auto* Root = AddNode(nullptr, float3{0, 0, 0});
+
+        auto* MeshNode   = AddNode(Root, float3{0, 0, 0});
+        MeshNode->_Mesh  = std::unique_ptr<GLTF::Mesh>{new GLTF::Mesh{nullptr, float4x4::Identity()}};
+        MeshNode->Scale  = float3{0.5f, 0.5f, 0.5f};
+        MeshNode->Matrix = float4x4::RotationX(-PI_F * 0.5f);
+
+        auto* Hips   = AddJoint(Root, float3{0, 1.0f, 0});
+        auto* Spine0 = AddJoint(Hips, float3{0, 0.2f, 0});
+        auto* Spine1 = AddJoint(Spine0, float3{0, 0.2f, 0});
+        auto* Neck   = AddJoint(Spine1, float3{0, 0.3f, 0});
+        AddJoint(Neck, float3{0, 0.15f, 0});
+        for (float Side : {-1.f, +1.f})
+        {
+            auto* Shoulder = AddJoint(Spine1, float3{Side * 0.2f, 0.25f, 0});
+            auto* Arm      = AddJoint(Shoulder, float3{Side * 0.25f, 0, 0});
+            auto* Forearm  = AddJoint(Arm, float3{Side * 0.25f, 0, 0});
+            AddJoint(Forearm, float3{Side * 0.2f, 0, 0});
+
+            auto* Thigh = AddJoint(Hips, float3{Side * 0.1f, -0.1f, 0});
+            auto* Shin  = AddJoint(Thigh, float3{0, -0.45f, 0});
+            AddJoint(Shin, float3{0, -0.45f, 0.05f});
+        }
+        VERIFY_EXPR(m_Skin.Joints.size() == 19);
+
+        // Bind pose
+        GLTF::UpdateNodeTransforms(m_LinearNodes);
+        for (auto* Joint : m_Skin.Joints)
+            m_Skin.InverseBindMatrices.push_back(Joint->GlobalMatrix.Inverse());
+        MeshNode->_Skin = &m_Skin;
+    }
+
+    void Animate(float Time)
+    {
+        for (size_t i = 0; i < m_Skin.Joints.size(); ++i)
+        {
+            auto Angle                 = std::sin(Time + static_cast<float>(i)) * 0.5f;
+            m_Skin.Joints[i]->Rotation = Quaternion::RotationFromAxisAngle(float3{1, 0.5f, 0.25f}, Angle);
+        }
+    }
+
+    const std::vector<GLTF::Node*>& GetLinearNodes() const { return m_LinearNodes; }
+    const GLTF::Mesh&               GetMesh() const { return *m_LinearNodes[1]->_Mesh; }
+
+    // Reference implementation that walks from every node to the root
+    static float4x4 GetGlobalMatrixRef(const GLTF::Node* node)
+    {
+        auto mat = node->LocalMatrix();
+        for (auto* p = node->Parent; p != nullptr; p = p->Parent)
+        {
+            mat = mat * p->LocalMatrix();
+        }
+        return mat;
+    }
+
+    void UpdateRef(GLTF::Mesh::TransformData& Transforms) const
+    {
+        const auto* MeshNode = m_LinearNodes[1];
+
+        Transforms.matrix     = GetGlobalMatrixRef(MeshNode);
+        auto InverseTransform = Transforms.matrix.Inverse();
+        Transforms.jointMatrices.resize(m_Skin.Joints.size());
+        for (size_t i = 0; i < m_Skin.Joints.size(); ++i)
+        {
+            Transforms.jointMatrices[i] = m_Skin.InverseBindMatrices[i] * GetGlobalMatrixRef(m_Skin.Joints[i]) * InverseTransform;
+        }
+    }
+
+private:
+    GLTF::Node* AddNode(GLTF::Node* Parent, const float3& Translation)
+    {
+        std::unique_ptr<GLTF::Node> NewNode{new GLTF::Node{}};
+        NewNode->Index       = static_cast<Uint32>(m_LinearNodes.size());
+        NewNode->Parent      = Parent;
+        NewNode->Matrix      = float4x4::Identity();
+        NewNode->Translation = Translation;
+
+        auto* pNode = NewNode.get();
+        m_LinearNodes.push_back(pNode);
+        if (Parent != nullptr)
+            Parent->Children.push_back(std::move(NewNode));
+        else
+            m_Root = std::move(NewNode);
+        return pNode;
+    }
+
+    GLTF::Node* AddJoint(GLTF::Node* Parent, const float3& Translation)
+    {
+        auto* Joint = AddNode(Parent, Translation);
+        m_Skin.Joints.push_back(Joint);
+        return Joint;
+    }
+
+    std::unique_ptr<GLTF::Node> m_Root;
+    std::vector<GLTF::Node*>    m_LinearNodes;
+    GLTF::Skin                  m_Skin;
+};
+
+TEST(Tools_AssetLoader, GLTFNodeTransforms)
+{
+    SkinnedRig Rig;
+
+    GLTF::Mesh::TransformData RefTransforms;
+    for (float Time = 0; Time < 3.f; Time += 0.25f)
+    {
+        Rig.Animate(Time);
+        GLTF::UpdateNodeTransforms(Rig.GetLinearNodes());
+        Rig.UpdateRef(RefTransforms);
+
+        const auto& Transforms = Rig.GetMesh().Transforms;
+        ASSERT_EQ(Transforms.jointMatrices.size(), RefTransforms.jointMatrices.size());
+        for (size_t j = 0; j < Transforms.jointMatrices.size(); ++j)
+        {
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    EXPECT_NEAR(Transforms.jointMatrices[j][r][c], RefTransforms.jointMatrices[j][r][c], 1e-4f);
+                }
+            }
+        }
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                EXPECT_NEAR(Transforms.matrix[r][c], RefTransforms.matrix[r][c], 1e-5f);
+            }
+        }
+    }
+}
+
+TEST(Tools_AssetLoader, GLTFNodeTransformsPerf)
+{
+    constexpr int NumRigs       = 100;
+    constexpr int NumIterations = 100;
+
+    std::vector<std::unique_ptr<SkinnedRig>> Rigs(NumRigs);
+    for (auto& Rig : Rigs)
+    {
+        Rig.reset(new SkinnedRig);
+        Rig->Animate(1.f);
+    }
+
+    GLTF::Mesh::TransformData RefTransforms;
+
+    Timer  T;
+    double StartTime = T.GetElapsedTime();
+    for (int i = 0; i < NumIterations; ++i)
+    {
+        for (auto& Rig : Rigs)
+            Rig->UpdateRef(RefTransforms);
+    }
+    double RefTime = T.GetElapsedTime() - StartTime;
+
+    StartTime = T.GetElapsedTime();
+    for (int i = 0; i < NumIterations; ++i)
+    {
+        for (auto& Rig : Rigs)
+            GLTF::UpdateNodeTransforms(Rig->GetLinearNodes());
+    }
+    double LinearTime = T.GetElapsedTime() - StartTime;
+
+    LOG_INFO_MESSAGE(NumRigs * NumIterations, " updates of a 19-joint rig: walk-to-root - ", RefTime * 1000.0,
+                     " ms, single top-down pass - ", LinearTime * 1000.0, " ms");
+}
+
+} // namespace
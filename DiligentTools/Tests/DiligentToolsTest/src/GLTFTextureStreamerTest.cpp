@@ -0,0 +1,104 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+
+#include "GLTFTextureStreamer.hpp"
+#include "TextureLoader.h"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+TEST(Tools_AssetLoader, TextureStreamerRequiredMip)
+{
+    using GLTF::TextureStreamer;
+
+    // One texel per pixel
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 1024, 0), 0u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 2048, 0), 0u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 512, 0), 1u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 400, 0), 1u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 256, 128, 0), 3u);
+
+    // Bias
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 512, -1), 0u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 512, +1), 2u);
+
+    // Invisible and tiny surfaces only need the last level
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 512, 0, 0), 10u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 512, 0.01f, 0), 10u);
+}
+
+TEST(Tools_AssetLoader, TextureStreamerMipChainSize)
+{
+    using GLTF::TextureStreamer;
+
+    EXPECT_EQ(TextureStreamer::GetMipChainSize(4, 4, 0, 3), Uint64{(16 + 4 + 1) * 4});
+    EXPECT_EQ(TextureStreamer::GetMipChainSize(4, 4, 1, 3), Uint64{(4 + 1) * 4});
+    EXPECT_EQ(TextureStreamer::GetMipChainSize(8, 2, 0, 4), Uint64{(16 + 4 + 2 + 1) * 4});
+    EXPECT_EQ(TextureStreamer::GetMipChainSize(8, 2, 4, 4), Uint64{0});
+}
+
+TEST(Tools_TextureLoader, ComputeMipLevelRGBA8)
+{
+    // 3x3 -> 1x1, the last row and column are dropped
+    // clang-format off
+    const Uint8 FineData[] =
+    {
+        0,  0, 0, 255,   30, 30, 0, 255,   60, 0, 0, 0,
+        90, 0, 0, 255,   90, 60, 0, 255,   60, 0, 0, 0,
+        0,  0, 0, 255,    0,  0, 0, 255,    0, 0, 0, 0
+    };
+    // clang-format on
+    Uint8 CoarseData[4] = {};
+    ComputeMipLevel(3, 3, TEX_FORMAT_RGBA8_UNORM, FineData, 3 * 4, CoarseData, 4);
+    EXPECT_EQ(CoarseData[0], 52);
+    EXPECT_EQ(CoarseData[1], 22);
+    EXPECT_EQ(CoarseData[2], 0);
+    EXPECT_EQ(CoarseData[3], 255);
+
+    // 4x2 -> 2x1
+    // clang-format off
+    const Uint8 FineData2[] =
+    {
+        10, 20, 30, 40,   30, 40, 50, 60,   0, 0, 0, 0,   255, 255, 255, 255,
+        10, 20, 30, 40,   30, 40, 50, 60,   0, 0, 0, 0,   255, 255, 255, 255
+    };
+    // clang-format on
+    Uint8 CoarseData2[8] = {};
+    ComputeMipLevel(4, 2, TEX_FORMAT_RGBA8_UNORM, FineData2, 4 * 4, CoarseData2, 2 * 4);
+    const Uint8 RefData2[] = {20, 30, 40, 50, 127, 127, 127, 127};
+    for (size_t i = 0; i < _countof(RefData2); ++i)
+        EXPECT_EQ(CoarseData2[i], RefData2[i]) << "i = " << i;
+}
+
+} // namespace
@@ -0,0 +1,269 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ImageComparator.hpp"
+#include "Timer.hpp"
+#include "Errors.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+struct TestImages
+{
+    Uint32 Width         = 0;
+    Uint32 Height        = 0;
+    Uint32 NumComponents = 0;
+    Uint32 Stride        = 0;
+
+    std::vector<Uint8> Image;
+    std::vector<Uint8> Reference;
+};
+
+// Creates a random reference image and a copy with NumChanges components changed by up to MaxChange
+TestImages CreateTestImages(Uint32 Width, Uint32 Height, Uint32 NumComponents, Uint32 NumChanges, int MaxChange, std::mt19937& Gen)
+{
+    TestImages Images;
+    Images.Width         = Width;
+    Images.Height        = Height;
+    Images.NumComponents = NumComponents;
+    Images.Stride        = Width * NumComponents + 5;
+
+    Images.Reference.resize(size_t{Images.Stride} * Height);
+    std::uniform_int_distribution<int> ByteDistr{0, 255};
+    for (auto& Val : Images.Reference)
+        Val = static_cast<Uint8>(ByteDistr(Gen));
+
+    Images.Image = Images.Reference;
+
+    std::uniform_int_distribution<Uint32> RowDistr{0, Height - 1};
+    std::uniform_int_distribution<Uint32> ColDistr{0, Width * NumComponents - 1};
+    std::uniform_int_distribution<int>    ChangeDistr{-MaxChange, MaxChange};
+    for (Uint32 i = 0; i < NumChanges; ++i)
+    {
+        auto& Val = Images.Image[RowDistr(Gen) * Images.Stride + ColDistr(Gen)];
+        Val       = static_cast<Uint8>(std::min(std::max(int{Val} + ChangeDistr(Gen), 0), 255));
+    }
+
+    return Images;
+}
+
+ImageCompareInfo GetCompareInfo(const TestImages& Images)
+{
+    ImageCompareInfo Info;
+    Info.Width           = Images.Width;
+    Info.Height          = Images.Height;
+    Info.NumComponents   = Images.NumComponents;
+    Info.pImage          = Images.Image.data();
+    Info.Stride          = Images.Stride;
+    Info.pReference      = Images.Reference.data();
+    Info.ReferenceStride = Images.Stride;
+    return Info;
+}
+
+// Straightforward per-pixel implementation
+void CompareImagesRef(const ImageCompareInfo& Info, ImageComparison& Result)
+{
+    const auto NumCompared = Info.NumComparedComponents != 0 ? Info.NumComparedComponents : Info.NumComponents;
+
+    Result           = ImageComparison{};
+    Result.NumTilesX = (Info.Width + Info.TileSize - 1) / Info.TileSize;
+    Result.NumTilesY = (Info.Height + Info.TileSize - 1) / Info.TileSize;
+    Result.Tiles.resize(Result.NumTilesX * Result.NumTilesY);
+
+    Uint64 SumSquaredError = 0;
+    for (Uint32 row = 0; row < Info.Height; ++row)
+    {
+        for (Uint32 col = 0; col < Info.Width; ++col)
+        {
+            const auto* pImgPixel = static_cast<const Uint8*>(Info.pImage) + row * Info.Stride + col * Info.NumComponents;
+            const auto* pRefPixel = static_cast<const Uint8*>(Info.pReference) + row * Info.ReferenceStride + col * Info.NumComponents;
+
+            auto& Tile = Result.Tiles[(row / Info.TileSize) * Result.NumTilesX + col / Info.TileSize];
+
+            Uint32 PixelError = 0;
+            for (Uint32 c = 0; c < NumCompared; ++c)
+            {
+                const auto Error = static_cast<Uint32>(std::abs(int{pImgPixel[c]} - int{pRefPixel[c]}));
+                PixelError       = std::max(PixelError, Error);
+                Tile.SumSquaredError += Error * Error;
+                SumSquaredError += Error * Error;
+            }
+            Tile.MaxError   = std::max(Tile.MaxError, PixelError);
+            Result.MaxError = std::max(Result.MaxError, PixelError);
+            if (PixelError > Info.Tolerance)
+            {
+                ++Tile.NumDiffPixels;
+                ++Result.NumDiffPixels;
+            }
+        }
+    }
+    Result.MeanSquaredError = static_cast<double>(SumSquaredError) / (static_cast<double>(Info.Width) * static_cast<double>(Info.Height) * NumCompared);
+}
+
+void CheckComparison(const ImageCompareInfo& Info)
+{
+    ImageComparison Result, RefResult;
+    CompareImages(Info, Result);
+    CompareImagesRef(Info, RefResult);
+
+    EXPECT_EQ(Result.NumDiffPixels, RefResult.NumDiffPixels);
+    EXPECT_EQ(Result.MaxError, RefResult.MaxError);
+    EXPECT_NEAR(Result.MeanSquaredError, RefResult.MeanSquaredError, 1e-9);
+    ASSERT_EQ(Result.NumTilesX, RefResult.NumTilesX);
+    ASSERT_EQ(Result.NumTilesY, RefResult.NumTilesY);
+    ASSERT_EQ(Result.Tiles.size(), RefResult.Tiles.size());
+    for (size_t i = 0; i < Result.Tiles.size(); ++i)
+    {
+        EXPECT_EQ(Result.Tiles[i].NumDiffPixels, RefResult.Tiles[i].NumDiffPixels) << "tile " << i;
+        EXPECT_EQ(Result.Tiles[i].MaxError, RefResult.Tiles[i].MaxError) << "tile " << i;
+        EXPECT_EQ(Result.Tiles[i].SumSquaredError, RefResult.Tiles[i].SumSquaredError) << "tile " << i;
+    }
+}
+
+} // namespace
+
+TEST(Tools_TextureLoader, CompareImages)
+{
+    std::mt19937 Gen{17};
+
+    // Odd sizes exercise the scalar tails of the vectorized rows
+    const Uint32 Sizes[][2] = {{1, 1}, {15, 3}, {37, 29}, {517, 263}, {1024, 512}};
+    for (const auto& Size : Sizes)
+    {
+        for (Uint32 NumComponents = 1; NumComponents <= 4; ++NumComponents)
+        {
+            const auto Images = CreateTestImages(Size[0], Size[1], NumComponents, Size[0] * Size[1] / 16 + 1, 40, Gen);
+
+            auto Info = GetCompareInfo(Images);
+            for (Uint32 NumCompared = 0; NumCompared <= NumComponents; ++NumCompared)
+            {
+                for (Uint32 Tolerance : {0u, 7u, 255u})
+                {
+                    for (Uint32 TileSize : {16u, 33u})
+                    {
+                        Info.NumComparedComponents = NumCompared;
+                        Info.Tolerance             = Tolerance;
+                        Info.TileSize              = TileSize;
+                        CheckComparison(Info);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, CompareIdenticalImages)
+{
+    std::mt19937 Gen{5};
+
+    const auto Images = CreateTestImages(640, 480, 4, 0, 0, Gen);
+
+    auto Info            = GetCompareInfo(Images);
+    Info.CreateDiffImage = true;
+
+    ImageComparison Result;
+    CompareImages(Info, Result);
+    EXPECT_EQ(Result.NumDiffPixels, 0u);
+    EXPECT_EQ(Result.NumDiffTiles, 0u);
+    EXPECT_EQ(Result.MaxError, 0u);
+    EXPECT_EQ(Result.PSNR, std::numeric_limits<double>::infinity());
+    ASSERT_EQ(Result.DiffImage.size(), size_t{640} * 480 * 3);
+    // Matching pixels are dark
+    EXPECT_TRUE(std::all_of(Result.DiffImage.begin(), Result.DiffImage.end(), [](Uint8 Val) { return Val < 64; }));
+}
+
+TEST(Tools_TextureLoader, CompareImagesDiffImage)
+{
+    std::mt19937 Gen{3};
+
+    auto Images = CreateTestImages(100, 70, 3, 0, 0, Gen);
+    // Change one pixel in the tile (1, 1)
+    Images.Image[45 * Images.Stride + 40 * 3 + 1] ^= 0x80;
+
+    auto Info            = GetCompareInfo(Images);
+    Info.TileSize        = 32;
+    Info.CreateDiffImage = true;
+
+    ImageComparison Result;
+    CompareImages(Info, Result);
+    EXPECT_EQ(Result.NumDiffPixels, 1u);
+    EXPECT_EQ(Result.NumDiffTiles, 1u);
+    EXPECT_EQ(Result.MaxError, 128u);
+    EXPECT_NEAR(Result.PSNR, 10.0 * std::log10(255.0 * 255.0 / (128.0 * 128.0 / (100.0 * 70.0 * 3.0))), 1e-6);
+    ASSERT_EQ(Result.NumTilesX, 4u);
+    ASSERT_EQ(Result.NumTilesY, 3u);
+    EXPECT_EQ(Result.Tiles[1 * 4 + 1].NumDiffPixels, 1u);
+
+    const auto* pDiffPixel = &Result.DiffImage[(45 * 100 + 40) * 3];
+    EXPECT_EQ(pDiffPixel[0], 192);
+    EXPECT_EQ(pDiffPixel[1], 0);
+    EXPECT_EQ(pDiffPixel[2], 0);
+
+    const auto Heatmap = Result.CreateTileHeatmap();
+    ASSERT_EQ(Heatmap.size(), Result.DiffImage.size());
+    // Tile (1, 1) is hot, the rest is black
+    EXPECT_GE(Heatmap[(40 * 100 + 40) * 3], 128);
+    EXPECT_EQ(Heatmap[(10 * 100 + 10) * 3], 0);
+    EXPECT_EQ(Heatmap[(69 * 100 + 99) * 3], 0);
+}
+
+TEST(Tools_TextureLoader, CompareImagesPerf)
+{
+    std::mt19937 Gen{11};
+
+    const auto Images = CreateTestImages(3840, 2160, 4, 1000, 10, Gen);
+
+    auto Info                  = GetCompareInfo(Images);
+    Info.NumComparedComponents = 3;
+    Info.Tolerance             = 2;
+
+    ImageComparison Result, RefResult;
+
+    Timer T;
+
+    auto StartTime = T.GetElapsedTime();
+    CompareImagesRef(Info, RefResult);
+    const auto RefTime = T.GetElapsedTime() - StartTime;
+
+    StartTime       = T.GetElapsedTime();
+    CompareImages(Info, Result);
+    const auto Time = T.GetElapsedTime() - StartTime;
+
+    EXPECT_EQ(Result.NumDiffPixels, RefResult.NumDiffPixels);
+    LOG_INFO_MESSAGE("3840x2160 RGBA8 image comparison: per-pixel reference - ", RefTime * 1000.0, " ms, optimized - ", Time * 1000.0, " ms");
+}
@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include <thread>
+
+#include "ImageDecodeQueue.hpp"
+#include "../include/JPEGCodec.h"
+
+#include "gtest/gtest.h"
+
+#include "DataBlobImpl.hpp"
+
+using namespace Diligent;
+
+namespace
+{
+
+RefCntAutoPtr<IDataBlob> CreateTestJpeg(Uint32 Width, Uint32 Height)
+{
+    std::vector<Uint8> Pixels(Width * Height * 3);
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        for (Uint32 x = 0; x < Width; ++x)
+        {
+            auto* pPixel = &Pixels[(x + y * Width) * 3];
+            pPixel[0]    = static_cast<Uint8>(x * 255 / Width);
+            pPixel[1]    = static_cast<Uint8>(y * 255 / Height);
+            pPixel[2]    = 64;
+        }
+    }
+
+    RefCntAutoPtr<IDataBlob> pJpgData{MakeNewRCObj<DataBlobImpl>()(0)};
+    EXPECT_EQ(EncodeJpeg(Pixels.data(), Width, Height, 90, pJpgData), ENCODE_JPEG_RESULT_OK);
+    return pJpgData;
+}
+
+TEST(Tools_TextureLoader, ImageDecodeQueue)
+{
+    const std::vector<std::pair<Uint32, Uint32>> Sizes = {{64, 64}, {256, 128}, {13, 7}, {512, 512}, {100, 300}, {1, 1}, {128, 256}, {320, 200}};
+
+    std::vector<RefCntAutoPtr<IDataBlob>> JpegFiles;
+    for (const auto& Size : Sizes)
+        JpegFiles.emplace_back(CreateTestJpeg(Size.first, Size.second));
+
+    ImageDecodeQueue Queue{3};
+
+    std::vector<Uint32> JobIds;
+    for (auto& pJpgData : JpegFiles)
+        JobIds.push_back(Queue.Enqueue(pJpgData, ImageLoadInfo{}));
+    EXPECT_EQ(Queue.GetNumJobs(), Sizes.size());
+
+    // Single image
+    {
+        auto pImage = Queue.WaitForImage(JobIds[1]);
+        ASSERT_NE(pImage, nullptr);
+        EXPECT_EQ(pImage->GetDesc().Width, Sizes[1].first);
+        EXPECT_EQ(pImage->GetDesc().Height, Sizes[1].second);
+        EXPECT_EQ(Queue.GetNumJobs(), Sizes.size() - 1);
+    }
+
+    // The remaining images are returned in the order they were enqueued
+    auto Images = Queue.WaitForAll();
+    ASSERT_EQ(Images.size(), Sizes.size() - 1);
+    for (size_t i = 0, img = 0; i < Sizes.size(); ++i)
+    {
+        if (i == 1)
+            continue;
+        auto& pImage = Images[img++];
+        ASSERT_NE(pImage, nullptr);
+        EXPECT_EQ(pImage->GetDesc().Width, Sizes[i].first) << "Image " << i;
+        EXPECT_EQ(pImage->GetDesc().Height, Sizes[i].second) << "Image " << i;
+        EXPECT_EQ(pImage->GetDesc().NumComponents, 3u);
+    }
+    EXPECT_EQ(Queue.GetNumJobs(), size_t{0});
+}
+
+TEST(Tools_TextureLoader, ImageDecodeQueuePreview)
+{
+    auto pJpgData = CreateTestJpeg(512, 256);
+
+    ImageDecodeQueue Queue{2};
+
+    auto JobId0 = Queue.Enqueue(pJpgData, ImageLoadInfo{}, 4);
+    // Unsupported factors are rounded down to a power of two
+    auto JobId1 = Queue.Enqueue(pJpgData, ImageLoadInfo{}, 100);
+    // No preview
+    auto JobId2 = Queue.Enqueue(pJpgData, ImageLoadInfo{});
+
+    auto CheckJob = [&](Uint32 JobId, Uint32 PreviewDownscale) {
+        while (!Queue.IsComplete(JobId))
+            std::this_thread::yield();
+
+        auto pPreview = Queue.GetPreview(JobId);
+        if (PreviewDownscale > 1)
+        {
+            ASSERT_NE(pPreview, nullptr);
+            EXPECT_EQ(pPreview->GetDesc().Width, 512 / PreviewDownscale);
+            EXPECT_EQ(pPreview->GetDesc().Height, 256 / PreviewDownscale);
+        }
+        else
+        {
+            EXPECT_EQ(pPreview, nullptr);
+        }
+
+        auto pImage = Queue.WaitForImage(JobId);
+        ASSERT_NE(pImage, nullptr);
+        EXPECT_EQ(pImage->GetDesc().Width, 512u);
+        EXPECT_EQ(pImage->GetDesc().Height, 256u);
+    };
+    CheckJob(JobId0, 4);
+    CheckJob(JobId1, 8);
+    CheckJob(JobId2, 1);
+}
+
+TEST(Tools_TextureLoader, ImageDecodeQueueInvalidData)
+{
+    auto pJpgData = CreateTestJpeg(64, 64);
+
+    // Truncated header
+    RefCntAutoPtr<IDataBlob> pInvalidData{MakeNewRCObj<DataBlobImpl>()(16)};
+    memcpy(pInvalidData->GetDataPtr(), pJpgData->GetConstDataPtr(), 16);
+
+    ImageDecodeQueue Queue{2};
+
+    ImageLoadInfo LoadInfo;
+    LoadInfo.Format = IMAGE_FILE_FORMAT_JPEG;
+
+    auto JobId0 = Queue.Enqueue(pInvalidData, LoadInfo);
+    auto JobId1 = Queue.Enqueue(pJpgData, LoadInfo);
+
+    EXPECT_EQ(Queue.WaitForImage(JobId0), nullptr);
+    EXPECT_NE(Queue.WaitForImage(JobId1), nullptr);
+}
+
+} // namespace
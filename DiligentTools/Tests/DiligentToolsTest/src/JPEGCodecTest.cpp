@@ -65,7 +65,7 @@ TEST(Tools_TextureLoader, JPEGCodec)
     RefCntAutoPtr<IDataBlob> pDecodedPixelsBlob{MakeNewRCObj<DataBlobImpl>()(0)};
 
     ImageDesc DecodedImgDesc;
-    DecodeJpeg(pJpgData, pDecodedPixelsBlob, &DecodedImgDesc);
+    DecodeJpeg(pJpgData, pDecodedPixelsBlob, &DecodedImgDesc, 1);
 
     ASSERT_EQ(DecodedImgDesc.Width, TestImgWidth);
     ASSERT_EQ(DecodedImgDesc.Height, TestImgHeight);
@@ -88,4 +88,67 @@ TEST(Tools_TextureLoader, JPEGCodec)
     }
 }
 
+TEST(Tools_TextureLoader, JPEGCodecDownscale)
+{
+    constexpr Uint32 TestImgWidth  = 256;
+    constexpr Uint32 TestImgHeight = 120;
+    constexpr Uint32 NumComponents = 3;
+
+    // Smooth gradient, so that the downscaled image can be compared with the reference
+    std::vector<Uint8> RefPixels(TestImgWidth * TestImgHeight * NumComponents);
+    for (Uint32 y = 0; y < TestImgHeight; ++y)
+    {
+        for (Uint32 x = 0; x < TestImgWidth; ++x)
+        {
+            auto idx = x + y * TestImgWidth;
+
+            RefPixels[idx * NumComponents + 0] = static_cast<Uint8>(x);
+            RefPixels[idx * NumComponents + 1] = static_cast<Uint8>(y * 2);
+            RefPixels[idx * NumComponents + 2] = 128;
+        }
+    }
+
+    RefCntAutoPtr<IDataBlob> pJpgData{MakeNewRCObj<DataBlobImpl>()(0)};
+
+    auto Res = EncodeJpeg(RefPixels.data(), TestImgWidth, TestImgHeight, 100, pJpgData);
+    ASSERT_EQ(Res, ENCODE_JPEG_RESULT_OK);
+
+    for (Uint32 Downscale : {2u, 4u, 8u})
+    {
+        RefCntAutoPtr<IDataBlob> pDecodedPixelsBlob{MakeNewRCObj<DataBlobImpl>()(0)};
+
+        ImageDesc DecodedImgDesc;
+        auto      DecodeRes = DecodeJpeg(pJpgData, pDecodedPixelsBlob, &DecodedImgDesc, Downscale);
+        ASSERT_EQ(DecodeRes, DECODE_JPEG_RESULT_OK);
+
+        // The size is rounded up
+        ASSERT_EQ(DecodedImgDesc.Width, (TestImgWidth + Downscale - 1) / Downscale);
+        ASSERT_EQ(DecodedImgDesc.Height, (TestImgHeight + Downscale - 1) / Downscale);
+        ASSERT_EQ(DecodedImgDesc.NumComponents, NumComponents);
+
+        const Uint8* pTestPixels = reinterpret_cast<const Uint8*>(pDecodedPixelsBlob->GetDataPtr());
+        for (Uint32 y = 0; y < TestImgHeight / Downscale; ++y)
+        {
+            for (Uint32 x = 0; x < TestImgWidth / Downscale; ++x)
+            {
+                // Center of the block of the source pixels
+                auto RefX = x * Downscale + Downscale / 2;
+                auto RefY = y * Downscale + Downscale / 2;
+                for (Uint32 c = 0; c < NumComponents; ++c)
+                {
+                    auto RefVal  = RefPixels[(RefX + RefY * TestImgWidth) * NumComponents + c];
+                    auto TestVal = pTestPixels[x * DecodedImgDesc.NumComponents + c + y * DecodedImgDesc.RowStride];
+                    auto Diff    = std::abs(static_cast<int>(RefVal) - static_cast<int>(TestVal));
+                    EXPECT_LE(Diff, static_cast<int>(Downscale) * 2) << "Downscale " << Downscale << " [" << x << "," << y << "][" << c << "]";
+                }
+            }
+        }
+    }
+
+    RefCntAutoPtr<IDataBlob> pDecodedPixelsBlob{MakeNewRCObj<DataBlobImpl>()(0)};
+
+    ImageDesc DecodedImgDesc;
+    EXPECT_EQ(DecodeJpeg(pJpgData, pDecodedPixelsBlob, &DecodedImgDesc, 3), DECODE_JPEG_RESULT_INVALID_ARGUMENTS);
+}
+
 } // namespace
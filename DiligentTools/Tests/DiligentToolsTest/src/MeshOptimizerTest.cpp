@@ -0,0 +1,242 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <random>
+
+#include "MeshOptimizer.hpp"
+#include "BasicMath.hpp"
+#include "Timer.hpp"
+#include "DebugUtilities.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Regular grid of GridSize x GridSize quads
+struct GridMesh
+{
+    explicit GridMesh(Uint32 GridSize)
+    {
+        for (Uint32 y = 0; y <= GridSize; ++y)
+        {
+            for (Uint32 x = 0; x <= GridSize; ++x)
+                Positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.f);
+        }
+
+        for (Uint32 y = 0; y < GridSize; ++y)
+        {
+            for (Uint32 x = 0; x < GridSize; ++x)
+            {
+                const Uint32 v0 = y * (GridSize + 1) + x;
+                const Uint32 v1 = v0 + 1;
+                const Uint32 v2 = v0 + GridSize + 1;
+                const Uint32 v3 = v2 + 1;
+                Indices.insert(Indices.end(), {v0, v1, v2, v2, v1, v3});
+            }
+        }
+    }
+
+    void ShuffleTriangles(Uint32 Seed)
+    {
+        std::vector<std::array<Uint32, 3>> Tris(Indices.size() / 3);
+        memcpy(Tris.data(), Indices.data(), Indices.size() * sizeof(Uint32));
+        std::shuffle(Tris.begin(), Tris.end(), std::mt19937{Seed});
+        memcpy(Indices.data(), Tris.data(), Indices.size() * sizeof(Uint32));
+    }
+
+    std::vector<float3> Positions;
+    std::vector<Uint32> Indices;
+};
+
+// Returns the sorted list of triangles with every triangle rotated so that
+// its smallest index comes first, which preserves the winding order.
+std::vector<std::array<Uint32, 3>> GetCanonicalTriangles(const std::vector<Uint32>& Indices)
+{
+    std::vector<std::array<Uint32, 3>> Tris(Indices.size() / 3);
+    for (size_t t = 0; t < Tris.size(); ++t)
+    {
+        auto& Tri = Tris[t];
+        Tri       = {Indices[t * 3 + 0], Indices[t * 3 + 1], Indices[t * 3 + 2]};
+        std::rotate(Tri.begin(), std::min_element(Tri.begin(), Tri.end()), Tri.end());
+    }
+    std::sort(Tris.begin(), Tris.end());
+    return Tris;
+}
+
+TEST(Tools_AssetLoader, MeshOptimizerWeldVertices)
+{
+    GridMesh Grid{8};
+
+    // Unweld the mesh so that every index references its own vertex
+    std::vector<float3> Vertices;
+    std::vector<Uint32> Indices;
+    for (auto Idx : Grid.Indices)
+    {
+        Indices.push_back(static_cast<Uint32>(Vertices.size()));
+        Vertices.push_back(Grid.Positions[Idx]);
+    }
+    // Unreferenced vertex
+    Vertices.emplace_back(100.f, 100.f, 100.f);
+
+    const MeshOptimizerStream Stream{Vertices.data(), sizeof(float3), sizeof(float3)};
+
+    std::vector<Uint32> Remap(Vertices.size());
+    const auto          NumUniqueVertices = GenerateVertexRemap(Remap.data(), Indices.data(), Indices.size(), Vertices.size(), &Stream, 1);
+    EXPECT_EQ(NumUniqueVertices, Grid.Positions.size());
+    EXPECT_EQ(Remap.back(), ~0u);
+
+    std::vector<float3> WeldedVertices(NumUniqueVertices);
+    RemapVertexBuffer(WeldedVertices.data(), Vertices.data(), Vertices.size(), sizeof(float3), Remap.data());
+    RemapIndexBuffer(Indices.data(), Indices.data(), Indices.size(), Remap.data());
+    for (size_t i = 0; i < Indices.size(); ++i)
+    {
+        ASSERT_LT(Indices[i], NumUniqueVertices);
+        EXPECT_EQ(WeldedVertices[Indices[i]], Grid.Positions[Grid.Indices[i]]);
+    }
+}
+
+TEST(Tools_AssetLoader, MeshOptimizerVertexCache)
+{
+    constexpr Uint32 FIFOCacheSize = 16;
+
+    GridMesh Grid{128};
+    Grid.ShuffleTriangles(0);
+
+    const auto VertexCount = Grid.Positions.size();
+    const auto IndexCount  = Grid.Indices.size();
+
+    const float ACMRBefore = ComputeACMR(Grid.Indices.data(), IndexCount, VertexCount, FIFOCacheSize);
+
+    std::vector<Uint32> Optimized(IndexCount);
+
+    Timer  T;
+    double StartTime = T.GetElapsedTime();
+    OptimizeVertexCache(Optimized.data(), Grid.Indices.data(), IndexCount, VertexCount);
+    double OptimizeTime = T.GetElapsedTime() - StartTime;
+
+    const float ACMRAfter = ComputeACMR(Optimized.data(), IndexCount, VertexCount, FIFOCacheSize);
+    EXPECT_EQ(GetCanonicalTriangles(Optimized), GetCanonicalTriangles(Grid.Indices));
+    EXPECT_LT(ACMRAfter, ACMRBefore);
+    // Every vertex of a regular grid is shared by 6 triangles, so the ideal ACMR is 0.5
+    EXPECT_LT(ACMRAfter, 0.8f);
+
+    std::vector<Uint32> NoOverdraw(IndexCount);
+    OptimizeOverdraw(NoOverdraw.data(), Optimized.data(), IndexCount, &Grid.Positions[0].x, VertexCount, sizeof(float3));
+    const float ACMROverdraw = ComputeACMR(NoOverdraw.data(), IndexCount, VertexCount, FIFOCacheSize);
+    EXPECT_EQ(GetCanonicalTriangles(NoOverdraw), GetCanonicalTriangles(Grid.Indices));
+    // Reordering whole clusters may only add misses at cluster boundaries
+    EXPECT_LT(ACMROverdraw, ACMRAfter * 1.1f);
+
+    LOG_INFO_MESSAGE(IndexCount / 3, " triangles, ", FIFOCacheSize, "-entry FIFO cache ACMR: shuffled - ", ACMRBefore,
+                     ", vertex cache optimized - ", ACMRAfter, ", overdraw optimized - ", ACMROverdraw,
+                     ". Optimization time: ", OptimizeTime * 1000.0, " ms");
+}
+
+TEST(Tools_AssetLoader, MeshOptimizerVertexFetch)
+{
+    GridMesh Grid{16};
+    Grid.ShuffleTriangles(1);
+
+    std::vector<Uint32> Remap(Grid.Positions.size());
+    const auto          NumVertices = OptimizeVertexFetchRemap(Remap.data(), Grid.Indices.data(), Grid.Indices.size(), Grid.Positions.size());
+    EXPECT_EQ(NumVertices, Grid.Positions.size());
+
+    std::vector<float3> Positions(NumVertices);
+    RemapVertexBuffer(Positions.data(), Grid.Positions.data(), Grid.Positions.size(), sizeof(float3), Remap.data());
+
+    std::vector<Uint32> Indices(Grid.Indices.size());
+    RemapIndexBuffer(Indices.data(), Grid.Indices.data(), Grid.Indices.size(), Remap.data());
+
+    // Vertices must be referenced in order of their first use
+    Uint32 NextVertex = 0;
+    for (size_t i = 0; i < Indices.size(); ++i)
+    {
+        ASSERT_LE(Indices[i], NextVertex);
+        if (Indices[i] == NextVertex)
+            ++NextVertex;
+        EXPECT_EQ(Positions[Indices[i]], Grid.Positions[Grid.Indices[i]]);
+    }
+}
+
+TEST(Tools_AssetLoader, MeshOptimizerSimplify)
+{
+    GridMesh Grid{32};
+
+    const auto VertexCount = Grid.Positions.size();
+    const auto IndexCount  = Grid.Indices.size();
+
+    // Flat interior vertices can be removed without any error, while border vertices must stay
+    std::vector<Uint32> Simplified(IndexCount);
+
+    const auto TargetIndexCount     = IndexCount / 4;
+    float      Error                = -1;
+    const auto SimplifiedIndexCount = SimplifyMesh(Simplified.data(), Grid.Indices.data(), IndexCount, &Grid.Positions[0].x,
+                                                   VertexCount, sizeof(float3), TargetIndexCount, 0.01f, &Error);
+    EXPECT_LE(SimplifiedIndexCount, TargetIndexCount);
+    EXPECT_NEAR(Error, 0.f, 1e-3f);
+
+    float SimplifiedArea = 0;
+    for (size_t i = 0; i < SimplifiedIndexCount; i += 3)
+    {
+        const auto& P0 = Grid.Positions[Simplified[i + 0]];
+        const auto& P1 = Grid.Positions[Simplified[i + 1]];
+        const auto& P2 = Grid.Positions[Simplified[i + 2]];
+
+        // No triangle may flip
+        const auto N = cross(P1 - P0, P2 - P0);
+        EXPECT_GT(N.z, 0.f);
+        SimplifiedArea += N.z * 0.5f;
+    }
+    // The simplified mesh must still cover the whole grid
+    EXPECT_NEAR(SimplifiedArea, 32.f * 32.f, 1e-2f);
+
+    // Bend the grid so that every collapse introduces an error
+    for (auto& Pos : Grid.Positions)
+        Pos.z = std::sin(Pos.x * 0.5f) * std::sin(Pos.y * 0.5f) * 4.f;
+
+    float      ErrorSmall      = 0;
+    float      ErrorLarge      = 0;
+    const auto IndexCountSmall = SimplifyMesh(Simplified.data(), Grid.Indices.data(), IndexCount, &Grid.Positions[0].x,
+                                              VertexCount, sizeof(float3), 0, 1e-2f, &ErrorSmall);
+    const auto IndexCountLarge = SimplifyMesh(Simplified.data(), Grid.Indices.data(), IndexCount, &Grid.Positions[0].x,
+                                              VertexCount, sizeof(float3), 0, 5e-2f, &ErrorLarge);
+    EXPECT_LE(ErrorSmall, 1e-2f);
+    EXPECT_LE(ErrorLarge, 5e-2f);
+    EXPECT_LT(IndexCountLarge, IndexCountSmall);
+
+    LOG_INFO_MESSAGE("Simplified ", IndexCount / 3, "-triangle curved grid to ", IndexCountSmall / 3, " triangles at error ", ErrorSmall,
+                     " and to ", IndexCountLarge / 3, " triangles at error ", ErrorLarge);
+}
+
+} // namespace
@@ -0,0 +1,223 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "TextureLoader.h"
+#include "GraphicsAccessories.hpp"
+#include "ColorConversion.h"
+#include "Timer.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Straightforward per-channel implementation with float sRGB conversion
+template <typename ChannelType>
+void ComputeMipLevelRef(Uint32 FineWidth, Uint32 FineHeight, Uint32 NumChannels, bool IsSRGB,
+                        const Uint8* pFineData, Uint32 FineStride, Uint8* pCoarseData, Uint32 CoarseStride)
+{
+    const auto CoarseWidth  = std::max(FineWidth / 2u, 1u);
+    const auto CoarseHeight = std::max(FineHeight / 2u, 1u);
+    const auto MaxVal       = static_cast<float>(std::numeric_limits<ChannelType>::max());
+    for (Uint32 row = 0; row < CoarseHeight; ++row)
+    {
+        const auto* pSrcRow0 = reinterpret_cast<const ChannelType*>(pFineData + row * 2 * FineStride);
+        const auto* pSrcRow1 = reinterpret_cast<const ChannelType*>(pFineData + std::min(row * 2 + 1, FineHeight - 1) * FineStride);
+        auto*       pDstRow  = reinterpret_cast<ChannelType*>(pCoarseData + row * CoarseStride);
+        for (Uint32 col = 0; col < CoarseWidth; ++col)
+        {
+            const auto src_col0 = col * 2;
+            const auto src_col1 = std::min(col * 2 + 1, FineWidth - 1);
+            for (Uint32 c = 0; c < NumChannels; ++c)
+            {
+                const ChannelType Chnls[] = {
+                    pSrcRow0[src_col0 * NumChannels + c],
+                    pSrcRow0[src_col1 * NumChannels + c],
+                    pSrcRow1[src_col0 * NumChannels + c],
+                    pSrcRow1[src_col1 * NumChannels + c] //
+                };
+
+                auto& Dst = pDstRow[col * NumChannels + c];
+                if (IsSRGB && c < 3)
+                {
+                    float Linear = 0;
+                    for (auto Chnl : Chnls)
+                        Linear += SRGBToLinear(static_cast<float>(Chnl) / MaxVal) * 0.25f;
+                    Dst = static_cast<ChannelType>(std::min(LinearToSRGB(Linear) * MaxVal + 0.5f, MaxVal));
+                }
+                else
+                {
+                    Dst = static_cast<ChannelType>((Uint32{Chnls[0]} + Uint32{Chnls[1]} + Uint32{Chnls[2]} + Uint32{Chnls[3]}) / 4);
+                }
+            }
+        }
+    }
+}
+
+struct MipLevelData
+{
+    MipLevelData(Uint32 _Width, Uint32 _Height, TEXTURE_FORMAT _Fmt) :
+        Width{_Width},
+        Height{_Height},
+        Fmt{_Fmt}
+    {
+        const auto& FmtAttribs = GetTextureFormatAttribs(Fmt);
+
+        NumChannels = FmtAttribs.NumComponents;
+        IsSRGB      = FmtAttribs.ComponentType == COMPONENT_TYPE_UNORM_SRGB;
+        ChannelSize = FmtAttribs.ComponentSize;
+
+        FineStride   = (Width * NumChannels * ChannelSize + 3) & ~3u;
+        CoarseStride = (std::max(Width / 2u, 1u) * NumChannels * ChannelSize + 3) & ~3u;
+
+        FineData.resize(size_t{FineStride} * Height);
+        const auto CoarseDataSize = size_t{CoarseStride} * std::max(Height / 2u, 1u);
+        CoarseData.resize(CoarseDataSize);
+        RefCoarseData.resize(CoarseDataSize);
+
+        std::mt19937 Gen{Width * 31 + Height};
+        for (auto& Byte : FineData)
+            Byte = static_cast<Uint8>(Gen());
+    }
+
+    void Compute()
+    {
+        ComputeMipLevel(Width, Height, Fmt, FineData.data(), FineStride, CoarseData.data(), CoarseStride);
+    }
+
+    void ComputeRef()
+    {
+        if (ChannelSize == 1)
+            ComputeMipLevelRef<Uint8>(Width, Height, NumChannels, IsSRGB, FineData.data(), FineStride, RefCoarseData.data(), CoarseStride);
+        else
+            ComputeMipLevelRef<Uint16>(Width, Height, NumChannels, IsSRGB, FineData.data(), FineStride, RefCoarseData.data(), CoarseStride);
+    }
+
+    // Returns the maximum difference between the coarse level and the reference
+    Uint32 Compare() const
+    {
+        Uint32 MaxDiff = 0;
+        for (Uint32 row = 0; row < std::max(Height / 2u, 1u); ++row)
+        {
+            for (Uint32 i = 0; i < std::max(Width / 2u, 1u) * NumChannels; ++i)
+            {
+                const auto Offset = size_t{row} * CoarseStride + i * ChannelSize;
+
+                Uint32 Val = 0, RefVal = 0;
+                memcpy(&Val, &CoarseData[Offset], ChannelSize);
+                memcpy(&RefVal, &RefCoarseData[Offset], ChannelSize);
+                MaxDiff = std::max(MaxDiff, Val > RefVal ? Val - RefVal : RefVal - Val);
+            }
+        }
+        return MaxDiff;
+    }
+
+    const Uint32         Width;
+    const Uint32         Height;
+    const TEXTURE_FORMAT Fmt;
+
+    Uint32 NumChannels  = 0;
+    Uint32 ChannelSize  = 0;
+    bool   IsSRGB       = false;
+    Uint32 FineStride   = 0;
+    Uint32 CoarseStride = 0;
+
+    std::vector<Uint8> FineData;
+    std::vector<Uint8> CoarseData;
+    std::vector<Uint8> RefCoarseData;
+};
+
+TEST(Tools_TextureLoader, ComputeMipLevel)
+{
+    const TEXTURE_FORMAT Formats[] = {
+        TEX_FORMAT_R8_UNORM,
+        TEX_FORMAT_RG8_UNORM,
+        TEX_FORMAT_RGBA8_UNORM,
+        TEX_FORMAT_RGBA8_UNORM_SRGB,
+        TEX_FORMAT_R16_UNORM,
+        TEX_FORMAT_RGBA16_UNORM //
+    };
+    // Sizes that exercise SIMD loops as well as the scalar tails
+    const Uint32 Sizes[] = {1, 2, 3, 7, 8, 9, 17, 33, 64, 100};
+    for (auto Fmt : Formats)
+    {
+        for (auto Width : Sizes)
+        {
+            for (auto Height : Sizes)
+            {
+                MipLevelData Level{Width, Height, Fmt};
+                Level.Compute();
+                Level.ComputeRef();
+                // sRGB values may differ by one due to the lookup-table conversion
+                EXPECT_LE(Level.Compare(), Level.IsSRGB ? 1u : 0u) << GetTextureFormatAttribs(Fmt).Name << ' ' << Width << 'x' << Height;
+            }
+        }
+    }
+
+    // Large levels are processed by multiple threads
+    MipLevelData Level{2048, 2048, TEX_FORMAT_RGBA8_UNORM};
+    Level.Compute();
+    Level.ComputeRef();
+    EXPECT_EQ(Level.Compare(), 0u);
+}
+
+TEST(Tools_TextureLoader, ComputeMipLevelPerf)
+{
+    for (auto Fmt : {TEX_FORMAT_RGBA8_UNORM, TEX_FORMAT_RGBA8_UNORM_SRGB, TEX_FORMAT_RGBA16_UNORM})
+    {
+        MipLevelData Level{4096, 4096, Fmt};
+
+        // Warm up the lookup tables and the thread pool
+        Level.Compute();
+
+        Timer  T;
+        double StartTime = T.GetElapsedTime();
+        Level.ComputeRef();
+        double RefTime = T.GetElapsedTime() - StartTime;
+
+        StartTime = T.GetElapsedTime();
+        Level.Compute();
+        double Time = T.GetElapsedTime() - StartTime;
+
+        EXPECT_LE(Level.Compare(), Level.IsSRGB ? 1u : 0u);
+
+        LOG_INFO_MESSAGE("4096x4096 ", GetTextureFormatAttribs(Fmt).Name, " coarse mip: per-channel reference - ", RefTime * 1000.0,
+                         " ms, ComputeMipLevel - ", Time * 1000.0, " ms");
+    }
+}
+
+} // namespace
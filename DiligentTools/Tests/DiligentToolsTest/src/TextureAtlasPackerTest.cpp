@@ -0,0 +1,165 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <vector>
+
+#include "TextureAtlasPacker.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+bool RegionsOverlap(const TextureAtlasRegion& R0, const TextureAtlasRegion& R1, Uint32 Padding)
+{
+    return R0.X - Padding < R1.X + R1.Width + Padding && R1.X - Padding < R0.X + R0.Width + Padding &&
+        R0.Y - Padding < R1.Y + R1.Height + Padding && R1.Y - Padding < R0.Y + R0.Height + Padding;
+}
+
+TEST(Tools_AssetLoader, PackTextureAtlas)
+{
+    constexpr Uint32 AtlasSize = 512;
+    constexpr Uint32 Padding   = 8;
+
+    std::vector<TextureAtlasRegion> Regions;
+    for (Uint32 Size : {64u, 128u, 100u, 32u, 60u, 128u, 16u, 250u})
+    {
+        TextureAtlasRegion Region;
+        Region.Width  = Size;
+        Region.Height = Size / 2 + 3;
+        Regions.push_back(Region);
+    }
+
+    const auto UsedSize = PackTextureAtlas(AtlasSize, AtlasSize, Padding, Padding, Regions.data(), Regions.size());
+    EXPECT_LE(UsedSize.x, AtlasSize);
+    EXPECT_LE(UsedSize.y, AtlasSize);
+    EXPECT_EQ(UsedSize.x % Padding, 0u);
+    EXPECT_EQ(UsedSize.y % Padding, 0u);
+
+    for (size_t i = 0; i < Regions.size(); ++i)
+    {
+        const auto& Region = Regions[i];
+        ASSERT_TRUE(Region.IsPacked);
+        // Padded regions are aligned and fit into the used part of the atlas
+        EXPECT_EQ((Region.X - Padding) % Padding, 0u);
+        EXPECT_EQ((Region.Y - Padding) % Padding, 0u);
+        EXPECT_LE(Region.X + Region.Width + Padding, UsedSize.x);
+        EXPECT_LE(Region.Y + Region.Height + Padding, UsedSize.y);
+        for (size_t j = 0; j < i; ++j)
+            EXPECT_FALSE(RegionsOverlap(Region, Regions[j], Padding)) << "regions " << i << " and " << j;
+    }
+}
+
+TEST(Tools_AssetLoader, PackTextureAtlasOverflow)
+{
+    // Two rows of two padded 112x112 cells fit into a 256x256 atlas
+    std::vector<TextureAtlasRegion> Regions(6);
+    for (auto& Region : Regions)
+    {
+        Region.Width  = 100;
+        Region.Height = 100;
+    }
+    Regions[5].Width = 300;
+
+    const auto UsedSize = PackTextureAtlas(256, 256, 4, 16, Regions.data(), Regions.size());
+    EXPECT_EQ(UsedSize, uint2(224, 224));
+
+    Uint32 NumPacked = 0;
+    for (const auto& Region : Regions)
+        NumPacked += Region.IsPacked ? 1 : 0;
+    EXPECT_EQ(NumPacked, 4u);
+    // The texture is wider than the atlas
+    EXPECT_FALSE(Regions[5].IsPacked);
+}
+
+TEST(Tools_AssetLoader, CopyToTextureAtlas)
+{
+    constexpr Uint32 Padding    = 2;
+    constexpr Uint32 AtlasWidth = 8;
+
+    // 3x2 texture whose texels store their coordinates
+    std::vector<Uint8> Texture(3 * 2 * 4);
+    for (Uint32 y = 0; y < 2; ++y)
+    {
+        for (Uint32 x = 0; x < 3; ++x)
+        {
+            auto* pTexel = &Texture[(y * 3 + x) * 4];
+            pTexel[0]    = static_cast<Uint8>(x);
+            pTexel[1]    = static_cast<Uint8>(y);
+            pTexel[2]    = 0;
+            pTexel[3]    = 255;
+        }
+    }
+
+    TextureAtlasRegion Region;
+    Region.X        = Padding + 1;
+    Region.Y        = Padding;
+    Region.Width    = 3;
+    Region.Height   = 2;
+    Region.IsPacked = true;
+
+    std::vector<Uint8> Atlas(AtlasWidth * 6 * 4, 77);
+    CopyToTextureAtlas(Region, Padding, Texture.data(), 3 * 4, Atlas.data(), AtlasWidth * 4);
+
+    for (Uint32 y = 0; y < 6; ++y)
+    {
+        for (Uint32 x = 0; x < AtlasWidth; ++x)
+        {
+            const auto* pTexel = &Atlas[(y * AtlasWidth + x) * 4];
+            if (x < 1 || x >= 1 + 3 + Padding * 2)
+            {
+                // Texels outside of the padded region are not modified
+                EXPECT_EQ(pTexel[0], 77);
+                continue;
+            }
+
+            // The padding repeats the texture
+            const Uint32 TexX = (x - Region.X + 3 * 2) % 3;
+            const Uint32 TexY = (y - Region.Y + 2 * 2) % 2;
+            EXPECT_EQ(pTexel[0], TexX) << "x=" << x << " y=" << y;
+            EXPECT_EQ(pTexel[1], TexY) << "x=" << x << " y=" << y;
+            EXPECT_EQ(pTexel[3], 255);
+        }
+    }
+}
+
+TEST(Tools_AssetLoader, TextureAtlasUVScaleBias)
+{
+    TextureAtlasRegion Region;
+    Region.X      = 64;
+    Region.Y      = 32;
+    Region.Width  = 128;
+    Region.Height = 64;
+
+    const auto ScaleBias = GetTextureAtlasUVScaleBias(Region, 512, 256);
+    EXPECT_EQ(ScaleBias, float4(0.25f, 0.25f, 0.125f, 0.125f));
+}
+
+} // namespace
@@ -0,0 +1,317 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "TextureLoader.h"
+#include "GraphicsAccessories.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+void DecodeRGB565(Uint32 Color, int RGB[3])
+{
+    const auto R = (Color >> 11) & 31;
+    const auto G = (Color >> 5) & 63;
+    const auto B = Color & 31;
+
+    RGB[0] = static_cast<int>((R << 3) | (R >> 2));
+    RGB[1] = static_cast<int>((G << 2) | (G >> 4));
+    RGB[2] = static_cast<int>((B << 3) | (B >> 2));
+}
+
+// Decodes the color part of a BC1/BC3 block into RGBA texels
+void DecodeBC1Block(const Uint8* pBlock, Uint8* pRGBA)
+{
+    const Uint32 Color0 = pBlock[0] | (pBlock[1] << 8);
+    const Uint32 Color1 = pBlock[2] | (pBlock[3] << 8);
+
+    int Palette[4][3];
+    DecodeRGB565(Color0, Palette[0]);
+    DecodeRGB565(Color1, Palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        if (Color0 > Color1)
+        {
+            Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+            Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+        }
+        else
+        {
+            Palette[2][c] = (Palette[0][c] + Palette[1][c]) / 2;
+            Palette[3][c] = 0;
+        }
+    }
+
+    const Uint32 Indices = pBlock[4] | (pBlock[5] << 8) | (pBlock[6] << 16) | (Uint32{pBlock[7]} << 24);
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+            pRGBA[i * 4 + c] = static_cast<Uint8>(Palette[(Indices >> (i * 2)) & 3][c]);
+    }
+}
+
+// Decodes a BC4 block into every Stride-th byte of pValues
+void DecodeBC4Block(const Uint8* pBlock, Uint8* pValues, Uint32 Stride)
+{
+    const int Value0 = pBlock[0];
+    const int Value1 = pBlock[1];
+
+    int Palette[8] = {Value0, Value1};
+    if (Value0 > Value1)
+    {
+        for (int p = 2; p < 8; ++p)
+            Palette[p] = ((8 - p) * Value0 + (p - 1) * Value1) / 7;
+    }
+    else
+    {
+        for (int p = 2; p < 6; ++p)
+            Palette[p] = ((6 - p) * Value0 + (p - 1) * Value1) / 5;
+        Palette[6] = 0;
+        Palette[7] = 255;
+    }
+
+    Uint64 Indices = 0;
+    for (Uint32 b = 0; b < 6; ++b)
+        Indices |= Uint64{pBlock[2 + b]} << (b * 8);
+    for (Uint32 i = 0; i < 16; ++i)
+        pValues[i * Stride] = static_cast<Uint8>(Palette[(Indices >> (i * 3)) & 7]);
+}
+
+Uint32 ReadBits(const Uint8* pBlock, Uint32& Pos, Uint32 NumBits)
+{
+    Uint32 Value = 0;
+    for (Uint32 b = 0; b < NumBits; ++b, ++Pos)
+        Value |= ((pBlock[Pos >> 3] >> (Pos & 7)) & 1u) << b;
+    return Value;
+}
+
+// Decodes a BC7 block encoded in mode 6
+void DecodeBC7Mode6Block(const Uint8* pBlock, Uint8* pRGBA)
+{
+    Uint32 Pos = 0;
+    ASSERT_EQ(ReadBits(pBlock, Pos, 7), 1u << 6) << "Only mode 6 blocks are expected";
+
+    int Endpoints[2][4];
+    for (int c = 0; c < 4; ++c)
+    {
+        Endpoints[0][c] = static_cast<int>(ReadBits(pBlock, Pos, 7));
+        Endpoints[1][c] = static_cast<int>(ReadBits(pBlock, Pos, 7));
+    }
+    for (int e = 0; e < 2; ++e)
+    {
+        const auto P = static_cast<int>(ReadBits(pBlock, Pos, 1));
+        for (int c = 0; c < 4; ++c)
+            Endpoints[e][c] = (Endpoints[e][c] << 1) | P;
+    }
+
+    static constexpr int Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        const auto Idx = ReadBits(pBlock, Pos, i == 0 ? 3 : 4);
+        for (int c = 0; c < 4; ++c)
+            pRGBA[i * 4 + c] = static_cast<Uint8>(((64 - Weights[Idx]) * Endpoints[0][c] + Weights[Idx] * Endpoints[1][c] + 32) >> 6);
+    }
+    EXPECT_EQ(Pos, 128u);
+}
+
+// Compresses the RGBA8 image, decodes it back and returns the PSNR of every channel.
+// Channels that the format does not store are ignored.
+std::array<double, 4> CompressAndDecode(const std::vector<Uint8>& RGBA, Uint32 Width, Uint32 Height, TEXTURE_FORMAT Fmt)
+{
+    const auto BlockSize   = Uint32{GetTextureFormatAttribs(Fmt).ComponentSize};
+    const auto NumBlocksX  = (Width + 3) / 4;
+    const auto NumBlocksY  = (Height + 3) / 4;
+    const auto BlockStride = NumBlocksX * BlockSize;
+
+    std::vector<Uint8> Blocks(size_t{BlockStride} * NumBlocksY);
+    CompressMipLevel(Width, Height, TEX_FORMAT_RGBA8_UNORM, RGBA.data(), Width * 4, Fmt, Blocks.data(), BlockStride);
+
+    double SqError[4] = {};
+    for (Uint32 by = 0; by < NumBlocksY; ++by)
+    {
+        for (Uint32 bx = 0; bx < NumBlocksX; ++bx)
+        {
+            const auto* pBlock = &Blocks[size_t{by} * BlockStride + bx * BlockSize];
+
+            Uint8 Decoded[16 * 4] = {};
+            switch (Fmt)
+            {
+                case TEX_FORMAT_BC1_UNORM: DecodeBC1Block(pBlock, Decoded); break;
+                case TEX_FORMAT_BC3_UNORM:
+                    DecodeBC4Block(pBlock, Decoded + 3, 4);
+                    DecodeBC1Block(pBlock + 8, Decoded);
+                    break;
+                case TEX_FORMAT_BC4_UNORM: DecodeBC4Block(pBlock, Decoded, 4); break;
+                case TEX_FORMAT_BC5_UNORM:
+                    DecodeBC4Block(pBlock, Decoded, 4);
+                    DecodeBC4Block(pBlock + 8, Decoded + 1, 4);
+                    break;
+                case TEX_FORMAT_BC7_UNORM: DecodeBC7Mode6Block(pBlock, Decoded); break;
+                default: ADD_FAILURE() << "Unexpected format";
+            }
+
+            for (Uint32 i = 0; i < 16; ++i)
+            {
+                const auto x = bx * 4 + i % 4;
+                const auto y = by * 4 + i / 4;
+                if (x >= Width || y >= Height)
+                    continue;
+                for (Uint32 c = 0; c < 4; ++c)
+                {
+                    const auto Diff = static_cast<double>(RGBA[(size_t{y} * Width + x) * 4 + c]) - static_cast<double>(Decoded[i * 4 + c]);
+                    SqError[c] += Diff * Diff;
+                }
+            }
+        }
+    }
+
+    std::array<double, 4> PSNR;
+    for (Uint32 c = 0; c < 4; ++c)
+    {
+        const auto MSE = SqError[c] / (static_cast<double>(Width) * Height);
+        PSNR[c]        = MSE > 0 ? 10.0 * std::log10(255.0 * 255.0 / MSE) : 100.0;
+    }
+    return PSNR;
+}
+
+// Smooth color gradients with an alpha ramp. Gradients are slow compared to the block size,
+// as in most real textures.
+std::vector<Uint8> CreateTestImage(Uint32 Width, Uint32 Height)
+{
+    std::vector<Uint8> RGBA(size_t{Width} * Height * 4);
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        for (Uint32 x = 0; x < Width; ++x)
+        {
+            auto* pTexel = &RGBA[(size_t{y} * Width + x) * 4];
+            pTexel[0]    = static_cast<Uint8>(127.5 + 127.0 * std::sin(x * 0.05) * std::cos(y * 0.03));
+            pTexel[1]    = static_cast<Uint8>(std::min((x + y) * 2u, 255u));
+            pTexel[2]    = static_cast<Uint8>(127.5 + 100.0 * std::sin(x * 0.02 + y * 0.01));
+            pTexel[3]    = static_cast<Uint8>(255u - std::min(y * 2u, 255u));
+        }
+    }
+    return RGBA;
+}
+
+} // namespace
+
+TEST(Tools_TextureLoader, GetCompressedTextureFormat)
+{
+    EXPECT_EQ(GetCompressedTextureFormat(TEXTURE_LOAD_COMPRESS_MODE_NONE, false, false), TEX_FORMAT_UNKNOWN);
+    EXPECT_EQ(GetCompressedTextureFormat(TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR, false, false), TEX_FORMAT_BC1_UNORM);
+    EXPECT_EQ(GetCompressedTextureFormat(TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR, true, true), TEX_FORMAT_BC3_UNORM_SRGB);
+    EXPECT_EQ(GetCompressedTextureFormat(TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR_HQ, true, false), TEX_FORMAT_BC7_UNORM);
+    EXPECT_EQ(GetCompressedTextureFormat(TEXTURE_LOAD_COMPRESS_MODE_BC_NORMAL, false, false), TEX_FORMAT_BC5_UNORM);
+    EXPECT_EQ(GetCompressedTextureFormat(TEXTURE_LOAD_COMPRESS_MODE_BC_SINGLE_CHANNEL, false, false), TEX_FORMAT_BC4_UNORM);
+}
+
+TEST(Tools_TextureLoader, CompressMipLevel)
+{
+    struct FormatInfo
+    {
+        TEXTURE_FORMAT Fmt;
+        Uint32         NumChannels;
+        double         MinPSNR;
+    };
+    const FormatInfo Formats[] = {
+        {TEX_FORMAT_BC1_UNORM, 3, 35},
+        {TEX_FORMAT_BC3_UNORM, 4, 35},
+        {TEX_FORMAT_BC4_UNORM, 1, 45},
+        {TEX_FORMAT_BC5_UNORM, 2, 45},
+        {TEX_FORMAT_BC7_UNORM, 4, 40} //
+    };
+    // Sizes that are not multiples of 4 exercise partial blocks of the coarse mip levels
+    const Uint32 Sizes[] = {1, 3, 4, 13, 64, 512};
+    for (const auto& Info : Formats)
+    {
+        for (auto Size : Sizes)
+        {
+            const auto RGBA = CreateTestImage(Size, Size);
+            const auto PSNR = CompressAndDecode(RGBA, Size, Size, Info.Fmt);
+            for (Uint32 c = 0; c < Info.NumChannels; ++c)
+                EXPECT_GE(PSNR[c], Info.MinPSNR) << GetTextureFormatAttribs(Info.Fmt).Name << ' ' << Size << 'x' << Size << " channel " << c;
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, CompressSolidBlock)
+{
+    std::vector<Uint8> RGBA(16 * 4);
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        RGBA[i * 4 + 0] = 200;
+        RGBA[i * 4 + 1] = 100;
+        RGBA[i * 4 + 2] = 40;
+        RGBA[i * 4 + 3] = 128;
+    }
+
+    // BC4 and BC5 reproduce solid blocks exactly
+    for (auto Fmt : {TEX_FORMAT_BC4_UNORM, TEX_FORMAT_BC5_UNORM, TEX_FORMAT_BC3_UNORM})
+    {
+        Uint8 Block[16] = {};
+        CompressMipLevel(4, 4, TEX_FORMAT_RGBA8_UNORM, RGBA.data(), 16, Fmt, Block, 16);
+
+        Uint8 Decoded[16 * 4] = {};
+        if (Fmt == TEX_FORMAT_BC3_UNORM)
+        {
+            DecodeBC4Block(Block, Decoded + 3, 4);
+            EXPECT_EQ(Decoded[3], 128);
+        }
+        else
+        {
+            DecodeBC4Block(Block, Decoded, 4);
+            EXPECT_EQ(Decoded[0], 200);
+            if (Fmt == TEX_FORMAT_BC5_UNORM)
+            {
+                DecodeBC4Block(Block + 8, Decoded + 1, 4);
+                EXPECT_EQ(Decoded[1], 100);
+            }
+        }
+    }
+
+    // BC1 and BC7 are limited by the endpoint precision
+    Uint8 Block[16]       = {};
+    Uint8 Decoded[16 * 4] = {};
+    CompressMipLevel(4, 4, TEX_FORMAT_RGBA8_UNORM, RGBA.data(), 16, TEX_FORMAT_BC1_UNORM, Block, 8);
+    DecodeBC1Block(Block, Decoded);
+    for (int c = 0; c < 3; ++c)
+        EXPECT_NEAR(Decoded[c], RGBA[c], 8);
+
+    CompressMipLevel(4, 4, TEX_FORMAT_RGBA8_UNORM, RGBA.data(), 16, TEX_FORMAT_BC7_UNORM, Block, 16);
+    DecodeBC7Mode6Block(Block, Decoded);
+    for (int c = 0; c < 4; ++c)
+        EXPECT_NEAR(Decoded[c], RGBA[c], 1);
+}
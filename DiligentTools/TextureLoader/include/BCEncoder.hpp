@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/GraphicsTypes.h"
+
+namespace Diligent
+{
+
+/// Encodes a block of 4x4 RGBA8 texels into a BC1 block (8 bytes). Alpha is ignored and the block
+/// always uses the four-color mode, so that it can also be used as the color part of a BC3 block.
+void EncodeBC1Block(const Uint8 RGBA[16 * 4], Uint8* pBlock);
+
+/// Encodes a block of 4x4 RGBA8 texels into a BC3 block (16 bytes).
+void EncodeBC3Block(const Uint8 RGBA[16 * 4], Uint8* pBlock);
+
+/// Encodes a block of 4x4 8-bit values into a BC4 block (8 bytes).
+void EncodeBC4Block(const Uint8 Values[16], Uint8* pBlock);
+
+/// Encodes a block of 4x4 RG8 texels into a BC5 block (16 bytes).
+void EncodeBC5Block(const Uint8 RG[16 * 2], Uint8* pBlock);
+
+/// Encodes a block of 4x4 RGBA8 texels into a BC7 block (16 bytes). Only mode 6
+/// (one subset, RGBA endpoints with 7 bits and a p-bit, 4-bit indices) is used.
+void EncodeBC7Block(const Uint8 RGBA[16 * 4], Uint8* pBlock);
+
+/// Compresses a texture level into BC blocks.
+
+/// \param [in]  Width          - Level width.
+/// \param [in]  Height         - Level height.
+/// \param [in]  pSrc           - Level texels, 8 bits per channel.
+/// \param [in]  SrcStride      - Row stride of the level, in bytes.
+/// \param [in]  SrcNumChannels - Number of channels in the source texel (1, 2 or 4).
+///                               BC1, BC3 and BC7 require 4 channels, BC5 requires at least 2,
+///                               BC4 uses the first channel.
+/// \param [in]  DstFmt         - BC1, BC3, BC4, BC5 or BC7 UNORM or sRGB format.
+/// \param [out] pDst           - Compressed data, (Width+3)/4 x (Height+3)/4 blocks.
+/// \param [in]  DstStride      - Row stride of the compressed data (one row of blocks), in bytes.
+///
+/// \return     true if the level was compressed, and false if the formats are not supported.
+///
+/// \remarks    Blocks that extend past the level boundary replicate the edge texels.
+///             Rows of blocks of large levels are distributed between the worker threads
+///             of the texture loader pool.
+bool CompressBlocks(Uint32         Width,
+                    Uint32         Height,
+                    const Uint8*   pSrc,
+                    Uint32         SrcStride,
+                    Uint32         SrcNumChannels,
+                    TEXTURE_FORMAT DstFmt,
+                    Uint8*         pDst,
+                    Uint32         DstStride);
+
+} // namespace Diligent
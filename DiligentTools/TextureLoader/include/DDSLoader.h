@@ -49,6 +49,7 @@
 
 #include "RenderDevice.h"
 #include "Texture.h"
+#include "FileStream.h"
 
 void CreateDDSTextureFromMemory(
     Diligent::IRenderDevice* pDevice,
@@ -73,3 +74,10 @@ void CreateDDSTextureFromMemoryEx(
     Diligent::ITexture**         texture /*,
     D2D1_ALPHA_MODE* alphaMode*/
 );
+
+// Writes the texture to the stream in DDS format with the DX10 header.
+// Subresources must be given in the same order as in texture initialization data.
+bool SaveDDSTextureToStream(
+    Diligent::IFileStream*       pStream,
+    const Diligent::TextureDesc& desc,
+    const Diligent::TextureData& texData);
@@ -64,14 +64,18 @@ DILIGENT_TYPED_ENUM(ENCODE_JPEG_RESULT, Uint32)
 
 /// Decodes jpeg image.
 
-/// \param [in]  pSrcJpegBits - JPEG image encoded bits.
-/// \param [out] pDstPixels   - Decoded pixels data blob. The pixels are always tightly packed
-///                             (for instance, components of 3-channel image will be written as |r|g|b|r|g|b|r|g|b|...).
-/// \param [out] pDstImgDesc  - Decoded image description.
-/// \return                     Decoding result, see Diligent::DECODE_JPEG_RESULT.
+/// \param [in]  pSrcJpegBits    - JPEG image encoded bits.
+/// \param [out] pDstPixels      - Decoded pixels data blob. The pixels are always tightly packed
+///                                (for instance, components of 3-channel image will be written as |r|g|b|r|g|b|r|g|b|...).
+/// \param [out] pDstImgDesc     - Decoded image description.
+/// \param [in]  DownscaleFactor - Factor (1, 2, 4 or 8) by which the image is downscaled while decoding.
+///                                Downscaling is performed in the DCT domain and is much faster than
+///                                decoding the full image.
+/// \return                        Decoding result, see Diligent::DECODE_JPEG_RESULT.
 DECODE_JPEG_RESULT DILIGENT_GLOBAL_FUNCTION(DecodeJpeg)(IDataBlob* pSrcJpegBits,
                                                         IDataBlob* pDstPixels,
-                                                        ImageDesc* pDstImgDesc);
+                                                        ImageDesc* pDstImgDesc,
+                                                        Uint32     DownscaleFactor);
 
 
 /// Encodes an image jpeg PNG format.
@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// Returns the pool of worker threads shared by the CPU texture processing functions
+/// (mip generation and block compression).
+ThreadPool& GetTextureLoaderThreadPool();
+
+/// Computes the coarse mip level by averaging 2x2 blocks of texels of the fine level.
+
+/// \param [in]  NumChannels     - Number of channels in the texel.
+/// \param [in]  ComponentSize   - Size of one channel, in bytes. Only 1 and 2 are supported.
+/// \param [in]  IsSRGB          - Whether the color channels are sRGB-encoded. Color channels
+///                                are then averaged in linear space, while the alpha channel
+///                                of a four-channel texel is always averaged as is.
+/// \param [in]  pFineMip        - Fine mip level data.
+/// \param [in]  FineMipStride   - Fine mip level row stride, in bytes.
+/// \param [in]  FineMipWidth    - Fine mip level width.
+/// \param [in]  FineMipHeight   - Fine mip level height.
+/// \param [out] pCoarseMip      - Coarse mip level data.
+/// \param [in]  CoarseMipStride - Coarse mip level row stride, in bytes.
+/// \param [in]  CoarseMipWidth  - Coarse mip level width, max(FineMipWidth/2, 1).
+/// \param [in]  CoarseMipHeight - Coarse mip level height, max(FineMipHeight/2, 1).
+///
+/// \remarks    Four-channel texels are processed with SSE2 or AVX2 instructions when the
+///             library is compiled for the corresponding instruction set. Rows of large
+///             levels are distributed between the worker threads of an internal pool.
+void ComputeCoarseMip(Uint32      NumChannels,
+                      Uint32      ComponentSize,
+                      bool        IsSRGB,
+                      const void* pFineMip,
+                      Uint32      FineMipStride,
+                      Uint32      FineMipWidth,
+                      Uint32      FineMipHeight,
+                      void*       pCoarseMip,
+                      Uint32      CoarseMipStride,
+                      Uint32      CoarseMipWidth,
+                      Uint32      CoarseMipHeight);
+
+} // namespace Diligent
@@ -65,6 +65,11 @@ struct ImageLoadInfo
 {
     /// Image file format
     IMAGE_FILE_FORMAT Format DEFAULT_INITIALIZER(IMAGE_FILE_FORMAT_UNKNOWN);
+
+    /// Factor (1, 2, 4 or 8) by which the image is downscaled while it is decoded.
+    /// Only JPEG images support downscaled decoding, other images are always decoded
+    /// at full resolution.
+    Uint32 DownscaleFactor DEFAULT_INITIALIZER(1);
 };
 typedef struct ImageLoadInfo ImageLoadInfo;
 
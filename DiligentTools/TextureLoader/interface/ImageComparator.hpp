@@ -0,0 +1,141 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+
+namespace Diligent
+{
+
+/// Image comparison attributes
+struct ImageCompareInfo
+{
+    /// Image width and height in pixels
+    Uint32 Width  = 0;
+    Uint32 Height = 0;
+
+    /// Number of 8-bit components per pixel, the same for both images
+    Uint32 NumComponents = 0;
+
+    /// Number of the first components that are compared, e.g. 3 to ignore
+    /// the alpha channel of RGBA images. 0 means all components.
+    Uint32 NumComparedComponents = 0;
+
+    /// Tested image data and row stride in bytes
+    const void* pImage = nullptr;
+    Uint32      Stride = 0;
+
+    /// Reference (golden) image data and row stride in bytes
+    const void* pReference      = nullptr;
+    Uint32      ReferenceStride = 0;
+
+    /// A pixel is different when any compared component differs by more than the tolerance
+    Uint32 Tolerance = 0;
+
+    /// Size of the tiles for which the statistics are collected
+    Uint32 TileSize = 32;
+
+    /// Whether to create the diff image, see ImageComparison::DiffImage
+    bool CreateDiffImage = false;
+};
+
+/// Difference statistics of an image tile
+struct ImageTileDiff
+{
+    /// Number of different pixels
+    Uint32 NumDiffPixels = 0;
+
+    /// Maximum absolute difference of a component
+    Uint32 MaxError = 0;
+
+    /// Sum of squared component differences
+    Uint64 SumSquaredError = 0;
+};
+
+/// Result of the image comparison
+struct ImageComparison
+{
+    Uint32 Width    = 0;
+    Uint32 Height   = 0;
+    Uint32 TileSize = 0;
+
+    /// Number of different pixels
+    Uint32 NumDiffPixels = 0;
+
+    /// Maximum absolute difference of a component
+    Uint32 MaxError = 0;
+
+    /// Mean squared difference of the compared components
+    double MeanSquaredError = 0;
+
+    /// Peak signal-to-noise ratio in dB. Infinity if the images are identical.
+    double PSNR = 0;
+
+    /// Number of tiles that contain different pixels
+    Uint32 NumDiffTiles = 0;
+
+    /// Tile statistics, NumTilesX x NumTilesY tiles in row-major order
+    Uint32                     NumTilesX = 0;
+    Uint32                     NumTilesY = 0;
+    std::vector<ImageTileDiff> Tiles;
+
+    /// Tightly packed RGB8 image where different pixels are red, brighter for larger errors,
+    /// and other pixels show the darkened luminance of the reference image.
+    /// Empty if ImageCompareInfo::CreateDiffImage is false.
+    std::vector<Uint8> DiffImage;
+
+    /// Creates a tightly packed RGB8 heatmap of the tile statistics with the same size as the
+    /// images. Tiles without differences are black, other tiles go from dark red to yellow
+    /// with the fraction of different pixels.
+    std::vector<Uint8> CreateTileHeatmap() const;
+};
+
+/// Compares two 8-bit images.
+
+/// \param [in]  Info   - Comparison attributes.
+/// \param [out] Result - Comparison result.
+///
+/// \remarks    Images with three or four components are compared with SSE2 instructions when
+///             the library is compiled for this instruction set. Rows of tiles of large images
+///             are distributed between the worker threads of an internal pool.
+void CompareImages(const ImageCompareInfo& Info, ImageComparison& Result);
+
+/// Loads two image files and compares them, see CompareImages(). The alpha channel is
+/// ignored when only one of the images has it.
+
+/// \return false if the images could not be loaded or have different sizes.
+bool CompareImageFiles(const char*      FilePath,
+                       const char*      ReferenceFilePath,
+                       Uint32           Tolerance,
+                       bool             CreateDiffImage,
+                       ImageComparison& Result);
+
+} // namespace Diligent
@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <atomic>
+
+#include "Image.h"
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// Decodes PNG, JPEG and TIFF images on a pool of worker threads.
+
+/// Every enqueued image is decoded by one of the workers. An image may optionally be decoded
+/// progressively: a downscaled preview is decoded first so that it can be displayed while
+/// the full image is being decoded. Previews of all enqueued images are decoded before
+/// full images.
+///
+/// The methods of the queue are thread-safe.
+class ImageDecodeQueue
+{
+public:
+    /// \param [in] NumThreads - Number of worker threads. If 0, the number of hardware threads
+    ///                          minus one is used.
+    explicit ImageDecodeQueue(Uint32 NumThreads = 0);
+
+    /// Waits for the images that are being decoded and discards the rest.
+    ~ImageDecodeQueue();
+
+    // clang-format off
+    ImageDecodeQueue           (const ImageDecodeQueue&)  = delete;
+    ImageDecodeQueue           (      ImageDecodeQueue&&) = delete;
+    ImageDecodeQueue& operator=(const ImageDecodeQueue&)  = delete;
+    ImageDecodeQueue& operator=(      ImageDecodeQueue&&) = delete;
+    // clang-format on
+
+    /// Adds an image to the queue.
+
+    /// \param [in] pFileData        - Encoded image. The queue keeps a reference to the blob
+    ///                                until the image is decoded.
+    /// \param [in] LoadInfo         - Image load info. If LoadInfo.Format is IMAGE_FILE_FORMAT_UNKNOWN,
+    ///                                the format is derived from the file header.
+    /// \param [in] PreviewDownscale - If greater than 1, a preview downscaled by this factor
+    ///                                (2, 4 or 8) is decoded first, see GetPreview(). Only JPEG
+    ///                                images support previews, the value is ignored for other formats.
+    ///
+    /// \return Identifier of the decoding job.
+    Uint32 Enqueue(IDataBlob* pFileData, const ImageLoadInfo& LoadInfo, Uint32 PreviewDownscale = 1);
+
+    /// Returns the preview of the image, or null if the preview has not been decoded yet
+    /// or was not requested.
+    RefCntAutoPtr<Image> GetPreview(Uint32 JobId);
+
+    /// Returns true if the image has been decoded.
+    bool IsComplete(Uint32 JobId);
+
+    /// Waits until the image is decoded and returns it. The job is then removed from the queue,
+    /// so the method can only be called once for every job.
+
+    /// \return The decoded image, or null if the image could not be decoded.
+    RefCntAutoPtr<Image> WaitForImage(Uint32 JobId);
+
+    /// Waits until all enqueued images are decoded and returns them in the order in which
+    /// they were enqueued. All jobs are removed from the queue.
+    std::vector<RefCntAutoPtr<Image>> WaitForAll();
+
+    /// Returns the number of images that have not been retrieved from the queue.
+    size_t GetNumJobs();
+
+private:
+    struct Job
+    {
+        RefCntAutoPtr<IDataBlob> pFileData;
+        ImageLoadInfo            LoadInfo;
+        Uint32                   PreviewDownscale = 1;
+
+        RefCntAutoPtr<Image> pPreview;
+        RefCntAutoPtr<Image> pImage;
+
+        // The number of tasks (preview and full image) that have not finished yet
+        Uint32 NumPendingTasks = 0;
+    };
+
+    void ProcessNextTask();
+
+    std::mutex              m_Mtx;
+    std::condition_variable m_CompleteCV;
+
+    std::unordered_map<Uint32, std::unique_ptr<Job>> m_Jobs;
+
+    // Previews are decoded before full images
+    std::deque<Job*> m_PendingPreviews;
+    std::deque<Job*> m_PendingImages;
+
+    Uint32 m_NextJobId = 0;
+
+    std::atomic<bool> m_Abort{false};
+
+    std::unique_ptr<ThreadPool> m_pWorkers;
+};
+
+} // namespace Diligent
@@ -35,6 +35,24 @@ DILIGENT_BEGIN_NAMESPACE(Diligent)
 
 struct Image;
 
+/// Block compression of the textures created from images
+DILIGENT_TYPED_ENUM(TEXTURE_LOAD_COMPRESS_MODE, Uint8){
+    /// The texture is not compressed
+    TEXTURE_LOAD_COMPRESS_MODE_NONE = 0,
+
+    /// Color texture: BC1 if all texels are opaque and BC3 otherwise
+    TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR,
+
+    /// Color texture with higher quality: BC7
+    TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR_HQ,
+
+    /// Tangent-space normal map: X and Y are stored in BC5, Z must be
+    /// reconstructed in the shader
+    TEXTURE_LOAD_COMPRESS_MODE_BC_NORMAL,
+
+    /// Single-channel texture, e.g. occlusion map: the first channel is stored in BC4
+    TEXTURE_LOAD_COMPRESS_MODE_BC_SINGLE_CHANNEL};
+
 // clang-format off
 /// Texture loading information
 struct TextureLoadInfo
@@ -63,16 +81,24 @@ struct TextureLoadInfo
     /// Texture format
     TEXTURE_FORMAT Format               DEFAULT_VALUE(TEX_FORMAT_UNKNOWN);
 
+    /// Block compression of the texture created from an image.
+
+    /// All mip levels are computed and compressed on the CPU. Compression requires 8-bit
+    /// images whose width and height are multiples of 4, and Format must be TEX_FORMAT_UNKNOWN.
+    /// Otherwise, the texture is created uncompressed.
+    TEXTURE_LOAD_COMPRESS_MODE CompressMode DEFAULT_VALUE(TEXTURE_LOAD_COMPRESS_MODE_NONE);
+
 
 #if DILIGENT_CPP_INTERFACE
-    explicit TextureLoadInfo(const Char*         _Name,
-                             USAGE               _Usage             = TextureLoadInfo{}.Usage,
-                             BIND_FLAGS          _BindFlags         = TextureLoadInfo{}.BindFlags,
-                             Uint32              _MipLevels         = TextureLoadInfo{}.MipLevels,
-                             CPU_ACCESS_FLAGS    _CPUAccessFlags    = TextureLoadInfo{}.CPUAccessFlags,
-                             Bool                _IsSRGB            = TextureLoadInfo{}.IsSRGB,
-                             Bool                _GenerateMips      = TextureLoadInfo{}.GenerateMips,
-                             TEXTURE_FORMAT      _Format            = TextureLoadInfo{}.Format) :
+    explicit TextureLoadInfo(const Char*                _Name,
+                             USAGE                      _Usage             = TextureLoadInfo{}.Usage,
+                             BIND_FLAGS                 _BindFlags         = TextureLoadInfo{}.BindFlags,
+                             Uint32                     _MipLevels         = TextureLoadInfo{}.MipLevels,
+                             CPU_ACCESS_FLAGS           _CPUAccessFlags    = TextureLoadInfo{}.CPUAccessFlags,
+                             Bool                       _IsSRGB            = TextureLoadInfo{}.IsSRGB,
+                             Bool                       _GenerateMips      = TextureLoadInfo{}.GenerateMips,
+                             TEXTURE_FORMAT             _Format            = TextureLoadInfo{}.Format,
+                             TEXTURE_LOAD_COMPRESS_MODE _CompressMode      = TextureLoadInfo{}.CompressMode) :
         Name            {_Name},
         Usage           {_Usage},
         BindFlags       {_BindFlags},
@@ -80,7 +106,8 @@ struct TextureLoadInfo
         CPUAccessFlags  {_CPUAccessFlags},
         IsSRGB          {_IsSRGB},
         GenerateMips    {_GenerateMips},
-        Format          {_Format}
+        Format          {_Format},
+        CompressMode    {_CompressMode}
     {}
 
     TextureLoadInfo(){};
@@ -125,6 +152,55 @@ void DILIGENT_GLOBAL_FUNCTION(CreateTextureFromKTX)(IDataBlob*                pK
                                                     IRenderDevice*            pDevice,
                                                     ITexture**                ppTexture);
 
+/// Computes a coarser mip level by averaging 2x2 texel blocks of a finer level
+
+/// \param [in] FineLevelWidth    - Width of the fine mip level
+/// \param [in] FineLevelHeight   - Height of the fine mip level
+/// \param [in] Fmt               - Texel format. 8- and 16-bit UNORM formats with 1, 2 or 4 components
+///                                 are supported, sRGB formats are averaged in linear space.
+/// \param [in] pFineLevelData    - Fine mip level data
+/// \param [in] FineDataStride    - Row stride of the fine mip level, in bytes
+/// \param [out] pCoarseLevelData - Coarse mip level data, max(FineLevelWidth/2, 1) x max(FineLevelHeight/2, 1) texels
+/// \param [in] CoarseDataStride  - Row stride of the coarse mip level, in bytes
+void DILIGENT_GLOBAL_FUNCTION(ComputeMipLevel)(Uint32         FineLevelWidth,
+                                               Uint32         FineLevelHeight,
+                                               TEXTURE_FORMAT Fmt,
+                                               const void*    pFineLevelData,
+                                               Uint32         FineDataStride,
+                                               void*          pCoarseLevelData,
+                                               Uint32         CoarseDataStride);
+
+/// Returns the block-compressed format for the compression mode
+
+/// \param [in] Mode     - Compression mode.
+/// \param [in] HasAlpha - Whether the texture has texels that are not opaque. Only used by
+///                        TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR.
+/// \param [in] IsSRGB   - Whether the color texture uses sRGB gamma encoding.
+/// \return     BC format, or TEX_FORMAT_UNKNOWN for TEXTURE_LOAD_COMPRESS_MODE_NONE.
+TEXTURE_FORMAT DILIGENT_GLOBAL_FUNCTION(GetCompressedTextureFormat)(TEXTURE_LOAD_COMPRESS_MODE Mode,
+                                                                    Bool                       HasAlpha,
+                                                                    Bool                       IsSRGB);
+
+/// Compresses a mip level into BC blocks
+
+/// \param [in] Width           - Width of the mip level
+/// \param [in] Height          - Height of the mip level
+/// \param [in] SrcFmt          - Texel format. 8-bit UNORM formats with 1, 2 or 4 components are supported.
+/// \param [in] pSrcLevelData   - Mip level data
+/// \param [in] SrcDataStride   - Row stride of the mip level, in bytes
+/// \param [in] DstFmt          - BC1, BC3, BC4, BC5 or BC7 format. BC1, BC3 and BC7 require 4 source
+///                               components, BC5 requires 2 or 4, BC4 compresses the first component.
+/// \param [out] pDstLevelData  - Compressed data, (Width+3)/4 x (Height+3)/4 blocks
+/// \param [in] DstDataStride   - Row stride of the compressed data (one row of blocks), in bytes
+void DILIGENT_GLOBAL_FUNCTION(CompressMipLevel)(Uint32         Width,
+                                                Uint32         Height,
+                                                TEXTURE_FORMAT SrcFmt,
+                                                const void*    pSrcLevelData,
+                                                Uint32         SrcDataStride,
+                                                TEXTURE_FORMAT DstFmt,
+                                                void*          pDstLevelData,
+                                                Uint32         DstDataStride);
+
 #include "../../../DiligentCore/Primitives/interface/UndefGlobalFuncHelperMacros.h"
 
 DILIGENT_END_NAMESPACE // namespace Diligent
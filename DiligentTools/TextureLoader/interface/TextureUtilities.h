@@ -51,6 +51,17 @@ void DILIGENT_GLOBAL_FUNCTION(CreateTextureFromFile)(const Char*               F
                                                      IRenderDevice*            pDevice,
                                                      ITexture**                ppTexture);
 
+/// Writes texture data to a DDS file
+
+/// \param [in] FilePath - Destination file path
+/// \param [in] TexDesc  - Texture description
+/// \param [in] TexData  - Texture subresources in CPU memory, in the same order
+///                        as in the texture initialization data
+/// \return true if the file was written successfully, and false otherwise
+Bool DILIGENT_GLOBAL_FUNCTION(SaveTextureAsDDS)(const Char*           FilePath,
+                                                const TextureDesc REF TexDesc,
+                                                const TextureData REF TexData);
+
 #include "../../../DiligentCore/Primitives/interface/UndefGlobalFuncHelperMacros.h"
 
 DILIGENT_END_NAMESPACE // namespace Diligent
@@ -0,0 +1,619 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "BCEncoder.hpp"
+#include "MipGenerator.hpp"
+#include "GraphicsAccessories.hpp"
+#include "ThreadPool.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Levels with fewer blocks are compressed by the calling thread only
+constexpr size_t MinParallelBlocks = 64 * 64;
+// Number of blocks compressed by a thread at a time
+constexpr size_t BlocksPerChunk = 2 * 1024;
+
+template <size_t NumChannels>
+using Vec = std::array<float, NumChannels>;
+
+template <size_t NumChannels>
+void ClampEndpoint(Vec<NumChannels>& E)
+{
+    for (auto& c : E)
+        c = std::min(std::max(c, 0.f), 255.f);
+}
+
+// Places the endpoints at the extremes of the texels projected onto the principal axis
+template <size_t NumChannels>
+void FitEndpoints(const Vec<NumChannels> Texels[16], Vec<NumChannels>& E0, Vec<NumChannels>& E1)
+{
+    Vec<NumChannels> Mean{};
+    Vec<NumChannels> Min, Max;
+    Min.fill(+std::numeric_limits<float>::max());
+    Max.fill(-std::numeric_limits<float>::max());
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        for (Uint32 c = 0; c < NumChannels; ++c)
+        {
+            Mean[c] += Texels[i][c] / 16.f;
+            Min[c] = std::min(Min[c], Texels[i][c]);
+            Max[c] = std::max(Max[c], Texels[i][c]);
+        }
+    }
+
+    float Cov[NumChannels][NumChannels] = {};
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        for (Uint32 a = 0; a < NumChannels; ++a)
+        {
+            for (Uint32 b = 0; b < NumChannels; ++b)
+                Cov[a][b] += (Texels[i][a] - Mean[a]) * (Texels[i][b] - Mean[b]);
+        }
+    }
+
+    // Power iterations starting from the diagonal of the bounding box
+    Vec<NumChannels> Axis;
+    for (Uint32 c = 0; c < NumChannels; ++c)
+        Axis[c] = Max[c] - Min[c];
+    float AxisLen = 0;
+    for (int Iter = 0; Iter < 8; ++Iter)
+    {
+        Vec<NumChannels> NewAxis{};
+        for (Uint32 a = 0; a < NumChannels; ++a)
+        {
+            for (Uint32 b = 0; b < NumChannels; ++b)
+                NewAxis[a] += Cov[a][b] * Axis[b];
+        }
+
+        AxisLen = 0;
+        for (auto c : NewAxis)
+            AxisLen += c * c;
+        AxisLen = std::sqrt(AxisLen);
+        if (AxisLen < 1e-6f)
+            break;
+
+        for (Uint32 c = 0; c < NumChannels; ++c)
+            Axis[c] = NewAxis[c] / AxisLen;
+    }
+
+    if (AxisLen < 1e-6f)
+    {
+        // All texels are the same
+        E0 = Mean;
+        E1 = Mean;
+        return;
+    }
+
+    float MinT = +std::numeric_limits<float>::max();
+    float MaxT = -std::numeric_limits<float>::max();
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        float t = 0;
+        for (Uint32 c = 0; c < NumChannels; ++c)
+            t += (Texels[i][c] - Mean[c]) * Axis[c];
+        MinT = std::min(MinT, t);
+        MaxT = std::max(MaxT, t);
+    }
+
+    for (Uint32 c = 0; c < NumChannels; ++c)
+    {
+        E0[c] = Mean[c] + Axis[c] * MinT;
+        E1[c] = Mean[c] + Axis[c] * MaxT;
+    }
+    ClampEndpoint(E0);
+    ClampEndpoint(E1);
+}
+
+// Computes the endpoints that minimize the squared error for the given weights of E1 (least squares)
+template <size_t NumChannels>
+bool RefineEndpoints(const Vec<NumChannels> Texels[16], const float Weights[16], Vec<NumChannels>& E0, Vec<NumChannels>& E1)
+{
+    float            AA = 0, BB = 0, AB = 0;
+    Vec<NumChannels> AX{}, BX{};
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        const auto b = Weights[i];
+        const auto a = 1.f - b;
+        AA += a * a;
+        BB += b * b;
+        AB += a * b;
+        for (Uint32 c = 0; c < NumChannels; ++c)
+        {
+            AX[c] += a * Texels[i][c];
+            BX[c] += b * Texels[i][c];
+        }
+    }
+
+    const auto Det = AA * BB - AB * AB;
+    if (std::abs(Det) < 1e-6f)
+        return false;
+
+    for (Uint32 c = 0; c < NumChannels; ++c)
+    {
+        E0[c] = (AX[c] * BB - BX[c] * AB) / Det;
+        E1[c] = (BX[c] * AA - AX[c] * AB) / Det;
+    }
+    ClampEndpoint(E0);
+    ClampEndpoint(E1);
+    return true;
+}
+
+template <size_t NumChannels>
+void LoadTexels(const Uint8* pTexels, Vec<NumChannels> Texels[16])
+{
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        for (Uint32 c = 0; c < NumChannels; ++c)
+            Texels[i][c] = static_cast<float>(pTexels[i * 4 + c]);
+    }
+}
+
+inline int Quantize(float Val, int MaxVal)
+{
+    return std::min(std::max(static_cast<int>(Val * static_cast<float>(MaxVal) / 255.f + 0.5f), 0), MaxVal);
+}
+
+Uint16 QuantizeRGB565(const Vec<3>& Color)
+{
+    return static_cast<Uint16>((Quantize(Color[0], 31) << 11) | (Quantize(Color[1], 63) << 5) | Quantize(Color[2], 31));
+}
+
+void ExpandRGB565(Uint32 Color, int RGB[3])
+{
+    const auto R = (Color >> 11) & 31;
+    const auto G = (Color >> 5) & 63;
+    const auto B = Color & 31;
+
+    RGB[0] = static_cast<int>((R << 3) | (R >> 2));
+    RGB[1] = static_cast<int>((G << 2) | (G >> 4));
+    RGB[2] = static_cast<int>((B << 3) | (B >> 2));
+}
+
+// Computes the indices of the four-color BC1 block and returns the squared error
+Uint32 ComputeBC1Indices(const Uint8 RGBA[16 * 4], Uint16 Color0, Uint16 Color1, Uint32& Indices)
+{
+    int Palette[4][3];
+    ExpandRGB565(Color0, Palette[0]);
+    ExpandRGB565(Color1, Palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+        Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+    }
+
+    Indices      = 0;
+    Uint32 Error = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        const auto* pTexel = RGBA + i * 4;
+
+        Uint32 BestIdx  = 0;
+        Uint32 BestDist = ~Uint32{0};
+        for (Uint32 p = 0; p < 4; ++p)
+        {
+            Uint32 Dist = 0;
+            for (int c = 0; c < 3; ++c)
+            {
+                const auto d = static_cast<int>(pTexel[c]) - Palette[p][c];
+                Dist += static_cast<Uint32>(d * d);
+            }
+            if (Dist < BestDist)
+            {
+                BestDist = Dist;
+                BestIdx  = p;
+            }
+        }
+        Indices |= BestIdx << (i * 2);
+        Error += BestDist;
+    }
+    return Error;
+}
+
+// Computes the indices of the BC4 block with Value0 > Value1 (eight-value mode)
+Uint64 ComputeBC4Indices(const Uint8 Values[16], Uint32 Stride, int Value0, int Value1)
+{
+    int Palette[8] = {Value0, Value1};
+    for (int p = 2; p < 8; ++p)
+        Palette[p] = ((8 - p) * Value0 + (p - 1) * Value1 + 3) / 7;
+
+    Uint64 Indices = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        const int Val = Values[i * Stride];
+
+        Uint64 BestIdx  = 0;
+        int    BestDist = std::numeric_limits<int>::max();
+        for (int p = 0; p < 8; ++p)
+        {
+            const auto Dist = std::abs(Val - Palette[p]);
+            if (Dist < BestDist)
+            {
+                BestDist = Dist;
+                BestIdx  = static_cast<Uint64>(p);
+            }
+        }
+        Indices |= BestIdx << (i * 3);
+    }
+    return Indices;
+}
+
+void EncodeBC4Channel(const Uint8* pValues, Uint32 Stride, Uint8* pBlock)
+{
+    int MinVal = 255;
+    int MaxVal = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        MinVal = std::min(MinVal, static_cast<int>(pValues[i * Stride]));
+        MaxVal = std::max(MaxVal, static_cast<int>(pValues[i * Stride]));
+    }
+
+    // If all values are the same, the block uses the six-value mode and
+    // index 0 that selects Value0.
+    const auto Indices = MaxVal > MinVal ? ComputeBC4Indices(pValues, Stride, MaxVal, MinVal) : Uint64{0};
+
+    pBlock[0] = static_cast<Uint8>(MaxVal);
+    pBlock[1] = static_cast<Uint8>(MinVal);
+    for (Uint32 b = 0; b < 6; ++b)
+        pBlock[2 + b] = static_cast<Uint8>(Indices >> (b * 8));
+}
+
+// Writes the bits of a 128-bit block starting from the least significant bit
+class BlockBitWriter
+{
+public:
+    explicit BlockBitWriter(Uint8* pBlock) :
+        m_pBlock{pBlock}
+    {
+        memset(m_pBlock, 0, 16);
+    }
+
+    void Write(Uint32 Value, Uint32 NumBits)
+    {
+        VERIFY_EXPR(m_Pos + NumBits <= 128);
+        for (Uint32 b = 0; b < NumBits; ++b, ++m_Pos)
+        {
+            if ((Value >> b) & 1u)
+                m_pBlock[m_Pos >> 3] |= static_cast<Uint8>(1u << (m_Pos & 7));
+        }
+    }
+
+    Uint32 GetPosition() const { return m_Pos; }
+
+private:
+    Uint8* const m_pBlock;
+    Uint32       m_Pos = 0;
+};
+
+constexpr int BC7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Mode 6 endpoint: 7 bits per channel and a p-bit shared by all channels
+struct BC7Endpoint
+{
+    int Q[4];
+    int P;
+
+    int Decode(int c) const
+    {
+        return (Q[c] << 1) | P;
+    }
+};
+
+BC7Endpoint QuantizeBC7Endpoint(const Vec<4>& E)
+{
+    BC7Endpoint Best{};
+    float       BestError = std::numeric_limits<float>::max();
+    for (int P = 0; P < 2; ++P)
+    {
+        BC7Endpoint Endpoint{};
+        Endpoint.P = P;
+
+        float Error = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            Endpoint.Q[c] = std::min(std::max(static_cast<int>((E[c] - static_cast<float>(P)) * 0.5f + 0.5f), 0), 127);
+
+            const auto d = static_cast<float>(Endpoint.Decode(c)) - E[c];
+            Error += d * d;
+        }
+        if (Error < BestError)
+        {
+            BestError = Error;
+            Best      = Endpoint;
+        }
+    }
+    return Best;
+}
+
+// Computes the 4-bit indices of the mode 6 block and returns the squared error
+Uint32 ComputeBC7Indices(const Uint8 RGBA[16 * 4], const BC7Endpoint& E0, const BC7Endpoint& E1, Uint8 Indices[16])
+{
+    int Palette[16][4];
+    for (int p = 0; p < 16; ++p)
+    {
+        for (int c = 0; c < 4; ++c)
+            Palette[p][c] = ((64 - BC7Weights4[p]) * E0.Decode(c) + BC7Weights4[p] * E1.Decode(c) + 32) >> 6;
+    }
+
+    Uint32 Error = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        const auto* pTexel = RGBA + i * 4;
+
+        Uint32 BestIdx  = 0;
+        Uint32 BestDist = ~Uint32{0};
+        for (Uint32 p = 0; p < 16; ++p)
+        {
+            Uint32 Dist = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                const auto d = static_cast<int>(pTexel[c]) - Palette[p][c];
+                Dist += static_cast<Uint32>(d * d);
+            }
+            if (Dist < BestDist)
+            {
+                BestDist = Dist;
+                BestIdx  = p;
+            }
+        }
+        Indices[i] = static_cast<Uint8>(BestIdx);
+        Error += BestDist;
+    }
+    return Error;
+}
+
+} // namespace
+
+void EncodeBC1Block(const Uint8 RGBA[16 * 4], Uint8* pBlock)
+{
+    Vec<3> Texels[16];
+    LoadTexels(RGBA, Texels);
+
+    Vec<3> E0, E1;
+    FitEndpoints(Texels, E0, E1);
+
+    auto   Color0 = QuantizeRGB565(E0);
+    auto   Color1 = QuantizeRGB565(E1);
+    Uint32 Indices;
+    auto   Error = ComputeBC1Indices(RGBA, Color0, Color1, Indices);
+
+    // Refine the endpoints for the selected indices
+    if (Error > 0)
+    {
+        // Weights of Color1 for indices 0..3
+        static constexpr float IdxWeights[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+
+        float Weights[16];
+        for (Uint32 i = 0; i < 16; ++i)
+            Weights[i] = IdxWeights[(Indices >> (i * 2)) & 3];
+
+        if (RefineEndpoints(Texels, Weights, E0, E1))
+        {
+            const auto RefinedColor0 = QuantizeRGB565(E0);
+            const auto RefinedColor1 = QuantizeRGB565(E1);
+
+            Uint32     RefinedIndices;
+            const auto RefinedError = ComputeBC1Indices(RGBA, RefinedColor0, RefinedColor1, RefinedIndices);
+            if (RefinedError < Error)
+            {
+                Color0  = RefinedColor0;
+                Color1  = RefinedColor1;
+                Indices = RefinedIndices;
+            }
+        }
+    }
+
+    // Color0 > Color1 selects the four-color mode
+    if (Color0 < Color1)
+    {
+        std::swap(Color0, Color1);
+        // Swap indices 0 <-> 1 and 2 <-> 3
+        Indices ^= 0x55555555u;
+    }
+    else if (Color0 == Color1)
+    {
+        Indices = 0;
+    }
+
+    pBlock[0] = static_cast<Uint8>(Color0 & 0xFF);
+    pBlock[1] = static_cast<Uint8>(Color0 >> 8);
+    pBlock[2] = static_cast<Uint8>(Color1 & 0xFF);
+    pBlock[3] = static_cast<Uint8>(Color1 >> 8);
+    for (Uint32 b = 0; b < 4; ++b)
+        pBlock[4 + b] = static_cast<Uint8>(Indices >> (b * 8));
+}
+
+void EncodeBC3Block(const Uint8 RGBA[16 * 4], Uint8* pBlock)
+{
+    EncodeBC4Channel(RGBA + 3, 4, pBlock);
+    EncodeBC1Block(RGBA, pBlock + 8);
+}
+
+void EncodeBC4Block(const Uint8 Values[16], Uint8* pBlock)
+{
+    EncodeBC4Channel(Values, 1, pBlock);
+}
+
+void EncodeBC5Block(const Uint8 RG[16 * 2], Uint8* pBlock)
+{
+    EncodeBC4Channel(RG + 0, 2, pBlock);
+    EncodeBC4Channel(RG + 1, 2, pBlock + 8);
+}
+
+void EncodeBC7Block(const Uint8 RGBA[16 * 4], Uint8* pBlock)
+{
+    Vec<4> Texels[16];
+    LoadTexels(RGBA, Texels);
+
+    Vec<4> E0, E1;
+    FitEndpoints(Texels, E0, E1);
+
+    auto  Endpoint0 = QuantizeBC7Endpoint(E0);
+    auto  Endpoint1 = QuantizeBC7Endpoint(E1);
+    Uint8 Indices[16];
+    auto  Error = ComputeBC7Indices(RGBA, Endpoint0, Endpoint1, Indices);
+
+    // Refine the endpoints for the selected indices
+    if (Error > 0)
+    {
+        float Weights[16];
+        for (Uint32 i = 0; i < 16; ++i)
+            Weights[i] = static_cast<float>(BC7Weights4[Indices[i]]) / 64.f;
+
+        if (RefineEndpoints(Texels, Weights, E0, E1))
+        {
+            const auto RefinedEndpoint0 = QuantizeBC7Endpoint(E0);
+            const auto RefinedEndpoint1 = QuantizeBC7Endpoint(E1);
+
+            Uint8      RefinedIndices[16];
+            const auto RefinedError = ComputeBC7Indices(RGBA, RefinedEndpoint0, RefinedEndpoint1, RefinedIndices);
+            if (RefinedError < Error)
+            {
+                Endpoint0 = RefinedEndpoint0;
+                Endpoint1 = RefinedEndpoint1;
+                memcpy(Indices, RefinedIndices, sizeof(Indices));
+            }
+        }
+    }
+
+    // The most significant bit of the first (anchor) index is implicitly zero
+    if (Indices[0] >= 8)
+    {
+        std::swap(Endpoint0, Endpoint1);
+        for (auto& Idx : Indices)
+            Idx = static_cast<Uint8>(15 - Idx);
+    }
+
+    BlockBitWriter Writer{pBlock};
+    // Mode 6 is encoded as six zero bits followed by one
+    Writer.Write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c)
+    {
+        Writer.Write(static_cast<Uint32>(Endpoint0.Q[c]), 7);
+        Writer.Write(static_cast<Uint32>(Endpoint1.Q[c]), 7);
+    }
+    Writer.Write(static_cast<Uint32>(Endpoint0.P), 1);
+    Writer.Write(static_cast<Uint32>(Endpoint1.P), 1);
+    Writer.Write(Indices[0], 3);
+    for (Uint32 i = 1; i < 16; ++i)
+        Writer.Write(Indices[i], 4);
+    VERIFY_EXPR(Writer.GetPosition() == 128);
+}
+
+bool CompressBlocks(Uint32         Width,
+                    Uint32         Height,
+                    const Uint8*   pSrc,
+                    Uint32         SrcStride,
+                    Uint32         SrcNumChannels,
+                    TEXTURE_FORMAT DstFmt,
+                    Uint8*         pDst,
+                    Uint32         DstStride)
+{
+    VERIFY_EXPR(Width > 0 && Height > 0);
+
+    void (*EncodeBlock)(const Uint8*, Uint8*) = nullptr;
+    // Number of channels in the texels passed to the block encoder
+    Uint32 BlockChannels = 0;
+    switch (DstFmt)
+    {
+        // clang-format off
+        case TEX_FORMAT_BC1_UNORM:
+        case TEX_FORMAT_BC1_UNORM_SRGB: EncodeBlock = EncodeBC1Block; BlockChannels = 4; break;
+        case TEX_FORMAT_BC3_UNORM:
+        case TEX_FORMAT_BC3_UNORM_SRGB: EncodeBlock = EncodeBC3Block; BlockChannels = 4; break;
+        case TEX_FORMAT_BC4_UNORM:      EncodeBlock = EncodeBC4Block; BlockChannels = 1; break;
+        case TEX_FORMAT_BC5_UNORM:      EncodeBlock = EncodeBC5Block; BlockChannels = 2; break;
+        case TEX_FORMAT_BC7_UNORM:
+        case TEX_FORMAT_BC7_UNORM_SRGB: EncodeBlock = EncodeBC7Block; BlockChannels = 4; break;
+        // clang-format on
+
+        default:
+            LOG_ERROR_MESSAGE("Unable to compress texels to format ", GetTextureFormatAttribs(DstFmt).Name, ": only BC1, BC3, BC4, BC5 and BC7 UNORM formats are supported");
+            return false;
+    }
+
+    if ((SrcNumChannels != 1 && SrcNumChannels != 2 && SrcNumChannels != 4) || SrcNumChannels < BlockChannels)
+    {
+        LOG_ERROR_MESSAGE("Unable to compress texels with ", SrcNumChannels, " channels to format ", GetTextureFormatAttribs(DstFmt).Name);
+        return false;
+    }
+
+    const auto BlockSize    = Uint32{GetTextureFormatAttribs(DstFmt).ComponentSize};
+    const auto NumBlocksX   = (Width + 3) / 4;
+    const auto NumBlocksY   = (Height + 3) / 4;
+    const auto CompressRows = [&](Uint32 FirstRow, Uint32 EndRow) //
+    {
+        Uint8 Texels[16 * 4];
+        for (Uint32 by = FirstRow; by < EndRow; ++by)
+        {
+            for (Uint32 bx = 0; bx < NumBlocksX; ++bx)
+            {
+                for (Uint32 y = 0; y < 4; ++y)
+                {
+                    const auto* pSrcRow = pSrc + size_t{std::min(by * 4 + y, Height - 1)} * SrcStride;
+                    for (Uint32 x = 0; x < 4; ++x)
+                    {
+                        const auto* pSrcTexel = pSrcRow + size_t{std::min(bx * 4 + x, Width - 1)} * SrcNumChannels;
+                        for (Uint32 c = 0; c < BlockChannels; ++c)
+                            Texels[(y * 4 + x) * BlockChannels + c] = pSrcTexel[c];
+                    }
+                }
+                EncodeBlock(Texels, pDst + size_t{by} * DstStride + size_t{bx} * BlockSize);
+            }
+        }
+    };
+
+    if (size_t{NumBlocksX} * size_t{NumBlocksY} < MinParallelBlocks)
+    {
+        CompressRows(0, NumBlocksY);
+    }
+    else
+    {
+        const auto RowsPerChunk = std::max(BlocksPerChunk / NumBlocksX, size_t{1});
+        GetTextureLoaderThreadPool().ParallelFor(NumBlocksY, RowsPerChunk,
+                                                 [&](size_t FirstRow, size_t EndRow) //
+                                                 {
+                                                     CompressRows(static_cast<Uint32>(FirstRow), static_cast<Uint32>(EndRow));
+                                                 });
+    }
+
+    return true;
+}
+
+} // namespace Diligent
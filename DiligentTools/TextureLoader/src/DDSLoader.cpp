@@ -1498,3 +1498,149 @@ void CreateDDSTextureFromMemoryEx(
     //if (alphaMode)
     //    *alphaMode = GetAlphaMode(header);
 }
+
+
+//--------------------------------------------------------------------------------------
+static DXGI_FORMAT TexFormatToDXGIFormat(TEXTURE_FORMAT TexFormat)
+{
+    // DXGIFormatToTexFormat() handles every format up to BC7 except R32_FLOAT_X8X24_TYPELESS
+    for (Uint32 fmt = DXGI_FORMAT_R32G32B32A32_TYPELESS; fmt <= DXGI_FORMAT_BC7_UNORM_SRGB; ++fmt)
+    {
+        if (fmt != DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS && DXGIFormatToTexFormat(static_cast<DXGI_FORMAT>(fmt)) == TexFormat)
+            return static_cast<DXGI_FORMAT>(fmt);
+    }
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+
+//--------------------------------------------------------------------------------------
+bool SaveDDSTextureToStream(
+    IFileStream* pStream,
+    const TextureDesc& desc,
+    const TextureData& texData)
+{
+    if (!pStream || !texData.pSubResources)
+    {
+        LOG_ERROR_MESSAGE("Invalid arguments");
+        return false;
+    }
+
+    const auto format = TexFormatToDXGIFormat(desc.Format);
+    if (format == DXGI_FORMAT_UNKNOWN)
+    {
+        LOG_ERROR_MESSAGE("Format of texture '", (desc.Name != nullptr ? desc.Name : ""), "' can't be stored in a DDS file");
+        return false;
+    }
+
+    DDS_HEADER header = {};
+    header.size        = sizeof(DDS_HEADER);
+    header.flags       = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP;
+    header.width       = desc.Width;
+    header.height      = desc.Height;
+    header.depth       = 1;
+    header.mipMapCount = desc.MipLevels;
+    header.ddspf.size  = sizeof(DDS_PIXELFORMAT);
+    header.ddspf.flags = DDS_FOURCC;
+    header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+    header.caps        = DDS_SURFACE_FLAGS_TEXTURE | DDS_SURFACE_FLAGS_MIPMAP;
+
+    DDS_HEADER_DXT10 d3d10ext = {};
+    d3d10ext.dxgiFormat = format;
+    d3d10ext.arraySize  = desc.ArraySize;
+
+    size_t arraySize = desc.ArraySize;
+    switch (desc.Type)
+    {
+        case RESOURCE_DIM_TEX_1D:
+        case RESOURCE_DIM_TEX_1D_ARRAY:
+            d3d10ext.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE1D;
+            header.height = 1;
+            break;
+
+        case RESOURCE_DIM_TEX_2D:
+        case RESOURCE_DIM_TEX_2D_ARRAY:
+            d3d10ext.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+            break;
+
+        case RESOURCE_DIM_TEX_CUBE:
+        case RESOURCE_DIM_TEX_CUBE_ARRAY:
+            // Array size in the DX10 header is the number of cubes
+            d3d10ext.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+            d3d10ext.miscFlag  = D3D11_RESOURCE_MISC_TEXTURECUBE;
+            d3d10ext.arraySize = desc.ArraySize / 6;
+            header.caps  |= DDS_SURFACE_FLAGS_CUBEMAP;
+            header.caps2 |= DDS_CUBEMAP_ALLFACES;
+            break;
+
+        case RESOURCE_DIM_TEX_3D:
+            d3d10ext.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE3D;
+            d3d10ext.arraySize = 1;
+            header.depth  = desc.Depth;
+            header.flags |= DDS_HEADER_FLAGS_VOLUME;
+            header.caps2 |= DDS_FLAGS_VOLUME;
+            arraySize     = 1;
+            break;
+
+        default:
+            LOG_ERROR_MESSAGE("Unexpected texture type");
+            return false;
+    }
+
+    if (texData.NumSubresources != desc.MipLevels * arraySize)
+    {
+        LOG_ERROR_MESSAGE("The number of subresources (", texData.NumSubresources, ") does not match the texture description (", desc.MipLevels * arraySize, ")");
+        return false;
+    }
+
+    const Uint32 dwMagicNumber = DDS_MAGIC;
+
+    bool res = pStream->Write(&dwMagicNumber, sizeof(dwMagicNumber)) &&
+               pStream->Write(&header, sizeof(header)) &&
+               pStream->Write(&d3d10ext, sizeof(d3d10ext));
+
+    // Subresources are stored in the same order as FillInitData() reads them:
+    // all mip levels of the first array slice, then all mip levels of the next slice, etc.
+    for (size_t j = 0; j < arraySize && res; j++)
+    {
+        size_t w = header.width;
+        size_t h = header.height;
+        size_t d = header.depth;
+        for (size_t i = 0; i < desc.MipLevels && res; i++)
+        {
+            const auto& subRes = texData.pSubResources[j * desc.MipLevels + i];
+            if (subRes.pData == nullptr)
+            {
+                LOG_ERROR_MESSAGE("Only subresources in CPU memory can be stored in a DDS file");
+                return false;
+            }
+
+            size_t NumBytes = 0;
+            size_t RowBytes = 0;
+            size_t NumRows = 0;
+            GetSurfaceInfo(w, h, format, &NumBytes, &RowBytes, &NumRows);
+
+            for (size_t z = 0; z < d && res; z++)
+            {
+                const auto* pSrcSlice = reinterpret_cast<const Uint8*>(subRes.pData) + z * subRes.DepthStride;
+                if (subRes.Stride == RowBytes)
+                {
+                    res = pStream->Write(pSrcSlice, NumBytes);
+                }
+                else
+                {
+                    for (size_t row = 0; row < NumRows && res; row++)
+                        res = pStream->Write(pSrcSlice + row * subRes.Stride, RowBytes);
+                }
+            }
+
+            w = std::max(w >> 1, size_t{1});
+            h = std::max(h >> 1, size_t{1});
+            d = std::max(d >> 1, size_t{1});
+        }
+    }
+
+    if (!res)
+        LOG_ERROR_MESSAGE("Failed to write DDS data to the stream");
+
+    return res;
+}
@@ -46,6 +46,10 @@
 #include "BasicFileStream.hpp"
 #include "StringTools.hpp"
 
+#if PLATFORM_LINUX
+#    include "LinuxMappedFileBlob.hpp"
+#endif
+
 namespace Diligent
 {
 
@@ -224,6 +228,11 @@ Image::Image(IReferenceCounters*  pRefCounters,
     TBase{pRefCounters},
     m_pData{MakeNewRCObj<DataBlobImpl>()(0)}
 {
+    if (LoadInfo.DownscaleFactor != 1 && LoadInfo.Format != IMAGE_FILE_FORMAT_JPEG)
+    {
+        LOG_WARNING_MESSAGE("Downscaled decoding is only supported for JPEG images. The image will be decoded at full resolution.");
+    }
+
     if (LoadInfo.Format == IMAGE_FILE_FORMAT_TIFF)
     {
         LoadTiffFile(pFileData, LoadInfo);
@@ -236,7 +245,7 @@ Image::Image(IReferenceCounters*  pRefCounters,
     }
     else if (LoadInfo.Format == IMAGE_FILE_FORMAT_JPEG)
     {
-        auto Res = DecodeJpeg(pFileData, m_pData.RawPtr(), &m_Desc);
+        auto Res = DecodeJpeg(pFileData, m_pData.RawPtr(), &m_Desc, LoadInfo.DownscaleFactor);
         if (Res != DECODE_JPEG_RESULT_OK)
             LOG_ERROR_MESSAGE("Failed to decode jpeg image");
     }
@@ -386,14 +395,23 @@ IMAGE_FILE_FORMAT CreateImageFromFile(const Char* FilePath,
     auto ImgFileFormat = IMAGE_FILE_FORMAT_UNKNOWN;
     try
     {
-        RefCntAutoPtr<BasicFileStream> pFileStream(MakeNewRCObj<BasicFileStream>()(FilePath, EFileAccessMode::Read));
-        if (!pFileStream->IsValid())
-            LOG_ERROR_AND_THROW("Failed to open image file \"", FilePath, '\"');
+        RefCntAutoPtr<IDataBlob> pFileData;
+#if PLATFORM_LINUX
+        // Map the file rather than read it into a transient buffer. DDS and KTX textures
+        // are then uploaded directly from the mapped pages.
+        LinuxMappedFileBlob::Create(FilePath, &pFileData);
+#endif
+        if (!pFileData)
+        {
+            RefCntAutoPtr<BasicFileStream> pFileStream(MakeNewRCObj<BasicFileStream>()(FilePath, EFileAccessMode::Read));
+            if (!pFileStream->IsValid())
+                LOG_ERROR_AND_THROW("Failed to open image file \"", FilePath, '\"');
 
-        RefCntAutoPtr<IDataBlob> pFileData(MakeNewRCObj<DataBlobImpl>()(0));
-        pFileStream->ReadBlob(pFileData);
+            pFileData = MakeNewRCObj<DataBlobImpl>()(0);
+            pFileStream->ReadBlob(pFileData);
+        }
 
-        ImgFileFormat = Image::GetFileFormat(reinterpret_cast<Uint8*>(pFileData->GetDataPtr()), pFileData->GetSize());
+        ImgFileFormat = Image::GetFileFormat(reinterpret_cast<const Uint8*>(pFileData->GetConstDataPtr()), pFileData->GetSize());
         if (ImgFileFormat == IMAGE_FILE_FORMAT_UNKNOWN)
         {
             LOG_WARNING_MESSAGE("Unable to derive image format from the header for file \"", FilePath, "\". Trying to analyze extension.");
@@ -0,0 +1,407 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define IMGCMP_USE_SSE2 1
+#endif
+
+#include "ImageComparator.hpp"
+#include "Image.h"
+#include "MipGenerator.hpp"
+#include "ThreadPool.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Images with fewer pixels are compared by the calling thread only
+constexpr size_t MinParallelPixels = 256 * 256;
+
+// Squared errors of a row segment are accumulated in 32-bit lanes, which limits the tile size
+constexpr Uint32 MaxTileSize = 4096;
+
+struct CompareAttribs
+{
+    const Uint8* pImage;
+    Uint32       Stride;
+    const Uint8* pReference;
+    Uint32       ReferenceStride;
+    Uint32       NumComponents;
+    Uint32       NumComparedComponents;
+    Uint32       Tolerance;
+};
+
+// Compares NumPixels pixels of one row
+void CompareSegmentScalar(const CompareAttribs& Attribs, const Uint8* pImage, const Uint8* pReference, Uint32 NumPixels, ImageTileDiff& Tile)
+{
+    for (Uint32 i = 0; i < NumPixels; ++i, pImage += Attribs.NumComponents, pReference += Attribs.NumComponents)
+    {
+        Uint32 PixelError = 0;
+        for (Uint32 c = 0; c < Attribs.NumComparedComponents; ++c)
+        {
+            const auto Error = static_cast<Uint32>(std::abs(int{pImage[c]} - int{pReference[c]}));
+            PixelError       = std::max(PixelError, Error);
+            Tile.SumSquaredError += Error * Error;
+        }
+        Tile.MaxError = std::max(Tile.MaxError, PixelError);
+        if (PixelError > Attribs.Tolerance)
+            ++Tile.NumDiffPixels;
+    }
+}
+
+#if IMGCMP_USE_SSE2
+inline __m128i AbsDiffU8(__m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+
+// Adds squared 8-bit values to four 32-bit accumulators
+inline __m128i AccumulateSquares(__m128i Acc, __m128i Val)
+{
+    const auto Zero = _mm_setzero_si128();
+
+    const auto Lo = _mm_unpacklo_epi8(Val, Zero);
+    const auto Hi = _mm_unpackhi_epi8(Val, Zero);
+    return _mm_add_epi32(Acc, _mm_add_epi32(_mm_madd_epi16(Lo, Lo), _mm_madd_epi16(Hi, Hi)));
+}
+
+inline Uint32 HorizontalMaxU8(__m128i Val)
+{
+    Val = _mm_max_epu8(Val, _mm_srli_si128(Val, 8));
+    Val = _mm_max_epu8(Val, _mm_srli_si128(Val, 4));
+    Val = _mm_max_epu8(Val, _mm_srli_si128(Val, 2));
+    Val = _mm_max_epu8(Val, _mm_srli_si128(Val, 1));
+    return static_cast<Uint32>(_mm_cvtsi128_si32(Val) & 0xFF);
+}
+
+inline Uint64 HorizontalSumU32(__m128i Val)
+{
+    alignas(16) Uint32 Lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(Lanes), Val);
+    return Uint64{Lanes[0]} + Uint64{Lanes[1]} + Uint64{Lanes[2]} + Uint64{Lanes[3]};
+}
+
+// Returns the number of pixels whose components are not all set in the byte mask,
+// i.e. the number of pixels where some component exceeds the tolerance
+template <Uint32 NumComponents>
+inline Uint32 CountDiffPixels(Uint64 WithinToleranceMask, Uint32 NumPixels)
+{
+    constexpr Uint64 PixelMask = (Uint64{1} << NumComponents) - 1;
+
+    Uint32 NumDiffPixels = 0;
+    for (Uint32 i = 0; i < NumPixels; ++i)
+    {
+        if (((WithinToleranceMask >> (i * NumComponents)) & PixelMask) != PixelMask)
+            ++NumDiffPixels;
+    }
+    return NumDiffPixels;
+}
+
+// Compares 16 pixels at a time. All components are compared except for the alpha channel
+// of four-component pixels, which can be masked out by ComponentMask.
+template <Uint32 NumComponents>
+void CompareSegmentSSE2(const CompareAttribs& Attribs, const Uint8* pImage, const Uint8* pReference, Uint32 NumPixels, ImageTileDiff& Tile)
+{
+    // 16 pixels take NumComponents 16-byte vectors
+    constexpr Uint32 NumVectors = NumComponents;
+
+    const auto ToleranceV    = _mm_set1_epi8(static_cast<char>(std::min(Attribs.Tolerance, 255u)));
+    const auto ComponentMask = NumComponents == 4 && Attribs.NumComparedComponents == 3 ? _mm_set1_epi32(0x00FFFFFF) : _mm_set1_epi32(-1);
+    const auto Zero          = _mm_setzero_si128();
+    auto       MaxErrorV     = Zero;
+    auto       SumSqErrorV   = Zero;
+
+    Uint32 i = 0;
+    for (; i + 16 <= NumPixels; i += 16, pImage += 16 * NumComponents, pReference += 16 * NumComponents)
+    {
+        Uint64 WithinToleranceMask = 0;
+        for (Uint32 v = 0; v < NumVectors; ++v)
+        {
+            const auto Img = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pImage) + v);
+            const auto Ref = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pReference) + v);
+            const auto Err = _mm_and_si128(AbsDiffU8(Img, Ref), ComponentMask);
+
+            MaxErrorV   = _mm_max_epu8(MaxErrorV, Err);
+            SumSqErrorV = AccumulateSquares(SumSqErrorV, Err);
+
+            const auto WithinTolerance = _mm_cmpeq_epi8(_mm_subs_epu8(Err, ToleranceV), Zero);
+            WithinToleranceMask |= Uint64{static_cast<Uint32>(_mm_movemask_epi8(WithinTolerance))} << (v * 16);
+        }
+
+        // Images that match are the common case, so pixels are only counted when some component differs
+        constexpr Uint64 AllWithinTolerance = ~Uint64{0} >> (64 - NumVectors * 16);
+        if (WithinToleranceMask != AllWithinTolerance)
+            Tile.NumDiffPixels += CountDiffPixels<NumComponents>(WithinToleranceMask, 16);
+    }
+
+    Tile.MaxError = std::max(Tile.MaxError, HorizontalMaxU8(MaxErrorV));
+    Tile.SumSquaredError += HorizontalSumU32(SumSqErrorV);
+
+    if (i < NumPixels)
+        CompareSegmentScalar(Attribs, pImage, pReference, NumPixels - i, Tile);
+}
+#endif
+
+void WriteDiffSegment(const CompareAttribs& Attribs, const Uint8* pImage, const Uint8* pReference, Uint32 NumPixels, Uint8* pDiff)
+{
+    for (Uint32 i = 0; i < NumPixels; ++i, pImage += Attribs.NumComponents, pReference += Attribs.NumComponents, pDiff += 3)
+    {
+        Uint32 PixelError = 0;
+        for (Uint32 c = 0; c < Attribs.NumComparedComponents; ++c)
+            PixelError = std::max(PixelError, static_cast<Uint32>(std::abs(int{pImage[c]} - int{pReference[c]})));
+
+        if (PixelError > Attribs.Tolerance)
+        {
+            pDiff[0] = static_cast<Uint8>(128 + PixelError / 2);
+            pDiff[1] = 0;
+            pDiff[2] = 0;
+        }
+        else
+        {
+            const auto Luminance = Attribs.NumComponents >= 3 ?
+                (Uint32{pReference[0]} * 54 + Uint32{pReference[1]} * 183 + Uint32{pReference[2]} * 19) >> 8 :
+                Uint32{pReference[0]};
+
+            pDiff[0] = pDiff[1] = pDiff[2] = static_cast<Uint8>(Luminance / 4);
+        }
+    }
+}
+
+// Repacks pixels to the given number of components
+std::vector<Uint8> RepackPixels(const ImageDesc& Desc, const Uint8* pData, Uint32 NumComponents)
+{
+    std::vector<Uint8> Pixels(size_t{Desc.Width} * size_t{Desc.Height} * NumComponents);
+    for (Uint32 row = 0; row < Desc.Height; ++row)
+    {
+        const auto* pSrc = pData + size_t{row} * Desc.RowStride;
+        auto*       pDst = &Pixels[size_t{row} * Desc.Width * NumComponents];
+        for (Uint32 col = 0; col < Desc.Width; ++col)
+        {
+            for (Uint32 c = 0; c < NumComponents; ++c)
+                pDst[col * NumComponents + c] = pSrc[col * Desc.NumComponents + c];
+        }
+    }
+    return Pixels;
+}
+
+} // namespace
+
+void CompareImages(const ImageCompareInfo& Info, ImageComparison& Result)
+{
+    VERIFY(Info.pImage != nullptr && Info.pReference != nullptr, "Image data must not be null");
+    VERIFY(Info.NumComponents > 0 && Info.NumComponents <= 4, "Unexpected number of components: ", Info.NumComponents);
+    VERIFY(Info.Stride >= Info.Width * Info.NumComponents && Info.ReferenceStride >= Info.Width * Info.NumComponents, "Row stride is too small");
+
+    // clang-format off
+    const CompareAttribs Attribs
+    {
+        static_cast<const Uint8*>(Info.pImage),
+        Info.Stride,
+        static_cast<const Uint8*>(Info.pReference),
+        Info.ReferenceStride,
+        Info.NumComponents,
+        Info.NumComparedComponents != 0 ? std::min(Info.NumComparedComponents, Info.NumComponents) : Info.NumComponents,
+        Info.Tolerance
+    };
+    // clang-format on
+
+    Result          = ImageComparison{};
+    Result.Width    = Info.Width;
+    Result.Height   = Info.Height;
+    Result.TileSize = std::min(std::max(Info.TileSize, 1u), MaxTileSize);
+
+    const auto TileSize = Result.TileSize;
+    Result.NumTilesX    = (Info.Width + TileSize - 1) / TileSize;
+    Result.NumTilesY    = (Info.Height + TileSize - 1) / TileSize;
+    Result.Tiles.resize(size_t{Result.NumTilesX} * size_t{Result.NumTilesY});
+    if (Info.CreateDiffImage)
+        Result.DiffImage.resize(size_t{Info.Width} * size_t{Info.Height} * 3);
+
+    auto CompareSegment = CompareSegmentScalar;
+#if IMGCMP_USE_SSE2
+    if (Attribs.NumComponents == 3 && Attribs.NumComparedComponents == 3)
+        CompareSegment = CompareSegmentSSE2<3>;
+    else if (Attribs.NumComponents == 4 && Attribs.NumComparedComponents >= 3)
+        CompareSegment = CompareSegmentSSE2<4>;
+#endif
+
+    auto CompareTileRows = [&](size_t FirstTileRow, size_t EndTileRow) //
+    {
+        for (auto TileY = static_cast<Uint32>(FirstTileRow); TileY < EndTileRow; ++TileY)
+        {
+            const auto EndRow = std::min((TileY + 1) * TileSize, Info.Height);
+            for (Uint32 row = TileY * TileSize; row < EndRow; ++row)
+            {
+                const auto* pImgRow = Attribs.pImage + size_t{row} * Attribs.Stride;
+                const auto* pRefRow = Attribs.pReference + size_t{row} * Attribs.ReferenceStride;
+                for (Uint32 TileX = 0; TileX < Result.NumTilesX; ++TileX)
+                {
+                    const auto FirstCol  = TileX * TileSize;
+                    const auto NumPixels = std::min(TileSize, Info.Width - FirstCol);
+                    const auto Offset    = size_t{FirstCol} * Attribs.NumComponents;
+
+                    CompareSegment(Attribs, pImgRow + Offset, pRefRow + Offset, NumPixels, Result.Tiles[size_t{TileY} * Result.NumTilesX + TileX]);
+                    if (Info.CreateDiffImage)
+                    {
+                        auto* pDiff = &Result.DiffImage[(size_t{row} * Info.Width + FirstCol) * 3];
+                        WriteDiffSegment(Attribs, pImgRow + Offset, pRefRow + Offset, NumPixels, pDiff);
+                    }
+                }
+            }
+        }
+    };
+
+    if (size_t{Info.Width} * size_t{Info.Height} < MinParallelPixels)
+        CompareTileRows(0, Result.NumTilesY);
+    else
+        GetTextureLoaderThreadPool().ParallelFor(Result.NumTilesY, 1, CompareTileRows);
+
+    Uint64 SumSquaredError = 0;
+    for (const auto& Tile : Result.Tiles)
+    {
+        Result.NumDiffPixels += Tile.NumDiffPixels;
+        Result.MaxError = std::max(Result.MaxError, Tile.MaxError);
+        SumSquaredError += Tile.SumSquaredError;
+        if (Tile.NumDiffPixels > 0)
+            ++Result.NumDiffTiles;
+    }
+
+    const auto NumValues    = static_cast<double>(Info.Width) * static_cast<double>(Info.Height) * static_cast<double>(Attribs.NumComparedComponents);
+    Result.MeanSquaredError = NumValues > 0 ? static_cast<double>(SumSquaredError) / NumValues : 0.0;
+    Result.PSNR             = Result.MeanSquaredError > 0 ?
+        10.0 * std::log10(255.0 * 255.0 / Result.MeanSquaredError) :
+        std::numeric_limits<double>::infinity();
+}
+
+std::vector<Uint8> ImageComparison::CreateTileHeatmap() const
+{
+    std::vector<Uint8> Heatmap(size_t{Width} * size_t{Height} * 3);
+    for (Uint32 TileY = 0; TileY < NumTilesY; ++TileY)
+    {
+        for (Uint32 TileX = 0; TileX < NumTilesX; ++TileX)
+        {
+            const auto& Tile = Tiles[size_t{TileY} * NumTilesX + TileX];
+            if (Tile.NumDiffPixels == 0)
+                continue;
+
+            const auto FirstCol = TileX * TileSize;
+            const auto FirstRow = TileY * TileSize;
+            const auto EndCol   = std::min(FirstCol + TileSize, Width);
+            const auto EndRow   = std::min(FirstRow + TileSize, Height);
+
+            const auto DiffFraction = static_cast<float>(Tile.NumDiffPixels) / static_cast<float>((EndCol - FirstCol) * (EndRow - FirstRow));
+            const auto R            = static_cast<Uint8>(128.f + 127.f * DiffFraction);
+            const auto G            = static_cast<Uint8>(255.f * DiffFraction);
+            for (Uint32 row = FirstRow; row < EndRow; ++row)
+            {
+                for (Uint32 col = FirstCol; col < EndCol; ++col)
+                {
+                    auto* pPixel = &Heatmap[(size_t{row} * Width + col) * 3];
+                    pPixel[0]    = R;
+                    pPixel[1]    = G;
+                }
+            }
+        }
+    }
+    return Heatmap;
+}
+
+bool CompareImageFiles(const char*      FilePath,
+                       const char*      ReferenceFilePath,
+                       Uint32           Tolerance,
+                       bool             CreateDiffImage,
+                       ImageComparison& Result)
+{
+    RefCntAutoPtr<Image> pImage;
+    RefCntAutoPtr<Image> pReference;
+    CreateImageFromFile(FilePath, &pImage);
+    CreateImageFromFile(ReferenceFilePath, &pReference);
+    if (!pImage || !pReference)
+    {
+        LOG_ERROR_MESSAGE("Failed to load image '", (pImage ? ReferenceFilePath : FilePath), "'");
+        return false;
+    }
+
+    const auto& Desc    = pImage->GetDesc();
+    const auto& RefDesc = pReference->GetDesc();
+    if (Desc.Width != RefDesc.Width || Desc.Height != RefDesc.Height)
+    {
+        LOG_ERROR_MESSAGE("Image size (", Desc.Width, "x", Desc.Height, ") does not match the reference image size (", RefDesc.Width, "x", RefDesc.Height, ")");
+        return false;
+    }
+    if (Desc.ComponentType != VT_UINT8 || RefDesc.ComponentType != VT_UINT8)
+    {
+        LOG_ERROR_MESSAGE("Only 8-bit images can be compared");
+        return false;
+    }
+
+    const auto* pData    = static_cast<const Uint8*>(pImage->GetData()->GetConstDataPtr());
+    const auto* pRefData = static_cast<const Uint8*>(pReference->GetData()->GetConstDataPtr());
+
+    ImageCompareInfo CompareInfo;
+    CompareInfo.Width           = Desc.Width;
+    CompareInfo.Height          = Desc.Height;
+    CompareInfo.NumComponents   = Desc.NumComponents;
+    CompareInfo.pImage          = pData;
+    CompareInfo.Stride          = Desc.RowStride;
+    CompareInfo.pReference      = pRefData;
+    CompareInfo.ReferenceStride = RefDesc.RowStride;
+    CompareInfo.Tolerance       = Tolerance;
+    CompareInfo.CreateDiffImage = CreateDiffImage;
+
+    // Components that only one of the images has, e.g. alpha, are dropped
+    std::vector<Uint8> RepackedPixels;
+    if (Desc.NumComponents > RefDesc.NumComponents)
+    {
+        RepackedPixels            = RepackPixels(Desc, pData, RefDesc.NumComponents);
+        CompareInfo.NumComponents = RefDesc.NumComponents;
+        CompareInfo.pImage        = RepackedPixels.data();
+        CompareInfo.Stride        = Desc.Width * RefDesc.NumComponents;
+    }
+    else if (RefDesc.NumComponents > Desc.NumComponents)
+    {
+        RepackedPixels              = RepackPixels(RefDesc, pRefData, Desc.NumComponents);
+        CompareInfo.pReference      = RepackedPixels.data();
+        CompareInfo.ReferenceStride = Desc.Width * Desc.NumComponents;
+    }
+
+    CompareImages(CompareInfo, Result);
+    return true;
+}
+
+} // namespace Diligent
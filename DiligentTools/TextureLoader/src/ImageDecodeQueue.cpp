@@ -0,0 +1,220 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "pch.h"
+
+#include <algorithm>
+
+#include "ImageDecodeQueue.hpp"
+#include "ThreadPool.hpp"
+#include "Errors.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+ImageDecodeQueue::ImageDecodeQueue(Uint32 NumThreads) :
+    m_pWorkers{new ThreadPool{NumThreads}}
+{
+}
+
+ImageDecodeQueue::~ImageDecodeQueue()
+{
+    // The remaining tasks skip decoding, and the thread pool waits for the running ones
+    m_Abort.store(true);
+    m_pWorkers.reset();
+}
+
+Uint32 ImageDecodeQueue::Enqueue(IDataBlob* pFileData, const ImageLoadInfo& LoadInfo, Uint32 PreviewDownscale)
+{
+    VERIFY_EXPR(pFileData != nullptr);
+
+    std::unique_ptr<Job> pJob{new Job};
+    pJob->pFileData = pFileData;
+    pJob->LoadInfo  = LoadInfo;
+    if (pJob->LoadInfo.Format == IMAGE_FILE_FORMAT_UNKNOWN)
+        pJob->LoadInfo.Format = Image::GetFileFormat(static_cast<const Uint8*>(pFileData->GetConstDataPtr()), pFileData->GetSize());
+
+    if (PreviewDownscale > 1 && pJob->LoadInfo.Format == IMAGE_FILE_FORMAT_JPEG)
+    {
+        // JPEG decoder supports 1/2, 1/4 and 1/8 scaling
+        Uint32 Downscale = 2;
+        while (Downscale * 2 <= std::min(PreviewDownscale, 8u))
+            Downscale *= 2;
+        if (Downscale != PreviewDownscale)
+            LOG_WARNING_MESSAGE("Preview downscale factor ", PreviewDownscale, " is not supported. Using ", Downscale, " instead.");
+        pJob->PreviewDownscale = Downscale;
+    }
+
+    const Uint32 NumTasks = pJob->PreviewDownscale > 1 ? 2 : 1;
+    pJob->NumPendingTasks = NumTasks;
+
+    Uint32 JobId = 0;
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+
+        JobId = m_NextJobId++;
+        if (pJob->PreviewDownscale > 1)
+            m_PendingPreviews.push_back(pJob.get());
+        m_PendingImages.push_back(pJob.get());
+        m_Jobs.emplace(JobId, std::move(pJob));
+    }
+
+    // Every task decodes the next pending image rather than a specific one,
+    // so that previews of all images are decoded first.
+    for (Uint32 i = 0; i < NumTasks; ++i)
+        m_pWorkers->Enqueue([this]() { ProcessNextTask(); });
+
+    return JobId;
+}
+
+void ImageDecodeQueue::ProcessNextTask()
+{
+    Job* pJob      = nullptr;
+    bool IsPreview = false;
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        if (!m_PendingPreviews.empty())
+        {
+            pJob      = m_PendingPreviews.front();
+            IsPreview = true;
+            m_PendingPreviews.pop_front();
+        }
+        else
+        {
+            VERIFY(!m_PendingImages.empty(), "There must be a pending image for every task");
+            pJob = m_PendingImages.front();
+            m_PendingImages.pop_front();
+        }
+    }
+
+    RefCntAutoPtr<Image> pImage;
+    if (!m_Abort.load())
+    {
+        auto LoadInfo = pJob->LoadInfo;
+        if (IsPreview)
+            LoadInfo.DownscaleFactor = pJob->PreviewDownscale;
+
+        Image::CreateFromDataBlob(pJob->pFileData, LoadInfo, &pImage);
+        // The image is created even if decoding fails
+        if (pImage && (pImage->GetDesc().Width == 0 || pImage->GetDesc().Height == 0))
+            pImage.Release();
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        if (IsPreview)
+            pJob->pPreview = std::move(pImage);
+        else
+            pJob->pImage = std::move(pImage);
+
+        VERIFY_EXPR(pJob->NumPendingTasks > 0);
+        if (--pJob->NumPendingTasks == 0)
+            pJob->pFileData.Release();
+    }
+    m_CompleteCV.notify_all();
+}
+
+RefCntAutoPtr<Image> ImageDecodeQueue::GetPreview(Uint32 JobId)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+
+    auto it = m_Jobs.find(JobId);
+    if (it == m_Jobs.end())
+    {
+        UNEXPECTED("Job ", JobId, " is not found in the queue");
+        return {};
+    }
+    return it->second->pPreview;
+}
+
+bool ImageDecodeQueue::IsComplete(Uint32 JobId)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+
+    auto it = m_Jobs.find(JobId);
+    if (it == m_Jobs.end())
+    {
+        UNEXPECTED("Job ", JobId, " is not found in the queue");
+        return false;
+    }
+    return it->second->NumPendingTasks == 0;
+}
+
+RefCntAutoPtr<Image> ImageDecodeQueue::WaitForImage(Uint32 JobId)
+{
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+
+    auto it = m_Jobs.find(JobId);
+    if (it == m_Jobs.end())
+    {
+        UNEXPECTED("Job ", JobId, " is not found in the queue");
+        return {};
+    }
+
+    // The job is owned by the queue, so the pointer stays valid when the map is modified
+    auto* pJob = it->second.get();
+    m_CompleteCV.wait(Lock, [pJob]() { return pJob->NumPendingTasks == 0; });
+
+    auto pImage = std::move(pJob->pImage);
+    m_Jobs.erase(JobId);
+    return pImage;
+}
+
+std::vector<RefCntAutoPtr<Image>> ImageDecodeQueue::WaitForAll()
+{
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+
+    m_CompleteCV.wait(Lock, [this]() {
+        return std::all_of(m_Jobs.begin(), m_Jobs.end(), [](const std::pair<const Uint32, std::unique_ptr<Job>>& It) {
+            return It.second->NumPendingTasks == 0;
+        });
+    });
+
+    std::vector<Uint32> JobIds;
+    JobIds.reserve(m_Jobs.size());
+    for (const auto& It : m_Jobs)
+        JobIds.push_back(It.first);
+    std::sort(JobIds.begin(), JobIds.end());
+
+    std::vector<RefCntAutoPtr<Image>> Images;
+    Images.reserve(JobIds.size());
+    for (auto JobId : JobIds)
+        Images.emplace_back(std::move(m_Jobs[JobId]->pImage));
+    m_Jobs.clear();
+
+    return Images;
+}
+
+size_t ImageDecodeQueue::GetNumJobs()
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_Jobs.size();
+}
+
+} // namespace Diligent
@@ -60,11 +60,15 @@ my_error_exit(j_common_ptr cinfo)
 
 DECODE_JPEG_RESULT Diligent_DecodeJpeg(IDataBlob* pSrcJpegBits,
                                        IDataBlob* pDstPixels,
-                                       ImageDesc* pDstImgDesc)
+                                       ImageDesc* pDstImgDesc,
+                                       Uint32     DownscaleFactor)
 {
     if (!pSrcJpegBits || !pDstPixels || !pDstImgDesc)
         return DECODE_JPEG_RESULT_INVALID_ARGUMENTS;
 
+    if (DownscaleFactor != 1 && DownscaleFactor != 2 && DownscaleFactor != 4 && DownscaleFactor != 8)
+        return DECODE_JPEG_RESULT_INVALID_ARGUMENTS;
+
     // https://github.com/LuaDist/libjpeg/blob/master/example.c
 
     // This struct contains the JPEG decompression parameters and pointers to
@@ -94,9 +98,9 @@ DECODE_JPEG_RESULT Diligent_DecodeJpeg(IDataBlob* pSrcJpegBits,
     jpeg_create_decompress(&cinfo);
 
     // Step 2: specify data source
-    unsigned char* pSrcPtr = IDataBlob_GetDataPtr(pSrcJpegBits);
-    unsigned long  SrcSize = (unsigned long)IDataBlob_GetSize(pSrcJpegBits);
-    jpeg_mem_src(&cinfo, pSrcPtr, SrcSize);
+    const unsigned char* pSrcPtr = IDataBlob_GetConstDataPtr(pSrcJpegBits);
+    unsigned long        SrcSize = (unsigned long)IDataBlob_GetSize(pSrcJpegBits);
+    jpeg_mem_src(&cinfo, (unsigned char*)pSrcPtr, SrcSize);
 
     // Step 3: read file parameters with jpeg_read_header()
     jpeg_read_header(&cinfo, TRUE);
@@ -108,8 +112,10 @@ DECODE_JPEG_RESULT Diligent_DecodeJpeg(IDataBlob* pSrcJpegBits,
 
     // Step 4: set parameters for decompression
 
-    // In this example, we don't need to change any of the defaults set by
-    // jpeg_read_header(), so we do nothing here.
+    // Scale the image by 1/DownscaleFactor. The scaling is performed by the inverse DCT,
+    // so the decoder does proportionally less work.
+    cinfo.scale_num   = 1;
+    cinfo.scale_denom = DownscaleFactor;
 
 
     // Step 5: Start decompressor
@@ -218,7 +218,7 @@ void CreateTextureFromKTX(IDataBlob*             pKTXData,
                           ITexture**             ppTexture)
 {
     static constexpr Uint8 KTX10FileIdentifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
-    const Uint8*           pData                   = reinterpret_cast<const Uint8*>(pKTXData->GetDataPtr());
+    const Uint8*           pData                   = reinterpret_cast<const Uint8*>(pKTXData->GetConstDataPtr());
     const auto             DataSize                = pKTXData->GetSize();
     if (DataSize >= 12 && memcmp(pData, KTX10FileIdentifier, sizeof(KTX10FileIdentifier)) == 0)
     {
@@ -273,7 +273,7 @@ void CreateTextureFromKTX(IDataBlob*             pKTXData,
                 pData += Align(MipInfo.MipSize, 4u);
             }
         }
-        VERIFY(pData - reinterpret_cast<const Uint8*>(pKTXData->GetDataPtr()) == static_cast<ptrdiff_t>(DataSize), "Unexpected data size");
+        VERIFY(pData - reinterpret_cast<const Uint8*>(pKTXData->GetConstDataPtr()) == static_cast<ptrdiff_t>(DataSize), "Unexpected data size");
 
         TextureData InitData(SubresData.data(), static_cast<Uint32>(SubresData.size()));
         pDevice->CreateTexture(TexDesc, &InitData, ppTexture);
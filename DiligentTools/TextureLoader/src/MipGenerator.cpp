@@ -0,0 +1,464 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "pch.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#    define MIPGEN_USE_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define MIPGEN_USE_SSE2 1
+#endif
+
+#include "MipGenerator.hpp"
+#include "ColorConversion.h"
+#include "ThreadPool.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Levels with fewer coarse texels are processed by the calling thread only
+constexpr size_t MinParallelTexels = 512 * 512;
+// Number of coarse texels processed by a thread at a time
+constexpr size_t TexelsPerChunk = 64 * 1024;
+
+struct MipAttribs
+{
+    Uint32 NumChannels;
+    Uint32 ComponentSize;
+    bool   IsSRGB;
+
+    const Uint8* pFineMip;
+    Uint32       FineMipStride;
+    Uint32       FineMipWidth;
+    Uint32       FineMipHeight;
+
+    Uint8* pCoarseMip;
+    Uint32 CoarseMipStride;
+    Uint32 CoarseMipWidth;
+    Uint32 CoarseMipHeight;
+
+    const Uint8* GetFineRow(Uint32 Row) const
+    {
+        return pFineMip + size_t{Row} * size_t{FineMipStride};
+    }
+
+    Uint8* GetCoarseRow(Uint32 Row) const
+    {
+        return pCoarseMip + size_t{Row} * size_t{CoarseMipStride};
+    }
+
+    // The number of coarse texels in a row that are averaged from two fine texels.
+    // The last coarse texel of a one texel wide level is averaged from one texel only.
+    Uint32 GetNumFullBlocks() const
+    {
+        return std::min(CoarseMipWidth, FineMipWidth / 2);
+    }
+};
+
+// Conversion tables for 8-bit sRGB channels
+class SRGB8Tables
+{
+public:
+    SRGB8Tables() noexcept
+    {
+        for (Uint32 i = 0; i < m_ToLinear.size(); ++i)
+            m_ToLinear[i] = SRGBToLinear(static_cast<float>(i) / 255.f);
+
+        // Linear value at which the rounded sRGB value changes from i-1 to i
+        m_Thresholds[0] = 0;
+        for (Uint32 i = 1; i < m_Thresholds.size(); ++i)
+            m_Thresholds[i] = SRGBToLinear((static_cast<float>(i) - 0.5f) / 255.f);
+
+        // The first guess must never exceed the result, so it is computed for a value that
+        // is slightly less than the start of the bucket.
+        Uint32 Value = 0;
+        for (Uint32 i = 0; i < m_FirstGuess.size(); ++i)
+        {
+            const auto BucketStart = (static_cast<float>(i) - 0.5f) / static_cast<float>(NumBuckets);
+            while (Value < 255 && m_Thresholds[Value + 1] <= BucketStart)
+                ++Value;
+            m_FirstGuess[i] = static_cast<Uint8>(Value);
+        }
+    }
+
+    float ToLinear(Uint8 Value) const
+    {
+        return m_ToLinear[Value];
+    }
+
+    // Converts the linear value to the nearest 8-bit sRGB value. The bucket is small
+    // enough for the first guess to be off by no more than two.
+    Uint8 ToSRGB(float Linear) const
+    {
+        const auto Bucket = static_cast<Uint32>(std::min(std::max(Linear, 0.f), 1.f) * static_cast<float>(NumBuckets - 1));
+
+        Uint32 Value = m_FirstGuess[Bucket];
+        while (Value < 255 && Linear >= m_Thresholds[Value + 1])
+            ++Value;
+        return static_cast<Uint8>(Value);
+    }
+
+private:
+    static constexpr Uint32 NumBuckets = 4096;
+
+    std::array<float, 256>        m_ToLinear;
+    std::array<float, 256>        m_Thresholds;
+    std::array<Uint8, NumBuckets> m_FirstGuess;
+};
+
+const SRGB8Tables& GetSRGB8Tables()
+{
+    static const SRGB8Tables Tables;
+    return Tables;
+}
+
+template <typename ChannelType>
+ChannelType LinearAverage(ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3)
+{
+    static_assert(std::numeric_limits<ChannelType>::is_integer && !std::numeric_limits<ChannelType>::is_signed, "Unsigned integers are expected");
+    return static_cast<ChannelType>((static_cast<Uint32>(c0) + static_cast<Uint32>(c1) + static_cast<Uint32>(c2) + static_cast<Uint32>(c3)) / 4);
+}
+
+template <typename ChannelType>
+struct LinearAverageFunc
+{
+    ChannelType operator()(Uint32 /*Channel*/, ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3) const
+    {
+        return LinearAverage(c0, c1, c2, c3);
+    }
+};
+
+template <typename ChannelType>
+struct SRGBAverageFunc
+{
+    // The alpha channel is not sRGB-encoded
+    const Uint32 AlphaChannel;
+
+    ChannelType operator()(Uint32 Channel, ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3) const
+    {
+        if (Channel == AlphaChannel)
+            return LinearAverage(c0, c1, c2, c3);
+
+        static constexpr float NormVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
+
+        const float fLinearAverage = (SRGBToLinear(c0 / NormVal) + SRGBToLinear(c1 / NormVal) + SRGBToLinear(c2 / NormVal) + SRGBToLinear(c3 / NormVal)) * 0.25f;
+        const float fSRGBAverage   = LinearToSRGB(fLinearAverage) * NormVal + 0.5f;
+        return static_cast<ChannelType>(std::min(std::max(fSRGBAverage, 0.f), NormVal));
+    }
+};
+
+template <>
+struct SRGBAverageFunc<Uint8>
+{
+    explicit SRGBAverageFunc(Uint32 _AlphaChannel) :
+        AlphaChannel{_AlphaChannel},
+        Tables{GetSRGB8Tables()}
+    {}
+
+    const Uint32       AlphaChannel;
+    const SRGB8Tables& Tables;
+
+    Uint8 operator()(Uint32 Channel, Uint8 c0, Uint8 c1, Uint8 c2, Uint8 c3) const
+    {
+        if (Channel == AlphaChannel)
+            return LinearAverage(c0, c1, c2, c3);
+
+        return Tables.ToSRGB((Tables.ToLinear(c0) + Tables.ToLinear(c1) + Tables.ToLinear(c2) + Tables.ToLinear(c3)) * 0.25f);
+    }
+};
+
+// Computes coarse texels [FirstCol, CoarseMipWidth) of the row
+template <typename ChannelType, typename AverageFuncType>
+void ComputeCoarseRow(const MipAttribs& Attribs, Uint32 Row, Uint32 FirstCol, const AverageFuncType& Average)
+{
+    const auto* pSrcRow0 = reinterpret_cast<const ChannelType*>(Attribs.GetFineRow(Row * 2));
+    const auto* pSrcRow1 = reinterpret_cast<const ChannelType*>(Attribs.GetFineRow(std::min(Row * 2 + 1, Attribs.FineMipHeight - 1)));
+    auto*       pDstRow  = reinterpret_cast<ChannelType*>(Attribs.GetCoarseRow(Row));
+
+    const auto NumChannels = Attribs.NumChannels;
+    for (Uint32 col = FirstCol; col < Attribs.CoarseMipWidth; ++col)
+    {
+        const auto src_col0 = col * 2;
+        const auto src_col1 = std::min(col * 2 + 1, Attribs.FineMipWidth - 1);
+
+        for (Uint32 c = 0; c < NumChannels; ++c)
+        {
+            const auto Chnl00 = pSrcRow0[src_col0 * NumChannels + c];
+            const auto Chnl01 = pSrcRow0[src_col1 * NumChannels + c];
+            const auto Chnl10 = pSrcRow1[src_col0 * NumChannels + c];
+            const auto Chnl11 = pSrcRow1[src_col1 * NumChannels + c];
+
+            pDstRow[col * NumChannels + c] = Average(c, Chnl00, Chnl01, Chnl10, Chnl11);
+        }
+    }
+}
+
+#if MIPGEN_USE_SSE2
+// Returns 16-bit sums of 2x2 blocks of RGBA8 texels: two coarse texels from four fine texels in two rows
+inline __m128i SumBlocksRGBA8(__m128i Row0, __m128i Row1)
+{
+    const auto Zero = _mm_setzero_si128();
+
+    auto Lo = _mm_add_epi16(_mm_unpacklo_epi8(Row0, Zero), _mm_unpacklo_epi8(Row1, Zero));
+    auto Hi = _mm_add_epi16(_mm_unpackhi_epi8(Row0, Zero), _mm_unpackhi_epi8(Row1, Zero));
+    // Add the right texel of every pair to the left one
+    Lo = _mm_add_epi16(Lo, _mm_srli_si128(Lo, 8));
+    Hi = _mm_add_epi16(Hi, _mm_srli_si128(Hi, 8));
+    return _mm_unpacklo_epi64(Lo, Hi);
+}
+
+// Returns the average of a 2x2 block of RGBA16 texels as four 32-bit values
+inline __m128i AverageBlockRGBA16(__m128i Row0, __m128i Row1)
+{
+    const auto Zero = _mm_setzero_si128();
+
+    auto Sum = _mm_add_epi32(_mm_unpacklo_epi16(Row0, Zero), _mm_unpackhi_epi16(Row0, Zero));
+    Sum      = _mm_add_epi32(Sum, _mm_add_epi32(_mm_unpacklo_epi16(Row1, Zero), _mm_unpackhi_epi16(Row1, Zero)));
+    return _mm_srli_epi32(Sum, 2);
+}
+
+// Packs 32-bit values from [0, 65535] range to 16 bits. SSE2 only has a signed
+// saturating pack, so the values are biased to the signed range and back.
+inline __m128i PackUnorm16(__m128i Val0, __m128i Val1)
+{
+    const auto Bias32 = _mm_set1_epi32(0x8000);
+    const auto Bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(Val0, Bias32), _mm_sub_epi32(Val1, Bias32)), Bias16);
+}
+#endif
+
+#if MIPGEN_USE_AVX2
+// Same as the SSE2 version for every 128-bit lane: four coarse texels from eight fine texels
+inline __m256i SumBlocksRGBA8(__m256i Row0, __m256i Row1)
+{
+    const auto Zero = _mm256_setzero_si256();
+
+    auto Lo = _mm256_add_epi16(_mm256_unpacklo_epi8(Row0, Zero), _mm256_unpacklo_epi8(Row1, Zero));
+    auto Hi = _mm256_add_epi16(_mm256_unpackhi_epi8(Row0, Zero), _mm256_unpackhi_epi8(Row1, Zero));
+    Lo      = _mm256_add_epi16(Lo, _mm256_srli_si256(Lo, 8));
+    Hi      = _mm256_add_epi16(Hi, _mm256_srli_si256(Hi, 8));
+    return _mm256_unpacklo_epi64(Lo, Hi);
+}
+
+// Same as the SSE2 version for every 128-bit lane: two coarse texels from four fine texels
+inline __m256i AverageBlocksRGBA16(__m256i Row0, __m256i Row1)
+{
+    const auto Zero = _mm256_setzero_si256();
+
+    auto Sum = _mm256_add_epi32(_mm256_unpacklo_epi16(Row0, Zero), _mm256_unpackhi_epi16(Row0, Zero));
+    Sum      = _mm256_add_epi32(Sum, _mm256_add_epi32(_mm256_unpacklo_epi16(Row1, Zero), _mm256_unpackhi_epi16(Row1, Zero)));
+    return _mm256_srli_epi32(Sum, 2);
+}
+#endif
+
+// Computes coarse texels of an RGBA8 row with SIMD instructions and returns their number.
+// The remaining texels must be computed by the scalar code.
+Uint32 ComputeCoarseRowRGBA8(const MipAttribs& Attribs, Uint32 Row)
+{
+    Uint32 col = 0;
+#if MIPGEN_USE_SSE2 || MIPGEN_USE_AVX2
+    const auto* pSrcRow0  = Attribs.GetFineRow(Row * 2);
+    const auto* pSrcRow1  = Attribs.GetFineRow(std::min(Row * 2 + 1, Attribs.FineMipHeight - 1));
+    auto*       pDstRow   = Attribs.GetCoarseRow(Row);
+    const auto  NumBlocks = Attribs.GetNumFullBlocks();
+#endif
+
+#if MIPGEN_USE_AVX2
+    for (; col + 8 <= NumBlocks; col += 8)
+    {
+        const auto* pSrc0 = reinterpret_cast<const __m256i*>(pSrcRow0 + col * 8);
+        const auto* pSrc1 = reinterpret_cast<const __m256i*>(pSrcRow1 + col * 8);
+
+        const auto Sum0 = SumBlocksRGBA8(_mm256_loadu_si256(pSrc0 + 0), _mm256_loadu_si256(pSrc1 + 0));
+        const auto Sum1 = SumBlocksRGBA8(_mm256_loadu_si256(pSrc0 + 1), _mm256_loadu_si256(pSrc1 + 1));
+
+        // Packing interleaves the lanes: c0 c1 c4 c5 | c2 c3 c6 c7
+        const auto Packed = _mm256_packus_epi16(_mm256_srli_epi16(Sum0, 2), _mm256_srli_epi16(Sum1, 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDstRow + col * 4), _mm256_permute4x64_epi64(Packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+#endif
+
+#if MIPGEN_USE_SSE2
+    for (; col + 4 <= NumBlocks; col += 4)
+    {
+        const auto* pSrc0 = reinterpret_cast<const __m128i*>(pSrcRow0 + col * 8);
+        const auto* pSrc1 = reinterpret_cast<const __m128i*>(pSrcRow1 + col * 8);
+
+        const auto Sum0 = SumBlocksRGBA8(_mm_loadu_si128(pSrc0 + 0), _mm_loadu_si128(pSrc1 + 0));
+        const auto Sum1 = SumBlocksRGBA8(_mm_loadu_si128(pSrc0 + 1), _mm_loadu_si128(pSrc1 + 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstRow + col * 4), _mm_packus_epi16(_mm_srli_epi16(Sum0, 2), _mm_srli_epi16(Sum1, 2)));
+    }
+#endif
+
+    return col;
+}
+
+// Computes coarse texels of an RGBA16 row with SIMD instructions and returns their number
+Uint32 ComputeCoarseRowRGBA16(const MipAttribs& Attribs, Uint32 Row)
+{
+    Uint32 col = 0;
+#if MIPGEN_USE_SSE2 || MIPGEN_USE_AVX2
+    const auto* pSrcRow0  = Attribs.GetFineRow(Row * 2);
+    const auto* pSrcRow1  = Attribs.GetFineRow(std::min(Row * 2 + 1, Attribs.FineMipHeight - 1));
+    auto*       pDstRow   = Attribs.GetCoarseRow(Row);
+    const auto  NumBlocks = Attribs.GetNumFullBlocks();
+#endif
+
+#if MIPGEN_USE_AVX2
+    for (; col + 4 <= NumBlocks; col += 4)
+    {
+        const auto* pSrc0 = reinterpret_cast<const __m256i*>(pSrcRow0 + col * 16);
+        const auto* pSrc1 = reinterpret_cast<const __m256i*>(pSrcRow1 + col * 16);
+
+        const auto Avg0 = AverageBlocksRGBA16(_mm256_loadu_si256(pSrc0 + 0), _mm256_loadu_si256(pSrc1 + 0));
+        const auto Avg1 = AverageBlocksRGBA16(_mm256_loadu_si256(pSrc0 + 1), _mm256_loadu_si256(pSrc1 + 1));
+
+        // Packing interleaves the lanes: c0 c2 | c1 c3
+        const auto Packed = _mm256_packus_epi32(Avg0, Avg1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDstRow + col * 8), _mm256_permute4x64_epi64(Packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+#endif
+
+#if MIPGEN_USE_SSE2
+    for (; col + 2 <= NumBlocks; col += 2)
+    {
+        const auto* pSrc0 = reinterpret_cast<const __m128i*>(pSrcRow0 + col * 16);
+        const auto* pSrc1 = reinterpret_cast<const __m128i*>(pSrcRow1 + col * 16);
+
+        const auto Avg0 = AverageBlockRGBA16(_mm_loadu_si128(pSrc0 + 0), _mm_loadu_si128(pSrc1 + 0));
+        const auto Avg1 = AverageBlockRGBA16(_mm_loadu_si128(pSrc0 + 1), _mm_loadu_si128(pSrc1 + 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstRow + col * 8), PackUnorm16(Avg0, Avg1));
+    }
+#endif
+
+    return col;
+}
+
+template <typename ChannelType>
+void ComputeCoarseRows(const MipAttribs& Attribs, Uint32 FirstRow, Uint32 EndRow)
+{
+    if (Attribs.IsSRGB)
+    {
+        // sRGB channels are converted through lookup tables, which SIMD instructions can't speed up
+        const SRGBAverageFunc<ChannelType> Average{Attribs.NumChannels == 4 ? 3u : ~0u};
+        for (Uint32 row = FirstRow; row < EndRow; ++row)
+            ComputeCoarseRow<ChannelType>(Attribs, row, 0, Average);
+    }
+    else
+    {
+        const LinearAverageFunc<ChannelType> Average;
+        for (Uint32 row = FirstRow; row < EndRow; ++row)
+        {
+            Uint32 FirstCol = 0;
+            if (Attribs.NumChannels == 4)
+                FirstCol = sizeof(ChannelType) == 1 ? ComputeCoarseRowRGBA8(Attribs, row) : ComputeCoarseRowRGBA16(Attribs, row);
+            ComputeCoarseRow<ChannelType>(Attribs, row, FirstCol, Average);
+        }
+    }
+}
+
+} // namespace
+
+ThreadPool& GetTextureLoaderThreadPool()
+{
+    static ThreadPool Pool;
+    return Pool;
+}
+
+void ComputeCoarseMip(Uint32      NumChannels,
+                      Uint32      ComponentSize,
+                      bool        IsSRGB,
+                      const void* pFineMip,
+                      Uint32      FineMipStride,
+                      Uint32      FineMipWidth,
+                      Uint32      FineMipHeight,
+                      void*       pCoarseMip,
+                      Uint32      CoarseMipStride,
+                      Uint32      CoarseMipWidth,
+                      Uint32      CoarseMipHeight)
+{
+    VERIFY_EXPR(FineMipWidth > 0 && FineMipHeight > 0 && FineMipStride > 0);
+    VERIFY_EXPR(CoarseMipWidth > 0 && CoarseMipHeight > 0 && CoarseMipStride > 0);
+    VERIFY_EXPR(CoarseMipWidth == std::max(FineMipWidth / 2u, 1u) && CoarseMipHeight == std::max(FineMipHeight / 2u, 1u));
+
+    // clang-format off
+    const MipAttribs Attribs
+    {
+        NumChannels,
+        ComponentSize,
+        IsSRGB,
+        static_cast<const Uint8*>(pFineMip),
+        FineMipStride,
+        FineMipWidth,
+        FineMipHeight,
+        static_cast<Uint8*>(pCoarseMip),
+        CoarseMipStride,
+        CoarseMipWidth,
+        CoarseMipHeight
+    };
+    // clang-format on
+
+    void (*ComputeRows)(const MipAttribs&, Uint32, Uint32) = nullptr;
+    switch (ComponentSize)
+    {
+        case 1: ComputeRows = ComputeCoarseRows<Uint8>; break;
+        case 2: ComputeRows = ComputeCoarseRows<Uint16>; break;
+
+        default:
+            UNEXPECTED("Unsupported component size: ", ComponentSize);
+            return;
+    }
+
+    if (size_t{CoarseMipWidth} * size_t{CoarseMipHeight} < MinParallelTexels)
+    {
+        ComputeRows(Attribs, 0, CoarseMipHeight);
+    }
+    else
+    {
+        const auto RowsPerChunk = std::max(TexelsPerChunk / CoarseMipWidth, size_t{1});
+        GetTextureLoaderThreadPool().ParallelFor(CoarseMipHeight, RowsPerChunk,
+                                                 [&](size_t FirstRow, size_t EndRow) //
+                                                 {
+                                                     ComputeRows(Attribs, static_cast<Uint32>(FirstRow), static_cast<Uint32>(EndRow));
+                                                 });
+    }
+}
+
+} // namespace Diligent
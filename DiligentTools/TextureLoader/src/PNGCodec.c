@@ -43,7 +43,7 @@ typedef struct PNGReadFnState PNGReadFnState;
 static void PngReadCallback(png_structp pngPtr, png_bytep data, png_size_t length)
 {
     PNGReadFnState* pState  = (PNGReadFnState*)(png_get_io_ptr(pngPtr));
-    Uint8*          pDstPtr = (Uint8*)IDataBlob_GetDataPtr(pState->pPngBits) + pState->Offset;
+    const Uint8*    pDstPtr = (const Uint8*)IDataBlob_GetConstDataPtr(pState->pPngBits) + pState->Offset;
     memcpy(data, pDstPtr, length);
     pState->Offset += length;
 }
@@ -60,7 +60,7 @@ DECODE_PNG_RESULT Diligent_DecodePng(IDataBlob* pSrcPngBits,
     // https://gist.github.com/niw/5963798
 
     const size_t    PngSigSize = 8;
-    png_const_bytep pngsig     = (png_const_bytep)IDataBlob_GetDataPtr(pSrcPngBits);
+    png_const_bytep pngsig     = (png_const_bytep)IDataBlob_GetConstDataPtr(pSrcPngBits);
     //Let LibPNG check the signature. If this function returns 0, everything is OK.
     if (png_sig_cmp(pngsig, 0, PngSigSize) != 0)
     {
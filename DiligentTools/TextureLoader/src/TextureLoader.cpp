@@ -36,7 +36,8 @@
 #include "DDSLoader.h"
 #include "PNGCodec.h"
 #include "JPEGCodec.h"
-#include "ColorConversion.h"
+#include "MipGenerator.hpp"
+#include "BCEncoder.hpp"
 #include "Image.h"
 
 extern "C"
@@ -54,7 +55,8 @@ extern "C"
 
     Diligent::DECODE_JPEG_RESULT Diligent_DecodeJpeg(Diligent::IDataBlob* pSrcJpegBits,
                                                      Diligent::IDataBlob* pDstPixels,
-                                                     Diligent::ImageDesc* pDstImgDesc);
+                                                     Diligent::ImageDesc* pDstImgDesc,
+                                                     Diligent::Uint32     DownscaleFactor);
 
     Diligent::ENCODE_JPEG_RESULT Diligent_EncodeJpeg(Diligent::Uint8*     pSrcRGBData,
                                                      Diligent::Uint32     Width,
@@ -66,80 +68,6 @@ extern "C"
 namespace Diligent
 {
 
-template <typename ChannelType>
-ChannelType SRGBAverage(ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3)
-{
-    static constexpr float NormVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
-
-    float fc0 = static_cast<float>(c0) / NormVal;
-    float fc1 = static_cast<float>(c1) / NormVal;
-    float fc2 = static_cast<float>(c2) / NormVal;
-    float fc3 = static_cast<float>(c3) / NormVal;
-
-    float fLinearAverage = (SRGBToLinear(fc0) + SRGBToLinear(fc1) + SRGBToLinear(fc2) + SRGBToLinear(fc3)) / 4.f;
-    float fSRGBAverage   = LinearToSRGB(fLinearAverage) * NormVal;
-
-    static constexpr float MinVal = static_cast<float>(std::numeric_limits<ChannelType>::min());
-    static constexpr float MaxVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
-
-    fSRGBAverage = std::max(fSRGBAverage, MinVal);
-    fSRGBAverage = std::min(fSRGBAverage, MaxVal);
-
-    return static_cast<ChannelType>(fSRGBAverage);
-}
-
-template <typename ChannelType>
-ChannelType LinearAverage(ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3)
-{
-    static_assert(std::numeric_limits<ChannelType>::is_integer && !std::numeric_limits<ChannelType>::is_signed, "Unsigned integers are expected");
-    return static_cast<ChannelType>((static_cast<Uint32>(c0) + static_cast<Uint32>(c1) + static_cast<Uint32>(c2) + static_cast<Uint32>(c3)) / 4);
-}
-
-template <typename ChannelType>
-void ComputeCoarseMip(Uint32      NumChannels,
-                      bool        IsSRGB,
-                      const void* pFineMip,
-                      Uint32      FineMipStride,
-                      Uint32      FineMipWidth,
-                      Uint32      FineMipHeight,
-                      void*       pCoarseMip,
-                      Uint32      CoarseMipStride,
-                      Uint32      CoarseMipWidth,
-                      Uint32      CoarseMipHeight)
-{
-    VERIFY_EXPR(FineMipWidth > 0 && FineMipHeight > 0 && FineMipStride > 0);
-    VERIFY_EXPR(CoarseMipWidth > 0 && CoarseMipHeight > 0 && CoarseMipStride > 0);
-
-    for (Uint32 row = 0; row < CoarseMipHeight; ++row)
-    {
-        auto src_row0 = row * 2;
-        auto src_row1 = std::min(row * 2 + 1, FineMipHeight - 1);
-
-        auto pSrcRow0 = reinterpret_cast<const ChannelType*>(reinterpret_cast<const Uint8*>(pFineMip) + src_row0 * FineMipStride);
-        auto pSrcRow1 = reinterpret_cast<const ChannelType*>(reinterpret_cast<const Uint8*>(pFineMip) + src_row1 * FineMipStride);
-
-        for (Uint32 col = 0; col < CoarseMipWidth; ++col)
-        {
-            auto src_col0 = col * 2;
-            auto src_col1 = std::min(col * 2 + 1, FineMipWidth - 1);
-
-            for (Uint32 c = 0; c < NumChannels; ++c)
-            {
-                auto Chnl00 = pSrcRow0[src_col0 * NumChannels + c];
-                auto Chnl01 = pSrcRow0[src_col1 * NumChannels + c];
-                auto Chnl10 = pSrcRow1[src_col0 * NumChannels + c];
-                auto Chnl11 = pSrcRow1[src_col1 * NumChannels + c];
-
-                auto& DstCol = reinterpret_cast<ChannelType*>(reinterpret_cast<Uint8*>(pCoarseMip) + row * CoarseMipStride)[col * NumChannels + c];
-                if (IsSRGB)
-                    DstCol = SRGBAverage(Chnl00, Chnl01, Chnl10, Chnl11);
-                else
-                    DstCol = LinearAverage(Chnl00, Chnl01, Chnl10, Chnl11);
-            }
-        }
-    }
-}
-
 template <typename ChannelType>
 void RGBToRGBA(const void* pRGBData,
                Uint32      RGBStride,
@@ -160,6 +88,50 @@ void RGBToRGBA(const void* pRGBData,
         }
 }
 
+// Returns the block-compressed format of the texture, or TEX_FORMAT_UNKNOWN if the texture can't be compressed
+static TEXTURE_FORMAT SelectCompressedFormat(const TextureLoadInfo&   TexLoadInfo,
+                                             const TextureDesc&       TexDesc,
+                                             Uint32                   NumComponents,
+                                             Uint32                   ChannelDepth,
+                                             bool                     IsSRGB,
+                                             const TextureSubResData& Level0Data)
+{
+    const auto Mode = TexLoadInfo.CompressMode;
+    if (Mode == TEXTURE_LOAD_COMPRESS_MODE_NONE)
+        return TEX_FORMAT_UNKNOWN;
+
+    const char* Reason = nullptr;
+    if (TexLoadInfo.Format != TEX_FORMAT_UNKNOWN)
+        Reason = "texture format is specified explicitly";
+    else if (ChannelDepth != 8)
+        Reason = "only 8-bit images can be compressed";
+    else if ((TexDesc.Width % 4) != 0 || (TexDesc.Height % 4) != 0)
+        Reason = "image dimensions must be multiples of 4";
+    else if ((Mode == TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR || Mode == TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR_HQ) && NumComponents != 4)
+        Reason = "color compression requires an RGB or RGBA image";
+    else if (Mode == TEXTURE_LOAD_COMPRESS_MODE_BC_NORMAL && NumComponents < 2)
+        Reason = "normal map compression requires at least two channels";
+
+    if (Reason != nullptr)
+    {
+        LOG_WARNING_MESSAGE("Texture '", (TexLoadInfo.Name != nullptr ? TexLoadInfo.Name : ""), "' is created uncompressed: ", Reason);
+        return TEX_FORMAT_UNKNOWN;
+    }
+
+    bool HasAlpha = false;
+    if (Mode == TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR)
+    {
+        for (Uint32 row = 0; row < TexDesc.Height && !HasAlpha; ++row)
+        {
+            const auto* pRow = static_cast<const Uint8*>(Level0Data.pData) + size_t{Level0Data.Stride} * row;
+            for (Uint32 col = 0; col < TexDesc.Width && !HasAlpha; ++col)
+                HasAlpha = pRow[col * 4 + 3] != 255;
+        }
+    }
+
+    return GetCompressedTextureFormat(Mode, HasAlpha, IsSRGB);
+}
+
 void CreateTextureFromImage(Image*                 pSrcImage,
                             const TextureLoadInfo& TexLoadInfo,
                             IRenderDevice*         pDevice,
@@ -219,6 +191,7 @@ void CreateTextureFromImage(Image*                 pSrcImage,
 
     std::vector<TextureSubResData>  pSubResources(TexDesc.MipLevels);
     std::vector<std::vector<Uint8>> Mips(TexDesc.MipLevels);
+    std::vector<std::vector<Uint8>> CompressedMips;
 
     if (ImgDesc.NumComponents == 3)
     {
@@ -259,22 +232,11 @@ void CreateTextureFromImage(Image*                 pSrcImage,
 
         if (TexLoadInfo.GenerateMips)
         {
-            if (ChannelDepth == 8)
-            {
-                ComputeCoarseMip<Uint8>(NumComponents, IsSRGB,
-                                        pSubResources[m - 1].pData, pSubResources[m - 1].Stride,
-                                        MipWidth, MipHeight,
-                                        Mips[m].data(), CoarseMipStride,
-                                        CoarseMipWidth, CoarseMipHeight);
-            }
-            else if (ChannelDepth == 16)
-            {
-                ComputeCoarseMip<Uint16>(NumComponents, IsSRGB,
-                                         pSubResources[m - 1].pData, pSubResources[m - 1].Stride,
-                                         MipWidth, MipHeight,
-                                         Mips[m].data(), CoarseMipStride,
-                                         CoarseMipWidth, CoarseMipHeight);
-            }
+            ComputeCoarseMip(NumComponents, ChannelDepth / 8, IsSRGB,
+                             pSubResources[m - 1].pData, pSubResources[m - 1].Stride,
+                             MipWidth, MipHeight,
+                             Mips[m].data(), CoarseMipStride,
+                             CoarseMipWidth, CoarseMipHeight);
         }
 
         pSubResources[m].pData  = Mips[m].data();
@@ -284,6 +246,28 @@ void CreateTextureFromImage(Image*                 pSrcImage,
         MipHeight = CoarseMipHeight;
     }
 
+    const auto CompressedFormat = SelectCompressedFormat(TexLoadInfo, TexDesc, NumComponents, ChannelDepth, IsSRGB, pSubResources[0]);
+    if (CompressedFormat != TEX_FORMAT_UNKNOWN)
+    {
+        // Levels are compressed after the whole mip chain has been computed from the uncompressed data
+        const auto BlockSize = Uint32{GetTextureFormatAttribs(CompressedFormat).ComponentSize};
+        CompressedMips.resize(TexDesc.MipLevels);
+        for (Uint32 m = 0; m < TexDesc.MipLevels; ++m)
+        {
+            const auto Width       = std::max(TexDesc.Width >> m, 1u);
+            const auto Height      = std::max(TexDesc.Height >> m, 1u);
+            const auto BlockStride = (Width + 3) / 4 * BlockSize;
+            CompressedMips[m].resize(size_t{BlockStride} * size_t{(Height + 3) / 4});
+
+            CompressBlocks(Width, Height, static_cast<const Uint8*>(pSubResources[m].pData), pSubResources[m].Stride, NumComponents,
+                           CompressedFormat, CompressedMips[m].data(), BlockStride);
+
+            pSubResources[m].pData  = CompressedMips[m].data();
+            pSubResources[m].Stride = BlockStride;
+        }
+        TexDesc.Format = CompressedFormat;
+    }
+
     TextureData TexData;
     TexData.pSubResources   = pSubResources.data();
     TexData.NumSubresources = TexDesc.MipLevels;
@@ -297,7 +281,7 @@ void CreateTextureFromDDS(IDataBlob*             pDDSData,
                           ITexture**             ppTexture)
 {
     CreateDDSTextureFromMemoryEx(pDevice,
-                                 reinterpret_cast<const Uint8*>(pDDSData->GetDataPtr()),
+                                 reinterpret_cast<const Uint8*>(pDDSData->GetConstDataPtr()),
                                  static_cast<size_t>(pDDSData->GetSize()),
                                  0, // maxSize
                                  TexLoadInfo.Usage,
@@ -309,6 +293,88 @@ void CreateTextureFromDDS(IDataBlob*             pDDSData,
                                  ppTexture);
 }
 
+void ComputeMipLevel(Uint32         FineLevelWidth,
+                     Uint32         FineLevelHeight,
+                     TEXTURE_FORMAT Fmt,
+                     const void*    pFineLevelData,
+                     Uint32         FineDataStride,
+                     void*          pCoarseLevelData,
+                     Uint32         CoarseDataStride)
+{
+    const auto& FmtAttribs = GetTextureFormatAttribs(Fmt);
+
+    const auto NumChannels = Uint32{FmtAttribs.NumComponents};
+    const bool IsSRGB      = FmtAttribs.ComponentType == COMPONENT_TYPE_UNORM_SRGB;
+    if ((FmtAttribs.ComponentType != COMPONENT_TYPE_UNORM && !IsSRGB) || NumChannels == 3 || FmtAttribs.IsTypeless)
+    {
+        LOG_ERROR_MESSAGE("Unable to compute mip level for format ", FmtAttribs.Name, ": only 8- and 16-bit UNORM formats with 1, 2 or 4 components are supported");
+        return;
+    }
+
+    const auto CoarseLevelWidth  = std::max(FineLevelWidth / 2u, 1u);
+    const auto CoarseLevelHeight = std::max(FineLevelHeight / 2u, 1u);
+    if (FmtAttribs.ComponentSize != 1 && FmtAttribs.ComponentSize != 2)
+    {
+        LOG_ERROR_MESSAGE("Unable to compute mip level for format ", FmtAttribs.Name, ": unsupported component size");
+        return;
+    }
+
+    ComputeCoarseMip(NumChannels, FmtAttribs.ComponentSize, IsSRGB,
+                     pFineLevelData, FineDataStride, FineLevelWidth, FineLevelHeight,
+                     pCoarseLevelData, CoarseDataStride, CoarseLevelWidth, CoarseLevelHeight);
+}
+
+TEXTURE_FORMAT GetCompressedTextureFormat(TEXTURE_LOAD_COMPRESS_MODE Mode,
+                                          Bool                       HasAlpha,
+                                          Bool                       IsSRGB)
+{
+    switch (Mode)
+    {
+        case TEXTURE_LOAD_COMPRESS_MODE_NONE:
+            return TEX_FORMAT_UNKNOWN;
+
+        case TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR:
+            if (HasAlpha)
+                return IsSRGB ? TEX_FORMAT_BC3_UNORM_SRGB : TEX_FORMAT_BC3_UNORM;
+            else
+                return IsSRGB ? TEX_FORMAT_BC1_UNORM_SRGB : TEX_FORMAT_BC1_UNORM;
+
+        case TEXTURE_LOAD_COMPRESS_MODE_BC_COLOR_HQ:
+            return IsSRGB ? TEX_FORMAT_BC7_UNORM_SRGB : TEX_FORMAT_BC7_UNORM;
+
+        case TEXTURE_LOAD_COMPRESS_MODE_BC_NORMAL:
+            return TEX_FORMAT_BC5_UNORM;
+
+        case TEXTURE_LOAD_COMPRESS_MODE_BC_SINGLE_CHANNEL:
+            return TEX_FORMAT_BC4_UNORM;
+
+        default:
+            UNEXPECTED("Unexpected texture compression mode");
+            return TEX_FORMAT_UNKNOWN;
+    }
+}
+
+void CompressMipLevel(Uint32         Width,
+                      Uint32         Height,
+                      TEXTURE_FORMAT SrcFmt,
+                      const void*    pSrcLevelData,
+                      Uint32         SrcDataStride,
+                      TEXTURE_FORMAT DstFmt,
+                      void*          pDstLevelData,
+                      Uint32         DstDataStride)
+{
+    const auto& SrcFmtAttribs = GetTextureFormatAttribs(SrcFmt);
+    if ((SrcFmtAttribs.ComponentType != COMPONENT_TYPE_UNORM && SrcFmtAttribs.ComponentType != COMPONENT_TYPE_UNORM_SRGB) ||
+        SrcFmtAttribs.ComponentSize != 1 || SrcFmtAttribs.NumComponents == 3 || SrcFmtAttribs.IsTypeless)
+    {
+        LOG_ERROR_MESSAGE("Unable to compress mip level of format ", SrcFmtAttribs.Name, ": only 8-bit UNORM formats with 1, 2 or 4 components are supported");
+        return;
+    }
+
+    CompressBlocks(Width, Height, static_cast<const Uint8*>(pSrcLevelData), SrcDataStride, SrcFmtAttribs.NumComponents,
+                   DstFmt, static_cast<Uint8*>(pDstLevelData), DstDataStride);
+}
+
 DECODE_PNG_RESULT DecodePng(IDataBlob* pSrcPngBits,
                             IDataBlob* pDstPixels,
                             ImageDesc* pDstImgDesc)
@@ -329,9 +395,10 @@ ENCODE_PNG_RESULT EncodePng(const Uint8* pSrcPixels,
 
 DECODE_JPEG_RESULT DecodeJpeg(IDataBlob* pSrcJpegBits,
                               IDataBlob* pDstPixels,
-                              ImageDesc* pDstImgDesc)
+                              ImageDesc* pDstImgDesc,
+                              Uint32     DownscaleFactor)
 {
-    return Diligent_DecodeJpeg(pSrcJpegBits, pDstPixels, pDstImgDesc);
+    return Diligent_DecodeJpeg(pSrcJpegBits, pDstPixels, pDstImgDesc, DownscaleFactor);
 }
 
 ENCODE_JPEG_RESULT EncodeJpeg(Uint8*     pSrcRGBPixels,
@@ -363,4 +430,34 @@ extern "C"
     {
         Diligent::CreateTextureFromDDS(pDDSData, TexLoadInfo, pDevice, ppTexture);
     }
+
+    void Diligent_ComputeMipLevel(Diligent::Uint32         FineLevelWidth,
+                                  Diligent::Uint32         FineLevelHeight,
+                                  Diligent::TEXTURE_FORMAT Fmt,
+                                  const void*              pFineLevelData,
+                                  Diligent::Uint32         FineDataStride,
+                                  void*                    pCoarseLevelData,
+                                  Diligent::Uint32         CoarseDataStride)
+    {
+        Diligent::ComputeMipLevel(FineLevelWidth, FineLevelHeight, Fmt, pFineLevelData, FineDataStride, pCoarseLevelData, CoarseDataStride);
+    }
+
+    Diligent::TEXTURE_FORMAT Diligent_GetCompressedTextureFormat(Diligent::TEXTURE_LOAD_COMPRESS_MODE Mode,
+                                                                 Diligent::Bool                       HasAlpha,
+                                                                 Diligent::Bool                       IsSRGB)
+    {
+        return Diligent::GetCompressedTextureFormat(Mode, HasAlpha, IsSRGB);
+    }
+
+    void Diligent_CompressMipLevel(Diligent::Uint32         Width,
+                                   Diligent::Uint32         Height,
+                                   Diligent::TEXTURE_FORMAT SrcFmt,
+                                   const void*              pSrcLevelData,
+                                   Diligent::Uint32         SrcDataStride,
+                                   Diligent::TEXTURE_FORMAT DstFmt,
+                                   void*                    pDstLevelData,
+                                   Diligent::Uint32         DstDataStride)
+    {
+        Diligent::CompressMipLevel(Width, Height, SrcFmt, pSrcLevelData, SrcDataStride, DstFmt, pDstLevelData, DstDataStride);
+    }
 }
\ No newline at end of file
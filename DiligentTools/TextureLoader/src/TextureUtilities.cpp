@@ -32,6 +32,8 @@
 #include "Image.h"
 #include "RefCntAutoPtr.hpp"
 #include "DataBlobImpl.hpp"
+#include "BasicFileStream.hpp"
+#include "DDSLoader.h"
 
 namespace Diligent
 {
@@ -59,6 +61,20 @@ void CreateTextureFromFile(const Char*            FilePath,
     }
 }
 
+bool SaveTextureAsDDS(const Char*        FilePath,
+                      const TextureDesc& TexDesc,
+                      const TextureData& TexData)
+{
+    RefCntAutoPtr<BasicFileStream> pFileStream(MakeNewRCObj<BasicFileStream>()(FilePath, EFileAccessMode::Overwrite));
+    if (!pFileStream->IsValid())
+    {
+        LOG_ERROR_MESSAGE("Failed to open file \"", FilePath, "\" for writing");
+        return false;
+    }
+
+    return SaveDDSTextureToStream(pFileStream, TexDesc, TexData);
+}
+
 } // namespace Diligent
 
 extern "C"
@@ -70,4 +86,11 @@ extern "C"
     {
         Diligent::CreateTextureFromFile(FilePath, TexLoadInfo, pDevice, ppTexture);
     }
+
+    Diligent::Bool Diligent_SaveTextureAsDDS(const Diligent::Char*        FilePath,
+                                             const Diligent::TextureDesc& TexDesc,
+                                             const Diligent::TextureData& TexData)
+    {
+        return Diligent::SaveTextureAsDDS(FilePath, TexDesc, TexData);
+    }
 }
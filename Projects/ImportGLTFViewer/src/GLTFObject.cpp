@@ -73,6 +73,7 @@ void GLTFObject::LoadModel(const char* Path)
 {
     if (m_Model)
     {
+        m_ModelInstance.reset();
         m_GLTFRenderer->ReleaseResourceBindings(*m_Model);
         m_PlayAnimation  = false;
         m_AnimationIndex = 0;
@@ -80,6 +81,7 @@ void GLTFObject::LoadModel(const char* Path)
     }
 
     m_Model.reset(new GLTF::Model(m_pDevice, m_pImmediateContext, Path));
+    m_ModelInstance.reset(new GLTF::ModelInstance(*m_Model));
     m_GLTFRenderer->InitializeResourceBindings(*m_Model, m_VertexBuffer, m_VSConstants);
 
     // Center and scale model
@@ -272,7 +274,7 @@ void GLTFObject::RenderActor(const Camera& camera, bool IsShadowPass)
         CamAttribs->f4Position    = float4(CameraWorldPos, 1);
     }
 
-    m_GLTFRenderer->Render(m_pImmediateContext, *m_Model, m_RenderParams);
+    m_GLTFRenderer->Render(m_pImmediateContext, *m_ModelInstance, m_RenderParams);
 
     if (m_BackgroundMode != BackgroundMode::None)
     {
@@ -303,7 +305,7 @@ void GLTFObject::UpdateActor(double CurrTime, double ElapsedTime)
         float& AnimationTimer = m_AnimationTimers[m_AnimationIndex];
         AnimationTimer += static_cast<float>(ElapsedTime);
         AnimationTimer = std::fmod(AnimationTimer, m_Model->Animations[m_AnimationIndex].End);
-        m_Model->UpdateAnimation(m_AnimationIndex, AnimationTimer);
+        m_ModelInstance->UpdateAnimation(m_AnimationIndex, AnimationTimer);
     }
 }
 
@@ -72,6 +72,7 @@ GLTFObject::GLTFObject(const SampleInitInfo& InitInfo, RefCntAutoPtr<IRenderPass
 GLTFObject::~GLTFObject()
 {
     m_GLTFRenderer.reset();
+    m_ModelInstance.reset();
     m_Model.reset();
 }
 
@@ -79,6 +80,7 @@ void GLTFObject::LoadModel(const char* Path)
 {
     if (m_Model)
     {
+        m_ModelInstance.reset();
         m_GLTFRenderer->ReleaseResourceBindings(*m_Model);
         m_PlayAnimation  = false;
         m_AnimationIndex = 0;
@@ -86,6 +88,7 @@ void GLTFObject::LoadModel(const char* Path)
     }
 
     m_Model.reset(new GLTF::Model(m_pDevice, m_pImmediateContext, Path));
+    m_ModelInstance.reset(new GLTF::ModelInstance(*m_Model));
     m_GLTFRenderer->InitializeResourceBindings(*m_Model, m_VertexBuffer, m_VSConstants);
 
     // Center and scale model
@@ -165,6 +168,7 @@ void GLTFObject::RenderActor(const Camera& camera, bool IsShadowPass)
         auto CameraViewProj = CameraView * Proj;
 
         m_RenderParams.ModelTransform = m_WorldMatrix;
+        m_RenderParams.ViewProj       = CameraViewProj;
 
         {
             MapHelper<CameraAttribs> CamAttribs(m_pImmediateContext, m_VertexBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
@@ -174,7 +178,7 @@ void GLTFObject::RenderActor(const Camera& camera, bool IsShadowPass)
             CamAttribs->f4Position    = float4(CameraWorldPos, 1);
         }
 
-        m_GLTFRenderer->Render(m_pImmediateContext, *m_Model, m_RenderParams);
+        m_GLTFRenderer->Render(m_pImmediateContext, *m_ModelInstance, m_RenderParams);
     }
 }
 
@@ -187,7 +191,7 @@ void GLTFObject::UpdateActor(double CurrTime, double ElapsedTime)
         float& AnimationTimer = m_AnimationTimers[m_AnimationIndex];
         AnimationTimer += static_cast<float>(ElapsedTime);
         AnimationTimer = std::fmod(AnimationTimer, m_Model->Animations[m_AnimationIndex].End);
-        m_Model->UpdateAnimation(m_AnimationIndex, AnimationTimer);
+        m_ModelInstance->UpdateAnimation(m_AnimationIndex, AnimationTimer);
     }
 }
 
@@ -45,6 +45,7 @@ private:
 
     std::unique_ptr<GLTF_PBR_Renderer>    m_GLTFRenderer;
     std::unique_ptr<GLTF::Model>          m_Model;
+    std::unique_ptr<GLTF::ModelInstance>  m_ModelInstance;
 
     MouseState m_LastMouseState;
 };
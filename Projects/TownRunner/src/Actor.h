@@ -29,6 +29,7 @@
 
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "AdvancedMath.hpp"
 #include "Camera.h"
 #include "EnvMap.h"
 #include <vector>
@@ -84,6 +85,14 @@ public:
 
     void            Render() override final {};
     virtual void    RenderActor(const Camera& camera, bool IsShadowPass){};
+    // Renders the actor's occluders to the depth buffer before the G-buffer pass
+    virtual void    RenderActorDepth(const Camera& camera){};
+    // Renders the actor to a shadow map cascade outside of the render pass
+    virtual void    RenderActorShadow(const float4x4& LightViewProj){};
+    // Returns false if the actor does not cast shadows
+    virtual bool    GetShadowCasterBounds(BoundBox& Bounds) { return false; }
+    // Requests the texture resolution the actor needs for the camera, see GLTF::TextureStreamer
+    virtual void    RequestTextures(const Camera& camera) {}
     void            Update(double CurrTime, double ElapsedTime) override final;
     virtual void    UpdateActor(double CurrTime, double ElapsedTime) {}
     void            updateComponents(double CurrTime, double ElapsedTime);
@@ -26,8 +26,10 @@
  */
 
 #include <cmath>
+#include <cfloat>
 #include <array>
 #include "GLTFObject.h"
+#include "ShadowCascades.h"
 #include "MapHelper.hpp"
 #include "BasicMath.hpp"
 #include "GraphicsUtilities.h"
@@ -35,6 +37,9 @@
 #include "CommonlyUsedStates.h"
 #include "ShaderMacroHelper.hpp"
 #include "FileSystem.hpp"
+#include "BasicFileStream.hpp"
+#include "DataBlobImpl.hpp"
+#include "HashUtils.hpp"
 #include "imgui.h"
 #include "imGuIZMO.h"
 
@@ -59,6 +64,21 @@ struct EnvMapRenderAttribs
 
 } // namespace
 
+GLTF_AnimationBatch*   GLTFObject::s_pAnimationBatch   = nullptr;
+GLTF_ComputeSkinning*  GLTFObject::s_pComputeSkinning  = nullptr;
+ShadowCascades*        GLTFObject::s_pShadowCascades   = nullptr;
+GLTF::TextureStreamer* GLTFObject::s_pTextureStreamer  = nullptr;
+ImageDecodeQueue*      GLTFObject::s_pImageDecodeQueue = nullptr;
+
+GLTF::Model::MeshCacheType* GLTFObject::s_pMeshCache = nullptr;
+
+RefCntWeakPtr<ITextureView> GLTFObject::s_pEnvMapSRV;
+RefCntWeakPtr<ITextureView> GLTFObject::s_pIrradianceCubeSRV;
+RefCntWeakPtr<ITextureView> GLTFObject::s_pPrefilteredEnvMapSRV;
+
+GLTF::Model::TextureCompressionSettings GLTFObject::s_TextureCompression;
+GLTF::Model::TextureAtlasSettings       GLTFObject::s_TextureAtlas;
+
 GLTFObject::GLTFObject()
 {
     _actorType = ActorType::GLTFObject;
@@ -74,14 +94,30 @@ void GLTFObject::LoadModel(const char* Path)
 {
     if (m_Model)
     {
+        m_SkinnedVertices = {};
+        m_ModelInstance.reset();
         m_GLTFRenderer->ReleaseResourceBindings(*m_Model);
         m_PlayAnimation  = false;
         m_AnimationIndex = 0;
         m_AnimationTimers.clear();
     }
 
-    m_Model.reset(new GLTF::Model(m_pDevice, m_pImmediateContext, Path));
+    GLTF::Model::CreateInfo ModelCI{Path};
+    ModelCI.pMeshCache                           = s_pMeshCache;
+    ModelCI.MeshOptimization.WeldVertices        = true;
+    ModelCI.MeshOptimization.OptimizeVertexCache = true;
+    ModelCI.MeshOptimization.OptimizeVertexFetch = true;
+    ModelCI.MeshOptimization.NumLODs             = 3;
+    ModelCI.pTextureStreamer                     = s_pTextureStreamer;
+    ModelCI.TextureCompression                   = s_TextureCompression;
+    ModelCI.TextureAtlas                         = s_TextureAtlas;
+    ModelCI.pImageDecodeQueue                    = s_pImageDecodeQueue;
+    m_Model.reset(new GLTF::Model(m_pDevice, m_pImmediateContext, ModelCI));
+    m_ModelInstance.reset(new GLTF::ModelInstance(*m_Model));
+    if (s_pAnimationBatch != nullptr && s_pComputeSkinning != nullptr && GLTF_AnimationBatch::GetModelJointCount(*m_Model) != 0)
+        m_SkinnedVertices = s_pComputeSkinning->CreateSkinnedVertices(m_pImmediateContext, *m_Model);
     m_GLTFRenderer->InitializeResourceBindings(*m_Model, m_VertexBuffer, m_VSConstants);
+    m_BoundTexturesVersion = m_Model->TexturesVersion;
 
     // Center and scale model
     float3 ModelDim{m_Model->AABBTransform[0][0], m_Model->AABBTransform[1][1], m_Model->AABBTransform[2][2]};
@@ -108,20 +144,32 @@ void GLTFObject::Initialize(const SampleInitInfo& InitInfo, RefCntAutoPtr<IRende
 
     m_pRenderPass = RenderPass;
 
-    RefCntAutoPtr<ITexture> EnvironmentMap;
-    CreateTextureFromFile("textures/papermill.ktx", TextureLoadInfo{"Environment map"}, m_pDevice, &EnvironmentMap);
-    m_TextureSRV = EnvironmentMap->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
-
     auto BackBufferFmt  = m_pSwapChain->GetDesc().ColorBufferFormat;
     auto DepthBufferFmt = m_pSwapChain->GetDesc().DepthBufferFormat;
 
     GLTF_PBR_Renderer::CreateInfo RendererCI;
-    RendererCI.RTVFmt         = BackBufferFmt;
-    RendererCI.DSVFmt         = DepthBufferFmt;
-    RendererCI.AllowDebugView = true;
-    RendererCI.UseIBL         = true;
-    RendererCI.FrontCCW       = true;
+    RendererCI.RTVFmt          = BackBufferFmt;
+    RendererCI.DSVFmt          = DepthBufferFmt;
+    RendererCI.AllowDebugView  = true;
+    RendererCI.UseIBL          = true;
+    RendererCI.FrontCCW        = true;
+    RendererCI.UseJointsBuffer = s_pAnimationBatch != nullptr;
+    // Falls back to per-material SRBs if the device does not support bindless resources
+    RendererCI.UseBindlessMaterials = true;
+    if (s_pShadowCascades != nullptr)
+    {
+        const auto& ShadowSettings  = s_pShadowCascades->GetSettings();
+        RendererCI.ShadowMapFmt     = ShadowSettings.Format;
+        RendererCI.UseShadows       = true;
+        RendererCI.ShadowFilterSize = ShadowSettings.FilterSize;
+    }
+
+    RendererCI.IBLCacheDirectory = "IBLCache";
     m_GLTFRenderer.reset(new GLTF_PBR_Renderer(m_pDevice, m_pImmediateContext, RendererCI, m_pRenderPass));
+    if (s_pAnimationBatch != nullptr)
+        m_GLTFRenderer->SetJointsBuffer(s_pAnimationBatch->GetJointsBufferSRV());
+    if (s_pShadowCascades != nullptr)
+        m_GLTFRenderer->SetShadowMap(s_pShadowCascades->GetSRV());
 
     CreateUniformBuffer(m_pDevice, sizeof(CameraAttribs), "Camera attribs buffer", &m_VertexBuffer);
     CreateUniformBuffer(m_pDevice, sizeof(LightAttribs), "Light attribs buffer", &m_VSConstants);
@@ -131,55 +179,198 @@ void GLTFObject::Initialize(const SampleInitInfo& InitInfo, RefCntAutoPtr<IRende
     {
         {m_VertexBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true},
         {m_VSConstants,  RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true},
-        {m_IndexBuffer,  RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true},
-        {EnvironmentMap, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true}
+        {m_IndexBuffer,  RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, true}
     };
     // clang-format on
     m_pImmediateContext->TransitionResourceStates(_countof(Barriers), Barriers);
 
-    m_GLTFRenderer->PrecomputeCubemaps(m_pDevice, m_pImmediateContext, m_TextureSRV);
+    InitializeIBL();
 
     m_LightDirection = normalize(float3(0.5f, -0.6f, -0.2f));
 }
 
+void GLTFObject::InitializeIBL()
+{
+    // All objects use the same environment map, so it is loaded and the IBL cubemaps are
+    // computed by the first object only. The other objects reuse them while any object is alive.
+    m_TextureSRV = s_pEnvMapSRV.Lock();
+
+    RefCntAutoPtr<ITextureView> pIrradianceCubeSRV    = s_pIrradianceCubeSRV.Lock();
+    RefCntAutoPtr<ITextureView> pPrefilteredEnvMapSRV = s_pPrefilteredEnvMapSRV.Lock();
+    if (m_TextureSRV && pIrradianceCubeSRV && pPrefilteredEnvMapSRV)
+    {
+        m_GLTFRenderer->SetIBLCubemaps(pIrradianceCubeSRV, pPrefilteredEnvMapSRV);
+        return;
+    }
+
+    // The hash of the file contents identifies the environment map in the IBL cache
+    RefCntAutoPtr<IDataBlob> pEnvMapData{MakeNewRCObj<DataBlobImpl>()(0)};
+    {
+        RefCntAutoPtr<BasicFileStream> pEnvMapFile{MakeNewRCObj<BasicFileStream>()("textures/papermill.ktx", EFileAccessMode::Read)};
+        pEnvMapFile->ReadBlob(pEnvMapData);
+    }
+    const auto EnvMapHash = ComputeHashRaw(pEnvMapData->GetDataPtr(), pEnvMapData->GetSize());
+
+    RefCntAutoPtr<ITexture> EnvironmentMap;
+    CreateTextureFromKTX(pEnvMapData, TextureLoadInfo{"Environment map"}, m_pDevice, &EnvironmentMap);
+    m_TextureSRV = EnvironmentMap->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+
+    StateTransitionDesc Barrier{EnvironmentMap, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true};
+    m_pImmediateContext->TransitionResourceStates(1, &Barrier);
+
+    m_GLTFRenderer->PrecomputeCubemaps(m_pDevice, m_pImmediateContext, m_TextureSRV, EnvMapHash);
+
+    s_pEnvMapSRV            = m_TextureSRV;
+    s_pIrradianceCubeSRV    = m_GLTFRenderer->GetIrradianceCubeSRV();
+    s_pPrefilteredEnvMapSRV = m_GLTFRenderer->GetPrefilteredEnvMapSRV();
+}
+
 void GLTFObject::setObjectPath(const char* pathP)
 {
     path = pathP;
     LoadModel(path);
 }
 
-// Render a frame
-void GLTFObject::RenderActor(const Camera& camera, bool IsShadowPass)
+void GLTFObject::UpdateRenderParams(const Camera& camera)
+{
+    // Get pretransform matrix that rotates the scene according the surface orientation
+    auto SrfPreTransform = GetSurfacePretransformMatrix(float3{0, 0, 1});
+
+    const auto  CameraView = camera.m_ViewMatrix * SrfPreTransform;
+    const auto& Proj       = GetAdjustedProjectionMatrix(PI_F / 4.0f, 0.1f, 100.f);
+
+    UpdateRenderParams(CameraView * Proj);
+}
+
+void GLTFObject::UpdateRenderParams(const float4x4& ViewProj)
+{
+    m_RenderParams.ModelTransform = m_WorldMatrix;
+    if (s_pAnimationBatch != nullptr && m_ModelInstance)
+        m_RenderParams.FirstJoint = s_pAnimationBatch->GetFirstJoint(*m_ModelInstance);
+    m_RenderParams.pSkinnedVertexBuffer = m_SkinnedVertices.pVertexBuffer;
+    m_RenderParams.ViewProj             = ViewProj;
+    // About two pixels at the current resolution
+    m_RenderParams.MaxLODScreenError = 2.f / static_cast<float>(std::max(m_pSwapChain->GetDesc().Height, 1u));
+}
+
+void GLTFObject::UpdateCameraAndLightAttribs(const Camera& camera)
 {
-    if (state == ActorState::Active)
     {
+        MapHelper<LightAttribs> lightAttribs(m_pImmediateContext, m_VSConstants, MAP_WRITE, MAP_FLAG_DISCARD);
+        if (s_pShadowCascades != nullptr)
+        {
+            lightAttribs->f4Direction   = s_pShadowCascades->GetLightDirection();
+            lightAttribs->ShadowAttribs = s_pShadowCascades->GetShadowAttribs();
+        }
+        else
         {
-            MapHelper<LightAttribs> lightAttribs(m_pImmediateContext, m_VSConstants, MAP_WRITE, MAP_FLAG_DISCARD);
             lightAttribs->f4Direction = m_LightDirection;
-            lightAttribs->f4Intensity = m_LightColor * m_LightIntensity;
         }
+        lightAttribs->f4Intensity = m_LightColor * m_LightIntensity;
+    }
 
-        // Get pretransform matrix that rotates the scene according the surface orientation
-        auto SrfPreTransform = GetSurfacePretransformMatrix(float3{0, 0, 1});
+    const auto& CameraWorld    = camera.GetWorldMatrix();
+    float3      CameraWorldPos = float3::MakeVector(CameraWorld[3]);
+    const auto& Proj           = GetAdjustedProjectionMatrix(PI_F / 4.0f, 0.1f, 100.f);
+    const auto& CameraViewProj = m_RenderParams.ViewProj;
 
-        const auto  CameraView     = camera.m_ViewMatrix * SrfPreTransform;
-        const auto& CameraWorld    = camera.GetWorldMatrix();
-        float3      CameraWorldPos = float3::MakeVector(CameraWorld[3]);
-        const auto& Proj           = GetAdjustedProjectionMatrix(PI_F / 4.0f, 0.1f, 100.f);
+    // Shadow cascades are selected by the view space depth
+    const auto CameraView = camera.m_ViewMatrix * GetSurfacePretransformMatrix(float3{0, 0, 1});
 
-        auto CameraViewProj = CameraView * Proj;
+    MapHelper<CameraAttribs> CamAttribs(m_pImmediateContext, m_VertexBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+    CamAttribs->mViewT        = CameraView.Transpose();
+    CamAttribs->mProjT        = Proj.Transpose();
+    CamAttribs->mViewProjT    = CameraViewProj.Transpose();
+    CamAttribs->mViewProjInvT = CameraViewProj.Inverse().Transpose();
+    CamAttribs->f4Position    = float4(CameraWorldPos, 1);
+}
 
-        m_RenderParams.ModelTransform = m_WorldMatrix;
+void GLTFObject::RenderActorDepth(const Camera& camera)
+{
+    if (state == ActorState::Active && !m_RenderedByStaticScene)
+    {
+        UpdateRenderParams(camera);
+        m_GLTFRenderer->RenderDepth(m_pImmediateContext, *m_ModelInstance, m_RenderParams);
+    }
+}
 
-        {
-            MapHelper<CameraAttribs> CamAttribs(m_pImmediateContext, m_VertexBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
-            CamAttribs->mProjT        = Proj.Transpose();
-            CamAttribs->mViewProjT    = CameraViewProj.Transpose();
-            CamAttribs->mViewProjInvT = CameraViewProj.Inverse().Transpose();
-            CamAttribs->f4Position    = float4(CameraWorldPos, 1);
-        }
+void GLTFObject::RenderActorShadow(const float4x4& LightViewProj)
+{
+    // Objects rendered by the static scene still cast shadows themselves
+    if (state == ActorState::Active)
+    {
+        UpdateRenderParams(LightViewProj);
+        m_GLTFRenderer->RenderDepth(m_pImmediateContext, *m_ModelInstance, m_RenderParams, true);
+    }
+}
+
+bool GLTFObject::GetShadowCasterBounds(BoundBox& Bounds)
+{
+    if (state != ActorState::Active || !m_Model)
+        return false;
+
+    // AABB transform maps the unit cube to the bounding box of the model
+    const auto ModelToWorld = m_Model->AABBTransform * m_WorldMatrix;
+
+    Bounds.Min = float3{+FLT_MAX, +FLT_MAX, +FLT_MAX};
+    Bounds.Max = float3{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    for (int i = 0; i < 8; ++i)
+    {
+        const float3 Corner{(i & 0x01) ? 1.f : 0.f, (i & 0x02) ? 1.f : 0.f, (i & 0x04) ? 1.f : 0.f};
+        const auto   WorldCorner = Corner * ModelToWorld;
+
+        Bounds.Min = std::min(Bounds.Min, WorldCorner);
+        Bounds.Max = std::max(Bounds.Max, WorldCorner);
+    }
+    return true;
+}
+
+void GLTFObject::RequestTextures(const Camera& camera)
+{
+    if (s_pTextureStreamer == nullptr || !m_Model)
+        return;
 
-        m_GLTFRenderer->Render(m_pImmediateContext, *m_Model, m_RenderParams);
+    // The streamer replaces textures of the model when it changes their resident mip levels.
+    // Bindings of the previous textures remain valid until they are released here.
+    if (m_BoundTexturesVersion != m_Model->TexturesVersion)
+    {
+        m_GLTFRenderer->ReleaseResourceBindings(*m_Model);
+        m_GLTFRenderer->InitializeResourceBindings(*m_Model, m_VertexBuffer, m_VSConstants);
+        m_BoundTexturesVersion = m_Model->TexturesVersion;
+    }
+
+    // Textures of the objects that are not visible are not requested and eventually lose their fine mip levels
+    BoundBox Bounds;
+    if (!GetShadowCasterBounds(Bounds))
+        return;
+
+    const auto  CameraView = camera.m_ViewMatrix * GetSurfacePretransformMatrix(float3{0, 0, 1});
+    const auto& Proj       = GetAdjustedProjectionMatrix(PI_F / 4.0f, 0.1f, 100.f);
+
+    ViewFrustum Frustum;
+    ExtractViewFrustumPlanesFromMatrix(CameraView * Proj, Frustum, m_pDevice->GetDeviceCaps().IsGLDevice());
+    if (GetBoxVisibility(Frustum, Bounds) == BoxVisibility::Invisible)
+        return;
+
+    // Projected size of the bounding sphere
+    const auto& CameraWorld = camera.GetWorldMatrix();
+    const auto  Center      = (Bounds.Min + Bounds.Max) * 0.5f;
+    const auto  Radius      = length(Bounds.Max - Bounds.Min) * 0.5f;
+    const auto  Distance    = length(Center - float3::MakeVector(CameraWorld[3]));
+    const auto  ScreenSize  = Radius * Proj._22 * static_cast<float>(m_pSwapChain->GetDesc().Height) / std::max(Distance, Radius);
+
+    s_pTextureStreamer->RequestModel(*m_Model, ScreenSize);
+}
+
+// Render a frame
+void GLTFObject::RenderActor(const Camera& camera, bool IsShadowPass)
+{
+    if (state == ActorState::Active && !m_RenderedByStaticScene)
+    {
+        UpdateRenderParams(camera);
+        UpdateCameraAndLightAttribs(camera);
+
+        m_GLTFRenderer->Render(m_pImmediateContext, *m_ModelInstance, m_RenderParams);
     }
 }
 
@@ -187,12 +378,31 @@ void GLTFObject::UpdateActor(double CurrTime, double ElapsedTime)
 {
     SampleBase::Update(CurrTime, ElapsedTime);
 
-    if (!m_Model->Animations.empty() && m_PlayAnimation)
+    const bool Animate        = !m_Model->Animations.empty() && m_PlayAnimation;
+    float      AnimationTimer = 0;
+    if (Animate)
+    {
+        auto& Timer = m_AnimationTimers[m_AnimationIndex];
+        Timer += static_cast<float>(ElapsedTime);
+        Timer          = std::fmod(Timer, m_Model->Animations[m_AnimationIndex].End);
+        AnimationTimer = Timer;
+    }
+
+    if (s_pAnimationBatch != nullptr)
+    {
+        // Skinned instances must be in the joints buffer every frame, otherwise they are
+        // rendered in the bind pose. Paused instances keep their current pose.
+        if (Animate)
+            s_pAnimationBatch->AddInstance(*m_ModelInstance, m_AnimationIndex, AnimationTimer);
+        else if (GLTF_AnimationBatch::GetModelJointCount(*m_Model) != 0)
+            s_pAnimationBatch->AddInstance(*m_ModelInstance);
+
+        if (m_SkinnedVertices.pVertexBuffer)
+            s_pComputeSkinning->AddInstance(*m_ModelInstance, m_SkinnedVertices);
+    }
+    else if (Animate)
     {
-        float& AnimationTimer = m_AnimationTimers[m_AnimationIndex];
-        AnimationTimer += static_cast<float>(ElapsedTime);
-        AnimationTimer = std::fmod(AnimationTimer, m_Model->Animations[m_AnimationIndex].End);
-        m_Model->UpdateAnimation(m_AnimationIndex, AnimationTimer);
+        m_ModelInstance->UpdateAnimation(m_AnimationIndex, AnimationTimer);
     }
 }
 
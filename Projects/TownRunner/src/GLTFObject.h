@@ -1,13 +1,19 @@
 #pragma once
 #include "Actor.h"
 #include "GLTFLoader.hpp"
+#include "GLTFTextureStreamer.hpp"
+#include "ImageDecodeQueue.hpp"
 #include "GLTF_PBR_Renderer.hpp"
+#include "GLTF_AnimationBatch.hpp"
+#include "GLTF_ComputeSkinning.hpp"
 #include "Camera.h"
 #include "EnvMap.h"
 
 namespace Diligent
 {
 
+class ShadowCascades;
+
 class GLTFObject : public Actor
 {
 public:
@@ -20,18 +26,78 @@ public:
 
     void RenderActor(const Camera& camera, bool IsShadowPass) override;
 
+    void RenderActorDepth(const Camera& camera) override;
+
+    void RenderActorShadow(const float4x4& LightViewProj) override;
+
+    bool GetShadowCasterBounds(BoundBox& Bounds) override;
+
+    void RequestTextures(const Camera& camera) override;
+
     void UpdateActor(double CurrTime, double ElapsedTime) override;
 
+    const GLTF::Model* GetModel() const { return m_Model.get(); }
+    const float4x4&    GetWorldMatrix() const { return m_WorldMatrix; }
+
+    // Objects that are rendered by a static scene (see StaticGeometry) skip their own draws
+    void SetRenderedByStaticScene(bool RenderedByStaticScene) { m_RenderedByStaticScene = RenderedByStaticScene; }
+
+    // When set, animations of all GLTF objects are evaluated together by the batch,
+    // and the renderers read joint matrices from the batch's joints buffer.
+    // Must be set before any GLTF object is initialized.
+    static void SetAnimationBatch(GLTF_AnimationBatch* pBatch) { s_pAnimationBatch = pBatch; }
+
+    // When set together with the animation batch, skinned models are skinned once
+    // per frame in a compute pre-pass. Must be set before any GLTF object is initialized.
+    static void SetComputeSkinning(GLTF_ComputeSkinning* pSkinning) { s_pComputeSkinning = pSkinning; }
+
+    // When set, the sun is shadowed by the cascades, and its direction is taken from them.
+    // Must be set before any GLTF object is initialized.
+    static void SetShadowCascades(ShadowCascades* pShadows) { s_pShadowCascades = pShadows; }
+
+    // When set, mip levels of the model textures are streamed by the streamer.
+    // Must be set before any GLTF object is initialized.
+    static void SetTextureStreamer(GLTF::TextureStreamer* pStreamer) { s_pTextureStreamer = pStreamer; }
+
+    // Block compression of the model textures. Compressed textures are cached on disk and are not streamed.
+    // Must be set before any GLTF object is initialized.
+    static void SetTextureCompression(const GLTF::Model::TextureCompressionSettings& Settings) { s_TextureCompression = Settings; }
+
+    // Packing of the small model textures into atlases, so that materials share resource bindings.
+    // Must be set before any GLTF object is initialized.
+    static void SetTextureAtlas(const GLTF::Model::TextureAtlasSettings& Settings) { s_TextureAtlas = Settings; }
+
+    // Queue that decodes the model images on worker threads. Shared by all objects so that
+    // every model does not start its own threads.
+    static void SetImageDecodeQueue(ImageDecodeQueue* pQueue) { s_pImageDecodeQueue = pQueue; }
+
+    // Cache of the optimized geometry shared by all objects that load the same model.
+    // Must be set before any GLTF object is initialized.
+    static void SetMeshCache(GLTF::Model::MeshCacheType* pCache) { s_pMeshCache = pCache; }
+
 protected:
     const char* path;
 
     BackgroundMode m_BackgroundMode = BackgroundMode::EnvironmentMap;
     RefCntAutoPtr<IRenderPass> m_pRenderPass;
 
+    // Sets up the render parameters for the camera. The depth pre-pass and the G-buffer pass
+    // must use the same parameters to produce identical depth values.
+    void UpdateRenderParams(const Camera& camera);
+    void UpdateRenderParams(const float4x4& ViewProj);
+
+    // Updates the camera and light constant buffers used by the renderer
+    void UpdateCameraAndLightAttribs(const Camera& camera);
+
+    GLTF_PBR_Renderer::RenderInfo m_RenderParams;
+
+    std::unique_ptr<GLTF_PBR_Renderer> m_GLTFRenderer;
+
 private:
     void LoadModel(const char* Path);
 
-    GLTF_PBR_Renderer::RenderInfo m_RenderParams;
+    // Loads the environment map and sets up the IBL cubemaps of the renderer
+    void InitializeIBL();
 
     float3 m_LightDirection;
     float4 m_LightColor     = float4(1, 1, 1, 1);
@@ -43,10 +109,34 @@ private:
     int                m_AnimationIndex = 0;
     std::vector<float> m_AnimationTimers;
 
-    std::unique_ptr<GLTF_PBR_Renderer>    m_GLTFRenderer;
     std::unique_ptr<GLTF::Model>          m_Model;
+    std::unique_ptr<GLTF::ModelInstance>  m_ModelInstance;
+
+    GLTF_ComputeSkinning::SkinnedVertices m_SkinnedVertices;
 
     MouseState m_LastMouseState;
+
+    bool m_RenderedByStaticScene = false;
+
+    // Version of the model textures the resource bindings were initialized with
+    Uint32 m_BoundTexturesVersion = 0;
+
+    static GLTF_AnimationBatch*   s_pAnimationBatch;
+    static GLTF_ComputeSkinning*  s_pComputeSkinning;
+    static ShadowCascades*        s_pShadowCascades;
+    static GLTF::TextureStreamer* s_pTextureStreamer;
+    static ImageDecodeQueue*      s_pImageDecodeQueue;
+
+    static GLTF::Model::MeshCacheType* s_pMeshCache;
+
+    // Environment map and IBL cubemaps shared by all objects. The objects hold strong
+    // references, so the textures are released together with the last object.
+    static RefCntWeakPtr<ITextureView> s_pEnvMapSRV;
+    static RefCntWeakPtr<ITextureView> s_pIrradianceCubeSRV;
+    static RefCntWeakPtr<ITextureView> s_pPrefilteredEnvMapSRV;
+
+    static GLTF::Model::TextureCompressionSettings s_TextureCompression;
+    static GLTF::Model::TextureAtlasSettings       s_TextureAtlas;
 };
 
 } // namespace Diligent
\ No newline at end of file
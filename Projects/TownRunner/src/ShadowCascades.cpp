@@ -0,0 +1,275 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include <cmath>
+
+#include "ShadowCascades.h"
+
+namespace Diligent
+{
+
+ShadowCascades::ShadowCascades(IRenderDevice* pDevice, const Settings& ShadowSettings) :
+    m_Settings{ShadowSettings},
+    m_pDevice{pDevice}
+{
+    VERIFY(m_Settings.CascadeSlack >= 1.f, "Cascade slack must not be less than 1");
+
+    ShadowMapManager::InitInfo SMMgrInitInfo;
+    SMMgrInitInfo.Format      = m_Settings.Format;
+    SMMgrInitInfo.Resolution  = m_Settings.Resolution;
+    SMMgrInitInfo.NumCascades = m_Settings.NumCascades;
+    SMMgrInitInfo.ShadowMode  = SHADOW_MODE_PCF;
+    m_ShadowMapMgr.Initialize(pDevice, SMMgrInitInfo);
+
+    m_ShadowAttribs.iFixedFilterSize = m_Settings.FilterSize;
+    if (m_Settings.Resolution >= 2048)
+        m_ShadowAttribs.fFixedDepthBias = 0.0025f;
+    else if (m_Settings.Resolution >= 1024)
+        m_ShadowAttribs.fFixedDepthBias = 0.005f;
+    else
+        m_ShadowAttribs.fFixedDepthBias = 0.0075f;
+
+    // The cache is only a copy source, so it is not bound as a shader resource
+    TextureDesc CacheDesc;
+    CacheDesc.Name      = "Static shadow casters cache";
+    CacheDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+    CacheDesc.Width     = m_Settings.Resolution;
+    CacheDesc.Height    = m_Settings.Resolution;
+    CacheDesc.MipLevels = 1;
+    CacheDesc.ArraySize = m_Settings.NumCascades;
+    CacheDesc.Format    = m_Settings.Format;
+    CacheDesc.BindFlags = BIND_DEPTH_STENCIL;
+    pDevice->CreateTexture(CacheDesc, nullptr, &m_pStaticCache);
+
+    m_Cascades.resize(m_Settings.NumCascades);
+    for (Uint32 i = 0; i < m_Settings.NumCascades; ++i)
+    {
+        TextureViewDesc DSVDesc;
+        DSVDesc.Name            = "Static shadow casters cache DSV";
+        DSVDesc.ViewType        = TEXTURE_VIEW_DEPTH_STENCIL;
+        DSVDesc.FirstArraySlice = i;
+        DSVDesc.NumArraySlices  = 1;
+        m_pStaticCache->CreateView(DSVDesc, &m_Cascades[i].pStaticCacheDSV);
+    }
+}
+
+void ShadowCascades::AddStaticCaster(Actor* pActor)
+{
+    if (m_StaticCasters.insert(pActor).second)
+        InvalidateStaticCasters();
+}
+
+void ShadowCascades::RemoveCaster(Actor* pActor)
+{
+    if (m_StaticCasters.erase(pActor) != 0)
+        InvalidateStaticCasters();
+}
+
+void ShadowCascades::InvalidateStaticCasters()
+{
+    for (auto& Cascade : m_Cascades)
+        Cascade.StaticCacheValid = false;
+}
+
+void ShadowCascades::InvalidateCascades()
+{
+    for (auto& Cascade : m_Cascades)
+    {
+        Cascade.IsPlaced         = false;
+        Cascade.StaticCacheValid = false;
+    }
+}
+
+void ShadowCascades::SetLightDirection(const float3& LightDir)
+{
+    const auto NewDirection = normalize(LightDir);
+    if (NewDirection != m_LightDirection)
+    {
+        // Light view space depends on the light direction only
+        m_LightDirection = NewDirection;
+        InvalidateCascades();
+    }
+}
+
+void ShadowCascades::Update(const float4x4& CameraView, const float4x4& CameraProj)
+{
+    // Stabilized cascade extents do not depend on the camera orientation, so that
+    // the cascades only have to be moved when the camera moves.
+    ShadowMapManager::DistributeCascadeInfo DistrInfo;
+    DistrInfo.pCameraView      = &CameraView;
+    DistrInfo.pCameraProj      = &CameraProj;
+    DistrInfo.pLightDir        = &m_LightDirection;
+    DistrInfo.SnapCascades     = true;
+    DistrInfo.StabilizeExtents = true;
+    m_ShadowMapMgr.DistributeCascades(DistrInfo, m_ShadowAttribs);
+
+    const auto& DevCaps    = m_pDevice->GetDeviceCaps();
+    const auto& NDCAttribs = DevCaps.GetNDCAttribs();
+    const float MinNDCZ    = DevCaps.IsGLDevice() ? -1.f : 0.f;
+    const float Resolution = static_cast<float>(m_Settings.Resolution);
+
+    const auto     WorldToLightViewSpace = m_ShadowAttribs.mWorldToLightViewT.Transpose();
+    const float4x4 ProjToUVScale         = float4x4::Scale(0.5f, NDCAttribs.YtoVScale, NDCAttribs.ZtoDepthScale);
+    const float4x4 ProjToUVBias          = float4x4::Translation(0.5f, 0.5f, NDCAttribs.GetZtoDepthBias());
+
+    for (Uint32 i = 0; i < m_Settings.NumCascades; ++i)
+    {
+        auto& CascadeAttribs = m_ShadowAttribs.Cascades[i];
+        auto& Cascade        = m_Cascades[i];
+
+        // Light view space box that the shadow map manager has fit to the camera frustum slice
+        const auto   Scale = float3::MakeVector(CascadeAttribs.f4LightSpaceScale);
+        const auto   Bias  = float3::MakeVector(CascadeAttribs.f4LightSpaceScaledBias);
+        const float3 Min   = (float3{-1, -1, MinNDCZ} - Bias) / Scale;
+        const float3 Max   = (float3{+1, +1, +1} - Bias) / Scale;
+
+        const bool IsInside =
+            Min.x >= Cascade.Min.x && Min.y >= Cascade.Min.y && Min.z >= Cascade.Min.z &&
+            Max.x <= Cascade.Max.x && Max.y <= Cascade.Max.y && Max.z <= Cascade.Max.z;
+        if (!Cascade.IsPlaced || !IsInside)
+        {
+            // Enlarge the box to let the camera move within the cascade and align it with the texels
+            const float3 Extent     = (Max - Min) * m_Settings.CascadeSlack;
+            float3       Center     = (Max + Min) * 0.5f;
+            const float  TexelXSize = Extent.x / Resolution;
+            const float  TexelYSize = Extent.y / Resolution;
+            Center.x                = std::round(Center.x / TexelXSize) * TexelXSize;
+            Center.y                = std::round(Center.y / TexelYSize) * TexelYSize;
+
+            Cascade.Min              = Center - Extent * 0.5f;
+            Cascade.Max              = Center + Extent * 0.5f;
+            Cascade.IsPlaced         = true;
+            Cascade.StaticCacheValid = false;
+        }
+
+        // Margins are defined in texels and are not affected by the enlargement
+        const float3 Extent = Cascade.Max - Cascade.Min;
+
+        CascadeAttribs.f4LightSpaceScale.x = 2.f / Extent.x;
+        CascadeAttribs.f4LightSpaceScale.y = 2.f / Extent.y;
+        CascadeAttribs.f4LightSpaceScale.z = (1.f - MinNDCZ) / Extent.z;
+
+        CascadeAttribs.f4LightSpaceScaledBias.x = -Cascade.Min.x * CascadeAttribs.f4LightSpaceScale.x - 1.f;
+        CascadeAttribs.f4LightSpaceScaledBias.y = -Cascade.Min.y * CascadeAttribs.f4LightSpaceScale.y - 1.f;
+        CascadeAttribs.f4LightSpaceScaledBias.z = -Cascade.Min.z * CascadeAttribs.f4LightSpaceScale.z + MinNDCZ;
+
+        const auto CascadeProj =
+            float4x4::Scale(CascadeAttribs.f4LightSpaceScale.x, CascadeAttribs.f4LightSpaceScale.y, CascadeAttribs.f4LightSpaceScale.z) *
+            float4x4::Translation(CascadeAttribs.f4LightSpaceScaledBias.x, CascadeAttribs.f4LightSpaceScaledBias.y, CascadeAttribs.f4LightSpaceScaledBias.z);
+
+        Cascade.WorldToLightProjSpace                = WorldToLightViewSpace * CascadeProj;
+        m_ShadowAttribs.mWorldToShadowMapUVDepthT[i] = (Cascade.WorldToLightProjSpace * ProjToUVScale * ProjToUVBias).Transpose();
+    }
+}
+
+void ShadowCascades::Render(IDeviceContext* pCtx, const std::vector<Actor*>& Actors)
+{
+    m_Stats = {};
+
+    const bool IsGL       = m_pDevice->GetDeviceCaps().IsGLDevice();
+    auto*      pShadowMap = m_ShadowMapMgr.GetSRV()->GetTexture();
+
+    m_DynamicCasters.clear();
+    for (auto* pActor : Actors)
+    {
+        Caster DynamicCaster{pActor, {}};
+        if (m_StaticCasters.find(pActor) == m_StaticCasters.end() && pActor->GetShadowCasterBounds(DynamicCaster.Bounds))
+            m_DynamicCasters.push_back(DynamicCaster);
+    }
+
+    for (Uint32 i = 0; i < m_Settings.NumCascades; ++i)
+    {
+        auto& Cascade = m_Cascades[i];
+
+        // Casters between the light and the cascade must not be culled as they may cast shadows into it
+        ViewFrustumExt Frustum;
+        ExtractViewFrustumPlanesFromMatrix(Cascade.WorldToLightProjSpace, Frustum, IsGL);
+        auto IsVisible = [&](const BoundBox& Bounds) {
+            return GetBoxVisibility(Frustum, Bounds, FRUSTUM_PLANE_FLAG_OPEN_NEAR) != BoxVisibility::Invisible;
+        };
+
+        if (!Cascade.StaticCacheValid)
+        {
+            pCtx->SetRenderTargets(0, nullptr, Cascade.pStaticCacheDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            pCtx->ClearDepthStencil(Cascade.pStaticCacheDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            for (auto* pActor : m_StaticCasters)
+            {
+                BoundBox Bounds;
+                if (!pActor->GetShadowCasterBounds(Bounds))
+                    continue;
+
+                if (IsVisible(Bounds))
+                {
+                    pActor->RenderActorShadow(Cascade.WorldToLightProjSpace);
+                    ++m_Stats.NumStaticCasterDraws;
+                }
+                else
+                {
+                    ++m_Stats.NumCulledCasters;
+                }
+            }
+            Cascade.StaticCacheValid     = true;
+            Cascade.HasStaticCastersOnly = false;
+            ++m_Stats.NumStaticCascadeUpdates;
+        }
+
+        m_VisibleCasters.clear();
+        for (const auto& DynamicCaster : m_DynamicCasters)
+        {
+            if (IsVisible(DynamicCaster.Bounds))
+                m_VisibleCasters.push_back(DynamicCaster.pActor);
+            else
+                ++m_Stats.NumCulledCasters;
+        }
+
+        // Nothing has changed since the cache was copied to the cascade
+        if (m_VisibleCasters.empty() && Cascade.HasStaticCastersOnly)
+            continue;
+
+        CopyTextureAttribs CopyAttribs{m_pStaticCache, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                       pShadowMap, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+        CopyAttribs.SrcSlice = i;
+        CopyAttribs.DstSlice = i;
+        pCtx->CopyTexture(CopyAttribs);
+        Cascade.HasStaticCastersOnly = m_VisibleCasters.empty();
+
+        if (!m_VisibleCasters.empty())
+        {
+            pCtx->SetRenderTargets(0, nullptr, m_ShadowMapMgr.GetCascadeDSV(i), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            for (auto* pActor : m_VisibleCasters)
+                pActor->RenderActorShadow(Cascade.WorldToLightProjSpace);
+            m_Stats.NumDynamicCasterDraws += static_cast<Uint32>(m_VisibleCasters.size());
+        }
+    }
+
+    // The shadow map is read by the G-buffer pass
+    StateTransitionDesc Barrier{pShadowMap, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true};
+    pCtx->TransitionResourceStates(1, &Barrier);
+}
+
+} // namespace Diligent
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include <unordered_set>
+
+#include "Actor.h"
+#include "ShadowMapManager.hpp"
+#include "AdvancedMath.hpp"
+
+namespace Diligent
+{
+
+// Cascaded shadow map of the sun. Static casters, e.g. buildings, are rendered into a cache of
+// the cascades that is only updated when the sun or the static casters change, or when the camera
+// leaves the area covered by a cascade. Every frame, the cache is copied to the cascades and only
+// dynamic casters are rendered on top.
+class ShadowCascades
+{
+public:
+    struct Settings
+    {
+        // Resolution of one cascade
+        Uint32 Resolution = 2048;
+
+        Uint32 NumCascades = 4;
+
+        TEXTURE_FORMAT Format = TEX_FORMAT_D32_FLOAT;
+
+        // PCF kernel size (2, 3, 5 or 7), see GLTF_PBR_Renderer::CreateInfo::ShadowFilterSize
+        int FilterSize = 3;
+
+        // Cascades cover this much more than the camera frustum slices, so that the camera can
+        // move within a cascade without invalidating the cached static casters.
+        float CascadeSlack = 1.25f;
+    };
+
+    // Counters of the last Render() call
+    struct Statistics
+    {
+        Uint32 NumStaticCascadeUpdates = 0;
+        Uint32 NumStaticCasterDraws    = 0;
+        Uint32 NumDynamicCasterDraws   = 0;
+        Uint32 NumCulledCasters        = 0;
+    };
+
+    ShadowCascades(IRenderDevice* pDevice, const Settings& ShadowSettings);
+
+    // Static casters are only rendered when the cache is updated
+    void AddStaticCaster(Actor* pActor);
+
+    void RemoveCaster(Actor* pActor);
+
+    // Must be called when a static caster is moved
+    void InvalidateStaticCasters();
+
+    void          SetLightDirection(const float3& LightDir);
+    const float3& GetLightDirection() const { return m_LightDirection; }
+
+    // Places the cascades for the camera. The view matrix must include the surface pretransform.
+    void Update(const float4x4& CameraView, const float4x4& CameraProj);
+
+    // Renders the casters to the cascades and transitions the shadow map to the shader resource state.
+    // Actors that are not static casters are rendered as dynamic casters.
+    // Must be called outside of the render pass.
+    void Render(IDeviceContext* pCtx, const std::vector<Actor*>& Actors);
+
+    ITextureView*           GetSRV() { return m_ShadowMapMgr.GetSRV(); }
+    const ShadowMapAttribs& GetShadowAttribs() const { return m_ShadowAttribs; }
+    const Settings&         GetSettings() const { return m_Settings; }
+    const Statistics&       GetStatistics() const { return m_Stats; }
+
+private:
+    struct Cascade
+    {
+        // Light view space box covered by the cascade
+        float3 Min;
+        float3 Max;
+
+        float4x4 WorldToLightProjSpace;
+
+        bool IsPlaced         = false;
+        bool StaticCacheValid = false;
+        // Whether the cascade is an exact copy of the static cache
+        bool HasStaticCastersOnly = false;
+
+        RefCntAutoPtr<ITextureView> pStaticCacheDSV;
+    };
+
+    struct Caster
+    {
+        Actor*   pActor;
+        BoundBox Bounds;
+    };
+
+    void InvalidateCascades();
+
+    const Settings m_Settings;
+
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+
+    ShadowMapManager m_ShadowMapMgr;
+    ShadowMapAttribs m_ShadowAttribs;
+
+    RefCntAutoPtr<ITexture> m_pStaticCache;
+    std::vector<Cascade>    m_Cascades;
+
+    float3 m_LightDirection = float3{0, -1, 0};
+
+    std::unordered_set<Actor*> m_StaticCasters;
+    std::vector<Caster>        m_DynamicCasters;
+    std::vector<Actor*>        m_VisibleCasters;
+
+    Statistics m_Stats;
+};
+
+} // namespace Diligent
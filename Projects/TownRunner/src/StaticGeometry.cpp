@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+
+#include "StaticGeometry.h"
+
+namespace Diligent
+{
+
+StaticGeometry::StaticGeometry(const SampleInitInfo& InitInfo, RefCntAutoPtr<IRenderPass>& RenderPass)
+{
+    GLTFObject::Initialize(InitInfo, RenderPass);
+    _actorName = "StaticGeometry";
+
+    m_Scene.reset(new GLTF_StaticScene(m_pDevice));
+}
+
+StaticGeometry::~StaticGeometry()
+{
+    m_GLTFRenderer->ReleaseResourceBindings(*m_Scene);
+}
+
+void StaticGeometry::AddObject(GLTFObject* pObject)
+{
+    if (m_Scene->IsBuilt())
+    {
+        LOG_ERROR_MESSAGE("Objects can't be added to the static geometry after it has been built");
+        return;
+    }
+
+    pObject->SetRenderedByStaticScene(true);
+    m_Objects.push_back(pObject);
+}
+
+void StaticGeometry::Cull(const Camera& camera, const HiZPyramid* pHiZ)
+{
+    if (!m_Scene->IsBuilt())
+    {
+        // World transforms of the objects are known after the first update
+        for (auto* pObject : m_Objects)
+            m_Scene->AddInstance(*pObject->GetModel(), pObject->GetWorldMatrix());
+        m_Scene->Build(m_pImmediateContext);
+        m_GLTFRenderer->InitializeResourceBindings(*m_Scene, m_VertexBuffer, m_VSConstants);
+    }
+
+    // Textures of the models are replaced when the texture streamer changes their resident mip levels
+    Uint32 TexturesVersion = 0;
+    for (auto* pObject : m_Objects)
+        TexturesVersion += pObject->GetModel()->TexturesVersion;
+    if (TexturesVersion != m_BoundTexturesVersion)
+    {
+        m_GLTFRenderer->ReleaseResourceBindings(*m_Scene);
+        m_GLTFRenderer->InitializeResourceBindings(*m_Scene, m_VertexBuffer, m_VSConstants);
+        m_BoundTexturesVersion = TexturesVersion;
+    }
+
+    UpdateRenderParams(camera);
+    m_Scene->Cull(m_pImmediateContext, m_RenderParams.ViewProj, pHiZ);
+}
+
+void StaticGeometry::CullOccluded(HiZPyramid& HiZ)
+{
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+    if (!m_pOccluderDepth || m_pOccluderDepth->GetDesc().Width != SCDesc.Width || m_pOccluderDepth->GetDesc().Height != SCDesc.Height)
+    {
+        TextureDesc TexDesc;
+        TexDesc.Name      = "Static geometry occluder depth";
+        TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+        TexDesc.Width     = SCDesc.Width;
+        TexDesc.Height    = SCDesc.Height;
+        TexDesc.MipLevels = 1;
+        TexDesc.Format    = SCDesc.DepthBufferFormat;
+        TexDesc.BindFlags = BIND_DEPTH_STENCIL | BIND_SHADER_RESOURCE;
+
+        TexDesc.ClearValue.Format             = TexDesc.Format;
+        TexDesc.ClearValue.DepthStencil.Depth = 1.f;
+        m_pOccluderDepth.Release();
+        m_pDevice->CreateTexture(TexDesc, nullptr, &m_pOccluderDepth);
+    }
+
+    auto* pDSV = m_pOccluderDepth->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
+    m_pImmediateContext->SetRenderTargets(0, nullptr, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_GLTFRenderer->RenderStaticSceneDepth(m_pImmediateContext, *m_Scene, m_RenderParams, true);
+
+    HiZ.Build(m_pImmediateContext, m_pOccluderDepth->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE), m_RenderParams.ViewProj);
+    m_Scene->CullOccluded(m_pImmediateContext, HiZ);
+}
+
+void StaticGeometry::RenderActor(const Camera& camera, bool IsShadowPass)
+{
+    if (state == ActorState::Active && m_Scene->IsBuilt())
+    {
+        UpdateRenderParams(camera);
+        UpdateCameraAndLightAttribs(camera);
+
+        m_GLTFRenderer->RenderStaticScene(m_pImmediateContext, *m_Scene, m_RenderParams);
+    }
+}
+
+void StaticGeometry::RenderActorDepth(const Camera& camera)
+{
+    if (state == ActorState::Active && m_Scene->IsBuilt())
+    {
+        UpdateRenderParams(camera);
+        m_GLTFRenderer->RenderStaticSceneDepth(m_pImmediateContext, *m_Scene, m_RenderParams);
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "GLTFObject.h"
+#include "GLTF_StaticScene.hpp"
+#include "HiZPyramid.hpp"
+
+namespace Diligent
+{
+
+// Renders static GLTF objects, e.g. buildings, as one GPU-culled static scene.
+// The objects keep their components (physics, collisions), but are not drawn individually.
+class StaticGeometry : public GLTFObject
+{
+public:
+    StaticGeometry(const SampleInitInfo& InitInfo, RefCntAutoPtr<IRenderPass>& RenderPass);
+    ~StaticGeometry();
+
+    // Adds the object to the scene. Objects can only be added before the first Cull() call.
+    void AddObject(GLTFObject* pObject);
+
+    // Builds the scene on the first call and culls it for the camera. If the Hi-Z pyramid
+    // of the previous frame is given, hidden objects are culled as well, and CullOccluded()
+    // must be called next. Must be called outside of the render pass.
+    void Cull(const Camera& camera, const HiZPyramid* pHiZ);
+
+    // Rebuilds the pyramid from the depth of the objects that passed the last Cull() call and
+    // brings back the culled objects it does not hide. Dynamic actors are not rendered to the
+    // pyramid, so that they never hide the static geometry. Must be called outside of the render pass.
+    void CullOccluded(HiZPyramid& HiZ);
+
+    const GLTF_StaticScene::Statistics& GetStatistics() const { return m_Scene->GetStatistics(); }
+
+    void RenderActor(const Camera& camera, bool IsShadowPass) override;
+
+    // Renders the opaque objects that passed the last Cull() call to the depth buffer
+    void RenderActorDepth(const Camera& camera) override;
+
+    // The scene is static
+    void UpdateActor(double CurrTime, double ElapsedTime) override {}
+
+private:
+    std::unique_ptr<GLTF_StaticScene> m_Scene;
+    std::vector<GLTFObject*>          m_Objects;
+
+    // Sum of the texture versions of the models the bindings were initialized with
+    Uint32 m_BoundTexturesVersion = 0;
+
+    // Depth of the objects that passed the first occlusion culling pass
+    RefCntAutoPtr<ITexture> m_pOccluderDepth;
+};
+
+} // namespace Diligent
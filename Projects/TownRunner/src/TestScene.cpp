@@ -28,6 +28,8 @@
 #include <vector>
 
 #include <stdio.h>
+#include <cstring>
+#include <cstdlib>
 
 #include "TestScene.hpp"
 #include "MapHelper.hpp"
@@ -44,6 +46,8 @@
 #include "Plane.h"
 #include "Ray.h"
 #include "CollisionComponent.hpp"
+#include "imgui.h"
+#include "imGuIZMO.h"
 
 namespace Diligent
 {
@@ -54,15 +58,60 @@ namespace Diligent
     return new TestScene();
 }
 
+TestScene::~TestScene()
+{
+    //GLTF objects keep raw pointers to the systems owned by the scene, reset them so that
+    //objects created by another scene never see the destroyed ones
+    GLTFObject::SetAnimationBatch(nullptr);
+    GLTFObject::SetComputeSkinning(nullptr);
+    GLTFObject::SetShadowCascades(nullptr);
+    GLTFObject::SetTextureStreamer(nullptr);
+    GLTFObject::SetImageDecodeQueue(nullptr);
+    GLTFObject::SetMeshCache(nullptr);
+}
+
 void TestScene::GetEngineInitializationAttribs(RENDER_DEVICE_TYPE DeviceType, EngineCreateInfo& EngineCI, SwapChainDesc& SCDesc)
 {
     SampleBase::GetEngineInitializationAttribs(DeviceType, EngineCI, SCDesc);
 
     EngineCI.Features.DepthClamp = DEVICE_FEATURE_STATE_OPTIONAL;
+    // GLTF objects are rendered in bindless mode when the feature is available
+    EngineCI.Features.BindlessResources = DEVICE_FEATURE_STATE_OPTIONAL;
+    // Buildings are culled on the GPU and drawn with indirect draw calls when the feature is available
+    EngineCI.Features.IndirectRendering = DEVICE_FEATURE_STATE_OPTIONAL;
     // We do not need the depth buffer from the swap chain in this sample
     SCDesc.DepthBufferFormat = TEX_FORMAT_UNKNOWN;
 }
 
+void TestScene::ProcessCommandLine(const char* CmdLine)
+{
+    if (const auto* pArg = strstr(CmdLine, "-shadow_resolution"))
+    {
+        const auto Resolution       = atoi(pArg + strlen("-shadow_resolution"));
+        m_ShadowSettings.Resolution = static_cast<Uint32>(clamp(Resolution, 256, 8192));
+    }
+    if (const auto* pArg = strstr(CmdLine, "-shadow_cascades"))
+    {
+        const auto NumCascades       = atoi(pArg + strlen("-shadow_cascades"));
+        m_ShadowSettings.NumCascades = static_cast<Uint32>(clamp(NumCascades, 1, MAX_CASCADES));
+    }
+    if (const auto* pArg = strstr(CmdLine, "-texture_budget"))
+    {
+        const auto BudgetMB                     = atoi(pArg + strlen("-texture_budget"));
+        m_TextureStreamingSettings.MemoryBudget = static_cast<Uint64>(clamp(BudgetMB, 16, 16384)) << 20;
+    }
+    //-texture_compression compresses the GLTF textures to BC1/BC3/BC4/BC5, -texture_compression_hq uses BC7 for color textures
+    if (const auto* pArg = strstr(CmdLine, "-texture_compression"))
+    {
+        m_TextureCompressionSettings.Enabled     = true;
+        m_TextureCompressionSettings.HighQuality = strncmp(pArg, "-texture_compression_hq", strlen("-texture_compression_hq")) == 0;
+        m_TextureCompressionSettings.CacheDir    = "TextureCache";
+    }
+    //-texture_atlas packs small textures of the buildings into atlases. The atlases have only a few mip levels,
+    //so distant buildings alias, and they are not enabled by default.
+    m_TextureAtlasSettings.Enabled = strstr(CmdLine, "-texture_atlas") != nullptr;
+}
+
 void TestScene::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
@@ -75,6 +124,40 @@ void TestScene::Initialize(const SampleInitInfo& InitInfo)
     Init = InitInfo;
     CreateRenderPass();
 
+    //The sun is shadowed by cascaded shadow maps, the buildings are cached in the cascades
+    shadowCascades.reset(new ShadowCascades(m_pDevice, m_ShadowSettings));
+    shadowCascades->SetLightDirection(float3(0.5f, -0.6f, -0.2f));
+    GLTFObject::SetShadowCascades(shadowCascades.get());
+
+    //Mip levels of the GLTF textures are streamed in as the camera approaches the actors
+    textureStreamer.reset(new GLTF::TextureStreamer(m_pDevice, m_pImmediateContext, m_TextureStreamingSettings));
+    GLTFObject::SetTextureStreamer(textureStreamer.get());
+    //Compressed textures are written to the cache directory on the first run and loaded from it afterwards
+    GLTFObject::SetTextureCompression(m_TextureCompressionSettings);
+    GLTFObject::SetTextureAtlas(m_TextureAtlasSettings);
+    //Images of the GLTF models are decoded in parallel while the files are parsed
+    imageDecodeQueue.reset(new ImageDecodeQueue);
+    GLTFObject::SetImageDecodeQueue(imageDecodeQueue.get());
+    //Models loaded by several actors are optimized only once
+    GLTFObject::SetMeshCache(&m_MeshCache);
+
+    //Animations of all GLTF actors are evaluated together on worker threads
+    animationBatch.reset(new GLTF_AnimationBatch(m_pDevice, GLTF_AnimationBatch::CreateInfo{}));
+    GLTFObject::SetAnimationBatch(animationBatch.get());
+    //Skinned actors are skinned once per frame in a compute pass and reuse the result in all draws
+    if (m_pDevice->GetDeviceCaps().Features.ComputeShaders == DEVICE_FEATURE_STATE_ENABLED)
+    {
+        computeSkinning.reset(new GLTF_ComputeSkinning(m_pDevice, animationBatch->GetJointsBufferSRV()));
+        GLTFObject::SetComputeSkinning(computeSkinning.get());
+    }
+    //Buildings are culled on the GPU and rendered with one indirect draw per primitive
+    const auto& Features = m_pDevice->GetDeviceCaps().Features;
+    if (Features.ComputeShaders == DEVICE_FEATURE_STATE_ENABLED && Features.IndirectRendering == DEVICE_FEATURE_STATE_ENABLED)
+    {
+        staticGeometry.reset(new StaticGeometry(Init, m_pRenderPass));
+        hiZPyramid.reset(new HiZPyramid(m_pDevice));
+    }
+
     //Player
     _player = new Player(Init, m_BackgroundMode, m_pRenderPass, "Player");
     _player->Initialize(float3(0, 1, 0), Quaternion(0, 0, 0, 1), _reactPhysic, float3(0, 0.5f, 0), 0.5f, 1.8f, 0.005f, 10.f, 40000);
@@ -317,6 +400,9 @@ void TestScene::CreateBasicMesh(const char* path, const SampleInitInfo& InitInfo
     BoxShape* boxShape = _reactPhysic->GetPhysicCommon()->createBoxShape(scalebox);
     CollisionComponentCreation(building, rbCube, boxShape, nullTransform);
     actors.emplace_back(building);
+    if (staticGeometry)
+        staticGeometry->AddObject(building);
+    shadowCascades->AddStaticCaster(building);
 }
      
 void TestScene::ActorCreation()
@@ -387,6 +473,31 @@ void TestScene::Render()
         light->CreateSRB(ColorBuffer, DepthZBuffer);
     }
 
+    // Texture uploads and copies must be done outside of the render pass as well.
+    // Objects rebind replaced textures when they request them, so this goes before culling.
+    for (auto actor : actors)
+        actor->RequestTextures(*_player->GetCamera());
+    textureStreamer->Update(m_pImmediateContext);
+
+    // Culling runs in a compute pass and must be done outside of the render pass
+    if (staticGeometry)
+    {
+        // Objects hidden in the previous frame may become visible in this one, so the objects culled
+        // by the pyramid of the previous frame are tested again against the pyramid built from the
+        // depth of the objects that passed the first test
+        staticGeometry->Cull(*_player->GetCamera(), m_UseOcclusionCulling ? hiZPyramid.get() : nullptr);
+        if (m_UseOcclusionCulling)
+            staticGeometry->CullOccluded(*hiZPyramid);
+    }
+
+    // Shadow maps are rendered outside of the render pass as well
+    {
+        const auto CameraView = _player->GetCamera()->GetViewMatrix() * GetSurfacePretransformMatrix(float3{0, 0, 1});
+        const auto CameraProj = GetAdjustedProjectionMatrix(PI_F / 4.0f, 0.1f, 100.f);
+        shadowCascades->Update(CameraView, CameraProj);
+        shadowCascades->Render(m_pImmediateContext, actors);
+    }
+
     BeginRenderPassAttribs RPBeginInfo;
     RPBeginInfo.pRenderPass  = m_pRenderPass;
     RPBeginInfo.pFramebuffer = pFramebuffer;
@@ -418,6 +529,18 @@ void TestScene::Render()
     RPBeginInfo.StateTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
     m_pImmediateContext->BeginRenderPass(RPBeginInfo);
 
+    // Depth pre-pass: the G-buffer pass then only shades the visible pixels
+    for (auto actor : actors)
+    {
+        if (actor->getState() == Actor::ActorState::Active)
+        {
+            actor->RenderActorDepth(*_player->GetCamera());
+        }
+    }
+    //The static geometry is not in the actor list, so it is rendered separately
+    if (staticGeometry)
+        staticGeometry->RenderActorDepth(*_player->GetCamera());
+
     for (auto actor : actors)
     {
         if (actor->getState() == Actor::ActorState::Active)
@@ -425,6 +548,8 @@ void TestScene::Render()
             actor->RenderActor(*_player->GetCamera(), false);
         }
     }
+    if (staticGeometry)
+        staticGeometry->RenderActor(*_player->GetCamera(), false);
 
     m_pImmediateContext->NextSubpass();
 
@@ -517,12 +642,16 @@ void TestScene::Update(double CurrTime, double ElapsedTime)
     
     //Draw log
     Diligent::Log::Instance().Draw();
+    UpdateUI();
 
     // Animate Actors
     for (auto actor : actors)
     {
             actor->Update(CurrTime, ElapsedTime);
     }
+    animationBatch->Execute(m_pImmediateContext);
+    if (computeSkinning)
+        computeSkinning->Execute(m_pImmediateContext, *animationBatch);
 
     for (auto light : lights)
     {
@@ -530,6 +659,53 @@ void TestScene::Update(double CurrTime, double ElapsedTime)
     }
 }
 
+void TestScene::UpdateUI()
+{
+    ImGui::SetNextWindowPos(ImVec2(10, 300), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Profiling", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        if (staticGeometry)
+        {
+            const auto& Stats = staticGeometry->GetStatistics();
+            ImGui::Text("Static instances: %u", Stats.NumInstances);
+            ImGui::Text("Frustum culled:   %u", Stats.NumFrustumCulled);
+            ImGui::Text("Occlusion culled: %u", Stats.NumOcclusionCulled);
+            ImGui::Text("Drawn:            %u", Stats.NumInstances - Stats.NumFrustumCulled - Stats.NumOcclusionCulled);
+            if (ImGui::Checkbox("Occlusion culling", &m_UseOcclusionCulling) && !m_UseOcclusionCulling)
+                hiZPyramid->Invalidate();
+        }
+        else
+        {
+            ImGui::TextDisabled("GPU culling is not supported by the device");
+        }
+
+        ImGui::Separator();
+        const auto& ShadowSettings = shadowCascades->GetSettings();
+        const auto& ShadowStats    = shadowCascades->GetStatistics();
+        ImGui::Text("Shadow cascades:  %u x %u", ShadowSettings.NumCascades, ShadowSettings.Resolution);
+        ImGui::Text("Static updates:   %u", ShadowStats.NumStaticCascadeUpdates);
+        ImGui::Text("Static casters:   %u", ShadowStats.NumStaticCasterDraws);
+        ImGui::Text("Dynamic casters:  %u", ShadowStats.NumDynamicCasterDraws);
+        ImGui::Text("Culled casters:   %u", ShadowStats.NumCulledCasters);
+
+        ImGui::Separator();
+        const auto& StreamingStats = textureStreamer->GetStatistics();
+        ImGui::Text("Texture memory:   %u / %u MB", static_cast<Uint32>((StreamingStats.ResidentMemory + StreamingStats.SourceMemory) >> 20),
+                    static_cast<Uint32>(m_TextureStreamingSettings.MemoryBudget >> 20));
+        ImGui::Text("Source images:    %u MB", static_cast<Uint32>(StreamingStats.SourceMemory >> 20));
+        ImGui::Text("Full resolution:  %u MB", static_cast<Uint32>(StreamingStats.FullResolutionMemory >> 20));
+        ImGui::Text("Pending uploads:  %u", StreamingStats.NumPendingUploads);
+        ImGui::Text("Streamed in:      %u", StreamingStats.NumStreamedIn);
+        ImGui::Text("Evicted:          %u", StreamingStats.NumEvicted);
+
+        // Changing the sun direction re-renders the static casters
+        auto SunDirection = shadowCascades->GetLightDirection();
+        if (ImGui::gizmo3D("Sun direction", SunDirection, ImGui::GetTextLineHeight() * 10))
+            shadowCascades->SetLightDirection(SunDirection);
+    }
+    ImGui::End();
+}
+
 void TestScene::addActor(Actor* actor)
 {
     actors.emplace_back(actor);
@@ -541,6 +717,7 @@ void TestScene::removeActor(Actor* actor)
     auto iter = std::find(begin(actors), end(actors), actor);
     if (iter != end(actors))
     {
+        shadowCascades->RemoveCaster(actor);
         std::iter_swap(iter, end(actors) - 1);
         actors.pop_back();
     }
@@ -43,6 +43,10 @@
 #include "Target.h"
 #include "ReactEventListener.h"
 #include "Building.h"
+#include "GLTF_AnimationBatch.hpp"
+#include "GLTF_ComputeSkinning.hpp"
+#include "StaticGeometry.h"
+#include "ShadowCascades.h"
 
 namespace Diligent
 {
@@ -56,8 +60,14 @@ public:
         static TestScene inst;
         return inst;
     }
+    ~TestScene();
+
     virtual void GetEngineInitializationAttribs(RENDER_DEVICE_TYPE DeviceType, EngineCreateInfo& EngineCI, SwapChainDesc& SCDesc) override final;
 
+    // Shadow settings can be changed with "-shadow_resolution <N>" and "-shadow_cascades <N>",
+    // the texture streaming budget with "-texture_budget <MB>"
+    virtual void ProcessCommandLine(const char* CmdLine) override final;
+
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
 
     virtual void Render() override final;
@@ -72,6 +82,9 @@ public:
     void           CreateBasicMesh(const char* path, const SampleInitInfo& InitInfo,float3 coord);
     void           SetLastActorTransform(float3 _coord, Quaternion _quat, float _scale);
 
+    //Draws the profiling overlay
+    void           UpdateUI();
+
 
     SampleInitInfo getInitInfo() { return Init; }
 
@@ -102,8 +115,24 @@ private:
     std::vector<Actor*> actors;
     std::vector<Target*> targets;
 
-    std::unique_ptr<EnvMap>       envMaps;
-    std::unique_ptr<AmbientLight> ambientlight;
+    std::unique_ptr<EnvMap>                envMaps;
+    std::unique_ptr<AmbientLight>          ambientlight;
+    std::unique_ptr<GLTF_AnimationBatch>   animationBatch;
+    std::unique_ptr<GLTF_ComputeSkinning>  computeSkinning;
+    std::unique_ptr<StaticGeometry>        staticGeometry;
+    std::unique_ptr<HiZPyramid>            hiZPyramid;
+    std::unique_ptr<ShadowCascades>        shadowCascades;
+    std::unique_ptr<GLTF::TextureStreamer> textureStreamer;
+    std::unique_ptr<ImageDecodeQueue>      imageDecodeQueue;
+
+    ShadowCascades::Settings                m_ShadowSettings;
+    GLTF::TextureStreamer::CreateInfo       m_TextureStreamingSettings;
+    GLTF::Model::TextureCompressionSettings m_TextureCompressionSettings;
+    GLTF::Model::TextureAtlasSettings       m_TextureAtlasSettings;
+    GLTF::Model::MeshCacheType              m_MeshCache;
+
+    // Two-pass occlusion culling of the static geometry, see StaticGeometry::CullOccluded()
+    bool m_UseOcclusionCulling = true;
     std::vector<PointLight*>      lights;
 
     RefCntAutoPtr<ITexture> ColorBuffer;